@@ -0,0 +1,307 @@
+// alarm_fsm.h — mașina de stări a alarmei (tabel constexpr, verificat la compilare)
+#ifndef ALARMA_SIMPLA_ALARM_FSM_H
+#define ALARMA_SIMPLA_ALARM_FSM_H
+
+#include <stdint.h>
+
+// Valorile 0..3 sunt cele istorice (EEPROM, RTC, telemetrie); stările noi se
+// adaugă doar la final.
+enum class AlarmState : uint8_t { DISARMED,
+                                  ARMING,       // exit delay (away sau stay)
+                                  ARMED,        // away: toate zonele
+                                  ALARMING,
+                                  ENTRY_DELAY,  // zonă de intrare declanșată, se așteaptă DISARM
+                                  ARMED_STAY }; // stay: zonele INTERIOR sunt ocolite
+static const uint8_t ALARM_STATE_COUNT = 6;
+
+enum class AlarmEvent : uint8_t { ARM_AWAY,
+                                  ARM_STAY,
+                                  DISARM,
+                                  MOTION_ENTRY,
+                                  MOTION_INSTANT,
+                                  MOTION_INTERIOR,
+                                  TIMEOUT };
+static const uint8_t ALARM_EVENT_COUNT = 7;
+
+// Tipul zonei decide ce eveniment produce mișcarea pe PIR-ul ei.
+enum class ZoneType : uint8_t { ENTRY,      // cu entry delay (ușa de intrare)
+                                INSTANT,    // alarmă imediată
+                                INTERIOR }; // ocolită în stay; urmează entry delay-ul
+
+enum class AlarmTimer : uint8_t { NONE,
+                                  EXIT_DELAY,
+                                  ENTRY_DELAY,
+                                  SIREN };
+
+enum class LedPattern : uint8_t { OFF,
+                                  ON,
+                                  BLINK,        // 500 ms
+                                  SLOW_BLINK,   // 1000 ms
+                                  FAST_BLINK }; // 125 ms
+
+// Ce înseamnă fiecare stare pentru ieșiri și timere. Ieșirile se scriu doar la
+// tranziții (și la schimbarea fazei LED-ului), nu la fiecare trecere prin loop().
+struct AlarmStateInfo {
+  const char* name;
+  bool siren;
+  bool armed;         // PIR-urile partiției sunt citite
+  LedPattern led;
+  AlarmTimer timer;   // pornit la intrarea în stare; expirarea => AlarmEvent::TIMEOUT
+  uint8_t priority;   // starea afișată pentru mai multe partiții = prioritatea maximă
+};
+
+static constexpr AlarmStateInfo ALARM_STATE_INFO[ALARM_STATE_COUNT] = {
+  /* DISARMED    */ { "DISARMED", false, false, LedPattern::BLINK, AlarmTimer::NONE, 0 },
+  /* ARMING      */ { "ARMING", false, false, LedPattern::BLINK, AlarmTimer::EXIT_DELAY, 3 },
+  /* ARMED       */ { "ARMED", false, true, LedPattern::ON, AlarmTimer::NONE, 2 },
+  /* ALARMING    */ { "ALARMING", true, true, LedPattern::ON, AlarmTimer::SIREN, 5 },
+  /* ENTRY_DELAY */ { "ENTRY_DELAY", false, true, LedPattern::FAST_BLINK, AlarmTimer::ENTRY_DELAY, 4 },
+  /* ARMED_STAY  */ { "ARMED_STAY", false, true, LedPattern::SLOW_BLINK, AlarmTimer::NONE, 1 },
+};
+
+// Acțiuni executate la tranziție (biți)
+static const uint8_t ALARM_ACT_MODE_AWAY = 1 << 0;      // modul armat al partiției = ARMED
+static const uint8_t ALARM_ACT_MODE_STAY = 1 << 1;      // modul armat al partiției = ARMED_STAY
+static const uint8_t ALARM_ACT_RESUME_ARMED = 1 << 2;   // ținta = modul armat memorat (next e ARMED ca placeholder)
+static const uint8_t ALARM_ACT_COUNT_ALARM = 1 << 3;    // incrementează contorul de alarme
+
+static const uint8_t ALARM_NO_TRANSITION = 0xFF;
+
+struct AlarmTransition {
+  uint8_t next;     // AlarmState sau ALARM_NO_TRANSITION (eveniment ignorat)
+  uint8_t actions;  // ALARM_ACT_*
+};
+
+#define ALARM_T(state, actions) { static_cast<uint8_t>(AlarmState::state), (actions) }
+#define ALARM_IGNORE { ALARM_NO_TRANSITION, 0 }
+
+// stare x eveniment -> stare următoare + acțiuni; dispatch = o indexare.
+static constexpr AlarmTransition ALARM_TRANSITIONS[ALARM_STATE_COUNT][ALARM_EVENT_COUNT] = {
+  //                 ARM_AWAY                                 ARM_STAY                                  DISARM                  MOTION_ENTRY                MOTION_INSTANT                           MOTION_INTERIOR                          TIMEOUT
+  /* DISARMED    */ { ALARM_T(ARMING, ALARM_ACT_MODE_AWAY),    ALARM_T(ARMING, ALARM_ACT_MODE_STAY),    ALARM_IGNORE,           ALARM_IGNORE,               ALARM_IGNORE,                            ALARM_IGNORE,                            ALARM_IGNORE },
+  /* ARMING      */ { ALARM_IGNORE,                            ALARM_IGNORE,                            ALARM_T(DISARMED, 0),   ALARM_IGNORE,               ALARM_IGNORE,                            ALARM_IGNORE,                            ALARM_T(ARMED, ALARM_ACT_RESUME_ARMED) },
+  /* ARMED       */ { ALARM_IGNORE,                            ALARM_IGNORE,                            ALARM_T(DISARMED, 0),   ALARM_T(ENTRY_DELAY, 0),    ALARM_T(ALARMING, ALARM_ACT_COUNT_ALARM), ALARM_T(ALARMING, ALARM_ACT_COUNT_ALARM), ALARM_IGNORE },
+  /* ALARMING    */ { ALARM_IGNORE,                            ALARM_IGNORE,                            ALARM_T(DISARMED, 0),   ALARM_IGNORE,               ALARM_IGNORE,                            ALARM_IGNORE,                            ALARM_T(ARMED, ALARM_ACT_RESUME_ARMED) },
+  /* ENTRY_DELAY */ { ALARM_IGNORE,                            ALARM_IGNORE,                            ALARM_T(DISARMED, 0),   ALARM_IGNORE,               ALARM_T(ALARMING, ALARM_ACT_COUNT_ALARM), ALARM_IGNORE,                            ALARM_T(ALARMING, ALARM_ACT_COUNT_ALARM) },
+  /* ARMED_STAY  */ { ALARM_T(ARMING, ALARM_ACT_MODE_AWAY),    ALARM_IGNORE,                            ALARM_T(DISARMED, 0),   ALARM_T(ENTRY_DELAY, 0),    ALARM_T(ALARMING, ALARM_ACT_COUNT_ALARM), ALARM_IGNORE,                            ALARM_IGNORE },
+};
+
+#undef ALARM_T
+#undef ALARM_IGNORE
+
+inline constexpr const AlarmTransition& alarmTransition(AlarmState s, AlarmEvent e) {
+  return ALARM_TRANSITIONS[static_cast<uint8_t>(s)][static_cast<uint8_t>(e)];
+}
+
+// ----------------------------
+// Runtime pur (fără I/O): folosit de firmware și de tools/trace_replay.cpp
+// ----------------------------
+// Câmpurile de un byte sunt grupate la început: 12 bytes în loc de 16.
+struct AlarmPartition {
+  AlarmState state;
+  AlarmState armedMode;  // ARMED sau ARMED_STAY: unde revine după ARMING/ALARMING
+  bool timerActive;
+  uint32_t sinceMs;
+  uint32_t timerDeadlineMs;
+};
+
+// Zona unui PIR: partiția (grup armat independent) și tipul ei.
+struct AlarmZone {
+  uint8_t partition;
+  ZoneType type;
+};
+
+struct AlarmTimings {
+  uint32_t exitDelayMs;
+  uint32_t entryDelayMs;
+  uint32_t sirenMs;
+  uint32_t motionRetriggerMs;
+};
+
+inline uint32_t alarmTimerMs(AlarmTimer timer, const AlarmTimings& t) {
+  switch (timer) {
+    case AlarmTimer::NONE: return 0;
+    case AlarmTimer::EXIT_DELAY: return t.exitDelayMs;
+    case AlarmTimer::ENTRY_DELAY: return t.entryDelayMs;
+    case AlarmTimer::SIREN: return t.sirenMs;
+  }
+  return 0;
+}
+
+inline AlarmEvent zoneMotionEvent(ZoneType type) {
+  switch (type) {
+    case ZoneType::ENTRY: return AlarmEvent::MOTION_ENTRY;
+    case ZoneType::INSTANT: return AlarmEvent::MOTION_INSTANT;
+    case ZoneType::INTERIOR: return AlarmEvent::MOTION_INTERIOR;
+  }
+  return AlarmEvent::MOTION_INSTANT;
+}
+
+// O singură indexare în tabel; false = eveniment ignorat (fără efecte).
+inline bool alarmApply(AlarmPartition& part, AlarmEvent event, uint32_t now, const AlarmTimings& timings, uint32_t* alarmCount) {
+  const AlarmTransition& t = alarmTransition(part.state, event);
+  if (t.next == ALARM_NO_TRANSITION) return false;
+
+  if (t.actions & ALARM_ACT_MODE_AWAY) part.armedMode = AlarmState::ARMED;
+  if (t.actions & ALARM_ACT_MODE_STAY) part.armedMode = AlarmState::ARMED_STAY;
+  if (t.actions & ALARM_ACT_COUNT_ALARM) ++*alarmCount;
+  part.state = (t.actions & ALARM_ACT_RESUME_ARMED) ? part.armedMode : static_cast<AlarmState>(t.next);
+  part.sinceMs = now;
+  const uint32_t timerMs = alarmTimerMs(ALARM_STATE_INFO[static_cast<uint8_t>(part.state)].timer, timings);
+  part.timerActive = timerMs != 0;
+  part.timerDeadlineMs = now + timerMs;
+  return true;
+}
+
+// PIR-urile (bit i = PIR i+1 activ) se evaluează doar pentru partițiile armate;
+// `dispatch(partition, event)` aplică tranziția (plus efectele, în firmware).
+template <typename Dispatch>
+inline void alarmZonesStep(const AlarmZone* zones, uint8_t zoneCount, const AlarmPartition* partitions, uint8_t pirLevels, uint32_t* lastMotionMs,
+                           uint32_t now, const AlarmTimings& timings, Dispatch dispatch) {
+  for (uint8_t i = 0; i < zoneCount; ++i) {
+    const AlarmZone& zone = zones[i];
+    if (!ALARM_STATE_INFO[static_cast<uint8_t>(partitions[zone.partition].state)].armed) continue;
+    if ((pirLevels & (1u << i)) && now - lastMotionMs[i] >= timings.motionRetriggerMs) {
+      lastMotionMs[i] = now;
+      dispatch(zone.partition, zoneMotionEvent(zone.type));
+    }
+  }
+}
+
+template <typename Dispatch>
+inline void alarmTimersStep(AlarmPartition* partitions, uint8_t partitionCount, uint32_t now, Dispatch dispatch) {
+  for (uint8_t i = 0; i < partitionCount; ++i) {
+    if (partitions[i].timerActive && (int32_t)(now - partitions[i].timerDeadlineMs) >= 0) {
+      partitions[i].timerActive = false;
+      dispatch(i, AlarmEvent::TIMEOUT);
+    }
+  }
+}
+
+// ----------------------------
+// Verificări la compilare (enumerare exhaustivă stare x eveniment)
+// ----------------------------
+namespace alarm_fsm_check {
+
+constexpr bool isArmedMode(uint8_t s) {
+  return s == static_cast<uint8_t>(AlarmState::ARMED) || s == static_cast<uint8_t>(AlarmState::ARMED_STAY);
+}
+
+// Țintele efective ale unei tranziții (RESUME_ARMED poate duce în oricare mod armat).
+constexpr bool forEachTarget(const AlarmTransition& t, bool (*pred)(uint8_t)) {
+  return (t.actions & ALARM_ACT_RESUME_ARMED)
+           ? pred(static_cast<uint8_t>(AlarmState::ARMED)) && pred(static_cast<uint8_t>(AlarmState::ARMED_STAY))
+           : pred(t.next);
+}
+
+constexpr bool validTarget(uint8_t s) {
+  return s < ALARM_STATE_COUNT;
+}
+
+constexpr bool targetsValid() {
+  for (uint8_t s = 0; s < ALARM_STATE_COUNT; ++s) {
+    for (uint8_t e = 0; e < ALARM_EVENT_COUNT; ++e) {
+      const AlarmTransition& t = ALARM_TRANSITIONS[s][e];
+      if (t.next == ALARM_NO_TRANSITION) {
+        if (t.actions != 0) return false;
+        continue;
+      }
+      if (!forEachTarget(t, validTarget)) return false;
+      if ((t.actions & ALARM_ACT_RESUME_ARMED) && t.next != static_cast<uint8_t>(AlarmState::ARMED)) return false;
+      if ((t.actions & ALARM_ACT_MODE_AWAY) && (t.actions & ALARM_ACT_MODE_STAY)) return false;
+    }
+  }
+  return true;
+}
+
+// Sirena pornește doar în ALARMING (deci niciodată în DISARMED).
+constexpr bool sirenOnlyWhileAlarming() {
+  for (uint8_t s = 0; s < ALARM_STATE_COUNT; ++s) {
+    if (ALARM_STATE_INFO[s].siren != (s == static_cast<uint8_t>(AlarmState::ALARMING))) return false;
+  }
+  return !ALARM_STATE_INFO[static_cast<uint8_t>(AlarmState::DISARMED)].siren;
+}
+
+// DISARM funcționează din orice stare armată/în alarmă.
+constexpr bool disarmAlwaysWorks() {
+  for (uint8_t s = 0; s < ALARM_STATE_COUNT; ++s) {
+    if (s == static_cast<uint8_t>(AlarmState::DISARMED)) continue;
+    const AlarmTransition& t = ALARM_TRANSITIONS[s][static_cast<uint8_t>(AlarmEvent::DISARM)];
+    if (t.next != static_cast<uint8_t>(AlarmState::DISARMED) || t.actions != 0) return false;
+  }
+  return true;
+}
+
+// Mișcarea și timerele nu produc nimic cât timp PIR-urile nu sunt citite
+// (DISARMED, ARMING); din DISARMED se iese doar prin armare.
+constexpr bool motionOnlyWhenArmed() {
+  for (uint8_t s = 0; s < ALARM_STATE_COUNT; ++s) {
+    for (uint8_t e = static_cast<uint8_t>(AlarmEvent::MOTION_ENTRY); e <= static_cast<uint8_t>(AlarmEvent::MOTION_INTERIOR); ++e) {
+      if (ALARM_TRANSITIONS[s][e].next != ALARM_NO_TRANSITION && !ALARM_STATE_INFO[s].armed) return false;
+    }
+  }
+  const uint8_t d = static_cast<uint8_t>(AlarmState::DISARMED);
+  for (uint8_t e = 0; e < ALARM_EVENT_COUNT; ++e) {
+    const bool armEvent = e == static_cast<uint8_t>(AlarmEvent::ARM_AWAY) || e == static_cast<uint8_t>(AlarmEvent::ARM_STAY);
+    if (!armEvent && ALARM_TRANSITIONS[d][e].next != ALARM_NO_TRANSITION) return false;
+  }
+  return true;
+}
+
+// TIMEOUT există exact în stările care pornesc un timer.
+constexpr bool timersMatchTimeouts() {
+  for (uint8_t s = 0; s < ALARM_STATE_COUNT; ++s) {
+    const bool hasTimer = ALARM_STATE_INFO[s].timer != AlarmTimer::NONE;
+    const bool hasTimeout = ALARM_TRANSITIONS[s][static_cast<uint8_t>(AlarmEvent::TIMEOUT)].next != ALARM_NO_TRANSITION;
+    if (hasTimer != hasTimeout) return false;
+  }
+  return true;
+}
+
+// În ARMED_STAY zonele INTERIOR nu declanșează nimic.
+constexpr bool stayBypassesInterior() {
+  return ALARM_TRANSITIONS[static_cast<uint8_t>(AlarmState::ARMED_STAY)][static_cast<uint8_t>(AlarmEvent::MOTION_INTERIOR)].next == ALARM_NO_TRANSITION;
+}
+
+constexpr bool isAlarming(uint8_t s) {
+  return s == static_cast<uint8_t>(AlarmState::ALARMING);
+}
+
+// ALARMING se atinge doar prin mișcare sau expirarea entry delay-ului, niciodată
+// direct dintr-o comandă, și fiecare astfel de tranziție e numărată.
+constexpr bool alarmOnlyFromMotionOrEntryTimeout() {
+  for (uint8_t s = 0; s < ALARM_STATE_COUNT; ++s) {
+    for (uint8_t e = 0; e < ALARM_EVENT_COUNT; ++e) {
+      const AlarmTransition& t = ALARM_TRANSITIONS[s][e];
+      if (t.next == ALARM_NO_TRANSITION || (t.actions & ALARM_ACT_RESUME_ARMED) || !isAlarming(t.next)) continue;
+      if (isAlarming(s)) return false;
+      const bool motion = e >= static_cast<uint8_t>(AlarmEvent::MOTION_ENTRY) && e <= static_cast<uint8_t>(AlarmEvent::MOTION_INTERIOR);
+      const bool entryTimeout = e == static_cast<uint8_t>(AlarmEvent::TIMEOUT) && s == static_cast<uint8_t>(AlarmState::ENTRY_DELAY);
+      if (!(motion || entryTimeout) || !(t.actions & ALARM_ACT_COUNT_ALARM)) return false;
+    }
+  }
+  return true;
+}
+
+// Prioritățile sunt distincte (starea rezumat a mai multor partiții e unică).
+constexpr bool prioritiesUnique() {
+  for (uint8_t a = 0; a < ALARM_STATE_COUNT; ++a) {
+    for (uint8_t b = a + 1; b < ALARM_STATE_COUNT; ++b) {
+      if (ALARM_STATE_INFO[a].priority == ALARM_STATE_INFO[b].priority) return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace alarm_fsm_check
+
+static_assert(alarm_fsm_check::targetsValid(), "alarm FSM: invalid transition target/actions");
+static_assert(alarm_fsm_check::sirenOnlyWhileAlarming(), "alarm FSM: siren outside ALARMING");
+static_assert(alarm_fsm_check::disarmAlwaysWorks(), "alarm FSM: DISARM must reach DISARMED from every state");
+static_assert(alarm_fsm_check::motionOnlyWhenArmed(), "alarm FSM: motion handled while not armed");
+static_assert(alarm_fsm_check::timersMatchTimeouts(), "alarm FSM: timer without TIMEOUT transition (or vice versa)");
+static_assert(alarm_fsm_check::stayBypassesInterior(), "alarm FSM: interior zones must be bypassed in ARMED_STAY");
+static_assert(alarm_fsm_check::alarmOnlyFromMotionOrEntryTimeout(), "alarm FSM: ALARMING reachable without motion");
+static_assert(alarm_fsm_check::prioritiesUnique(), "alarm FSM: duplicate state priority");
+
+#endif  // ALARMA_SIMPLA_ALARM_FSM_H
@@ -0,0 +1,205 @@
+// button_gesture.h — coada de fronturi a butonului (scrisă din ISR) și decodorul de gesturi scurt/lung/multi-apăsare, fără I/O, comun firmware + unelte host
+#ifndef ALARMA_SIMPLA_BUTTON_GESTURE_H
+#define ALARMA_SIMPLA_BUTTON_GESTURE_H
+
+#include <stdint.h>
+
+// Întreruperea pe front (CHANGE) pune în coadă momentul și nivelul citit;
+// loop() golește coada și decodează. Toate deciziile (debounce, apăsare lungă,
+// pauza care încheie o serie) se iau după momentele fronturilor, nu după
+// momentul în care loop() ajunge la ele, deci o trecere blocată câteva secunde
+// (connectWifi(), Ping.ping()) întârzie doar acțiunea, nu o schimbă.
+struct ButtonEdge {
+  uint32_t atMs;
+  bool pressed;
+};
+
+// Un producător (ISR), un consumator (loop()). N = putere a lui 2, cel mult 128.
+// Cât timp loop() e blocat, vibrațiile contactului se strâng pe loc: fronturile
+// X, Y, X mai dese decât coalesceMs devin un singur X la momentul ultimului,
+// adică exact ce ar decide decodorul din ele. ISR-ul atinge doar intrări pe care
+// loop() nu le citește încă (cel puțin 3 în coadă).
+template <uint8_t N>
+class ButtonEdgeQueue {
+  static_assert(N >= 4 && N <= 128 && (N & (N - 1)) == 0, "N putere a lui 2");
+
+ public:
+  void begin(uint32_t coalesceMs) {
+    *this = ButtonEdgeQueue();
+    coalesceMs_ = coalesceMs;
+  }
+
+  // Din ISR; inline ca să ajungă în IRAM odată cu handler-ul. Coadă plină =
+  // frontul se pierde (numărat); nivelul din fronturile următoare resincronizează decodorul.
+  inline __attribute__((always_inline)) void push(uint32_t atMs, bool pressed) {
+    const uint8_t head = __atomic_load_n(&head_, __ATOMIC_RELAXED);
+    const uint8_t depth = static_cast<uint8_t>(head - __atomic_load_n(&tail_, __ATOMIC_ACQUIRE));
+    const uint8_t prev = (head - 1) & (N - 1);
+    const uint8_t prev2 = (head - 2) & (N - 1);
+    if (depth >= 3 && (pressed_[prev2] != 0) == pressed && atMs - atMs_[prev] < coalesceMs_ && atMs_[prev] - atMs_[prev2] < coalesceMs_) {
+      atMs_[prev2] = atMs;
+      __atomic_store_n(&head_, static_cast<uint8_t>(head - 1), __ATOMIC_RELEASE);
+      __atomic_store_n(&coalesced_, __atomic_load_n(&coalesced_, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+      return;
+    }
+    if (depth >= N) {
+      __atomic_store_n(&dropped_, __atomic_load_n(&dropped_, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+      return;
+    }
+    atMs_[head & (N - 1)] = atMs;
+    pressed_[head & (N - 1)] = pressed ? 1 : 0;
+    __atomic_store_n(&head_, static_cast<uint8_t>(head + 1), __ATOMIC_RELEASE);
+  }
+
+  bool pop(ButtonEdge* out) {
+    const uint8_t tail = __atomic_load_n(&tail_, __ATOMIC_RELAXED);
+    const uint8_t depth = static_cast<uint8_t>(__atomic_load_n(&head_, __ATOMIC_ACQUIRE) - tail);
+    if (depth == 0) return false;
+    if (depth > maxDepth_) maxDepth_ = depth;
+    out->atMs = atMs_[tail & (N - 1)];
+    out->pressed = pressed_[tail & (N - 1)] != 0;
+    __atomic_store_n(&tail_, static_cast<uint8_t>(tail + 1), __ATOMIC_RELEASE);
+    ++popped_;
+    return true;
+  }
+
+  uint32_t popped() const { return popped_; }
+  uint32_t coalesced() const { return __atomic_load_n(&coalesced_, __ATOMIC_RELAXED); }
+  uint32_t dropped() const { return __atomic_load_n(&dropped_, __ATOMIC_RELAXED); }
+  uint8_t maxDepth() const { return maxDepth_; }
+  static constexpr uint8_t capacity() { return N; }
+
+ private:
+  uint32_t atMs_[N] = {};
+  uint8_t pressed_[N] = {};
+  uint8_t head_ = 0;  // scris doar de ISR
+  uint8_t tail_ = 0;  // scris doar de loop()
+  uint8_t maxDepth_ = 0;
+  uint32_t coalesceMs_ = 0;
+  uint32_t dropped_ = 0;
+  uint32_t coalesced_ = 0;
+  uint32_t popped_ = 0;
+};
+
+struct ButtonGestureConfig {
+  uint32_t debounceMs;   // un nivel contează doar dacă ține atât
+  uint32_t longPressMs;  // apăsare ținută => gest terminat cu „lung”, fără să aștepte eliberarea
+  uint32_t multiGapMs;   // pauză după o eliberare care încheie seria de apăsări scurte
+};
+
+// shorts apăsări scurte, urmate (longPress) sau nu de una ținută. atMs = momentul
+// deciziei după fronturi: apăsare + longPressMs, sau ultima eliberare + multiGapMs.
+struct ButtonGesture {
+  uint8_t shorts;
+  bool longPress;
+  uint32_t atMs;
+};
+
+static const uint8_t BUTTON_SHORTS_MAX = 15;
+
+class ButtonGestureDecoder {
+ public:
+  void begin(const ButtonGestureConfig& config, bool pressed, uint32_t now) {
+    *this = ButtonGestureDecoder();
+    config_ = config;
+    raw_ = stable_ = pressed;
+    rawSinceMs_ = now;
+    longDone_ = pressed;  // ținut de la pornire: nu e gest
+  }
+
+  // Un front din coadă, în ordine. emit(const ButtonGesture&) primește gesturile încheiate.
+  template <typename Emit>
+  void feed(const ButtonEdge& e, Emit emit) {
+    settle(e.atMs, emit);
+    // același nivel de două ori = un front pierdut (coadă plină / ISR întârziat)
+    raw_ = e.pressed;
+    rawSinceMs_ = e.atMs;
+  }
+
+  // La fiecare trecere, după fronturile din coadă: termenele scadente până la now.
+  template <typename Emit>
+  void poll(uint32_t now, Emit emit) {
+    settle(now, emit);
+  }
+
+  bool pressed() const { return stable_; }
+  uint8_t pendingShorts() const { return shorts_; }
+
+ private:
+  static bool reached(uint32_t now, uint32_t deadline) { return (int32_t)(now - deadline) >= 0; }
+
+  // Avansează până la `now`, în ordinea momentelor: un nivel nou confirmat
+  // (ținut debounceMs) are momentul frontului său, deci un termen de după acel
+  // front așteaptă confirmarea sau anularea lui.
+  template <typename Emit>
+  void settle(uint32_t now, Emit emit) {
+    for (;;) {
+      const bool pending = raw_ != stable_;
+      uint32_t deadline = 0;
+      const bool hasDeadline = nextDeadline(&deadline);
+      if (hasDeadline && reached(now, deadline) && (!pending || (int32_t)(deadline - rawSinceMs_) < 0)) {
+        fire(emit);
+        continue;
+      }
+      if (pending && reached(now, rawSinceMs_ + config_.debounceMs)) {
+        stable_ = raw_;
+        changed(rawSinceMs_);
+        continue;
+      }
+      return;
+    }
+  }
+
+  bool nextDeadline(uint32_t* at) const {
+    if (stable_ && !longDone_) {
+      *at = pressMs_ + config_.longPressMs;
+      return true;
+    }
+    if (!stable_ && shorts_ != 0) {
+      *at = releaseMs_ + config_.multiGapMs;
+      return true;
+    }
+    return false;
+  }
+
+  template <typename Emit>
+  void fire(Emit emit) {
+    if (stable_) {
+      longDone_ = true;
+      emit(ButtonGesture{ shorts_, true, pressMs_ + config_.longPressMs });
+    } else {
+      emit(ButtonGesture{ shorts_, false, releaseMs_ + config_.multiGapMs });
+    }
+    shorts_ = 0;
+  }
+
+  void changed(uint32_t at) {
+    if (stable_) {
+      pressMs_ = at;
+      longDone_ = false;
+      return;
+    }
+    if (longDone_) return;  // eliberarea după un gest lung
+    if (shorts_ < BUTTON_SHORTS_MAX) ++shorts_;
+    releaseMs_ = at;
+  }
+
+  ButtonGestureConfig config_ = {};
+  uint32_t rawSinceMs_ = 0;
+  uint32_t pressMs_ = 0;
+  uint32_t releaseMs_ = 0;
+  uint8_t shorts_ = 0;
+  bool raw_ = false;
+  bool stable_ = false;
+  bool longDone_ = false;
+};
+
+// Codul unui gest, pentru loguri: '.' = scurtă, '-' = lungă (ex. "...-").
+inline void buttonGestureCode(const ButtonGesture& g, char* out, uint8_t outSize) {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < g.shorts && n + 1 < outSize; ++i) out[n++] = '.';
+  if (g.longPress && n + 1 < outSize) out[n++] = '-';
+  out[n] = '\0';
+}
+
+#endif  // ALARMA_SIMPLA_BUTTON_GESTURE_H
@@ -2,22 +2,105 @@
 #ifndef ALARMA_SIMPLA_CONFIG_H
 #define ALARMA_SIMPLA_CONFIG_H
 
-// WiFi
-static const char* WIFI_SSID = "TP-Link_583B";      // de test la munca 
-static const char* WIFI_PASSWORD = "MicroEJ_21";
+// WiFi: rețele în ordinea priorității. La reconectare se încearcă întâi
+// ultimul BSSID/canal/IP bun (cache în RTC), apoi lista de mai jos.
+struct WifiNetwork {
+  const char* ssid;
+  const char* password;
+};
 
-// static const char* WIFI_SSID = "TP-Link_2F48";  // la TEREN . 
-// static const char* WIFI_PASSWORD = "10782279";
+static const WifiNetwork WIFI_NETWORKS[] = {
+  { "TP-Link_583B", "MicroEJ_21" },  // de test la munca
+  // { "TP-Link_2F48", "10782279" },  // la TEREN .
+  // { "tzone", "19821981" },
+  // { "RD_GUEST_SIBIU", "U3cC2#d6Fy@@" },
+};
 
+// OTA (HTTP din LAN). Lângă imagine trebuie să existe `<url>.sha256`
+// (ex. generat cu: sha256sum firmware.bin > firmware.bin.sha256). `OTA <url>`
+// și rollback-ul acceptă doar URL-uri de pe serverul din OTA_FIRMWARE_URL.
+static const char* OTA_FIRMWARE_URL = "http://192.168.1.10:8000/firmware.bin";
+static const char* OTA_ROLLBACK_URL = "http://192.168.1.10:8000/firmware_good.bin";
 
-// static const char* WIFI_SSID = "tzone";
-// static const char* WIFI_PASSWORD = "19821981";
+// Telemetrie binară UDP (cadre de 64 bytes, vezi include/telemetry_frame.h)
+static const char* TELEMETRY_COLLECTOR_HOST = "192.168.1.10";
+static const uint16_t TELEMETRY_COLLECTOR_PORT = 5140;
+static const uint32_t TELEMETRY_INTERVAL_MS = 10'000;  // 0 = dezactivat
 
+// Syslog RFC 5424 pe UDP (evenimentele [ EVENT= ...]); "" = dezactivat.
+// Cât serverul nu e accesibil, ultimele SYSLOG_BUFFER_RECORDS evenimente
+// așteaptă în RAM (putere a lui 2, ~72 B fiecare).
+static const char* SYSLOG_HOST = "192.168.1.10";
+static const uint16_t SYSLOG_PORT = 514;
+static const uint16_t SYSLOG_BUFFER_RECORDS = 64;
+// RFC 5426 §3.1: un singur mesaj syslog per datagramă UDP. > 1 = loturi de
+// mesaje separate prin LF, NESTANDARD: rsyslog/syslog-ng le salvează ca o singură
+// înregistrare cu linii noi în ea; doar pentru un receptor care știe să le despartă.
+static const uint8_t SYSLOG_BATCH_RECORDS = 1;
+static const uint16_t SYSLOG_RATE_PER_SEC = 10;  // datagrame/s la golirea buffer-ului
+static const uint16_t SYSLOG_RATE_BURST = 5;
 
+// Alarmă cooperativă: plăcile din același LAN cu același PEER_SITE_ID își
+// împart armarea și sirena (include/peer_sync.h). Grupul e administrativ
+// (239.255.x.x), nu iese din rețeaua locală. Pachetele sunt semnate cu
+// PEER_SITE_KEY (SipHash-2-4): aceeași cheie pe plăcile unui site, alta pe
+// fiecare site, generată de ex. cu `head -c16 /dev/urandom | xxd -i`. Cu cheia
+// de zero sincronizarea nu pornește, chiar dacă PEER_ENABLED = true.
+static const bool PEER_ENABLED = false;
+static const char* PEER_GROUP = "239.255.42.99";
+static const uint16_t PEER_PORT = 5141;
+static const uint16_t PEER_SITE_ID = 1;
+static const uint8_t PEER_SITE_KEY[16] = {};
 
+// PIR defect (blocat activ, cablu tăiat, contact intermitent): zona se ocolește
+// automat până la dezarmare (include/zone_health.h), ca sirena să nu pornească
+// din nou după fiecare ALARM_DURATION_MS. Verificările rulează doar cu partiția armată.
+static const uint32_t ZONE_STUCK_HIGH_MS = 3UL * 60'000;   // activ continuu
+static const uint32_t ZONE_DUTY_WINDOW_MS = 10UL * 60'000;
+static const uint8_t ZONE_DUTY_MAX_PCT = 50;               // activ din fereastră
+static const uint32_t ZONE_TRIP_SLOT_MS = 60'000;          // fereastra de rată = 32 de sloturi
+static const uint8_t ZONE_TRIP_SLOTS_MAX = 12;             // sloturi cu declanșări; 0 = fără
+static const uint8_t ZONE_SWINGER_LIMIT = 3;               // alarme pornite de zonă într-o armare; 0 = fără limită
+
+// HTTPS: sincronizarea timpului din header-ul Date (GET/HEAD pe 443, nu pe 80,
+// unde unii ISP interceptează traficul). Test local: tools/tls_probe_server.cpp.
+static const char* HTTPS_HOST = "www.google.com";
+static const uint16_t HTTPS_PORT = 443;
+static const char* HTTPS_TIME_PATH = "/generate_204";
+// Amprenta SHA1 a certificatului ("AA:BB:..."). "" = setInsecure(): fără
+// nicio verificare, deci FĂRĂ protecție la interceptare — cine deturnează
+// portul 443 poate da orice oră (și orice răspuns probei HTTPS). Lanțul CA nu
+// se poate valida înainte de sincronizarea timpului, deci singura protecție
+// e amprenta (de actualizat la reînnoirea certificatului serverului).
+static const char* HTTPS_FINGERPRINT = "";
+static const uint16_t HTTPS_MFLN_BYTES = 512;  // fragment TLS negociat; 0 = buffere de 16 KB
+static const bool HTTPS_FAST_CIPHERS = false;  // true = și suite fără ECDHE (handshake mai ieftin)
+// Proba de internet (60 s, releul și power watchdog-ul): false = ping ICMP
+// 8.8.8.8; true = HEAD pe HTTPS_HOST/HTTPS_TIME_PATH, pe conexiunea keep-alive
+// și sesiunea TLS reluată ale sincronizării timpului (pentru rețele care
+// blochează ICMP). Rezultatul are încredere doar cât HTTPS_FINGERPRINT.
+static const bool INTERNET_PROBE_HTTPS = false;
+
+// Consolă TCP (telnet): log-ul serial + comenzile UART, până la 3 clienți.
+// Fără `LOGIN <token>` un client are doar comenzile care citesc (STATUS, TSDB,
+// TRACE DUMP|SAVED, HELP); ARM/STAY/DISARM, OTA, FAULT și EMULATE_* rămân doar
+// pe UART, și după LOGIN. Telnet e text clar: tokenul oprește alți clienți din
+// LAN, nu pe cine ascultă traficul. "" = LOGIN dezactivat (consolă doar citire).
+static const uint16_t CONSOLE_TCP_PORT = 23;
+static const char* CONSOLE_TOKEN = "";
+
+// Statusul automat (30 s): true = doar câmpurile schimbate, o linie [STATUS]
+// (include/status_delta.h), cu keyframe complet periodic; false = blocul complet.
+// La runtime: STATUS FULL|DELTA. Comanda STATUS afișează mereu blocul complet.
+static const bool STATUS_AUTO_DELTA = true;
+
+// Injecție de defecte pentru teste de recuperare pe placă (comanda FAULT,
+// include/fault_inject.h). false = hook-urile dispar la compilare.
+static const bool FAULT_INJECTION_ENABLED = false;
+
+// Limba mesajelor de consolă: "RO" sau "EN" (la runtime: comanda LANG RO|EN)
+static const char* CONSOLE_LANG = "RO";
 
-// static const char* WIFI_SSID = "RD_GUEST_SIBIU";
-// static const char* WIFI_PASSWORD = "U3cC2#d6Fy@@";
 // MQTT (dezactivat)
 // static const char* MQTT_SERVER = "192.168.1.10";
 // static const uint16_t MQTT_PORT = 1883;
@@ -0,0 +1,83 @@
+// coroutine.h — corutine fără stivă (stil protothread) pentru secvențe temporizate, fără I/O, comun firmware + unelte host
+#ifndef ALARMA_SIMPLA_COROUTINE_H
+#define ALARMA_SIMPLA_COROUTINE_H
+
+#include <stdint.h>
+
+// O secvență ca „releu ON; așteaptă 1 s; releu OFF; așteaptă 1 s” se scrie
+// liniar, dar funcția se întoarce la fiecare așteptare și e reluată din loop()
+// de unde a rămas (switch pe __LINE__, ca protothreads). Costul e fix și
+// cunoscut la compilare: cadrul Coroutine (12 B) plus câmpurile pe care le
+// adaugă structura derivată; nu există stivă proprie și nici heap.
+//
+// Reguli (ca la orice protothread):
+//   - variabilele locale NU supraviețuiesc unui CO_AWAIT* / CO_YIELD: tot ce
+//     trebuie păstrat stă în structura derivată din Coroutine;
+//   - în corpul corutinei nu se folosește `switch` în jurul unui CO_AWAIT*;
+//   - un singur CO_AWAIT* pe linie (eticheta e numărul liniei).
+//
+//   struct Blink : Coroutine { uint8_t i; };
+//   CoStatus blinkRun(Blink& co, uint32_t now) {
+//     CO_BEGIN(co);
+//     for (co.i = 0; co.i < 3; ++co.i) {
+//       led(true);
+//       CO_AWAIT_MS(co, now, 500);
+//       led(false);
+//       CO_AWAIT_MS(co, now, 500);
+//     }
+//     CO_END(co);
+//   }
+//
+// C++20 `co_await` ar cere -fcoroutines și un alocator pentru cadre; aici
+// toolchain-ul e C++17, iar cadrele sunt oricum mici și statice.
+enum class CoStatus : uint8_t { RUNNING, DONE };
+
+static const uint16_t CO_STATE_START = 0;
+static const uint16_t CO_STATE_DONE = 0xFFFF;
+
+struct Coroutine {
+  uint16_t resumeAt = CO_STATE_START;  // linia de reluare; 0 = de la început
+  uint32_t waitFromMs = 0;
+  uint32_t waitMs = 0;
+
+  bool done() const { return resumeAt == CO_STATE_DONE; }
+  bool running() const { return resumeAt != CO_STATE_START && resumeAt != CO_STATE_DONE; }
+  void restart() { resumeAt = CO_STATE_START; }
+};
+
+// reluată după ce s-a terminat, o corutină rămâne terminată (până la restart())
+#define CO_BEGIN(co)                                       \
+  if ((co).resumeAt == CO_STATE_DONE) return CoStatus::DONE; \
+  switch ((co).resumeAt) {                                 \
+    case CO_STATE_START:
+
+#define CO_END(co)                 \
+  }                                \
+  (co).resumeAt = CO_STATE_DONE;   \
+  return CoStatus::DONE
+
+#define CO_YIELD(co)                                     \
+  do {                                                   \
+    (co).resumeAt = static_cast<uint16_t>(__LINE__);     \
+    return CoStatus::RUNNING;                            \
+    case static_cast<uint16_t>(__LINE__):;               \
+  } while (0)
+
+#define CO_AWAIT(co, cond)                               \
+  do {                                                   \
+    (co).resumeAt = static_cast<uint16_t>(__LINE__);     \
+    [[fallthrough]];                                     \
+    case static_cast<uint16_t>(__LINE__):                \
+      if (!(cond)) return CoStatus::RUNNING;             \
+  } while (0)
+
+// Așteptare relativă la `now` de la prima evaluare; comparația pe diferență
+// trece corect peste rollover-ul lui millis().
+#define CO_AWAIT_MS(co, now, ms)                                     \
+  do {                                                               \
+    (co).waitFromMs = (now);                                         \
+    (co).waitMs = (ms);                                              \
+    CO_AWAIT(co, (uint32_t)((now) - (co).waitFromMs) >= (co).waitMs); \
+  } while (0)
+
+#endif  // ALARMA_SIMPLA_COROUTINE_H
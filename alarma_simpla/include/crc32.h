@@ -0,0 +1,21 @@
+// crc32.h — CRC32 (IEEE 802.3, reflectat), folosit de firmware și de uneltele host
+#ifndef ALARMA_SIMPLA_CRC32_H
+#define ALARMA_SIMPLA_CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Bit cu bit, fără tabelă: datele protejate sunt mici (zeci de bytes) și
+// tabela de 1 KB ar costa DRAM pe ESP8266.
+inline uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t len) {
+  crc = ~crc;
+  while (len--) {
+    crc ^= *data++;
+    for (int k = 0; k < 8; ++k) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
+
+#endif  // ALARMA_SIMPLA_CRC32_H
@@ -0,0 +1,100 @@
+// event_bus.h — magistrală de evenimente statică (coadă fixă, abonați la compilare), comun firmware + unelte host
+#ifndef ALARMA_SIMPLA_EVENT_BUS_H
+#define ALARMA_SIMPLA_EVENT_BUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Producătorii (tranziții de alarmă, deciziile releului) doar pun un eveniment
+// de 12 bytes în coadă; abonații (log, telemetrie, ...) îl primesc mai târziu,
+// din dispatch(), în afara secțiunii critice a trecerii prin loop().
+enum class BusTopic : uint8_t {
+  ALARM_STATE,     // a = partiție, b = AlarmState nouă, value = alarmTriggerCount
+  RELAY_DECISION,  // a = RELAY_DECISION_* (biți), value = relayInternetActivationCount
+  POWER_CYCLE,     // a = echipament (power_watchdog.h), b = PowerAction::Kind, value = cicluri
+};
+static const uint8_t BUS_TOPIC_COUNT = 3;
+
+constexpr uint32_t busTopicBit(BusTopic t) {
+  return 1u << static_cast<uint8_t>(t);
+}
+
+struct BusEvent {
+  uint32_t ms;  // millis() la post
+  uint32_t value;
+  BusTopic topic;
+  uint8_t a;
+  uint8_t b;
+  uint8_t reserved;
+};
+
+// Un abonat e un tip cu:
+//   static constexpr uint32_t TOPICS = busTopicBit(...) | ...;
+//   static void onEvent(const BusEvent& e);
+// Lista de abonați e parametru de template: livrarea e un șir de apeluri
+// directe (fără tabele de pointeri / virtual), iar un topic fără abonați nu
+// intră deloc în coadă.
+//
+// Un singur producător și un singur consumator, ambele din loop()/setup().
+// Coada plină nu pierde evenimente: cel mai vechi e livrat pe loc (contorizat
+// în inlineDrains()), ca ordinea să rămână cea de la post.
+template <uint16_t CAPACITY, typename... Sinks>
+class EventBus {
+  static_assert(CAPACITY >= 2 && CAPACITY <= 256 && (CAPACITY & (CAPACITY - 1)) == 0, "EventBus capacity must be a power of two");
+
+ public:
+  static constexpr uint32_t SUBSCRIBED = (0u | ... | Sinks::TOPICS);
+
+  void post(BusTopic topic, uint8_t a, uint8_t b, uint32_t value, uint32_t ms) {
+    if (!(SUBSCRIBED & busTopicBit(topic))) return;
+    if (static_cast<uint16_t>(head_ - tail_) == CAPACITY) {
+      ++inlineDrains_;
+      deliver(queue_[tail_++ & MASK]);
+    }
+    BusEvent& e = queue_[head_++ & MASK];
+    e.ms = ms;
+    e.value = value;
+    e.topic = topic;
+    e.a = a;
+    e.b = b;
+    e.reserved = 0;
+    ++posted_;
+    const uint16_t depth = static_cast<uint16_t>(head_ - tail_);
+    if (depth > maxDepth_) maxDepth_ = depth;
+  }
+
+  // Livrează cel mult `budget` evenimente, în ordinea post-urilor.
+  uint16_t dispatch(uint16_t budget = CAPACITY) {
+    uint16_t n = 0;
+    while (tail_ != head_ && n < budget) {
+      // copie: un abonat poate posta la rândul lui (ex. log -> status)
+      const BusEvent e = queue_[tail_++ & MASK];
+      deliver(e);
+      ++n;
+    }
+    return n;
+  }
+
+  uint16_t depth() const { return static_cast<uint16_t>(head_ - tail_); }
+  uint16_t maxDepth() const { return maxDepth_; }
+  uint32_t posted() const { return posted_; }
+  uint32_t inlineDrains() const { return inlineDrains_; }
+  static constexpr uint16_t capacity() { return CAPACITY; }
+
+ private:
+  static constexpr uint16_t MASK = CAPACITY - 1;
+
+  static void deliver(const BusEvent& e) {
+    const uint32_t bit = busTopicBit(e.topic);
+    ((Sinks::TOPICS & bit ? Sinks::onEvent(e) : void()), ...);
+  }
+
+  BusEvent queue_[CAPACITY];
+  uint16_t head_ = 0;
+  uint16_t tail_ = 0;
+  uint16_t maxDepth_ = 0;
+  uint32_t posted_ = 0;
+  uint32_t inlineDrains_ = 0;
+};
+
+#endif  // ALARMA_SIMPLA_EVENT_BUS_H
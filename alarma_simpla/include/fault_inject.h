@@ -0,0 +1,152 @@
+// fault_inject.h — defecte injectate la granița I/O (ping, DNS, HTTPS, ceas, PIR, heap), fără I/O, comun firmware + unelte host
+#ifndef ALARMA_SIMPLA_FAULT_INJECT_H
+#define ALARMA_SIMPLA_FAULT_INJECT_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Fiecare defect are un nume (comanda UART `FAULT <NUME> <valoare> [sec]`), o
+// valoare (procent sau mărime) și o durată. Firmware-ul întreabă injectorul
+// exact acolo unde citește lumea de afară (rezultatul ping-ului, rezolvarea
+// DNS, conexiunea HTTPS, nivelurile PIR), deci restul logicii (relay_scheduler,
+// power_watchdog, alarm_fsm, urma de intrări) vede defectul ca pe o intrare
+// reală. Fără defecte active, fiecare hook costă un test pe o mască; cu
+// FAULT_INJECTION_ENABLED = false (config.h) nu rămâne nimic în imagine.
+//
+// Aleatorul e xorshift32 cu seed fix, ca o rulare să poată fi repetată
+// (același seed + aceleași comenzi = aceleași eșecuri, la aceleași probe).
+enum class Fault : uint8_t {
+  PING_LOSS,      // % din ping-uri raportate eșuate
+  PING_RTT,       // ms adăugate la RTT-ul raportat
+  DNS_FAIL,       // % din rezolvări de nume eșuate
+  HTTPS_FAIL,     // % din conexiunile HTTPS (sincronizarea timpului) eșuate
+  CLOCK_JUMP,     // s adăugate o dată la ceasul de sistem (negativ = înapoi)
+  PIR_NOISE,      // % din treceri prin loop() cu un PIR aleator citit HIGH
+  HEAP_PRESSURE,  // bytes ținuți alocați pe durata defectului
+};
+
+static const uint8_t FAULT_COUNT = 7;
+
+struct FaultInfo {
+  const char* name;
+  const char* unit;
+  int32_t minValue;
+  int32_t maxValue;
+};
+
+static const FaultInfo FAULT_INFO[FAULT_COUNT] = {
+  /* PING_LOSS     */ { "PING_LOSS", "%", 0, 100 },
+  /* PING_RTT      */ { "PING_RTT", "ms", 0, 10'000 },
+  /* DNS_FAIL      */ { "DNS_FAIL", "%", 0, 100 },
+  /* HTTPS_FAIL    */ { "HTTPS_FAIL", "%", 0, 100 },
+  /* CLOCK_JUMP    */ { "CLOCK_JUMP", "s", -86'400 * 365, 86'400 * 365 },
+  /* PIR_NOISE     */ { "PIR_NOISE", "%", 0, 100 },
+  /* HEAP_PRESSURE */ { "HEAP_PRESSURE", "B", 0, 32'768 },
+};
+
+// Numele din comandă (main.cpp o trece deja în majuscule); FAULT_COUNT dacă nu există.
+inline uint8_t faultFromName(const char* name, size_t len) {
+  for (uint8_t f = 0; f < FAULT_COUNT; ++f) {
+    if (strlen(FAULT_INFO[f].name) == len && memcmp(FAULT_INFO[f].name, name, len) == 0) return f;
+  }
+  return FAULT_COUNT;
+}
+
+class FaultInjector {
+ public:
+  void seed(uint32_t s) { rng_ = s != 0 ? s : 0x9E3779B9u; }
+
+  // durationMs = 0: până la clear(); valoare în afara intervalului = false
+  bool arm(Fault f, int32_t value, uint32_t durationMs, uint32_t now) {
+    const uint8_t i = static_cast<uint8_t>(f);
+    if (i >= FAULT_COUNT || value < FAULT_INFO[i].minValue || value > FAULT_INFO[i].maxValue) return false;
+    value_[i] = value;
+    untilMs_[i] = now + durationMs;
+    forever_ = static_cast<uint8_t>(durationMs == 0 ? forever_ | bit(i) : forever_ & ~bit(i));
+    active_ |= bit(i);
+    pending_ |= bit(i);  // CLOCK_JUMP / HEAP_PRESSURE: aplicate o dată de apelant
+    return true;
+  }
+
+  void clear(Fault f) { active_ &= static_cast<uint8_t>(~bit(static_cast<uint8_t>(f))); }
+  void clearAll() { active_ = 0; }
+
+  // O(1) când nu e nimic activ: hook-urile din firmware întreabă întâi asta.
+  bool anyActive() const { return active_ != 0; }
+  bool active(Fault f) const { return (active_ & bit(static_cast<uint8_t>(f))) != 0; }
+  int32_t value(Fault f) const { return value_[static_cast<uint8_t>(f)]; }
+  uint32_t hits(Fault f) const { return hits_[static_cast<uint8_t>(f)]; }
+  uint32_t rolls(Fault f) const { return rolls_[static_cast<uint8_t>(f)]; }
+  uint32_t remainingMs(Fault f, uint32_t now) const {
+    const uint8_t i = static_cast<uint8_t>(f);
+    if (!(active_ & bit(i)) || (forever_ & bit(i))) return 0;
+    return (int32_t)(untilMs_[i] - now) > 0 ? untilMs_[i] - now : 0;
+  }
+
+  // Defecte de tip procent: true = de data asta eșuează.
+  bool roll(Fault f) {
+    const uint8_t i = static_cast<uint8_t>(f);
+    if (!(active_ & bit(i))) return false;
+    ++rolls_[i];
+    if (next() % 100 >= static_cast<uint32_t>(value_[i])) return false;
+    ++hits_[i];
+    return true;
+  }
+
+  // Mărime (ms, s, bytes) de aplicat acum; 0 dacă defectul e inactiv.
+  int32_t amount(Fault f) {
+    const uint8_t i = static_cast<uint8_t>(f);
+    if (!(active_ & bit(i))) return 0;
+    ++rolls_[i];
+    ++hits_[i];
+    return value_[i];
+  }
+
+  // Defectele aplicate o singură dată la armare (salt de ceas, alocare):
+  // true o dată după fiecare arm().
+  bool takePending(Fault f) {
+    const uint8_t b = bit(static_cast<uint8_t>(f));
+    if (!(pending_ & b) || !(active_ & b)) return false;
+    pending_ &= static_cast<uint8_t>(~b);
+    return true;
+  }
+
+  uint32_t randomBelow(uint32_t n) { return n != 0 ? next() % n : 0; }
+
+  // Dezactivează defectele expirate; întoarce masca celor tocmai încheiate.
+  uint8_t expire(uint32_t now) {
+    uint8_t ended = 0;
+    for (uint8_t i = 0; i < FAULT_COUNT; ++i) {
+      const uint8_t b = bit(i);
+      if ((active_ & b) && !(forever_ & b) && (int32_t)(now - untilMs_[i]) >= 0) ended |= b;
+    }
+    active_ &= static_cast<uint8_t>(~ended);
+    return ended;
+  }
+
+  void resetCounters() {
+    memset(hits_, 0, sizeof(hits_));
+    memset(rolls_, 0, sizeof(rolls_));
+  }
+
+ private:
+  static uint8_t bit(uint8_t i) { return static_cast<uint8_t>(1u << i); }
+
+  uint32_t next() {
+    rng_ ^= rng_ << 13;
+    rng_ ^= rng_ >> 17;
+    rng_ ^= rng_ << 5;
+    return rng_;
+  }
+
+  uint32_t rng_ = 0x9E3779B9u;
+  uint8_t active_ = 0;
+  uint8_t forever_ = 0;
+  uint8_t pending_ = 0;
+  int32_t value_[FAULT_COUNT] = {};
+  uint32_t untilMs_[FAULT_COUNT] = {};
+  uint32_t hits_[FAULT_COUNT] = {};
+  uint32_t rolls_[FAULT_COUNT] = {};
+};
+
+#endif  // ALARMA_SIMPLA_FAULT_INJECT_H
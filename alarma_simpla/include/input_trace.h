@@ -0,0 +1,338 @@
+// input_trace.h — urmă compactă a intrărilor externe (record pe placă, replay pe host)
+#ifndef ALARMA_SIMPLA_INPUT_TRACE_H
+#define ALARMA_SIMPLA_INPUT_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "alarm_fsm.h"
+#include "relay_scheduler.h"
+
+// Ce se înregistrează: doar trecerile prin loop() în care s-a schimbat ceva
+// (nivelurile PIR/WiFi, rezultatul unui ping, starea modificată din afara
+// pașilor deterministici — comenzi, buton, conectare WiFi — sau o decizie).
+// O trecere = PASS(dt) urmat de înregistrările ei. Restul trecerilor nu
+// modifică starea, deci replay-ul le poate sări.
+//
+// Ordinea pașilor într-o trecere (aceeași în firmware și în trace_replay.cpp):
+//   1. LEVELS (dacă s-au schimbat)
+//   2. relayLoopStep(now, wifi)
+//   3. STATE faza TRACE_PHASE_INPUT (comenzi UART/TCP, buton, ocolirea zonelor)
+//   4. alarmZonesStep (PIR fără zonele ocolite) + alarmTimersStep (now)
+//   5. STATE faza TRACE_PHASE_NETWORK (conectare WiFi, sincronizare timp, plăci vecine)
+//   6. PING -> relayPingResult(now + offset, ok)
+//   7. STATE faza TRACE_PHASE_LATE (OTA, telemetrie)
+//
+// Ring-ul are două jumătăți; fiecare începe cu un SNAPSHOT complet (config +
+// stare), deci replay-ul poate porni de la cea mai veche jumătate rămasă.
+static const uint8_t TRACE_FORMAT_VERSION = 2;
+static const uint8_t TRACE_MAX_PARTITIONS = 4;
+static const uint8_t TRACE_ZONES = 4;
+
+static const uint8_t TRACE_LEVEL_WIFI = 1 << 4;  // biții 0..3 = PIR1..PIR4
+
+enum TraceTag : uint8_t { TRACE_TAG_PASS = 1,
+                          TRACE_TAG_LEVELS,
+                          TRACE_TAG_STATE,
+                          TRACE_TAG_PING,
+                          TRACE_TAG_DECISION,
+                          TRACE_TAG_COMMAND,
+                          TRACE_TAG_SNAPSHOT };
+
+enum TracePhase : uint8_t { TRACE_PHASE_INPUT,
+                            TRACE_PHASE_NETWORK,
+                            TRACE_PHASE_LATE,
+                            TRACE_PHASE_COUNT };
+
+enum TraceDecisionKind : uint8_t { TRACE_DECISION_RELAY = 1,   // arg = RELAY_DECISION_*
+                                   TRACE_DECISION_ALARM = 2 }; // arg = partiție << 4 | AlarmState
+
+static const size_t TRACE_COMMAND_MAX = 32;
+
+// Starea deterministă urmărită (aceeași pe placă și în replay).
+struct TracedState {
+  RelayScheduler relay;
+  AlarmPartition partitions[TRACE_MAX_PARTITIONS];
+  uint32_t lastMotionMs[TRACE_ZONES];
+  uint32_t alarmTriggerCount;
+  uint8_t zoneBypass;  // decisă în afara pașilor deterministici (zone_health.h)
+};
+
+struct TraceConfig {
+  uint8_t partitionCount;
+  AlarmZone zones[TRACE_ZONES];
+  AlarmTimings timings;
+};
+
+// ----------------------------
+// Codare (little-endian, varint pentru intervale)
+// ----------------------------
+inline size_t tracePutU32(uint8_t* p, uint32_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+  p[2] = static_cast<uint8_t>(v >> 16);
+  p[3] = static_cast<uint8_t>(v >> 24);
+  return 4;
+}
+
+inline uint32_t traceGetU32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline size_t tracePutVarint(uint8_t* p, uint32_t v) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    p[n++] = static_cast<uint8_t>(v | 0x80);
+    v >>= 7;
+  }
+  p[n++] = static_cast<uint8_t>(v);
+  return n;
+}
+
+// 0 = date insuficiente/invalid
+inline size_t traceGetVarint(const uint8_t* p, size_t avail, uint32_t* v) {
+  uint32_t r = 0;
+  for (size_t i = 0; i < avail && i < 5; ++i) {
+    r |= static_cast<uint32_t>(p[i] & 0x7F) << (7 * i);
+    if (!(p[i] & 0x80)) {
+      *v = r;
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+inline size_t traceStateBytes(uint8_t partitionCount) {
+  return 5 * 4 + 1 + partitionCount * 11u + TRACE_ZONES * 4 + 4 + 1;
+}
+
+inline size_t traceEncodeState(const TracedState& s, uint8_t partitionCount, uint8_t* p) {
+  uint8_t* start = p;
+  p += tracePutU32(p, s.relay.cutUntilMs);
+  p += tracePutU32(p, s.relay.nextAllowedMs);
+  p += tracePutU32(p, s.relay.wifiDisconnectedSinceMs);
+  p += tracePutU32(p, s.relay.unlockMs);
+  p += tracePutU32(p, s.relay.activationCount);
+  *p++ = static_cast<uint8_t>((s.relay.cutActive ? 1 : 0) | (s.relay.pingDownActive ? 2 : 0) | (s.relay.wifiWasConnected ? 4 : 0) | (s.relay.pingDelegated ? 8 : 0));
+  for (uint8_t i = 0; i < partitionCount; ++i) {
+    const AlarmPartition& part = s.partitions[i];
+    *p++ = static_cast<uint8_t>(part.state);
+    *p++ = static_cast<uint8_t>(part.armedMode);
+    p += tracePutU32(p, part.sinceMs);
+    p += tracePutU32(p, part.timerDeadlineMs);
+    *p++ = part.timerActive ? 1 : 0;
+  }
+  for (uint8_t i = 0; i < TRACE_ZONES; ++i) p += tracePutU32(p, s.lastMotionMs[i]);
+  p += tracePutU32(p, s.alarmTriggerCount);
+  *p++ = s.zoneBypass;
+  return static_cast<size_t>(p - start);
+}
+
+inline size_t traceDecodeState(const uint8_t* p, uint8_t partitionCount, TracedState* s) {
+  const uint8_t* start = p;
+  *s = {};
+  s->relay.cutUntilMs = traceGetU32(p);
+  s->relay.nextAllowedMs = traceGetU32(p + 4);
+  s->relay.wifiDisconnectedSinceMs = traceGetU32(p + 8);
+  s->relay.unlockMs = traceGetU32(p + 12);
+  s->relay.activationCount = traceGetU32(p + 16);
+  p += 20;
+  s->relay.cutActive = (*p & 1) != 0;
+  s->relay.pingDownActive = (*p & 2) != 0;
+  s->relay.wifiWasConnected = (*p & 4) != 0;
+  s->relay.pingDelegated = (*p & 8) != 0;
+  ++p;
+  for (uint8_t i = 0; i < partitionCount; ++i) {
+    AlarmPartition& part = s->partitions[i];
+    part.state = static_cast<AlarmState>(p[0]);
+    part.armedMode = static_cast<AlarmState>(p[1]);
+    part.sinceMs = traceGetU32(p + 2);
+    part.timerDeadlineMs = traceGetU32(p + 6);
+    part.timerActive = p[10] != 0;
+    p += 11;
+  }
+  for (uint8_t i = 0; i < TRACE_ZONES; ++i, p += 4) s->lastMotionMs[i] = traceGetU32(p);
+  s->alarmTriggerCount = traceGetU32(p);
+  s->zoneBypass = p[4];
+  p += 5;
+  return static_cast<size_t>(p - start);
+}
+
+inline bool traceStatesEqual(const TracedState& a, const TracedState& b, uint8_t partitionCount) {
+  uint8_t ea[128], eb[128];
+  const size_t n = traceEncodeState(a, partitionCount, ea);
+  traceEncodeState(b, partitionCount, eb);
+  return memcmp(ea, eb, n) == 0;
+}
+
+// Antetul fișierului/dump-ului: 'A','R', versiune, rezervat, lungimea celor
+// două jumătăți (cea veche prima), apoi conținutul lor.
+static const size_t TRACE_FILE_HEADER_BYTES = 8;
+
+// ----------------------------
+// Recorder (firmware)
+// ----------------------------
+// Starea se compară ca bytes (memcmp), deci TracedState trebuie inițializat
+// cu {} și copiat întreg (padding-ul rămâne 0).
+template <size_t HALF_BYTES>
+class InputTraceRecorder {
+  static_assert(HALF_BYTES >= 512 && HALF_BYTES <= 0xFFFF, "trace half size");
+
+ public:
+  void begin(const TraceConfig& config) {
+    config_ = config;
+    len_[0] = len_[1] = 0;
+    active_ = 0;
+    started_ = false;
+  }
+
+  void beginPass(uint32_t now, uint8_t levels, const TracedState& s) {
+    passNow_ = now;
+    passRecorded_ = false;
+    passChanged_ = false;
+    memcpy(&shadow_, &s, sizeof(s));
+    // jumătate nouă doar la început de trecere: snapshot-ul e o stare "între treceri"
+    if (!started_ || HALF_BYTES - len_[active_] < PASS_RESERVE_BYTES) {
+      startHalf(now, levels, s);
+      lastLevels_ = levels;
+      return;
+    }
+    if (levels != lastLevels_) {
+      lastLevels_ = levels;
+      uint8_t rec[2] = { TRACE_TAG_LEVELS, levels };
+      append(rec, sizeof(rec));
+    }
+  }
+
+  // După un pas determinist: replay-ul îl va reface, doar marcăm schimbarea.
+  void stepDone(const TracedState& s) {
+    if (memcmp(&shadow_, &s, sizeof(s)) != 0) {
+      passChanged_ = true;
+      memcpy(&shadow_, &s, sizeof(s));
+    }
+  }
+
+  // După cod nedeterminist (comenzi, rețea): orice schimbare devine STATE.
+  void external(uint8_t phase, const TracedState& s) {
+    if (memcmp(&shadow_, &s, sizeof(s)) == 0) return;
+    memcpy(&shadow_, &s, sizeof(s));
+    uint8_t rec[2 + 128];
+    rec[0] = TRACE_TAG_STATE;
+    rec[1] = phase;
+    const size_t n = traceEncodeState(s, config_.partitionCount, rec + 2);
+    append(rec, n + 2);
+  }
+
+  void ping(bool ok, uint32_t atMs) {
+    uint8_t rec[2 + 5];
+    rec[0] = TRACE_TAG_PING;
+    rec[1] = ok ? 1 : 0;
+    const size_t n = tracePutVarint(rec + 2, atMs - passNow_);
+    append(rec, n + 2);
+  }
+
+  void decision(uint8_t kind, uint8_t arg) {
+    uint8_t rec[3] = { TRACE_TAG_DECISION, kind, arg };
+    append(rec, sizeof(rec));
+  }
+
+  void command(const char* text, size_t len) {
+    if (len > TRACE_COMMAND_MAX) len = TRACE_COMMAND_MAX;
+    uint8_t rec[2 + TRACE_COMMAND_MAX];
+    rec[0] = TRACE_TAG_COMMAND;
+    rec[1] = static_cast<uint8_t>(len);
+    memcpy(rec + 2, text, len);
+    append(rec, len + 2);
+  }
+
+  void endPass() {
+    if (passChanged_ && !passRecorded_) writePassHeader();
+  }
+
+  // Pentru dump/flush fără buffer intermediar: antet + cele două jumătăți.
+  void header(uint8_t out[TRACE_FILE_HEADER_BYTES]) const {
+    const uint8_t older = active_ ^ 1;
+    out[0] = 'A';
+    out[1] = 'R';
+    out[2] = TRACE_FORMAT_VERSION;
+    out[3] = overflow_ ? 1 : 0;
+    out[4] = static_cast<uint8_t>(len_[older]);
+    out[5] = static_cast<uint8_t>(len_[older] >> 8);
+    out[6] = static_cast<uint8_t>(len_[active_]);
+    out[7] = static_cast<uint8_t>(len_[active_] >> 8);
+  }
+
+  // i = 0: jumătatea veche, i = 1: cea curentă
+  size_t span(uint8_t i, const uint8_t** data) const {
+    const uint8_t h = (i == 0) ? (active_ ^ 1) : active_;
+    *data = buf_[h];
+    return len_[h];
+  }
+
+  size_t bytesUsed() const { return len_[0] + len_[1]; }
+
+ private:
+  // o trecere încape oricând: LEVELS + 3 x STATE + PING + decizii + comandă
+  static const size_t PASS_RESERVE_BYTES = 6 + 2 + TRACE_PHASE_COUNT * (2 + 128) + 8 + 16 * 3 + 2 + TRACE_COMMAND_MAX;
+
+  void startHalf(uint32_t now, uint8_t levels, const TracedState& s) {
+    active_ = started_ ? (active_ ^ 1) : 0;
+    started_ = true;
+    len_[active_] = 0;
+    uint8_t* p = buf_[active_];
+    *p++ = TRACE_TAG_SNAPSHOT;
+    p += tracePutU32(p, now);
+    *p++ = levels;
+    *p++ = config_.partitionCount;
+    for (uint8_t i = 0; i < TRACE_ZONES; ++i) {
+      *p++ = config_.zones[i].partition;
+      *p++ = static_cast<uint8_t>(config_.zones[i].type);
+    }
+    p += tracePutU32(p, config_.timings.exitDelayMs);
+    p += tracePutU32(p, config_.timings.entryDelayMs);
+    p += tracePutU32(p, config_.timings.sirenMs);
+    p += tracePutU32(p, config_.timings.motionRetriggerMs);
+    p += traceEncodeState(s, config_.partitionCount, p);
+    len_[active_] = static_cast<uint16_t>(p - buf_[active_]);
+    lastPassMs_ = now;
+  }
+
+  void writePassHeader() {
+    passRecorded_ = true;
+    uint8_t rec[1 + 5];
+    rec[0] = TRACE_TAG_PASS;
+    const size_t n = tracePutVarint(rec + 1, passNow_ - lastPassMs_);
+    lastPassMs_ = passNow_;
+    raw(rec, n + 1);
+  }
+
+  void append(const uint8_t* rec, size_t len) {
+    if (!passRecorded_) writePassHeader();
+    raw(rec, len);
+  }
+
+  void raw(const uint8_t* rec, size_t len) {
+    if (len_[active_] + len > HALF_BYTES) {
+      overflow_ = true;  // nu ar trebui să se întâmple (PASS_RESERVE_BYTES)
+      return;
+    }
+    memcpy(buf_[active_] + len_[active_], rec, len);
+    len_[active_] = static_cast<uint16_t>(len_[active_] + len);
+  }
+
+  uint8_t buf_[2][HALF_BYTES] = {};
+  uint16_t len_[2] = { 0, 0 };
+  uint8_t active_ = 0;
+  bool started_ = false;
+  bool overflow_ = false;
+  TraceConfig config_ = {};
+  TracedState shadow_ = {};
+  uint32_t passNow_ = 0;
+  uint32_t lastPassMs_ = 0;
+  uint8_t lastLevels_ = 0;
+  bool passRecorded_ = false;
+  bool passChanged_ = false;
+};
+
+#endif  // ALARMA_SIMPLA_INPUT_TRACE_H
@@ -0,0 +1,76 @@
+// log_ring.h — ring buffer de log cu un scriitor și cursori independenți per cititor
+#ifndef ALARMA_SIMPLA_LOG_RING_H
+#define ALARMA_SIMPLA_LOG_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Poziția de citire a unui client. `pos` e un offset absolut (crește monoton,
+// modulo 2^32) în fluxul scris vreodată în ring.
+struct LogCursor {
+  uint32_t pos;
+  uint32_t dropped;  // bytes pierduți de acest cititor (a rămas în urmă)
+};
+
+// Scriitorul nu așteaptă niciodată cititorii: datele vechi se suprascriu, iar
+// un cititor prea lent pierde bytes doar la propriul cursor. Cititorii primesc
+// pointeri direct în buffer (fără copie intermediară per client).
+template <size_t CAPACITY>
+class LogRing {
+  static_assert(CAPACITY >= 64 && (CAPACITY & (CAPACITY - 1)) == 0, "LogRing capacity must be a power of two");
+
+ public:
+  void write(const uint8_t* data, size_t len) {
+    if (len > CAPACITY) {
+      // doar ultimii CAPACITY bytes mai pot fi citiți
+      head_ += static_cast<uint32_t>(len - CAPACITY);
+      data += len - CAPACITY;
+      len = CAPACITY;
+    }
+    const size_t off = head_ & MASK;
+    const size_t first = (len < CAPACITY - off) ? len : CAPACITY - off;
+    memcpy(buf_ + off, data, first);
+    memcpy(buf_, data + first, len - first);
+    head_ += static_cast<uint32_t>(len);
+  }
+
+  uint32_t head() const { return head_; }
+
+  // Cel mai vechi byte încă disponibil.
+  uint32_t oldest() const { return (head_ > CAPACITY) ? head_ - static_cast<uint32_t>(CAPACITY) : 0; }
+
+  // Cursor nou care începe cu ultimele `backlog` bytes din istoric.
+  LogCursor cursorWithBacklog(size_t backlog) const {
+    const uint32_t available = head_ - oldest();
+    const uint32_t take = (backlog < available) ? static_cast<uint32_t>(backlog) : available;
+    return LogCursor{ head_ - take, 0 };
+  }
+
+  // Mută un cursor rămas în urmă la cel mai vechi byte valid; întoarce bytes pierduți.
+  uint32_t catchUp(LogCursor& c) const {
+    const uint32_t behind = head_ - c.pos;
+    if (behind <= CAPACITY) return 0;
+    const uint32_t lost = behind - static_cast<uint32_t>(CAPACITY);
+    c.pos += lost;
+    c.dropped += lost;
+    return lost;
+  }
+
+  // Bloc contiguu de citit de la cursor (0 = nimic nou). Apelantul avansează
+  // `c.pos` cu câți bytes a consumat efectiv.
+  size_t peek(const LogCursor& c, const uint8_t** data) const {
+    const uint32_t pending = head_ - c.pos;
+    if (pending == 0 || pending > CAPACITY) return 0;
+    const size_t off = c.pos & MASK;
+    *data = buf_ + off;
+    return (pending < CAPACITY - off) ? pending : CAPACITY - off;
+  }
+
+ private:
+  static const size_t MASK = CAPACITY - 1;
+  uint8_t buf_[CAPACITY] = {};
+  uint32_t head_ = 0;
+};
+
+#endif  // ALARMA_SIMPLA_LOG_RING_H
@@ -0,0 +1,278 @@
+// messages.h — catalogul mesajelor de consolă: ID numeric + text RO/EN în flash
+#ifndef ALARMA_SIMPLA_MESSAGES_H
+#define ALARMA_SIMPLA_MESSAGES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Pe ESP8266 literalele obișnuite stau în DRAM; textele de aici sunt PROGMEM
+// (flash) și se citesc cu pgm_read_*. Pe host (tools/) macro-urile sunt banale.
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef pgm_read_byte
+#define pgm_read_byte(p) (*reinterpret_cast<const uint8_t*>(p))
+#endif
+#ifndef pgm_read_ptr
+#define pgm_read_ptr(p) (*reinterpret_cast<const void* const*>(p))
+#endif
+
+// X(ID, RO, EN). Coloana RO e textul de până acum al firmware-ului (verificat
+// de tools/message_catalog_check.cpp), EN e traducerea completă. ID-urile sunt
+// numere stabile (mesajele noi se adaugă la final), deci pot apărea și în loguri
+// binare. Fără '\n': msgPrintln() adaugă sfârșitul de rând al consolei.
+// Argumente: %s text, %d/%u număr, %x hex (majuscule), %% procent.
+// Evenimentele (EVT_*) sunt identice în ambele limbi: serial_log_analyzer
+// le recunoaște după text.
+#define MESSAGE_CATALOG(X) \
+  X(STATUS_BEGIN, "=====  %u  ===== >>", "=====  %u  ===== >>") \
+  X(STATUS_END, "=====  %u  =====  <<", "=====  %u  =====  <<") \
+  X(STATUS_ALARM_SECTION, "🚨[ Stare alarmă]", "🚨[ Alarm state]") \
+  X(STATUS_ALARM, "Alarmă: %s", "Alarm: %s") \
+  X(STATUS_PARTITION, "  P%u: %s", "  P%u: %s") \
+  X(STATUS_PARTITION_TIMER, " (%ds)", " (%ds)") \
+  X(STATUS_TRIGGER_COUNT, "Alarme declanșate: %u", "Alarms triggered: %u") \
+  X(STATUS_INTERNET_RELAY, "Internet relay: %s", "Internet relay: %s") \
+  X(STATUS_PING_DOWN, "Ping down activ: %s", "Ping down active: %s") \
+  X(STATUS_PING_DOWN_START, "Ping down start: %s", "Ping down start: %s") \
+  X(STATUS_WIFI_SECTION, "[🌐 Rețea WiFi]", "[🌐 WiFi network]") \
+  X(STATUS_WIFI, "Status WiFi: %s", "WiFi status: %s") \
+  X(STATUS_WIFI_EMULATION, "WiFi emulation: %s", "WiFi emulation: %s") \
+  X(STATUS_IP, "IP local: %s", "Local IP: %s") \
+  X(STATUS_GATEWAY, "Gateway: %s", "Gateway: %s") \
+  X(STATUS_DNS, "DNS: %s", "DNS: %s") \
+  X(STATUS_RSSI, "rssi=%d", "rssi=%d") \
+  X(STATUS_SSID, "SSID: %s ch=%d", "SSID: %s ch=%d") \
+  X(STATUS_LAST_CONNECT, "Last connect: %s assoc=%u ms ip=%u ms", "Last connect: %s assoc=%u ms ip=%u ms") \
+  X(STATUS_INTERNET_SECTION, "[🌍 Conectivitate Internet]", "[🌍 Internet connectivity]") \
+  X(STATUS_LAST_DISCONNECT, "Ultima deconectare: %s", "Last disconnect: %s") \
+  X(STATUS_WIFI_DOWN_FOR, "WiFi disconnected since: %s", "WiFi disconnected for: %s") \
+  X(STATUS_PING_COUNTER, "Ping counter: %u", "Ping counter: %u") \
+  X(STATUS_PING_INTERVAL, "Ping interval: %u ms (%u sec)", "Ping interval: %u ms (%u sec)") \
+  X(STATUS_SYSTEM_SECTION, "System ::", "System ::") \
+  X(STATUS_NTP_STARTED, "NTP started: %s", "NTP started: %s") \
+  X(STATUS_NTP_READY, "NTP ready: %s", "NTP ready: %s") \
+  X(STATUS_FREE_HEAP, "Free heap: %u", "Free heap: %u") \
+  X(STATUS_CHIP_ID, "Chip ID: %x", "Chip ID: %x") \
+  X(STATUS_UPTIME, "Uptime: %s", "Uptime: %s") \
+  X(BOOT_RULE, "[BOOT] ===========================================", "[BOOT] ===========================================") \
+  X(BOOT_BUILD, "[BOOT] FW build: %s %s", "[BOOT] FW build: %s %s") \
+  X(BOOT_CHIP_ID, "[BOOT] Chip ID: 0x%x", "[BOOT] Chip ID: 0x%x") \
+  X(BOOT_CPU_FREQ, "[BOOT] CPU freq (MHz): %u", "[BOOT] CPU freq (MHz): %u") \
+  X(BOOT_FREE_HEAP, "[BOOT] Free heap: %u", "[BOOT] Free heap: %u") \
+  X(BOOT_RESET_REASON, "[BOOT] Reset reason: %s", "[BOOT] Reset reason: %s") \
+  X(BOOT_RESTORE_US, "[BOOT] Reset -> alarm state restored (us): %u", "[BOOT] Reset -> alarm state restored (us): %u") \
+  X(BOOT_WIFI_NETWORKS, "[BOOT] WiFi networks: ", "[BOOT] WiFi networks: ") \
+  X(BOOT_WIFI_CACHE, "[BOOT] WiFi cache (RTC): %s", "[BOOT] WiFi cache (RTC): %s") \
+  X(BOOT_RELAY_PIN, "[BOOT] Internet relay pin: GPIO%u", "[BOOT] Internet relay pin: GPIO%u") \
+  X(BOOT_RELAY_PULSE, "[BOOT] Relay pulse (ms): %u", "[BOOT] Relay pulse (ms): %u") \
+  X(BOOT_WIFI_RETRY, "[BOOT] WiFi retry trigger (ms): %u", "[BOOT] WiFi retry trigger (ms): %u") \
+  X(BOOT_PING_INTERVAL, "[BOOT] Ping interval normal (ms): %u", "[BOOT] Ping interval normal (ms): %u") \
+  X(BOOT_STATUS_INTERVAL, "[BOOT] Status auto interval (ms): %u", "[BOOT] Status auto interval (ms): %u") \
+  X(CMD_INVALID_PARTITION, "UART CMD: %s -> invalid partition", "UART CMD: %s -> invalid partition") \
+  X(CMD_DONE, "UART CMD: %s -> OK", "UART CMD: %s -> OK") \
+  X(CMD_IGNORED, "UART CMD: %s -> ignored in current state", "UART CMD: %s -> ignored in current state") \
+  X(CMD_PINGNOW, "UART CMD: PINGNOW", "UART CMD: PINGNOW") \
+  X(CMD_WIFI_OFF, "UART CMD: EMULATE_WIFI_OFF -> WiFi forced DISCONNECTED", "UART CMD: EMULATE_WIFI_OFF -> WiFi forced DISCONNECTED") \
+  X(CMD_WIFI_OFF_RELAY, "UART CMD: relay INTERNET ON immediately", "UART CMD: relay INTERNET ON immediately") \
+  X(CMD_WIFI_ON, "UART CMD: EMULATE_WIFI_ON -> WiFi emulation disabled", "UART CMD: EMULATE_WIFI_ON -> WiFi emulation disabled") \
+  X(CMD_WIFI_ON_RELAY, "UART CMD: relay INTERNET forced INACTIVE", "UART CMD: relay INTERNET forced INACTIVE") \
+  X(CMD_OTA_STARTED, "UART CMD: OTA -> download started", "UART CMD: OTA -> download started") \
+  X(CMD_OTA_FAILED, "UART CMD: OTA -> failed to start", "UART CMD: OTA -> failed to start") \
+  X(CMD_TELEMETRY, "UART CMD: TELEMETRY -> interval (ms): %u", "UART CMD: TELEMETRY -> interval (ms): %u") \
+  X(CMD_TRACE_SAVE, "UART CMD: TRACE SAVE -> at end of loop", "UART CMD: TRACE SAVE -> at end of loop") \
+  X(CMD_HELP, \
+    "UART commands: ARM [p], STAY [p], DISARM [p], STATUS [FULL|DELTA], PINGNOW, EMULATE_WIFI_OFF, EMULATE_WIFI_ON, OTA [url], TELEMETRY <sec>, TRACE DUMP|SAVED|SAVE, LANG RO|EN, HTTPSNOW, TSDB [h|from to|FLUSH], FAULT [NAME value [sec]|SEED n|CLEAR], LOGIN <token>, HELP", \
+    "UART commands: ARM [p], STAY [p], DISARM [p], STATUS [FULL|DELTA], PINGNOW, EMULATE_WIFI_OFF, EMULATE_WIFI_ON, OTA [url], TELEMETRY <sec>, TRACE DUMP|SAVED|SAVE, LANG RO|EN, HTTPSNOW, TSDB [h|from to|FLUSH], FAULT [NAME value [sec]|SEED n|CLEAR], LOGIN <token>, HELP") \
+  X(CMD_UNKNOWN, "UART CMD unknown: %s", "UART CMD unknown: %s") \
+  X(CMD_TRY_HELP, "Try: HELP", "Try: HELP") \
+  X(CMD_LANG, "UART CMD: LANG -> %s", "UART CMD: LANG -> %s") \
+  X(CMD_LANG_INVALID, "UART CMD: LANG -> folosește RO sau EN", "UART CMD: LANG -> use RO or EN") \
+  X(EVENT_LINE, "[ EVENT= %s] :    %s", "[ EVENT= %s] :    %s") \
+  X(EVT_ALARM_STATE, "Alarm state -> %s (P%u)", "Alarm state -> %s (P%u)") \
+  X(EVT_WIFI_EMULATION_CANCELED, "EMULATE_WIFI_OFF canceled -> REAL_WIFI_CONNECTED", "EMULATE_WIFI_OFF canceled -> REAL_WIFI_CONNECTED") \
+  X(EVT_WIFI_CONNECTED, "WiFi connect success", "WiFi connect success") \
+  X(EVT_WIFI_EMULATION_FORCED, "WiFi emulation active -> forcing DISCONNECTED state", "WiFi emulation active -> forcing DISCONNECTED state") \
+  X(EVT_WIFI_CONNECT_FAILED, "WiFi connect failed", "WiFi connect failed") \
+  X(EVT_INTERNET_DOWN, "internet_DOWN_detected", "internet_DOWN_detected") \
+  X(EVT_WIFI_DOWN, "WiFi transition: CONNECTED -> DISCONNECTED", "WiFi transition: CONNECTED -> DISCONNECTED") \
+  X(EVT_WIFI_UP, "WiFi transition: DISCONNECTED -> CONNECTED", "WiFi transition: DISCONNECTED -> CONNECTED") \
+  X(EVT_RELAY_ACTIVATED, "relay_1_ACTIVATED", "relay_1_ACTIVATED") \
+  X(EVT_RELAY_DEACTIVATED, "relay_1_DEACTIVATED", "relay_1_DEACTIVATED") \
+  X(EVT_RELAY_FORCED_INACTIVE, "relay_1_FORCED_INACTIVE_wifi_connected", "relay_1_FORCED_INACTIVE_wifi_connected") \
+  X(EVT_CMD_WIFI_OFF, "UART command: EMULATE_WIFI_OFF (relay ON immediate)", "UART command: EMULATE_WIFI_OFF (relay ON immediate)") \
+  X(EVT_CMD_WIFI_ON, "UART command: EMULATE_WIFI_ON", "UART command: EMULATE_WIFI_ON") \
+  X(EVT_OTA_STARTED, "OTA_STARTED", "OTA_STARTED") \
+  X(EVT_OTA_ROLLBACK_STARTED, "OTA_ROLLBACK_STARTED", "OTA_ROLLBACK_STARTED") \
+  X(EVT_OTA_ABORTED, "OTA_ABORTED", "OTA_ABORTED") \
+  X(EVT_OTA_DONE, "OTA_DONE -> reboot", "OTA_DONE -> reboot") \
+  X(EVT_OTA_ROLLBACK_DONE, "OTA_ROLLBACK_DONE -> reboot", "OTA_ROLLBACK_DONE -> reboot") \
+  X(EVT_OTA_CONFIRMED, "OTA image confirmed (health check OK)", "OTA image confirmed (health check OK)") \
+  X(EVT_CONSOLE_CONNECTED, "Console client %u connected", "Console client %u connected") \
+  X(EVT_CONSOLE_DISCONNECTED, "Console client %u disconnected", "Console client %u disconnected") \
+  X(EVT_TRACE_SAVED, "trace saved (%s)", "trace saved (%s)") \
+  X(EVT_TRACE_FLUSH_FAILED, "trace flush failed (LittleFS)", "trace flush failed (LittleFS)") \
+  X(EVT_SETUP_COMPLETE, "Setup complete", "Setup complete") \
+  X(CMD_HTTPSNOW, "UART CMD: HTTPSNOW -> HTTP %d, handshake %u ms, Date: %s", "UART CMD: HTTPSNOW -> HTTP %d, handshake %u ms, Date: %s") \
+  X(CMD_STATUS_MODE, "UART CMD: STATUS -> raport automat %s", "UART CMD: STATUS -> auto report %s") \
+  X(CMD_TSDB_FLUSH, "UART CMD: TSDB FLUSH -> %u eșantioane scrise în flash", "UART CMD: TSDB FLUSH -> %u samples written to flash") \
+  X(CMD_TSDB_INVALID, "UART CMD: TSDB -> folosește TSDB <ore> sau TSDB <de_la> <până_la> (epoch)", "UART CMD: TSDB -> use TSDB <hours> or TSDB <from> <to> (epoch)") \
+  X(EVT_POWER_CUT, "power_cycle %s -> OFF (#%u)", "power_cycle %s -> OFF (#%u)") \
+  X(EVT_POWER_RESTORE, "power_cycle %s -> ON", "power_cycle %s -> ON") \
+  X(EVT_POWER_SETTLED, "power_cycle %s -> boot done, re-probing", "power_cycle %s -> boot done, re-probing") \
+  X(CMD_FAULT_DISABLED, "UART CMD: FAULT -> injecția de defecte nu e compilată (FAULT_INJECTION_ENABLED în config.h)", "UART CMD: FAULT -> fault injection is not compiled in (FAULT_INJECTION_ENABLED in config.h)") \
+  X(CMD_FAULT_INVALID, "UART CMD: FAULT -> folosește FAULT <NUME> <valoare> [sec], FAULT SEED <n> sau FAULT CLEAR", "UART CMD: FAULT -> use FAULT <NAME> <value> [sec], FAULT SEED <n> or FAULT CLEAR") \
+  X(EVT_FAULT_ARMED, "fault_%s=%d for %u s", "fault_%s=%d for %u s") \
+  X(EVT_FAULT_RUN_END, "fault_run_end after %u s", "fault_run_end after %u s") \
+  X(EVT_PEER_ARM, "peer %s from 0x%x", "peer %s from 0x%x") \
+  X(EVT_PEER_ALARM, "peer_alarm from 0x%x (PIR mask 0x%x)", "peer_alarm from 0x%x (PIR mask 0x%x)") \
+  X(EVT_ZONE_BYPASSED, "zone %u BYPASSED (%s)", "zone %u BYPASSED (%s)") \
+  X(EVT_ZONE_RESTORED, "zone %u restored", "zone %u restored") \
+  X(EVT_BUTTON_GESTURE, "button %s -> %s (lag %u ms)", "button %s -> %s (lag %u ms)") \
+  X(CMD_UART_ONLY, "UART CMD: %s -> doar pe UART", "UART CMD: %s -> UART only") \
+  X(CMD_LOGIN_REQUIRED, "UART CMD: %s -> necesită LOGIN <token>", "UART CMD: %s -> requires LOGIN <token>") \
+  X(CMD_LOGIN_OK, "UART CMD: LOGIN -> OK", "UART CMD: LOGIN -> OK") \
+  X(CMD_LOGIN_DISABLED, "UART CMD: LOGIN -> CONSOLE_TOKEN gol în config.h, consola TCP e doar citire", "UART CMD: LOGIN -> CONSOLE_TOKEN is empty in config.h, the TCP console is read-only") \
+  X(EVT_CONSOLE_LOGIN, "Console client %u logged in", "Console client %u logged in") \
+  X(EVT_CONSOLE_LOGIN_FAILED, "Console client %u login failed", "Console client %u login failed")
+
+enum class Msg : uint16_t {
+#define MSG_ENUM_ENTRY(id, ro, en) id,
+  MESSAGE_CATALOG(MSG_ENUM_ENTRY)
+#undef MSG_ENUM_ENTRY
+};
+
+#define MSG_COUNT_ENTRY(id, ro, en) +1
+static const uint16_t MSG_COUNT = 0 MESSAGE_CATALOG(MSG_COUNT_ENTRY);
+#undef MSG_COUNT_ENTRY
+
+enum class MsgLang : uint8_t { RO, EN };
+static const uint8_t MSG_LANG_COUNT = 2;
+
+// Textele, câte un tablou PROGMEM per mesaj și limbă, plus tabelul de pointeri.
+#define MSG_TEXT_ENTRY(id, ro, en) \
+  static const char MSG_RO_##id[] PROGMEM = ro; \
+  static const char MSG_EN_##id[] PROGMEM = en;
+MESSAGE_CATALOG(MSG_TEXT_ENTRY)
+#undef MSG_TEXT_ENTRY
+
+static const char* const MSG_TABLE[MSG_LANG_COUNT][MSG_COUNT] PROGMEM = {
+#define MSG_RO_ENTRY(id, ro, en) MSG_RO_##id,
+#define MSG_EN_ENTRY(id, ro, en) MSG_EN_##id,
+  { MESSAGE_CATALOG(MSG_RO_ENTRY) },
+  { MESSAGE_CATALOG(MSG_EN_ENTRY) },
+#undef MSG_RO_ENTRY
+#undef MSG_EN_ENTRY
+};
+
+// Bytes ocupați de texte în flash, per limbă (raportul de la build).
+#define MSG_RO_BYTES_ENTRY(id, ro, en) +sizeof(ro)
+#define MSG_EN_BYTES_ENTRY(id, ro, en) +sizeof(en)
+static const size_t MSG_CATALOG_BYTES_RO = 0 MESSAGE_CATALOG(MSG_RO_BYTES_ENTRY);
+static const size_t MSG_CATALOG_BYTES_EN = 0 MESSAGE_CATALOG(MSG_EN_BYTES_ENTRY);
+#undef MSG_RO_BYTES_ENTRY
+#undef MSG_EN_BYTES_ENTRY
+
+inline const char* msgText(MsgLang lang, Msg id) {
+  const uint8_t l = static_cast<uint8_t>(lang) < MSG_LANG_COUNT ? static_cast<uint8_t>(lang) : 0;
+  return static_cast<const char*>(pgm_read_ptr(&MSG_TABLE[l][static_cast<uint16_t>(id)]));
+}
+
+inline const char* msgLangName(MsgLang lang) {
+  return lang == MsgLang::EN ? "EN" : "RO";
+}
+
+// "RO"/"EN" (indiferent de majuscule) => true și limba în *out.
+inline bool msgLangParse(const char* s, MsgLang* out) {
+  if (s == nullptr || strlen(s) != 2) return false;
+  const char a = static_cast<char>(s[0] & ~0x20);
+  const char b = static_cast<char>(s[1] & ~0x20);
+  if (a == 'R' && b == 'O') {
+    *out = MsgLang::RO;
+  } else if (a == 'E' && b == 'N') {
+    *out = MsgLang::EN;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Argument de mesaj: text sau număr, convertit din tipul de la apel.
+struct MsgArg {
+  enum Kind : uint8_t { STR, INT, UINT };
+
+  MsgArg(const char* v) : kind(STR), s(v) {}
+  MsgArg(int v) : kind(INT), i(v) {}
+  MsgArg(long v) : kind(INT), i(static_cast<int32_t>(v)) {}
+  MsgArg(unsigned v) : kind(UINT), u(v) {}
+  MsgArg(unsigned long v) : kind(UINT), u(static_cast<uint32_t>(v)) {}
+
+  Kind kind;
+  union {
+    const char* s;
+    int32_t i;
+    uint32_t u;
+  };
+};
+
+// Formatorul: citește formatul din flash octet cu octet și scrie în out
+// (mereu terminat cu '\0', trunchiat la outSize - 1). Întoarce lungimea scrisă.
+inline size_t msgRender(char* out, size_t outSize, const char* fmt, const MsgArg* args, size_t argCount) {
+  if (outSize == 0) return 0;
+  size_t n = 0;
+  size_t next = 0;
+  auto put = [&](char c) {
+    if (n + 1 < outSize) out[n++] = c;
+  };
+  auto putUnsigned = [&](uint32_t v, uint32_t base) {
+    char digits[10];
+    uint8_t k = 0;
+    do {
+      const uint32_t d = v % base;
+      digits[k++] = static_cast<char>(d < 10 ? '0' + d : 'A' + d - 10);
+      v /= base;
+    } while (v != 0);
+    while (k > 0) put(digits[--k]);
+  };
+
+  for (const char* p = fmt;; ++p) {
+    const char c = static_cast<char>(pgm_read_byte(p));
+    if (c == '\0') break;
+    if (c != '%') {
+      put(c);
+      continue;
+    }
+    const char conv = static_cast<char>(pgm_read_byte(++p));
+    if (conv == '\0') break;
+    if (conv == '%') {
+      put('%');
+      continue;
+    }
+    if (next >= argCount) {
+      put('?');
+      continue;
+    }
+    const MsgArg& a = args[next++];
+    if (a.kind == MsgArg::STR) {
+      for (const char* s = a.s ? a.s : "(null)"; *s != '\0'; ++s) put(*s);
+    } else if (conv == 'x') {
+      putUnsigned(a.u, 16);
+    } else if (a.kind == MsgArg::INT && a.i < 0) {
+      put('-');
+      putUnsigned(0u - static_cast<uint32_t>(a.i), 10);
+    } else {
+      putUnsigned(a.u, 10);
+    }
+  }
+  out[n] = '\0';
+  return n;
+}
+
+template <typename... Args>
+inline size_t msgFormat(char* out, size_t outSize, MsgLang lang, Msg id, const Args&... args) {
+  const MsgArg argv[sizeof...(Args) + 1] = { MsgArg(args)..., MsgArg(0) };
+  return msgRender(out, outSize, msgText(lang, id), argv, sizeof...(Args));
+}
+
+#endif  // ALARMA_SIMPLA_MESSAGES_H
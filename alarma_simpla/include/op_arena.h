@@ -0,0 +1,108 @@
+// op_arena.h — arenă (bump allocator) pentru bufferele temporare ale operațiilor de rețea, fără I/O, comun firmware + unelte host
+#ifndef ALARMA_SIMPLA_OP_ARENA_H
+#define ALARMA_SIMPLA_OP_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Un singur buffer static (BSS, rezervat la link, nu din heap). O operație
+// (sincronizarea timpului, descărcarea .sha256 pentru OTA, ...) deschide un
+// ArenaScope, ia bufferele cu alloc() și la ieșirea din scope tot ce a luat se
+// eliberează dintr-odată (O(1): cursorul revine la marcajul de la început).
+// Heap-ul nu vede deloc aceste buffere, deci nu rămân găuri între alocările
+// de durată lungă (umm_malloc pe ESP8266 nu mută blocurile).
+//
+// Scope-urile se pot imbrica (LIFO, ca pe stivă). alloc() fără scope deschis
+// sau peste capacitate întoarce nullptr: apelantul renunță la operație, ca la
+// un malloc eșuat. Pe operație se țin: câte rulări, câte alocări refuzate,
+// bytes folosiți la ultima rulare și maximul (high-water).
+struct ArenaOpStats {
+  uint32_t runs;
+  uint32_t failures;
+  uint16_t lastBytes;
+  uint16_t maxBytes;
+};
+
+static const uint8_t ARENA_NO_OP = 0xFF;
+
+template <size_t CAP, uint8_t OPS>
+class OpArena {
+  static_assert(CAP <= 0xFFFF, "ArenaOpStats ține bytes pe 16 biți");
+
+ public:
+  struct Mark {
+    uint16_t used;
+    uint16_t peak;
+    uint8_t op;
+  };
+
+  void* alloc(size_t bytes, size_t align = alignof(uint32_t)) {
+    const size_t start = (used_ + align - 1) & ~(align - 1);
+    if (op_ == ARENA_NO_OP || start + bytes > CAP) {
+      if (op_ != ARENA_NO_OP) ++stats_[op_].failures;
+      ++failures_;
+      return nullptr;
+    }
+    used_ = static_cast<uint16_t>(start + bytes);
+    if (used_ > peak_) peak_ = used_;
+    return buf_ + start;
+  }
+
+  // Text gol de `size` bytes (inclusiv terminatorul).
+  char* allocText(size_t size) {
+    char* p = static_cast<char*>(alloc(size, 1));
+    if (p != nullptr && size != 0) p[0] = '\0';
+    return p;
+  }
+
+  Mark open(uint8_t op) {
+    const Mark m = { used_, peak_, op_ };
+    op_ = op < OPS ? op : ARENA_NO_OP;
+    peak_ = used_;
+    return m;
+  }
+
+  void close(const Mark& m) {
+    if (op_ != ARENA_NO_OP) {
+      ArenaOpStats& s = stats_[op_];
+      ++s.runs;
+      s.lastBytes = static_cast<uint16_t>(peak_ - m.used);
+      if (s.lastBytes > s.maxBytes) s.maxBytes = s.lastBytes;
+    }
+    if (peak_ > highWater_) highWater_ = peak_;
+    used_ = m.used;
+    peak_ = peak_ > m.peak ? peak_ : m.peak;  // scope-ul exterior vede și ce a folosit cel interior
+    op_ = m.op;
+  }
+
+  size_t capacity() const { return CAP; }
+  size_t used() const { return used_; }
+  size_t highWater() const { return highWater_; }
+  uint32_t failures() const { return failures_; }
+  const ArenaOpStats& stats(uint8_t op) const { return stats_[op]; }
+
+ private:
+  alignas(8) uint8_t buf_[CAP];
+  uint16_t used_ = 0;
+  uint16_t peak_ = 0;
+  uint16_t highWater_ = 0;
+  uint8_t op_ = ARENA_NO_OP;
+  uint32_t failures_ = 0;
+  ArenaOpStats stats_[OPS] = {};
+};
+
+// Deschide o operație pe durata blocului; destructorul eliberează tot ce s-a luat în ea.
+template <typename Arena>
+class ArenaScope {
+ public:
+  ArenaScope(Arena& arena, uint8_t op) : arena_(arena), mark_(arena.open(op)) {}
+  ~ArenaScope() { arena_.close(mark_); }
+  ArenaScope(const ArenaScope&) = delete;
+  ArenaScope& operator=(const ArenaScope&) = delete;
+
+ private:
+  Arena& arena_;
+  typename Arena::Mark mark_;
+};
+
+#endif  // ALARMA_SIMPLA_OP_ARENA_H
@@ -0,0 +1,323 @@
+// peer_sync.h — alarmă cooperativă între plăci (UDP multicast în LAN), fără I/O, comun firmware + unelte host
+#ifndef ALARMA_SIMPLA_PEER_SYNC_H
+#define ALARMA_SIMPLA_PEER_SYNC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "alarm_fsm.h"
+#include "siphash.h"
+#include "telemetry_frame.h"
+
+// Mai multe plăci pe același site (una pe etaj) împart două registre:
+//   - ARM: ultima comandă pentru toată placa (ARM / STAY / DISARM), de pe
+//     oricare placă (buton, UART, MQTT);
+//   - ALARM: ultimul incident = placa + PIR-urile care au pornit sirena.
+// Fiecare registru are o versiune (ceas Lamport, placa de origine); la
+// primire se păstrează versiunea mai mare (last-writer-wins). Fără lider:
+// ordinea e totală și aceeași pe toate plăcile, deci după ce au văzut aceleași
+// pachete au aceeași stare, indiferent de ordinea sosirii. Un pachet
+// duplicat sau vechi nu schimbă nimic (merge idempotent).
+//
+// Fiecare pachet poartă ambele registre (stare completă, 48 B): retransmiterea
+// e pur și simplu retrimiterea stării. La o schimbare locală se trimite imediat
+// și încă de câteva ori în primele ~250 ms (pierderi izolate), apoi un
+// heartbeat la PEER_HEARTBEAT_MS reface orice pierdere mai lungă. `seq` (per
+// placă) servește doar la statistică (pachete pierdute / duplicate).
+//
+// Incidentul poartă și vârsta lui (ms de la declanșare, fără ceas comun): o
+// placă repornită sau care revine după o pană află de incidentele vechi din
+// heartbeat, dar pornește sirena doar pentru cele mai noi de
+// PEER_ALARM_FRESH_MS.
+//
+// Autentificare: SipHash-2-4 cu cheia site-ului (PEER_SITE_KEY din config.h)
+// peste tot pachetul; fără cheie, alt dispozitiv din LAN nu poate dezarma sau
+// porni sirena. Un pachet fără MAC valid (alt site, cheie greșită, v1 fără
+// MAC, bytes alterați) se aruncă înainte de orice câmp. Un pachet valid
+// reluat mai târziu e doar o versiune veche: merge-ul îl ignoră cât timp
+// plăcile țin minte una mai nouă.
+//
+// Layout fix, little-endian, 48 bytes (versiunea 2):
+//   off  size  câmp
+//    0    2    magic 'A','P'
+//    2    1    versiune
+//    3    1    flags (PEER_FLAG_*)
+//    4    2    site id (plăci din instalații diferite în același LAN se ignoră)
+//    6    2    rezervat (0)
+//    8    4    board id (chip id)
+//   12    4    seq
+//   16    4    ARM: lamport
+//   20    4    ARM: placa de origine
+//   24    1    ARM: comanda (PeerArmCmd)
+//   25    1    ALARM: PIR-urile (bit i = PIR i+1; 0 = entry delay expirat)
+//   26    2    rezervat (0)
+//   28    4    ALARM: lamport
+//   32    4    ALARM: placa de origine
+//   36    4    ALARM: vârsta incidentului, ms (0xFFFFFFFF = vechi / niciunul)
+//   40    8    MAC: SipHash-2-4(cheia site-ului, bytes 0..39)
+static const size_t PEER_PACKET_SIZE = 48;
+static const size_t PEER_MAC_OFFSET = 40;
+static const uint8_t PEER_MAGIC_0 = 'A';
+static const uint8_t PEER_MAGIC_1 = 'P';
+static const uint8_t PEER_VERSION = 2;
+static const uint8_t PEER_FLAG_CHANGED = 1u << 0;  // trimis din cauza unei schimbări, nu heartbeat
+
+static const uint8_t PEER_MAX_PEERS = 8;
+static const uint32_t PEER_HEARTBEAT_MS = 1'000;
+static const uint32_t PEER_OFFLINE_MS = 5'000;
+static const uint32_t PEER_ALARM_FRESH_MS = 10'000;
+// retrimiteri după o schimbare locală (ms de la schimbare); apoi doar heartbeat.
+// Dese la început: sirena pe celelalte plăci întârzie doar dacă toate cele
+// trimise în primele 40 ms se pierd (la 30% pierderi: 0,3^5 ≈ 0,2%).
+static const uint16_t PEER_BURST_MS[] = { 0, 5, 10, 20, 40, 100, 250 };
+static const uint8_t PEER_BURST_COUNT = sizeof(PEER_BURST_MS) / sizeof(PEER_BURST_MS[0]);
+
+enum class PeerArmCmd : uint8_t { NONE, ARM_AWAY, ARM_STAY, DISARM };
+
+// Doar comenzile de armare se partajează; PeerArmCmd::NONE pentru restul.
+inline PeerArmCmd peerArmFromEvent(AlarmEvent e) {
+  switch (e) {
+    case AlarmEvent::ARM_AWAY: return PeerArmCmd::ARM_AWAY;
+    case AlarmEvent::ARM_STAY: return PeerArmCmd::ARM_STAY;
+    case AlarmEvent::DISARM: return PeerArmCmd::DISARM;
+    default: return PeerArmCmd::NONE;
+  }
+}
+
+inline AlarmEvent peerArmEvent(PeerArmCmd cmd) {
+  return cmd == PeerArmCmd::ARM_AWAY ? AlarmEvent::ARM_AWAY : cmd == PeerArmCmd::ARM_STAY ? AlarmEvent::ARM_STAY : AlarmEvent::DISARM;
+}
+
+// Tabelul FSM ignoră ARM în ARMING / ARMED: o comandă de armare venită de la
+// alt nod, cu alt mod decât cel local (away vs stay, comenzi concurente), se
+// aplică ca DISARM + ARM, altfel plăcile ar rămâne în moduri diferite.
+inline bool peerArmNeedsDisarm(const AlarmPartition& part, PeerArmCmd cmd) {
+  if (cmd != PeerArmCmd::ARM_AWAY && cmd != PeerArmCmd::ARM_STAY) return false;
+  if (part.state != AlarmState::ARMING && part.state != AlarmState::ARMED && part.state != AlarmState::ARMED_STAY) return false;
+  return part.armedMode != (cmd == PeerArmCmd::ARM_AWAY ? AlarmState::ARMED : AlarmState::ARMED_STAY);
+}
+
+struct PeerRegister {
+  uint32_t lamport;  // 0 = niciodată scris
+  uint32_t origin;
+  uint8_t value;     // ARM: PeerArmCmd; ALARM: masca PIR-urilor
+};
+
+// (lamport, origine) lexicografic: ordine totală, aceeași pe toate plăcile.
+inline bool peerNewer(const PeerRegister& a, const PeerRegister& b) {
+  return a.lamport != b.lamport ? a.lamport > b.lamport : a.origin > b.origin;
+}
+
+struct PeerPacket {
+  uint8_t flags;
+  uint16_t siteId;
+  uint32_t boardId;
+  uint32_t seq;
+  PeerRegister arm;
+  PeerRegister alarm;
+  uint32_t alarmAgeMs;
+};
+
+inline uint64_t peerMac(const uint8_t key[SIPHASH_KEY_BYTES], const uint8_t* packet) {
+  return siphash24(key, packet, PEER_MAC_OFFSET);
+}
+
+inline void peerEncode(const PeerPacket& p, const uint8_t key[SIPHASH_KEY_BYTES], uint8_t* out) {
+  memset(out, 0, PEER_PACKET_SIZE);
+  out[0] = PEER_MAGIC_0;
+  out[1] = PEER_MAGIC_1;
+  out[2] = PEER_VERSION;
+  out[3] = p.flags;
+  telemetryPutU16(out + 4, p.siteId);
+  telemetryPutU32(out + 8, p.boardId);
+  telemetryPutU32(out + 12, p.seq);
+  telemetryPutU32(out + 16, p.arm.lamport);
+  telemetryPutU32(out + 20, p.arm.origin);
+  out[24] = p.arm.value;
+  out[25] = p.alarm.value;
+  telemetryPutU32(out + 28, p.alarm.lamport);
+  telemetryPutU32(out + 32, p.alarm.origin);
+  telemetryPutU32(out + 36, p.alarmAgeMs);
+  const uint64_t mac = peerMac(key, out);
+  telemetryPutU32(out + PEER_MAC_OFFSET, static_cast<uint32_t>(mac));
+  telemetryPutU32(out + PEER_MAC_OFFSET + 4, static_cast<uint32_t>(mac >> 32));
+}
+
+// Comparația MAC-ului nu se oprește la primul byte diferit.
+inline bool peerMacValid(const uint8_t key[SIPHASH_KEY_BYTES], const uint8_t* in) {
+  const uint64_t mac = peerMac(key, in);
+  uint8_t diff = 0;
+  for (uint8_t i = 0; i < 8; ++i) diff |= static_cast<uint8_t>(in[PEER_MAC_OFFSET + i] ^ static_cast<uint8_t>(mac >> (8 * i)));
+  return diff == 0;
+}
+
+inline bool peerDecode(const uint8_t* in, size_t len, const uint8_t key[SIPHASH_KEY_BYTES], PeerPacket* p) {
+  if (len != PEER_PACKET_SIZE || in[0] != PEER_MAGIC_0 || in[1] != PEER_MAGIC_1 || in[2] != PEER_VERSION) return false;
+  if (!peerMacValid(key, in)) return false;
+  p->flags = in[3];
+  p->siteId = telemetryGetU16(in + 4);
+  p->boardId = telemetryGetU32(in + 8);
+  p->seq = telemetryGetU32(in + 12);
+  p->arm = { telemetryGetU32(in + 16), telemetryGetU32(in + 20), in[24] };
+  p->alarm = { telemetryGetU32(in + 28), telemetryGetU32(in + 32), in[25] };
+  p->alarmAgeMs = telemetryGetU32(in + 36);
+  return p->arm.value <= static_cast<uint8_t>(PeerArmCmd::DISARM);
+}
+
+struct PeerInfo {
+  uint32_t boardId;
+  uint32_t lastSeenMs;
+  uint32_t lastSeq;
+  uint32_t received;
+  uint32_t lost;        // goluri în seq
+  uint32_t duplicates;  // seq deja văzut (sau mai vechi)
+};
+
+// Rezultatul unui pachet primit: ce registre s-au schimbat (de aplicat local).
+// Un incident mai vechi de PEER_ALARM_FRESH_MS e adoptat fără PEER_RX_ALARM.
+static const uint8_t PEER_RX_ARM = 1u << 0;
+static const uint8_t PEER_RX_ALARM = 1u << 1;
+
+class PeerSync {
+ public:
+  void begin(uint32_t boardId, uint16_t siteId, const uint8_t key[SIPHASH_KEY_BYTES]) {
+    *this = PeerSync();
+    boardId_ = boardId;
+    siteId_ = siteId;
+    memcpy(key_, key, SIPHASH_KEY_BYTES);
+  }
+
+  // Schimbări locale: versiune nouă, trimisă imediat + burst.
+  void localArm(PeerArmCmd cmd, uint32_t now) { write(arm_, static_cast<uint8_t>(cmd), now); }
+  void localAlarm(uint8_t pirMask, uint32_t now) {
+    write(alarm_, pirMask, now);
+    alarmAtMs_ = now;
+    alarmStale_ = false;
+  }
+
+  // true = de trimis acum un pachet (encode() îl umple)
+  bool dueSend(uint32_t now) {
+    if (!alarmStale_ && now - alarmAtMs_ >= PEER_ALARM_FRESH_MS) alarmStale_ = true;
+    if (burstIndex_ < PEER_BURST_COUNT) {
+      if (now - changedMs_ < PEER_BURST_MS[burstIndex_]) return false;
+      ++burstIndex_;
+      nextHeartbeatMs_ = now + PEER_HEARTBEAT_MS;
+      changedFlag_ = true;
+      return true;
+    }
+    if ((int32_t)(now - nextHeartbeatMs_) < 0) return false;
+    nextHeartbeatMs_ = now + PEER_HEARTBEAT_MS;
+    changedFlag_ = false;
+    return true;
+  }
+
+  void encode(uint8_t* out, uint32_t now) {
+    const PeerPacket p = { static_cast<uint8_t>(changedFlag_ ? PEER_FLAG_CHANGED : 0), siteId_, boardId_, seq_++, arm_, alarm_, alarmAgeMs(now) };
+    peerEncode(p, key_, out);
+  }
+
+  uint8_t receive(const uint8_t* buf, size_t len, uint32_t now) {
+    PeerPacket p;
+    if (!peerDecode(buf, len, key_, &p)) {
+      ++rejected_;
+      return 0;
+    }
+    if (p.siteId != siteId_ || p.boardId == boardId_) return 0;  // alt site / propriul ecou multicast
+    notePeer(p, now);
+
+    uint8_t changed = 0;
+    if (merge(arm_, p.arm)) changed |= PEER_RX_ARM;
+    if (merge(alarm_, p.alarm)) {
+      alarmAtMs_ = now - p.alarmAgeMs;
+      alarmStale_ = p.alarmAgeMs >= PEER_ALARM_FRESH_MS;
+      if (!alarmStale_) changed |= PEER_RX_ALARM;
+    }
+    if (changed != 0) ++merges_;
+    return changed;
+  }
+
+  const PeerRegister& arm() const { return arm_; }
+  const PeerRegister& alarm() const { return alarm_; }
+  // UINT32_MAX = niciun incident sau unul deja vechi (nu mai crește, deci nici nu trece prin 0)
+  uint32_t alarmAgeMs(uint32_t now) const { return alarm_.lamport == 0 || alarmStale_ ? UINT32_MAX : now - alarmAtMs_; }
+  uint32_t boardId() const { return boardId_; }
+  uint32_t sent() const { return seq_; }
+  uint32_t merges() const { return merges_; }
+  uint32_t rejected() const { return rejected_; }  // format greșit sau MAC invalid
+  uint8_t peerCount() const { return peerCount_; }
+  const PeerInfo& peer(uint8_t i) const { return peers_[i]; }
+  uint8_t onlineCount(uint32_t now) const {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < peerCount_; ++i) n += (now - peers_[i].lastSeenMs) < PEER_OFFLINE_MS ? 1 : 0;
+    return n;
+  }
+
+ private:
+  void write(PeerRegister& r, uint8_t value, uint32_t now) {
+    r.lamport = clock_ = clock_ + 1;
+    r.origin = boardId_;
+    r.value = value;
+    changedMs_ = now;
+    burstIndex_ = 0;
+  }
+
+  bool merge(PeerRegister& local, const PeerRegister& remote) {
+    if (remote.lamport > clock_) clock_ = remote.lamport;
+    if (!peerNewer(remote, local)) return false;
+    local = remote;
+    return true;
+  }
+
+  void notePeer(const PeerPacket& p, uint32_t now) {
+    PeerInfo* info = nullptr;
+    for (uint8_t i = 0; i < peerCount_ && info == nullptr; ++i) {
+      if (peers_[i].boardId == p.boardId) info = &peers_[i];
+    }
+    if (info == nullptr) {
+      // tabel plin: se refolosește cel mai vechi văzut
+      uint8_t slot = peerCount_;
+      if (slot == PEER_MAX_PEERS) {
+        slot = 0;
+        for (uint8_t i = 1; i < PEER_MAX_PEERS; ++i) {
+          if ((int32_t)(peers_[i].lastSeenMs - peers_[slot].lastSeenMs) < 0) slot = i;
+        }
+      } else {
+        ++peerCount_;
+      }
+      info = &peers_[slot];
+      *info = { p.boardId, now, p.seq, 1, 0, 0 };
+      return;
+    }
+    info->lastSeenMs = now;
+    ++info->received;
+    if ((int32_t)(p.seq - info->lastSeq) <= 0) {
+      // un seq mai mic după o pauză lungă = placa a repornit
+      if (info->lastSeq - p.seq > 1000) info->lastSeq = p.seq;
+      else ++info->duplicates;
+      return;
+    }
+    info->lost += p.seq - info->lastSeq - 1;
+    info->lastSeq = p.seq;
+  }
+
+  uint32_t boardId_ = 0;
+  uint16_t siteId_ = 0;
+  uint8_t key_[SIPHASH_KEY_BYTES] = {};
+  uint32_t clock_ = 0;
+  uint32_t seq_ = 0;
+  PeerRegister arm_ = {};
+  PeerRegister alarm_ = {};
+  uint32_t alarmAtMs_ = 0;
+  bool alarmStale_ = true;
+  uint32_t changedMs_ = 0;
+  uint8_t burstIndex_ = PEER_BURST_COUNT;
+  bool changedFlag_ = false;
+  uint32_t nextHeartbeatMs_ = 0;
+  uint32_t merges_ = 0;
+  uint32_t rejected_ = 0;
+  uint8_t peerCount_ = 0;
+  PeerInfo peers_[PEER_MAX_PEERS] = {};
+};
+
+#endif  // ALARMA_SIMPLA_PEER_SYNC_H
@@ -0,0 +1,245 @@
+// power_watchdog.h — power-cycle pentru mai multe echipamente (modem, router, switch) după mai multe ținte sondate, fără I/O, comun firmware + unelte host
+#ifndef ALARMA_SIMPLA_POWER_WATCHDOG_H
+#define ALARMA_SIMPLA_POWER_WATCHDOG_H
+
+#include <stdint.h>
+
+// Echipamentele (fiecare pe canalul lui de releu) și țintele sondate (gateway,
+// o gazdă din LAN, un IP public) se descriu în tabele. Fiecare țintă știe prin
+// ce echipamente trece proba (`via`); din țintele căzute și cele care răspund
+// rezultă suspecții:
+//   - suspect = pe drumul unei ținte căzute și pe drumul niciunei ținte vii;
+//   - dintre suspecți, cel care explică cele mai multe ținte căzute (un router
+//     căzut explică și gateway-ul, și IP-ul public, și LAN-ul: un singur ciclu);
+//   - la egalitate, cel din amonte (`upstream`): modemul înaintea routerului;
+//   - dacă după ciclu tot nu merge, urmează echipamentele rămase pe drumurile
+//     căzute (router după modem: WAN-ul routerului nu se reface singur).
+// Un singur echipament e în ciclu la un moment dat (impuls + boot); probele din
+// acest interval nu contează.
+//
+// Ca relay_scheduler.h: fără I/O, același cod pe placă și în
+// tools/power_watchdog_sim.cpp. tick() și dueProbe() fac O(1) pe trecere
+// (un termen de comparat, o țintă verificată); diagnosticul rulează doar
+// după un rezultat nou de probă.
+static const uint8_t POWER_WD_MAX_DEVICES = 8;
+static const uint8_t POWER_WD_MAX_TARGETS = 8;
+static const uint8_t POWER_WD_NONE = 0xFF;
+
+struct PowerDeviceConfig {
+  const char* name;
+  uint8_t upstream;     // de cine depinde (POWER_WD_NONE = nimeni); modemul pentru router
+  bool switchable;      // are releu; altfel doar diagnostic (nu e ales niciodată)
+  uint32_t pulseMs;     // cât stă fără alimentare
+  uint32_t settleMs;    // boot după impuls, înainte ca probele să conteze din nou
+  uint32_t cooldownMs;  // minim între sfârșitul unui ciclu și următorul, același echipament
+};
+
+struct PowerTargetConfig {
+  const char* name;
+  uint8_t via;            // biți: echipamentele prin care trece proba
+  uint8_t failThreshold;  // eșecuri consecutive până la DOWN
+  uint32_t intervalMs;    // 0 = sondată din afară (ping-ul Google existent)
+};
+
+constexpr uint8_t powerDeviceBit(uint8_t d) {
+  return static_cast<uint8_t>(1u << d);
+}
+
+enum class PowerHealth : uint8_t { UNKNOWN, UP, DOWN };
+enum class PowerPhase : uint8_t { IDLE, PULSE, SETTLE };
+
+struct PowerAction {
+  enum Kind : uint8_t { NONE, CUT, RESTORE, SETTLED };
+  Kind kind;
+  uint8_t device;
+};
+
+class PowerWatchdog {
+ public:
+  void begin(const PowerDeviceConfig* devices, uint8_t deviceCount, const PowerTargetConfig* targets, uint8_t targetCount, uint32_t now) {
+    *this = PowerWatchdog();
+    devices_ = devices;
+    targets_ = targets;
+    deviceCount_ = deviceCount > POWER_WD_MAX_DEVICES ? POWER_WD_MAX_DEVICES : deviceCount;
+    targetCount_ = targetCount > POWER_WD_MAX_TARGETS ? POWER_WD_MAX_TARGETS : targetCount;
+    for (uint8_t d = 0; d < deviceCount_; ++d) {
+      // rangul = câte echipamente sunt în amonte (lanț mărginit, deci și un ciclu greșit în tabel se termină)
+      uint8_t up = devices_[d].upstream;
+      while (up < deviceCount_ && rank_[d] < deviceCount_) {
+        ++rank_[d];
+        up = devices_[up].upstream;
+      }
+    }
+    for (uint8_t t = 0; t < targetCount_; ++t) nextProbeMs_[t] = now;
+  }
+
+  // Ținta de sondat acum (cel mult una pe trecere) sau POWER_WD_NONE.
+  uint8_t dueProbe(uint32_t now) {
+    if (phase_ != PowerPhase::IDLE || targetCount_ == 0) return POWER_WD_NONE;
+    const uint8_t t = cursor_;
+    cursor_ = static_cast<uint8_t>((cursor_ + 1) % targetCount_);
+    if (targets_[t].intervalMs == 0 || (int32_t)(now - nextProbeMs_[t]) < 0) return POWER_WD_NONE;
+    nextProbeMs_[t] = now + targets_[t].intervalMs;
+    return t;
+  }
+
+  void probeResult(uint8_t t, bool ok) {
+    if (t >= targetCount_ || phase_ != PowerPhase::IDLE) return;
+    if (ok) {
+      failStreak_[t] = 0;
+      health_[t] = PowerHealth::UP;
+    } else {
+      if (failStreak_[t] < 0xFF) ++failStreak_[t];
+      if (failStreak_[t] >= targets_[t].failThreshold) health_[t] = PowerHealth::DOWN;
+    }
+    dirty_ = true;
+  }
+
+  PowerAction tick(uint32_t now) {
+    if (phase_ == PowerPhase::PULSE) {
+      if ((int32_t)(now - phaseUntilMs_) < 0) return { PowerAction::NONE, POWER_WD_NONE };
+      phase_ = PowerPhase::SETTLE;
+      phaseUntilMs_ = now + devices_[active_].settleMs;
+      // un ciclu pornit din afară (releul routerului, relay_scheduler.h) își oprește singur impulsul
+      return { external_ ? PowerAction::NONE : PowerAction::RESTORE, active_ };
+    }
+    if (phase_ == PowerPhase::SETTLE) {
+      if ((int32_t)(now - phaseUntilMs_) < 0) return { PowerAction::NONE, POWER_WD_NONE };
+      const uint8_t d = active_;
+      phase_ = PowerPhase::IDLE;
+      active_ = POWER_WD_NONE;
+      tried_ |= powerDeviceBit(d);
+      lastCycleEndMs_[d] = now;
+      cycleEnded_ |= powerDeviceBit(d);
+      for (uint8_t t = 0; t < targetCount_; ++t) {
+        health_[t] = PowerHealth::UNKNOWN;
+        failStreak_[t] = 0;
+        nextProbeMs_[t] = now;
+      }
+      dirty_ = false;
+      return { PowerAction::SETTLED, d };
+    }
+    if (!dirty_) return { PowerAction::NONE, POWER_WD_NONE };
+    dirty_ = false;
+
+    uint8_t failing = 0, healthy = 0, unknown = 0, down = 0;
+    for (uint8_t t = 0; t < targetCount_; ++t) {
+      const uint8_t via = targets_[t].via;
+      if (health_[t] == PowerHealth::DOWN) {
+        failing |= via;
+        ++down;
+      } else if (health_[t] == PowerHealth::UP && failStreak_[t] == 0) {
+        healthy |= via;  // un UP cu eșecuri recente nu mai dezvinovățește pe nimeni
+      } else {
+        unknown |= via;
+      }
+    }
+    if (down == 0) {
+      if (unknown == 0) tried_ = 0;  // toate țintele răspund: incidentul s-a închis
+      return { PowerAction::NONE, POWER_WD_NONE };
+    }
+    // fără decizie până nu se știe starea tuturor țintelor care împart un echipament cu cele căzute
+    if (unknown & failing) return { PowerAction::NONE, POWER_WD_NONE };
+
+    const uint8_t d = pick(now, failing, healthy);
+    if (d == POWER_WD_NONE) return { PowerAction::NONE, POWER_WD_NONE };
+    phase_ = PowerPhase::PULSE;
+    active_ = d;
+    external_ = false;
+    phaseUntilMs_ = now + devices_[d].pulseMs;
+    ++cycles_[d];
+    return { PowerAction::CUT, d };
+  }
+
+  // Ciclu pornit de altcineva pe canalul unui echipament (ex. routerul la WiFi
+  // căzut): nu se suprapune alt ciclu peste el, iar probele așteaptă boot-ul.
+  void noteExternalCycle(uint8_t d, uint32_t now) {
+    if (d >= deviceCount_) return;
+    ++cycles_[d];
+    if (phase_ != PowerPhase::IDLE && active_ != d) return;
+    phase_ = PowerPhase::PULSE;
+    active_ = d;
+    external_ = true;
+    phaseUntilMs_ = now + devices_[d].pulseMs;
+  }
+
+  PowerPhase phase() const { return phase_; }
+  uint8_t activeDevice() const { return active_; }
+  uint32_t phaseRemainingMs(uint32_t now) const { return phase_ == PowerPhase::IDLE ? 0 : phaseUntilMs_ - now; }
+  PowerHealth health(uint8_t t) const { return health_[t]; }
+  uint32_t cycles(uint8_t d) const { return cycles_[d]; }
+  uint8_t triedMask() const { return tried_; }
+  uint8_t deviceCount() const { return deviceCount_; }
+  uint8_t targetCount() const { return targetCount_; }
+  const PowerDeviceConfig& device(uint8_t d) const { return devices_[d]; }
+  const PowerTargetConfig& target(uint8_t t) const { return targets_[t]; }
+
+ private:
+  bool ready(uint8_t d, uint32_t now) const {
+    if (!devices_[d].switchable) return false;
+    return !(cycleEnded_ & powerDeviceBit(d)) || now - lastCycleEndMs_[d] >= devices_[d].cooldownMs;
+  }
+
+  uint8_t coverage(uint8_t d) const {
+    uint8_t n = 0;
+    for (uint8_t t = 0; t < targetCount_; ++t) {
+      if (health_[t] == PowerHealth::DOWN && (targets_[t].via & powerDeviceBit(d))) ++n;
+    }
+    return n;
+  }
+
+  uint8_t best(uint8_t candidates) const {
+    uint8_t bestD = POWER_WD_NONE, bestCover = 0;
+    for (uint8_t d = 0; d < deviceCount_; ++d) {
+      if (!(candidates & powerDeviceBit(d))) continue;
+      const uint8_t c = coverage(d);
+      if (bestD == POWER_WD_NONE || c > bestCover || (c == bestCover && rank_[d] < rank_[bestD])) {
+        bestD = d;
+        bestCover = c;
+      }
+    }
+    return bestD;
+  }
+
+  uint8_t pick(uint32_t now, uint8_t failing, uint8_t healthy) {
+    uint8_t switchable = 0, usable = 0;
+    for (uint8_t d = 0; d < deviceCount_; ++d) {
+      if (!devices_[d].switchable) continue;
+      switchable |= powerDeviceBit(d);
+      if (ready(d, now)) usable |= powerDeviceBit(d);
+    }
+    failing &= switchable;
+    if (failing == 0) return POWER_WD_NONE;
+    // 1) suspecții neîncercați; 2) restul drumurilor căzute, neîncercate
+    uint8_t cand = failing & ~healthy & ~tried_;
+    if (cand == 0) cand = failing & ~tried_;
+    if (cand != 0) return best(cand & usable);  // NONE dacă sunt în cooldown: se așteaptă
+    // 3) toate încercate și tot cade (ex. ISP căzut): runda următoare, abia când
+    //    toate au ieșit din cooldown, ca o pană lungă să nu țină releele în buclă
+    if (failing & ~usable) return POWER_WD_NONE;
+    tried_ = 0;
+    cand = failing & ~healthy;
+    return best(cand != 0 ? cand : failing);
+  }
+
+  const PowerDeviceConfig* devices_ = nullptr;
+  const PowerTargetConfig* targets_ = nullptr;
+  uint8_t deviceCount_ = 0;
+  uint8_t targetCount_ = 0;
+  uint8_t rank_[POWER_WD_MAX_DEVICES] = {};
+  uint32_t cycles_[POWER_WD_MAX_DEVICES] = {};
+  uint32_t lastCycleEndMs_[POWER_WD_MAX_DEVICES] = {};
+  uint8_t cycleEnded_ = 0;
+  uint32_t nextProbeMs_[POWER_WD_MAX_TARGETS] = {};
+  uint8_t failStreak_[POWER_WD_MAX_TARGETS] = {};
+  PowerHealth health_[POWER_WD_MAX_TARGETS] = {};
+  PowerPhase phase_ = PowerPhase::IDLE;
+  uint8_t active_ = POWER_WD_NONE;
+  bool external_ = false;
+  bool dirty_ = false;
+  uint8_t tried_ = 0;
+  uint8_t cursor_ = 0;
+  uint32_t phaseUntilMs_ = 0;
+};
+
+#endif  // ALARMA_SIMPLA_POWER_WATCHDOG_H
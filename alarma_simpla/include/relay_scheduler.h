@@ -0,0 +1,137 @@
+// relay_scheduler.h — decizia releului de internet (power-cycle router), fără I/O
+#ifndef ALARMA_SIMPLA_RELAY_SCHEDULER_H
+#define ALARMA_SIMPLA_RELAY_SCHEDULER_H
+
+#include <stdint.h>
+
+// Funcții pure peste RelayScheduler: primesc timpul trecerii prin loop() și
+// intrările (WiFi, rezultat ping) și întorc deciziile luate (RELAY_DECISION_*).
+// Firmware-ul face log/print pe baza lor; tools/trace_replay.cpp rulează
+// exact același cod peste o urmă înregistrată pe placă.
+static const uint32_t INTERNET_RELAY_PULSE_MS = 10'000;
+static const uint32_t INTERNET_RELAY_COOLDOWN_MS = 60'000;
+
+// Ca AlarmTimings: firmware-ul folosește valorile de mai sus (argumentul
+// implicit), tools/param_sweep.cpp trece alte perechi prin același cod.
+struct RelayTimings {
+  uint32_t pulseMs;
+  uint32_t cooldownMs;
+};
+
+static constexpr RelayTimings RELAY_TIMINGS = { INTERNET_RELAY_PULSE_MS, INTERNET_RELAY_COOLDOWN_MS };
+
+struct RelayScheduler {
+  uint32_t cutUntilMs;
+  uint32_t nextAllowedMs;
+  uint32_t wifiDisconnectedSinceMs;
+  uint32_t unlockMs;  // până atunci releul rămâne OFF (holdoff la pornire)
+  uint32_t activationCount;
+  bool cutActive;     // D2 activ (router fără alimentare)
+  bool pingDownActive;
+  bool wifiWasConnected;
+  bool pingDelegated;  // ping căzut => doar PING_DOWN; ce se restartează decide power_watchdog.h
+};
+
+static const uint8_t RELAY_DECISION_NONE = 0;
+static const uint8_t RELAY_DECISION_WIFI_DOWN = 1 << 0;
+static const uint8_t RELAY_DECISION_WIFI_UP = 1 << 1;
+static const uint8_t RELAY_DECISION_FORCED_INACTIVE = 1 << 2;
+static const uint8_t RELAY_DECISION_DEACTIVATED = 1 << 3;
+static const uint8_t RELAY_DECISION_ACTIVATED = 1 << 4;
+static const uint8_t RELAY_DECISION_PING_DOWN = 1 << 5;
+
+inline uint8_t relayActivate(RelayScheduler& rs, uint32_t now, const RelayTimings& t = RELAY_TIMINGS) {
+  ++rs.activationCount;
+  rs.cutActive = true;
+  rs.cutUntilMs = now + t.pulseMs;
+  rs.nextAllowedMs = now + t.pulseMs + t.cooldownMs;
+  return RELAY_DECISION_ACTIVATED;
+}
+
+inline void relayClear(RelayScheduler& rs) {
+  rs.cutActive = false;
+  rs.cutUntilMs = 0;
+  rs.nextAllowedMs = 0;
+}
+
+inline uint8_t relayTrackWifi(RelayScheduler& rs, uint32_t now, bool wifiConnected) {
+  uint8_t d = RELAY_DECISION_NONE;
+  if (rs.wifiWasConnected && !wifiConnected) {
+    if (rs.wifiDisconnectedSinceMs == 0) rs.wifiDisconnectedSinceMs = now;
+    d = RELAY_DECISION_WIFI_DOWN;
+  } else if (!rs.wifiWasConnected && wifiConnected) {
+    d = RELAY_DECISION_WIFI_UP;
+  }
+  rs.wifiWasConnected = wifiConnected;
+  return d;
+}
+
+// WiFi + ping OK => releul nu are ce căuta activ.
+inline uint8_t relayEnforceOffWhenConnected(RelayScheduler& rs, bool wifiConnected) {
+  if (!wifiConnected || rs.pingDownActive || rs.pingDelegated) return RELAY_DECISION_NONE;
+  if (!rs.cutActive && rs.cutUntilMs == 0) return RELAY_DECISION_NONE;
+  relayClear(rs);
+  return RELAY_DECISION_FORCED_INACTIVE;
+}
+
+inline uint8_t relayPulseUpdate(RelayScheduler& rs, uint32_t now) {
+  if (!rs.cutActive || rs.cutUntilMs == 0) return RELAY_DECISION_NONE;
+  if ((int32_t)(now - rs.cutUntilMs) < 0) return RELAY_DECISION_NONE;
+  rs.cutActive = false;
+  rs.cutUntilMs = 0;
+  return RELAY_DECISION_DEACTIVATED;
+}
+
+// WiFi căzut: impuls imediat, apoi câte un impuls după fiecare cooldown.
+inline uint8_t relayWifiRetry(RelayScheduler& rs, uint32_t now, bool wifiConnected, const RelayTimings& t = RELAY_TIMINGS) {
+  if ((int32_t)(now - rs.unlockMs) < 0) {
+    // holdoff la pornire: releu OFF, scheduler resetat
+    relayClear(rs);
+    rs.wifiDisconnectedSinceMs = 0;
+    return RELAY_DECISION_NONE;
+  }
+  if (wifiConnected) {
+    rs.wifiDisconnectedSinceMs = 0;
+    rs.nextAllowedMs = 0;
+    return RELAY_DECISION_NONE;
+  }
+  if (rs.wifiDisconnectedSinceMs == 0) {
+    rs.wifiDisconnectedSinceMs = now;
+    return rs.cutActive ? RELAY_DECISION_NONE : relayActivate(rs, now, t);
+  }
+  if (rs.cutActive) return RELAY_DECISION_NONE;
+  if (rs.nextAllowedMs == 0) {
+    rs.nextAllowedMs = now + t.cooldownMs;
+    return RELAY_DECISION_NONE;
+  }
+  if ((int32_t)(now - rs.nextAllowedMs) < 0) return RELAY_DECISION_NONE;
+  return relayActivate(rs, now, t);
+}
+
+// Pașii de la începutul fiecărei treceri prin loop(), în ordinea din firmware.
+inline uint8_t relayLoopStep(RelayScheduler& rs, uint32_t now, bool wifiConnected, const RelayTimings& t = RELAY_TIMINGS) {
+  uint8_t d = relayTrackWifi(rs, now, wifiConnected);
+  d |= relayEnforceOffWhenConnected(rs, wifiConnected);
+  d |= relayPulseUpdate(rs, now);
+  d |= relayWifiRetry(rs, now, wifiConnected, t);
+  return d;
+}
+
+inline uint8_t relayPingResult(RelayScheduler& rs, uint32_t now, bool ok, const RelayTimings& t = RELAY_TIMINGS) {
+  if (ok) {
+    rs.pingDownActive = false;
+    if (!rs.pingDelegated) relayClear(rs);
+    return RELAY_DECISION_NONE;
+  }
+  uint8_t d = RELAY_DECISION_NONE;
+  if (!rs.pingDownActive) {
+    rs.pingDownActive = true;
+    d |= RELAY_DECISION_PING_DOWN;
+  }
+  if (!rs.pingDelegated && !rs.cutActive && (int32_t)(now - rs.nextAllowedMs) >= 0) {
+    d |= relayActivate(rs, now, t);
+  }
+  return d;
+}
+
+#endif  // ALARMA_SIMPLA_RELAY_SCHEDULER_H
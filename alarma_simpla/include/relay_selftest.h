@@ -0,0 +1,39 @@
+// relay_selftest.h — testul releelor de la pornire ca o corutină (coroutine.h), fără I/O, comun firmware + unelte host
+#ifndef ALARMA_SIMPLA_RELAY_SELFTEST_H
+#define ALARMA_SIMPLA_RELAY_SELFTEST_H
+
+#include <stdint.h>
+
+#include "coroutine.h"
+
+// RELAY1 ON/OFF x2, apoi RELAY2 ON/OFF x2, câte stepMs fiecare pas. Corutina
+// doar pune relayOn[]; firmware-ul le suprapune (OR) peste comanda normală a
+// releelor, iar tools/coroutine_bench.cpp rulează exact aceeași secvență
+// alături de monitorizarea PIR-urilor.
+static const uint8_t RELAY_SELFTEST_RELAYS = 2;
+static const uint8_t RELAY_SELFTEST_PULSES = 2;
+
+constexpr uint32_t relaySelfTestDurationMs(uint32_t stepMs) {
+  return static_cast<uint32_t>(RELAY_SELFTEST_RELAYS) * RELAY_SELFTEST_PULSES * 2 * stepMs;
+}
+
+struct RelaySelfTest : Coroutine {
+  uint8_t relay = 0;
+  uint8_t pulse = 0;
+  bool relayOn[RELAY_SELFTEST_RELAYS] = {};
+};
+
+inline CoStatus relaySelfTestRun(RelaySelfTest& co, uint32_t now, uint32_t stepMs) {
+  CO_BEGIN(co);
+  for (co.relay = 0; co.relay < RELAY_SELFTEST_RELAYS; ++co.relay) {
+    for (co.pulse = 0; co.pulse < RELAY_SELFTEST_PULSES; ++co.pulse) {
+      co.relayOn[co.relay] = true;
+      CO_AWAIT_MS(co, now, stepMs);
+      co.relayOn[co.relay] = false;
+      CO_AWAIT_MS(co, now, stepMs);
+    }
+  }
+  CO_END(co);
+}
+
+#endif  // ALARMA_SIMPLA_RELAY_SELFTEST_H
@@ -0,0 +1,55 @@
+// seqlock.h — sequence lock: un singur scriitor, cititori care nu îl blochează niciodată
+#ifndef ALARMA_SIMPLA_SEQLOCK_H
+#define ALARMA_SIMPLA_SEQLOCK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Scriitorul modifică valoarea pe loc între beginWrite()/endWrite(); contorul
+// e impar cât timp scrierea e în curs. Un cititor copiază valoarea și o acceptă
+// doar dacă contorul era par și nu s-a schimbat între timp, deci nu vede
+// niciodată o stare pe jumătate scrisă. Cititorul nu așteaptă: tryRead() întoarce
+// false (de exemplu într-un callback care a întrerupt scriitorul) și încearcă
+// data viitoare. Copia se face pe cuvinte de 32 biți cu load-uri atomice
+// relaxed (pe ESP8266: load-uri simple + `memw` pentru fence-uri).
+template <typename T>
+class SeqLocked {
+  static_assert(sizeof(T) % 4 == 0 && alignof(T) >= 4, "SeqLocked copies 32-bit words");
+
+ public:
+  // Doar contextul scriitor (loop()) folosește referința direct.
+  T& value() { return value_; }
+  const T& value() const { return value_; }
+
+  void beginWrite() {
+    const uint32_t s = __atomic_load_n(&seq_, __ATOMIC_RELAXED);
+    __atomic_store_n(&seq_, s + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+  }
+
+  void endWrite() {
+    const uint32_t s = __atomic_load_n(&seq_, __ATOMIC_RELAXED);
+    __atomic_store_n(&seq_, s + 1, __ATOMIC_RELEASE);
+  }
+
+  bool writing() const { return (__atomic_load_n(&seq_, __ATOMIC_RELAXED) & 1u) != 0; }
+  uint32_t sequence() const { return __atomic_load_n(&seq_, __ATOMIC_ACQUIRE); }
+
+  bool tryRead(T* out) const {
+    const uint32_t s0 = __atomic_load_n(&seq_, __ATOMIC_ACQUIRE);
+    if (s0 & 1u) return false;
+    const Word* src = reinterpret_cast<const Word*>(&value_);
+    Word* dst = reinterpret_cast<Word*>(out);
+    for (size_t i = 0; i < sizeof(T) / 4; ++i) dst[i] = __atomic_load_n(src + i, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&seq_, __ATOMIC_RELAXED) == s0;
+  }
+
+ private:
+  typedef uint32_t __attribute__((__may_alias__)) Word;
+
+  T value_ = {};
+  uint32_t seq_ = 0;
+};
+
+#endif  // ALARMA_SIMPLA_SEQLOCK_H
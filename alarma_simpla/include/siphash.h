@@ -0,0 +1,69 @@
+// siphash.h — SipHash-2-4 (MAC de 64 biți cu cheie de 128 biți), folosit de firmware și de uneltele host
+#ifndef ALARMA_SIMPLA_SIPHASH_H
+#define ALARMA_SIMPLA_SIPHASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Aumasson & Bernstein, varianta de referință (2 runde pe bloc, 4 la final).
+// Pentru mesaje scurte (zeci de bytes) e mult mai ieftin decât HMAC-SHA256 pe
+// ESP8266 și nu are nevoie de tabele. Octeții se citesc little-endian,
+// independent de platformă.
+static const size_t SIPHASH_KEY_BYTES = 16;
+
+inline uint64_t siphashLoad64(const uint8_t* p) {
+  uint64_t v = 0;
+  for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+  return v;
+}
+
+inline uint64_t siphashRotl(uint64_t x, int b) {
+  return (x << b) | (x >> (64 - b));
+}
+
+inline void siphashRound(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+  v0 += v1;
+  v1 = siphashRotl(v1, 13);
+  v1 ^= v0;
+  v0 = siphashRotl(v0, 32);
+  v2 += v3;
+  v3 = siphashRotl(v3, 16);
+  v3 ^= v2;
+  v0 += v3;
+  v3 = siphashRotl(v3, 21);
+  v3 ^= v0;
+  v2 += v1;
+  v1 = siphashRotl(v1, 17);
+  v1 ^= v2;
+  v2 = siphashRotl(v2, 32);
+}
+
+inline uint64_t siphash24(const uint8_t key[SIPHASH_KEY_BYTES], const uint8_t* data, size_t len) {
+  const uint64_t k0 = siphashLoad64(key);
+  const uint64_t k1 = siphashLoad64(key + 8);
+  uint64_t v0 = 0x736f6d6570736575ull ^ k0;
+  uint64_t v1 = 0x646f72616e646f6dull ^ k1;
+  uint64_t v2 = 0x6c7967656e657261ull ^ k0;
+  uint64_t v3 = 0x7465646279746573ull ^ k1;
+
+  const size_t full = len & ~static_cast<size_t>(7);
+  for (size_t i = 0; i < full; i += 8) {
+    const uint64_t m = siphashLoad64(data + i);
+    v3 ^= m;
+    siphashRound(v0, v1, v2, v3);
+    siphashRound(v0, v1, v2, v3);
+    v0 ^= m;
+  }
+  uint64_t last = static_cast<uint64_t>(len) << 56;
+  for (size_t i = full; i < len; ++i) last |= static_cast<uint64_t>(data[i]) << (8 * (i - full));
+  v3 ^= last;
+  siphashRound(v0, v1, v2, v3);
+  siphashRound(v0, v1, v2, v3);
+  v0 ^= last;
+
+  v2 ^= 0xff;
+  for (int i = 0; i < 4; ++i) siphashRound(v0, v1, v2, v3);
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+#endif  // ALARMA_SIMPLA_SIPHASH_H
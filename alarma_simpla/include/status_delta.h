@@ -0,0 +1,271 @@
+// status_delta.h — raport de status incremental (doar câmpurile schimbate), comun firmware + unelte host
+#ifndef ALARMA_SIMPLA_STATUS_DELTA_H
+#define ALARMA_SIMPLA_STATUS_DELTA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "crc32.h"
+
+// O linie per raport:
+//   [STATUS] seq=<n> K up=<s> alarm=ARMED p1=ARMED ... (keyframe: toate câmpurile)
+//   [STATUS] seq=<n> D up=<s> heap=30912 rssi=-63        (delta: doar ce s-a schimbat)
+// seq crește cu 1 la fiecare raport; un gol în seq înseamnă o linie pierdută și
+// consumatorul ignoră delta-urile până la următorul keyframe. La boot seq pornește
+// de la 0, care e mereu keyframe. Valorile cu spații, ghilimele sau '=' sunt puse
+// între ghilimele ("..." cu \" și \\); "-" = câmp indisponibil acum.
+//
+// Câmpurile se adaugă doar la sfârșit (cheia e cea din log, nu indexul).
+#define STATUS_FIELDS(X) \
+  X(ALARM, "alarm") \
+  X(P1, "p1") \
+  X(P1_TIMER, "p1_timer") \
+  X(P2, "p2") \
+  X(P2_TIMER, "p2_timer") \
+  X(P3, "p3") \
+  X(P3_TIMER, "p3_timer") \
+  X(P4, "p4") \
+  X(P4_TIMER, "p4_timer") \
+  X(TRIGGERS, "triggers") \
+  X(RELAY, "relay") \
+  X(PING_DOWN, "ping_down") \
+  X(PING_DOWN_START, "ping_down_start") \
+  X(WIFI, "wifi") \
+  X(WIFI_EMULATION, "wifi_emul") \
+  X(IP, "ip") \
+  X(GATEWAY, "gw") \
+  X(DNS, "dns") \
+  X(RSSI, "rssi") \
+  X(SSID, "ssid") \
+  X(CHANNEL, "ch") \
+  X(LAST_CONNECT, "connect") \
+  X(LAST_DISCONNECT, "last_disc") \
+  X(WIFI_DOWN_FOR, "wifi_down_for") \
+  X(PING_COUNTER, "pings") \
+  X(PING_INTERVAL, "ping_ms") \
+  X(NTP_STARTED, "ntp_started") \
+  X(NTP_READY, "ntp_ready") \
+  X(FREE_HEAP, "heap") \
+  X(OTA, "ota") \
+  X(CONSOLE_CLIENTS, "console") \
+  X(CONSOLE_DROPPED, "console_drop") \
+  X(TRACE_BYTES, "trace_b") \
+  X(TRACE_SAVED, "trace_saved") \
+  X(HTTPS_REQUESTS, "https_req") \
+  X(HTTPS_FAILURES, "https_fail") \
+  X(HTTPS_RESUMED, "https_resumed") \
+  X(CHIP_ID, "chip")
+
+enum class StatusField : uint8_t {
+#define STATUS_ENUM_ENTRY(id, key) id,
+  STATUS_FIELDS(STATUS_ENUM_ENTRY)
+#undef STATUS_ENUM_ENTRY
+};
+
+#define STATUS_COUNT_ENTRY(id, key) +1
+static const uint8_t STATUS_FIELD_COUNT = 0 STATUS_FIELDS(STATUS_COUNT_ENTRY);
+#undef STATUS_COUNT_ENTRY
+
+static const char* const STATUS_FIELD_KEYS[STATUS_FIELD_COUNT] = {
+#define STATUS_KEY_ENTRY(id, key) key,
+  STATUS_FIELDS(STATUS_KEY_ENTRY)
+#undef STATUS_KEY_ENTRY
+};
+
+static const char STATUS_LINE_PREFIX[] = "[STATUS] seq=";
+static const size_t STATUS_VALUE_MAX = 40;  // inclusiv terminatorul; valorile mai lungi se taie
+
+typedef void (*StatusDeltaSink)(void* ctx, const char* text);
+
+// "heap=30912" / "ssid=\"Casa 2G\"" în out (mereu terminat cu 0).
+inline void statusFormatPair(char* out, size_t outSize, const char* key, const char* value) {
+  size_t n = static_cast<size_t>(snprintf(out, outSize, " %s=", key));
+  if (n >= outSize) return;
+  bool quote = value[0] == '\0';
+  for (const char* p = value; *p && !quote; ++p) quote = *p == ' ' || *p == '"' || *p == '=' || *p == '\\';
+  if (quote && n + 1 < outSize) out[n++] = '"';
+  for (const char* p = value; *p && (p - value) < static_cast<ptrdiff_t>(STATUS_VALUE_MAX - 1); ++p) {
+    const bool escape = quote && (*p == '"' || *p == '\\');
+    if (n + (escape ? 2 : 1) + (quote ? 1 : 0) >= outSize) break;
+    if (escape) out[n++] = '\\';
+    out[n++] = *p;
+  }
+  if (quote) out[n++] = '"';
+  out[n] = '\0';
+}
+
+// Emițătorul ține doar un CRC32 per câmp (nu valoarea), deci ~4 B per câmp în DRAM.
+class StatusDeltaEncoder {
+ public:
+  explicit StatusDeltaEncoder(uint16_t keyframeEvery) : keyframeEvery_(keyframeEvery ? keyframeEvery : 1) {}
+
+  // Următorul raport va fi keyframe (client nou, schimbare de mod etc.).
+  void requestKeyframe() { keyframePending_ = true; }
+  uint32_t nextSeq() const { return seq_; }
+
+  void begin(uint32_t uptimeSec, StatusDeltaSink sink, void* ctx) {
+    sink_ = sink;
+    ctx_ = ctx;
+    keyframe_ = keyframePending_ || (seq_ % keyframeEvery_) == 0;
+    keyframePending_ = false;
+    emitted_ = 0;
+    char head[48];
+    snprintf(head, sizeof(head), "%s%lu %c up=%lu", STATUS_LINE_PREFIX, static_cast<unsigned long>(seq_), keyframe_ ? 'K' : 'D',
+             static_cast<unsigned long>(uptimeSec));
+    sink_(ctx_, head);
+  }
+
+  void put(StatusField f, const char* value) {
+    const uint8_t i = static_cast<uint8_t>(f);
+    if (i >= STATUS_FIELD_COUNT) return;
+    const size_t len = strnlen(value, STATUS_VALUE_MAX - 1);
+    const uint32_t crc = crc32Update(0, reinterpret_cast<const uint8_t*>(value), len);
+    if (!keyframe_ && crc == crc_[i]) return;
+    crc_[i] = crc;
+    char pair[24 + 2 * STATUS_VALUE_MAX];
+    statusFormatPair(pair, sizeof(pair), STATUS_FIELD_KEYS[i], value);
+    sink_(ctx_, pair);
+    ++emitted_;
+  }
+
+  void put(StatusField f, long value) {
+    char buf[12];
+    snprintf(buf, sizeof(buf), "%ld", value);
+    put(f, buf);
+  }
+
+  void put(StatusField f, unsigned long value) {
+    char buf[12];
+    snprintf(buf, sizeof(buf), "%lu", value);
+    put(f, buf);
+  }
+
+  void put(StatusField f, int value) { put(f, static_cast<long>(value)); }
+  void put(StatusField f, unsigned value) { put(f, static_cast<unsigned long>(value)); }
+  void put(StatusField f, bool value) { put(f, value ? "YES" : "NO"); }
+
+  // Linia nu include terminatorul; apelantul trece la rând nou.
+  uint8_t end() {
+    ++seq_;
+    return emitted_;
+  }
+
+  bool lastWasKeyframe() const { return keyframe_; }
+
+ private:
+  uint32_t crc_[STATUS_FIELD_COUNT] = {};
+  uint32_t seq_ = 0;
+  uint16_t keyframeEvery_;
+  uint8_t emitted_ = 0;
+  bool keyframe_ = true;
+  bool keyframePending_ = true;
+  StatusDeltaSink sink_ = nullptr;
+  void* ctx_ = nullptr;
+};
+
+enum class StatusDeltaResult : uint8_t {
+  NOT_STATUS,  // altă linie din log
+  KEYFRAME,    // stare reconstruită complet
+  DELTA,       // aplicat peste starea curentă
+  SKIPPED,     // delta după un gol în seq sau înainte de primul keyframe
+  MALFORMED,
+};
+
+// Consumatorul: reface starea completă din linii [STATUS]. Ține valorile (host).
+class StatusDeltaDecoder {
+ public:
+  StatusDeltaResult feed(const char* line) {
+    const size_t prefix = sizeof(STATUS_LINE_PREFIX) - 1;
+    if (strncmp(line, STATUS_LINE_PREFIX, prefix) != 0) return StatusDeltaResult::NOT_STATUS;
+    const char* p = line + prefix;
+    char* end = nullptr;
+    const unsigned long seq = strtoul(p, &end, 10);
+    if (end == p || end[0] != ' ' || (end[1] != 'K' && end[1] != 'D') || end[2] != ' ') return StatusDeltaResult::MALFORMED;
+    const bool keyframe = end[1] == 'K';
+    p = end + 3;
+    if (strncmp(p, "up=", 3) != 0) return StatusDeltaResult::MALFORMED;
+    const unsigned long up = strtoul(p + 3, &end, 10);
+    p = end;
+
+    const bool inOrder = synced_ && seq == static_cast<unsigned long>(lastSeq_ + 1);
+    if (!keyframe && !inOrder) {
+      if (synced_) ++gaps_;
+      synced_ = false;
+      return StatusDeltaResult::SKIPPED;
+    }
+    if (synced_ && !inOrder) ++gaps_;
+
+    // Parsăm într-o copie; starea se schimbă doar dacă toată linia e validă.
+    char next[STATUS_FIELD_COUNT][STATUS_VALUE_MAX];
+    bool nextKnown[STATUS_FIELD_COUNT];
+    if (keyframe) {
+      memset(next, 0, sizeof(next));
+      memset(nextKnown, 0, sizeof(nextKnown));
+    } else {
+      memcpy(next, values_, sizeof(next));
+      memcpy(nextKnown, known_, sizeof(nextKnown));
+    }
+    while (*p == ' ') {
+      ++p;
+      const char* eq = strchr(p, '=');
+      if (eq == nullptr) return StatusDeltaResult::MALFORMED;
+      int field = -1;
+      for (uint8_t i = 0; i < STATUS_FIELD_COUNT; ++i) {
+        if (strlen(STATUS_FIELD_KEYS[i]) == static_cast<size_t>(eq - p) && strncmp(STATUS_FIELD_KEYS[i], p, eq - p) == 0) field = i;
+      }
+      p = eq + 1;
+      char value[STATUS_VALUE_MAX];
+      size_t n = 0;
+      if (*p == '"') {
+        ++p;
+        while (*p && *p != '"') {
+          if (*p == '\\' && p[1]) ++p;
+          if (n + 1 < sizeof(value)) value[n++] = *p;
+          ++p;
+        }
+        if (*p != '"') return StatusDeltaResult::MALFORMED;
+        ++p;
+      } else {
+        while (*p && *p != ' ' && *p != '\r' && *p != '\n') {
+          if (n + 1 < sizeof(value)) value[n++] = *p;
+          ++p;
+        }
+      }
+      value[n] = '\0';
+      // chei necunoscute = firmware mai nou; le sărim
+      if (field < 0) continue;
+      memcpy(next[field], value, n + 1);
+      nextKnown[field] = true;
+    }
+    if (*p != '\0' && *p != '\r' && *p != '\n') return StatusDeltaResult::MALFORMED;
+
+    memcpy(values_, next, sizeof(values_));
+    memcpy(known_, nextKnown, sizeof(known_));
+    lastSeq_ = static_cast<uint32_t>(seq);
+    uptimeSec_ = static_cast<uint32_t>(up);
+    synced_ = true;
+    return keyframe ? StatusDeltaResult::KEYFRAME : StatusDeltaResult::DELTA;
+  }
+
+  bool synced() const { return synced_; }
+  uint32_t lastSeq() const { return lastSeq_; }
+  uint32_t uptimeSec() const { return uptimeSec_; }
+  uint32_t gaps() const { return gaps_; }
+  // nullptr dacă valoarea nu a apărut în ultimul keyframe / delta-urile de după
+  const char* value(StatusField f) const {
+    const uint8_t i = static_cast<uint8_t>(f);
+    return i < STATUS_FIELD_COUNT && known_[i] ? values_[i] : nullptr;
+  }
+
+ private:
+  char values_[STATUS_FIELD_COUNT][STATUS_VALUE_MAX] = {};
+  bool known_[STATUS_FIELD_COUNT] = {};
+  uint32_t lastSeq_ = 0;
+  uint32_t uptimeSec_ = 0;
+  uint32_t gaps_ = 0;
+  bool synced_ = false;
+};
+
+#endif  // ALARMA_SIMPLA_STATUS_DELTA_H
@@ -0,0 +1,142 @@
+// supervisor.h — deadline-urile task-urilor din loop() și imaginea RTC scrisă de tickerul supervizorului, fără I/O, comun firmware + unelte host
+#ifndef ALARMA_SIMPLA_SUPERVISOR_H
+#define ALARMA_SIMPLA_SUPERVISOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "alarm_fsm.h"
+#include "crc32.h"
+#include "seqlock.h"
+#include "system_state.h"
+
+struct SupervisedTaskInfo {
+  const char* name;
+  uint32_t deadlineMs;
+};
+
+enum class CrashCause : uint8_t { NONE,
+                                  SUPERVISOR_TIMEOUT };
+
+static const uint32_t CRASH_CONTEXT_MAGIC = 0xA1A2C0DE;
+static const uint32_t RELAY_SCHEDULER_RTC_MAGIC = 0xA1A2B0B0;
+static const uint8_t SUPERVISOR_NO_TASK = 0xFF;
+
+// MAX_PARTITIONS = spațiul rezervat în RTC (ALARM_PARTITION_MAX), nu numărul folosit.
+template <uint8_t MAX_PARTITIONS>
+struct CrashContextT {
+  uint32_t magic;
+  uint32_t crc;  // CRC32 peste câmpurile de după el
+  uint32_t uptimeMs;
+  uint32_t freeHeap;
+  uint32_t bootCount;
+  uint8_t alarmState;  // rezumatul partițiilor
+  uint8_t stage;
+  uint8_t cause;
+  uint8_t task;
+  uint8_t partitionState[MAX_PARTITIONS];
+  uint8_t partitionMode[MAX_PARTITIONS];
+};
+
+// Contorul de activări și cooldown-ul rămas al releului de internet.
+struct RelaySchedulerRtc {
+  uint32_t magic;
+  uint32_t crc;
+  uint32_t activationCount;
+  uint32_t cooldownRemainingMs;
+};
+static_assert(sizeof(RelaySchedulerRtc) % 4 == 0, "RTC user memory is word addressed");
+
+template <uint8_t M>
+inline uint32_t crashContextCrc(const CrashContextT<M>& ctx) {
+  const uint8_t* body = reinterpret_cast<const uint8_t*>(&ctx.uptimeMs);
+  return crc32Update(0, body, sizeof(ctx) - offsetof(CrashContextT<M>, uptimeMs));
+}
+
+template <uint8_t M>
+inline bool crashContextValid(const CrashContextT<M>& ctx) {
+  return ctx.magic == CRASH_CONTEXT_MAGIC && ctx.crc == crashContextCrc(ctx);
+}
+
+inline uint32_t relaySchedulerCrc(const RelaySchedulerRtc& rec) {
+  const uint8_t* body = reinterpret_cast<const uint8_t*>(&rec.activationCount);
+  return crc32Update(0, body, sizeof(rec) - offsetof(RelaySchedulerRtc, activationCount));
+}
+
+inline bool relaySchedulerRtcValid(const RelaySchedulerRtc& rec) {
+  return rec.magic == RELAY_SCHEDULER_RTC_MAGIC && rec.crc == relaySchedulerCrc(rec);
+}
+
+// Primul task care nu a mai făcut check-in în deadline-ul lui, sau SUPERVISOR_NO_TASK.
+inline uint8_t supervisorOverdueTask(uint32_t now, const uint32_t* checkInMs, const SupervisedTaskInfo* tasks, uint8_t count) {
+  for (uint8_t i = 0; i < count; ++i) {
+    if ((now - checkInMs[i]) > tasks[i].deadlineMs) return i;
+  }
+  return SUPERVISOR_NO_TASK;
+}
+
+template <uint8_t M, uint8_t P>
+inline void crashContextCapture(CrashContextT<M>* ctx, CrashCause cause, uint8_t task, uint8_t stage, const SystemStateT<P>& snap, uint32_t uptimeMs, uint32_t freeHeap, uint32_t bootCount) {
+  static_assert(P <= M, "partition count exceeds the RTC area");
+  *ctx = {};
+  ctx->magic = CRASH_CONTEXT_MAGIC;
+  ctx->uptimeMs = uptimeMs;
+  ctx->freeHeap = freeHeap;
+  ctx->bootCount = bootCount;
+  ctx->alarmState = static_cast<uint8_t>(snap.alarmState);
+  for (uint8_t i = 0; i < P; ++i) {
+    ctx->partitionState[i] = static_cast<uint8_t>(snap.partitions[i].state);
+    ctx->partitionMode[i] = static_cast<uint8_t>(snap.partitions[i].armedMode);
+  }
+  ctx->stage = stage;
+  ctx->cause = static_cast<uint8_t>(cause);
+  ctx->task = task;
+  ctx->crc = crashContextCrc(*ctx);
+}
+
+inline void relaySchedulerRtcCapture(RelaySchedulerRtc* rec, const RelayScheduler& relay, uint32_t now) {
+  *rec = {};
+  rec->magic = RELAY_SCHEDULER_RTC_MAGIC;
+  rec->activationCount = relay.activationCount;
+  const int32_t remaining = (int32_t)(relay.nextAllowedMs - now);
+  rec->cooldownRemainingMs = (relay.nextAllowedMs != 0 && remaining > 0) ? static_cast<uint32_t>(remaining) : 0;
+  rec->crc = relaySchedulerCrc(*rec);
+}
+
+// Starea partiției p după un reset la cald, dintr-un context valid. Sirena nu
+// repornește (ALARMING => modul armat), entry delay-ul repornește de la zero.
+template <uint8_t M>
+inline AlarmState crashContextRestoreState(const CrashContextT<M>& ctx, uint8_t p, AlarmState* armedMode) {
+  *armedMode = (ctx.partitionMode[p] == static_cast<uint8_t>(AlarmState::ARMED_STAY)) ? AlarmState::ARMED_STAY : AlarmState::ARMED;
+  switch (static_cast<AlarmState>(ctx.partitionState[p])) {
+    case AlarmState::ARMING: return AlarmState::ARMING;
+    case AlarmState::ENTRY_DELAY: return AlarmState::ENTRY_DELAY;
+    case AlarmState::ARMED:
+    case AlarmState::ARMED_STAY:
+    case AlarmState::ALARMING: return *armedMode;
+    default: return AlarmState::DISARMED;
+  }
+}
+
+// Un tick (1s). Tickerul poate rula în yield()-urile unei treceri prin loop(),
+// cu starea pe jumătate actualizată: salvarea periodică folosește doar o copie
+// completă (seqlock), altfel rămâne imaginea de la tick-ul anterior. La un task
+// blocat scriitorul e blocat și el, deci starea live nu se mai schimbă: se
+// salvează oricum (copia, sau valoarea live) și se cere reset.
+// save(CrashCause, task, const SystemStateT<P>&). Întoarce true = reset.
+template <uint8_t P, typename Save>
+inline bool supervisorTickStep(uint32_t now, const uint32_t* checkInMs, const SupervisedTaskInfo* tasks, uint8_t count, const SeqLocked<SystemStateT<P>>& state, Save save) {
+  SystemStateT<P> snap;
+  const bool consistent = state.tryRead(&snap);
+  const uint8_t overdue = supervisorOverdueTask(now, checkInMs, tasks, count);
+  if (overdue != SUPERVISOR_NO_TASK) {
+    save(CrashCause::SUPERVISOR_TIMEOUT, overdue, consistent ? snap : state.value());
+    return true;
+  }
+  if (consistent) {
+    save(CrashCause::NONE, SUPERVISOR_NO_TASK, snap);
+  }
+  return false;
+}
+
+#endif  // ALARMA_SIMPLA_SUPERVISOR_H
@@ -0,0 +1,180 @@
+// syslog_sink.h — evenimente în syslog RFC 5424 pe UDP, cu buffer în RAM cât rețeaua e căzută, comun firmware + unelte host
+#ifndef ALARMA_SIMPLA_SYSLOG_SINK_H
+#define ALARMA_SIMPLA_SYSLOG_SINK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Evenimentele importante (internet_DOWN_detected, relay_1_ACTIVATED) apar
+// tocmai când rețeaua lipsește, deci fiecare linie de [ EVENT= ...] intră
+// întâi într-un ring fix de înregistrări, cu momentul ei (epoch dacă ora e
+// sincronizată, altfel millis() și epoch-ul se deduce la trimitere). Cu
+// legătura refăcută, ring-ul se golește în datagrame cu mai multe mesaje
+// (separate prin LF), limitate de un token bucket. Nicio alocare: textul e
+// copiat în înregistrare, formatarea scrie direct în buffer-ul datagramei.
+//
+// Formatul unui mesaj (RFC 5424):
+//   <PRI>1 2026-10-19T08:15:02Z alarma-00a1b2c3 alarma_simpla - EVENT [alarma@32473 seq="7" late="312"] internet_DOWN_detected
+// `late` = secunde între eveniment și trimitere; `dropped` apare pe primul
+// mesaj de după o suprascriere a ring-ului. 32473 = PEN-ul de exemplu din RFC 5612.
+static const uint8_t SYSLOG_TEXT_MAX = 56;
+static const size_t SYSLOG_DATAGRAM_MAX = 1024;  // sub MTU, fără fragmentare IP
+static const uint8_t SYSLOG_FACILITY_LOCAL0 = 16;
+
+static const uint8_t SYSLOG_SEV_CRITICAL = 2;
+static const uint8_t SYSLOG_SEV_WARNING = 4;
+static const uint8_t SYSLOG_SEV_NOTICE = 5;
+static const uint8_t SYSLOG_SEV_INFO = 6;
+
+struct SyslogRecord {
+  uint32_t seq;
+  uint32_t ms;     // millis() la eveniment
+  uint32_t epoch;  // 0 = ora încă nesincronizată
+  uint8_t severity;
+  uint8_t len;
+  char text[SYSLOG_TEXT_MAX];
+};
+
+// Ring de înregistrări: plin => cea mai veche se pierde (contorizat), ca cele
+// mai recente (de obicei și cele mai relevante) să ajungă la server.
+template <uint16_t CAPACITY>
+class SyslogBuffer {
+  static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "SyslogBuffer capacity must be a power of two");
+
+ public:
+  void push(const char* text, uint8_t severity, uint32_t ms, uint32_t epoch) {
+    if (count_ == CAPACITY) {
+      ++tail_;
+      --count_;
+      ++dropped_;
+      ++droppedTotal_;
+    }
+    SyslogRecord& r = records_[(tail_ + count_) & MASK];
+    r.seq = nextSeq_++;
+    r.ms = ms;
+    r.epoch = epoch;
+    r.severity = severity;
+    size_t n = strlen(text);
+    if (n > SYSLOG_TEXT_MAX) n = SYSLOG_TEXT_MAX;
+    memcpy(r.text, text, n);
+    r.len = static_cast<uint8_t>(n);
+    ++count_;
+    if (count_ > maxCount_) maxCount_ = count_;
+  }
+
+  uint16_t size() const { return count_; }
+  const SyslogRecord& at(uint16_t i) const { return records_[(tail_ + i) & MASK]; }
+  void pop(uint16_t n) {
+    if (n > count_) n = count_;
+    tail_ = static_cast<uint16_t>(tail_ + n);
+    count_ = static_cast<uint16_t>(count_ - n);
+  }
+
+  // pierdute de la ultimul takeDropped() (se raportează o singură dată)
+  uint32_t takeDropped() {
+    const uint32_t n = dropped_;
+    dropped_ = 0;
+    return n;
+  }
+  uint32_t droppedTotal() const { return droppedTotal_; }
+  uint16_t maxCount() const { return maxCount_; }
+  static constexpr uint16_t capacity() { return CAPACITY; }
+
+ private:
+  static constexpr uint16_t MASK = CAPACITY - 1;
+  SyslogRecord records_[CAPACITY];
+  uint16_t tail_ = 0;
+  uint16_t count_ = 0;
+  uint16_t maxCount_ = 0;
+  uint32_t nextSeq_ = 0;
+  uint32_t dropped_ = 0;
+  uint32_t droppedTotal_ = 0;
+};
+
+struct SyslogIdentity {
+  const char* hostname;  // ex. "alarma-00a1b2c3"
+  const char* appName;
+  uint8_t facility;
+};
+
+// Un mesaj RFC 5424 (fără LF) în out; 0 dacă nu încape.
+inline size_t syslogFormat(const SyslogRecord& r, const SyslogIdentity& id, uint32_t nowMs, uint32_t nowEpoch, uint32_t dropped, char* out, size_t outSize) {
+  const uint32_t ageSec = (nowMs - r.ms) / 1000;
+  uint32_t epoch = r.epoch;
+  if (epoch == 0 && nowEpoch != 0 && nowEpoch > ageSec) epoch = nowEpoch - ageSec;  // sincronizare venită după eveniment
+
+  char ts[24] = "-";
+  if (epoch != 0) {
+    const time_t t = static_cast<time_t>(epoch);
+    struct tm tmUtc;
+    gmtime_r(&t, &tmUtc);
+    strftime(ts, sizeof(ts), "%Y-%m-%dT%H:%M:%SZ", &tmUtc);
+  }
+  char droppedParam[24] = "";
+  if (dropped != 0) snprintf(droppedParam, sizeof(droppedParam), " dropped=\"%lu\"", static_cast<unsigned long>(dropped));
+
+  const int n = snprintf(out, outSize, "<%u>1 %s %s %s - EVENT [alarma@32473 seq=\"%lu\" late=\"%lu\"%s] %.*s", id.facility * 8u + r.severity, ts, id.hostname,
+                         id.appName, static_cast<unsigned long>(r.seq), static_cast<unsigned long>(ageSec), droppedParam, r.len, r.text);
+  if (n < 0 || static_cast<size_t>(n) >= outSize) return 0;
+  return static_cast<size_t>(n);
+}
+
+// Umple o datagramă cu mesaje de la începutul ring-ului (separate prin LF,
+// fără LF final). Întoarce bytes; *taken = câte înregistrări a consumat —
+// apelantul face pop(*taken) doar dacă trimiterea a reușit. `dropped` se pune
+// pe primul mesaj.
+template <uint16_t CAPACITY>
+size_t syslogBuildBatch(const SyslogBuffer<CAPACITY>& buf, const SyslogIdentity& id, uint32_t nowMs, uint32_t nowEpoch, uint32_t dropped, uint8_t maxRecords,
+                        char* out, size_t outSize, uint16_t* taken) {
+  size_t used = 0;
+  uint16_t n = 0;
+  while (n < buf.size() && n < maxRecords) {
+    const size_t sep = used ? 1 : 0;
+    if (used + sep >= outSize) break;
+    const size_t len = syslogFormat(buf.at(n), id, nowMs, nowEpoch, n == 0 ? dropped : 0, out + used + sep, outSize - used - sep);
+    if (len == 0) {
+      if (n == 0) {
+        // un singur mesaj prea mare pentru datagramă nu trebuie să blocheze coada
+        ++n;
+        continue;
+      }
+      break;
+    }
+    if (sep) out[used] = '\n';
+    used += sep + len;
+    ++n;
+  }
+  *taken = n;
+  return used;
+}
+
+// Token bucket pe datagrame: `ratePerSec` în regim continuu, cel mult `burst` deodată.
+struct SyslogRateLimiter {
+  uint16_t ratePerSec;
+  uint16_t burst;
+  uint32_t tokensMilli;  // jetoane * 1000
+  uint32_t lastMs;
+  bool started;
+
+  bool take(uint32_t now) {
+    if (!started) {
+      started = true;
+      tokensMilli = static_cast<uint32_t>(burst) * 1000;
+      lastMs = now;
+    }
+    const uint32_t elapsed = now - lastMs;
+    lastMs = now;
+    const uint64_t refill = static_cast<uint64_t>(elapsed) * ratePerSec;  // ms * jetoane/s = jetoane * 1000
+    const uint64_t cap = static_cast<uint64_t>(burst) * 1000;
+    const uint64_t tokens = tokensMilli + refill;
+    tokensMilli = static_cast<uint32_t>(tokens > cap ? cap : tokens);
+    if (tokensMilli < 1000) return false;
+    tokensMilli -= 1000;
+    return true;
+  }
+};
+
+#endif  // ALARMA_SIMPLA_SYSLOG_SINK_H
@@ -0,0 +1,70 @@
+// system_state.h — starea runtime a firmware-ului într-o singură structură compactă
+#ifndef ALARMA_SIMPLA_SYSTEM_STATE_H
+#define ALARMA_SIMPLA_SYSTEM_STATE_H
+
+#include <stdint.h>
+#include <time.h>
+
+#include "alarm_fsm.h"
+#include "relay_scheduler.h"
+#include "seqlock.h"
+
+// Crește la orice schimbare de layout (snapshot-urile salvate/transmise o poartă).
+static const uint8_t SYSTEM_STATE_VERSION = 2;
+
+// Un singur scriitor: loop() (și setup()). Câmpurile sunt ordonate după
+// aliniere, flag-urile sunt biți, iar timpii reali sunt epoch pe 32 de biți
+// (valabil până în 2106). Duratele de conectare WiFi încap în 16 biți
+// (timeout-ul e 15 s). Cititorii asincroni (Ticker, ISR) folosesc
+// SeqLocked<SystemState>::tryRead().
+template <uint8_t PARTITIONS>
+struct SystemStateT {
+  // alarmă
+  AlarmPartition partitions[PARTITIONS];
+  uint32_t lastMotionMs[4];
+  uint32_t alarmTriggerCount;
+  // releu internet + ping
+  RelayScheduler relay;
+  uint32_t lastGooglePingMs;
+  uint32_t pingCounter;
+  uint32_t pingDownStartEpoch;
+  uint32_t lastWifiDisconnectEpoch;
+  uint32_t lastPingDownEpoch;  // rămâne setat și după revenire (telemetrie)
+  // WiFi
+  uint32_t wifiOffLivePrintLastMs;
+  uint32_t emulateWifiLastConnectTryMs;
+  uint32_t wifiConnectStartMs;
+  // timp + status
+  uint32_t lastHttpTimeTryMs;
+  uint32_t lastAutoStatusMs;
+  uint32_t statusPrintCounter;
+  uint32_t bootToArmedUs;  // micros() de la reset până la starea alarmei restaurată
+  uint16_t lastPingRttMs;
+  uint16_t wifiLastAssocMs;  // durate ultimei conectări reușite
+  uint16_t wifiLastIpMs;
+  uint8_t version;
+  AlarmState alarmState;  // rezumatul partițiilor (prioritatea maximă)
+  uint8_t zoneBypass;     // biți: PIR-urile ocolite (zone_health.h)
+  uint8_t wifiAttemptNetwork : 4;
+  bool wifiCacheValid : 1;
+  bool wifiAttemptFast : 1;      // încercarea curentă folosește cache-ul
+  bool wifiNextAttemptFast : 1;  // după o deconectare se încearcă întâi cache-ul
+  bool wifiLastConnectFast : 1;
+  bool wifiConnectInProgress : 1;
+  bool emulateWifiOff : 1;
+  bool emulateWifiOffLogged : 1;
+  bool ntpStarted : 1;
+  bool ntpReadyLogged : 1;
+  bool ntpWaitingLogged : 1;
+};
+
+// Valorile de pornire (bitfield-urile nu pot avea inițializator în C++17).
+template <uint8_t PARTITIONS>
+inline void systemStateInit(SystemStateT<PARTITIONS>& s) {
+  s = {};
+  s.version = SYSTEM_STATE_VERSION;
+  s.alarmState = AlarmState::DISARMED;
+  s.wifiNextAttemptFast = true;
+}
+
+#endif  // ALARMA_SIMPLA_SYSTEM_STATE_H
@@ -0,0 +1,298 @@
+// telemetry_frame.h — cadru binar de telemetrie (UDP), comun firmware + unelte host
+#ifndef ALARMA_SIMPLA_TELEMETRY_FRAME_H
+#define ALARMA_SIMPLA_TELEMETRY_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "crc32.h"
+#include "messages.h"
+
+// Layout fix, little-endian, 64 bytes (versiunea 1):
+//   off  size  câmp
+//    0    2    magic 'A','T'
+//    2    1    versiune
+//    3    1    tip cadru (TELEMETRY_TYPE_STATUS, TELEMETRY_TYPE_EVENT mai jos)
+//    4    4    seq (crește cu 1 la fiecare cadru; goluri = pierderi)
+//    8    4    chip id
+//   12    4    uptime (s)
+//   16    4    epoch curent (0 = fără timp real)
+//   20    4    epoch ultima întrerupere (ping down / WiFi down)
+//   24    4    pingCounter
+//   28    4    relayInternetActivationCount
+//   32    4    free heap
+//   36    2    cel mai mare bloc liber din heap
+//   38    1    AlarmState
+//   39    1    flags (TELEMETRY_FLAG_*)
+//   40    1    RSSI (int8, dBm)
+//   41    1    LoopStage
+//   42    2    ultimul RTT ping (ms)
+//   44    4    boot count
+//   48    4    WiFi deconectat de (s)
+//   52    8    rezervat (0)
+//   60    4    CRC32 peste bytes 0..59
+// Câmpuri noi se adaugă în zona rezervată; schimbarea layout-ului => versiune nouă.
+//
+// Cadrul de eveniment (TELEMETRY_TYPE_EVENT, câte unul la fiecare logEvent()):
+// același antet și CRC, același contor seq ca STATUS (un singur șir de
+// pierderi pe placă), apoi ID-ul și argumentele mesajului din messages.h, nu
+// textul: colectorul îl refă cu msgRender() în limba lui.
+//   off  size  câmp
+//    0   12    magic, versiune, tip, seq, chip id (ca la STATUS)
+//   12    4    uptime (s)
+//   16    4    epoch (0 = fără timp real)
+//   20    2    Msg (ID-ul din messages.h)
+//   22    1    severitatea syslog
+//   23    1    numărul de argumente (max TELEMETRY_EVENT_MAX_ARGS)
+//   24    1    tipul argumentelor, 2 biți fiecare (MsgArg::Kind), argumentul 0 în biții 0-1
+//   25   35    argumentele la rând: număr = 4 bytes, text = bytes + '\0'
+//              (trunchiat la spațiul rămas)
+//   60    4    CRC32 peste bytes 0..59
+static const size_t TELEMETRY_FRAME_SIZE = 64;
+static const uint8_t TELEMETRY_MAGIC_0 = 'A';
+static const uint8_t TELEMETRY_MAGIC_1 = 'T';
+static const uint8_t TELEMETRY_VERSION = 1;
+static const uint8_t TELEMETRY_TYPE_STATUS = 1;
+static const uint8_t TELEMETRY_TYPE_EVENT = 2;
+static const uint8_t TELEMETRY_EVENT_MAX_ARGS = 4;
+static const size_t TELEMETRY_EVENT_ARG_BYTES = 35;
+
+static const uint8_t TELEMETRY_FLAG_INTERNET_CUT = 1u << 0;
+static const uint8_t TELEMETRY_FLAG_PING_DOWN = 1u << 1;
+static const uint8_t TELEMETRY_FLAG_WIFI_CONNECTED = 1u << 2;
+static const uint8_t TELEMETRY_FLAG_WIFI_EMULATED_OFF = 1u << 3;
+static const uint8_t TELEMETRY_FLAG_NTP_READY = 1u << 4;
+static const uint8_t TELEMETRY_FLAG_SIREN_ON = 1u << 5;
+static const uint8_t TELEMETRY_FLAG_OTA_PENDING = 1u << 6;
+
+struct TelemetryFrame {
+  uint32_t seq;
+  uint32_t chipId;
+  uint32_t uptimeSec;
+  uint32_t epoch;
+  uint32_t lastOutageEpoch;
+  uint32_t pingCounter;
+  uint32_t relayActivationCount;
+  uint32_t freeHeap;
+  uint16_t maxFreeBlock;
+  uint8_t alarmState;
+  uint8_t flags;
+  int8_t rssi;
+  uint8_t loopStage;
+  uint16_t lastPingRttMs;
+  uint32_t bootCount;
+  uint32_t wifiDownSec;
+};
+
+struct TelemetryEvent {
+  uint32_t seq;
+  uint32_t chipId;
+  uint32_t uptimeSec;
+  uint32_t epoch;
+  uint16_t msgId;
+  uint8_t severity;
+  uint8_t argCount;
+  uint8_t argKinds;
+  uint8_t args[TELEMETRY_EVENT_ARG_BYTES];  // textele sunt mereu terminate cu '\0'
+};
+
+inline void telemetryPutU16(uint8_t* p, uint16_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+inline void telemetryPutU32(uint8_t* p, uint32_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+  p[2] = static_cast<uint8_t>(v >> 16);
+  p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+inline uint16_t telemetryGetU16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t telemetryGetU32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// out trebuie să aibă TELEMETRY_FRAME_SIZE bytes.
+inline void telemetryEncode(const TelemetryFrame& f, uint8_t* out) {
+  memset(out, 0, TELEMETRY_FRAME_SIZE);
+  out[0] = TELEMETRY_MAGIC_0;
+  out[1] = TELEMETRY_MAGIC_1;
+  out[2] = TELEMETRY_VERSION;
+  out[3] = TELEMETRY_TYPE_STATUS;
+  telemetryPutU32(out + 4, f.seq);
+  telemetryPutU32(out + 8, f.chipId);
+  telemetryPutU32(out + 12, f.uptimeSec);
+  telemetryPutU32(out + 16, f.epoch);
+  telemetryPutU32(out + 20, f.lastOutageEpoch);
+  telemetryPutU32(out + 24, f.pingCounter);
+  telemetryPutU32(out + 28, f.relayActivationCount);
+  telemetryPutU32(out + 32, f.freeHeap);
+  telemetryPutU16(out + 36, f.maxFreeBlock);
+  out[38] = f.alarmState;
+  out[39] = f.flags;
+  out[40] = static_cast<uint8_t>(f.rssi);
+  out[41] = f.loopStage;
+  telemetryPutU16(out + 42, f.lastPingRttMs);
+  telemetryPutU32(out + 44, f.bootCount);
+  telemetryPutU32(out + 48, f.wifiDownSec);
+  telemetryPutU32(out + 60, crc32Update(0, out, 60));
+}
+
+// false dacă lungimea, magic-ul, versiunea sau CRC-ul nu se potrivesc.
+inline bool telemetryDecode(const uint8_t* in, size_t len, TelemetryFrame* f) {
+  if (len != TELEMETRY_FRAME_SIZE) return false;
+  if (in[0] != TELEMETRY_MAGIC_0 || in[1] != TELEMETRY_MAGIC_1) return false;
+  if (in[2] != TELEMETRY_VERSION || in[3] != TELEMETRY_TYPE_STATUS) return false;
+  if (telemetryGetU32(in + 60) != crc32Update(0, in, 60)) return false;
+
+  f->seq = telemetryGetU32(in + 4);
+  f->chipId = telemetryGetU32(in + 8);
+  f->uptimeSec = telemetryGetU32(in + 12);
+  f->epoch = telemetryGetU32(in + 16);
+  f->lastOutageEpoch = telemetryGetU32(in + 20);
+  f->pingCounter = telemetryGetU32(in + 24);
+  f->relayActivationCount = telemetryGetU32(in + 28);
+  f->freeHeap = telemetryGetU32(in + 32);
+  f->maxFreeBlock = telemetryGetU16(in + 36);
+  f->alarmState = in[38];
+  f->flags = in[39];
+  f->rssi = static_cast<int8_t>(in[40]);
+  f->loopStage = in[41];
+  f->lastPingRttMs = telemetryGetU16(in + 42);
+  f->bootCount = telemetryGetU32(in + 44);
+  f->wifiDownSec = telemetryGetU32(in + 48);
+  return true;
+}
+
+// Tipul unui cadru care a trecut de lungime, magic și versiune; 0 altfel.
+// CRC-ul îl verifică decodorul tipului respectiv.
+inline uint8_t telemetryFrameType(const uint8_t* in, size_t len) {
+  if (len != TELEMETRY_FRAME_SIZE) return 0;
+  if (in[0] != TELEMETRY_MAGIC_0 || in[1] != TELEMETRY_MAGIC_1 || in[2] != TELEMETRY_VERSION) return 0;
+  return in[3];
+}
+
+// Împachetează argumentele în e->args. Un text care nu mai încape e
+// trunchiat; un număr care nu mai încape devine 0 (argumentele rămân la
+// aceleași poziții). Întoarce false dacă s-a pierdut ceva.
+inline bool telemetryEventSetArgs(TelemetryEvent* e, const MsgArg* args, size_t count) {
+  memset(e->args, 0, sizeof(e->args));
+  e->argKinds = 0;
+  e->argCount = 0;
+  bool complete = count <= TELEMETRY_EVENT_MAX_ARGS;
+  size_t used = 0;
+  for (size_t i = 0; i < count && i < TELEMETRY_EVENT_MAX_ARGS; ++i) {
+    const MsgArg& a = args[i];
+    const size_t left = sizeof(e->args) - used;
+    if (a.kind == MsgArg::STR) {
+      if (left == 0) {
+        // niciun byte pentru '\0': argumentul devine numărul 0
+        e->argKinds |= static_cast<uint8_t>(MsgArg::UINT << (2 * i));
+        complete = false;
+      } else {
+        const char* s = a.s ? a.s : "";
+        size_t n = strlen(s);
+        if (n + 1 > left) {
+          n = left - 1;
+          complete = false;
+        }
+        memcpy(e->args + used, s, n);
+        e->args[used + n] = '\0';
+        used += n + 1;
+        e->argKinds |= static_cast<uint8_t>(MsgArg::STR << (2 * i));
+      }
+    } else {
+      e->argKinds |= static_cast<uint8_t>(a.kind << (2 * i));
+      if (left >= 4) {
+        telemetryPutU32(e->args + used, a.u);
+        used += 4;
+      } else {
+        complete = false;
+      }
+    }
+    ++e->argCount;
+  }
+  return complete;
+}
+
+// Argumentele decodate, ca MsgArg pentru msgRender(); textele arată în e.args.
+// Întoarce numărul lor (out are TELEMETRY_EVENT_MAX_ARGS elemente).
+inline size_t telemetryEventArgs(const TelemetryEvent& e, MsgArg* out) {
+  size_t used = 0;
+  for (uint8_t i = 0; i < e.argCount; ++i) {
+    const uint8_t kind = (e.argKinds >> (2 * i)) & 3;
+    if (kind == MsgArg::STR) {
+      const char* s = reinterpret_cast<const char*>(e.args + used);
+      out[i] = MsgArg(s);
+      used += strlen(s) + 1;
+      continue;
+    }
+    const uint32_t v = used + 4 <= sizeof(e.args) ? telemetryGetU32(e.args + used) : 0;
+    used += 4;
+    if (kind == MsgArg::INT) {
+      out[i] = MsgArg(static_cast<int>(static_cast<int32_t>(v)));
+    } else {
+      out[i] = MsgArg(static_cast<unsigned long>(v));
+    }
+  }
+  return e.argCount;
+}
+
+inline void telemetryEventEncode(const TelemetryEvent& e, uint8_t* out) {
+  memset(out, 0, TELEMETRY_FRAME_SIZE);
+  out[0] = TELEMETRY_MAGIC_0;
+  out[1] = TELEMETRY_MAGIC_1;
+  out[2] = TELEMETRY_VERSION;
+  out[3] = TELEMETRY_TYPE_EVENT;
+  telemetryPutU32(out + 4, e.seq);
+  telemetryPutU32(out + 8, e.chipId);
+  telemetryPutU32(out + 12, e.uptimeSec);
+  telemetryPutU32(out + 16, e.epoch);
+  telemetryPutU16(out + 20, e.msgId);
+  out[22] = e.severity;
+  out[23] = e.argCount;
+  out[24] = e.argKinds;
+  memcpy(out + 25, e.args, TELEMETRY_EVENT_ARG_BYTES);
+  telemetryPutU32(out + 60, crc32Update(0, out, 60));
+}
+
+// false la lungime/magic/versiune/tip/CRC greșite, ID în afara catalogului
+// sau argumente care nu se pot citi (text neterminat, tip necunoscut).
+inline bool telemetryEventDecode(const uint8_t* in, size_t len, TelemetryEvent* e) {
+  if (telemetryFrameType(in, len) != TELEMETRY_TYPE_EVENT) return false;
+  if (telemetryGetU32(in + 60) != crc32Update(0, in, 60)) return false;
+
+  e->seq = telemetryGetU32(in + 4);
+  e->chipId = telemetryGetU32(in + 8);
+  e->uptimeSec = telemetryGetU32(in + 12);
+  e->epoch = telemetryGetU32(in + 16);
+  e->msgId = telemetryGetU16(in + 20);
+  e->severity = in[22];
+  e->argCount = in[23];
+  e->argKinds = in[24];
+  memcpy(e->args, in + 25, TELEMETRY_EVENT_ARG_BYTES);
+  if (e->msgId >= MSG_COUNT || e->argCount > TELEMETRY_EVENT_MAX_ARGS) return false;
+
+  size_t used = 0;
+  for (uint8_t i = 0; i < e->argCount; ++i) {
+    const uint8_t kind = (e->argKinds >> (2 * i)) & 3;
+    if (kind == MsgArg::STR) {
+      if (used >= sizeof(e->args)) return false;
+      const void* nul = memchr(e->args + used, '\0', sizeof(e->args) - used);
+      if (nul == nullptr) return false;
+      used = static_cast<size_t>(static_cast<const uint8_t*>(nul) - e->args) + 1;
+    } else if (kind == MsgArg::INT || kind == MsgArg::UINT) {
+      used += 4;  // un număr fără loc se citește 0 (vezi telemetryEventSetArgs)
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+#endif  // ALARMA_SIMPLA_TELEMETRY_FRAME_H
@@ -0,0 +1,453 @@
+// tsdb.h — serie de timp comprimată pe coloane (delta-of-delta / XOR, ca Gorilla), comun firmware + unelte host
+#ifndef ALARMA_SIMPLA_TSDB_H
+#define ALARMA_SIMPLA_TSDB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "crc32.h"
+
+// Un eșantion pe minut: RSSI, RTT-ul ultimului ping, heap liber, releul de internet.
+struct TsdbSample {
+  uint32_t epoch;
+  uint32_t heap;
+  uint16_t rttMs;  // TSDB_RTT_FAIL = ping eșuat / fără ping
+  int8_t rssi;     // TSDB_RSSI_NONE = fără WiFi
+  uint8_t relay;   // bit 7 = releu activ; biții 0..6 = activări de la eșantionul anterior
+};
+
+static const uint16_t TSDB_RTT_FAIL = 0xFFFF;
+static const int8_t TSDB_RSSI_NONE = -128;
+static const uint8_t TSDB_RELAY_ACTIVE = 0x80;
+
+// Blocul = TSDB_BLOCK_SAMPLES eșantioane, codate coloană cu coloană (fiecare
+// coloană e un șir de biți aliniat la byte). Pe flash: TSDB_SEGMENT_COUNT
+// fișiere de câte TSDB_SEGMENT_BYTES; când se umple unul, cel mai vechi se
+// șterge și se rescrie, deci bugetul de flash e fix.
+static const uint8_t TSDB_BLOCK_SAMPLES = 60;
+static const uint8_t TSDB_COLUMNS = 5;  // epoch, rssi, rtt, heap, relay
+static const uint8_t TSDB_SEGMENT_COUNT = 8;
+static const uint32_t TSDB_SEGMENT_BYTES = 32 * 1024;
+static const uint32_t TSDB_FLASH_BUDGET_BYTES = TSDB_SEGMENT_COUNT * TSDB_SEGMENT_BYTES;
+
+// Antet bloc, little-endian, 28 bytes:
+//   off  size  câmp
+//    0    2    magic 'T','S'
+//    2    1    versiune
+//    3    1    eșantioane în bloc
+//    4    4    epoch primul eșantion
+//    8    4    epoch ultimul eșantion
+//   12   10    bytes per coloană (5 x u16)
+//   22    2    rezervat (0)
+//   24    4    CRC32 peste antet[0..24) + coloane
+static const size_t TSDB_BLOCK_HEADER_BYTES = 28;
+static const uint8_t TSDB_MAGIC_0 = 'T';
+static const uint8_t TSDB_MAGIC_1 = 'S';
+static const uint8_t TSDB_VERSION = 1;
+// Cel mai rău caz pe eșantion: epoch 36 + rssi 10 + rtt 19 + heap 44 + releu 9 biți.
+static const size_t TSDB_MAX_BITS_PER_SAMPLE = 118;
+static const size_t TSDB_BLOCK_MAX_BYTES = TSDB_BLOCK_HEADER_BYTES + (TSDB_BLOCK_SAMPLES * TSDB_MAX_BITS_PER_SAMPLE + 7) / 8 + TSDB_COLUMNS;
+
+struct TsdbBlockInfo {
+  uint8_t count;
+  uint32_t firstEpoch;
+  uint32_t lastEpoch;
+  uint16_t columnBytes[TSDB_COLUMNS];
+  uint32_t totalBytes;  // antet + coloane
+};
+
+// ----------------------------
+// Biți (MSB întâi)
+// ----------------------------
+struct TsdbBitWriter {
+  uint8_t* buf;
+  size_t capBytes;
+  size_t bitPos;
+  bool overflow;
+
+  void put(uint32_t value, uint8_t bits) {
+    while (bits--) {
+      const size_t byte = bitPos >> 3;
+      if (byte >= capBytes) {
+        overflow = true;
+        return;
+      }
+      const uint8_t mask = static_cast<uint8_t>(0x80u >> (bitPos & 7));
+      if ((value >> bits) & 1u) {
+        buf[byte] |= mask;
+      } else {
+        buf[byte] &= static_cast<uint8_t>(~mask);
+      }
+      ++bitPos;
+    }
+  }
+  size_t bytes() const { return (bitPos + 7) >> 3; }
+};
+
+struct TsdbBitReader {
+  const uint8_t* buf;
+  size_t bits;
+  size_t pos;
+
+  uint32_t get(uint8_t n) {
+    uint32_t v = 0;
+    while (n--) {
+      uint32_t bit = 0;
+      if (pos < bits) bit = (buf[pos >> 3] >> (7 - (pos & 7))) & 1u;
+      ++pos;
+      v = (v << 1) | bit;
+    }
+    return v;
+  }
+  // Numără biții 1 dinaintea primului 0 (prefixul de bucket), cel mult `max`.
+  uint8_t ones(uint8_t max) {
+    uint8_t n = 0;
+    while (n < max && get(1)) ++n;
+    return n;
+  }
+  bool exhausted() const { return pos > bits; }
+};
+
+inline uint32_t tsdbZigzag(int32_t v) {
+  return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+inline int32_t tsdbUnzigzag(uint32_t v) {
+  return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+}
+
+// ----------------------------
+// Coloane. Fiecare are o stare (valoarea/delta anterioară) identică la
+// codare și decodare; primul eșantion se scrie brut.
+// ----------------------------
+
+// Epoch: delta-of-delta față de pasul anterior (inițial 60 s, un eșantion pe minut).
+//   0 => dod 0; 10 + 7b; 110 + 9b; 1110 + 12b; 1111 + delta brut 32b
+struct TsdbEpochColumn {
+  uint32_t prev = 0;
+  int64_t prevDelta = 60;
+  bool first = true;
+
+  void encode(TsdbBitWriter& w, uint32_t v) {
+    if (first) {
+      w.put(v, 32);
+      first = false;
+    } else {
+      const int64_t delta = static_cast<int64_t>(v) - prev;
+      const int64_t dod = delta - prevDelta;
+      if (dod == 0) {
+        w.put(0, 1);
+      } else if (dod >= -63 && dod <= 64) {
+        w.put(0x2, 2);
+        w.put(static_cast<uint32_t>(dod + 63), 7);
+      } else if (dod >= -255 && dod <= 256) {
+        w.put(0x6, 3);
+        w.put(static_cast<uint32_t>(dod + 255), 9);
+      } else if (dod >= -2047 && dod <= 2048) {
+        w.put(0xE, 4);
+        w.put(static_cast<uint32_t>(dod + 2047), 12);
+      } else {
+        w.put(0xF, 4);
+        w.put(static_cast<uint32_t>(v - prev), 32);
+      }
+      prevDelta = delta;
+    }
+    prev = v;
+  }
+
+  uint32_t decode(TsdbBitReader& r) {
+    if (first) {
+      first = false;
+      prev = r.get(32);
+      return prev;
+    }
+    int64_t delta;
+    switch (r.ones(4)) {
+      case 0: delta = prevDelta; break;
+      case 1: delta = prevDelta + static_cast<int64_t>(r.get(7)) - 63; break;
+      case 2: delta = prevDelta + static_cast<int64_t>(r.get(9)) - 255; break;
+      case 3: delta = prevDelta + static_cast<int64_t>(r.get(12)) - 2047; break;
+      default: delta = static_cast<int32_t>(r.get(32)); break;
+    }
+    prevDelta = delta;
+    prev = static_cast<uint32_t>(prev + delta);
+    return prev;
+  }
+};
+
+// RSSI: delta mic (±4 dBm) sau valoarea brută.  0 => la fel; 10 + 3b zigzag; 11 + 8b
+struct TsdbRssiColumn {
+  int8_t prev = 0;
+  bool first = true;
+
+  void encode(TsdbBitWriter& w, int8_t v) {
+    const uint32_t z = tsdbZigzag(static_cast<int32_t>(v) - prev);
+    if (first) {
+      w.put(static_cast<uint8_t>(v), 8);
+      first = false;
+    } else if (z == 0) {
+      w.put(0, 1);
+    } else if (z < 8) {
+      w.put(0x2, 2);
+      w.put(z, 3);
+    } else {
+      w.put(0x3, 2);
+      w.put(static_cast<uint8_t>(v), 8);
+    }
+    prev = v;
+  }
+
+  int8_t decode(TsdbBitReader& r) {
+    if (first) {
+      first = false;
+    } else if (r.get(1) == 0) {
+      return prev;
+    } else if (r.get(1) == 0) {
+      prev = static_cast<int8_t>(prev + tsdbUnzigzag(r.get(3)));
+      return prev;
+    }
+    prev = static_cast<int8_t>(r.get(8));
+    return prev;
+  }
+};
+
+// RTT: delta zigzag pe 6 sau 10 biți, altfel brut.  0; 10 + 6b; 110 + 10b; 111 + 16b
+struct TsdbRttColumn {
+  uint16_t prev = 0;
+  bool first = true;
+
+  void encode(TsdbBitWriter& w, uint16_t v) {
+    const uint32_t z = tsdbZigzag(static_cast<int32_t>(v) - prev);
+    if (first) {
+      w.put(v, 16);
+      first = false;
+    } else if (z == 0) {
+      w.put(0, 1);
+    } else if (z < 64) {
+      w.put(0x2, 2);
+      w.put(z, 6);
+    } else if (z < 1024) {
+      w.put(0x6, 3);
+      w.put(z, 10);
+    } else {
+      w.put(0x7, 3);
+      w.put(v, 16);
+    }
+    prev = v;
+  }
+
+  uint16_t decode(TsdbBitReader& r) {
+    if (first) {
+      first = false;
+      prev = static_cast<uint16_t>(r.get(16));
+      return prev;
+    }
+    switch (r.ones(3)) {
+      case 0: break;
+      case 1: prev = static_cast<uint16_t>(prev + tsdbUnzigzag(r.get(6))); break;
+      case 2: prev = static_cast<uint16_t>(prev + tsdbUnzigzag(r.get(10))); break;
+      default: prev = static_cast<uint16_t>(r.get(16)); break;
+    }
+    return prev;
+  }
+};
+
+// Heap: XOR cu valoarea anterioară, biții semnificativi în fereastra
+// (zerouri în față / în spate) anterioară dacă încap, altfel fereastră nouă.
+//   0 => la fel; 10 + biții din fereastra veche; 11 + 5b lead + 5b (len-1) + len biți
+struct TsdbHeapColumn {
+  uint32_t prev = 0;
+  uint8_t lead = 0xFF;  // 0xFF = încă fără fereastră
+  uint8_t trail = 0;
+  bool first = true;
+
+  static uint8_t clz32(uint32_t x) { return static_cast<uint8_t>(__builtin_clz(x)); }
+  static uint8_t ctz32(uint32_t x) { return static_cast<uint8_t>(__builtin_ctz(x)); }
+
+  void encode(TsdbBitWriter& w, uint32_t v) {
+    if (first) {
+      w.put(v, 32);
+      first = false;
+      prev = v;
+      return;
+    }
+    const uint32_t x = v ^ prev;
+    prev = v;
+    if (x == 0) {
+      w.put(0, 1);
+      return;
+    }
+    uint8_t l = clz32(x);
+    const uint8_t t = ctz32(x);
+    if (l > 31) l = 31;
+    if (lead != 0xFF && l >= lead && t >= trail) {
+      w.put(0x2, 2);
+      w.put(x >> trail, static_cast<uint8_t>(32 - lead - trail));
+      return;
+    }
+    const uint8_t len = static_cast<uint8_t>(32 - l - t);
+    w.put(0x3, 2);
+    w.put(l, 5);
+    w.put(len - 1u, 5);
+    w.put(x >> t, len);
+    lead = l;
+    trail = t;
+  }
+
+  uint32_t decode(TsdbBitReader& r) {
+    if (first) {
+      first = false;
+      prev = r.get(32);
+      return prev;
+    }
+    if (r.get(1) == 0) return prev;
+    if (r.get(1) == 0) {
+      prev ^= r.get(static_cast<uint8_t>(32 - lead - trail)) << trail;
+      return prev;
+    }
+    lead = static_cast<uint8_t>(r.get(5));
+    const uint8_t len = static_cast<uint8_t>(r.get(5) + 1);
+    trail = static_cast<uint8_t>(32 - lead - len);
+    prev ^= r.get(len) << trail;
+    return prev;
+  }
+};
+
+// Releu: aproape mereu 0.  0; 1 + 8b
+struct TsdbRelayColumn {
+  void encode(TsdbBitWriter& w, uint8_t v) {
+    if (v == 0) {
+      w.put(0, 1);
+    } else {
+      w.put(1, 1);
+      w.put(v, 8);
+    }
+  }
+  uint8_t decode(TsdbBitReader& r) { return r.get(1) ? static_cast<uint8_t>(r.get(8)) : 0; }
+};
+
+// ----------------------------
+// Bloc
+// ----------------------------
+inline void tsdbPutU16(uint8_t* p, uint16_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+inline void tsdbPutU32(uint8_t* p, uint32_t v) {
+  for (uint8_t i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+inline uint16_t tsdbGetU16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t tsdbGetU32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// Codează `n` eșantioane (epoch crescător) în out; întoarce bytes scriși (0 = eroare).
+inline size_t tsdbEncodeBlock(const TsdbSample* s, uint8_t n, uint8_t* out, size_t outSize) {
+  if (n == 0 || n > TSDB_BLOCK_SAMPLES || outSize < TSDB_BLOCK_HEADER_BYTES) return 0;
+  memset(out, 0, TSDB_BLOCK_HEADER_BYTES);
+  out[0] = TSDB_MAGIC_0;
+  out[1] = TSDB_MAGIC_1;
+  out[2] = TSDB_VERSION;
+  out[3] = n;
+  tsdbPutU32(out + 4, s[0].epoch);
+  tsdbPutU32(out + 8, s[n - 1].epoch);
+
+  size_t pos = TSDB_BLOCK_HEADER_BYTES;
+  for (uint8_t c = 0; c < TSDB_COLUMNS; ++c) {
+    TsdbBitWriter w = { out + pos, outSize - pos, 0, false };
+    TsdbEpochColumn epoch;
+    TsdbRssiColumn rssi;
+    TsdbRttColumn rtt;
+    TsdbHeapColumn heap;
+    TsdbRelayColumn relay;
+    for (uint8_t i = 0; i < n; ++i) {
+      switch (c) {
+        case 0: epoch.encode(w, s[i].epoch); break;
+        case 1: rssi.encode(w, s[i].rssi); break;
+        case 2: rtt.encode(w, s[i].rttMs); break;
+        case 3: heap.encode(w, s[i].heap); break;
+        default: relay.encode(w, s[i].relay); break;
+      }
+    }
+    if (w.overflow) return 0;
+    tsdbPutU16(out + 12 + 2 * c, static_cast<uint16_t>(w.bytes()));
+    pos += w.bytes();
+  }
+  uint32_t crc = crc32Update(0, out, 24);
+  crc = crc32Update(crc, out + TSDB_BLOCK_HEADER_BYTES, pos - TSDB_BLOCK_HEADER_BYTES);
+  tsdbPutU32(out + 24, crc);
+  return pos;
+}
+
+// Doar antetul (fără CRC): destul ca o interogare să sară peste blocuri.
+inline bool tsdbParseHeader(const uint8_t* h, TsdbBlockInfo* info) {
+  if (h[0] != TSDB_MAGIC_0 || h[1] != TSDB_MAGIC_1 || h[2] != TSDB_VERSION) return false;
+  if (h[3] == 0 || h[3] > TSDB_BLOCK_SAMPLES) return false;
+  info->count = h[3];
+  info->firstEpoch = tsdbGetU32(h + 4);
+  info->lastEpoch = tsdbGetU32(h + 8);
+  info->totalBytes = TSDB_BLOCK_HEADER_BYTES;
+  for (uint8_t c = 0; c < TSDB_COLUMNS; ++c) {
+    info->columnBytes[c] = tsdbGetU16(h + 12 + 2 * c);
+    info->totalBytes += info->columnBytes[c];
+  }
+  return info->totalBytes <= TSDB_BLOCK_MAX_BYTES;
+}
+
+// Decodor în flux: câte un rând la next(), cu un cititor de biți per coloană;
+// memoria e doar blocul (deja citit) plus câteva zeci de bytes de stare.
+class TsdbBlockReader {
+ public:
+  // false dacă antetul sau CRC-ul nu se potrivesc.
+  bool open(const uint8_t* block, size_t len) {
+    if (len < TSDB_BLOCK_HEADER_BYTES || !tsdbParseHeader(block, &info_) || len < info_.totalBytes) return false;
+    uint32_t crc = crc32Update(0, block, 24);
+    crc = crc32Update(crc, block + TSDB_BLOCK_HEADER_BYTES, info_.totalBytes - TSDB_BLOCK_HEADER_BYTES);
+    if (crc != tsdbGetU32(block + 24)) return false;
+    size_t pos = TSDB_BLOCK_HEADER_BYTES;
+    for (uint8_t c = 0; c < TSDB_COLUMNS; ++c) {
+      readers_[c] = { block + pos, static_cast<size_t>(info_.columnBytes[c]) * 8, 0 };
+      pos += info_.columnBytes[c];
+    }
+    epoch_ = TsdbEpochColumn();
+    rssi_ = TsdbRssiColumn();
+    rtt_ = TsdbRttColumn();
+    heap_ = TsdbHeapColumn();
+    row_ = 0;
+    return true;
+  }
+
+  bool next(TsdbSample* s) {
+    if (row_ >= info_.count) return false;
+    s->epoch = epoch_.decode(readers_[0]);
+    s->rssi = rssi_.decode(readers_[1]);
+    s->rttMs = rtt_.decode(readers_[2]);
+    s->heap = heap_.decode(readers_[3]);
+    s->relay = relay_.decode(readers_[4]);
+    ++row_;
+    for (const TsdbBitReader& r : readers_) {
+      if (r.exhausted()) return false;
+    }
+    return true;
+  }
+
+  const TsdbBlockInfo& info() const { return info_; }
+
+ private:
+  TsdbBlockInfo info_ = {};
+  TsdbBitReader readers_[TSDB_COLUMNS] = {};
+  TsdbEpochColumn epoch_;
+  TsdbRssiColumn rssi_;
+  TsdbRttColumn rtt_;
+  TsdbHeapColumn heap_;
+  TsdbRelayColumn relay_;
+  uint8_t row_ = 0;
+};
+
+#endif  // ALARMA_SIMPLA_TSDB_H
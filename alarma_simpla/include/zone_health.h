@@ -0,0 +1,165 @@
+// zone_health.h — sănătatea PIR-urilor (activ continuu, duty cycle, rata de declanșări, alarme repetate) și ocolirea automată a zonei, fără I/O, comun firmware + unelte host
+#ifndef ALARMA_SIMPLA_ZONE_HEALTH_H
+#define ALARMA_SIMPLA_ZONE_HEALTH_H
+
+#include <stdint.h>
+
+// Un PIR defect (blocat activ, cablu tăiat cu pull-up) dă mișcare la fiecare
+// MOTION_RETRIGGER_MS: după sirenă partiția revine în ARMED și intră imediat
+// din nou în ALARMING, toată noaptea. Pe fiecare zonă se urmăresc, O(1) pe
+// trecere, doar cât partiția ei e armată (`watch`):
+//   - STUCK: activ continuu peste stuckHighMs;
+//   - DUTY: activ peste dutyMaxPct% dintr-o fereastră de dutyWindowMs
+//     (contact intermitent, PIR care „pâlpâie”);
+//   - RATE: fronturi crescătoare în cel puțin tripSlotsMax din ultimele 32 de
+//     sloturi de tripSlotMs (bitset deplasat la fiecare front);
+//   - SWINGER: zona a pornit swingerLimit alarme în aceeași armare.
+// Zona găsită defectă e ocolită (bypassMask) până la dezarmarea partiției;
+// atunci revine, dacă PIR-ul e în repaus. Firmware-ul pune masca în starea
+// urmărită (input_trace.h), deci replay-ul aplică exact aceeași ocolire.
+enum class ZoneFault : uint8_t { NONE, STUCK, DUTY, RATE, SWINGER };
+
+static const char* const ZONE_FAULT_NAMES[] = { "OK", "STUCK", "DUTY", "RATE", "SWINGER" };
+
+struct ZoneHealthConfig {
+  uint32_t stuckHighMs;
+  uint32_t dutyWindowMs;
+  uint8_t dutyMaxPct;
+  uint32_t tripSlotMs;
+  uint8_t tripSlotsMax;  // din 32; 0 = fără verificarea ratei
+  uint8_t swingerLimit;  // 0 = fără limită
+};
+
+struct ZoneHealthZone {
+  uint32_t highSinceMs;     // ultimul front crescător
+  uint32_t windowStartMs;
+  uint32_t highInWindowMs;  // intervalele active închise din fereastra curentă
+  uint32_t tripBits;        // bit 0 = slotul `tripSlot`
+  uint32_t tripSlot;
+  uint8_t alarms;
+  ZoneFault fault;
+  bool level;
+  bool watched;
+};
+
+template <uint8_t ZONES>
+class ZoneHealth {
+  static_assert(ZONES <= 8, "o mască de 8 biți");
+
+ public:
+  void begin(const ZoneHealthConfig& config) {
+    *this = ZoneHealth();
+    config_ = config;
+  }
+
+  // O trecere: levels = PIR-urile citite (bit i = zona i), watch = zonele cu
+  // partiția armată. Întoarce zonele care și-au schimbat ocolirea.
+  uint8_t step(uint32_t now, uint8_t levels, uint8_t watch) {
+    uint8_t changed = 0;
+    for (uint8_t i = 0; i < ZONES; ++i) {
+      ZoneHealthZone& z = zones_[i];
+      const uint8_t bit = static_cast<uint8_t>(1u << i);
+      const bool high = (levels & bit) != 0;
+      const bool watched = (watch & bit) != 0;
+
+      if (watched != z.watched) {
+        z.watched = watched;
+        z.windowStartMs = now;
+        z.highInWindowMs = 0;
+        z.tripBits = 0;
+        z.alarms = 0;
+      }
+      if (high != z.level) {
+        z.level = high;
+        if (high) {
+          z.highSinceMs = now;
+          noteTrip(z, now);
+        } else {
+          z.highInWindowMs += now - openStart(z);
+        }
+      }
+      if (now - z.windowStartMs >= config_.dutyWindowMs) {
+        z.windowStartMs = now;
+        z.highInWindowMs = 0;
+      }
+
+      if (z.fault != ZoneFault::NONE) {
+        // dezarmat + PIR în repaus: zona revine
+        if (!watched && !high) {
+          z.fault = ZoneFault::NONE;
+          changed |= bit;
+        }
+        continue;
+      }
+      if (!watched) continue;
+      z.fault = diagnose(z, now, high);
+      if (z.fault != ZoneFault::NONE) changed |= bit;
+    }
+    return changed;
+  }
+
+  // Zona i a dus partiția în ALARMING; întoarce bitul zonei dacă a fost ocolită acum.
+  uint8_t noteAlarm(uint8_t i) {
+    if (i >= ZONES) return 0;
+    ZoneHealthZone& z = zones_[i];
+    if (z.alarms < 0xFF) ++z.alarms;
+    if (z.fault != ZoneFault::NONE || config_.swingerLimit == 0 || z.alarms < config_.swingerLimit) return 0;
+    z.fault = ZoneFault::SWINGER;
+    return static_cast<uint8_t>(1u << i);
+  }
+
+  uint8_t bypassMask() const {
+    uint8_t m = 0;
+    for (uint8_t i = 0; i < ZONES; ++i) {
+      if (zones_[i].fault != ZoneFault::NONE) m |= static_cast<uint8_t>(1u << i);
+    }
+    return m;
+  }
+
+  ZoneFault fault(uint8_t i) const { return zones_[i].fault; }
+  uint8_t alarms(uint8_t i) const { return zones_[i].alarms; }
+  uint8_t tripSlots(uint8_t i) const { return popcount(zones_[i].tripBits); }
+  uint32_t highForMs(uint8_t i, uint32_t now) const { return zones_[i].level ? now - zones_[i].highSinceMs : 0; }
+  uint8_t dutyPct(uint8_t i, uint32_t now) const {
+    const ZoneHealthZone& z = zones_[i];
+    const uint32_t elapsed = now - z.windowStartMs;
+    if (elapsed == 0) return z.level ? 100 : 0;
+    return static_cast<uint8_t>(static_cast<uint64_t>(activeInWindow(z, now)) * 100 / elapsed);
+  }
+
+ private:
+  static uint8_t popcount(uint32_t v) {
+    uint8_t n = 0;
+    for (; v != 0; v &= v - 1) ++n;
+    return n;
+  }
+
+  // Partea intervalului activ curent care cade în fereastra curentă.
+  static uint32_t openStart(const ZoneHealthZone& z) {
+    return (int32_t)(z.highSinceMs - z.windowStartMs) > 0 ? z.highSinceMs : z.windowStartMs;
+  }
+
+  static uint32_t activeInWindow(const ZoneHealthZone& z, uint32_t now) {
+    return z.highInWindowMs + (z.level ? now - openStart(z) : 0);
+  }
+
+  void noteTrip(ZoneHealthZone& z, uint32_t now) {
+    const uint32_t slot = now / config_.tripSlotMs;
+    const uint32_t shift = slot - z.tripSlot;
+    z.tripBits = shift >= 32 ? 0 : z.tripBits << shift;
+    z.tripBits |= 1;
+    z.tripSlot = slot;
+  }
+
+  ZoneFault diagnose(const ZoneHealthZone& z, uint32_t now, bool high) const {
+    if (high && now - z.highSinceMs >= config_.stuckHighMs) return ZoneFault::STUCK;
+    if (static_cast<uint64_t>(activeInWindow(z, now)) * 100 >= static_cast<uint64_t>(config_.dutyMaxPct) * config_.dutyWindowMs) return ZoneFault::DUTY;
+    if (config_.tripSlotsMax != 0 && popcount(z.tripBits) >= config_.tripSlotsMax) return ZoneFault::RATE;
+    return ZoneFault::NONE;
+  }
+
+  ZoneHealthConfig config_ = {};
+  ZoneHealthZone zones_[ZONES] = {};
+};
+
+#endif  // ALARMA_SIMPLA_ZONE_HEALTH_H
@@ -0,0 +1,95 @@
+# memory_report.py — raport PlatformIO post-build: memoria stării runtime și a mesajelor
+#
+# platformio.ini: extra_scripts = post:scripts/memory_report.py
+#
+# main.cpp definește tablouri-etalon memory_report_* cu dimensiunile care ne
+# interesează: SystemState (system_state.h) și catalogul de mesaje (messages.h)
+# ținut în flash. După compilarea lui main.cpp.o le citim cu nm din toolchain.
+#
+# Câtă DRAM s-a eliberat (globale strânse în SystemState, texte mutate în
+# flash) nu reiese din marker-e: se compară secțiunile .data/.rodata/.bss (pe
+# ESP8266 toate stau în DRAM) ale firmware.elf curent cu ale unui build de
+# referință, dat în platformio.ini:
+#   custom_memory_baseline_elf = /cale/firmware_vechi.elf
+import os
+import subprocess
+
+Import("env")  # noqa: F821 (injectat de PlatformIO)
+
+
+def toolchain_tool(name):
+    cc = env.subst("$CC")  # noqa: F821
+    if cc.endswith("gcc"):
+        return cc[: -len("gcc")] + name
+    return name
+
+
+def toolchain_nm():
+    return toolchain_tool("nm")
+
+
+DRAM_SECTIONS = (".data", ".rodata", ".bss")
+
+
+def dram_sections(elf):
+    out = subprocess.run([toolchain_tool("size"), "-A", elf], capture_output=True, text=True, check=True).stdout
+    sizes = {}
+    for line in out.splitlines():
+        parts = line.split()
+        # <secțiune> <dimensiune> <adresă>
+        if len(parts) >= 2 and parts[0] in DRAM_SECTIONS:
+            sizes[parts[0]] = int(parts[1])
+    return sizes
+
+
+def report_dram(elf, env):
+    baseline = env.GetProjectOption("custom_memory_baseline_elf", "")
+    if not baseline:
+        print("DRAM .data+.rodata+.bss: set custom_memory_baseline_elf for a before/after comparison")
+        return
+    if not os.path.isfile(baseline):
+        print("memory_report: baseline %s not found" % baseline)
+        return
+    try:
+        before, after = dram_sections(baseline), dram_sections(elf)
+    except (OSError, subprocess.CalledProcessError) as e:
+        print("memory_report: size failed: %s" % e)
+        return
+    for name in DRAM_SECTIONS:
+        print("DRAM %s: %d B baseline, %d B now (%+d B)"
+              % (name, before.get(name, 0), after.get(name, 0), after.get(name, 0) - before.get(name, 0)))
+    freed = sum(before.get(n, 0) for n in DRAM_SECTIONS) - sum(after.get(n, 0) for n in DRAM_SECTIONS)
+    print("DRAM freed vs baseline (.data+.rodata+.bss): %d B" % freed)
+
+
+def symbol_sizes(obj):
+    out = subprocess.run([toolchain_nm(), "-S", obj], capture_output=True, text=True, check=True).stdout
+    sizes = {}
+    for line in out.splitlines():
+        parts = line.split()
+        # <adresă> <dimensiune> <tip> <nume>
+        if len(parts) == 4 and parts[3].startswith("memory_report_"):
+            sizes[parts[3][len("memory_report_"):]] = int(parts[1], 16)
+    return sizes
+
+
+def report(source, target, env):
+    report_dram(target[0].get_abspath(), env)
+    obj = os.path.join(env.subst("$BUILD_DIR"), "src", "main.cpp.o")
+    if not os.path.isfile(obj):
+        print("memory_report: %s not found" % obj)
+        return
+    try:
+        sizes = symbol_sizes(obj)
+    except (OSError, subprocess.CalledProcessError) as e:
+        print("memory_report: nm failed: %s" % e)
+        return
+    if any(k not in sizes for k in ("state", "msg_ro", "msg_en")):
+        print("memory_report: marker symbols missing in main.cpp.o")
+        return
+    print("SystemState: %d B" % sizes["state"])
+    print("Message catalog bytes in flash: RO %d B + EN %d B"
+          % (sizes["msg_ro"], sizes["msg_en"]))
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", report)  # noqa: F821
@@ -1,7 +1,13 @@
 #include <Arduino.h>
 #include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
 #include <ESP8266Ping.h>
 #include <ESP8266HTTPClient.h>
+#include <Updater.h>
+#include <bearssl/bearssl_hash.h>
+#include <Ticker.h>
+#include <EEPROM.h>
+#include <LittleFS.h>
 #include <time.h>
 #if 0
 #include <PubSubClient.h>
@@ -19,6 +25,27 @@
 // Config WiFi + MQTT (în `config.h`)
 // ----------------------------
 #include "config.h"
+#include "crc32.h"
+#include "telemetry_frame.h"
+#include "messages.h"
+#include "alarm_fsm.h"
+#include "log_ring.h"
+#include "relay_scheduler.h"
+#include "input_trace.h"
+#include "system_state.h"
+#include "status_delta.h"
+#include "event_bus.h"
+#include "tsdb.h"
+#include "power_watchdog.h"
+#include "syslog_sink.h"
+#include "coroutine.h"
+#include "relay_selftest.h"
+#include "fault_inject.h"
+#include "peer_sync.h"
+#include "op_arena.h"
+#include "zone_health.h"
+#include "button_gesture.h"
+#include "supervisor.h"
 
 #if 0
 WiFiClient espClient;
@@ -34,6 +61,19 @@ static const int PIN_PIR[4] = {
   16   // PIR4  -> GPIO16 (D0)
 };
 
+// Zone: partiția (grup armat independent) și tipul fiecărui PIR.
+// ENTRY = entry delay, INSTANT = alarmă imediată, INTERIOR = ocolit în stay.
+static const uint8_t ALARM_PARTITION_COUNT = 2;
+static const uint8_t ALARM_PARTITION_MAX = 4;  // spațiu rezervat în EEPROM/RTC
+static constexpr AlarmZone ALARM_ZONES[4] = {
+  { 0, ZoneType::ENTRY },     // PIR1 -> ușa de intrare
+  { 0, ZoneType::INTERIOR },  // PIR2
+  { 0, ZoneType::INTERIOR },  // PIR3
+  { 1, ZoneType::INSTANT },   // PIR4 -> partiția 2 (ex. garaj)
+};
+static_assert(ALARM_PARTITION_COUNT >= 1 && ALARM_PARTITION_COUNT <= ALARM_PARTITION_MAX, "partition count");
+static_assert(ALARM_ZONES[0].partition < ALARM_PARTITION_COUNT && ALARM_ZONES[1].partition < ALARM_PARTITION_COUNT && ALARM_ZONES[2].partition < ALARM_PARTITION_COUNT && ALARM_ZONES[3].partition < ALARM_PARTITION_COUNT, "zone partition out of range");
+
 // Relee (2 canale) pentru Siren1 și Siren2
 // Majoritatea modulelor de releu sunt ACTIVE LOW:
 //  - IN la LOW => releu ON
@@ -57,69 +97,171 @@ static const int RELAY_OFF_LEVEL = HIGH;  // releu inactiv la HIGH
 // Timpi (ms)
 // ----------------------------
 static const uint32_t EXIT_DELAY_MS = 10'000;       // delay după armare (ieșire din zonă)
+static const uint32_t ENTRY_DELAY_MS = 15'000;      // timp de dezarmare după o zonă ENTRY
 static const uint32_t ALARM_DURATION_MS = 30'000;   // cât ține sirena la o alarmă
 static const uint32_t MOTION_RETRIGGER_MS = 2'000;  // ignoră re-trigger-uri PIR prea dese
 static const uint32_t LONG_PRESS_MS = 2'000;        // apăsare lungă pentru arm/dezarm
 static const uint32_t DEBOUNCE_MS = 40;
+static const uint32_t BUTTON_MULTI_GAP_MS = 600;    // pauza care încheie o serie de apăsări scurte
 static const uint32_t GOOGLE_PING_INTERVAL_MS = 60'000;
 static const uint32_t STATUS_AUTO_INTERVAL_MS = 30'000;
+static const uint16_t STATUS_KEYFRAME_EVERY = 20;  // raport complet la 20 x 30 s = 10 min
 static const uint32_t FAST_STARTUP_WINDOW_MS = 60'000;
 static const uint32_t FAST_STARTUP_PING_INTERVAL_MS = 10'000;
-static const uint32_t INTERNET_RELAY_PULSE_MS = 10'000;
-static const uint32_t INTERNET_RELAY_COOLDOWN_MS = 60'000;
 static const uint32_t RELAY_STARTUP_HOLDOFF_MS = 60'000;
 static const uint32_t WIFI_DISCONNECT_RELAY_RETRY_MS = 120'000;
 static const uint32_t EMULATE_WIFI_RETRY_CONNECT_MS = 10'000;
+static const uint32_t WIFI_CONNECT_TIMEOUT_MS = 15'000;
+static const uint32_t WIFI_FAST_CONNECT_TIMEOUT_MS = 3'000;  // BSSID/canal/IP din cache
+static const uint32_t STARTUP_TEST_STEP_MS = 1'000;
 static const IPAddress GOOGLE_PING_IP(8, 8, 8, 8);
 static const char* ROMANIA_TZ = "EET-2EEST,M3.5.0/3,M10.5.0/4";
+static constexpr AlarmTimings ALARM_TIMINGS = { EXIT_DELAY_MS, ENTRY_DELAY_MS, ALARM_DURATION_MS, MOTION_RETRIGGER_MS };
+static constexpr ZoneHealthConfig ZONE_HEALTH_CONFIG = { ZONE_STUCK_HIGH_MS, ZONE_DUTY_WINDOW_MS, ZONE_DUTY_MAX_PCT, ZONE_TRIP_SLOT_MS, ZONE_TRIP_SLOTS_MAX, ZONE_SWINGER_LIMIT };
+static ZoneHealth<4> zoneHealth;
+
+// ----------------------------
+// Power-cycle pe mai multe echipamente (include/power_watchdog.h)
+// ----------------------------
+// Indexul din enum = bitul din `via` / `upstream`. Routerul rămâne pe releul
+// de internet (relay_scheduler.h: impulsul, WiFi căzut, holdoff din RTC);
+// celelalte au canalul lor. Pin -1 = fără releu: echipamentul intră doar în
+// diagnostic. NodeMCU nu mai are pini liberi siguri: GPIO15 (D8) merge doar
+// cu un modul activ HIGH (pull-down la boot); pentru switch e nevoie de un
+// expander sau de a doua placă. O țintă LAN are sens doar cu switch-ul pe releu.
+enum PowerDeviceId : uint8_t { POWER_MODEM, POWER_ROUTER, POWER_POE_SWITCH, POWER_DEVICE_COUNT };
+enum PowerTargetId : uint8_t { POWER_TARGET_GATEWAY, POWER_TARGET_PUBLIC, POWER_TARGET_LAN_HOST, POWER_TARGET_COUNT };
+
+struct PowerRelayChannel {
+  int pin;
+  int onLevel;
+  int offLevel;
+};
+
+static const PowerRelayChannel POWER_RELAYS[POWER_DEVICE_COUNT] = {
+  { -1, HIGH, LOW },                                        // modem (ex. GPIO15 / D8, modul activ HIGH)
+  { PIN_RELAY1_INTERNET, RELAY_ON_LEVEL, RELAY_OFF_LEVEL },  // router
+  { -1, RELAY_ON_LEVEL, RELAY_OFF_LEVEL },                  // switch PoE
+};
+
+static const PowerDeviceConfig POWER_DEVICES[POWER_DEVICE_COUNT] = {
+  // nume, upstream, are releu, impuls, boot, cooldown
+  { "MODEM", POWER_WD_NONE, POWER_RELAYS[POWER_MODEM].pin >= 0, 10'000, 120'000, 30UL * 60'000 },
+  { "ROUTER", POWER_MODEM, true, INTERNET_RELAY_PULSE_MS, 90'000, INTERNET_RELAY_COOLDOWN_MS },
+  { "POE_SWITCH", POWER_ROUTER, POWER_RELAYS[POWER_POE_SWITCH].pin >= 0, 5'000, 45'000, 15UL * 60'000 },
+};
+
+static const PowerTargetConfig POWER_TARGETS[POWER_TARGET_COUNT] = {
+  // nume, echipamente pe drum, eșecuri până la DOWN, interval (0 = ping-ul Google de mai sus)
+  { "GATEWAY", powerDeviceBit(POWER_ROUTER), 3, 30'000 },
+  { "PUBLIC", powerDeviceBit(POWER_ROUTER) | powerDeviceBit(POWER_MODEM), 2, 0 },
+  { "LAN_HOST", powerDeviceBit(POWER_ROUTER) | powerDeviceBit(POWER_POE_SWITCH), 3, 30'000 },
+};
+static const IPAddress POWER_LAN_HOST_IP(0, 0, 0, 0);  // ex. NVR-ul din spatele switch-ului; 0.0.0.0 = fără țintă LAN
+static PowerWatchdog powerWatchdog;
 
 // ----------------------------
 // Stare
 // ----------------------------
-enum class AlarmState : uint8_t { DISARMED,
-                                  ARMING,
-                                  ARMED,
-                                  ALARMING };
-static AlarmState state = AlarmState::DISARMED;
-
-static uint32_t stateSinceMs = 0;
-static uint32_t alarmUntilMs = 0;
-static uint32_t lastMotionMs[4] = { 0, 0, 0, 0 };
-static uint32_t lastGooglePingMs = 0;
-static uint32_t pingCounter = 0;
-static bool pingDownActive = false;
-static time_t pingDownStartRealEpoch = 0;
-static time_t lastWifiDisconnectRealEpoch = 0;
-static bool internetCutActive = false;  // D2 active LOW când cade ping
-static uint32_t internetCutUntilMs = 0;
-static uint32_t internetRelayNextAllowedMs = 0;
-static uint32_t wifiDisconnectedSinceMs = 0;
-static uint32_t relaySchedulerUnlockMs = 0;
-static uint32_t relayInternetActivationCount = 0;
-static uint32_t wifiOffLivePrintLastMs = 0;
-static bool prevWifiConnected = false;
-static bool emulateWifiOff = false;
-static bool emulateWifiOffLogged = false;
-static uint32_t emulateWifiLastConnectTryMs = 0;
-static bool ntpStarted = false;
-static bool ntpReadyLogged = false;
-static bool ntpWaitingLogged = false;
-static uint32_t lastHttpTimeTryMs = 0;
-static uint32_t lastAutoStatusMs = 0;
-static uint32_t statusPrintCounter = 0;
+// Starea runtime stă într-un singur SystemState (system_state.h), scris doar
+// din loop()/setup(). Fiecare partiție are propria stare (tabelul din
+// alarm_fsm.h); `sys.alarmState` este rezumatul lor (prioritatea maximă).
+// Fiecare trecere prin loop() e o scriere seqlock: supervizorul (Ticker) și
+// alți cititori asincroni văd doar stări complete, de la finalul unei treceri.
+using SystemState = SystemStateT<ALARM_PARTITION_COUNT>;
+static SeqLocked<SystemState> systemState;
+static SystemState& sys = systemState.value();
+
+// Statusul automat incremental (status_delta.h): ține doar CRC-ul ultimei
+// valori raportate pentru fiecare câmp.
+static StatusDeltaEncoder statusDelta(STATUS_KEYFRAME_EVERY);
+static bool statusAutoDelta = STATUS_AUTO_DELTA;
+static_assert(static_cast<uint8_t>(StatusField::P4_TIMER) - static_cast<uint8_t>(StatusField::P1) + 1 == 2 * ALARM_PARTITION_MAX, "status fields per partition");
+
+// Raport de memorie la build (scripts/memory_report.py citește dimensiunile
+// simbolurilor din main.cpp.o). Nu sunt referite, deci --gc-sections le scoate
+// din firmware.
+extern "C" {
+__attribute__((used)) const uint8_t memory_report_state[sizeof(SystemState)] = {};
+__attribute__((used)) const uint8_t memory_report_msg_ro[MSG_CATALOG_BYTES_RO] = {};
+__attribute__((used)) const uint8_t memory_report_msg_en[MSG_CATALOG_BYTES_EN] = {};
+}
+
+// Etapa curentă din loop() (salvată în RTC pentru raportul de crash)
+enum class LoopStage : uint8_t { BOOT,
+                                 ALARM,
+                                 SERIAL_CMD,
+                                 WIFI_CONNECT,
+                                 TIME_SYNC,
+                                 HTTP_TIME_SYNC,
+                                 PING,
+                                 STATUS,
+                                 OTA,
+                                 IDLE };
+
+// De unde vine o comandă: UART (acces fizic, toate comenzile) sau consola TCP,
+// înainte/după LOGIN (vezi CONSOLE_TOKEN în config.h).
+enum class CmdSource : uint8_t { UART,
+                                 CONSOLE,
+                                 CONSOLE_LOGGED_IN };
+
+static const uint8_t WIFI_NETWORK_COUNT = sizeof(WIFI_NETWORKS) / sizeof(WIFI_NETWORKS[0]);
+static_assert(WIFI_NETWORK_COUNT >= 1 && WIFI_NETWORK_COUNT <= 16, "sys.wifiAttemptNetwork is a 4-bit field (indices 0..15)");
+
+// Ultima asociere bună (salvată în RTC): permite reconectare fără scan și fără
+// să așteptăm DHCP (adresa din cache e folosită doar până vine lease-ul nou).
+struct WifiCache {
+  uint32_t magic;
+  uint32_t crc;
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t mask;
+  uint32_t dns;
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t networkIndex;
+};
+static WifiCache wifiCache = {};
+// Scrise din callback-urile SDK-ului WiFi (al doilea scriitor), deci rămân în afara SystemState.
+static uint32_t wifiAssocAtMs = 0;
+static uint32_t wifiGotIpAtMs = 0;
+static uint32_t wifiLeaseRequestedMs = 0;  // != 0: DHCP pornit după o conectare rapidă, lease încă neprimit
+static WiFiEventHandler wifiConnectedHandler;
+static WiFiEventHandler wifiGotIpHandler;
 static String serialRxLine;
 
+// Tot ce se afișează trece prin `console`: UART + ring-ul comun din care se
+// servesc clienții consolei TCP (fiecare cu cursorul lui).
+static const size_t CONSOLE_RING_BYTES = 4096;
+static LogRing<CONSOLE_RING_BYTES> consoleRing;
+
+class LogConsole : public Print {
+ public:
+  size_t write(uint8_t c) override {
+    return write(&c, 1);
+  }
+  size_t write(const uint8_t* data, size_t len) override {
+    Serial.write(data, len);
+    consoleRing.write(data, len);
+    return len;
+  }
+  using Print::write;
+};
+static LogConsole console;
+
 // Forward declarations pentru MQTT
 static const char* stateToString(AlarmState s);
 #if 0
 static void publishState();
-static void enterState(AlarmState s);
+static bool alarmDispatch(uint8_t partition, AlarmEvent event);
 static void connectWifi();
 static void connectMqtt();
 static void pingGoogleIfNeeded();
 static void mqttCallback(char* topic, uint8_t* payload, unsigned int length);
 #else
-static void enterState(AlarmState s);
+static bool alarmDispatch(uint8_t partition, AlarmEvent event, uint32_t now);
+static uint8_t alarmDispatchAll(AlarmEvent event);
+static void traceAlarmDecision(uint8_t partition, AlarmState s);
 static void connectWifi();
 static bool isRealWifiConnected();
 static bool isWifiConnected();
@@ -128,129 +270,535 @@ static void runPingNow();
 static void performPingAndReport();
 static void applyRomaniaTimezone();
 static void ensureTimeSyncIfNeeded();
-static void tryHttpTimeSyncIfNeeded();
+static void tryHttpsTimeSyncIfNeeded();
+static void httpsCloseIfIdle();
+static void printHttpsStatus();
+static void putHttpsStatus(StatusDeltaEncoder& e);
 static uint32_t currentPingIntervalMs();
 static bool getLocalTimeSafe(struct tm* outTm);
 static void formatDurationMs(uint32_t durationMs, char* out, size_t outSize);
 static void formatEpochDateTime(time_t epoch, char* out, size_t outSize, bool includeSeconds);
 static void formatDateTime(char* out, size_t outSize, bool includeSeconds);
-static void logEvent(const char* message);
-static void updateInternetCutRelayPulse();
-static void handleWifiReconnectRelayRetry();
-static void enforceInternetRelayOffWhenWifiConnected();
-static void updateWifiDisconnectTracking();
+static void logEvent(const char* message, uint8_t severity = SYSLOG_SEV_NOTICE);
+static void updateInternetRelay(uint32_t now, bool wifiConnected);
+static void traceRelayDecision(uint8_t decision, uint32_t now);
+static void tracePingResult(bool ok, uint32_t now);
+static void traceCommand(const String& cmd);
+static void traceRequestFlush(const char* reason, bool force);
+static void traceDumpRam();
+static void traceDumpSaved();
 static void printStatusEvery30SecIfNeeded();
 static void printWifiOffLiveTelemetryEverySec();
 static void handleSerialCommands();
-static void processSerialCommand(String cmd);
+static void processSerialCommand(String cmd, CmdSource source);
 static void printRuntimeStatus();
+static void printStatusDelta();
 static void printBootInfo();
 static void startupRelayStartupTest();
+static const char* loopStageToString(LoopStage s);
+static void setLoopStage(LoopStage s);
+static void supervisorCheckIn(uint8_t task);
+static void supervisorBegin();
+static void loadCrashContextAtBoot();
+static void printCrashReport();
+static void restoreAlarmPartitions();
+static void loadPersistedState();
+static void persistArmStateIfChanged();
+static void saveRelaySchedulerRtc(const SystemState& snap);
+static void restoreRelayScheduler();
+static void updateStartupRelayTest();
+static bool otaStart(const char* url, bool rollback);
+static void otaUpdate();
+static void otaBootCheck();
+static void otaHealthCheck();
+static bool otaActive();
+static void printOtaStatus();
+static void putOtaStatus(StatusDeltaEncoder& e);
+static void wifiRoamingBegin();
+static void sendTelemetryIfNeeded();
+static void sendTelemetryEvent(Msg id, uint8_t severity, const MsgArg* args, size_t argCount);
+static void setTelemetryInterval(uint32_t intervalMs);
+static void syslogEnqueue(const char* message, uint8_t severity);
+static void syslogFlushIfNeeded();
+static void printSyslogStatus();
+static bool resolveHost(const char* host, IPAddress& ip);
+static bool pingHost(const IPAddress& ip);
+static bool faultRoll(Fault f);
+static int32_t faultAmount(Fault f);
+static void faultNotePing(bool ok, uint8_t decision);
+static void faultStep(uint32_t now);
+static void faultCommand(const String& cmd);
+static void printFaultStatus();
+static void peerLocalArm(AlarmEvent event);
+static void peerLocalAlarm();
+static void peerBegin();
+static void peerStep();
+static void printPeerStatus();
+static void printNetArenaStatus();
+static void zoneHealthStep(uint32_t now, uint8_t pirLevels);
+static void printZoneHealthStatus();
+static void printButtonStatus();
+static void printConsoleStatus();
+static void putConsoleStatus(StatusDeltaEncoder& e);
+static void printTraceStatus();
+static void putTraceStatus(StatusDeltaEncoder& e);
+static void printEventBusStatus();
+static void powerWatchdogBegin();
+static void powerWatchdogStep(uint32_t now);
+static void printPowerWatchdogStatus();
+static bool traceMountFs();
+static void tsdbBegin();
+static uint8_t tsdbFlush();
+static void tsdbSampleIfNeeded();
+static void tsdbStartQuery(uint32_t from, uint32_t to);
+static void tsdbQueryStep();
+static void printTsdbStatus();
+static void saveWifiCacheRtc();
+static void loadWifiCacheRtc();
 #endif
 
-// Buton
-static bool buttonStable = true;  // true = HIGH (neapasat, pullup)
-static bool buttonLastRead = true;
-static uint32_t buttonLastChangeMs = 0;
-static uint32_t buttonPressStartMs = 0;
-static bool longPressHandled = false;
+// ----------------------------
+// Mesaje de consolă (catalogul din messages.h, în flash)
+// ----------------------------
+// Limba se alege la build (CONSOLE_LANG din config.h) și la runtime (LANG RO|EN).
+static MsgLang consoleLang = MsgLang::RO;
+static const size_t MSG_LINE_MAX = 200;
+
+template <typename... Args>
+static void msgPrint(Msg id, const Args&... args) {
+  char line[MSG_LINE_MAX];
+  const size_t n = msgFormat(line, sizeof(line), consoleLang, id, args...);
+  console.write(reinterpret_cast<const uint8_t*>(line), n);
+}
 
-static void setOutputs(bool relay1On, bool relay2On, bool ledOn) {
-  digitalWrite(PIN_RELAY1_INTERNET, relay1On ? RELAY_ON_LEVEL : RELAY_OFF_LEVEL);
-  digitalWrite(PIN_RELAY2, relay2On ? RELAY_ON_LEVEL : RELAY_OFF_LEVEL);
+template <typename... Args>
+static void msgPrintln(Msg id, const Args&... args) {
+  msgPrint(id, args...);
+  console.println();
+}
 
-#if defined(ESP8266)
-  // LED on-board activ LOW
-  digitalWrite(PIN_LED, ledOn ? LOW : HIGH);
+// Severitatea în syslog: ce înseamnă o pană sau o intervenție e WARNING, restul NOTICE.
+static uint8_t syslogSeverity(Msg id) {
+  switch (id) {
+    case Msg::EVT_INTERNET_DOWN:
+    case Msg::EVT_WIFI_DOWN:
+    case Msg::EVT_WIFI_CONNECT_FAILED:
+    case Msg::EVT_RELAY_ACTIVATED:
+    case Msg::EVT_POWER_CUT:
+    case Msg::EVT_OTA_ABORTED:
+    case Msg::EVT_TRACE_FLUSH_FAILED:
+    case Msg::EVT_PEER_ALARM:
+    case Msg::EVT_ZONE_BYPASSED:
+      return SYSLOG_SEV_WARNING;
+    default:
+      return SYSLOG_SEV_NOTICE;
+  }
+}
+
+// Textul merge în consolă și syslog; ID-ul și argumentele, într-un cadru
+// TELEMETRY_TYPE_EVENT către colector.
+template <typename... Args>
+static void logEvent(Msg id, const Args&... args) {
+  static_assert(sizeof...(Args) <= TELEMETRY_EVENT_MAX_ARGS, "too many arguments for a telemetry event frame");
+  const MsgArg argv[sizeof...(Args) + 1] = { MsgArg(args)..., MsgArg(0) };
+  char message[96];
+  msgRender(message, sizeof(message), msgText(consoleLang, id), argv, sizeof...(Args));
+  const uint8_t severity = syslogSeverity(id);
+  logEvent(message, severity);
+  sendTelemetryEvent(id, severity, argv, sizeof...(Args));
+}
+
+// ----------------------------
+// Magistrală de evenimente (event_bus.h)
+// ----------------------------
+// Tranzițiile de alarmă și deciziile releului doar se postează (copie de 12 B
+// în coadă); log-ul, telemetria etc. le primesc din eventBusDispatch(), după
+// partea de alarmă/rețea a trecerii. O ieșire nouă = un abonat nou în listă,
+// fără modificări la producători.
+struct ConsoleEventSink {
+  static constexpr uint32_t TOPICS = busTopicBit(BusTopic::ALARM_STATE) | busTopicBit(BusTopic::RELAY_DECISION) | busTopicBit(BusTopic::POWER_CYCLE);
+  static void onEvent(const BusEvent& e);
+};
+
+struct TelemetryEventSink {
+  static constexpr uint32_t TOPICS = busTopicBit(BusTopic::ALARM_STATE) | busTopicBit(BusTopic::RELAY_DECISION) | busTopicBit(BusTopic::POWER_CYCLE);
+  static void onEvent(const BusEvent& e);
+};
+
+#if 0
+struct MqttEventSink {
+  static constexpr uint32_t TOPICS = busTopicBit(BusTopic::ALARM_STATE);
+  static void onEvent(const BusEvent&) { publishState(); }
+};
+static EventBus<16, ConsoleEventSink, TelemetryEventSink, MqttEventSink> eventBus;
 #else
-  // LED extern activ HIGH (fallback)
-  digitalWrite(PIN_LED, ledOn ? HIGH : LOW);
+static EventBus<16, ConsoleEventSink, TelemetryEventSink> eventBus;
 #endif
+
+// Costul post-ului (cicluri CPU, contează pe calea PIR -> tranziție) și al livrării.
+static uint32_t eventPostCalls = 0;
+static uint32_t eventPostCyclesTotal = 0;
+static uint32_t eventPostCyclesMax = 0;
+static uint32_t eventDispatchUsMax = 0;
+
+static void eventPost(BusTopic topic, uint8_t a, uint8_t b, uint32_t value) {
+  const uint32_t start = ESP.getCycleCount();
+  eventBus.post(topic, a, b, value, millis());
+  const uint32_t cycles = ESP.getCycleCount() - start;
+  ++eventPostCalls;
+  eventPostCyclesTotal += cycles;
+  if (cycles > eventPostCyclesMax) eventPostCyclesMax = cycles;
 }
 
-static void enterState(AlarmState s) {
-  state = s;
-  stateSinceMs = millis();
+static void eventBusDispatch() {
+  if (eventBus.depth() == 0) return;
+  const uint32_t start = micros();
+  eventBus.dispatch();
+  const uint32_t us = micros() - start;
+  if (us > eventDispatchUsMax) eventDispatchUsMax = us;
+}
 
-  switch (state) {
-    case AlarmState::DISARMED:
-      setOutputs(internetCutActive, false, false);
-      break;
-    case AlarmState::ARMING:
-      // clipire lentă cât timp se armează
-      setOutputs(internetCutActive, false, true);
-      break;
-    case AlarmState::ARMED:
-      setOutputs(internetCutActive, false, true);
-      break;
-    case AlarmState::ALARMING:
-      // ambele sirene ON + LED ON
-      setOutputs(internetCutActive, true, true);
-      alarmUntilMs = millis() + ALARM_DURATION_MS;
-      break;
+// Aceleași linii [ EVENT= ...] (și statusul complet la căderi) ca înainte,
+// în aceeași ordine în care erau scrise direct de producători.
+void ConsoleEventSink::onEvent(const BusEvent& e) {
+  if (e.topic == BusTopic::ALARM_STATE) {
+    logEvent(Msg::EVT_ALARM_STATE, stateToString(static_cast<AlarmState>(e.b)), e.a + 1);
+    return;
+  }
+  if (e.topic == BusTopic::POWER_CYCLE) {
+    const char* name = POWER_DEVICES[e.a].name;
+    if (e.b == PowerAction::CUT) logEvent(Msg::EVT_POWER_CUT, name, e.value);
+    if (e.b == PowerAction::RESTORE) logEvent(Msg::EVT_POWER_RESTORE, name);
+    if (e.b == PowerAction::SETTLED) logEvent(Msg::EVT_POWER_SETTLED, name);
+    return;
   }
+  const uint8_t d = e.a;
+  if (d & RELAY_DECISION_WIFI_DOWN) {
+    logEvent(Msg::EVT_WIFI_DOWN);
+    printRuntimeStatus();
+  }
+  if (d & RELAY_DECISION_WIFI_UP) logEvent(Msg::EVT_WIFI_UP);
+  if (d & RELAY_DECISION_FORCED_INACTIVE) logEvent(Msg::EVT_RELAY_FORCED_INACTIVE);
+  if (d & RELAY_DECISION_DEACTIVATED) logEvent(Msg::EVT_RELAY_DEACTIVATED);
+  if (d & RELAY_DECISION_PING_DOWN) {
+    logEvent(Msg::EVT_INTERNET_DOWN);
+    printRuntimeStatus();
+  }
+  if (d & RELAY_DECISION_ACTIVATED) logEvent(Msg::EVT_RELAY_ACTIVATED);
+}
 
-#if 0
-  publishState();
+static void printEventBusStatus() {
+  console.print(F("Event bus: posted "));
+  console.print(eventBus.posted());
+  console.print(F(", max depth "));
+  console.print(eventBus.maxDepth());
+  console.print(F("/"));
+  console.print(eventBus.capacity());
+  console.print(F(", inline "));
+  console.print(eventBus.inlineDrains());
+  console.print(F(", post avg "));
+  console.print(eventPostCalls ? eventPostCyclesTotal / eventPostCalls : 0);
+  console.print(F(" cycles (max "));
+  console.print(eventPostCyclesMax);
+  console.print(F("), dispatch max "));
+  console.print(eventDispatchUsMax);
+  console.println(F(" us"));
+}
+
+// Buton: fronturile vin din ISR (button_gesture.h), gesturile se decodează în loop()
+static constexpr ButtonGestureConfig BUTTON_GESTURE_CONFIG = { DEBOUNCE_MS, LONG_PRESS_MS, BUTTON_MULTI_GAP_MS };
+static ButtonEdgeQueue<64> buttonEdges;
+static ButtonGestureDecoder buttonDecoder;
+
+// Testul releelor de la pornire e o corutină (relay_selftest.h) reluată din
+// loop(); cât timp e activă, impulsurile ei se suprapun (OR) peste comanda
+// normală a releelor.
+static RelaySelfTest startupTest;
+
+// Ultimele niveluri scrise pe pini: digitalWrite() doar când se schimbă ceva.
+static bool outputsWritten = false;
+static bool outputRelay1On = false;
+static bool outputRelay2On = false;
+static bool outputLedOn = false;
+
+static void setOutputs(bool relay1On, bool relay2On, bool ledOn) {
+  relay1On = relay1On || startupTest.relayOn[0];
+  relay2On = relay2On || startupTest.relayOn[1];
+  if (!outputsWritten || relay1On != outputRelay1On) {
+    digitalWrite(PIN_RELAY1_INTERNET, relay1On ? RELAY_ON_LEVEL : RELAY_OFF_LEVEL);
+  }
+  if (!outputsWritten || relay2On != outputRelay2On) {
+    digitalWrite(PIN_RELAY2, relay2On ? RELAY_ON_LEVEL : RELAY_OFF_LEVEL);
+  }
+  if (!outputsWritten || ledOn != outputLedOn) {
+#if defined(ESP8266)
+    // LED on-board activ LOW
+    digitalWrite(PIN_LED, ledOn ? LOW : HIGH);
+#else
+    // LED extern activ HIGH (fallback)
+    digitalWrite(PIN_LED, ledOn ? HIGH : LOW);
 #endif
-  char eventMsg[48];
-  snprintf(eventMsg, sizeof(eventMsg), "Alarm state -> %s", stateToString(state));
-  logEvent(eventMsg);
+  }
+  outputsWritten = true;
+  outputRelay1On = relay1On;
+  outputRelay2On = relay2On;
+  outputLedOn = ledOn;
 }
 
-static void toggleArmDisarm() {
-  if (state == AlarmState::DISARMED) {
-    enterState(AlarmState::ARMING);
-  } else {
-    // orice altă stare => dezarmare imediată
-    enterState(AlarmState::DISARMED);
+static bool ledPatternLevel(LedPattern pattern, uint32_t now) {
+  switch (pattern) {
+    case LedPattern::OFF: return false;
+    case LedPattern::ON: return true;
+    case LedPattern::BLINK: return ((now / 500) % 2) == 0;
+    case LedPattern::SLOW_BLINK: return ((now / 1000) % 2) == 0;
+    case LedPattern::FAST_BLINK: return ((now / 125) % 2) == 0;
   }
+  return false;
 }
 
-static void updateButton() {
+// Sirena și LED-ul rezultă din starea rezumat; releul de internet din scheduler.
+// Apelat din loop() la fiecare trecere, dar scrie pinii doar la schimbări.
+static void refreshOutputs(uint32_t now) {
+  const AlarmStateInfo& info = ALARM_STATE_INFO[static_cast<uint8_t>(sys.alarmState)];
+  setOutputs(sys.relay.cutActive, info.siren, ledPatternLevel(info.led, now));
+}
+
+static AlarmState summarizePartitions() {
+  AlarmState summary = sys.partitions[0].state;
+  for (uint8_t i = 1; i < ALARM_PARTITION_COUNT; ++i) {
+    if (ALARM_STATE_INFO[static_cast<uint8_t>(sys.partitions[i].state)].priority > ALARM_STATE_INFO[static_cast<uint8_t>(summary)].priority) {
+      summary = sys.partitions[i].state;
+    }
+  }
+  return summary;
+}
+
+// Efectele unei tranziții deja aplicate pe partiție: ieșiri, persistență, log.
+static void partitionEntered(uint8_t p, uint32_t now) {
+  const AlarmState s = sys.partitions[p].state;
+  sys.alarmState = summarizePartitions();
+  refreshOutputs(now);
+  traceAlarmDecision(p, s);
+  persistArmStateIfChanged();
+  eventPost(BusTopic::ALARM_STATE, p, static_cast<uint8_t>(s), sys.alarmTriggerCount);
+  if (s == AlarmState::ALARMING) peerLocalAlarm();
+}
+
+// Intrare directă într-o stare (restaurare după reboot), cu timer-ul ei.
+static void enterPartitionState(uint8_t p, AlarmState s) {
+  AlarmPartition& part = sys.partitions[p];
+  const uint32_t now = millis();
+  part.state = s;
+  part.sinceMs = now;
+  const uint32_t timerMs = alarmTimerMs(ALARM_STATE_INFO[static_cast<uint8_t>(s)].timer, ALARM_TIMINGS);
+  part.timerActive = timerMs != 0;
+  part.timerDeadlineMs = now + timerMs;
+  partitionEntered(p, now);
+}
+
+// Tranziția e calculată de alarmApply() (alarm_fsm.h), același cod ca în replay.
+static bool alarmDispatch(uint8_t p, AlarmEvent event, uint32_t now) {
+  if (p >= ALARM_PARTITION_COUNT) return false;
+  if (!alarmApply(sys.partitions[p], event, now, ALARM_TIMINGS, &sys.alarmTriggerCount)) return false;
+  partitionEntered(p, now);
+  return true;
+}
+
+static uint8_t alarmDispatchAll(AlarmEvent event) {
   const uint32_t now = millis();
-  const bool reading = (digitalRead(PIN_BUTTON) == HIGH);  // HIGH = neapasat
+  uint8_t handled = 0;
+  for (uint8_t i = 0; i < ALARM_PARTITION_COUNT; ++i) {
+    if (alarmDispatch(i, event, now)) ++handled;
+  }
+  peerLocalArm(event);
+  return handled;
+}
 
-  if (reading != buttonLastRead) {
-    buttonLastRead = reading;
-    buttonLastChangeMs = now;
+static void updateAlarmTimers(uint32_t now) {
+  alarmTimersStep(sys.partitions, ALARM_PARTITION_COUNT, now, [now](uint8_t p, AlarmEvent event) { alarmDispatch(p, event, now); });
+}
+
+static void toggleArmDisarm() {
+  if (sys.alarmState == AlarmState::DISARMED) {
+    alarmDispatchAll(AlarmEvent::ARM_AWAY);
+  } else {
+    // orice altă stare => dezarmare imediată (toate partițiile)
+    alarmDispatchAll(AlarmEvent::DISARM);
   }
+}
 
-  // debounce
-  if ((now - buttonLastChangeMs) > DEBOUNCE_MS && reading != buttonStable) {
-    buttonStable = reading;
+// Gesturile butonului: '.' = apăsare scurtă, '-' = ținut LONG_PRESS_MS.
+// Seria se încheie după BUTTON_MULTI_GAP_MS fără altă apăsare; o apăsare
+// singură nu face nimic (GPIO0 e și butonul FLASH de pe placă).
+enum class ButtonAction : uint8_t { TOGGLE_ARM, ARM_STAY, SILENCE, ROUTER_CYCLE };
 
-    // tranziție stabilă
-    if (buttonStable == false) {  // a devenit LOW = apăsat
-      buttonPressStartMs = now;
-      longPressHandled = false;
-    } else {  // eliberat
-      buttonPressStartMs = 0;
-      longPressHandled = false;
-    }
+struct ButtonCode {
+  uint8_t shorts;
+  bool longPress;
+  ButtonAction action;
+  const char* name;
+};
+
+static constexpr ButtonCode BUTTON_CODES[] = {
+  { 0, true, ButtonAction::TOGGLE_ARM, "ARM/DISARM" },  // -    (ca înainte)
+  { 2, false, ButtonAction::ARM_STAY, "STAY" },         // ..
+  { 3, false, ButtonAction::SILENCE, "SILENCE" },       // ...  sirena tace, partiția rămâne armată
+  { 3, true, ButtonAction::ROUTER_CYCLE, "ROUTER" },    // ...- impuls pe releul routerului
+};
+
+static void IRAM_ATTR buttonIsr() {
+  buttonEdges.push(millis(), digitalRead(PIN_BUTTON) == LOW);  // LOW = apăsat (pullup)
+}
+
+static uint32_t buttonGestureCount = 0;
+static uint32_t buttonLagMsMax = 0;  // decizia după fronturi -> execuția în loop()
+static ButtonGesture buttonLastGesture = {};
+static const char* buttonLastAction = "-";
+
+// Alarma se termină ca la expirarea sirenei: partiția revine în modul armat.
+static void silenceSiren(uint32_t now) {
+  for (uint8_t i = 0; i < ALARM_PARTITION_COUNT; ++i) {
+    if (sys.partitions[i].state == AlarmState::ALARMING) alarmDispatch(i, AlarmEvent::TIMEOUT, now);
   }
+}
+
+// Ca un impuls pornit de scheduler: cooldown-ul și watchdog-ul îl văd la fel.
+static void forceRouterCycle(uint32_t now) {
+  if (sys.relay.cutActive) return;
+  powerWatchdog.noteExternalCycle(POWER_ROUTER, now);
+  eventPost(BusTopic::RELAY_DECISION, relayActivate(sys.relay, now), 0, sys.relay.activationCount);
+}
 
-  // long press
-  if (buttonStable == false && !longPressHandled && buttonPressStartMs != 0 && (now - buttonPressStartMs) >= LONG_PRESS_MS) {
-    longPressHandled = true;
-    toggleArmDisarm();
+static void onButtonGesture(const ButtonGesture& g, uint32_t now) {
+  const ButtonCode* code = nullptr;
+  for (const ButtonCode& c : BUTTON_CODES) {
+    if (c.shorts == g.shorts && c.longPress == g.longPress) code = &c;
+  }
+  if (code == nullptr && g.shorts <= 1 && !g.longPress) return;
+
+  ++buttonGestureCount;
+  buttonLastGesture = g;
+  buttonLastAction = code != nullptr ? code->name : "none";
+  if (now - g.atMs > buttonLagMsMax) buttonLagMsMax = now - g.atMs;
+  char text[BUTTON_SHORTS_MAX + 2];
+  buttonGestureCode(g, text, sizeof(text));
+  logEvent(Msg::EVT_BUTTON_GESTURE, text, buttonLastAction, now - g.atMs);
+  if (code == nullptr) return;
+
+  switch (code->action) {
+    case ButtonAction::TOGGLE_ARM: toggleArmDisarm(); break;
+    case ButtonAction::ARM_STAY: alarmDispatchAll(AlarmEvent::ARM_STAY); break;
+    case ButtonAction::SILENCE: silenceSiren(now); break;
+    case ButtonAction::ROUTER_CYCLE: forceRouterCycle(now); break;
   }
 }
 
-static bool motionDetected() {
+// `now` se citește înaintea golirii cozii: orice front de până atunci e deja
+// în coadă, deci termenele de până la `now` se decid corect.
+static void updateButton() {
   const uint32_t now = millis();
-  bool any = false;
+  const auto emit = [](const ButtonGesture& g) { onButtonGesture(g, millis()); };
+  ButtonEdge e;
+  while (buttonEdges.pop(&e)) buttonDecoder.feed(e, emit);
+  buttonDecoder.poll(now, emit);
+}
 
-  for (int i = 0; i < 4; ++i) {
-    if (digitalRead(PIN_PIR[i]) == HIGH) {
-      if (now - lastMotionMs[i] >= MOTION_RETRIGGER_MS) {
-        lastMotionMs[i] = now;
-        any = true;
-      }
+static void printButtonStatus() {
+  console.print(F("Button: edges "));
+  console.print(buttonEdges.popped());
+  console.print(F(" (bounces merged "));
+  console.print(buttonEdges.coalesced());
+  console.print(F(", dropped "));
+  console.print(buttonEdges.dropped());
+  console.print(F(", queue max "));
+  console.print(buttonEdges.maxDepth());
+  console.print(F("/"));
+  console.print(buttonEdges.capacity());
+  console.print(F("), gestures "));
+  console.print(buttonGestureCount);
+  if (buttonGestureCount != 0) {
+    char text[BUTTON_SHORTS_MAX + 2];
+    buttonGestureCode(buttonLastGesture, text, sizeof(text));
+    console.print(F(", last "));
+    console.print(text);
+    console.print(F(" -> "));
+    console.print(buttonLastAction);
+  }
+  console.print(F(", lag max "));
+  console.print(buttonLagMsMax);
+  console.println(F(" ms"));
+}
+
+// PIR-urile (citite o dată la începutul trecerii) contează doar pentru
+// partițiile armate; tabelul decide ce face mișcarea după tipul zonei.
+static uint8_t peerTripLevels = 0;  // PIR-urile din trecerea care a pornit alarma (pentru plăcile vecine)
+
+// Zonele ocolite (sys.zoneBypass) nu mai ajung la tabel. O zonă care a dus
+// partiția în ENTRY_DELAY/ALARMING în trecerea asta se numără pentru limita
+// de alarme pe armare (ZONE_SWINGER_LIMIT).
+static void updateZones(uint32_t now, uint8_t pirLevels) {
+  const uint8_t levels = pirLevels & static_cast<uint8_t>(~sys.zoneBypass);
+  alarmZonesStep(ALARM_ZONES, 4, sys.partitions, levels, sys.lastMotionMs, now, ALARM_TIMINGS, [now, levels](uint8_t p, AlarmEvent event) {
+    peerTripLevels = levels;
+    alarmDispatch(p, event, now);
+    peerTripLevels = 0;
+  });
+  for (uint8_t i = 0; i < 4; ++i) {
+    const AlarmPartition& part = sys.partitions[ALARM_ZONES[i].partition];
+    if (!(levels & (1u << i)) || sys.lastMotionMs[i] != now || part.sinceMs != now) continue;
+    if (part.state == AlarmState::ALARMING || part.state == AlarmState::ENTRY_DELAY) zoneHealth.noteAlarm(i);
+  }
+}
+
+// ----------------------------
+// Sănătatea PIR-urilor (zone_health.h)
+// ----------------------------
+// Rulează în faza de intrări, înaintea pașilor urmăriți: o ocolire nouă intră
+// în urmă ca schimbare externă de stare, deci replay-ul o aplică exact.
+static void zoneHealthStep(uint32_t now, uint8_t pirLevels) {
+  uint8_t watch = 0;
+  for (uint8_t i = 0; i < 4; ++i) {
+    const AlarmState s = sys.partitions[ALARM_ZONES[i].partition].state;
+    if (ALARM_STATE_INFO[static_cast<uint8_t>(s)].armed) watch |= static_cast<uint8_t>(1u << i);
+  }
+  zoneHealth.step(now, pirLevels, watch);
+  const uint8_t mask = zoneHealth.bypassMask();
+  const uint8_t changed = mask ^ sys.zoneBypass;
+  if (changed == 0) return;
+  sys.zoneBypass = mask;
+  for (uint8_t i = 0; i < 4; ++i) {
+    if (!(changed & (1u << i))) continue;
+    if (mask & (1u << i)) {
+      logEvent(Msg::EVT_ZONE_BYPASSED, i + 1, ZONE_FAULT_NAMES[static_cast<uint8_t>(zoneHealth.fault(i))]);
+    } else {
+      logEvent(Msg::EVT_ZONE_RESTORED, i + 1);
     }
   }
+}
 
-  return any;
+static void printZoneHealthStatus() {
+  const uint32_t now = millis();
+  console.print(F("Zones:"));
+  for (uint8_t i = 0; i < 4; ++i) {
+    console.print(i == 0 ? F(" Z") : F(" | Z"));
+    console.print(i + 1);
+    console.print(F(" "));
+    console.print(ZONE_FAULT_NAMES[static_cast<uint8_t>(zoneHealth.fault(i))]);
+    if (sys.zoneBypass & (1u << i)) console.print(F(" BYPASSED"));
+    console.print(F(" duty "));
+    console.print(zoneHealth.dutyPct(i, now));
+    console.print(F("%, trips "));
+    console.print(zoneHealth.tripSlots(i));
+    console.print(F("/32, alarms "));
+    console.print(zoneHealth.alarms(i));
+    const uint32_t highMs = zoneHealth.highForMs(i, now);
+    if (highMs >= 1'000) {
+      console.print(F(", high "));
+      console.print(highMs / 1'000);
+      console.print(F(" s"));
+    }
+  }
+  console.println();
 }
 
 // ----------------------------
@@ -258,11 +806,22 @@ static bool motionDetected() {
 // ----------------------------
 
 static const char* stateToString(AlarmState s) {
+  const uint8_t i = static_cast<uint8_t>(s);
+  return i < ALARM_STATE_COUNT ? ALARM_STATE_INFO[i].name : "UNKNOWN";
+}
+
+static const char* loopStageToString(LoopStage s) {
   switch (s) {
-    case AlarmState::DISARMED: return "DISARMED";
-    case AlarmState::ARMING: return "ARMING";
-    case AlarmState::ARMED: return "ARMED";
-    case AlarmState::ALARMING: return "ALARMING";
+    case LoopStage::BOOT: return "BOOT";
+    case LoopStage::ALARM: return "ALARM";
+    case LoopStage::SERIAL_CMD: return "SERIAL_CMD";
+    case LoopStage::WIFI_CONNECT: return "WIFI_CONNECT";
+    case LoopStage::TIME_SYNC: return "TIME_SYNC";
+    case LoopStage::HTTP_TIME_SYNC: return "HTTP_TIME_SYNC";
+    case LoopStage::PING: return "PING";
+    case LoopStage::STATUS: return "STATUS";
+    case LoopStage::OTA: return "OTA";
+    case LoopStage::IDLE: return "IDLE";
   }
   return "UNKNOWN";
 }
@@ -272,11 +831,11 @@ static void publishState() {
   if (!mqttClient.connected()) return;
 
   char payload[64];
-  snprintf(payload, sizeof(payload), "STATE:%s", stateToString(state));
+  snprintf(payload, sizeof(payload), "STATE:%s", stateToString(sys.alarmState));
 
   mqttClient.publish(MQTT_TOPIC, payload, true);  // retained
-  Serial.print("MQTT publish: ");
-  Serial.println(payload);
+  console.print(F("MQTT publish: "));
+  console.println(payload);
 }
 
 static void mqttCallback(char* topic, uint8_t* payload, unsigned int length) {
@@ -290,8 +849,8 @@ static void mqttCallback(char* topic, uint8_t* payload, unsigned int length) {
 
   msg.trim();
 
-  Serial.print("MQTT recv: ");
-  Serial.println(msg);
+  console.print(F("MQTT recv: "));
+  console.println(msg);
 
   // Comenzi așteptate: "CMD:ARM", "CMD:DISARM"
   if (!msg.startsWith("CMD:")) {
@@ -302,17 +861,17 @@ static void mqttCallback(char* topic, uint8_t* payload, unsigned int length) {
   cmd.toUpperCase();
 
   if (cmd == "ARM") {
-    if (state == AlarmState::DISARMED) {
-      enterState(AlarmState::ARMING);
-    }
+    alarmDispatchAll(AlarmEvent::ARM_AWAY);
+  } else if (cmd == "STAY") {
+    alarmDispatchAll(AlarmEvent::ARM_STAY);
   } else if (cmd == "DISARM") {
-    enterState(AlarmState::DISARMED);
+    alarmDispatchAll(AlarmEvent::DISARM);
   }
 }
 #endif
 
 static bool isWifiConnected() {
-  if (emulateWifiOff) return false;
+  if (sys.emulateWifiOff) return false;
   return WiFi.status() == WL_CONNECTED;
 }
 
@@ -320,56 +879,416 @@ static bool isRealWifiConnected() {
   return WiFi.status() == WL_CONNECTED;
 }
 
+static void beginWifiAttempt(bool fast, uint8_t networkIndex) {
+  if (networkIndex >= WIFI_NETWORK_COUNT) networkIndex = 0;
+  const WifiNetwork& net = WIFI_NETWORKS[networkIndex];
+  sys.wifiAttemptFast = fast;
+  sys.wifiAttemptNetwork = networkIndex;
+  wifiAssocAtMs = 0;
+  wifiGotIpAtMs = 0;
+  wifiLeaseRequestedMs = 0;
+  sys.wifiConnectStartMs = millis();
+
+  WiFi.mode(WIFI_STA);
+  if (fast) {
+    // IP static = ultimul lease DHCP; BSSID + canal => fără scan
+    WiFi.config(IPAddress(wifiCache.ip), IPAddress(wifiCache.gateway), IPAddress(wifiCache.mask), IPAddress(wifiCache.dns));
+    WiFi.begin(net.ssid, net.password, wifiCache.channel, wifiCache.bssid);
+  } else {
+    WiFi.config(IPAddress(0u), IPAddress(0u), IPAddress(0u));  // înapoi la DHCP
+    WiFi.begin(net.ssid, net.password);
+  }
+}
+
+// Adresa din cache nu e un lease: serverul DHCP nu știe că o folosim (o poate
+// da altui client când expiră) și nimeni nu o reînnoiește. IP-ul static e doar
+// pentru prima conectare; imediat după ea pornim clientul DHCP pe aceeași
+// asociere (fără reasociere). Serverul dă de regulă aceeași adresă; de aici
+// lwIP reînnoiește lease-ul singur. Dacă adresa e alta, conexiunile TCP
+// deschise (consola, HTTPS) se refac, iar cache-ul ia adresa nouă.
+static void wifiRequestLease() {
+  wifiGotIpAtMs = 0;
+  wifiLeaseRequestedMs = millis();
+  WiFi.config(IPAddress(0u), IPAddress(0u), IPAddress(0u));  // înapoi la DHCP
+}
+
+static void updateWifiCacheFromLink() {
+  const uint8_t* bssid = WiFi.BSSID();
+  if (bssid == nullptr) return;
+
+  WifiCache next = {};
+  next.ip = static_cast<uint32_t>(WiFi.localIP());
+  next.gateway = static_cast<uint32_t>(WiFi.gatewayIP());
+  next.mask = static_cast<uint32_t>(WiFi.subnetMask());
+  next.dns = static_cast<uint32_t>(WiFi.dnsIP());
+  memcpy(next.bssid, bssid, sizeof(next.bssid));
+  next.channel = static_cast<uint8_t>(WiFi.channel());
+  next.networkIndex = sys.wifiAttemptNetwork;
+  wifiCache = next;
+  sys.wifiCacheValid = true;
+  saveWifiCacheRtc();
+}
+
+static void wifiRoamingBegin() {
+  WiFi.persistent(false);       // fără scrieri în flash la fiecare WiFi.begin()
+  WiFi.setAutoReconnect(false);  // reconectarea (cache + fallback) e făcută de connectWifi()
+  wifiConnectedHandler = WiFi.onStationModeConnected([](const WiFiEventStationModeConnected&) {
+    wifiAssocAtMs = millis();
+  });
+  wifiGotIpHandler = WiFi.onStationModeGotIP([](const WiFiEventStationModeGotIP&) {
+    wifiGotIpAtMs = millis();
+  });
+  loadWifiCacheRtc();
+  sys.wifiNextAttemptFast = sys.wifiCacheValid;
+}
+
+// Non-blocant: pornește asocierea și revine; apelurile următoare din loop()
+// urmăresc progresul până la WIFI_CONNECT_TIMEOUT_MS, apoi reîncearcă.
 static void connectWifi() {
   if (isRealWifiConnected()) {
-    if (emulateWifiOff) {
-      emulateWifiOff = false;
-      emulateWifiOffLogged = false;
-      wifiDisconnectedSinceMs = 0;
-      logEvent("EMULATE_WIFI_OFF canceled -> REAL_WIFI_CONNECTED");
+    if (sys.emulateWifiOff) {
+      sys.emulateWifiOff = false;
+      sys.emulateWifiOffLogged = false;
+      sys.relay.wifiDisconnectedSinceMs = 0;
+      logEvent(Msg::EVT_WIFI_EMULATION_CANCELED);
+    }
+    if (sys.wifiConnectInProgress) {
+      sys.wifiConnectInProgress = false;
+      sys.wifiLastConnectFast = sys.wifiAttemptFast;
+      sys.wifiLastAssocMs = wifiAssocAtMs ? (wifiAssocAtMs - sys.wifiConnectStartMs) : 0;
+      sys.wifiLastIpMs = (wifiGotIpAtMs ? wifiGotIpAtMs : millis()) - sys.wifiConnectStartMs;
+      updateWifiCacheFromLink();
+      console.print(F("WiFi connected, IP: "));
+      console.println(WiFi.localIP());
+      console.print(F("WiFi connect: '"));
+      console.print(WIFI_NETWORKS[sys.wifiAttemptNetwork].ssid);
+      console.print(sys.wifiAttemptFast ? "' (fast, cached BSSID) assoc=" : "' (scan+DHCP) assoc=");
+      console.print(sys.wifiLastAssocMs);
+      console.print(F(" ms, ip="));
+      console.print(sys.wifiLastIpMs);
+      console.println(F(" ms"));
+      console.println();
+      logEvent(Msg::EVT_WIFI_CONNECTED);
+      if (sys.wifiAttemptFast) wifiRequestLease();
+    } else if (wifiLeaseRequestedMs != 0 && wifiGotIpAtMs != 0) {
+      const uint32_t leaseMs = wifiGotIpAtMs - wifiLeaseRequestedMs;
+      wifiLeaseRequestedMs = 0;
+      updateWifiCacheFromLink();
+      console.print(F("WiFi DHCP lease after fast connect: IP "));
+      console.print(WiFi.localIP());
+      console.print(F(" ("));
+      console.print(leaseMs);
+      console.println(F(" ms)"));
     }
     return;
   }
 
-  if (emulateWifiOff) {
-    if (!emulateWifiOffLogged) {
-      logEvent("WiFi emulation active -> forcing DISCONNECTED state");
-      emulateWifiOffLogged = true;
+  if (sys.emulateWifiOff) {
+    if (!sys.emulateWifiOffLogged) {
+      logEvent(Msg::EVT_WIFI_EMULATION_FORCED);
+      sys.emulateWifiOffLogged = true;
     }
 
     const uint32_t now = millis();
-    if ((now - emulateWifiLastConnectTryMs) >= EMULATE_WIFI_RETRY_CONNECT_MS) {
-      emulateWifiLastConnectTryMs = now;
-      WiFi.mode(WIFI_STA);
-      WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+    if ((now - sys.emulateWifiLastConnectTryMs) >= EMULATE_WIFI_RETRY_CONNECT_MS) {
+      sys.emulateWifiLastConnectTryMs = now;
+      beginWifiAttempt(false, sys.wifiCacheValid ? wifiCache.networkIndex : 0);
     }
     return;
   }
 
-  emulateWifiOffLogged = false;
+  sys.emulateWifiOffLogged = false;
 
-  WiFi.mode(WIFI_STA);
-  Serial.print("Connecting to WiFi: '");
-  Serial.print(WIFI_SSID);
-  Serial.println("'...");
+  const uint32_t now = millis();
+  // DHCP pornit după conectarea rapidă: asocierea rămâne, doar IP-ul lipsește
+  // până la lease; nu reasociem decât dacă lease-ul nu vine deloc.
+  if (wifiLeaseRequestedMs != 0 && (now - wifiLeaseRequestedMs) < WIFI_CONNECT_TIMEOUT_MS) return;
+  if (!sys.wifiConnectInProgress) {
+    const bool fast = sys.wifiNextAttemptFast && sys.wifiCacheValid;
+    beginWifiAttempt(fast, fast ? wifiCache.networkIndex : sys.wifiAttemptNetwork);
+    console.print(F("Connecting to WiFi: '"));
+    console.print(WIFI_NETWORKS[sys.wifiAttemptNetwork].ssid);
+    console.println(fast ? "' (cached BSSID/channel/IP)..." : "'...");
+    sys.wifiConnectInProgress = true;
+    return;
+  }
+
+  const uint32_t timeoutMs = sys.wifiAttemptFast ? WIFI_FAST_CONNECT_TIMEOUT_MS : WIFI_CONNECT_TIMEOUT_MS;
+  if ((now - sys.wifiConnectStartMs) < timeoutMs) return;
 
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  sys.wifiConnectInProgress = false;
+  console.print(F("WiFi connect failed: '"));
+  console.print(WIFI_NETWORKS[sys.wifiAttemptNetwork].ssid);
+  console.println(sys.wifiAttemptFast ? "' (fast) -> full scan" : "'");
+  console.println();
+  logEvent(Msg::EVT_WIFI_CONNECT_FAILED);
 
-  uint32_t start = millis();
-  while (!isWifiConnected() && millis() - start < 15'000) {
-    delay(250);
+  // fallback: cache -> rețelele în ordinea priorității -> din nou cache-ul
+  if (sys.wifiAttemptFast) {
+    sys.wifiNextAttemptFast = false;
+    sys.wifiAttemptNetwork = 0;
+  } else {
+    // în uint8_t: câmpul de 4 biți ar trece din 15 în 0 și n-ar atinge niciodată 16
+    const uint8_t next = static_cast<uint8_t>(sys.wifiAttemptNetwork + 1);
+    sys.wifiAttemptNetwork = next < WIFI_NETWORK_COUNT ? next : 0;
+    if (next >= WIFI_NETWORK_COUNT) sys.wifiNextAttemptFast = true;
   }
+}
 
-  if (isWifiConnected()) {
-    Serial.print("WiFi connected, IP: ");
-    Serial.println(WiFi.localIP());
-    Serial.println();
-    logEvent("WiFi connect success");
+// ----------------------------
+// Arena operațiilor de rețea (op_arena.h)
+// ----------------------------
+// Bufferele temporare ale unei operații (cererea HTTPS, liniile de header,
+// Date, URL-ul și conținutul .sha256 la OTA) vin dintr-un buffer static, nu
+// din heap; la sfârșitul operației NetArenaScope le eliberează pe toate odată.
+// Între alocările de durată lungă din heap nu mai rămân găuri de la ele.
+// STATUS arată maximul pe operație; soak pe host: tools/arena_soak.cpp.
+enum NetOp : uint8_t { NET_OP_HTTPS_TIME, NET_OP_OTA_SHA, NET_OP_HTTPS_PROBE, NET_OP_COUNT };
+static const char* const NET_OP_NAMES[NET_OP_COUNT] = { "HTTPS_TIME", "OTA_SHA", "HTTPS_PROBE" };
+static const size_t NET_ARENA_BYTES = 1024;
+static const size_t HTTPS_REQUEST_BYTES = 192;
+static const size_t HTTPS_LINE_BYTES = 96;
+static const size_t HTTPS_DATE_BYTES = 40;
+static const size_t OTA_SHA_URL_BYTES = 128;
+static const size_t OTA_SHA_BODY_BYTES = 72;
+
+static OpArena<NET_ARENA_BYTES, NET_OP_COUNT> netArena;
+using NetArenaScope = ArenaScope<decltype(netArena)>;
+
+// IPAddress::toString() aloca un String la fiecare STATUS; textul încape pe stivă.
+static void formatIp(const IPAddress& ip, char (&out)[16]) {
+  snprintf(out, sizeof(out), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+}
+
+static void printNetArenaStatus() {
+  console.print(F("Net arena: "));
+  console.print(netArena.used());
+  console.print(F("/"));
+  console.print(netArena.capacity());
+  console.print(F(" B, high-water "));
+  console.print(netArena.highWater());
+  console.print(F(" B, refused "));
+  console.print(netArena.failures());
+  for (uint8_t i = 0; i < NET_OP_COUNT; ++i) {
+    const ArenaOpStats& op = netArena.stats(i);
+    console.print(F("; "));
+    console.print(NET_OP_NAMES[i]);
+    console.print(F(" "));
+    console.print(op.runs);
+    console.print(F("x max "));
+    console.print(op.maxBytes);
+    console.print(F(" B"));
+  }
+  console.print(F("; heap max block "));
+  console.print(ESP.getMaxFreeBlockSize());
+  console.print(F(" B (frag "));
+  console.print(ESP.getHeapFragmentation());
+  console.println(F("%)"));
+}
+
+// ----------------------------
+// HTTPS (BearSSL): conexiune keep-alive + sesiune TLS reluată
+// ----------------------------
+// Un handshake complet costă peste 1 s de CPU și ~20 KB heap. Există un singur
+// client, persistent: cât timp serverul ține conexiunea deschisă, cererile
+// următoare merg pe ea fără handshake. După HTTPS_IDLE_CLOSE_MS fără cereri o
+// închidem noi (eliberează bufferele), dar ID-ul de sesiune rămâne în
+// httpsSession, deci reconectarea e un handshake scurt (fără schimb de chei).
+// BearSSL nu are session tickets pe client: reluarea e doar prin session ID.
+// Server local de test: tools/tls_probe_server.cpp.
+static const uint32_t HTTPS_TIMEOUT_MS = 3'000;
+static const uint32_t HTTPS_IDLE_CLOSE_MS = 60'000;
+
+struct HttpsStats {
+  uint32_t requests;
+  uint32_t failures;
+  uint32_t reusedConnections;  // cereri trimise pe o conexiune deja deschisă
+  uint32_t fullHandshakes;
+  uint32_t resumedHandshakes;
+  uint32_t fullHandshakeMsTotal;
+  uint32_t resumedHandshakeMsTotal;
+  uint32_t lastHandshakeMs;
+  uint32_t maxHandshakeMs;
+  uint32_t connectionHeapBytes;  // heap ocupat de ultima conexiune (buffere + context)
+  uint16_t fragmentBytes;        // MFLN negociat; 0 = buffere complete
+  uint16_t cipherSuite;
+  int lastSslError;
+};
+
+static BearSSL::WiFiClientSecure httpsClient;
+static BearSSL::Session httpsSession;
+static HttpsStats httpsStats = {};
+static bool httpsConfigured = false;
+static uint32_t httpsLastUseMs = 0;
+
+static void httpsConfigure() {
+  if (httpsConfigured) return;
+  httpsConfigured = true;
+  // Până la sincronizarea timpului lanțul CA nu se poate valida (datele de
+  // valabilitate): fie amprenta serverului, fie fără verificare.
+  if (HTTPS_FINGERPRINT[0] != '\0') {
+    httpsClient.setFingerprint(HTTPS_FINGERPRINT);
+  } else {
+    httpsClient.setInsecure();
+  }
+  if (HTTPS_FAST_CIPHERS) httpsClient.setCiphersLessSecure();
+  httpsClient.setSession(&httpsSession);
+  httpsClient.setTimeout(HTTPS_TIMEOUT_MS);
+  // MFLN: buffere mici doar dacă serverul acceptă fragmente de această mărime
+  if (HTTPS_MFLN_BYTES != 0 && BearSSL::WiFiClientSecure::probeMaxFragmentLength(HTTPS_HOST, HTTPS_PORT, HTTPS_MFLN_BYTES)) {
+    httpsClient.setBufferSizes(HTTPS_MFLN_BYTES, HTTPS_MFLN_BYTES);
+    httpsStats.fragmentBytes = HTTPS_MFLN_BYTES;
+  }
+}
+
+static bool httpsConnect() {
+  httpsConfigure();
+  httpsClient.stop();
+
+  // Sesiunea e reluată dacă serverul răspunde cu același session ID.
+  br_ssl_session_parameters* session = httpsSession.getSession();
+  uint8_t previousId[sizeof(session->session_id)];
+  const uint8_t previousLen = session->session_id_len;
+  memcpy(previousId, session->session_id, previousLen);
+
+  IPAddress literal;
+  if ((!literal.fromString(HTTPS_HOST) && faultRoll(Fault::DNS_FAIL)) || faultRoll(Fault::HTTPS_FAIL)) return false;
+
+  const uint32_t heapBefore = ESP.getFreeHeap();
+  const uint32_t startMs = millis();
+  if (!httpsClient.connect(HTTPS_HOST, HTTPS_PORT)) {
+    httpsStats.lastSslError = httpsClient.getLastSSLError();
+    return false;
+  }
+  const uint32_t handshakeMs = millis() - startMs;
+  const uint32_t heapAfter = ESP.getFreeHeap();
+
+  const bool resumed = previousLen != 0 && session->session_id_len == previousLen && memcmp(session->session_id, previousId, previousLen) == 0;
+  if (resumed) {
+    ++httpsStats.resumedHandshakes;
+    httpsStats.resumedHandshakeMsTotal += handshakeMs;
   } else {
-    Serial.println("WiFi connect failed");
-    Serial.println();
-    logEvent("WiFi connect failed");
+    ++httpsStats.fullHandshakes;
+    httpsStats.fullHandshakeMsTotal += handshakeMs;
+  }
+  httpsStats.lastHandshakeMs = handshakeMs;
+  httpsStats.maxHandshakeMs = std::max(httpsStats.maxHandshakeMs, handshakeMs);
+  httpsStats.connectionHeapBytes = heapBefore > heapAfter ? heapBefore - heapAfter : 0;
+  httpsStats.cipherSuite = session->cipher_suite;
+  httpsStats.lastSslError = 0;
+  return true;
+}
+
+// Citește o linie de header (fără CR/LF); false la timeout/conexiune închisă.
+static bool httpsReadLine(char* line, size_t lineSize) {
+  const size_t n = httpsClient.readBytesUntil('\n', line, lineSize - 1);
+  if (n == 0 && !httpsClient.connected()) return false;
+  line[n] = '\0';
+  if (n > 0 && line[n - 1] == '\r') line[n - 1] = '\0';
+  return n > 0;
+}
+
+// HEAD pe conexiunea persistentă. Întoarce codul HTTP (<= 0 la eroare) și,
+// dacă date != nullptr, header-ul Date. O conexiune refolosită pe care
+// serverul a închis-o între timp se reface o singură dată. Bufferele vin din
+// netArena: apelantul deschide un NetArenaScope.
+static int httpsHead(const char* path, char* date, size_t dateSize) {
+  if (date != nullptr && dateSize > 0) date[0] = '\0';
+  ++httpsStats.requests;
+
+  char* request = netArena.allocText(HTTPS_REQUEST_BYTES);
+  char* line = netArena.allocText(HTTPS_LINE_BYTES);
+  const int requestLen = request == nullptr ? -1 : snprintf(request, HTTPS_REQUEST_BYTES,
+                                  "HEAD %s HTTP/1.1\r\nHost: %s\r\nUser-Agent: alarma_simpla\r\nConnection: keep-alive\r\n\r\n", path, HTTPS_HOST);
+  if (line == nullptr || requestLen <= 0 || static_cast<size_t>(requestLen) >= HTTPS_REQUEST_BYTES) {
+    ++httpsStats.failures;
+    return -1;
+  }
+
+  for (uint8_t attempt = 0; attempt < 2; ++attempt) {
+    const bool reused = httpsClient.connected();
+    if (!reused && !httpsConnect()) break;
+    httpsLastUseMs = millis();
+
+    if (httpsClient.write(reinterpret_cast<const uint8_t*>(request), requestLen) != static_cast<size_t>(requestLen) || !httpsReadLine(line, HTTPS_LINE_BYTES)) {
+      httpsClient.stop();
+      if (reused) continue;  // serverul a închis conexiunea inactivă
+      break;
+    }
+    if (reused) ++httpsStats.reusedConnections;
+
+    // "HTTP/1.1 204 No Content"
+    const char* space = strchr(line, ' ');
+    const int code = space ? atoi(space + 1) : 0;
+    bool keepAlive = strncmp(line, "HTTP/1.1", 8) == 0;
+    while (httpsReadLine(line, HTTPS_LINE_BYTES)) {
+      if (date != nullptr && strncasecmp(line, "Date: ", 6) == 0) {
+        strncpy(date, line + 6, dateSize - 1);
+        date[dateSize - 1] = '\0';
+      } else if (strncasecmp(line, "Connection: close", 17) == 0) {
+        keepAlive = false;
+      }
+    }
+    // HEAD nu are corp: conexiunea e gata pentru următoarea cerere
+    if (!keepAlive) httpsClient.stop();
+    if (code <= 0) break;
+    return code;
   }
+  ++httpsStats.failures;
+  return -1;
+}
+
+// Proba de internet cu INTERNET_PROBE_HTTPS: un HEAD pe același client ca
+// sincronizarea timpului, deci la 60 s (peste HTTPS_IDLE_CLOSE_MS) fiecare
+// probă e un handshake reluat, nu unul complet. Orice 2xx/3xx = internet OK.
+static bool httpsProbe(uint32_t* rttMs) {
+  NetArenaScope scope(netArena, NET_OP_HTTPS_PROBE);
+  const uint32_t t0 = millis();
+  const int code = httpsHead(HTTPS_TIME_PATH, nullptr, 0);
+  *rttMs = millis() - t0;
+  return code >= 200 && code < 400 && !faultRoll(Fault::PING_LOSS);
+}
+
+static void httpsCloseIfIdle() {
+  if (httpsLastUseMs == 0 || (millis() - httpsLastUseMs) < HTTPS_IDLE_CLOSE_MS) return;
+  httpsLastUseMs = 0;
+  httpsClient.stop();  // sesiunea rămâne pentru reluare
+}
+
+static void putHttpsStatus(StatusDeltaEncoder& e) {
+  e.put(StatusField::HTTPS_REQUESTS, httpsStats.requests);
+  e.put(StatusField::HTTPS_FAILURES, httpsStats.failures);
+  e.put(StatusField::HTTPS_RESUMED, httpsStats.resumedHandshakes);
+}
+
+static void printHttpsStatus() {
+  console.print(F("HTTPS: "));
+  console.print(httpsStats.requests);
+  console.print(F(" req, "));
+  console.print(httpsStats.failures);
+  console.print(F(" failed, reused conn "));
+  console.print(httpsStats.reusedConnections);
+  console.print(F(", handshakes full "));
+  console.print(httpsStats.fullHandshakes);
+  console.print(F(" (avg "));
+  console.print(httpsStats.fullHandshakes ? httpsStats.fullHandshakeMsTotal / httpsStats.fullHandshakes : 0);
+  console.print(F(" ms) / resumed "));
+  console.print(httpsStats.resumedHandshakes);
+  console.print(F(" (avg "));
+  console.print(httpsStats.resumedHandshakes ? httpsStats.resumedHandshakeMsTotal / httpsStats.resumedHandshakes : 0);
+  console.println(F(" ms)"));
+  console.print(F("HTTPS last handshake (ms): "));
+  console.print(httpsStats.lastHandshakeMs);
+  console.print(F(", max "));
+  console.print(httpsStats.maxHandshakeMs);
+  console.print(F(", conn heap "));
+  console.print(httpsStats.connectionHeapBytes);
+  console.print(F(" B, MFLN "));
+  console.print(httpsStats.fragmentBytes);
+  console.print(F(", suite 0x"));
+  console.print(httpsStats.cipherSuite, HEX);
+  console.print(F(", ssl err "));
+  console.println(httpsStats.lastSslError);
 }
 
 static void applyRomaniaTimezone() {
@@ -380,7 +1299,7 @@ static void applyRomaniaTimezone() {
 static void ensureTimeSyncIfNeeded() {
   if (!isWifiConnected()) return;
 
-  if (!ntpStarted) {
+  if (!sys.ntpStarted) {
     // Force timezone Romania and start NTP using TZ-aware API.
     applyRomaniaTimezone();
 #if defined(ESP8266)
@@ -388,72 +1307,62 @@ static void ensureTimeSyncIfNeeded() {
 #else
     configTime(0, 0, "pool.ntp.org", "time.google.com");
 #endif
-    ntpStarted = true;
-    Serial.println("NTP sync started (Sibiu, RO)");
-    Serial.println();
+    sys.ntpStarted = true;
+    console.println(F("NTP sync started (Sibiu, RO)"));
+    console.println();
   }
 
-  if (!ntpReadyLogged) {
+  if (!sys.ntpReadyLogged) {
     struct tm tmInfo;
     if (getLocalTimeSafe(&tmInfo)) {
       char ts[24];
       formatDateTime(ts, sizeof(ts), true);
-      Serial.print("==== prima data citita : [");
-      Serial.print(ts);
-      Serial.println("] ====");
-      Serial.println();
-      ntpReadyLogged = true;
-      ntpWaitingLogged = false;
-      pingCounter = 0;
-      lastGooglePingMs = millis();
-      pingDownActive = false;
-      pingDownStartRealEpoch = 0;
-      internetCutActive = false;
-    } else if (!ntpWaitingLogged) {
-      Serial.println("Waiting for real internet time...");
-      Serial.println();
-      ntpWaitingLogged = true;
+      console.print(F("==== prima data citita : ["));
+      console.print(ts);
+      console.println(F("] ===="));
+      console.println();
+      sys.ntpReadyLogged = true;
+      sys.ntpWaitingLogged = false;
+      sys.pingCounter = 0;
+      sys.lastGooglePingMs = millis();
+      sys.relay.pingDownActive = false;
+      sys.pingDownStartEpoch = 0;
+      sys.relay.cutActive = false;
+    } else if (!sys.ntpWaitingLogged) {
+      console.println(F("Waiting for real internet time..."));
+      console.println();
+      sys.ntpWaitingLogged = true;
     }
 
-    if (!ntpReadyLogged) {
-      tryHttpTimeSyncIfNeeded();
+    if (!sys.ntpReadyLogged) {
+      tryHttpsTimeSyncIfNeeded();
     }
   }
 }
 
-static void tryHttpTimeSyncIfNeeded() {
+static void tryHttpsTimeSyncIfNeeded() {
   const uint32_t nowMs = millis();
-  if ((nowMs - lastHttpTimeTryMs) < 15000) return;
-  lastHttpTimeTryMs = nowMs;
-
-  HTTPClient http;
-  WiFiClient client;
-  const char* headerKeys[] = {"Date"};
-  http.collectHeaders(headerKeys, 1);
-
-  if (!http.begin(client, "http://google.com/generate_204")) return;
-
-  const int code = http.GET();
-  if (code > 0) {
-    String dateHeader = http.header("Date");
-    if (dateHeader.length() > 0) {
-      struct tm tmUtc = {};
-      char* parsed = strptime(dateHeader.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &tmUtc);
-      if (parsed != nullptr) {
-        setenv("TZ", "UTC0", 1);
-        tzset();
-        time_t utcEpoch = mktime(&tmUtc);
-        applyRomaniaTimezone();
-        if (utcEpoch >= 1700000000) {
-          timeval tv = {utcEpoch, 0};
-          settimeofday(&tv, nullptr);
-          Serial.println("Internet time sync via HTTP Date header");
-          Serial.println();
-        }
-      }
-    }
+  if ((nowMs - sys.lastHttpTimeTryMs) < 15000) return;
+  sys.lastHttpTimeTryMs = nowMs;
+  setLoopStage(LoopStage::HTTP_TIME_SYNC);
+
+  NetArenaScope scope(netArena, NET_OP_HTTPS_TIME);
+  char* dateHeader = netArena.allocText(HTTPS_DATE_BYTES);
+  if (dateHeader == nullptr || httpsHead(HTTPS_TIME_PATH, dateHeader, HTTPS_DATE_BYTES) <= 0 || dateHeader[0] == '\0') return;
+
+  struct tm tmUtc = {};
+  char* parsed = strptime(dateHeader, "%a, %d %b %Y %H:%M:%S GMT", &tmUtc);
+  if (parsed == nullptr) return;
+  setenv("TZ", "UTC0", 1);
+  tzset();
+  time_t utcEpoch = mktime(&tmUtc);
+  applyRomaniaTimezone();
+  if (utcEpoch >= 1700000000) {
+    timeval tv = {utcEpoch, 0};
+    settimeofday(&tv, nullptr);
+    console.println(F("Internet time sync via HTTPS Date header"));
+    console.println();
   }
-  http.end();
 }
 
 static bool getLocalTimeSafe(struct tm* outTm) {
@@ -503,17 +1412,17 @@ static void connectMqtt() {
     String clientId = "alarma_simpla_";
     clientId += String(ESP.getChipId(), HEX);
 
-    Serial.print("Connecting to MQTT: ");
-    Serial.print(MQTT_SERVER);
-    Serial.print(":" );
-    Serial.println(MQTT_PORT);
+    console.print(F("Connecting to MQTT: "));
+    console.print(MQTT_SERVER);
+    console.print(":" );
+    console.println(MQTT_PORT);
 
     if (mqttClient.connect(clientId.c_str())) {
-      Serial.println("MQTT connected");
+      console.println(F("MQTT connected"));
       mqttClient.subscribe(MQTT_TOPIC);
       publishState();  // trimite starea curentă la conectare
     } else {
-      Serial.println("MQTT connect failed");
+      console.println(F("MQTT connect failed"));
     }
   }
 }
@@ -524,66 +1433,67 @@ static void performPingAndReport() {
   if (!getLocalTimeSafe(&tmNow)) {
     return;
   }
-  ++pingCounter;
+  ++sys.pingCounter;
 
   char ts[24];
   formatDateTime(ts, sizeof(ts), true);
 
   bool ok = false;
+  uint32_t rttMs = 0;
   if (isWifiConnected()) {
-    ok = Ping.ping(GOOGLE_PING_IP, 1);
-    Serial.println();
+    setLoopStage(LoopStage::PING);
+    if (INTERNET_PROBE_HTTPS) {
+      ok = httpsProbe(&rttMs);
+    } else {
+      ok = pingHost(GOOGLE_PING_IP);
+      rttMs = Ping.averageTime();
+    }
+    console.println();
   }
 
+  const uint32_t nowMs = millis();
+  const uint8_t d = relayPingResult(sys.relay, nowMs, ok);
+  tracePingResult(ok, nowMs);
+  // fără WiFi nu s-a sondat nimic: nu e dovadă împotriva modemului/routerului
+  if (isWifiConnected()) powerWatchdog.probeResult(POWER_TARGET_PUBLIC, ok);
+  if (d != RELAY_DECISION_NONE) traceRelayDecision(d, nowMs);
+  faultNotePing(ok, d);
   if (ok) {
-    pingDownActive = false;
-    pingDownStartRealEpoch = 0;
-    internetCutActive = false;
-    internetCutUntilMs = 0;
-    internetRelayNextAllowedMs = 0;
-
-    Serial.println();
-    Serial.print(pingCounter);
-    Serial.print(") ");
-    Serial.print("[");
-    Serial.print(ts);
-    Serial.print("] PING Google OK (");
-    Serial.print(Ping.averageTime());
-    Serial.println(" ms)");
+    sys.pingDownStartEpoch = 0;
+
+    console.println();
+    console.print(sys.pingCounter);
+    console.print(F(") "));
+    console.print(F("["));
+    console.print(ts);
+    sys.lastPingRttMs = static_cast<uint16_t>(rttMs + faultAmount(Fault::PING_RTT));
+    console.print(INTERNET_PROBE_HTTPS ? F("] HTTPS probe OK (") : F("] PING Google OK ("));
+    console.print(sys.lastPingRttMs);
+    console.println(F(" ms)"));
   } else {
-    const uint32_t nowMs = millis();
-
-    if (!pingDownActive) {
-      pingDownActive = true;
-      pingDownStartRealEpoch = time(nullptr);
+    if (d & RELAY_DECISION_PING_DOWN) {
+      sys.pingDownStartEpoch = static_cast<uint32_t>(time(nullptr));
+      sys.lastPingDownEpoch = sys.pingDownStartEpoch;
       char disconnectedAt[24];
       formatDateTime(disconnectedAt, sizeof(disconnectedAt), false);
-      Serial.println("=============================================");
-      Serial.print("[INTERNET a fost deconectat la: ");
-      Serial.print(disconnectedAt);
-      Serial.println("]  *FW by TONE :)*");
-      Serial.println("=============================================");
-      Serial.println();
-      logEvent("internet_DOWN_detected");
-      printRuntimeStatus();
+      console.println(F("============================================="));
+      console.print(F("[INTERNET a fost deconectat la: "));
+      console.print(disconnectedAt);
+      console.println(F("]  *FW by TONE :)*"));
+      console.println(F("============================================="));
+      console.println();
     }
-    if (!internetCutActive && (int32_t)(nowMs - internetRelayNextAllowedMs) >= 0) {
-      ++relayInternetActivationCount;
-      internetCutActive = true;
-      internetCutUntilMs = nowMs + INTERNET_RELAY_PULSE_MS;
-      internetRelayNextAllowedMs = nowMs + INTERNET_RELAY_PULSE_MS + INTERNET_RELAY_COOLDOWN_MS;
-      logEvent("relay_1_ACTIVATED");
+    if (d & (RELAY_DECISION_PING_DOWN | RELAY_DECISION_ACTIVATED)) {
+      eventPost(BusTopic::RELAY_DECISION, d & (RELAY_DECISION_PING_DOWN | RELAY_DECISION_ACTIVATED), 0, sys.relay.activationCount);
     }
   }
 }
 
-static void logEvent(const char* message) {
+static void logEvent(const char* message, uint8_t severity) {
   char ts[24];
   formatDateTime(ts, sizeof(ts), true);
-  Serial.print("[ EVENT= ");
-  Serial.print(message);
-  Serial.print("] :    ");
-  Serial.println(ts);
+  msgPrintln(Msg::EVENT_LINE, message, ts);
+  syslogEnqueue(message, severity);
 }
 
 static void formatEpochDateTime(time_t epoch, char* out, size_t outSize, bool includeSeconds) {
@@ -601,323 +1511,554 @@ static void formatEpochDateTime(time_t epoch, char* out, size_t outSize, bool in
   }
 }
 
-static void updateInternetCutRelayPulse() {
-  if (!internetCutActive || internetCutUntilMs == 0) return;
-
-  const uint32_t now = millis();
-  if ((int32_t)(now - internetCutUntilMs) >= 0) {
-    internetCutActive = false;
-    internetCutUntilMs = 0;
-    logEvent("relay_1_DEACTIVATED");
+// Decizia o ia relay_scheduler.h (același cod ca în trace_replay); aici doar
+// efectele: reconectare rapidă, urma de intrări; log-ul și statusul vin din
+// abonații magistralei de evenimente.
+static void updateInternetRelay(uint32_t now, bool wifiConnected) {
+  const uint8_t d = relayLoopStep(sys.relay, now, wifiConnected);
+  if (d == RELAY_DECISION_NONE) return;
+  traceRelayDecision(d, now);
+  if (d & RELAY_DECISION_WIFI_DOWN) {
+    sys.lastWifiDisconnectEpoch = static_cast<uint32_t>(time(nullptr));
+    sys.wifiNextAttemptFast = true;
   }
+  // impuls pe router la WiFi căzut: watchdog-ul nu pornește alt ciclu peste el
+  if (d & RELAY_DECISION_ACTIVATED) powerWatchdog.noteExternalCycle(POWER_ROUTER, now);
+  eventPost(BusTopic::RELAY_DECISION, d, 0, sys.relay.activationCount);
 }
 
-static void enforceInternetRelayOffWhenWifiConnected() {
-  if (!isWifiConnected()) return;
-  if (pingDownActive) return;
-  if (!internetCutActive && internetCutUntilMs == 0) return;
+static void pingGoogleIfNeeded() {
+  const uint32_t now = millis();
+  if ((now - sys.lastGooglePingMs) < currentPingIntervalMs()) return;
+  sys.lastGooglePingMs = now;
+  performPingAndReport();
+}
 
-  internetCutActive = false;
-  internetCutUntilMs = 0;
-  internetRelayNextAllowedMs = 0;
-  logEvent("relay_1_FORCED_INACTIVE_wifi_connected");
+static void runPingNow() {
+  performPingAndReport();
 }
 
-static void handleWifiReconnectRelayRetry() {
-  const uint32_t now = millis();
-  if ((int32_t)(now - relaySchedulerUnlockMs) < 0) {
-    // Startup holdoff: keep relay OFF and reset scheduler state.
-    internetCutActive = false;
-    internetCutUntilMs = 0;
-    internetRelayNextAllowedMs = 0;
-    wifiDisconnectedSinceMs = 0;
-    return;
-  }
+// ----------------------------
+// Power-cycle multi-echipament
+// ----------------------------
+// Diagnosticul și ordinea sunt în power_watchdog.h (simulate în
+// tools/power_watchdog_sim.cpp); aici doar probele (gateway, gazda LAN;
+// IP-ul public vine din ping-ul Google) și canalele de releu.
+static uint8_t powerTargetCount() {
+  return POWER_LAN_HOST_IP.isSet() ? POWER_TARGET_COUNT : POWER_TARGET_LAN_HOST;
+}
 
-  if (isWifiConnected()) {
-    wifiDisconnectedSinceMs = 0;
-    internetRelayNextAllowedMs = 0;
-    return;
+static void powerWatchdogBegin() {
+  powerWatchdog.begin(POWER_DEVICES, POWER_DEVICE_COUNT, POWER_TARGETS, powerTargetCount(), millis());
+  for (uint8_t d = 0; d < POWER_DEVICE_COUNT; ++d) {
+    if (d == POWER_ROUTER || POWER_RELAYS[d].pin < 0) continue;
+    pinMode(POWER_RELAYS[d].pin, OUTPUT);
+    digitalWrite(POWER_RELAYS[d].pin, POWER_RELAYS[d].offLevel);
   }
+  // ping-ul Google doar raportează; decizia de power-cycle e a watchdog-ului
+  sys.relay.pingDelegated = true;
+}
 
-    if (wifiDisconnectedSinceMs == 0) {
-      wifiDisconnectedSinceMs = now;
-      if (!internetCutActive) {
-        ++relayInternetActivationCount;
-        internetCutActive = true;
-        internetCutUntilMs = now + INTERNET_RELAY_PULSE_MS;
-        internetRelayNextAllowedMs = now + INTERNET_RELAY_PULSE_MS + INTERNET_RELAY_COOLDOWN_MS;
-        logEvent("relay_1_ACTIVATED");
-      }
+static void powerSetRelay(uint8_t d, bool cut, uint32_t now) {
+  if (d == POWER_ROUTER) {
+    // impulsul se oprește singur în relayPulseUpdate(); setOutputs() scrie pinul
+    if (cut) eventPost(BusTopic::RELAY_DECISION, relayActivate(sys.relay, now), 0, sys.relay.activationCount);
     return;
   }
+  const PowerRelayChannel& ch = POWER_RELAYS[d];
+  if (ch.pin >= 0) digitalWrite(ch.pin, cut ? ch.onLevel : ch.offLevel);
+}
 
-  if (internetCutActive) return;
-  if (internetRelayNextAllowedMs == 0) {
-    internetRelayNextAllowedMs = now + INTERNET_RELAY_COOLDOWN_MS;
-    return;
+// După ping, în faza LATE a urmei: un impuls pe router pornit de aici apare în
+// urmă ca schimbare externă de stare (ca EMULATE_WIFI_OFF), deci replay-ul
+// rămâne exact.
+static void powerWatchdogStep(uint32_t now) {
+  if (isWifiConnected()) {
+    const uint8_t t = powerWatchdog.dueProbe(now);
+    if (t != POWER_WD_NONE) {
+      setLoopStage(LoopStage::PING);
+      const IPAddress ip = t == POWER_TARGET_GATEWAY ? WiFi.gatewayIP() : POWER_LAN_HOST_IP;
+      powerWatchdog.probeResult(t, pingHost(ip));
+    }
   }
-  if ((int32_t)(now - internetRelayNextAllowedMs) < 0) return;
-
-  ++relayInternetActivationCount;
-  internetCutActive = true;
-  internetCutUntilMs = now + INTERNET_RELAY_PULSE_MS;
-  internetRelayNextAllowedMs = now + INTERNET_RELAY_PULSE_MS + INTERNET_RELAY_COOLDOWN_MS;
-  logEvent("relay_1_ACTIVATED");
+  const PowerAction a = powerWatchdog.tick(now);
+  if (a.kind == PowerAction::NONE) return;
+  if (a.kind == PowerAction::CUT || a.kind == PowerAction::RESTORE) powerSetRelay(a.device, a.kind == PowerAction::CUT, now);
+  eventPost(BusTopic::POWER_CYCLE, a.device, a.kind, powerWatchdog.cycles(a.device));
 }
 
-static void pingGoogleIfNeeded() {
+static void printPowerWatchdogStatus() {
   const uint32_t now = millis();
-  if ((now - lastGooglePingMs) < currentPingIntervalMs()) return;
-  lastGooglePingMs = now;
-  performPingAndReport();
-}
-
-static void runPingNow() {
-  performPingAndReport();
-}
-
-static void updateWifiDisconnectTracking() {
-  const bool connected = isWifiConnected();
-  if (prevWifiConnected && !connected) {
-    lastWifiDisconnectRealEpoch = time(nullptr);
-    if (wifiDisconnectedSinceMs == 0) {
-      wifiDisconnectedSinceMs = millis();
-    }
-    logEvent("WiFi transition: CONNECTED -> DISCONNECTED");
-    printRuntimeStatus();
-  } else if (!prevWifiConnected && connected) {
-    logEvent("WiFi transition: DISCONNECTED -> CONNECTED");
+  console.print(F("Power WD:"));
+  for (uint8_t d = 0; d < POWER_DEVICE_COUNT; ++d) {
+    console.print(d == 0 ? F(" ") : F(" | "));
+    console.print(POWER_DEVICES[d].name);
+    if (!POWER_DEVICES[d].switchable) console.print(F(" (no relay)"));
+    console.print(F(" cycles "));
+    console.print(powerWatchdog.cycles(d));
+  }
+  console.print(F("; targets"));
+  static const char* const HEALTH[] = { "?", "UP", "DOWN" };
+  for (uint8_t t = 0; t < powerWatchdog.targetCount(); ++t) {
+    console.print(F(" "));
+    console.print(POWER_TARGETS[t].name);
+    console.print(F("="));
+    console.print(HEALTH[static_cast<uint8_t>(powerWatchdog.health(t))]);
   }
-  prevWifiConnected = connected;
+  if (powerWatchdog.phase() != PowerPhase::IDLE) {
+    console.print(powerWatchdog.phase() == PowerPhase::PULSE ? F("; OFF ") : F("; booting "));
+    console.print(POWER_DEVICES[powerWatchdog.activeDevice()].name);
+    console.print(F(" "));
+    console.print(powerWatchdog.phaseRemainingMs(now) / 1000);
+    console.print(F(" s"));
+  }
+  console.println();
 }
 
 static void printWifiOffLiveTelemetryEverySec() {
   if (isWifiConnected()) {
-    wifiOffLivePrintLastMs = 0;
+    sys.wifiOffLivePrintLastMs = 0;
     return;
   }
 
   const uint32_t now = millis();
-  if (wifiOffLivePrintLastMs != 0 && (now - wifiOffLivePrintLastMs) < 1000) return;
-  wifiOffLivePrintLastMs = now;
+  if (sys.wifiOffLivePrintLastMs != 0 && (now - sys.wifiOffLivePrintLastMs) < 1000) return;
+  sys.wifiOffLivePrintLastMs = now;
 
   char ts[24];
   formatDateTime(ts, sizeof(ts), true);
-  Serial.print(">>{EVENT: ");
-  Serial.print(internetCutActive ? "relay_1_ACTIVATED" : "relay_1_DEACTIVATED");
-  Serial.print(" Wifi is OFF | Date: ");
-  Serial.print(ts);
-  Serial.print(" |  ");
-  Serial.print(relayInternetActivationCount);
-  Serial.println(" incercari de OFF>ON; } <<");
+  console.print(F(">>{EVENT: "));
+  console.print(sys.relay.cutActive ? "relay_1_ACTIVATED" : "relay_1_DEACTIVATED");
+  console.print(F(" Wifi is OFF | Date: "));
+  console.print(ts);
+  console.print(F(" |  "));
+  console.print(sys.relay.activationCount);
+  console.println(F(" incercari de OFF>ON; } <<"));
 }
 
 static void printRuntimeStatus() {
-  ++statusPrintCounter;
+  ++sys.statusPrintCounter;
+  // o singură copie: raportul descrie aceeași stare de la primul la ultimul rând
+  const SystemState snap = sys;
   char up[32];
   formatDurationMs(millis(), up, sizeof(up));
   char lastWifiDown[24];
-  formatEpochDateTime(lastWifiDisconnectRealEpoch, lastWifiDown, sizeof(lastWifiDown), true);
+  formatEpochDateTime(snap.lastWifiDisconnectEpoch, lastWifiDown, sizeof(lastWifiDown), true);
   const uint32_t pingIntervalMs = currentPingIntervalMs();
 
-  Serial.println();
-  Serial.println();
-  Serial.print("=====  ");
-  Serial.print(statusPrintCounter);
-  Serial.println("  ===== >>");
-
-  Serial.println("🚨[ Stare alarmă]");
-  Serial.print("Alarmă: ");
-  Serial.println(stateToString(state));
-  Serial.print("Internet relay: ");
-  Serial.println(internetCutActive ? "ACTIVE" : "INACTIVE");
-  Serial.print("Ping down activ: ");
-  Serial.println(pingDownActive ? "YES" : "NO");
-  Serial.print("Ping down start: ");
+  console.println();
+  console.println();
+  msgPrintln(Msg::STATUS_BEGIN, snap.statusPrintCounter);
+
+  msgPrintln(Msg::STATUS_ALARM_SECTION);
+  msgPrintln(Msg::STATUS_ALARM, stateToString(snap.alarmState));
+  for (uint8_t i = 0; i < ALARM_PARTITION_COUNT; ++i) {
+    msgPrint(Msg::STATUS_PARTITION, i + 1, stateToString(snap.partitions[i].state));
+    if (snap.partitions[i].timerActive) {
+      msgPrint(Msg::STATUS_PARTITION_TIMER, (int32_t)(snap.partitions[i].timerDeadlineMs - millis()) / 1000);
+    }
+    console.println();
+  }
+  msgPrintln(Msg::STATUS_TRIGGER_COUNT, snap.alarmTriggerCount);
+  printZoneHealthStatus();
+  printButtonStatus();
+  msgPrintln(Msg::STATUS_INTERNET_RELAY, snap.relay.cutActive ? "ACTIVE" : "INACTIVE");
+  msgPrintln(Msg::STATUS_PING_DOWN, snap.relay.pingDownActive ? "YES" : "NO");
   char pingDownAt[24];
-  formatEpochDateTime(pingDownStartRealEpoch, pingDownAt, sizeof(pingDownAt), true);
-  Serial.println(pingDownAt);
-  Serial.println();
-
-  Serial.println("[🌐 Rețea WiFi]");
-  Serial.print("Status WiFi: ");
-  Serial.println(isWifiConnected() ? "CONNECTED" : "DISCONNECTED");
-  Serial.print("WiFi emulation: ");
-  Serial.println(emulateWifiOff ? "ON" : "OFF");
+  formatEpochDateTime(snap.pingDownStartEpoch, pingDownAt, sizeof(pingDownAt), true);
+  msgPrintln(Msg::STATUS_PING_DOWN_START, pingDownAt);
+  console.println();
+
+  msgPrintln(Msg::STATUS_WIFI_SECTION);
+  msgPrintln(Msg::STATUS_WIFI, isWifiConnected() ? "CONNECTED" : "DISCONNECTED");
+  msgPrintln(Msg::STATUS_WIFI_EMULATION, snap.emulateWifiOff ? "ON" : "OFF");
   if (isWifiConnected()) {
-    Serial.print("IP local: ");
-    Serial.println(WiFi.localIP());
-    Serial.print("Gateway: ");
-    Serial.println(WiFi.gatewayIP());
-    Serial.print("DNS: ");
-    Serial.println(WiFi.dnsIP());
-    Serial.print("rssi=");
-    Serial.println(WiFi.RSSI());
+    char ip[16];
+    formatIp(WiFi.localIP(), ip);
+    msgPrintln(Msg::STATUS_IP, ip);
+    formatIp(WiFi.gatewayIP(), ip);
+    msgPrintln(Msg::STATUS_GATEWAY, ip);
+    formatIp(WiFi.dnsIP(), ip);
+    msgPrintln(Msg::STATUS_DNS, ip);
+    msgPrintln(Msg::STATUS_RSSI, WiFi.RSSI());
+    msgPrintln(Msg::STATUS_SSID, WIFI_NETWORKS[snap.wifiAttemptNetwork].ssid, WiFi.channel());
+    msgPrintln(Msg::STATUS_LAST_CONNECT, snap.wifiLastConnectFast ? "fast" : "scan", snap.wifiLastAssocMs, snap.wifiLastIpMs);
   } else {
-    Serial.println("IP local: -");
-    Serial.println("Gateway: -");
-    Serial.println("DNS: -");
-    Serial.println("rssi=-");
+    msgPrintln(Msg::STATUS_IP, "-");
+    msgPrintln(Msg::STATUS_GATEWAY, "-");
+    msgPrintln(Msg::STATUS_DNS, "-");
+    msgPrintln(Msg::STATUS_RSSI, "-");
   }
-  Serial.println();
+  console.println();
 
-  Serial.println("[🌍 Conectivitate Internet]");
-  Serial.print("Ultima deconectare: ");
-  Serial.println(lastWifiDown);
+  msgPrintln(Msg::STATUS_INTERNET_SECTION);
+  msgPrintln(Msg::STATUS_LAST_DISCONNECT, lastWifiDown);
   char wifiDisconnectedFor[16];
-  if (wifiDisconnectedSinceMs == 0 || isWifiConnected()) {
+  if (snap.relay.wifiDisconnectedSinceMs == 0 || isWifiConnected()) {
     snprintf(wifiDisconnectedFor, sizeof(wifiDisconnectedFor), "0:00:00");
   } else {
-    const uint32_t disconnectedForMs = millis() - wifiDisconnectedSinceMs;
+    const uint32_t disconnectedForMs = millis() - snap.relay.wifiDisconnectedSinceMs;
     formatDurationMs(disconnectedForMs, wifiDisconnectedFor, sizeof(wifiDisconnectedFor));
   }
-  Serial.print("WiFi disconnected since: ");
-  Serial.println(wifiDisconnectedFor);
-  Serial.print("Ping counter: ");
-  Serial.println(pingCounter);
-  Serial.print("Ping interval: ");
-  Serial.print(pingIntervalMs);
-  Serial.print(" ms (");
-  Serial.print(pingIntervalMs / 1000);
-  Serial.println(" sec)");
-  Serial.println();
-
-  Serial.println("System ::");
-  Serial.print("NTP started: ");
-  Serial.println(ntpStarted ? "YES" : "NO");
-  Serial.print("NTP ready: ");
-  Serial.println(ntpReadyLogged ? "YES" : "NO");
-  Serial.print("Free heap: ");
-  Serial.println(ESP.getFreeHeap());
-  Serial.print("Chip ID: ");
-  Serial.println(ESP.getChipId(), HEX);
-  Serial.print("Uptime: ");
-  Serial.println(up);
-  Serial.print("=====  ");
-  Serial.print(statusPrintCounter);
-  Serial.println("  =====  <<");
-  Serial.println();
+  msgPrintln(Msg::STATUS_WIFI_DOWN_FOR, wifiDisconnectedFor);
+  msgPrintln(Msg::STATUS_PING_COUNTER, snap.pingCounter);
+  msgPrintln(Msg::STATUS_PING_INTERVAL, pingIntervalMs, pingIntervalMs / 1000);
+  console.println();
+
+  msgPrintln(Msg::STATUS_SYSTEM_SECTION);
+  msgPrintln(Msg::STATUS_NTP_STARTED, snap.ntpStarted ? "YES" : "NO");
+  msgPrintln(Msg::STATUS_NTP_READY, snap.ntpReadyLogged ? "YES" : "NO");
+  msgPrintln(Msg::STATUS_FREE_HEAP, ESP.getFreeHeap());
+  printOtaStatus();
+  printConsoleStatus();
+  printTraceStatus();
+  printHttpsStatus();
+  printEventBusStatus();
+  printPowerWatchdogStatus();
+  printSyslogStatus();
+  printFaultStatus();
+  printPeerStatus();
+  printNetArenaStatus();
+  printTsdbStatus();
+  msgPrintln(Msg::STATUS_CHIP_ID, ESP.getChipId());
+  msgPrintln(Msg::STATUS_UPTIME, up);
+  msgPrintln(Msg::STATUS_END, snap.statusPrintCounter);
+  console.println();
 }
 
-static void printStatusEvery30SecIfNeeded() {
-  const uint32_t now = millis();
-  if ((now - lastAutoStatusMs) < STATUS_AUTO_INTERVAL_MS) return;
-  lastAutoStatusMs = now;
-  printRuntimeStatus();
+static void statusDeltaSink(void*, const char* text) {
+  console.print(text);
 }
 
-static void printBootInfo() {
-  Serial.println("[BOOT] ===========================================");
-  Serial.print("[BOOT] FW build: ");
-  Serial.print(__DATE__);
-  Serial.print(" ");
-  Serial.println(__TIME__);
-  Serial.print("[BOOT] Chip ID: 0x");
-  Serial.println(ESP.getChipId(), HEX);
-  Serial.print("[BOOT] CPU freq (MHz): ");
-  Serial.println(ESP.getCpuFreqMHz());
-  Serial.print("[BOOT] Free heap: ");
-  Serial.println(ESP.getFreeHeap());
-  Serial.print("[BOOT] Reset reason: ");
-  Serial.println(ESP.getResetReason());
-  Serial.print("[BOOT] WiFi SSID: ");
-  Serial.println(WIFI_SSID);
-  Serial.print("[BOOT] Internet relay pin: GPIO");
-  Serial.println(PIN_RELAY1_INTERNET);
-  Serial.print("[BOOT] Relay pulse (ms): ");
-  Serial.println(INTERNET_RELAY_PULSE_MS);
-  Serial.print("[BOOT] WiFi retry trigger (ms): ");
-  Serial.println(WIFI_DISCONNECT_RELAY_RETRY_MS);
-  Serial.print("[BOOT] Ping interval normal (ms): ");
-  Serial.println(GOOGLE_PING_INTERVAL_MS);
-  Serial.print("[BOOT] Status auto interval (ms): ");
-  Serial.println(STATUS_AUTO_INTERVAL_MS);
-  Serial.println("[BOOT] ===========================================");
-  Serial.println();
-}
-
-static void processSerialCommand(String cmd) {
-  cmd.trim();
-  cmd.toUpperCase();
-  if (cmd.length() == 0) return;
-
-  if (cmd == "ARM") {
-    if (state == AlarmState::DISARMED) {
-      enterState(AlarmState::ARMING);
-      Serial.println("UART CMD: ARM -> OK");
+// Aceleași valori ca printRuntimeStatus(), ca perechi cheie=valoare; encoder-ul
+// scrie doar ce diferă de raportul anterior (tot blocul la keyframe).
+static void printStatusDelta() {
+  const SystemState snap = sys;
+  const uint32_t now = millis();
+  statusDelta.begin(now / 1000, statusDeltaSink, nullptr);
+
+  statusDelta.put(StatusField::ALARM, stateToString(snap.alarmState));
+  for (uint8_t i = 0; i < ALARM_PARTITION_COUNT; ++i) {
+    const uint8_t f = static_cast<uint8_t>(StatusField::P1) + 2 * i;
+    statusDelta.put(static_cast<StatusField>(f), stateToString(snap.partitions[i].state));
+    if (snap.partitions[i].timerActive) {
+      statusDelta.put(static_cast<StatusField>(f + 1), (long)((int32_t)(snap.partitions[i].timerDeadlineMs - now) / 1000));
     } else {
-      Serial.println("UART CMD: ARM -> already armed/arming/alarming");
+      statusDelta.put(static_cast<StatusField>(f + 1), "-");
     }
-    Serial.println();
-    return;
   }
-
-  if (cmd == "DISARM") {
-    enterState(AlarmState::DISARMED);
-    Serial.println("UART CMD: DISARM -> OK");
-    Serial.println();
-    return;
+  statusDelta.put(StatusField::TRIGGERS, snap.alarmTriggerCount);
+  statusDelta.put(StatusField::RELAY, snap.relay.cutActive ? "ACTIVE" : "INACTIVE");
+  statusDelta.put(StatusField::PING_DOWN, snap.relay.pingDownActive);
+  char text[32];
+  formatEpochDateTime(snap.pingDownStartEpoch, text, sizeof(text), true);
+  statusDelta.put(StatusField::PING_DOWN_START, text);
+
+  const bool wifiUp = isWifiConnected();
+  statusDelta.put(StatusField::WIFI, wifiUp ? "CONNECTED" : "DISCONNECTED");
+  statusDelta.put(StatusField::WIFI_EMULATION, snap.emulateWifiOff ? "ON" : "OFF");
+  if (wifiUp) {
+    char ip[16];
+    formatIp(WiFi.localIP(), ip);
+    statusDelta.put(StatusField::IP, ip);
+    formatIp(WiFi.gatewayIP(), ip);
+    statusDelta.put(StatusField::GATEWAY, ip);
+    formatIp(WiFi.dnsIP(), ip);
+    statusDelta.put(StatusField::DNS, ip);
+    statusDelta.put(StatusField::RSSI, (long)WiFi.RSSI());
+    statusDelta.put(StatusField::SSID, WIFI_NETWORKS[snap.wifiAttemptNetwork].ssid);
+    statusDelta.put(StatusField::CHANNEL, (long)WiFi.channel());
+    snprintf(text, sizeof(text), "%s/%u/%u", snap.wifiLastConnectFast ? "fast" : "scan", snap.wifiLastAssocMs, snap.wifiLastIpMs);
+    statusDelta.put(StatusField::LAST_CONNECT, text);
+  } else {
+    statusDelta.put(StatusField::IP, "-");
+    statusDelta.put(StatusField::GATEWAY, "-");
+    statusDelta.put(StatusField::DNS, "-");
+    statusDelta.put(StatusField::RSSI, "-");
+    statusDelta.put(StatusField::SSID, "-");
+    statusDelta.put(StatusField::CHANNEL, "-");
+    statusDelta.put(StatusField::LAST_CONNECT, "-");
   }
 
-  if (cmd == "STATUS") {
-    Serial.println("UART CMD: STATUS -> OK");
-    printRuntimeStatus();
-    return;
+  formatEpochDateTime(snap.lastWifiDisconnectEpoch, text, sizeof(text), true);
+  statusDelta.put(StatusField::LAST_DISCONNECT, text);
+  if (snap.relay.wifiDisconnectedSinceMs == 0 || wifiUp) {
+    statusDelta.put(StatusField::WIFI_DOWN_FOR, "0:00:00");
+  } else {
+    formatDurationMs(now - snap.relay.wifiDisconnectedSinceMs, text, sizeof(text));
+    statusDelta.put(StatusField::WIFI_DOWN_FOR, text);
+  }
+  statusDelta.put(StatusField::PING_COUNTER, snap.pingCounter);
+  statusDelta.put(StatusField::PING_INTERVAL, currentPingIntervalMs());
+
+  statusDelta.put(StatusField::NTP_STARTED, snap.ntpStarted);
+  statusDelta.put(StatusField::NTP_READY, snap.ntpReadyLogged);
+  statusDelta.put(StatusField::FREE_HEAP, ESP.getFreeHeap());
+  putOtaStatus(statusDelta);
+  putConsoleStatus(statusDelta);
+  putTraceStatus(statusDelta);
+  putHttpsStatus(statusDelta);
+  snprintf(text, sizeof(text), "0x%08X", ESP.getChipId());
+  statusDelta.put(StatusField::CHIP_ID, text);
+  statusDelta.end();
+  console.println();
+}
+
+static void printStatusEvery30SecIfNeeded() {
+  const uint32_t now = millis();
+  if ((now - sys.lastAutoStatusMs) < STATUS_AUTO_INTERVAL_MS) return;
+  sys.lastAutoStatusMs = now;
+  if (statusAutoDelta) {
+    printStatusDelta();
+  } else {
+    printRuntimeStatus();
+  }
+}
+
+static void printBootInfo() {
+  msgPrintln(Msg::BOOT_RULE);
+  msgPrintln(Msg::BOOT_BUILD, __DATE__, __TIME__);
+  msgPrintln(Msg::BOOT_CHIP_ID, ESP.getChipId());
+  msgPrintln(Msg::BOOT_CPU_FREQ, ESP.getCpuFreqMHz());
+  msgPrintln(Msg::BOOT_FREE_HEAP, ESP.getFreeHeap());
+  msgPrintln(Msg::BOOT_RESET_REASON, ESP.getResetReason().c_str());
+  msgPrintln(Msg::BOOT_RESTORE_US, sys.bootToArmedUs);
+  msgPrint(Msg::BOOT_WIFI_NETWORKS);
+  for (uint8_t i = 0; i < WIFI_NETWORK_COUNT; ++i) {
+    if (i > 0) console.print(F(", "));
+    console.print(WIFI_NETWORKS[i].ssid);
+  }
+  console.println();
+  msgPrintln(Msg::BOOT_WIFI_CACHE, sys.wifiCacheValid ? WIFI_NETWORKS[wifiCache.networkIndex].ssid : "-");
+  msgPrintln(Msg::BOOT_RELAY_PIN, PIN_RELAY1_INTERNET);
+  msgPrintln(Msg::BOOT_RELAY_PULSE, INTERNET_RELAY_PULSE_MS);
+  msgPrintln(Msg::BOOT_WIFI_RETRY, WIFI_DISCONNECT_RELAY_RETRY_MS);
+  msgPrintln(Msg::BOOT_PING_INTERVAL, GOOGLE_PING_INTERVAL_MS);
+  msgPrintln(Msg::BOOT_STATUS_INTERVAL, STATUS_AUTO_INTERVAL_MS);
+  msgPrintln(Msg::BOOT_RULE);
+  console.println();
+}
+
+// Comenzile care schimbă armarea, firmware-ul sau ieșirile plăcii.
+static bool commandUartOnly(const String& cmd) {
+  return cmd == "ARM" || cmd.startsWith("ARM ") || cmd == "STAY" || cmd.startsWith("STAY ") || cmd == "DISARM" || cmd.startsWith("DISARM ") || cmd == "OTA" || cmd.startsWith("OTA ") ||
+         cmd == "FAULT" || cmd.startsWith("FAULT ") || cmd.startsWith("EMULATE_");
+}
+
+// Comenzile care doar citesc; log-ul în sine vine oricum pe conexiune.
+static bool commandReadOnly(const String& cmd) {
+  return cmd == "STATUS" || cmd == "HELP" || cmd == "TRACE DUMP" || cmd == "TRACE SAVED" || cmd == "TSDB" || (cmd.startsWith("TSDB ") && cmd != "TSDB FLUSH");
+}
+
+static void processSerialCommand(String cmd, CmdSource source) {
+  cmd.trim();
+  const String raw = cmd;  // argumentele (ex. URL) își păstrează majusculele
+  cmd.toUpperCase();
+  if (cmd.length() == 0) return;
+  if (cmd.startsWith("LOGIN")) {  // doar pe consola TCP; tokenul nu se afișează
+    msgPrintln(Msg::CMD_IGNORED, "LOGIN");
+    console.println();
+    return;
+  }
+  // refuzate înainte de urmă: replay-ul vede doar comenzile executate
+  if (source != CmdSource::UART && commandUartOnly(cmd)) {
+    msgPrintln(Msg::CMD_UART_ONLY, cmd.c_str());
+    console.println();
+    return;
+  }
+  if (source == CmdSource::CONSOLE && !commandReadOnly(cmd)) {
+    msgPrintln(Msg::CMD_LOGIN_REQUIRED, cmd.c_str());
+    console.println();
+    return;
+  }
+  traceCommand(cmd);
+
+  // ARM / STAY / DISARM [partiție 1..N]; fără partiție => toate
+  if (cmd == "ARM" || cmd.startsWith("ARM ") || cmd == "STAY" || cmd.startsWith("STAY ") || cmd == "DISARM" || cmd.startsWith("DISARM ")) {
+    const int space = cmd.indexOf(' ');
+    const String name = (space < 0) ? cmd : cmd.substring(0, space);
+    const AlarmEvent event = (name == "ARM") ? AlarmEvent::ARM_AWAY : (name == "STAY") ? AlarmEvent::ARM_STAY : AlarmEvent::DISARM;
+    uint8_t handled = 0;
+    if (space < 0) {
+      handled = alarmDispatchAll(event);
+    } else {
+      const long p = cmd.substring(space + 1).toInt();
+      if (p < 1 || p > ALARM_PARTITION_COUNT) {
+        msgPrintln(Msg::CMD_INVALID_PARTITION, name.c_str());
+        console.println();
+        return;
+      }
+      handled = alarmDispatch(static_cast<uint8_t>(p - 1), event, millis()) ? 1 : 0;
+    }
+    msgPrintln(handled ? Msg::CMD_DONE : Msg::CMD_IGNORED, name.c_str());
+    console.println();
+    return;
+  }
+
+  if (cmd == "STATUS") {
+    msgPrintln(Msg::CMD_DONE, "STATUS");
+    printRuntimeStatus();
+    return;
+  }
+
+  if (cmd == "STATUS FULL" || cmd == "STATUS DELTA") {
+    statusAutoDelta = cmd == "STATUS DELTA";
+    statusDelta.requestKeyframe();
+    msgPrintln(Msg::CMD_STATUS_MODE, statusAutoDelta ? "DELTA" : "FULL");
+    console.println();
+    return;
   }
 
   if (cmd == "PINGNOW") {
-    Serial.println("UART CMD: PINGNOW");
+    msgPrintln(Msg::CMD_PINGNOW);
     runPingNow();
-    Serial.println();
+    console.println();
     return;
   }
 
   if (cmd == "EMULATE_WIFI_OFF") {
-    emulateWifiOff = true;
-    emulateWifiOffLogged = false;
-    emulateWifiLastConnectTryMs = 0;
-    if (wifiDisconnectedSinceMs == 0) {
-      wifiDisconnectedSinceMs = millis();
+    sys.emulateWifiOff = true;
+    sys.emulateWifiOffLogged = false;
+    sys.emulateWifiLastConnectTryMs = 0;
+    if (sys.relay.wifiDisconnectedSinceMs == 0) {
+      sys.relay.wifiDisconnectedSinceMs = millis();
     }
     WiFi.disconnect();
-    if (!internetCutActive) {
-      ++relayInternetActivationCount;
+    if (!sys.relay.cutActive) {
+      ++sys.relay.activationCount;
     }
-    internetCutActive = true;
-    internetCutUntilMs = millis() + INTERNET_RELAY_PULSE_MS;
-    Serial.println("UART CMD: EMULATE_WIFI_OFF -> WiFi forced DISCONNECTED");
-    Serial.println("UART CMD: relay INTERNET ON immediately");
-    Serial.println();
-    logEvent("UART command: EMULATE_WIFI_OFF (relay ON immediate)");
+    sys.relay.cutActive = true;
+    sys.relay.cutUntilMs = millis() + INTERNET_RELAY_PULSE_MS;
+    msgPrintln(Msg::CMD_WIFI_OFF);
+    msgPrintln(Msg::CMD_WIFI_OFF_RELAY);
+    console.println();
+    logEvent(Msg::EVT_CMD_WIFI_OFF);
     return;
   }
 
   if (cmd == "EMULATE_WIFI_ON") {
-    emulateWifiOff = false;
-    emulateWifiOffLogged = false;
-    wifiDisconnectedSinceMs = 0;
-    internetCutActive = false;
-    internetCutUntilMs = 0;
-    wifiOffLivePrintLastMs = 0;
-    Serial.println("UART CMD: EMULATE_WIFI_ON -> WiFi emulation disabled");
-    Serial.println("UART CMD: relay INTERNET forced INACTIVE");
+    sys.emulateWifiOff = false;
+    sys.emulateWifiOffLogged = false;
+    sys.relay.wifiDisconnectedSinceMs = 0;
+    sys.relay.cutActive = false;
+    sys.relay.cutUntilMs = 0;
+    sys.wifiOffLivePrintLastMs = 0;
+    msgPrintln(Msg::CMD_WIFI_ON);
+    msgPrintln(Msg::CMD_WIFI_ON_RELAY);
     connectWifi();
-    Serial.println();
-    logEvent("UART command: EMULATE_WIFI_ON");
+    console.println();
+    logEvent(Msg::EVT_CMD_WIFI_ON);
+    return;
+  }
+
+  if (cmd == "HTTPSNOW") {
+    NetArenaScope scope(netArena, NET_OP_HTTPS_TIME);
+    char* dateHeader = netArena.allocText(HTTPS_DATE_BYTES);
+    const int code = dateHeader != nullptr ? httpsHead(HTTPS_TIME_PATH, dateHeader, HTTPS_DATE_BYTES) : -1;
+    msgPrintln(Msg::CMD_HTTPSNOW, code, httpsStats.lastHandshakeMs, dateHeader != nullptr && dateHeader[0] ? dateHeader : "-");
+    printHttpsStatus();
+    console.println();
+    return;
+  }
+
+  if (cmd == "OTA" || cmd.startsWith("OTA ")) {
+    String url = (cmd == "OTA") ? String(OTA_FIRMWARE_URL) : raw.substring(4);
+    url.trim();
+    const bool ok = otaStart(url.c_str(), false);
+    msgPrintln(ok ? Msg::CMD_OTA_STARTED : Msg::CMD_OTA_FAILED);
+    console.println();
+    return;
+  }
+
+  if (cmd.startsWith("TELEMETRY ")) {
+    const uint32_t intervalMs = static_cast<uint32_t>(cmd.substring(10).toInt()) * 1000;
+    setTelemetryInterval(intervalMs);
+    msgPrintln(Msg::CMD_TELEMETRY, intervalMs);
+    console.println();
+    return;
+  }
+
+  if (cmd == "TRACE DUMP") {
+    traceDumpRam();
+    console.println();
+    return;
+  }
+
+  if (cmd == "TRACE SAVED") {
+    traceDumpSaved();
+    console.println();
+    return;
+  }
+
+  if (cmd == "TRACE SAVE") {
+    traceRequestFlush("manual", true);
+    msgPrintln(Msg::CMD_TRACE_SAVE);
+    console.println();
+    return;
+  }
+
+  if (cmd.startsWith("LANG ")) {
+    MsgLang lang;
+    if (msgLangParse(cmd.c_str() + 5, &lang)) {
+      consoleLang = lang;
+      msgPrintln(Msg::CMD_LANG, msgLangName(lang));
+    } else {
+      msgPrintln(Msg::CMD_LANG_INVALID);
+    }
+    console.println();
+    return;
+  }
+
+  if (cmd == "TSDB") {
+    printTsdbStatus();
+    console.println();
+    return;
+  }
+
+  if (cmd == "TSDB FLUSH") {
+    msgPrintln(Msg::CMD_TSDB_FLUSH, tsdbFlush());
+    console.println();
+    return;
+  }
+
+  if (cmd.startsWith("TSDB ")) {
+    // TSDB <ore> = ultimele ore; TSDB <de_la> <până_la> = epoch-uri (UTC)
+    const uint32_t nowEpoch = static_cast<uint32_t>(time(nullptr));
+    const int space = cmd.indexOf(' ', 5);
+    uint32_t from = 0, to = 0;
+    if (space < 0) {
+      const uint32_t hours = static_cast<uint32_t>(cmd.substring(5).toInt());
+      if (hours != 0 && nowEpoch >= 1700000000) {
+        from = nowEpoch - hours * 3600;
+        to = nowEpoch;
+      }
+    } else {
+      from = static_cast<uint32_t>(strtoul(cmd.c_str() + 5, nullptr, 10));
+      to = static_cast<uint32_t>(strtoul(cmd.c_str() + space + 1, nullptr, 10));
+    }
+    if (from == 0 || to < from) {
+      msgPrintln(Msg::CMD_TSDB_INVALID);
+    } else {
+      tsdbStartQuery(from, to);
+    }
+    return;
+  }
+
+  if (cmd == "FAULT" || cmd.startsWith("FAULT ")) {
+    faultCommand(cmd);
+    console.println();
     return;
   }
 
   if (cmd == "HELP") {
-    Serial.println("UART commands: ARM, DISARM, STATUS, PINGNOW, EMULATE_WIFI_OFF, EMULATE_WIFI_ON, HELP");
-    Serial.println();
+    msgPrintln(Msg::CMD_HELP);
+    console.println();
     return;
   }
 
-  Serial.print("UART CMD unknown: ");
-  Serial.println(cmd);
-  Serial.println("Try: HELP");
-  Serial.println();
+  msgPrintln(Msg::CMD_UNKNOWN, cmd.c_str());
+  msgPrintln(Msg::CMD_TRY_HELP);
+  console.println();
 }
 
 static void handleSerialCommands() {
@@ -925,7 +2066,7 @@ static void handleSerialCommands() {
     const char c = static_cast<char>(Serial.read());
     if (c == '\r') continue;
     if (c == '\n') {
-      processSerialCommand(serialRxLine);
+      processSerialCommand(serialRxLine, CmdSource::UART);
       serialRxLine = "";
       continue;
     }
@@ -936,122 +2077,2010 @@ static void handleSerialCommands() {
   }
 }
 
+// Pași: RELAY1 ON/OFF x2, apoi RELAY2 ON/OFF x2, câte STARTUP_TEST_STEP_MS fiecare.
+static const uint32_t STARTUP_TEST_DURATION_MS = relaySelfTestDurationMs(STARTUP_TEST_STEP_MS);
+
 static void startupRelayStartupTest() {
-  Serial.println("Startup test: RELAY1 x2, then RELAY2 x2");
+  console.println(F("Startup test: RELAY1 x2, then RELAY2 x2 (async)"));
+  startupTest = RelaySelfTest();
+  relaySelfTestRun(startupTest, millis(), STARTUP_TEST_STEP_MS);
+}
 
-  for (int i = 0; i < 2; ++i) {
-    digitalWrite(PIN_RELAY1_INTERNET, RELAY_ON_LEVEL);
-    delay(1000);
-    digitalWrite(PIN_RELAY1_INTERNET, RELAY_OFF_LEVEL);
-    delay(1000);
+static void updateStartupRelayTest() {
+  if (!startupTest.running()) return;
+  if (relaySelfTestRun(startupTest, millis(), STARTUP_TEST_STEP_MS) == CoStatus::DONE) {
+    console.println(F("Startup test done."));
+    console.println();
   }
+}
 
-  for (int i = 0; i < 2; ++i) {
-    digitalWrite(PIN_RELAY2, RELAY_ON_LEVEL);
-    delay(1000);
-    digitalWrite(PIN_RELAY2, RELAY_OFF_LEVEL);
-    delay(1000);
-  }
+// ----------------------------
+// Supervizor loop + watchdog (context crash în RTC)
+// ----------------------------
+// Fiecare task supravegheat face check-in din loop(). Tickerul de 1s copiază
+// contextul curent în memoria RTC (supraviețuiește reset-urilor WDT/excepție/soft)
+// și forțează reset dacă un task nu a mai făcut check-in în deadline-ul lui.
+// Watchdog-ul soft/hardware al core-ului rămâne activ pentru blocajele fără yield();
+// pentru acelea, etapa curentă este deja în RTC (scrisă la fiecare setLoopStage()).
+enum SupervisedTask : uint8_t { TASK_ALARM,
+                                TASK_NETWORK,
+                                TASK_SERIAL,
+                                TASK_COUNT };
+
+// Deadline-urile acoperă blocajele legitime (connectWifi() 15s, HTTP GET, ping).
+static const SupervisedTaskInfo SUPERVISED_TASKS[TASK_COUNT] = {
+  { "alarm", 30'000 },
+  { "network", 45'000 },
+  { "serial", 30'000 },
+};
 
-  digitalWrite(PIN_RELAY1_INTERNET, RELAY_OFF_LEVEL);
-  digitalWrite(PIN_RELAY2, RELAY_OFF_LEVEL);
-  Serial.println("Startup test done.");
-  Serial.println();
+// Layout RTC user memory (offset în blocuri de 4 bytes)
+static const uint32_t RTC_SLOT_CRASH_CONTEXT = 0;
+static const uint32_t RTC_SLOT_LOOP_STAGE = 8;
+static const uint32_t LOOP_STAGE_WORD_MAGIC = 0x5A6E0000;
+
+using CrashContext = CrashContextT<ALARM_PARTITION_MAX>;
+static_assert(sizeof(CrashContext) % 4 == 0, "RTC user memory is word addressed");
+static_assert(sizeof(CrashContext) <= RTC_SLOT_LOOP_STAGE * 4, "CrashContext overlaps loop stage slot");
+
+static Ticker supervisorTicker;
+static LoopStage loopStage = LoopStage::BOOT;
+static uint32_t taskCheckInMs[TASK_COUNT] = {};
+static uint32_t bootCount = 0;
+static bool previousCrashValid = false;
+static CrashContext previousCrash = {};
+static LoopStage previousStage = LoopStage::BOOT;
+static bool previousStageValid = false;
+
+static void setLoopStage(LoopStage s) {
+  if (loopStage == s) return;
+  loopStage = s;
+  // un singur cuvânt în RTC: rămâne valid chiar dacă urmează un blocaj fără yield()
+  uint32_t word = LOOP_STAGE_WORD_MAGIC | static_cast<uint32_t>(s);
+  ESP.rtcUserMemoryWrite(RTC_SLOT_LOOP_STAGE, &word, sizeof(word));
 }
 
-void setup() {
-  Serial.begin(115200);
-  Serial.setDebugOutput(true);
-  serialRxLine.reserve(96);
-  lastAutoStatusMs = millis();
-  Serial.println();
-  Serial.println("Alarma simpla starting...");
-  printBootInfo();
-  for (int i = 0; i < 4; ++i) {
-    pinMode(PIN_PIR[i], INPUT);
+static void supervisorCheckIn(uint8_t task) {
+  if (task < TASK_COUNT) {
+    taskCheckInMs[task] = millis();
   }
-  pinMode(PIN_RELAY1_INTERNET, OUTPUT);
-  pinMode(PIN_RELAY2, OUTPUT);
-  pinMode(PIN_LED, OUTPUT);
-  pinMode(PIN_BUTTON, INPUT_PULLUP);
+}
 
-  setOutputs(false, false, false);
-  startupRelayStartupTest();
-  relaySchedulerUnlockMs = millis() + RELAY_STARTUP_HOLDOFF_MS;
-  Serial.println("Relay scheduler holdoff: 60s (relay OFF)");
-  Serial.println();
-  enterState(AlarmState::DISARMED);
+static void saveCrashContext(CrashCause cause, uint8_t task, const SystemState& snap) {
+  CrashContext ctx;
+  crashContextCapture(&ctx, cause, task, static_cast<uint8_t>(loopStage), snap, millis(), ESP.getFreeHeap(), bootCount);
+  ESP.rtcUserMemoryWrite(RTC_SLOT_CRASH_CONTEXT, reinterpret_cast<uint32_t*>(&ctx), sizeof(ctx));
+}
 
-  connectWifi();
-  prevWifiConnected = isWifiConnected();
-  ensureTimeSyncIfNeeded();
-  logEvent("Setup complete");
-#if 0
-  connectMqtt();
-#endif
+// Deciziile (copie consistentă sau nu, task blocat) sunt în supervisor.h,
+// verificate pe host de tools/supervisor_sim.cpp.
+static void supervisorTick() {
+  const bool reset = supervisorTickStep(millis(), taskCheckInMs, SUPERVISED_TASKS, TASK_COUNT, systemState, [](CrashCause cause, uint8_t task, const SystemState& snap) {
+    saveCrashContext(cause, task, snap);
+    saveRelaySchedulerRtc(snap);
+  });
+  if (reset) ESP.reset();
 }
 
-void loop() {
+static void supervisorBegin() {
   const uint32_t now = millis();
+  for (uint8_t i = 0; i < TASK_COUNT; ++i) {
+    taskCheckInMs[i] = now;
+  }
+  saveCrashContext(CrashCause::NONE, SUPERVISOR_NO_TASK, sys);
+  supervisorTicker.attach_ms(1000, supervisorTick);
+}
 
-  updateWifiDisconnectTracking();
-  enforceInternetRelayOffWhenWifiConnected();
-  printStatusEvery30SecIfNeeded();
-  updateInternetCutRelayPulse();
-  handleWifiReconnectRelayRetry();
-  printWifiOffLiveTelemetryEverySec();
-  handleSerialCommands();
-  updateButton();
+static void loadCrashContextAtBoot() {
+  CrashContext ctx = {};
+  ESP.rtcUserMemoryRead(RTC_SLOT_CRASH_CONTEXT, reinterpret_cast<uint32_t*>(&ctx), sizeof(ctx));
+  previousCrashValid = crashContextValid(ctx);
+  if (previousCrashValid) {
+    previousCrash = ctx;
+    bootCount = ctx.bootCount + 1;
+  }
 
-  switch (state) {
-    case AlarmState::DISARMED:
-      // LED blink în starea dezarmată
-      setOutputs(internetCutActive, false, ((now / 500) % 2) == 0);
-      break;
+  uint32_t word = 0;
+  ESP.rtcUserMemoryRead(RTC_SLOT_LOOP_STAGE, &word, sizeof(word));
+  previousStageValid = (word & 0xFFFFFF00u) == LOOP_STAGE_WORD_MAGIC && (word & 0xFFu) <= static_cast<uint32_t>(LoopStage::IDLE);
+  if (previousStageValid) {
+    previousStage = static_cast<LoopStage>(word & 0xFFu);
+  }
+}
+
+// ----------------------------
+// Persistență stare (RTC pentru reset-uri, flash pentru power loss)
+// ----------------------------
+// Flash-ul (EEPROM emulat) se scrie doar când se schimbă starea armat/dezarmat
+// a unei partiții, nu la ALARMING/ENTRY_DELAY <-> ARMED, ca să nu uzeze sectorul.
+static const uint32_t PERSIST_MAGIC = 0xA1A2F1A5;
+static const uint8_t PERSIST_VERSION = 2;  // v1: o singură stare pentru toată casa
+static const size_t EEPROM_SIZE = 64;
+static const int EEPROM_OFFSET_ALARM = 0;
+static const int EEPROM_OFFSET_OTA = 32;
+static const uint32_t RTC_SLOT_RELAY_SCHEDULER = 16;
+
+struct PersistedAlarmRecord {
+  uint32_t magic;
+  uint32_t crc;
+  uint8_t version;
+  uint8_t partitionCount;
+  uint8_t armState[ALARM_PARTITION_MAX];  // DISARMED / ARMING / ARMED / ARMED_STAY
+  uint8_t armMode[ALARM_PARTITION_MAX];   // ARMED / ARMED_STAY (ținta lui ARMING)
+  uint16_t reserved;
+};
+static_assert(sizeof(PersistedAlarmRecord) <= EEPROM_OFFSET_OTA - EEPROM_OFFSET_ALARM, "EEPROM alarm area too small");
+
+struct PersistedAlarmRecordV1 {
+  uint32_t magic;
+  uint32_t crc;
+  uint8_t version;
+  uint8_t armState;
+  uint16_t reserved;
+};
 
-    case AlarmState::ARMING:
-      {
-        // clipire lentă pe durata arming
-        const bool blink = ((now / 500) % 2) == 0;
-        setOutputs(internetCutActive, false, blink);
+static_assert(RTC_SLOT_RELAY_SCHEDULER >= RTC_SLOT_LOOP_STAGE + 1, "RTC slots overlap");
 
-        if (now - stateSinceMs >= EXIT_DELAY_MS) {
-          enterState(AlarmState::ARMED);
-        }
-        break;
-      }
+static bool persistedRecordValid = false;
+static PersistedAlarmRecord persistedRecord = {};
+static bool relaySchedulerRestored = false;
+
+static AlarmState persistableArmState(const AlarmPartition& part) {
+  return (part.state == AlarmState::ALARMING || part.state == AlarmState::ENTRY_DELAY) ? part.armedMode : part.state;
+}
 
-    case AlarmState::ARMED:
-      {
-        // LED ON constant ca indicator
-        setOutputs(internetCutActive, false, true);
+static bool persistableState(uint8_t s) {
+  return s == static_cast<uint8_t>(AlarmState::DISARMED) || s == static_cast<uint8_t>(AlarmState::ARMING) || s == static_cast<uint8_t>(AlarmState::ARMED) || s == static_cast<uint8_t>(AlarmState::ARMED_STAY);
+}
 
-        if (motionDetected()) {
-          enterState(AlarmState::ALARMING);
-        }
-        break;
-      }
+static uint32_t persistedRecordCrc(const PersistedAlarmRecord& rec) {
+  const uint8_t* body = reinterpret_cast<const uint8_t*>(&rec.version);
+  return crc32Update(0, body, sizeof(rec) - offsetof(PersistedAlarmRecord, version));
+}
 
-    case AlarmState::ALARMING:
-      {
-        // Sirenă continuă (simplu). Dacă vrei ton intermitent, schimbă aici.
-        setOutputs(internetCutActive, true, true);
+// Înregistrarea v1 (o stare pentru toată casa) se aplică tuturor partițiilor.
+static bool loadPersistedRecordV1(PersistedAlarmRecord* out) {
+  PersistedAlarmRecordV1 v1 = {};
+  EEPROM.get(EEPROM_OFFSET_ALARM, v1);
+  const uint8_t* body = reinterpret_cast<const uint8_t*>(&v1.version);
+  if (v1.magic != PERSIST_MAGIC || v1.version != 1 || v1.crc != crc32Update(0, body, sizeof(v1) - offsetof(PersistedAlarmRecordV1, version))) return false;
+  if (v1.armState > static_cast<uint8_t>(AlarmState::ARMED)) return false;
+
+  *out = {};
+  out->magic = PERSIST_MAGIC;
+  out->version = PERSIST_VERSION;
+  out->partitionCount = ALARM_PARTITION_COUNT;
+  for (uint8_t i = 0; i < ALARM_PARTITION_MAX; ++i) {
+    out->armState[i] = v1.armState;
+    out->armMode[i] = static_cast<uint8_t>(AlarmState::ARMED);
+  }
+  out->crc = persistedRecordCrc(*out);
+  return true;
+}
+
+static void loadPersistedState() {
+  EEPROM.begin(EEPROM_SIZE);
+  PersistedAlarmRecord rec = {};
+  EEPROM.get(EEPROM_OFFSET_ALARM, rec);
+  persistedRecordValid = (rec.magic == PERSIST_MAGIC && rec.version == PERSIST_VERSION && rec.crc == persistedRecordCrc(rec) && rec.partitionCount == ALARM_PARTITION_COUNT);
+  for (uint8_t i = 0; persistedRecordValid && i < ALARM_PARTITION_COUNT; ++i) {
+    persistedRecordValid = persistableState(rec.armState[i]) && (rec.armMode[i] == static_cast<uint8_t>(AlarmState::ARMED) || rec.armMode[i] == static_cast<uint8_t>(AlarmState::ARMED_STAY));
+  }
+  if (!persistedRecordValid) {
+    persistedRecordValid = loadPersistedRecordV1(&rec);
+  }
+  if (persistedRecordValid) {
+    persistedRecord = rec;
+  }
+}
+
+static void persistArmStateIfChanged() {
+  PersistedAlarmRecord rec = {};
+  rec.magic = PERSIST_MAGIC;
+  rec.version = PERSIST_VERSION;
+  rec.partitionCount = ALARM_PARTITION_COUNT;
+  for (uint8_t i = 0; i < ALARM_PARTITION_MAX; ++i) {
+    const bool used = i < ALARM_PARTITION_COUNT;
+    rec.armState[i] = static_cast<uint8_t>(used ? persistableArmState(sys.partitions[i]) : AlarmState::DISARMED);
+    rec.armMode[i] = static_cast<uint8_t>((used && sys.partitions[i].armedMode == AlarmState::ARMED_STAY) ? AlarmState::ARMED_STAY : AlarmState::ARMED);
+  }
+  if (persistedRecordValid && memcmp(persistedRecord.armState, rec.armState, sizeof(rec.armState)) == 0 && memcmp(persistedRecord.armMode, rec.armMode, sizeof(rec.armMode)) == 0) return;
+
+  rec.crc = persistedRecordCrc(rec);
+  EEPROM.put(EEPROM_OFFSET_ALARM, rec);
+  if (EEPROM.commit()) {
+    persistedRecord = rec;
+    persistedRecordValid = true;
+  }
+}
+
+// Apelat din tickerul supervizorului (1s), odată cu contextul de crash (și la
+// reset-ul pentru task blocat): contorul de activări și cooldown-ul rămas.
+static void saveRelaySchedulerRtc(const SystemState& snap) {
+  RelaySchedulerRtc rec;
+  relaySchedulerRtcCapture(&rec, snap.relay, millis());
+  ESP.rtcUserMemoryWrite(RTC_SLOT_RELAY_SCHEDULER, reinterpret_cast<uint32_t*>(&rec), sizeof(rec));
+}
+
+static const uint32_t RTC_SLOT_WIFI_CACHE = 24;
+static const uint32_t WIFI_CACHE_MAGIC = 0xA1A2CAC4;
+static_assert(RTC_SLOT_WIFI_CACHE * 4 >= RTC_SLOT_RELAY_SCHEDULER * 4 + sizeof(RelaySchedulerRtc), "RTC slots overlap");
+static_assert(sizeof(WifiCache) % 4 == 0, "RTC user memory is word addressed");
+
+static uint32_t wifiCacheCrc(const WifiCache& c) {
+  const uint8_t* body = reinterpret_cast<const uint8_t*>(&c.ip);
+  return crc32Update(0, body, sizeof(c) - offsetof(WifiCache, ip));
+}
+
+static void saveWifiCacheRtc() {
+  wifiCache.magic = WIFI_CACHE_MAGIC;
+  wifiCache.crc = wifiCacheCrc(wifiCache);
+  ESP.rtcUserMemoryWrite(RTC_SLOT_WIFI_CACHE, reinterpret_cast<uint32_t*>(&wifiCache), sizeof(wifiCache));
+}
+
+static void loadWifiCacheRtc() {
+  WifiCache c = {};
+  ESP.rtcUserMemoryRead(RTC_SLOT_WIFI_CACHE, reinterpret_cast<uint32_t*>(&c), sizeof(c));
+  sys.wifiCacheValid = (c.magic == WIFI_CACHE_MAGIC && c.crc == wifiCacheCrc(c) && c.networkIndex < WIFI_NETWORK_COUNT && c.channel != 0);
+  if (sys.wifiCacheValid) {
+    wifiCache = c;
+  }
+}
+
+// După un reset la cald nu mai așteptăm holdoff-ul complet de 60s, doar
+// cooldown-ul rămas din ciclul anterior (+ testul releelor).
+static void restoreRelayScheduler() {
+  RelaySchedulerRtc rec = {};
+  ESP.rtcUserMemoryRead(RTC_SLOT_RELAY_SCHEDULER, reinterpret_cast<uint32_t*>(&rec), sizeof(rec));
+  relaySchedulerRestored = relaySchedulerRtcValid(rec);
+
+  const uint32_t now = millis();
+  if (relaySchedulerRestored) {
+    sys.relay.activationCount = rec.activationCount;
+    sys.relay.unlockMs = now + STARTUP_TEST_DURATION_MS + rec.cooldownRemainingMs;
+  } else {
+    sys.relay.unlockMs = now + STARTUP_TEST_DURATION_MS + RELAY_STARTUP_HOLDOFF_MS;
+  }
+}
+
+// Starea fiecărei partiții de restaurat: RTC (reset la cald) are prioritate,
+// apoi flash (power loss); fără niciuna => DISARMED.
+static AlarmState restoredPartitionState(uint8_t p, AlarmState* armedMode) {
+  if (previousCrashValid) return crashContextRestoreState(previousCrash, p, armedMode);
+  const uint8_t mode = persistedRecordValid ? persistedRecord.armMode[p] : 0;
+  *armedMode = (mode == static_cast<uint8_t>(AlarmState::ARMED_STAY)) ? AlarmState::ARMED_STAY : AlarmState::ARMED;
+  if (!persistedRecordValid) return AlarmState::DISARMED;
+  return static_cast<AlarmState>(persistedRecord.armState[p]);
+}
+
+// Toate stările se citesc înainte de prima tranziție: enterPartitionState()
+// rescrie înregistrarea din flash din care se restaurează.
+static void restoreAlarmPartitions() {
+  for (uint8_t i = 0; i < ALARM_PARTITION_COUNT; ++i) {
+    AlarmState mode = AlarmState::ARMED;
+    sys.partitions[i].state = restoredPartitionState(i, &mode);
+    sys.partitions[i].armedMode = mode;
+  }
+  for (uint8_t i = 0; i < ALARM_PARTITION_COUNT; ++i) {
+    enterPartitionState(i, sys.partitions[i].state);
+  }
+}
 
-        if (now >= alarmUntilMs) {
-          // rămâne armat după alarmă
-          enterState(AlarmState::ARMED);
-        }
-        break;
+static void printCrashReport() {
+  if (!previousCrashValid) {
+    console.print(F("[BOOT] Crash context: none (power-on), flash arm state: "));
+    if (!persistedRecordValid) {
+      console.println(F("-"));
+    } else {
+      for (uint8_t i = 0; i < ALARM_PARTITION_COUNT; ++i) {
+        console.print(i ? ", P" : "P");
+        console.print(i + 1);
+        console.print(F("="));
+        console.print(stateToString(static_cast<AlarmState>(persistedRecord.armState[i])));
       }
+      console.println();
+    }
+    console.println();
+    return;
+  }
+
+  char up[32];
+  formatDurationMs(previousCrash.uptimeMs, up, sizeof(up));
+  console.println(F("[BOOT] ----- Crash context (RTC) -----"));
+  console.print(F("[BOOT] Boot count: "));
+  console.println(bootCount);
+  console.print(F("[BOOT] Last stage: "));
+  console.println(loopStageToString(previousStageValid ? previousStage : static_cast<LoopStage>(previousCrash.stage)));
+  console.print(F("[BOOT] Alarm state: "));
+  console.println(stateToString(static_cast<AlarmState>(previousCrash.alarmState)));
+  console.print(F("[BOOT] Uptime: "));
+  console.println(up);
+  console.print(F("[BOOT] Free heap: "));
+  console.println(previousCrash.freeHeap);
+  console.print(F("[BOOT] Cause: "));
+  if (static_cast<CrashCause>(previousCrash.cause) == CrashCause::SUPERVISOR_TIMEOUT && previousCrash.task < TASK_COUNT) {
+    console.print(F("supervisor timeout (task "));
+    console.print(SUPERVISED_TASKS[previousCrash.task].name);
+    console.println(F(")"));
+  } else {
+    console.println(F("core reset (see reset reason)"));
+  }
+  console.print(F("[BOOT] Restored alarm state: "));
+  console.println(stateToString(sys.alarmState));
+  console.println(F("[BOOT] --------------------------------"));
+  console.println();
+}
+
+// ----------------------------
+// OTA (HTTP din LAN, streaming non-blocant)
+// ----------------------------
+// Imaginea se descarcă în bucăți de OTA_CHUNK_BYTES din loop(), deci PIR-urile
+// și sirena rămân active. SHA-256 se verifică înainte de ultimul write: la
+// nepotrivire update-ul e abandonat și imaginea curentă rămâne neatinsă.
+// ESP8266 nu are două sloturi de aplicație (Updater scrie în spațiul liber și
+// eboot copiază la reboot), așa că "rollback" = reinstalarea imaginii bune de la
+// OTA_ROLLBACK_URL. Imaginea nouă pornește de cel mult OTA_MAX_BOOT_ATTEMPTS
+// ori: dacă primele nu ating health-check-ul, ultimul boot cere rollback-ul.
+// Se descarcă doar de pe serverul din OTA_FIRMWARE_URL (schemă, host, port),
+// iar comanda OTA se acceptă doar pe UART.
+static const size_t OTA_CHUNK_BYTES = 1024;
+static const uint32_t OTA_STALL_TIMEOUT_MS = 10'000;
+static const uint16_t OTA_HTTP_TIMEOUT_MS = 2'000;  // connect + răspuns; loop() e blocat cât așteaptă
+static const uint32_t OTA_HEALTH_CHECK_MS = 60'000;
+static const uint32_t OTA_ROLLBACK_RETRY_MS = 60'000;  // între încercările de rollback eșuate
+static const uint8_t OTA_MAX_BOOT_ATTEMPTS = 3;
+static const uint32_t OTA_RECORD_MAGIC = 0xA1A2077A;
+
+enum class OtaPhase : uint8_t { IDLE,
+                                DOWNLOADING };
+
+struct OtaRecord {
+  uint32_t magic;
+  uint32_t crc;
+  uint8_t pending;  // imagine nouă, neconfirmată de health-check
+  uint8_t bootAttempts;
+  uint16_t reserved;
+};
+static_assert(sizeof(OtaRecord) <= EEPROM_SIZE - EEPROM_OFFSET_OTA, "EEPROM OTA area too small");
+
+static OtaPhase otaPhase = OtaPhase::IDLE;
+static HTTPClient otaHttp;
+static WiFiClient otaClient;
+static br_sha256_context otaSha;
+static uint8_t otaExpectedSha[32];
+static uint8_t otaChunk[OTA_CHUNK_BYTES];
+static uint32_t otaTotalBytes = 0;
+static uint32_t otaReceivedBytes = 0;
+static uint32_t otaStartMs = 0;
+static uint32_t otaLastDataMs = 0;
+static uint32_t otaMaxLoopStallUs = 0;
+static bool otaIsRollback = false;
+static OtaRecord otaRecord = {};
+static bool otaRollbackRequested = false;
+static uint32_t otaRollbackRetryAtMs = 0;  // 0 = imediat ce WiFi e conectat
+static uint16_t otaRollbackFailures = 0;
+
+static uint32_t otaRecordCrc(const OtaRecord& rec) {
+  const uint8_t* body = reinterpret_cast<const uint8_t*>(&rec.pending);
+  return crc32Update(0, body, sizeof(rec) - offsetof(OtaRecord, pending));
+}
+
+static void saveOtaRecord() {
+  otaRecord.magic = OTA_RECORD_MAGIC;
+  otaRecord.crc = otaRecordCrc(otaRecord);
+  EEPROM.put(EEPROM_OFFSET_OTA, otaRecord);
+  EEPROM.commit();
+}
+
+static bool otaActive() {
+  return otaPhase != OtaPhase::IDLE;
+}
+
+static void printOtaStatus() {
+  console.print(F("OTA: "));
+  if (otaActive()) {
+    console.print(otaReceivedBytes);
+    console.print(F("/"));
+    console.println(otaTotalBytes);
+  } else {
+    console.println(otaRecord.pending ? "PENDING_HEALTH_CHECK" : "IDLE");
+  }
+}
+
+static void putOtaStatus(StatusDeltaEncoder& e) {
+  if (otaActive()) {
+    char progress[24];
+    snprintf(progress, sizeof(progress), "%u/%u", (unsigned)otaReceivedBytes, (unsigned)otaTotalBytes);
+    e.put(StatusField::OTA, progress);
+  } else {
+    e.put(StatusField::OTA, otaRecord.pending ? "PENDING_HEALTH_CHECK" : "IDLE");
+  }
+}
+
+static int hexNibble(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// Fișierul .sha256 poate fi ieșirea lui `sha256sum` ("<hex>  firmware.bin").
+static bool parseSha256Hex(const char* text, uint8_t* out) {
+  for (int i = 0; i < 32; ++i) {
+    const int hi = hexNibble(text[2 * i]);
+    const int lo = (hi < 0) ? -1 : hexNibble(text[2 * i + 1]);
+    if (lo < 0) return false;
+    out[i] = static_cast<uint8_t>((hi << 4) | lo);
   }
+  return true;
+}
+
+static bool otaFetchExpectedSha(const char* url) {
+  // URL-ul și conținutul .sha256 ("<64 hex>  nume") stau în netArena, nu în String.
+  NetArenaScope scope(netArena, NET_OP_OTA_SHA);
+  char* shaUrl = netArena.allocText(OTA_SHA_URL_BYTES);
+  char* body = netArena.allocText(OTA_SHA_BODY_BYTES);
+  if (shaUrl == nullptr || body == nullptr) return false;
+  snprintf(shaUrl, OTA_SHA_URL_BYTES, "%s.sha256", url);
+
+  HTTPClient http;
+  WiFiClient client;
+  http.setTimeout(OTA_HTTP_TIMEOUT_MS);
+  if (!http.begin(client, shaUrl)) return false;
+  const int code = http.GET();
+  bool ok = false;
+  if (code == HTTP_CODE_OK) {
+    const size_t n = http.getStream().readBytes(body, OTA_SHA_BODY_BYTES - 1);
+    body[n] = '\0';
+    ok = n >= 64 && parseSha256Hex(body, otaExpectedSha);
+  }
+  http.end();
+  return ok;
+}
+
+// Rollback eșuat (server inaccesibil, 404, descărcare întreruptă): următoarea
+// încercare abia peste OTA_ROLLBACK_RETRY_MS, nu la fiecare trecere prin loop(),
+// unde GET-ul .sha256 blochează până la OTA_HTTP_TIMEOUT_MS.
+static void otaRollbackRetryLater() {
+  ++otaRollbackFailures;
+  otaRollbackRequested = true;
+  otaRollbackRetryAtMs = millis() + OTA_ROLLBACK_RETRY_MS;
+  if (otaRollbackRetryAtMs == 0) otaRollbackRetryAtMs = 1;
+  console.print(F("OTA rollback failed (attempt "));
+  console.print(otaRollbackFailures);
+  console.print(F("), retry in "));
+  console.print(OTA_ROLLBACK_RETRY_MS / 1000);
+  console.println(F(" s"));
+}
+
+static void otaAbort(const char* reason) {
+  Update.end(false);
+  otaHttp.end();
+  otaPhase = OtaPhase::IDLE;
+  console.print(F("OTA aborted: "));
+  console.println(reason);
+  console.println();
+  logEvent(Msg::EVT_OTA_ABORTED);
+  if (otaIsRollback) otaRollbackRetryLater();
+}
+
+// "http://host:port/" din OTA_FIRMWARE_URL: URL-ul cerut trebuie să înceapă
+// exact așa (fără alt host în userinfo, fără alt port).
+static bool otaUrlAllowed(const char* url) {
+  const char* scheme = strstr(OTA_FIRMWARE_URL, "://");
+  if (scheme == nullptr) return false;
+  const char* path = strchr(scheme + 3, '/');
+  const size_t originLen = (path != nullptr) ? static_cast<size_t>(path - OTA_FIRMWARE_URL) + 1 : strlen(OTA_FIRMWARE_URL);
+  return strncmp(url, OTA_FIRMWARE_URL, originLen) == 0 && (path != nullptr || url[originLen] == '/');
+}
 
-  // WiFi menținut în viață din loop
+static bool otaStart(const char* url, bool rollback) {
+  if (otaActive()) return false;
+  if (!otaUrlAllowed(url)) {
+    console.println(F("OTA: URL not on the OTA_FIRMWARE_URL server"));
+    return false;
+  }
   if (!isWifiConnected()) {
-    connectWifi();
+    console.println(F("OTA: WiFi not connected"));
+    return false;
   }
 
-  ensureTimeSyncIfNeeded();
-  pingGoogleIfNeeded();
+  setLoopStage(LoopStage::OTA);
+  if (!otaFetchExpectedSha(url)) {
+    console.println(F("OTA: cannot read <url>.sha256"));
+    return false;
+  }
+
+  otaHttp.setTimeout(OTA_HTTP_TIMEOUT_MS);
+  if (!otaHttp.begin(otaClient, url)) return false;
+  const int code = otaHttp.GET();
+  const int size = otaHttp.getSize();
+  if (code != HTTP_CODE_OK || size <= 0) {
+    otaHttp.end();
+    console.print(F("OTA: HTTP error, code="));
+    console.println(code);
+    return false;
+  }
+  if (!Update.begin(static_cast<size_t>(size))) {
+    otaHttp.end();
+    console.print(F("OTA: Update.begin failed: "));
+    console.println(Update.getErrorString());
+    return false;
+  }
+
+  br_sha256_init(&otaSha);
+  otaTotalBytes = static_cast<uint32_t>(size);
+  otaReceivedBytes = 0;
+  otaStartMs = millis();
+  otaLastDataMs = otaStartMs;
+  otaMaxLoopStallUs = 0;
+  otaIsRollback = rollback;
+  otaPhase = OtaPhase::DOWNLOADING;
+
+  console.print(F("OTA start: "));
+  console.print(url);
+  console.print(F(" ("));
+  console.print(otaTotalBytes);
+  console.println(F(" bytes)"));
+  logEvent(rollback ? Msg::EVT_OTA_ROLLBACK_STARTED : Msg::EVT_OTA_STARTED);
+  return true;
+}
+
+// Apelat după ultimul write (SHA-256 deja verificat).
+static void otaFinish() {
+  if (!Update.end(false)) {
+    otaAbort(Update.getErrorString().c_str());
+    return;
+  }
+  otaHttp.end();
+  otaPhase = OtaPhase::IDLE;
+
+  const uint32_t elapsedMs = millis() - otaStartMs;
+  console.print(F("OTA done: "));
+  console.print(otaTotalBytes);
+  console.print(F(" bytes in "));
+  console.print(elapsedMs);
+  console.print(F(" ms ("));
+  console.print(elapsedMs ? (otaTotalBytes / elapsedMs) : 0);
+  console.print(F(" KB/s), max loop stall "));
+  console.print(otaMaxLoopStallUs);
+  console.println(F(" us"));
+  console.println();
+
+  // imaginea de rollback e considerată bună; cea nouă trebuie confirmată
+  otaRecord.pending = otaIsRollback ? 0 : 1;
+  otaRecord.bootAttempts = 0;
+  saveOtaRecord();
+  tsdbFlush();  // ora curentă de eșantioane nu se pierde la reboot
+  logEvent(otaIsRollback ? Msg::EVT_OTA_ROLLBACK_DONE : Msg::EVT_OTA_DONE);
+  delay(100);
+  ESP.restart();
+}
+
+// Apelat din loop(): cel mult OTA_CHUNK_BYTES per trecere.
+static void otaUpdate() {
+  if (otaRollbackRequested && !otaActive() && isWifiConnected() &&
+      (otaRollbackRetryAtMs == 0 || static_cast<int32_t>(millis() - otaRollbackRetryAtMs) >= 0)) {
+    otaRollbackRequested = false;
+    if (!otaStart(OTA_ROLLBACK_URL, true)) otaRollbackRetryLater();
+  }
+  if (otaPhase != OtaPhase::DOWNLOADING) return;
+
+  setLoopStage(LoopStage::OTA);
+  const uint32_t now = millis();
+  WiFiClient* stream = otaHttp.getStreamPtr();
+  if (stream == nullptr || (!otaHttp.connected() && stream->available() == 0)) {
+    otaAbort("connection lost");
+    return;
+  }
+
+  const int available = stream->available();
+  if (available <= 0) {
+    if ((now - otaLastDataMs) > OTA_STALL_TIMEOUT_MS) {
+      otaAbort("download stalled");
+    }
+    return;
+  }
+
+  const uint32_t remaining = otaTotalBytes - otaReceivedBytes;
+  size_t want = std::min<size_t>(static_cast<size_t>(available), sizeof(otaChunk));
+  want = std::min<size_t>(want, remaining);
+  const int n = stream->read(otaChunk, want);
+  if (n <= 0) return;
+
+  otaLastDataMs = now;
+  br_sha256_update(&otaSha, otaChunk, static_cast<size_t>(n));
+  const bool lastChunk = (otaReceivedBytes + static_cast<uint32_t>(n)) >= otaTotalBytes;
+  if (lastChunk) {
+    // verificăm SHA înainte ca ultimul write să facă imaginea "finished"
+    uint8_t digest[32];
+    br_sha256_context probe = otaSha;
+    br_sha256_out(&probe, digest);
+    if (memcmp(digest, otaExpectedSha, sizeof(digest)) != 0) {
+      otaAbort("SHA-256 mismatch");
+      return;
+    }
+  }
+  if (Update.write(otaChunk, static_cast<size_t>(n)) != static_cast<size_t>(n)) {
+    otaAbort("flash write failed");
+    return;
+  }
+  otaReceivedBytes += static_cast<uint32_t>(n);
+  if (lastChunk) {
+    otaFinish();
+  }
+}
+
+// La boot: o imagine neconfirmată consumă o încercare; prea multe => rollback.
+static void otaBootCheck() {
+  OtaRecord rec = {};
+  EEPROM.get(EEPROM_OFFSET_OTA, rec);
+  if (rec.magic != OTA_RECORD_MAGIC || rec.crc != otaRecordCrc(rec)) {
+    otaRecord = {};
+    return;
+  }
+  otaRecord = rec;
+  if (!otaRecord.pending) return;
+
+  ++otaRecord.bootAttempts;
+  saveOtaRecord();
+  console.print(F("[BOOT] OTA image pending health check, attempt "));
+  console.print(otaRecord.bootAttempts);
+  console.print(F("/"));
+  console.println(OTA_MAX_BOOT_ATTEMPTS);
+  if (otaRecord.bootAttempts >= OTA_MAX_BOOT_ATTEMPTS) {
+    console.println(F("[BOOT] OTA health check failed -> rollback requested"));
+    otaRollbackRequested = true;
+  }
+}
+
+// Health-check: WiFi conectat și loop() viu OTA_HEALTH_CHECK_MS după boot.
+static void otaHealthCheck() {
+  if (!otaRecord.pending || otaRollbackRequested) return;
+  if (millis() < OTA_HEALTH_CHECK_MS || !isWifiConnected()) return;
+
+  otaRecord.pending = 0;
+  otaRecord.bootAttempts = 0;
+  saveOtaRecord();
+  logEvent(Msg::EVT_OTA_CONFIRMED);
+}
+
+// ----------------------------
+// Telemetrie binară UDP
+// ----------------------------
+// Un cadru de TELEMETRY_FRAME_SIZE bytes (layout în telemetry_frame.h) la
+// fiecare telemetryIntervalMs, doar cu WiFi conectat. Decodor host:
+// tools/telemetry_decoder.cpp.
+static WiFiUDP telemetryUdp;
+static IPAddress telemetryCollectorIp;
+static bool telemetryCollectorResolved = false;
+static uint32_t telemetryIntervalMs = TELEMETRY_INTERVAL_MS;
+static uint32_t telemetryLastSendMs = 0;
+static uint32_t telemetrySeq = 0;
+
+static void buildTelemetryFrame(TelemetryFrame* f, const SystemState& snap) {
+  const uint32_t nowMs = millis();
+  const time_t now = time(nullptr);
+  const bool wifiUp = isWifiConnected();
+
+  f->seq = telemetrySeq;
+  f->chipId = ESP.getChipId();
+  f->uptimeSec = nowMs / 1000;
+  f->epoch = (now >= 1700000000) ? static_cast<uint32_t>(now) : 0;
+  f->lastOutageEpoch = std::max(snap.lastPingDownEpoch, snap.lastWifiDisconnectEpoch);
+  f->pingCounter = snap.pingCounter;
+  f->relayActivationCount = snap.relay.activationCount;
+  f->freeHeap = ESP.getFreeHeap();
+  f->maxFreeBlock = ESP.getMaxFreeBlockSize();
+  f->alarmState = static_cast<uint8_t>(snap.alarmState);
+  f->flags = 0;
+  if (snap.relay.cutActive) f->flags |= TELEMETRY_FLAG_INTERNET_CUT;
+  if (snap.relay.pingDownActive) f->flags |= TELEMETRY_FLAG_PING_DOWN;
+  if (wifiUp) f->flags |= TELEMETRY_FLAG_WIFI_CONNECTED;
+  if (snap.emulateWifiOff) f->flags |= TELEMETRY_FLAG_WIFI_EMULATED_OFF;
+  if (snap.ntpReadyLogged) f->flags |= TELEMETRY_FLAG_NTP_READY;
+  if (snap.alarmState == AlarmState::ALARMING) f->flags |= TELEMETRY_FLAG_SIREN_ON;
+  if (otaRecord.pending) f->flags |= TELEMETRY_FLAG_OTA_PENDING;
+  f->rssi = wifiUp ? static_cast<int8_t>(WiFi.RSSI()) : 0;
+  f->loopStage = static_cast<uint8_t>(loopStage);
+  f->lastPingRttMs = snap.lastPingRttMs;
+  f->bootCount = bootCount;
+  f->wifiDownSec = (snap.relay.wifiDisconnectedSinceMs != 0 && !wifiUp) ? (nowMs - snap.relay.wifiDisconnectedSinceMs) / 1000 : 0;
+}
+
+// Alarmă / releu schimbat => cadru la următorul sendTelemetryIfNeeded(), nu
+// abia la finalul intervalului.
+void TelemetryEventSink::onEvent(const BusEvent&) {
+  if (telemetryIntervalMs != 0) telemetryLastSendMs = 0;
+}
+
+static void setTelemetryInterval(uint32_t intervalMs) {
+  telemetryIntervalMs = intervalMs;
+  telemetryLastSendMs = 0;
+}
+
+static bool telemetryCollectorReady() {
+  if (!telemetryCollectorResolved) telemetryCollectorResolved = resolveHost(TELEMETRY_COLLECTOR_HOST, telemetryCollectorIp);
+  return telemetryCollectorResolved;
+}
+
+static void sendTelemetryIfNeeded() {
+  if (telemetryIntervalMs == 0 || !isWifiConnected()) return;
+
+  const uint32_t now = millis();
+  if (telemetryLastSendMs != 0 && (now - telemetryLastSendMs) < telemetryIntervalMs) return;
+  telemetryLastSendMs = now;
+
+  if (!telemetryCollectorReady()) return;
+
+  TelemetryFrame frame = {};
+  buildTelemetryFrame(&frame, sys);
+  uint8_t buf[TELEMETRY_FRAME_SIZE];
+  telemetryEncode(frame, buf);
+  ++telemetrySeq;
+
+  telemetryUdp.beginPacket(telemetryCollectorIp, TELEMETRY_COLLECTOR_PORT);
+  telemetryUdp.write(buf, sizeof(buf));
+  telemetryUdp.endPacket();
+}
+
+// Un cadru pe eveniment, fără buffer: cât WiFi-ul e căzut evenimentele rămân
+// doar în syslogBuffer (nu consumă seq, deci nu apar ca pierderi).
+static void sendTelemetryEvent(Msg id, uint8_t severity, const MsgArg* args, size_t argCount) {
+  if (telemetryIntervalMs == 0 || !isWifiConnected() || !telemetryCollectorReady()) return;
+
+  TelemetryEvent e = {};
+  e.seq = telemetrySeq;
+  e.chipId = ESP.getChipId();
+  e.uptimeSec = millis() / 1000;
+  const time_t now = time(nullptr);
+  e.epoch = (now >= 1700000000) ? static_cast<uint32_t>(now) : 0;
+  e.msgId = static_cast<uint16_t>(id);
+  e.severity = severity;
+  telemetryEventSetArgs(&e, args, argCount);
+  uint8_t buf[TELEMETRY_FRAME_SIZE];
+  telemetryEventEncode(e, buf);
+  ++telemetrySeq;
+
+  telemetryUdp.beginPacket(telemetryCollectorIp, TELEMETRY_COLLECTOR_PORT);
+  telemetryUdp.write(buf, sizeof(buf));
+  telemetryUdp.endPacket();
+}
+
+// ----------------------------
+// Alarmă cooperativă între plăci (peer_sync.h, UDP multicast în LAN)
+// ----------------------------
+// Armarea / dezarmarea întregii plăci (buton, UART, MQTT) și orice intrare în
+// ALARMING se publică pe grupul PEER_GROUP; plăcile cu același PEER_SITE_ID
+// le aplică prin aceeași alarmDispatchAll(). Un incident de pe altă placă
+// intră ca MOTION_INSTANT (singurul drum spre ALARMING în afară de timeout),
+// deci contorul, sirena și persistența sunt cele obișnuite. peerStep() rulează
+// devreme în loop() (înainte de ping / OTA, care pot bloca), cu recepția
+// înregistrată în urma de intrări ca stare externă din faza NETWORK.
+// Verificare pe host, plăci în procese separate: tools/peer_sync_sim.cpp.
+static PeerSync peerSync;
+static WiFiUDP peerUdp;
+static IPAddress peerGroupIp;
+static bool peerJoined = false;
+static bool peerApplying = false;  // schimbarea vine de la alt nod: nu se republică
+static bool peerEnabled = false;   // PEER_ENABLED și PEER_SITE_KEY setată
+static uint32_t peerSent = 0;
+static uint32_t peerApplied = 0;
+
+static void peerLocalArm(AlarmEvent event) {
+  const PeerArmCmd cmd = peerArmFromEvent(event);
+  if (!peerEnabled || peerApplying || cmd == PeerArmCmd::NONE) return;
+  peerSync.localArm(cmd, millis());
+}
+
+static void peerLocalAlarm() {
+  if (!peerEnabled || peerApplying) return;
+  peerSync.localAlarm(peerTripLevels, millis());
+}
+
+static void peerApplyArm() {
+  const PeerArmCmd cmd = static_cast<PeerArmCmd>(peerSync.arm().value);
+  const uint32_t now = millis();
+  for (uint8_t i = 0; i < ALARM_PARTITION_COUNT; ++i) {
+    if (peerArmNeedsDisarm(sys.partitions[i], cmd)) alarmDispatch(i, AlarmEvent::DISARM, now);
+  }
+  alarmDispatchAll(peerArmEvent(cmd));
+  logEvent(Msg::EVT_PEER_ARM, cmd == PeerArmCmd::ARM_AWAY ? "ARM" : cmd == PeerArmCmd::ARM_STAY ? "STAY" : "DISARM", peerSync.arm().origin);
+}
+
+static void peerApplyAlarm() {
+  alarmDispatchAll(AlarmEvent::MOTION_INSTANT);
+  logEvent(Msg::EVT_PEER_ALARM, peerSync.alarm().origin, peerSync.alarm().value);
+}
+
+static void peerReceive(uint32_t now) {
+  uint8_t buf[PEER_PACKET_SIZE + 1];
+  // câteva pachete pe trecere: un vecin care inundă grupul nu ține loop()-ul pe loc
+  for (uint8_t n = 0; n < 8; ++n) {
+    const int size = peerUdp.parsePacket();
+    if (size <= 0) return;
+    const int len = peerUdp.read(buf, sizeof(buf));
+    const uint8_t changed = peerSync.receive(buf, len > 0 ? static_cast<size_t>(len) : 0, now);
+    if (changed == 0) continue;
+
+    // ambele registre noi (pachete pierdute): întâi cel mai vechi
+    peerApplying = true;
+    const bool armFirst = !peerNewer(peerSync.arm(), peerSync.alarm());
+    if (armFirst && (changed & PEER_RX_ARM)) peerApplyArm();
+    if (changed & PEER_RX_ALARM) peerApplyAlarm();
+    if (!armFirst && (changed & PEER_RX_ARM)) peerApplyArm();
+    peerApplying = false;
+    ++peerApplied;
+  }
+}
+
+// Cheia de zero = neconfigurată: nu se trimite și nu se acceptă nimic.
+static void peerBegin() {
+  uint8_t any = 0;
+  for (uint8_t b : PEER_SITE_KEY) any |= b;
+  peerEnabled = PEER_ENABLED && any != 0;
+  peerSync.begin(ESP.getChipId(), PEER_SITE_ID, PEER_SITE_KEY);
+}
+
+static void peerStep() {
+  if (!peerEnabled) return;
+  if (!isWifiConnected()) {
+    peerJoined = false;  // grupul se reface la reconectare (IP nou, alt AP)
+    return;
+  }
+  if (!peerJoined) {
+    if (!peerGroupIp.fromString(PEER_GROUP) || !peerUdp.beginMulticast(WiFi.localIP(), peerGroupIp, PEER_PORT)) return;
+    peerJoined = true;
+  }
+
+  const uint32_t now = millis();
+  peerReceive(now);
+
+  // schimbările de până acum (inclusiv din faza ALARM a acestei treceri) pleacă imediat
+  uint8_t buf[PEER_PACKET_SIZE];
+  while (peerSync.dueSend(now)) {
+    peerSync.encode(buf, now);
+    if (!peerUdp.beginPacketMulticast(peerGroupIp, PEER_PORT, WiFi.localIP())) return;
+    peerUdp.write(buf, sizeof(buf));
+    if (peerUdp.endPacket()) ++peerSent;
+  }
+}
+
+static void printPeerStatus() {
+  console.print(F("Peers: "));
+  if (!peerEnabled) {
+    console.println(PEER_ENABLED ? F("OFF (PEER_SITE_KEY not set)") : F("OFF"));
+    return;
+  }
+  const uint32_t now = millis();
+  console.print(PEER_GROUP);
+  console.print(F(":"));
+  console.print(PEER_PORT);
+  console.print(F(" site "));
+  console.print(PEER_SITE_ID);
+  console.print(peerJoined ? F(" joined, ") : F(" not joined, "));
+  console.print(peerSync.onlineCount(now));
+  console.print(F("/"));
+  console.print(peerSync.peerCount());
+  console.print(F(" online, sent "));
+  console.print(peerSent);
+  console.print(F(", applied "));
+  console.print(peerApplied);
+  console.print(F(", bad/unauthenticated "));
+  console.println(peerSync.rejected());
+  for (uint8_t i = 0; i < peerSync.peerCount(); ++i) {
+    const PeerInfo& p = peerSync.peer(i);
+    console.print(F("  0x"));
+    console.print(p.boardId, HEX);
+    console.print(F(" seen "));
+    console.print((now - p.lastSeenMs) / 1000);
+    console.print(F(" s ago, rx "));
+    console.print(p.received);
+    console.print(F(", lost "));
+    console.println(p.lost);
+  }
+}
+
+// ----------------------------
+// Injecție de defecte (fault_inject.h)
+// ----------------------------
+// Hook-urile stau la granița I/O: rezultatul ping-ului (Google și probele
+// power watchdog-ului), rezolvarea DNS, conexiunea HTTPS, nivelurile PIR. De
+// acolo încolo defectul e o intrare ca oricare alta (inclusiv în urma de
+// intrări). Saltul de ceas și presiunea pe heap se aplică în faza LATE, după
+// pasul urmărit. O rulare începe la primul FAULT armat și se termină când
+// expiră toate (sau la FAULT CLEAR), cu rezumatul a ce au făcut releul, power
+// watchdog-ul și alarma între timp.
+static FaultInjector faults;
+static void* faultHeapBlock = nullptr;
+
+struct FaultRun {
+  bool active;
+  uint32_t startMs;
+  uint32_t pingFailures;
+  uint32_t internetDown;
+  uint32_t relayActivationsAtStart;
+  uint32_t powerCyclesAtStart;
+  uint32_t alarmTriggersAtStart;
+  uint32_t httpsFailuresAtStart;
+  uint32_t minFreeHeap;
+};
+
+static FaultRun faultRun = {};
+
+static bool faultRoll(Fault f) {
+  return FAULT_INJECTION_ENABLED && faults.anyActive() && faults.roll(f);
+}
+
+static int32_t faultAmount(Fault f) {
+  return (FAULT_INJECTION_ENABLED && faults.anyActive()) ? faults.amount(f) : 0;
+}
+
+static void faultNotePing(bool ok, uint8_t decision) {
+  if (!FAULT_INJECTION_ENABLED || !faultRun.active) return;
+  if (!ok) ++faultRun.pingFailures;
+  if (decision & RELAY_DECISION_PING_DOWN) ++faultRun.internetDown;
+}
+
+static bool resolveHost(const char* host, IPAddress& ip) {
+  if (ip.fromString(host)) return true;
+  if (faultRoll(Fault::DNS_FAIL)) return false;
+  return WiFi.hostByName(host, ip) == 1;
+}
+
+static bool pingHost(const IPAddress& ip) {
+  const bool ok = Ping.ping(ip, 1);
+  return ok && !faultRoll(Fault::PING_LOSS);
+}
+
+static uint32_t powerCyclesTotal() {
+  uint32_t total = 0;
+  for (uint8_t d = 0; d < powerWatchdog.deviceCount(); ++d) total += powerWatchdog.cycles(d);
+  return total;
+}
+
+static void faultStartRun() {
+  faults.resetCounters();
+  faultRun = {};
+  faultRun.active = true;
+  faultRun.startMs = millis();
+  faultRun.relayActivationsAtStart = sys.relay.activationCount;
+  faultRun.powerCyclesAtStart = powerCyclesTotal();
+  faultRun.alarmTriggersAtStart = sys.alarmTriggerCount;
+  faultRun.httpsFailuresAtStart = httpsStats.failures;
+  faultRun.minFreeHeap = ESP.getFreeHeap();
+}
+
+static void printFaultRunSummary() {
+  console.print(F("Fault run: "));
+  console.print((millis() - faultRun.startMs) / 1000);
+  console.print(F(" s;"));
+  for (uint8_t f = 0; f < FAULT_COUNT; ++f) {
+    const Fault id = static_cast<Fault>(f);
+    if (faults.rolls(id) == 0) continue;
+    console.print(F(" "));
+    console.print(FAULT_INFO[f].name);
+    console.print(F(" "));
+    console.print(faults.hits(id));
+    console.print(F("/"));
+    console.print(faults.rolls(id));
+  }
+  console.println();
+  console.print(F("  pings failed "));
+  console.print(faultRun.pingFailures);
+  console.print(F(", internet_DOWN "));
+  console.print(faultRun.internetDown);
+  console.print(F(", relay activations +"));
+  console.print(sys.relay.activationCount - faultRun.relayActivationsAtStart);
+  console.print(F(", power cycles +"));
+  console.print(powerCyclesTotal() - faultRun.powerCyclesAtStart);
+  console.print(F(", alarm triggers +"));
+  console.print(sys.alarmTriggerCount - faultRun.alarmTriggersAtStart);
+  console.print(F(", HTTPS failures +"));
+  console.print(httpsStats.failures - faultRun.httpsFailuresAtStart);
+  console.print(F(", min free heap "));
+  console.print(faultRun.minFreeHeap);
+  console.print(F(" B; now: ping down "));
+  console.print(sys.relay.pingDownActive ? F("YES") : F("NO"));
+  console.print(F(", relay "));
+  console.println(sys.relay.cutActive ? F("ON") : F("OFF"));
+}
+
+static void faultEndRun() {
+  faults.clearAll();
+  free(faultHeapBlock);
+  faultHeapBlock = nullptr;
+  if (!faultRun.active) return;
+  faultRun.active = false;
+  logEvent(Msg::EVT_FAULT_RUN_END, (millis() - faultRun.startMs) / 1000);
+  printFaultRunSummary();
+}
+
+static void faultStep(uint32_t now) {
+  if (!FAULT_INJECTION_ENABLED || !faultRun.active) return;
+
+  if (faults.takePending(Fault::CLOCK_JUMP)) {
+    timeval tv = { time(nullptr) + faults.amount(Fault::CLOCK_JUMP), 0 };
+    settimeofday(&tv, nullptr);
+    faults.clear(Fault::CLOCK_JUMP);
+  }
+  if (faults.takePending(Fault::HEAP_PRESSURE)) {
+    free(faultHeapBlock);
+    // fără bloc contiguu de mărimea cerută rămâne nealocat (contorul arată 0 aplicări)
+    faultHeapBlock = malloc(static_cast<size_t>(faults.value(Fault::HEAP_PRESSURE)));
+    if (faultHeapBlock != nullptr) faults.amount(Fault::HEAP_PRESSURE);
+  }
+  faults.expire(now);
+  if (faultHeapBlock != nullptr && !faults.active(Fault::HEAP_PRESSURE)) {
+    free(faultHeapBlock);
+    faultHeapBlock = nullptr;
+  }
+  faultRun.minFreeHeap = std::min<uint32_t>(faultRun.minFreeHeap, ESP.getFreeHeap());
+  if (!faults.anyActive()) faultEndRun();
+}
+
+// FAULT | FAULT <NUME> <valoare> [sec] | FAULT SEED <n> | FAULT CLEAR
+static void faultCommand(const String& cmd) {
+  if (!FAULT_INJECTION_ENABLED) {
+    msgPrintln(Msg::CMD_FAULT_DISABLED);
+    return;
+  }
+  if (cmd == "FAULT") {
+    printFaultStatus();
+    return;
+  }
+  if (cmd == "FAULT CLEAR") {
+    if (!faultRun.active) printFaultStatus();
+    faultEndRun();
+    return;
+  }
+  if (cmd.startsWith("FAULT SEED ")) {
+    faults.seed(static_cast<uint32_t>(strtoul(cmd.c_str() + 11, nullptr, 10)));
+    printFaultStatus();
+    return;
+  }
+
+  // FAULT <NUME> <valoare> [sec]
+  const char* name = cmd.c_str() + 6;
+  const char* space = strchr(name, ' ');
+  const uint8_t f = space ? faultFromName(name, static_cast<size_t>(space - name)) : FAULT_COUNT;
+  char* end = nullptr;
+  const long value = (f < FAULT_COUNT) ? strtol(space + 1, &end, 10) : 0;
+  const uint32_t seconds = (end != nullptr && *end == ' ') ? static_cast<uint32_t>(strtoul(end + 1, nullptr, 10)) : 0;
+  if (f == FAULT_COUNT || end == space + 1) {
+    msgPrintln(Msg::CMD_FAULT_INVALID);
+    return;
+  }
+  if (!faultRun.active) faultStartRun();
+  if (!faults.arm(static_cast<Fault>(f), static_cast<int32_t>(value), seconds * 1000, millis())) {
+    msgPrintln(Msg::CMD_FAULT_INVALID);
+    if (!faults.anyActive()) faultRun.active = false;
+    return;
+  }
+  logEvent(Msg::EVT_FAULT_ARMED, FAULT_INFO[f].name, static_cast<int>(value), seconds);
+}
+
+static void printFaultStatus() {
+  if (!FAULT_INJECTION_ENABLED) return;
+  console.print(F("Faults:"));
+  if (!faults.anyActive()) console.print(F(" none"));
+  const uint32_t now = millis();
+  for (uint8_t f = 0; f < FAULT_COUNT; ++f) {
+    const Fault id = static_cast<Fault>(f);
+    if (!faults.active(id)) continue;
+    console.print(F(" "));
+    console.print(FAULT_INFO[f].name);
+    console.print(F("="));
+    console.print(faults.value(id));
+    console.print(FAULT_INFO[f].unit);
+    const uint32_t left = faults.remainingMs(id, now);
+    if (left != 0) {
+      console.print(F(" ("));
+      console.print(left / 1000);
+      console.print(F(" s left)"));
+    }
+  }
+  console.println();
+  if (faultRun.active) printFaultRunSummary();
+}
+
+// ----------------------------
+// Syslog la distanță (RFC 5424 pe UDP)
+// ----------------------------
+// Fiecare logEvent() intră în syslogBuffer (syslog_sink.h), indiferent de
+// rețea; de aici pleacă doar când serverul e accesibil: WiFi conectat și,
+// pentru un server din afara LAN-ului, internetul nu e declarat căzut. Astfel
+// evenimentele din timpul penei ajung după revenire, în ordine, cu momentul
+// lor. Mai multe mesaje pe datagramă, datagramele limitate de un token bucket
+// ca golirea după o pană lungă să nu inunde rețeaua. Verificare pe host:
+// tools/syslog_flush_sim.cpp.
+static SyslogBuffer<SYSLOG_BUFFER_RECORDS> syslogBuffer;
+static SyslogRateLimiter syslogRate = { SYSLOG_RATE_PER_SEC, SYSLOG_RATE_BURST, 0, 0, false };
+static WiFiUDP syslogUdp;
+static IPAddress syslogServerIp;
+static bool syslogServerResolved = false;
+static char syslogHostname[16] = "";
+static uint32_t syslogPendingDropped = 0;
+static uint32_t syslogSent = 0;
+static uint32_t syslogDatagrams = 0;
+
+static void syslogEnqueue(const char* message, uint8_t severity) {
+  const time_t now = time(nullptr);
+  syslogBuffer.push(message, severity, millis(), now >= 1700000000 ? static_cast<uint32_t>(now) : 0);
+}
+
+static bool syslogServerReachable() {
+  if (!isWifiConnected()) return false;
+  if (!sys.relay.pingDownActive) return true;
+  const uint32_t mask = static_cast<uint32_t>(WiFi.subnetMask());
+  return (static_cast<uint32_t>(syslogServerIp) & mask) == (static_cast<uint32_t>(WiFi.localIP()) & mask);
+}
+
+static void syslogFlushIfNeeded() {
+  if (SYSLOG_HOST[0] == '\0' || syslogBuffer.size() == 0 || !isWifiConnected()) return;
+
+  if (!syslogServerResolved) {
+    syslogServerResolved = resolveHost(SYSLOG_HOST, syslogServerIp);
+    if (!syslogServerResolved) return;
+  }
+  if (!syslogServerReachable()) return;
+  if (syslogHostname[0] == '\0') snprintf(syslogHostname, sizeof(syslogHostname), "alarma-%08x", ESP.getChipId());
+
+  const uint32_t now = millis();
+  if (!syslogRate.take(now)) return;
+
+  const SyslogIdentity id = { syslogHostname, "alarma_simpla", SYSLOG_FACILITY_LOCAL0 };
+  const time_t epochNow = time(nullptr);
+  syslogPendingDropped += syslogBuffer.takeDropped();
+  char datagram[SYSLOG_DATAGRAM_MAX];
+  uint16_t taken = 0;
+  const size_t len = syslogBuildBatch(syslogBuffer, id, now, epochNow >= 1700000000 ? static_cast<uint32_t>(epochNow) : 0, syslogPendingDropped,
+                                      SYSLOG_BATCH_RECORDS, datagram, sizeof(datagram), &taken);
+  if (len != 0) {
+    // fără endPacket() reușit înregistrările rămân în buffer pentru trecerea următoare
+    if (!syslogUdp.beginPacket(syslogServerIp, SYSLOG_PORT)) return;
+    syslogUdp.write(reinterpret_cast<const uint8_t*>(datagram), len);
+    if (!syslogUdp.endPacket()) return;
+    syslogPendingDropped = 0;
+    ++syslogDatagrams;
+    syslogSent += taken;
+  }
+  syslogBuffer.pop(taken);
+}
+
+static void printSyslogStatus() {
+  console.print(F("Syslog: "));
+  if (SYSLOG_HOST[0] == '\0') {
+    console.println(F("OFF"));
+    return;
+  }
+  console.print(SYSLOG_HOST);
+  console.print(F(":"));
+  console.print(SYSLOG_PORT);
+  console.print(F(" buffered "));
+  console.print(syslogBuffer.size());
+  console.print(F("/"));
+  console.print(syslogBuffer.capacity());
+  console.print(F(" (max "));
+  console.print(syslogBuffer.maxCount());
+  console.print(F(") sent "));
+  console.print(syslogSent);
+  console.print(F(" in "));
+  console.print(syslogDatagrams);
+  console.print(F(" datagrams, dropped "));
+  console.println(syslogBuffer.droppedTotal());
+}
+
+// ----------------------------
+// Consolă TCP (telnet) — oglinda log-ului + aceleași comenzi ca pe UART
+// ----------------------------
+// Toți clienții citesc din consoleRing, fiecare cu cursorul lui; se scrie doar
+// cât acceptă socket-ul acum (availableForWrite), deci un client lent nu
+// blochează loop()-ul. Dacă rămâne în urmă mai mult decât ring-ul, pierde
+// bytes doar el (contorul `dropped`).
+static const uint8_t CONSOLE_MAX_CLIENTS = 3;
+static const size_t CONSOLE_BACKLOG_BYTES = 1024;  // istoric trimis la conectare
+static const size_t CONSOLE_LINE_MAX = 80;
+static const uint32_t CONSOLE_LOGIN_BACKOFF_MS = 5'000;  // după un token greșit, pentru toți clienții
+
+struct ConsoleClient {
+  WiFiClient client;
+  LogCursor cursor;
+  uint32_t reportedDrops;
+  String rxLine;
+  bool active;
+  bool loggedIn;
+};
+
+static WiFiServer consoleServer(CONSOLE_TCP_PORT);
+static ConsoleClient consoleClients[CONSOLE_MAX_CLIENTS];
+static bool consoleServerStarted = false;
+static uint32_t consoleLoginBlockedUntilMs = 0;
+
+static void consoleAccept() {
+  WiFiClient incoming = consoleServer.accept();
+  if (!incoming) return;
+
+  for (uint8_t i = 0; i < CONSOLE_MAX_CLIENTS; ++i) {
+    ConsoleClient& c = consoleClients[i];
+    if (c.active) continue;
+    c.client = incoming;
+    c.client.setNoDelay(true);
+    c.cursor = consoleRing.cursorWithBacklog(CONSOLE_BACKLOG_BYTES);
+    c.reportedDrops = 0;
+    c.rxLine = "";
+    c.rxLine.reserve(CONSOLE_LINE_MAX);  // o singură alocare; += pe caracter nu mai face realloc
+    c.active = true;
+    c.loggedIn = false;
+    statusDelta.requestKeyframe();  // clientul nou reface starea din primul raport
+    logEvent(Msg::EVT_CONSOLE_CONNECTED, i + 1);
+    return;
+  }
+  incoming.println("console busy");
+  incoming.stop();
+}
+
+// Comparație în timp constant (lungimea tokenului nu e secretă).
+static bool consoleTokenMatches(const char* token) {
+  const size_t n = strlen(CONSOLE_TOKEN);
+  if (strlen(token) != n) return false;
+  uint8_t diff = 0;
+  for (size_t k = 0; k < n; ++k) diff |= static_cast<uint8_t>(token[k] ^ CONSOLE_TOKEN[k]);
+  return diff == 0;
+}
+
+// Tokenul nu ajunge în log, în urmă sau în ecoul comenzii. Un token greșit
+// închide conexiunea și blochează LOGIN pe toți clienții CONSOLE_LOGIN_BACKOFF_MS.
+static void consoleLogin(uint8_t i, String token) {
+  ConsoleClient& c = consoleClients[i];
+  token.trim();
+  if (CONSOLE_TOKEN[0] == '\0') {
+    msgPrintln(Msg::CMD_LOGIN_DISABLED);
+    console.println();
+    return;
+  }
+  const uint32_t now = millis();
+  const bool blocked = consoleLoginBlockedUntilMs != 0 && (int32_t)(now - consoleLoginBlockedUntilMs) < 0;
+  if (blocked || !consoleTokenMatches(token.c_str())) {
+    consoleLoginBlockedUntilMs = now + CONSOLE_LOGIN_BACKOFF_MS;
+    c.client.println("login failed");
+    c.client.stop();
+    c.active = false;
+    logEvent(Msg::EVT_CONSOLE_LOGIN_FAILED, i + 1);
+    return;
+  }
+  c.loggedIn = true;
+  msgPrintln(Msg::CMD_LOGIN_OK);
+  console.println();
+  logEvent(Msg::EVT_CONSOLE_LOGIN, i + 1);
+}
+
+static void consoleServeClient(uint8_t i) {
+  ConsoleClient& c = consoleClients[i];
+  if (!c.client.connected()) {
+    c.client.stop();
+    c.active = false;
+    logEvent(Msg::EVT_CONSOLE_DISCONNECTED, i + 1);
+    return;
+  }
+
+  while (c.client.available() > 0) {
+    const char ch = static_cast<char>(c.client.read());
+    if (ch == '\r') continue;
+    if (ch == '\n') {
+      String line = c.rxLine;
+      c.rxLine = "";
+      line.trim();
+      String head = line.substring(0, 5);
+      head.toUpperCase();
+      if (head == "LOGIN") {
+        consoleLogin(i, line.substring(5));
+      } else {
+        processSerialCommand(line, c.loggedIn ? CmdSource::CONSOLE_LOGGED_IN : CmdSource::CONSOLE);
+      }
+      if (!c.active) return;
+      continue;
+    }
+    if (c.rxLine.length() < CONSOLE_LINE_MAX) {
+      c.rxLine += ch;
+    }
+  }
+
+  consoleRing.catchUp(c.cursor);
+  size_t room = static_cast<size_t>(c.client.availableForWrite());
+  if (c.cursor.dropped != c.reportedDrops && room >= 48) {
+    char note[48];
+    const int n = snprintf(note, sizeof(note), "\r\n[console: %lu bytes dropped]\r\n", static_cast<unsigned long>(c.cursor.dropped - c.reportedDrops));
+    room -= c.client.write(reinterpret_cast<const uint8_t*>(note), static_cast<size_t>(n));
+    c.reportedDrops = c.cursor.dropped;
+  }
+  while (room > 0) {
+    const uint8_t* data = nullptr;
+    size_t n = consoleRing.peek(c.cursor, &data);
+    if (n == 0) break;
+    if (n > room) n = room;
+    const size_t written = c.client.write(data, n);
+    c.cursor.pos += static_cast<uint32_t>(written);
+    room -= written;
+    if (written < n) break;
+  }
+}
+
+static void consoleUpdate() {
+  if (!isRealWifiConnected()) return;
+  if (!consoleServerStarted) {
+    consoleServer.begin();
+    consoleServer.setNoDelay(true);
+    consoleServerStarted = true;
+  }
+
+  consoleAccept();
+  for (uint8_t i = 0; i < CONSOLE_MAX_CLIENTS; ++i) {
+    if (consoleClients[i].active) consoleServeClient(i);
+  }
+}
+
+static void printConsoleStatus() {
+  uint8_t active = 0;
+  uint32_t dropped = 0;
+  for (uint8_t i = 0; i < CONSOLE_MAX_CLIENTS; ++i) {
+    if (!consoleClients[i].active) continue;
+    ++active;
+    dropped += consoleClients[i].cursor.dropped;
+  }
+  console.print(F("Console TCP: port "));
+  console.print(CONSOLE_TCP_PORT);
+  console.print(F(", clients "));
+  console.print(active);
+  console.print(F("/"));
+  console.print(CONSOLE_MAX_CLIENTS);
+  console.print(F(", dropped "));
+  console.println(dropped);
+}
+
+static void putConsoleStatus(StatusDeltaEncoder& e) {
+  uint8_t active = 0;
+  uint32_t dropped = 0;
+  for (uint8_t i = 0; i < CONSOLE_MAX_CLIENTS; ++i) {
+    if (!consoleClients[i].active) continue;
+    ++active;
+    dropped += consoleClients[i].cursor.dropped;
+  }
+  e.put(StatusField::CONSOLE_CLIENTS, active);
+  e.put(StatusField::CONSOLE_DROPPED, dropped);
+}
+
+// ----------------------------
+// Urmă de intrări (record continuu în RAM, flush în flash la anomalii)
+// ----------------------------
+// Format și ordinea pașilor: include/input_trace.h. Replay pe PC cu
+// tools/trace_replay.cpp, care rulează același relay_scheduler.h/alarm_fsm.h.
+static const size_t TRACE_HALF_BYTES = 2048;
+static const char* TRACE_FILE_PATH = "/trace.bin";
+static const uint32_t TRACE_FLUSH_MIN_INTERVAL_MS = 10UL * 60UL * 1000UL;  // anomaliile repetate nu uzează flash-ul
+static const uint32_t TRACE_RELAY_BURST_WINDOW_MS = 30UL * 60UL * 1000UL;
+static const uint8_t TRACE_RELAY_BURST_COUNT = 4;  // atâtea power-cycle-uri în fereastră = anomalie
+static const size_t TRACE_HEX_BYTES_PER_LINE = 32;
+
+static InputTraceRecorder<TRACE_HALF_BYTES> traceRecorder;
+static TracedState traceScratch = {};
+static bool traceStepActive = false;  // deciziile se înregistrează doar din pașii refăcuți de replay
+static bool traceFlushPending = false;
+static bool traceFlushForced = false;
+static const char* traceFlushReason = "-";
+static uint32_t traceLastFlushMs = 0;
+static uint32_t traceFlushCount = 0;
+static bool traceFsMounted = false;
+static uint32_t traceRelayActivationMs[TRACE_RELAY_BURST_COUNT] = {};
+static uint8_t traceRelayActivationNext = 0;
+static uint32_t tracePassCycles = 0;  // costul recorder-ului în trecerea curentă
+static uint32_t traceMaxCycles = 0;
+static uint32_t traceTotalCycles = 0;
+static uint32_t tracePasses = 0;
+
+// Adună costul funcțiilor recorder-ului din trecerea curentă. CCOUNT se citește
+// într-o instrucțiune; micros() ar costa mai mult decât ce măsoară.
+struct TraceCost {
+  uint32_t start = ESP.getCycleCount();
+  ~TraceCost() { tracePassCycles += ESP.getCycleCount() - start; }
+};
+
+static uint8_t sampleInputLevels() {
+  uint8_t levels = 0;
+  for (uint8_t i = 0; i < 4; ++i) {
+    if (digitalRead(PIN_PIR[i]) == HIGH) levels |= static_cast<uint8_t>(1u << i);
+  }
+  if (faultRoll(Fault::PIR_NOISE)) levels |= static_cast<uint8_t>(1u << faults.randomBelow(4));
+  if (isWifiConnected()) levels |= TRACE_LEVEL_WIFI;
+  return levels;
+}
+
+static const TracedState& traceCapture() {
+  memcpy(&traceScratch.relay, &sys.relay, sizeof(sys.relay));
+  memcpy(traceScratch.partitions, sys.partitions, sizeof(sys.partitions));
+  memcpy(traceScratch.lastMotionMs, sys.lastMotionMs, sizeof(sys.lastMotionMs));
+  traceScratch.alarmTriggerCount = sys.alarmTriggerCount;
+  traceScratch.zoneBypass = sys.zoneBypass;
+  return traceScratch;
+}
+
+static void traceBegin() {
+  TraceConfig config = {};
+  config.partitionCount = ALARM_PARTITION_COUNT;
+  for (uint8_t i = 0; i < TRACE_ZONES; ++i) config.zones[i] = ALARM_ZONES[i];
+  config.timings = ALARM_TIMINGS;
+  traceRecorder.begin(config);
+}
+
+static void traceRequestFlush(const char* reason, bool force) {
+  if (traceFlushPending && !force) return;
+  traceFlushPending = true;
+  traceFlushForced = traceFlushForced || force;
+  traceFlushReason = reason;
+}
+
+static void traceAlarmDecision(uint8_t p, AlarmState s) {
+  if (traceStepActive) {
+    TraceCost cost;
+    traceRecorder.decision(TRACE_DECISION_ALARM, static_cast<uint8_t>((p << 4) | static_cast<uint8_t>(s)));
+  }
+  if (s == AlarmState::ALARMING) traceRequestFlush("alarm", false);
+}
+
+static void traceRelayDecision(uint8_t decision, uint32_t now) {
+  if (traceStepActive) {
+    TraceCost cost;
+    traceRecorder.decision(TRACE_DECISION_RELAY, decision);
+  }
+  if (!(decision & RELAY_DECISION_ACTIVATED)) return;
+  // cea mai veche din ultimele N activări încă în fereastră => power-cycle în buclă
+  const uint32_t oldest = traceRelayActivationMs[traceRelayActivationNext];
+  traceRelayActivationMs[traceRelayActivationNext] = now;
+  traceRelayActivationNext = (traceRelayActivationNext + 1) % TRACE_RELAY_BURST_COUNT;
+  if (oldest != 0 && now - oldest < TRACE_RELAY_BURST_WINDOW_MS) traceRequestFlush("relay_burst", false);
+}
+
+static void tracePingResult(bool ok, uint32_t now) {
+  if (!traceStepActive) return;
+  TraceCost cost;
+  traceRecorder.ping(ok, now);
+}
+
+static void traceCommand(const String& cmd) {
+  TraceCost cost;
+  traceRecorder.command(cmd.c_str(), cmd.length());
+}
+
+static void traceBeginPass(uint32_t now, uint8_t levels) {
+  tracePassCycles = 0;
+  TraceCost cost;
+  traceRecorder.beginPass(now, levels, traceCapture());
+  traceStepActive = true;
+}
+
+static void traceStepDone() {
+  TraceCost cost;
+  traceStepActive = false;
+  traceRecorder.stepDone(traceCapture());
+}
+
+static void traceStepStart() {
+  traceStepActive = true;
+}
+
+static void traceExternal(TracePhase phase) {
+  TraceCost cost;
+  traceRecorder.external(phase, traceCapture());
+}
+
+static bool traceMountFs() {
+  if (!traceFsMounted) traceFsMounted = LittleFS.begin();
+  return traceFsMounted;
+}
+
+static void traceFlushIfPending(uint32_t now) {
+  if (!traceFlushPending) return;
+  if (!traceFlushForced && traceFlushCount != 0 && now - traceLastFlushMs < TRACE_FLUSH_MIN_INTERVAL_MS) return;
+  traceFlushPending = false;
+  traceFlushForced = false;
+  traceLastFlushMs = now;
+
+  File f = traceMountFs() ? LittleFS.open(TRACE_FILE_PATH, "w") : File();
+  if (!f) {
+    logEvent(Msg::EVT_TRACE_FLUSH_FAILED);
+    return;
+  }
+  uint8_t header[TRACE_FILE_HEADER_BYTES];
+  traceRecorder.header(header);
+  f.write(header, sizeof(header));
+  for (uint8_t i = 0; i < 2; ++i) {
+    const uint8_t* data = nullptr;
+    const size_t n = traceRecorder.span(i, &data);
+    f.write(data, n);
+  }
+  f.close();
+  ++traceFlushCount;
+  logEvent(Msg::EVT_TRACE_SAVED, traceFlushReason);
+}
+
+static void traceEndPass(uint32_t now) {
+  {
+    TraceCost cost;
+    traceRecorder.endPass();
+  }
+  traceMaxCycles = std::max<uint32_t>(traceMaxCycles, tracePassCycles);
+  traceTotalCycles += tracePassCycles;
+  if (++tracePasses == 0x1000) {
+    // media rămâne pe o fereastră recentă, fără overflow
+    traceTotalCycles /= 2;
+    tracePasses /= 2;
+  }
+  traceFlushIfPending(now);
+}
+
+static void tracePrintHexLines(const uint8_t* data, size_t len) {
+  static const char HEX_DIGITS[] = "0123456789abcdef";
+  char line[TRACE_HEX_BYTES_PER_LINE * 2 + 1];
+  while (len > 0) {
+    const size_t n = len < TRACE_HEX_BYTES_PER_LINE ? len : TRACE_HEX_BYTES_PER_LINE;
+    for (size_t i = 0; i < n; ++i) {
+      line[2 * i] = HEX_DIGITS[data[i] >> 4];
+      line[2 * i + 1] = HEX_DIGITS[data[i] & 0x0F];
+    }
+    line[2 * n] = '\0';
+    console.println(line);
+    data += n;
+    len -= n;
+  }
+}
+
+// Dump hex între TRACE BEGIN/END; trace_replay acceptă direct captura.
+static void traceDumpRam() {
+  uint8_t header[TRACE_FILE_HEADER_BYTES];
+  traceRecorder.header(header);
+  console.print(F("TRACE BEGIN "));
+  console.println(static_cast<uint32_t>(sizeof(header) + traceRecorder.bytesUsed()));
+  tracePrintHexLines(header, sizeof(header));
+  for (uint8_t i = 0; i < 2; ++i) {
+    const uint8_t* data = nullptr;
+    const size_t n = traceRecorder.span(i, &data);
+    tracePrintHexLines(data, n);
+  }
+  console.println(F("TRACE END"));
+}
+
+static void traceDumpSaved() {
+  File f = traceMountFs() ? LittleFS.open(TRACE_FILE_PATH, "r") : File();
+  if (!f) {
+    console.println(F("TRACE: no saved trace"));
+    return;
+  }
+  console.print(F("TRACE BEGIN "));
+  console.println(static_cast<uint32_t>(f.size()));
+  uint8_t chunk[TRACE_HEX_BYTES_PER_LINE];
+  size_t n;
+  while ((n = f.read(chunk, sizeof(chunk))) > 0) {
+    tracePrintHexLines(chunk, n);
+  }
+  f.close();
+  console.println(F("TRACE END"));
+}
+
+static void printTraceStatus() {
+  console.print(F("Input trace: "));
+  console.print(static_cast<uint32_t>(traceRecorder.bytesUsed()));
+  console.print(F("/"));
+  console.print(static_cast<uint32_t>(2 * TRACE_HALF_BYTES));
+  const float cyclesPerUs = ESP.getCpuFreqMHz();
+  console.print(F(" B, recorder avg "));
+  console.print(tracePasses ? static_cast<float>(traceTotalCycles) / tracePasses / cyclesPerUs : 0.0f, 2);
+  console.print(F(" us/loop, max "));
+  console.print(traceMaxCycles / cyclesPerUs, 1);
+  console.print(F(" us, saved "));
+  console.print(traceFlushCount);
+  console.print(F(" ("));
+  console.print(traceFlushReason);
+  console.println(F(")"));
+}
+
+static void putTraceStatus(StatusDeltaEncoder& e) {
+  e.put(StatusField::TRACE_BYTES, static_cast<uint32_t>(traceRecorder.bytesUsed()));
+  e.put(StatusField::TRACE_SAVED, traceFlushCount);
+}
+
+// ----------------------------
+// Serie de timp (TSDB): RSSI, RTT, heap, releu — un eșantion pe minut, în flash
+// ----------------------------
+// Eșantioanele stau în RAM cât un bloc (o oră), apoi blocul se codează pe
+// coloane (tsdb.h) și se adaugă la segmentul curent din LittleFS. 8 segmente
+// de 32 KB țin peste 30 de zile (tools/tsdb_bench.cpp). `TSDB <ore>` și
+// `TSDB <de_la> <până_la>` trimit intervalul pe consolă ca CSV, câte un bloc
+// decodat pe trecere prin loop(), ca interogările lungi să nu blocheze alarma.
+static const uint8_t TSDB_HEADERS_PER_STEP = 32;  // blocuri sărite (doar antet) per trecere
+
+struct TsdbSegmentInfo {
+  uint32_t firstEpoch;
+  uint32_t lastEpoch;
+  uint32_t bytes;
+  uint16_t blocks;
+  uint16_t samples;
+};
+
+struct TsdbQuery {
+  bool active;
+  uint32_t from;
+  uint32_t to;
+  uint8_t order[TSDB_SEGMENT_COUNT];  // segmentele, de la cel mai vechi
+  uint8_t orderCount;
+  uint8_t orderPos;
+  uint32_t filePos;
+  uint32_t rows;
+  uint32_t blocksRead;
+  uint32_t blocksSkipped;
+  uint32_t startMs;
+};
+
+static TsdbSegmentInfo tsdbSegments[TSDB_SEGMENT_COUNT];
+static uint8_t tsdbCurrentSegment = 0;
+static bool tsdbReady = false;
+static TsdbSample tsdbPending[TSDB_BLOCK_SAMPLES];
+static uint8_t tsdbPendingCount = 0;
+static uint8_t tsdbBlock[TSDB_BLOCK_MAX_BYTES];  // codare la flush, citire la interogare
+static uint32_t tsdbLastMinute = 0;
+static uint32_t tsdbLastActivationCount = 0;
+static uint32_t tsdbFlushFailures = 0;
+static TsdbQuery tsdbQuery = {};
+
+static void tsdbSegmentPath(uint8_t i, char* out, size_t outSize) {
+  snprintf(out, outSize, "/tsdb%u.bin", i);
+}
+
+// Indexul segmentelor se reface la boot din antetele blocurilor; o scriere
+// întreruptă (reset în timpul flush-ului) se taie la ultimul bloc întreg.
+static void tsdbBegin() {
+  tsdbLastActivationCount = sys.relay.activationCount;
+  if (!traceMountFs()) return;
+  uint32_t newest = 0;
+  for (uint8_t i = 0; i < TSDB_SEGMENT_COUNT; ++i) {
+    TsdbSegmentInfo& seg = tsdbSegments[i];
+    seg = {};
+    char path[16];
+    tsdbSegmentPath(i, path, sizeof(path));
+    File f = LittleFS.open(path, "r+");
+    if (!f) continue;
+    const uint32_t size = f.size();
+    TsdbBlockInfo info;
+    uint8_t header[TSDB_BLOCK_HEADER_BYTES];
+    while (seg.bytes + TSDB_BLOCK_HEADER_BYTES <= size && f.seek(seg.bytes) && f.read(header, sizeof(header)) == sizeof(header) &&
+           tsdbParseHeader(header, &info) && seg.bytes + info.totalBytes <= size) {
+      if (seg.blocks == 0) seg.firstEpoch = info.firstEpoch;
+      seg.lastEpoch = info.lastEpoch;
+      seg.bytes += info.totalBytes;
+      ++seg.blocks;
+      seg.samples += info.count;
+    }
+    if (seg.bytes != size) f.truncate(seg.bytes);
+    f.close();
+    if (seg.blocks != 0 && seg.lastEpoch >= newest) {
+      newest = seg.lastEpoch;
+      tsdbCurrentSegment = i;
+    }
+  }
+  tsdbReady = true;
+}
+
+// Întoarce câte eșantioane au ajuns în flash (0 dacă nu era nimic sau scrierea a eșuat).
+static uint8_t tsdbFlush() {
+  if (tsdbPendingCount == 0) return 0;
+  const size_t n = tsdbEncodeBlock(tsdbPending, tsdbPendingCount, tsdbBlock, sizeof(tsdbBlock));
+  const uint8_t count = tsdbPendingCount;
+  const uint32_t firstEpoch = tsdbPending[0].epoch;
+  const uint32_t lastEpoch = tsdbPending[count - 1].epoch;
+  tsdbPendingCount = 0;
+  if (n == 0 || !tsdbReady) {
+    ++tsdbFlushFailures;
+    return 0;
+  }
+
+  char path[16];
+  if (tsdbSegments[tsdbCurrentSegment].bytes + n > TSDB_SEGMENT_BYTES) {
+    // segmentul următor (cel mai vechi) se rescrie de la zero
+    tsdbCurrentSegment = (tsdbCurrentSegment + 1) % TSDB_SEGMENT_COUNT;
+    tsdbSegmentPath(tsdbCurrentSegment, path, sizeof(path));
+    LittleFS.remove(path);
+    tsdbSegments[tsdbCurrentSegment] = {};
+  }
+  tsdbSegmentPath(tsdbCurrentSegment, path, sizeof(path));
+  File f = LittleFS.open(path, "a");
+  if (!f || f.write(tsdbBlock, n) != n) {
+    if (f) f.truncate(tsdbSegments[tsdbCurrentSegment].bytes);  // fără bloc rupt la coadă
+    ++tsdbFlushFailures;
+    return 0;
+  }
+  f.close();
+  TsdbSegmentInfo& seg = tsdbSegments[tsdbCurrentSegment];
+  if (seg.blocks == 0) seg.firstEpoch = firstEpoch;
+  seg.lastEpoch = lastEpoch;
+  seg.bytes += n;
+  ++seg.blocks;
+  seg.samples += count;
+  return count;
+}
+
+// Un eșantion la fiecare minut întreg (epoch aliniat la minut: delta-of-delta 0).
+static void tsdbSampleIfNeeded() {
+  const time_t nowEpoch = time(nullptr);
+  if (nowEpoch < 1700000000) return;
+  const uint32_t minute = static_cast<uint32_t>(nowEpoch) / 60;
+  if (minute == tsdbLastMinute) return;
+  tsdbLastMinute = minute;
+
+  TsdbSample& s = tsdbPending[tsdbPendingCount++];
+  s.epoch = minute * 60;
+  s.heap = ESP.getFreeHeap();
+  const bool wifiUp = isWifiConnected();
+  s.rssi = wifiUp ? static_cast<int8_t>(std::max<int32_t>(WiFi.RSSI(), -127)) : TSDB_RSSI_NONE;
+  s.rttMs = (!wifiUp || sys.relay.pingDownActive) ? TSDB_RTT_FAIL : sys.lastPingRttMs;
+  const uint32_t activations = sys.relay.activationCount - tsdbLastActivationCount;
+  tsdbLastActivationCount = sys.relay.activationCount;
+  s.relay = static_cast<uint8_t>(std::min<uint32_t>(activations, 0x7F)) | (sys.relay.cutActive ? TSDB_RELAY_ACTIVE : 0);
+  if (tsdbPendingCount == TSDB_BLOCK_SAMPLES) tsdbFlush();
+}
+
+static void tsdbPrintRow(const TsdbSample& s) {
+  char line[64];
+  char rssi[8] = "";
+  char rtt[8] = "";
+  if (s.rssi != TSDB_RSSI_NONE) snprintf(rssi, sizeof(rssi), "%d", s.rssi);
+  if (s.rttMs != TSDB_RTT_FAIL) snprintf(rtt, sizeof(rtt), "%u", s.rttMs);
+  snprintf(line, sizeof(line), "%lu,%s,%s,%lu,%u,%u", static_cast<unsigned long>(s.epoch), rssi, rtt, static_cast<unsigned long>(s.heap),
+           (s.relay & TSDB_RELAY_ACTIVE) ? 1 : 0, s.relay & 0x7F);
+  console.println(line);
+}
+
+static void tsdbStartQuery(uint32_t from, uint32_t to) {
+  TsdbQuery& q = tsdbQuery;
+  q = {};
+  q.active = true;
+  q.from = from;
+  q.to = to;
+  q.startMs = millis();
+  // segmentele nevide, de la cel mai vechi (sortare prin inserție, 8 elemente)
+  for (uint8_t i = 0; i < TSDB_SEGMENT_COUNT; ++i) {
+    if (tsdbSegments[i].blocks == 0) continue;
+    uint8_t j = q.orderCount++;
+    while (j > 0 && tsdbSegments[q.order[j - 1]].firstEpoch > tsdbSegments[i].firstEpoch) {
+      q.order[j] = q.order[j - 1];
+      --j;
+    }
+    q.order[j] = i;
+  }
+  console.print(F("TSDB BEGIN "));
+  console.print(from);
+  console.print(F(" "));
+  console.println(to);
+  console.println(F("epoch,rssi,rtt_ms,heap,relay_active,relay_activations"));
+}
+
+// Apelat din loop(): cel mult un bloc decodat (și câteva antete sărite) per trecere.
+static void tsdbQueryStep() {
+  TsdbQuery& q = tsdbQuery;
+  if (!q.active) return;
+
+  uint8_t headers = 0;
+  while (q.orderPos < q.orderCount && headers < TSDB_HEADERS_PER_STEP) {
+    const uint8_t segIndex = q.order[q.orderPos];
+    const TsdbSegmentInfo& seg = tsdbSegments[segIndex];
+    if (q.filePos >= seg.bytes || seg.lastEpoch < q.from || seg.firstEpoch > q.to) {
+      ++q.orderPos;
+      q.filePos = 0;
+      continue;
+    }
+    char path[16];
+    tsdbSegmentPath(segIndex, path, sizeof(path));
+    File f = LittleFS.open(path, "r");
+    TsdbBlockInfo info;
+    if (!f || !f.seek(q.filePos) || f.read(tsdbBlock, TSDB_BLOCK_HEADER_BYTES) != TSDB_BLOCK_HEADER_BYTES || !tsdbParseHeader(tsdbBlock, &info)) {
+      ++q.orderPos;
+      q.filePos = 0;
+      continue;
+    }
+    ++headers;
+    q.filePos += info.totalBytes;
+    if (info.lastEpoch < q.from || info.firstEpoch > q.to) {
+      ++q.blocksSkipped;
+      continue;
+    }
+    const size_t rest = info.totalBytes - TSDB_BLOCK_HEADER_BYTES;
+    TsdbBlockReader reader;
+    if (f.read(tsdbBlock + TSDB_BLOCK_HEADER_BYTES, rest) != rest || !reader.open(tsdbBlock, info.totalBytes)) {
+      console.println(F("TSDB: corrupt block skipped"));
+      continue;
+    }
+    ++q.blocksRead;
+    TsdbSample s;
+    while (reader.next(&s)) {
+      if (s.epoch < q.from || s.epoch > q.to) continue;
+      tsdbPrintRow(s);
+      ++q.rows;
+    }
+    return;
+  }
+  if (q.orderPos < q.orderCount) return;
+
+  // ce n-a ajuns încă în flash
+  for (uint8_t i = 0; i < tsdbPendingCount; ++i) {
+    if (tsdbPending[i].epoch < q.from || tsdbPending[i].epoch > q.to) continue;
+    tsdbPrintRow(tsdbPending[i]);
+    ++q.rows;
+  }
+  console.print(F("TSDB END "));
+  console.print(q.rows);
+  console.print(F(" rows, blocks read "));
+  console.print(q.blocksRead);
+  console.print(F(", skipped "));
+  console.print(q.blocksSkipped);
+  console.print(F(", "));
+  console.print(millis() - q.startMs);
+  console.println(F(" ms"));
+  q.active = false;
+}
+
+static void printTsdbStatus() {
+  uint32_t samples = tsdbPendingCount, blocks = 0, bytes = 0, oldest = 0;
+  for (uint8_t i = 0; i < TSDB_SEGMENT_COUNT; ++i) {
+    const TsdbSegmentInfo& seg = tsdbSegments[i];
+    if (seg.blocks == 0) continue;
+    samples += seg.samples;
+    blocks += seg.blocks;
+    bytes += seg.bytes;
+    if (oldest == 0 || seg.firstEpoch < oldest) oldest = seg.firstEpoch;
+  }
+  const uint32_t stored = samples - tsdbPendingCount;
+  console.print(F("TSDB: "));
+  console.print(samples);
+  console.print(F(" samples ("));
+  console.print(tsdbPendingCount);
+  console.print(F(" in RAM), "));
+  console.print(blocks);
+  console.print(F(" blocks, "));
+  console.print(bytes);
+  console.print(F("/"));
+  console.print(TSDB_FLASH_BUDGET_BYTES);
+  console.print(F(" B flash, "));
+  console.print(stored ? static_cast<float>(bytes) / stored : 0.0f, 2);
+  console.print(F(" B/sample, since "));
+  char since[24];
+  formatEpochDateTime(oldest, since, sizeof(since), false);
+  console.print(since);
+  console.print(F(", flush errors "));
+  console.println(tsdbFlushFailures);
+}
+
+void setup() {
+  Serial.begin(115200);
+  Serial.setDebugOutput(true);
+  serialRxLine.reserve(96);
+  // setup() și fiecare trecere prin loop() sunt secțiuni de scriere ale stării;
+  // tickerul supervizorului vede doar stări complete, dintre ele.
+  systemState.beginWrite();
+  systemStateInit(sys);
+  sys.lastAutoStatusMs = millis();
+  msgLangParse(CONSOLE_LANG, &consoleLang);
+  console.println();
+
+  // Fast-restore: pini + starea alarmei înainte de orice output lung pe UART,
+  // astfel încât monitorizarea PIR pornește la primul loop().
+  for (int i = 0; i < 4; ++i) {
+    pinMode(PIN_PIR[i], INPUT);
+  }
+  pinMode(PIN_RELAY1_INTERNET, OUTPUT);
+  pinMode(PIN_RELAY2, OUTPUT);
+  pinMode(PIN_LED, OUTPUT);
+  pinMode(PIN_BUTTON, INPUT_PULLUP);
+  buttonEdges.begin(DEBOUNCE_MS);
+  buttonDecoder.begin(BUTTON_GESTURE_CONFIG, digitalRead(PIN_BUTTON) == LOW, millis());
+  attachInterrupt(digitalPinToInterrupt(PIN_BUTTON), buttonIsr, CHANGE);
+  setOutputs(false, false, false);
+
+  loadCrashContextAtBoot();
+  loadPersistedState();
+  restoreRelayScheduler();
+  powerWatchdogBegin();
+  wifiRoamingBegin();
+  peerBegin();
+  zoneHealth.begin(ZONE_HEALTH_CONFIG);
+  restoreAlarmPartitions();
+  sys.bootToArmedUs = micros();
+  supervisorBegin();
+
+  console.println(F("Alarma simpla starting..."));
+  printBootInfo();
+  printCrashReport();
+  otaBootCheck();
+
+  // Testul releelor și WiFi-ul pornesc acum, dar rulează asincron din loop().
+  startupRelayStartupTest();
+  console.print(F("Relay scheduler holdoff (ms): "));
+  console.print(sys.relay.unlockMs - millis());
+  console.println(relaySchedulerRestored ? " (restored from RTC)" : " (relay OFF)");
+  console.println();
+
+  connectWifi();
+  sys.relay.wifiWasConnected = isWifiConnected();
+  ensureTimeSyncIfNeeded();
+  traceBegin();
+  tsdbBegin();
+  eventBusDispatch();
+  logEvent(Msg::EVT_SETUP_COMPLETE);
+#if 0
+  connectMqtt();
+#endif
+  systemState.endWrite();
+}
+
+void loop() {
+  const uint32_t now = millis();
+  const uint32_t loopStartUs = micros();
+  systemState.beginWrite();
+
+  // PIR + WiFi se citesc o singură dată pe trecere: exact ce vede și replay-ul.
+  const uint8_t levels = sampleInputLevels();
+  traceBeginPass(now, levels);
+
+  setLoopStage(LoopStage::STATUS);
+  updateInternetRelay(now, (levels & TRACE_LEVEL_WIFI) != 0);
+  traceStepDone();
+  printStatusEvery30SecIfNeeded();
+  printWifiOffLiveTelemetryEverySec();
+  setLoopStage(LoopStage::SERIAL_CMD);
+  handleSerialCommands();
+  consoleUpdate();
+  supervisorCheckIn(TASK_SERIAL);
+  setLoopStage(LoopStage::ALARM);
+  updateStartupRelayTest();
+  updateButton();
+  zoneHealthStep(now, levels);
+  traceExternal(TRACE_PHASE_INPUT);
+
+  traceStepStart();
+  updateZones(now, levels);
+  updateAlarmTimers(now);
+  traceStepDone();
+  refreshOutputs(now);
+  supervisorCheckIn(TASK_ALARM);
+
+  // WiFi menținut în viață din loop (non-blocant; raportează și reușita conectării)
+  setLoopStage(LoopStage::WIFI_CONNECT);
+  connectWifi();
+
+  setLoopStage(LoopStage::TIME_SYNC);
+  ensureTimeSyncIfNeeded();
+  peerStep();
+  traceExternal(TRACE_PHASE_NETWORK);
+  traceStepStart();
+  pingGoogleIfNeeded();
+  traceStepDone();
+  powerWatchdogStep(now);
+  faultStep(now);
+  otaUpdate();
+  otaHealthCheck();
+  tsdbSampleIfNeeded();
+  tsdbQueryStep();
+  eventBusDispatch();
+  sendTelemetryIfNeeded();
+  syslogFlushIfNeeded();
+  httpsCloseIfIdle();
+  traceExternal(TRACE_PHASE_LATE);
+  traceEndPass(now);
+  supervisorCheckIn(TASK_NETWORK);
+  setLoopStage(LoopStage::IDLE);
+
+  systemState.endWrite();
+
+  if (otaActive()) {
+    otaMaxLoopStallUs = std::max<uint32_t>(otaMaxLoopStallUs, micros() - loopStartUs);
+  }
 }
 
 
@@ -0,0 +1,318 @@
+// arena_soak.cpp — soak pentru include/op_arena.h: cel mai mare bloc liber din heap, cu și fără arenă
+//
+// Build:
+//   g++ -O2 -std=c++17 -I../include arena_soak.cpp -o arena_soak
+//
+// Utilizare:
+//   ./arena_soak [cicluri] [seed]      (implicit 1000000 cicluri, seed 1)
+//
+// Heap-ul e un model al umm_malloc de pe ESP8266: 40 KB, blocuri de 8 B, antet
+// de 4 B, first-fit, fără mutarea blocurilor, vecinii liberi se unesc. Un
+// ciclu = o sincronizare a timpului, în două variante, pe același fundal:
+//   - ca înainte de arenă: HTTPClient + WiFiClient + tabloul de header-e,
+//     cererea construită cu String +=, fiecare linie de răspuns citită într-un
+//     String care crește prin realloc, String-ul Date păstrat până la final;
+//   - cu arena: cererea, linia de header și Date din OpArena, exact bufferele
+//     din main.cpp; în heap rămân doar alocările stivei de rețea.
+// Fundalul (identic în ambele, același seed): pbuf-uri de recepție cât
+// operația citește, alocări lwIP / String-uri de consolă cu durate de la un
+// ciclu la mii, unele făcute chiar în timpul operației, între temporare.
+// Raportează media celui mai mare bloc liber pe ferestre de 10% din rulare,
+// operațiile pe heap pe ciclu și high-water-ul arenei.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include "op_arena.h"
+
+static const uint32_t HEAP_BYTES = 40 * 1024;
+static const uint32_t BLOCK = 8;
+static const uint32_t HEADER = 4;
+
+class SimHeap {
+ public:
+  SimHeap() { free_[0] = HEAP_BYTES; }
+
+  // Întoarce offset-ul sau UINT32_MAX (fără memorie / fragmentat).
+  uint32_t alloc(uint32_t bytes) {
+    const uint32_t need = (bytes + HEADER + BLOCK - 1) / BLOCK * BLOCK;
+    for (auto it = free_.begin(); it != free_.end(); ++it) {
+      if (it->second < need) continue;
+      const uint32_t at = it->first;
+      const uint32_t rest = it->second - need;
+      free_.erase(it);
+      if (rest != 0) free_[at + need] = rest;
+      used_[at] = need;
+      inUse_ += need;
+      ++ops_;
+      return at;
+    }
+    ++failures_;
+    return UINT32_MAX;
+  }
+
+  void release(uint32_t at) {
+    if (at == UINT32_MAX) return;
+    ++ops_;
+    auto u = used_.find(at);
+    uint32_t start = at, len = u->second;
+    inUse_ -= len;
+    used_.erase(u);
+    auto next = free_.lower_bound(at);
+    if (next != free_.end() && next->first == at + len) {
+      len += next->second;
+      next = free_.erase(next);
+    }
+    if (next != free_.begin()) {
+      auto prev = std::prev(next);
+      if (prev->first + prev->second == start) {
+        start = prev->first;
+        len += prev->second;
+        free_.erase(prev);
+      }
+    }
+    free_[start] = len;
+  }
+
+  uint32_t realloc(uint32_t at, uint32_t bytes) {
+    const uint32_t fresh = alloc(bytes);
+    release(at);
+    return fresh;
+  }
+
+  uint32_t maxFreeBlock() const {
+    uint32_t best = 0;
+    for (const auto& f : free_) best = std::max(best, f.second);
+    return best > HEADER ? best - HEADER : 0;
+  }
+  uint32_t freeBytes() const { return HEAP_BYTES - inUse_; }
+  uint32_t failures() const { return failures_; }
+  uint64_t ops() const { return ops_; }
+
+ private:
+  std::map<uint32_t, uint32_t> free_;
+  std::map<uint32_t, uint32_t> used_;
+  uint32_t inUse_ = 0;
+  uint32_t failures_ = 0;
+  uint64_t ops_ = 0;
+};
+
+struct Rng {
+  uint32_t s;
+  uint32_t next() {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+  }
+  uint32_t below(uint32_t n) { return next() % n; }
+};
+
+// Alocările de fundal: eliberate după `ttl` cicluri (0 = permanent).
+struct Live {
+  uint32_t at;
+  uint32_t expires;
+};
+
+// Ca în main.cpp
+enum : uint8_t { NET_OP_HTTPS_TIME, NET_OP_OTA_SHA, NET_OP_HTTPS_PROBE, NET_OP_COUNT };
+static const size_t NET_ARENA_BYTES = 1024;
+static const size_t HTTPS_REQUEST_BYTES = 192;
+static const size_t HTTPS_LINE_BYTES = 96;
+static const size_t HTTPS_DATE_BYTES = 40;
+static const uint32_t HEADER_LINES = 10;
+
+struct Result {
+  std::vector<uint32_t> windowMean;  // media celui mai mare bloc liber pe fiecare fereastră
+  uint32_t finalFree = 0;
+  uint32_t heapFailures = 0;
+  size_t arenaHighWater = 0;
+  uint32_t arenaFailures = 0;
+  double heapOpsPerCycle = 0;
+  double nsPerCycle = 0;
+};
+
+static Result soak(bool useArena, uint32_t cycles, uint32_t seed) {
+  SimHeap heap;
+  Rng rng = { seed };
+  std::vector<Live> background;
+  OpArena<NET_ARENA_BYTES, NET_OP_COUNT> arena;
+  Result r;
+
+  // Ocupare de bază după boot (WiFi, lwIP, BearSSL persistent, obiecte globale).
+  for (int i = 0; i < 40; ++i) heap.alloc(64 + rng.below(400));
+
+  auto backgroundAlloc = [&](uint32_t now) {
+    // pcb/pbuf lwIP, String-uri de consolă, cozi: durate de la un ciclu la sute
+    const uint32_t kind = rng.below(100);
+    uint32_t size, ttl;
+    if (kind < 60) {
+      size = 64 + rng.below(512);
+      ttl = 1 + rng.below(4);
+    } else if (kind < 95) {
+      size = 16 + rng.below(120);
+      ttl = 5 + rng.below(50);
+    } else if (kind < 99) {
+      size = 200 + rng.below(300);
+      ttl = 50 + rng.below(250);
+    } else {
+      size = 16 + rng.below(48);
+      ttl = 1'000 + rng.below(5'000);
+    }
+    background.push_back({ heap.alloc(size), now + ttl });
+  };
+
+  const uint32_t window = std::max<uint32_t>(cycles / 10, 1);
+  uint64_t windowSum = 0;
+  uint32_t windowSamples = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+
+  for (uint32_t c = 0; c < cycles; ++c) {
+    for (size_t i = 0; i < background.size();) {
+      if (background[i].expires == c) {
+        heap.release(background[i].at);
+        background[i] = background.back();
+        background.pop_back();
+      } else {
+        ++i;
+      }
+    }
+    backgroundAlloc(c);
+
+    // Răspunsul: HEADER_LINES linii de header, un pbuf de recepție (al stivei
+    // de rețea, în ambele variante) la fiecare două linii, eliberat după ce e
+    // citit; uneori și o alocare de fundal cât operația e în curs.
+    uint32_t rxPbuf = UINT32_MAX;
+    if (!useArena) {
+      const uint32_t wifiClient = heap.alloc(96);
+      const uint32_t httpHost = heap.alloc(24);
+      const uint32_t httpUri = heap.alloc(24);
+      const uint32_t headerArray = heap.alloc(40);
+      // header-ele cererii: String construit cu += (crește prin realloc)
+      uint32_t request = heap.alloc(32);
+      for (uint32_t size = 64; size <= 192; size *= 2) request = heap.realloc(request, size);
+      uint32_t dateHeader = UINT32_MAX;
+      for (uint32_t i = 0; i < HEADER_LINES; ++i) {
+        if (i % 2 == 0) {
+          heap.release(rxPbuf);
+          rxPbuf = heap.alloc(256 + rng.below(512));
+        }
+        if (rng.below(8) == 0) backgroundAlloc(c);
+        // readStringUntil('\n'): String-ul liniei crește caracter cu caracter
+        uint32_t line = heap.alloc(16);
+        const uint32_t len = 20 + rng.below(70);
+        for (uint32_t size = 32; size < len + 16; size *= 2) line = heap.realloc(line, size);
+        if (i == 3) {
+          dateHeader = heap.alloc(48);  // valoarea colectată, păstrată până la final
+        }
+        heap.release(line);
+      }
+      heap.release(request);
+      heap.release(dateHeader);
+      heap.release(headerArray);
+      heap.release(httpUri);
+      heap.release(httpHost);
+      heap.release(wifiClient);
+    } else {
+      ArenaScope<decltype(arena)> scope(arena, NET_OP_HTTPS_TIME);
+      char* request = arena.allocText(HTTPS_REQUEST_BYTES);
+      char* line = arena.allocText(HTTPS_LINE_BYTES);
+      char* date = arena.allocText(HTTPS_DATE_BYTES);
+      if (request == nullptr || line == nullptr || date == nullptr) ++r.heapFailures;
+      for (uint32_t i = 0; i < HEADER_LINES; ++i) {
+        if (i % 2 == 0) {
+          heap.release(rxPbuf);
+          rxPbuf = heap.alloc(256 + rng.below(512));
+        }
+        if (rng.below(8) == 0) backgroundAlloc(c);
+        rng.below(70);  // aceeași secvență aleatoare ca varianta din heap
+      }
+    }
+    heap.release(rxPbuf);
+
+    if (c % 16 == 0) {
+      windowSum += heap.maxFreeBlock();
+      ++windowSamples;
+    }
+    if ((c + 1) % window == 0) {
+      r.windowMean.push_back(static_cast<uint32_t>(windowSum / windowSamples));
+      windowSum = 0;
+      windowSamples = 0;
+    }
+  }
+
+  r.nsPerCycle = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / cycles;
+  r.heapOpsPerCycle = static_cast<double>(heap.ops()) / cycles;
+  r.finalFree = heap.freeBytes();
+  r.heapFailures += heap.failures();
+  r.arenaHighWater = arena.highWater();
+  r.arenaFailures = arena.failures();
+  return r;
+}
+
+int main(int argc, char** argv) {
+  const uint32_t cycles = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 1'000'000;
+  const uint32_t seed = argc > 2 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 1;
+  bool ok = true;
+  auto check = [&](const char* what, bool pass) {
+    printf("%-60s %s\n", what, pass ? "ok" : "FAILED");
+    ok = ok && pass;
+  };
+
+  // --- arena: eliberare LIFO, statistici pe operație, refuz peste capacitate
+  {
+    OpArena<256, 2> a;
+    check("alloc outside a scope is refused", a.alloc(8) == nullptr && a.failures() == 1);
+    {
+      ArenaScope<OpArena<256, 2>> outer(a, 0);
+      a.allocText(40);
+      {
+        ArenaScope<OpArena<256, 2>> inner(a, 1);
+        check("aligned allocation inside nested scope", (reinterpret_cast<uintptr_t>(a.alloc(10, 8)) & 7) == 0);
+        check("over capacity returns nullptr", a.alloc(300) == nullptr && a.stats(1).failures == 1);
+      }
+      check("inner scope released in O(1) (cursor back to mark)", a.used() == 40);
+    }
+    check("outer scope released, high-water kept", a.used() == 0 && a.highWater() == 50);
+    check("per-op stats: outer counts nested usage", a.stats(0).runs == 1 && a.stats(0).maxBytes == 50 && a.stats(1).maxBytes == 10);
+  }
+
+  // --- soak
+  const Result legacy = soak(false, cycles, seed);
+  const Result arena = soak(true, cycles, seed);
+  auto print = [](const char* name, const Result& r) {
+    printf("%-11s largest free block (mean per 10%% window):", name);
+    for (uint32_t v : r.windowMean) printf(" %5u", v);
+    printf("\n%-11s free %u B, failed allocs %u, %.1f heap ops/cycle, %.0f ns/cycle\n", "", r.finalFree, r.heapFailures, r.heapOpsPerCycle, r.nsPerCycle);
+  };
+  printf("%u sync cycles, seed %u, heap %u B (first-fit, %u B blocks)\n", cycles, seed, HEAP_BYTES, BLOCK);
+  print("heap temps", legacy);
+  print("arena", arena);
+  printf("arena: %zu/%zu B high-water, %u refused\n", arena.arenaHighWater, NET_ARENA_BYTES, arena.arenaFailures);
+
+  if (arena.windowMean.size() >= 3) {
+    // după încălzire (prima fereastră): fiecare fereastră în ±3% din media lor
+    uint64_t sum = 0;
+    for (size_t i = 1; i < arena.windowMean.size(); ++i) sum += arena.windowMean[i];
+    const double mean = static_cast<double>(sum) / (arena.windowMean.size() - 1);
+    double worst = 0;
+    bool larger = true;
+    for (size_t i = 1; i < arena.windowMean.size(); ++i) {
+      worst = std::max(worst, std::abs(arena.windowMean[i] - mean) / mean);
+      larger = larger && arena.windowMean[i] > legacy.windowMean[i];
+    }
+    char what[96];
+    snprintf(what, sizeof(what), "arena: largest free block flat (worst window %.1f%% off)", worst * 100);
+    check(what, worst <= 0.03);
+    check("arena: larger free block than heap temps in every window", larger);
+  }
+  check("no failed allocations with the arena", arena.heapFailures == 0 && arena.arenaFailures == 0);
+  check("arena high-water within NET_ARENA_BYTES", arena.arenaHighWater == HTTPS_REQUEST_BYTES + HTTPS_LINE_BYTES + HTTPS_DATE_BYTES);
+
+  printf("%s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,279 @@
+// button_gesture_sim.cpp — urme de fronturi ale butonului prin include/button_gesture.h, cu loop() blocat artificial
+//
+// Build:
+//   g++ -O2 -std=c++17 -I../include button_gesture_sim.cpp -o button_gesture_sim
+//
+// Utilizare:
+//   ./button_gesture_sim [gesturi=2000] [seed=1]
+//
+// Fiecare urmă e un șir de gesturi (scurte, serii, ținute, coduri fără acțiune)
+// apăsate de „mână” cu timpi aleatori și contacte care vibrează (0–5 fronturi
+// în plus în 10 ms). Fronturile intră în coadă la momentul lor (ISR-ul), iar
+// loop() golește coada la trecerile lui, ca în updateButton(), pe trei profile:
+// fără blocaje, blocaje de ping (1–5 s) și reconectări WiFi (8–12 s). Gesturile
+// decodate (cod + moment) trebuie să fie exact cele din urmă în toate
+// profilele. Pentru comparație rulează și vechiul updateButton() (citire la
+// fiecare trecere, doar apăsarea lungă) pe aceleași treceri. Ceasul pornește
+// aproape de 2^32 ms, deci urma trece prin revenirea la 0 a lui millis().
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "button_gesture.h"
+
+// Ca în main.cpp
+static const ButtonGestureConfig CONFIG = { 40, 2'000, 600 };
+static const uint32_t CLOCK_START_MS = 0xFFFFFFFFu - 120'000;
+
+struct Rng {
+  uint32_t s;
+  uint32_t next() {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+  }
+  uint32_t range(uint32_t lo, uint32_t hi) { return lo + next() % (hi - lo + 1); }
+};
+
+struct Expected {
+  uint8_t shorts;
+  bool longPress;
+  uint32_t atMs;
+};
+
+struct Hold {
+  uint32_t pressMs;
+  uint32_t releaseMs;
+};
+
+struct Trace {
+  std::vector<ButtonEdge> edges;
+  std::vector<Expected> gestures;
+  std::vector<Hold> holds;  // apăsările ținute (orice cod terminat cu '-')
+  uint32_t endMs;
+};
+
+// Un front „curat” la `at`, precedat de vibrații: nivelul sare de câteva ori în ~10 ms.
+static void transition(Trace& t, uint32_t at, bool pressed, Rng& rng) {
+  const uint32_t bounces = rng.range(0, 5);
+  uint32_t when = at - 10;
+  bool level = pressed;
+  for (uint32_t i = 0; i < bounces * 2; ++i) {
+    t.edges.push_back({ when, level });
+    level = !level;
+    when += rng.range(0, 10 / (bounces * 2) + 1);
+  }
+  t.edges.push_back({ at, pressed });
+}
+
+static Trace makeTrace(uint32_t gestures, Rng& rng) {
+  static const struct {
+    uint8_t shorts;
+    bool longPress;
+  } CODES[] = { { 0, true }, { 2, false }, { 3, false }, { 3, true }, { 1, false }, { 5, false }, { 2, true } };
+  Trace t;
+  uint32_t now = CLOCK_START_MS + 1'000;
+  for (uint32_t g = 0; g < gestures; ++g) {
+    const auto& code = CODES[rng.next() % (sizeof(CODES) / sizeof(CODES[0]))];
+    uint32_t releaseMs = 0;
+    for (uint8_t i = 0; i < code.shorts; ++i) {
+      if (i != 0) now = releaseMs + rng.range(120, 450);
+      transition(t, now, true, rng);
+      releaseMs = now + rng.range(70, 450);
+      transition(t, releaseMs, false, rng);
+    }
+    if (code.longPress) {
+      if (code.shorts != 0) now = releaseMs + rng.range(120, 450);
+      transition(t, now, true, rng);
+      t.gestures.push_back({ code.shorts, true, now + CONFIG.longPressMs });
+      const uint32_t pressMs = now;
+      now += CONFIG.longPressMs + rng.range(100, 3'000);
+      transition(t, now, false, rng);
+      t.holds.push_back({ pressMs, now });
+    } else {
+      t.gestures.push_back({ code.shorts, false, releaseMs + CONFIG.multiGapMs });
+      now = releaseMs;
+    }
+    now += CONFIG.multiGapMs + rng.range(300, 5'000);
+  }
+  t.endMs = now + 1'000;
+  return t;
+}
+
+struct StallProfile {
+  const char* name;
+  uint32_t everyMsMin, everyMsMax;  // 0 = fără blocaje
+  uint32_t stallMsMin, stallMsMax;
+  uint32_t stallsForMs;             // 0 = toată urma
+};
+
+struct RunResult {
+  std::vector<Expected> decoded;
+  uint32_t lagMsMax;
+  uint8_t queueMax;
+  uint32_t coalesced;
+  uint32_t dropped;
+  uint32_t passes;
+  // vechiul updateButton(): apăsări ținute găsite (din t.holds) și abaterea
+  // față de apăsare + LONG_PRESS_MS (înainte = a unit-o cu o apăsare scurtă ratată)
+  uint32_t oldLong;
+  uint32_t oldErrMsMax;
+};
+
+// Vechiul updateButton(), pe nivelul citit la fiecare trecere.
+struct PollingButton {
+  bool stable = true, lastRead = true, handled = false;
+  uint32_t lastChangeMs = 0, pressStartMs = 0;
+  bool step(uint32_t now, bool reading) {
+    if (reading != lastRead) {
+      lastRead = reading;
+      lastChangeMs = now;
+    }
+    if ((now - lastChangeMs) > CONFIG.debounceMs && reading != stable) {
+      stable = reading;
+      pressStartMs = stable ? 0 : now;
+      handled = false;
+    }
+    if (!stable && !handled && pressStartMs != 0 && (now - pressStartMs) >= CONFIG.longPressMs) {
+      handled = true;
+      return true;
+    }
+    return false;
+  }
+};
+
+template <uint8_t N>
+static RunResult run(const Trace& t, const StallProfile& profile, Rng rng) {
+  RunResult r = {};
+  ButtonEdgeQueue<N> queue;
+  queue.begin(CONFIG.debounceMs);
+  ButtonGestureDecoder decoder;
+  decoder.begin(CONFIG, false, CLOCK_START_MS);
+  PollingButton old;
+  size_t nextEdge = 0;
+  size_t nextHold = 0;
+  bool level = false;
+  uint32_t now = CLOCK_START_MS;
+  uint32_t nextStallMs = profile.everyMsMin ? now + rng.range(profile.everyMsMin, profile.everyMsMax) : 0;
+
+  while ((int32_t)(now - t.endMs) < 0) {
+    // trecerea ține 5–15 ms; uneori connectWifi()/Ping.ping() blochează loop()
+    uint32_t passMs = rng.range(5, 15);
+    const bool stalling = profile.stallsForMs == 0 || now - CLOCK_START_MS < profile.stallsForMs;
+    if (nextStallMs != 0 && stalling && (int32_t)(now - nextStallMs) >= 0) {
+      passMs += rng.range(profile.stallMsMin, profile.stallMsMax);
+      nextStallMs = now + rng.range(profile.everyMsMin, profile.everyMsMax);
+    }
+    const uint32_t passEnd = now + passMs;
+    // ISR: fronturile din timpul trecerii intră în coadă la momentul lor
+    while (nextEdge < t.edges.size() && (int32_t)(t.edges[nextEdge].atMs - passEnd) < 0) {
+      queue.push(t.edges[nextEdge].atMs, t.edges[nextEdge].pressed);
+      level = t.edges[nextEdge].pressed;
+      ++nextEdge;
+    }
+    now = passEnd;
+    ++r.passes;
+
+    const auto emit = [&](const ButtonGesture& g) {
+      r.decoded.push_back({ g.shorts, g.longPress, g.atMs });
+      if (now - g.atMs > r.lagMsMax) r.lagMsMax = now - g.atMs;
+    };
+    ButtonEdge e;
+    while (queue.pop(&e)) decoder.feed(e, emit);
+    decoder.poll(now, emit);
+
+    // vechiul poller vede doar nivelul de la trecere; o detecție e a apăsării ținute în curs
+    while (nextHold < t.holds.size() && (int32_t)(t.holds[nextHold].releaseMs - now) < 0) ++nextHold;
+    if (old.step(now, !level) && nextHold < t.holds.size() && (int32_t)(now - t.holds[nextHold].pressMs) >= 0) {
+      ++r.oldLong;
+      const int32_t err = (int32_t)(now - (t.holds[nextHold].pressMs + CONFIG.longPressMs));
+      const uint32_t absErr = static_cast<uint32_t>(err < 0 ? -err : err);
+      if (absErr > r.oldErrMsMax) r.oldErrMsMax = absErr;
+    }
+  }
+  r.queueMax = queue.maxDepth();
+  r.coalesced = queue.coalesced();
+  r.dropped = queue.dropped();
+  return r;
+}
+
+static bool sameGestures(const std::vector<Expected>& a, const std::vector<Expected>& b) {
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i].shorts != b[i].shorts || a[i].longPress != b[i].longPress || a[i].atMs != b[i].atMs) return false;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  const uint32_t gestures = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 2000;
+  const uint32_t seed = argc > 2 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 1;
+  bool ok = true;
+  auto check = [&](const char* what, bool pass) {
+    printf("%-60s %s\n", what, pass ? "ok" : "FAILED");
+    ok = ok && pass;
+  };
+
+  Rng rng = { seed * 2654435761u + 1 };
+  const Trace trace = makeTrace(gestures, rng);
+  const uint32_t holds = static_cast<uint32_t>(trace.holds.size());
+  printf("trace: %zu gestures, %zu edges, %.1f h (millis() wraps at +2 min)\n\n", trace.gestures.size(), trace.edges.size(),
+         (trace.endMs - CLOCK_START_MS) / 3'600'000.0);
+
+  static const StallProfile PROFILES[] = {
+    { "no stalls", 0, 0, 0, 0, 0 },
+    { "Ping.ping() 1-5 s every 5-30 s", 5'000, 30'000, 1'000, 5'000, 0 },
+    { "connectWifi() 8-12 s every 10-40 s", 10'000, 40'000, 8'000, 12'000, 0 },
+  };
+  printf("%-36s %9s %9s %7s %7s %7s   %s\n", "loop profile", "decoded", "lag max", "queue", "merged", "dropped", "old poller: holds found, timing error max");
+  bool exact = true, noDrops = true, oldMisses = false;
+  for (const StallProfile& p : PROFILES) {
+    const RunResult r = run<64>(trace, p, Rng{ seed + 17 });
+    const bool same = sameGestures(r.decoded, trace.gestures);
+    exact = exact && same;
+    noDrops = noDrops && r.dropped == 0;
+    if (p.everyMsMin != 0 && r.oldLong < holds) oldMisses = true;
+    printf("%-36s %4zu/%-4zu %6u ms %4u/64 %7u %7u   %u/%u, %u ms\n", p.name, r.decoded.size(), trace.gestures.size(), r.lagMsMax, r.queueMax, r.coalesced,
+           r.dropped, r.oldLong, holds, r.oldErrMsMax);
+  }
+  printf("\n");
+
+  // Coadă prea mică pentru blocajele lungi din prima jumătate: se pierd
+  // fronturi, dar nivelul din fronturile următoare resincronizează decodorul,
+  // deci gesturile de după ultimul blocaj ies din nou exact.
+  const uint32_t half = (trace.endMs - CLOCK_START_MS) / 2;
+  const StallProfile firstHalf = { "connectWifi() 8-12 s, first half", 10'000, 40'000, 8'000, 12'000, half };
+  const RunResult small = run<4>(trace, firstHalf, Rng{ seed + 17 });
+  const uint32_t quietFrom = CLOCK_START_MS + half + 30'000;
+  std::vector<Expected> wantTail, gotTail;
+  for (const Expected& x : trace.gestures) {
+    if ((int32_t)(x.atMs - quietFrom) >= 0) wantTail.push_back(x);
+  }
+  for (const Expected& x : small.decoded) {
+    if ((int32_t)(x.atMs - quietFrom) >= 0) gotTail.push_back(x);
+  }
+  const bool resync = small.dropped > 0 && !wantTail.empty() && sameGestures(gotTail, wantTail);
+  printf("queue of 4, WiFi stalls in the first half: dropped %u edges, decoded %zu/%zu; after the stalls %zu/%zu exact\n\n", small.dropped,
+         small.decoded.size(), trace.gestures.size(), sameGestures(gotTail, wantTail) ? gotTail.size() : 0, wantTail.size());
+
+  // Costul pe front al decodorului (pe host).
+  ButtonGestureDecoder bench;
+  bench.begin(CONFIG, false, CLOCK_START_MS);
+  uint32_t sink = 0;
+  const auto emit = [&](const ButtonGesture& g) { sink += g.shorts; };
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int rep = 0; rep < 50; ++rep) {
+    for (const ButtonEdge& e : trace.edges) bench.feed(ButtonEdge{ e.atMs + rep * 0x10000000u, e.pressed }, emit);
+  }
+  const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / (50.0 * trace.edges.size());
+  printf("decoder: %.1f ns/edge on host (sink %u)\n\n", ns, sink);
+
+  check("gestures and their times identical with and without stalls", exact);
+  check("queue of 64 never overflows", noDrops);
+  check("old per-pass poller misses long presses under stalls", oldMisses);
+  check("after queue overflow the decoder resynchronises", resync);
+  printf("%s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+// console_ring_bench.cpp — simulare host pentru fan-out-ul consolei TCP (include/log_ring.h)
+//
+// Build:
+//   g++ -O2 -std=c++17 -I../include console_ring_bench.cpp -o console_ring_bench
+//
+// Utilizare:
+//   ./console_ring_bench [ticks=2000000]
+//
+// Reproduce bucla din firmware: la fiecare "loop()" scriitorul adaugă o linie
+// de log în ring, apoi fiecare client consumă cât îi permite socket-ul lui
+// simulat (availableForWrite). Clienți: rapizi, lenți și unul care se blochează
+// periodic. Fiecare byte primit e verificat față de poziția lui absolută în flux,
+// iar la final: primit + pierdut + în așteptare == total scris, per client.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "log_ring.h"
+
+static const size_t RING_BYTES = 4096;  // la fel ca CONSOLE_RING_BYTES din main.cpp
+
+// Conținutul fluxului e o funcție de poziția absolută => verificare fără copii.
+static inline uint8_t streamByte(uint32_t pos) {
+  return (pos % 64 == 63) ? '\n' : static_cast<uint8_t>('a' + (pos * 7u) % 26u);
+}
+
+struct SimClient {
+  const char* name;
+  size_t bytesPerTick;    // cât acceptă socket-ul la o trecere
+  uint32_t stallEvery;    // 0 = niciodată; altfel la fiecare N ticks...
+  uint32_t stallTicks;    // ...nu acceptă nimic timp de atâtea ticks
+  LogCursor cursor;
+  uint64_t received;
+  uint64_t corrupt;
+};
+
+int main(int argc, char** argv) {
+  const uint32_t ticks = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 2000000;
+
+  static LogRing<RING_BYTES> ring;
+  std::vector<SimClient> clients = {
+    { "fast-1", 4096, 0, 0, {}, 0, 0 },
+    { "fast-2", 1460, 0, 0, {}, 0, 0 },
+    { "slow-64B", 64, 0, 0, {}, 0, 0 },
+    { "slow-16B", 16, 0, 0, {}, 0, 0 },
+    { "stalling", 2048, 10000, 500, {}, 0, 0 },
+  };
+  for (SimClient& c : clients) c.cursor = ring.cursorWithBacklog(0);
+
+  // linii de log de 20..100 bytes, ca printurile din firmware
+  uint8_t line[128];
+  uint32_t written = 0;
+  uint64_t peeks = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t t = 0; t < ticks; ++t) {
+    const size_t len = 20 + (t * 2654435761u >> 26) % 81;
+    for (size_t i = 0; i < len; ++i) line[i] = streamByte(written + static_cast<uint32_t>(i));
+    ring.write(line, len);
+    written += static_cast<uint32_t>(len);
+
+    for (SimClient& c : clients) {
+      ring.catchUp(c.cursor);
+      const bool stalled = c.stallEvery != 0 && (t % c.stallEvery) < c.stallTicks;
+      size_t room = stalled ? 0 : c.bytesPerTick;
+      while (room > 0) {
+        const uint8_t* data = nullptr;
+        size_t n = ring.peek(c.cursor, &data);
+        ++peeks;
+        if (n == 0) break;
+        if (n > room) n = room;
+        // "socket write": verificarea conținutului ține locul trimiterii
+        for (size_t i = 0; i < n; ++i) {
+          if (data[i] != streamByte(c.cursor.pos + static_cast<uint32_t>(i))) ++c.corrupt;
+        }
+        c.cursor.pos += static_cast<uint32_t>(n);
+        c.received += n;
+        room -= n;
+      }
+    }
+  }
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  uint64_t delivered = 0;
+  for (const SimClient& c : clients) delivered += c.received;
+
+  int failures = 0;
+  printf("ring=%zu B, ticks=%u, written=%u B, %.1f ns/tick (write + fan-out to %zu clients, incl. byte checks)\n", RING_BYTES, ticks,
+         written, seconds * 1e9 / ticks, clients.size());
+  printf("fan-out throughput: %.1f MB/s written, %.1f MB/s delivered, %.2f peeks/tick\n", written / seconds / 1e6,
+         static_cast<double>(delivered) / seconds / 1e6, static_cast<double>(peeks) / ticks);
+  for (const SimClient& c : clients) {
+    const uint32_t pending = ring.head() - c.cursor.pos;
+    const bool accounted = c.received + c.cursor.dropped + pending == written;
+    if (!accounted || c.corrupt != 0) ++failures;
+    printf("  %-9s received=%10llu dropped=%10u pending=%5u corrupt=%llu %s\n", c.name, static_cast<unsigned long long>(c.received),
+           c.cursor.dropped, pending, static_cast<unsigned long long>(c.corrupt), accounted ? "ok" : "ACCOUNTING MISMATCH");
+  }
+  // un client rapid nu pierde nimic din cauza celor lenți
+  if (clients[0].cursor.dropped != 0 || clients[1].cursor.dropped != 0) {
+    printf("fast client dropped data\n");
+    ++failures;
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+// coroutine_bench.cpp — verificare + cost pentru include/coroutine.h (testul releelor de la pornire)
+//
+// Build:
+//   g++ -O2 -std=c++17 -I../include coroutine_bench.cpp -o coroutine_bench
+//
+// Utilizare:
+//   ./coroutine_bench [-v]
+//
+// Verifică:
+//   1) corutina din relay_selftest.h produce exact fronturile vechiului
+//      updateStartupRelayTest() (automat pe pași, copiat mai jos ca referință);
+//   2) rulată din loop() alături de alarmZonesStep() (alarm_fsm.h), un impuls
+//      PIR de 100 ms în mijlocul testului declanșează alarma în aceeași
+//      trecere; varianta cu delay(1000) (blocantă, ca înainte de testul async)
+//      îl pierde complet;
+//   3) dimensiunea cadrului și costul unei reluări (corutina care așteaptă /
+//      avansează) față de automatul scris de mână.
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "alarm_fsm.h"
+#include "relay_selftest.h"
+
+static const uint32_t STEP_MS = 1'000;
+static const uint32_t LOOP_MS = 1;  // o trecere prin loop() pe ms simulată
+
+// Referința: automatul de dinainte (pas + termen), din main.cpp.
+struct LegacySelfTest {
+  bool relay1On = false;
+  bool relay2On = false;
+  uint8_t step = 0;
+  uint32_t nextMs = 0;
+
+  void start(uint32_t now) {
+    step = 0;
+    nextMs = now;
+  }
+  void update(uint32_t now) {
+    if (step > 8) return;
+    if ((int32_t)(now - nextMs) < 0) return;
+    nextMs = now + STEP_MS;
+    if (step == 8) {
+      relay1On = relay2On = false;
+      ++step;
+      return;
+    }
+    const bool on = (step % 2) == 0;
+    relay1On = (step < 4) && on;
+    relay2On = (step >= 4) && on;
+    ++step;
+  }
+  bool done() const { return step > 8; }
+};
+
+struct Edge {
+  uint32_t ms;
+  uint8_t relay;
+  bool on;
+  bool operator==(const Edge& o) const { return ms == o.ms && relay == o.relay && on == o.on; }
+};
+
+template <typename Get>
+static void recordEdges(std::vector<Edge>& edges, bool* last, uint32_t now, Get get) {
+  for (uint8_t r = 0; r < 2; ++r) {
+    const bool v = get(r);
+    if (v != last[r]) edges.push_back({ now, r, v });
+    last[r] = v;
+  }
+}
+
+static const AlarmZone ZONES[] = { { 0, ZoneType::INSTANT } };
+static const AlarmTimings TIMINGS = { 10'000, 10'000, 60'000, 2'000 };
+static const uint32_t PIR_FROM_MS = 2'500;
+static const uint32_t PIR_TO_MS = 2'600;
+
+struct AlarmSim {
+  AlarmPartition part = { AlarmState::ARMED, AlarmState::ARMED, false, 0, 0 };
+  uint32_t lastMotionMs[1] = { static_cast<uint32_t>(0) - TIMINGS.motionRetriggerMs };
+  uint32_t alarms = 0;
+  uint32_t alarmAtMs = 0;
+
+  void step(uint32_t now) {
+    const uint8_t levels = (now >= PIR_FROM_MS && now < PIR_TO_MS) ? 1 : 0;
+    alarmZonesStep(ZONES, 1, &part, levels, lastMotionMs, now, TIMINGS, [&](uint8_t, AlarmEvent e) {
+      if (alarmApply(part, e, now, TIMINGS, &alarms) && part.state == AlarmState::ALARMING && alarmAtMs == 0) alarmAtMs = now;
+    });
+  }
+};
+
+int main(int argc, char** argv) {
+  const bool verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+  bool ok = true;
+  auto check = [&](const char* what, bool pass) {
+    printf("%-62s %s\n", what, pass ? "ok" : "FAILED");
+    ok = ok && pass;
+  };
+
+  // --- 1) aceleași fronturi ca automatul vechi
+  std::vector<Edge> coEdges, legacyEdges;
+  uint32_t coDoneMs = 0, legacyDoneMs = 0;
+  {
+    RelaySelfTest co;
+    bool last[2] = {};
+    uint32_t now = 0;
+    relaySelfTestRun(co, now, STEP_MS);
+    recordEdges(coEdges, last, now, [&](uint8_t r) { return co.relayOn[r]; });
+    for (now = LOOP_MS; co.running() && now < 20'000; now += LOOP_MS) {
+      if (relaySelfTestRun(co, now, STEP_MS) == CoStatus::DONE) coDoneMs = now;
+      recordEdges(coEdges, last, now, [&](uint8_t r) { return co.relayOn[r]; });
+    }
+  }
+  {
+    LegacySelfTest t;
+    bool last[2] = {};
+    t.start(0);
+    for (uint32_t now = 0; !t.done() && now < 20'000; now += LOOP_MS) {
+      t.update(now);
+      if (t.done()) legacyDoneMs = now;
+      recordEdges(legacyEdges, last, now, [&](uint8_t r) { return r == 0 ? t.relay1On : t.relay2On; });
+    }
+  }
+  if (verbose) {
+    for (const Edge& e : coEdges) printf("  %5u ms  RELAY%u %s\n", e.ms, e.relay + 1, e.on ? "ON" : "OFF");
+  }
+  check("self-test edges match the old step machine", coEdges == legacyEdges && coEdges.size() == 8);
+  check("self-test ends after relaySelfTestDurationMs()", coDoneMs == relaySelfTestDurationMs(STEP_MS) && legacyDoneMs == coDoneMs);
+
+  // --- 2) concurent cu monitorizarea PIR
+  {
+    RelaySelfTest co;
+    AlarmSim alarm;
+    relaySelfTestRun(co, 0, STEP_MS);
+    bool overlapped = false;
+    for (uint32_t now = 0; now < 12'000; now += LOOP_MS) {
+      relaySelfTestRun(co, now, STEP_MS);
+      alarm.step(now);
+      if (now == PIR_FROM_MS) overlapped = co.running();
+    }
+    printf("coroutine: PIR pulse at %u ms -> ALARMING at %u ms\n", PIR_FROM_MS, alarm.alarmAtMs);
+    check("PIR during self-test raises the alarm in the same pass", overlapped && alarm.alarmAtMs == PIR_FROM_MS && alarm.alarms == 1);
+  }
+  {
+    // Testul cu delay(): loop()-ul începe abia după cele 8 s.
+    AlarmSim alarm;
+    for (uint32_t now = relaySelfTestDurationMs(STEP_MS); now < 12'000; now += LOOP_MS) alarm.step(now);
+    printf("blocking delay(): PIR pulse at %u ms -> %s\n", PIR_FROM_MS, alarm.alarms ? "ALARMING" : "missed");
+    check("blocking baseline misses the same pulse", alarm.alarms == 0);
+  }
+
+  // --- 3) memorie + cost
+  printf("frame: Coroutine %zu B, RelaySelfTest %zu B (old step machine %zu B)\n", sizeof(Coroutine), sizeof(RelaySelfTest), sizeof(LegacySelfTest));
+  {
+    const int reps = 20'000'000;
+    volatile uint32_t clock = 500;
+    RelaySelfTest co;
+    relaySelfTestRun(co, 0, STEP_MS);
+    LegacySelfTest legacy;
+    legacy.start(0);
+    legacy.update(0);
+
+    auto t0 = std::chrono::steady_clock::now();
+    uint32_t sink = 0;
+    for (int i = 0; i < reps; ++i) sink += static_cast<uint32_t>(relaySelfTestRun(co, clock, STEP_MS));
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i) {
+      legacy.update(clock);
+      sink += legacy.step;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    const double coWait = std::chrono::duration<double, std::nano>(t1 - t0).count() / reps;
+    const double legacyWait = std::chrono::duration<double, std::nano>(t2 - t1).count() / reps;
+
+    // reluări care avansează: o secvență completă pe fiecare iterație
+    const int runs = 1'000'000;
+    auto t3 = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; ++i) {
+      RelaySelfTest c;
+      uint32_t now = clock;
+      while (relaySelfTestRun(c, now, STEP_MS) == CoStatus::RUNNING) now += STEP_MS;
+      sink += c.relay;
+    }
+    auto t4 = std::chrono::steady_clock::now();
+    const double coFull = std::chrono::duration<double, std::nano>(t4 - t3).count() / runs;
+    printf("resume (waiting): coroutine %.2f ns, step machine %.2f ns; full self-test (9 resumes) %.1f ns  [%u]\n", coWait, legacyWait, coFull, sink & 1);
+  }
+
+  printf("%s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
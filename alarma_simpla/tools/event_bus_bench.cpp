@@ -0,0 +1,294 @@
+// event_bus_bench.cpp — verificare + cost pentru magistrala de evenimente (include/event_bus.h)
+//
+// Build:
+//   g++ -O2 -std=c++17 -I../include event_bus_bench.cpp -o event_bus_bench
+//
+// Utilizare:
+//   ./event_bus_bench [passes=5000000]
+//
+// 1) ordine, filtrare pe topic și coadă plină (livrare pe loc, nimic pierdut);
+// 2) simulare de loop() cu codul real de decizie (alarm_fsm.h, relay_scheduler.h):
+//    PIR-uri, timere, comenzi, căderi de WiFi/ping; fiecare tranziție se
+//    postează ca în firmware, iar la finalul trecerii se face dispatch. Se
+//    măsoară costul post-ului (ciclurile TSC pe x86, ns în rest), costul
+//    vechiului log sincron (formatarea liniei [ EVENT= ...] la producător) și
+//    adâncimea maximă a cozii;
+// 3) trecerea cea mai încărcată posibilă (toate PIR-urile + comandă + timere +
+//    releu) — trebuie să încapă în coadă.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#endif
+
+#include "alarm_fsm.h"
+#include "event_bus.h"
+#include "messages.h"
+#include "relay_scheduler.h"
+
+static const uint16_t BUS_CAPACITY = 16;  // la fel ca eventBus din main.cpp
+static const uint8_t PARTITIONS = 2;
+static const uint8_t ZONES = 4;
+
+// ---------------------------------------------------------------------------
+// 1) semantica
+// ---------------------------------------------------------------------------
+static std::vector<int> received[3];
+
+template <int ID, uint32_t MASK>
+struct RecordingSink {
+  static constexpr uint32_t TOPICS = MASK;
+  static void onEvent(const BusEvent& e) { received[ID].push_back(static_cast<int>(e.value)); }
+};
+
+using AlarmOnly = RecordingSink<0, busTopicBit(BusTopic::ALARM_STATE)>;
+using Both = RecordingSink<1, busTopicBit(BusTopic::ALARM_STATE) | busTopicBit(BusTopic::RELAY_DECISION)>;
+using RelayOnly = RecordingSink<2, busTopicBit(BusTopic::RELAY_DECISION)>;
+
+struct NoRelaySink {
+  static constexpr uint32_t TOPICS = busTopicBit(BusTopic::ALARM_STATE);
+  static void onEvent(const BusEvent&) {}
+};
+
+static int checkSemantics() {
+  int failures = 0;
+  auto expect = [&](bool ok, const char* what) {
+    if (!ok) {
+      printf("  FAILED: %s\n", what);
+      ++failures;
+    }
+  };
+
+  EventBus<4, AlarmOnly, Both, RelayOnly> bus;
+  // value = numărul post-ului; topic par/impar
+  for (int i = 0; i < 10; ++i) bus.post(i % 2 ? BusTopic::RELAY_DECISION : BusTopic::ALARM_STATE, 0, 0, static_cast<uint32_t>(i), 0);
+  expect(bus.inlineDrains() == 6, "6 inline drains with capacity 4 and 10 posts");
+  expect(bus.depth() == 4 && bus.maxDepth() == 4, "queue stays full at capacity");
+  bus.dispatch();
+  expect(bus.depth() == 0, "dispatch empties the queue");
+  std::vector<int> even, odd, all;
+  for (int i = 0; i < 10; ++i) (i % 2 ? odd : even).push_back(i), all.push_back(i);
+  expect(received[0] == even, "alarm-only sink got only ALARM_STATE, in order");
+  expect(received[1] == all, "two-topic sink got every event, in post order");
+  expect(received[2] == odd, "relay-only sink got only RELAY_DECISION, in order");
+
+  EventBus<4, NoRelaySink> filtered;
+  filtered.post(BusTopic::RELAY_DECISION, 0, 0, 0, 0);
+  expect(filtered.posted() == 0 && filtered.depth() == 0, "topic without subscribers is not queued");
+
+  EventBus<8, Both> budgeted;
+  received[1].clear();
+  for (int i = 0; i < 5; ++i) budgeted.post(BusTopic::ALARM_STATE, 0, 0, static_cast<uint32_t>(i), 0);
+  expect(budgeted.dispatch(2) == 2 && budgeted.depth() == 3, "dispatch honours the budget");
+  budgeted.dispatch();
+  expect(received[1] == std::vector<int>({ 0, 1, 2, 3, 4 }), "budgeted dispatch keeps order");
+
+  printf("semantics: order, topic filter, full queue, budget %s\n", failures == 0 ? "ok" : "FAILED");
+  return failures;
+}
+
+// ---------------------------------------------------------------------------
+// 2) simulare loop()
+// ---------------------------------------------------------------------------
+// Abonatul de log face ce face ConsoleEventSink (fără UART): formatează linia.
+static uint64_t logLines = 0;
+static uint64_t logBytes = 0;
+static bool telemetryDue = false;
+
+static void formatEventLine(const char* message, char* line, size_t size) {
+  const time_t t = static_cast<time_t>(1'792'368'000);
+  struct tm tmInfo;
+  localtime_r(&t, &tmInfo);
+  char ts[24];
+  strftime(ts, sizeof(ts), "%d/%m/%Y %H:%M:%S", &tmInfo);
+  msgFormat(line, size, MsgLang::RO, Msg::EVENT_LINE, message, ts);
+}
+
+static void logAlarmState(uint8_t p, AlarmState s) {
+  char message[96], line[200];
+  msgFormat(message, sizeof(message), MsgLang::RO, Msg::EVT_ALARM_STATE, ALARM_STATE_INFO[static_cast<uint8_t>(s)].name, p + 1);
+  formatEventLine(message, line, sizeof(line));
+  ++logLines;
+  logBytes += strlen(line);
+}
+
+struct LogSink {
+  static constexpr uint32_t TOPICS = busTopicBit(BusTopic::ALARM_STATE) | busTopicBit(BusTopic::RELAY_DECISION);
+  static void onEvent(const BusEvent& e) {
+    if (e.topic == BusTopic::ALARM_STATE) {
+      logAlarmState(e.a, static_cast<AlarmState>(e.b));
+      return;
+    }
+    char line[200];
+    formatEventLine("relay_1_ACTIVATED", line, sizeof(line));
+    ++logLines;
+    logBytes += strlen(line);
+  }
+};
+
+struct TelemetrySink {
+  static constexpr uint32_t TOPICS = busTopicBit(BusTopic::ALARM_STATE) | busTopicBit(BusTopic::RELAY_DECISION);
+  static void onEvent(const BusEvent&) { telemetryDue = true; }
+};
+
+static uint32_t rngState = 0x2545F491u;
+static uint32_t rnd() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+struct Cost {
+  uint64_t n = 0;
+  uint64_t total = 0;
+  uint64_t max = 0;
+  void add(uint64_t v) {
+    ++n;
+    total += v;
+    if (v > max) max = v;
+  }
+  double avg() const { return n ? static_cast<double>(total) / n : 0.0; }
+};
+
+static inline uint64_t ticks() {
+#ifdef BENCH_HAVE_TSC
+  return __rdtsc();
+#else
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+static const AlarmZone ZONE_CONFIG[ZONES] = {
+  { 0, ZoneType::ENTRY },
+  { 0, ZoneType::INTERIOR },
+  { 0, ZoneType::INTERIOR },
+  { 1, ZoneType::INSTANT },
+};
+static const AlarmTimings TIMINGS = { 10'000, 15'000, 30'000, 2'000 };
+
+struct SimResult {
+  Cost post;
+  Cost direct;
+  Cost dispatch;
+  uint16_t maxDepth = 0;
+  uint32_t inlineDrains = 0;
+  uint32_t posted = 0;
+  uint32_t busiestPass = 0;
+};
+
+static SimResult simulate(uint32_t passes) {
+  SimResult r;
+  static EventBus<BUS_CAPACITY, LogSink, TelemetrySink> bus;
+  AlarmPartition parts[PARTITIONS] = {};
+  uint32_t lastMotionMs[ZONES] = {};
+  uint32_t triggers = 0;
+  RelayScheduler relay = {};
+  relay.unlockMs = 70'000;
+  relay.wifiWasConnected = true;
+
+  uint32_t now = 1'000;
+  uint8_t levels = 0;
+  bool wifiUp = true, internetUp = true;
+  uint32_t nextPingMs = 10'000;
+  uint32_t passPosts = 0;
+
+  auto post = [&](BusTopic topic, uint8_t a, uint8_t b, uint32_t value) {
+    const uint64_t t0 = ticks();
+    bus.post(topic, a, b, value, now);
+    r.post.add(ticks() - t0);
+    ++passPosts;
+  };
+  auto dispatch = [&](uint8_t p, AlarmEvent event) {
+    if (!alarmApply(parts[p], event, now, TIMINGS, &triggers)) return;
+    post(BusTopic::ALARM_STATE, p, static_cast<uint8_t>(parts[p].state), triggers);
+    // ce făcea producătorul înainte: linia de log formatată pe loc
+    const uint64_t t0 = ticks();
+    char message[96], line[200];
+    msgFormat(message, sizeof(message), MsgLang::RO, Msg::EVT_ALARM_STATE, ALARM_STATE_INFO[static_cast<uint8_t>(parts[p].state)].name, p + 1);
+    formatEventLine(message, line, sizeof(line));
+    r.direct.add(ticks() - t0);
+  };
+
+  for (uint32_t i = 0; i < passes; ++i) {
+    now += 1 + rnd() % 8;
+    passPosts = 0;
+    for (uint8_t z = 0; z < ZONES; ++z) {
+      const bool on = levels & (1u << z);
+      if (on ? (rnd() % 400 == 0) : (rnd() % 20'000 == 0)) levels ^= static_cast<uint8_t>(1u << z);
+    }
+    if (rnd() % (wifiUp ? 2'000'000 : 40'000) == 0) wifiUp = !wifiUp;
+    if (rnd() % 1'500'000 == 0) internetUp = !internetUp;
+
+    const uint8_t d = relayLoopStep(relay, now, wifiUp);
+    if (d != RELAY_DECISION_NONE) post(BusTopic::RELAY_DECISION, d, 0, relay.activationCount);
+    if (rnd() % 100'000 == 0) {
+      const AlarmEvent ev = parts[0].state == AlarmState::DISARMED ? (rnd() % 2 ? AlarmEvent::ARM_AWAY : AlarmEvent::ARM_STAY) : AlarmEvent::DISARM;
+      for (uint8_t p = 0; p < PARTITIONS; ++p) dispatch(p, ev);
+    }
+    alarmZonesStep(ZONE_CONFIG, ZONES, parts, levels, lastMotionMs, now, TIMINGS, dispatch);
+    alarmTimersStep(parts, PARTITIONS, now, dispatch);
+    if (wifiUp && relay.wifiDisconnectedSinceMs != 0 && rnd() % 50 == 0) relay.wifiDisconnectedSinceMs = 0;
+    if ((int32_t)(now - nextPingMs) >= 0) {
+      nextPingMs = now + 60'000;
+      const uint8_t pd = relayPingResult(relay, now, internetUp && wifiUp);
+      const uint8_t logged = pd & (RELAY_DECISION_PING_DOWN | RELAY_DECISION_ACTIVATED);
+      if (logged) post(BusTopic::RELAY_DECISION, logged, 0, relay.activationCount);
+    }
+    if (passPosts > r.busiestPass) r.busiestPass = passPosts;
+
+    if (bus.depth() != 0) {
+      const uint16_t n = bus.depth();
+      const uint64_t t0 = ticks();
+      bus.dispatch();
+      r.dispatch.add((ticks() - t0) / n);
+    }
+  }
+  r.maxDepth = bus.maxDepth();
+  r.inlineDrains = bus.inlineDrains();
+  r.posted = bus.posted();
+  return r;
+}
+
+// ---------------------------------------------------------------------------
+// 3) cea mai încărcată trecere: comandă pe toate partițiile, toate PIR-urile,
+//    timere expirate, decizie de releu din loop și din ping
+// ---------------------------------------------------------------------------
+static uint32_t worstCasePass() {
+  // o tranziție per partiție pentru comandă și timere, una per zonă, plus 2 de releu
+  return PARTITIONS + ZONES + PARTITIONS + 2;
+}
+
+int main(int argc, char** argv) {
+  const uint32_t passes = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 5'000'000;
+  int failures = checkSemantics();
+
+  const auto t0 = std::chrono::steady_clock::now();
+  const SimResult r = simulate(passes);
+  const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+#ifdef BENCH_HAVE_TSC
+  const char* unit = "TSC cycles";
+#else
+  const char* unit = "ns";
+#endif
+  printf("simulation: %u loop passes in %.2f s, %u events posted, %llu log lines (%llu B)\n", passes, secs, r.posted,
+         static_cast<unsigned long long>(logLines), static_cast<unsigned long long>(logBytes));
+  printf("  post (producer side):        avg %.1f %s, max %llu\n", r.post.avg(), unit, static_cast<unsigned long long>(r.post.max));
+  printf("  old synchronous log format:  avg %.1f %s, max %llu (%.0fx the post)\n", r.direct.avg(), unit,
+         static_cast<unsigned long long>(r.direct.max), r.post.avg() > 0 ? r.direct.avg() / r.post.avg() : 0.0);
+  printf("  dispatch per event (sinks):  avg %.1f %s\n", r.dispatch.avg(), unit);
+  printf("  max queue depth: %u/%u, busiest pass %u events, inline drains %u\n", r.maxDepth, BUS_CAPACITY, r.busiestPass, r.inlineDrains);
+
+  const uint32_t worst = worstCasePass();
+  const bool fits = worst <= BUS_CAPACITY;
+  printf("worst-case pass bound: %u events for %u partitions / %u zones -> %s\n", worst, PARTITIONS, ZONES,
+         fits ? "fits in the queue" : "exceeds the queue (inline drains)");
+  if (!fits || r.inlineDrains != 0 || logLines != r.posted || !telemetryDue) ++failures;
+  printf("%s\n", failures == 0 ? "ok" : "FAILED");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,237 @@
+// fault_campaign_sim.cpp — verificare pentru include/fault_inject.h + campanii de defecte pe logica reală (releu, alarmă)
+//
+// Build:
+//   g++ -O2 -std=c++17 -I../include fault_campaign_sim.cpp -o fault_campaign_sim
+//
+// Utilizare:
+//   ./fault_campaign_sim [seed]
+//
+// 1) injectorul: procentele se respectă, același seed dă aceleași eșecuri,
+//    durate/expirare, aplicarea o singură dată (CLOCK_JUMP / HEAP_PRESSURE),
+//    costul unui hook fără defecte active;
+// 2) campanii, ca pe placă cu `FAULT ...`: loop() simulat (10 ms/trecere), ping
+//    Google la 60 s și gateway la 30 s, legate ca în main.cpp între
+//    relay_scheduler.h și power_watchdog.h (routerul pe releu, WiFi căzut cât
+//    routerul e oprit/pornește), PIR-uri prin alarm_fsm.h; la final același
+//    rezumat ca `Fault run:` din firmware.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "alarm_fsm.h"
+#include "fault_inject.h"
+#include "power_watchdog.h"
+#include "relay_scheduler.h"
+
+static const uint32_t PASS_MS = 10;
+static const uint32_t PING_INTERVAL_MS = 60'000;
+static const uint32_t ROUTER_BOOT_MS = 40'000;
+static const AlarmZone ZONES[] = { { 0, ZoneType::INTERIOR }, { 0, ZoneType::INTERIOR }, { 0, ZoneType::INTERIOR }, { 0, ZoneType::ENTRY } };
+static const AlarmTimings TIMINGS = { 10'000, 10'000, 60'000, 2'000 };
+
+// Tabelele din main.cpp (doar routerul are releu)
+enum : uint8_t { MODEM, ROUTER, POE_SWITCH, DEVICE_COUNT };
+enum : uint8_t { TARGET_GATEWAY, TARGET_PUBLIC, TARGET_COUNT };
+static const PowerDeviceConfig DEVICES[DEVICE_COUNT] = {
+  { "MODEM", POWER_WD_NONE, false, 10'000, 120'000, 30UL * 60'000 },
+  { "ROUTER", MODEM, true, INTERNET_RELAY_PULSE_MS, 90'000, INTERNET_RELAY_COOLDOWN_MS },
+  { "POE_SWITCH", ROUTER, false, 5'000, 45'000, 15UL * 60'000 },
+};
+static const PowerTargetConfig TARGETS[TARGET_COUNT] = {
+  { "GATEWAY", powerDeviceBit(ROUTER), 3, 30'000 },
+  { "PUBLIC", powerDeviceBit(ROUTER) | powerDeviceBit(MODEM), 2, 0 },
+};
+
+struct FaultCmd {
+  Fault fault;
+  int32_t value;
+  uint32_t seconds;
+};
+
+struct Summary {
+  uint32_t seconds;
+  uint32_t pingFailures;
+  uint32_t internetDown;
+  uint32_t relayActivations;
+  uint32_t powerCycles;
+  uint32_t minCycleGapMs;  // între două impulsuri ale routerului (UINT32_MAX = cel mult unul)
+  uint32_t alarmTriggers;
+  bool pingDownAtEnd;
+  bool relayAtEnd;
+  uint32_t hits[FAULT_COUNT];
+  uint32_t rolls[FAULT_COUNT];
+};
+
+// O rulare: comenzile FAULT la t=0, simulare până expiră toate + `tailMs`.
+static Summary runCampaign(uint32_t seed, const std::vector<FaultCmd>& cmds, AlarmState armed, uint32_t tailMs) {
+  FaultInjector faults;
+  faults.seed(seed);
+  RelayScheduler relay = {};
+  relay.wifiWasConnected = true;
+  relay.pingDelegated = true;
+  PowerWatchdog watchdog;
+  AlarmPartition part = { armed, armed == AlarmState::DISARMED ? AlarmState::ARMED : armed, false, 0, 0 };
+  uint32_t lastMotionMs[4];
+  for (uint32_t& m : lastMotionMs) m = static_cast<uint32_t>(0) - TIMINGS.motionRetriggerMs;
+  uint32_t alarmTriggers = 0;
+
+  const uint32_t start = 100'000;  // după holdoff-ul de pornire
+  watchdog.begin(DEVICES, DEVICE_COUNT, TARGETS, TARGET_COUNT, start);
+  for (const FaultCmd& c : cmds) faults.arm(c.fault, c.value, c.seconds * 1000, start);
+  auto pingOk = [&]() { return !(faults.anyActive() && faults.roll(Fault::PING_LOSS)); };  // rețeaua reală e bună
+  Summary s = {};
+  s.minCycleGapMs = UINT32_MAX;
+  uint32_t lastCutMs = 0, cuts = 0;
+  uint32_t endMs = 0;
+  uint32_t nextPingMs = start;
+  uint32_t routerUpMs = start;
+  bool cutWas = false;
+  for (uint32_t now = start; endMs == 0 || now < endMs + tailMs; now += PASS_MS) {
+    // PIR-uri (fără mișcare reală) + zgomot injectat
+    uint8_t levels = 0;
+    if (faults.anyActive() && faults.roll(Fault::PIR_NOISE)) levels |= static_cast<uint8_t>(1u << faults.randomBelow(4));
+    alarmZonesStep(ZONES, 4, &part, levels, lastMotionMs, now, TIMINGS, [&](uint8_t, AlarmEvent e) { alarmApply(part, e, now, TIMINGS, &alarmTriggers); });
+    alarmTimersStep(&part, 1, now, [&](uint8_t, AlarmEvent e) { alarmApply(part, e, now, TIMINGS, &alarmTriggers); });
+
+    // WiFi-ul cade cât routerul e fără alimentare și cât pornește
+    if (cutWas && !relay.cutActive) routerUpMs = now + ROUTER_BOOT_MS;
+    cutWas = relay.cutActive;
+    const bool wifiUp = !relay.cutActive && (int32_t)(now - routerUpMs) >= 0;
+
+    if (relayLoopStep(relay, now, wifiUp) & RELAY_DECISION_ACTIVATED) watchdog.noteExternalCycle(ROUTER, now);
+    if ((int32_t)(now - nextPingMs) >= 0) {
+      nextPingMs = now + PING_INTERVAL_MS;
+      const bool ok = wifiUp && pingOk();
+      const uint8_t d = relayPingResult(relay, now, ok);
+      if (wifiUp) watchdog.probeResult(TARGET_PUBLIC, ok);
+      if (endMs == 0) {
+        if (!ok) ++s.pingFailures;
+        if (d & RELAY_DECISION_PING_DOWN) ++s.internetDown;
+      }
+    }
+    if (wifiUp) {
+      const uint8_t t = watchdog.dueProbe(now);
+      if (t != POWER_WD_NONE) watchdog.probeResult(t, pingOk());
+    }
+    const PowerAction a = watchdog.tick(now);
+    if (a.kind == PowerAction::CUT && a.device == ROUTER) relayActivate(relay, now);
+    if (relay.activationCount != cuts) {
+      if (cuts != 0) s.minCycleGapMs = std::min(s.minCycleGapMs, now - lastCutMs);
+      cuts = relay.activationCount;
+      lastCutMs = now;
+    }
+
+    faults.expire(now);
+    if (endMs == 0 && !faults.anyActive()) {
+      endMs = now;
+      s.seconds = (now - start) / 1000;
+      s.relayActivations = relay.activationCount;
+      for (uint8_t d = 0; d < DEVICE_COUNT; ++d) s.powerCycles += watchdog.cycles(d);
+      s.alarmTriggers = alarmTriggers;
+      for (uint8_t f = 0; f < FAULT_COUNT; ++f) {
+        s.hits[f] = faults.hits(static_cast<Fault>(f));
+        s.rolls[f] = faults.rolls(static_cast<Fault>(f));
+      }
+    }
+  }
+  s.pingDownAtEnd = relay.pingDownActive;
+  s.relayAtEnd = relay.cutActive;
+  return s;
+}
+
+static void printSummary(const char* title, const Summary& s) {
+  printf("%s\n  Fault run: %u s;", title, s.seconds);
+  for (uint8_t f = 0; f < FAULT_COUNT; ++f) {
+    if (s.rolls[f] != 0) printf(" %s %u/%u", FAULT_INFO[f].name, s.hits[f], s.rolls[f]);
+  }
+  printf("\n  pings failed %u, internet_DOWN %u, relay activations +%u, power cycles +%u, alarm triggers +%u; 3 min later: ping down %s, relay %s\n",
+         s.pingFailures, s.internetDown, s.relayActivations, s.powerCycles, s.alarmTriggers, s.pingDownAtEnd ? "YES" : "NO", s.relayAtEnd ? "ON" : "OFF");
+}
+
+int main(int argc, char** argv) {
+  const uint32_t seed = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 1;
+  bool ok = true;
+  auto check = [&](const char* what, bool pass) {
+    printf("%-60s %s\n", what, pass ? "ok" : "FAILED");
+    ok = ok && pass;
+  };
+
+  // --- 1) injectorul
+  {
+    FaultInjector f;
+    f.seed(seed);
+    f.arm(Fault::PING_LOSS, 30, 0, 0);
+    const int n = 100'000;
+    int hits = 0;
+    for (int i = 0; i < n; ++i) hits += f.roll(Fault::PING_LOSS) ? 1 : 0;
+    const double rate = 100.0 * hits / n;
+    printf("PING_LOSS 30%%: %.2f%% over %d rolls\n", rate, n);
+    check("percentage within 1 point", std::fabs(rate - 30.0) < 1.0 && f.hits(Fault::PING_LOSS) == static_cast<uint32_t>(hits));
+  }
+  {
+    FaultInjector a, b, c;
+    a.seed(seed);
+    b.seed(seed);
+    c.seed(seed + 1);
+    for (FaultInjector* f : { &a, &b, &c }) f->arm(Fault::DNS_FAIL, 50, 0, 0);
+    bool same = true, differs = false;
+    for (int i = 0; i < 1000; ++i) {
+      const bool ra = a.roll(Fault::DNS_FAIL), rb = b.roll(Fault::DNS_FAIL), rc = c.roll(Fault::DNS_FAIL);
+      same = same && ra == rb;
+      differs = differs || ra != rc;
+    }
+    check("same seed -> same failures, other seed -> different", same && differs);
+  }
+  {
+    FaultInjector f;
+    const uint32_t t0 = 0xFFFFF000u;  // peste rollover-ul lui millis()
+    f.arm(Fault::PING_RTT, 250, 60'000, t0);
+    f.arm(Fault::HEAP_PRESSURE, 8'000, 0, t0);
+    f.arm(Fault::CLOCK_JUMP, -3600, 0, t0);
+    const bool pendingOnce = f.takePending(Fault::CLOCK_JUMP) && !f.takePending(Fault::CLOCK_JUMP) && f.takePending(Fault::HEAP_PRESSURE);
+    const bool before = f.expire(t0 + 59'990) == 0 && f.amount(Fault::PING_RTT) == 250 && f.remainingMs(Fault::PING_RTT, t0 + 59'990) == 10;
+    const bool after = f.expire(t0 + 60'000) == (1u << static_cast<uint8_t>(Fault::PING_RTT)) && f.amount(Fault::PING_RTT) == 0;
+    const bool forever = f.active(Fault::HEAP_PRESSURE) && f.expire(t0 + 3'600'000) == 0;
+    const bool rejects = !f.arm(Fault::PING_LOSS, 101, 10'000, t0) && !f.arm(Fault::HEAP_PRESSURE, -1, 10'000, t0);
+    check("duration, rollover, one-shot pending, range checks", pendingOnce && before && after && forever && rejects);
+    check("names round-trip", faultFromName("PIR_NOISE", 9) == static_cast<uint8_t>(Fault::PIR_NOISE) && faultFromName("PIR", 3) == FAULT_COUNT);
+  }
+  {
+    // hook fără defecte active: ce rămâne pe placă cu FAULT_INJECTION_ENABLED = true
+    FaultInjector f;
+    const int reps = 50'000'000;
+    volatile bool sink = false;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i) sink = sink ^ (f.anyActive() && f.roll(Fault::PING_LOSS));
+    const auto t1 = std::chrono::steady_clock::now();
+    printf("idle hook: %.2f ns/call (sizeof(FaultInjector) = %zu B)\n", std::chrono::duration<double, std::nano>(t1 - t0).count() / reps, sizeof(FaultInjector));
+  }
+
+  // --- 2) campanii
+  const uint32_t tail = 180'000;
+  const Summary total = runCampaign(seed, { { Fault::PING_LOSS, 100, 600 } }, AlarmState::DISARMED, tail);
+  printSummary("FAULT PING_LOSS 100 600  (all pings lost for 10 min)", total);
+  // cadența routerului: impuls 10 s + boot 90 s, apoi 2 ping-uri eșuate (și cel
+  // puțin INTERNET_RELAY_COOLDOWN_MS de la finalul ciclului) => ~3 min
+  const uint32_t minGapMs = INTERNET_RELAY_PULSE_MS + DEVICES[ROUTER].settleMs + INTERNET_RELAY_COOLDOWN_MS;
+  printf("  router cycles at least %.1f min apart (floor %.1f min)\n", total.minCycleGapMs / 60'000.0, minGapMs / 60'000.0);
+  check("total loss: router cycled every ~3 min, not faster, recovers",
+        total.internetDown == 1 && total.powerCycles == total.relayActivations && total.powerCycles >= 3 && total.powerCycles <= 600'000 / minGapMs + 1 &&
+            total.minCycleGapMs >= minGapMs && !total.pingDownAtEnd && !total.relayAtEnd);
+
+  const Summary flaky = runCampaign(seed, { { Fault::PING_LOSS, 20, 1800 } }, AlarmState::DISARMED, tail);
+  printSummary("FAULT PING_LOSS 20 1800  (flaky link, 30 min)", flaky);
+  check("flaky link: thresholds absorb isolated losses", flaky.pingFailures >= 1 && flaky.powerCycles <= flaky.internetDown && !flaky.pingDownAtEnd);
+
+  const Summary noiseArmed = runCampaign(seed, { { Fault::PIR_NOISE, 1, 120 } }, AlarmState::ARMED, tail);
+  printSummary("FAULT PIR_NOISE 1 120  (armed)", noiseArmed);
+  const Summary noiseDisarmed = runCampaign(seed, { { Fault::PIR_NOISE, 1, 120 } }, AlarmState::DISARMED, tail);
+  printSummary("FAULT PIR_NOISE 1 120  (disarmed)", noiseDisarmed);
+  check("PIR noise triggers only while armed", noiseArmed.alarmTriggers >= 1 && noiseDisarmed.alarmTriggers == 0);
+
+  printf("%s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,452 @@
+// fleet_collector.cpp — colector host (Linux) pentru telemetria flotei de plăci
+//
+// Build:
+//   g++ -O2 -std=c++17 -pthread -I../include fleet_collector.cpp -o fleet_collector
+//
+// Utilizare:
+//   ./fleet_collector [udpPort=5140] [queryPort=5141] [threads=nproc]
+//
+// Ingest: cadre TelemetryFrame și TelemetryEvent (include/telemetry_frame.h)
+// pe UDP. Fiecare thread are propriul socket (SO_REUSEPORT, kernel-ul împarte
+// fluxurile) și propriul epoll, citește în rafale cu recvmmsg() și scrie în
+// indexul shard-uit. Evenimentele se numără pe ID (messages.h) și pe placă;
+// ultimul e refăcut ca text cu msgRender().
+//
+// Interogări (TCP, o comandă pe linie, răspuns terminat cu "." pe linie separată):
+//   STATS                  dispozitive, cadre, evenimente, pierderi, rată ingest
+//   EVENTS                 evenimente primite, pe ID (EVT_ALARM_STATE 12, ...)
+//   CYCLES_GT <n>          site-uri cu > n power-cycle-uri de router azi (UTC)
+//   DEVICE <chipHex>       ultima stare a unui dispozitiv + ultimul eveniment
+//   OUTAGES <chipHex>      istoricul recent de întreruperi
+//   DOWN                   dispozitive cu ping down / WiFi down acum
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "telemetry_frame.h"
+
+static const size_t SHARD_COUNT = 64;
+static const size_t OUTAGE_HISTORY = 16;
+static const int RECV_BATCH = 64;
+
+#define MSG_NAME_ENTRY(id, ro, en) #id,
+static const char* const MSG_NAMES[MSG_COUNT] = { MESSAGE_CATALOG(MSG_NAME_ENTRY) };
+#undef MSG_NAME_ENTRY
+
+struct Outage {
+  uint32_t startEpoch;
+  uint32_t endEpoch;  // 0 = în desfășurare
+};
+
+struct DeviceRecord {
+  TelemetryFrame latest;
+  TelemetryEvent lastEvent;
+  uint64_t events;
+  bool hasStatus;  // primul cadru STATUS inițializează contorul de azi
+  uint64_t lastSeenSec;
+  uint64_t frames;
+  uint64_t lost;
+  uint32_t nextSeq;
+  uint32_t day;                // ziua (UTC) pentru contorul de azi
+  uint32_t relayCountDayStart;
+  uint32_t cyclesToday;
+  bool down;
+  uint8_t outageHead;
+  uint8_t outageCount;
+  Outage outages[OUTAGE_HISTORY];
+};
+
+// Fiecare shard are mutex-ul lui; un dispozitiv aparține mereu aceluiași shard,
+// deci thread-urile de ingest se blochează doar la coliziuni pe shard.
+struct alignas(64) Shard {
+  std::mutex mu;
+  std::unordered_map<uint32_t, DeviceRecord> devices;
+};
+
+static Shard shards[SHARD_COUNT];
+static std::atomic<uint64_t> framesTotal{ 0 };
+static std::atomic<uint64_t> framesBad{ 0 };
+static std::atomic<uint64_t> eventsTotal{ 0 };
+static std::atomic<uint64_t> eventsById[MSG_COUNT];
+static std::atomic<bool> running{ true };
+
+static Shard& shardFor(uint32_t chipId) {
+  return shards[(chipId * 2654435761u) >> 26];  // hash multiplicativ -> 64 shard-uri
+}
+
+static uint32_t utcDay(uint64_t sec) {
+  return static_cast<uint32_t>(sec / 86400);
+}
+
+// STATUS și EVENT au același contor seq: golurile din oricare = pierderi.
+static void noteSeq(DeviceRecord& d, uint32_t seq, bool first) {
+  if (!first && seq > d.nextSeq) d.lost += seq - d.nextSeq;
+  d.nextSeq = seq + 1;
+}
+
+static DeviceRecord& deviceFor(Shard& shard, uint32_t chipId, bool* isNew) {
+  auto it = shard.devices.find(chipId);
+  *isNew = (it == shard.devices.end());
+  if (*isNew) it = shard.devices.emplace(chipId, DeviceRecord{}).first;
+  return it->second;
+}
+
+static void ingestFrame(const TelemetryFrame& f, uint64_t nowSec) {
+  Shard& shard = shardFor(f.chipId);
+  std::lock_guard<std::mutex> lock(shard.mu);
+
+  bool isNew;
+  DeviceRecord& d = deviceFor(shard, f.chipId, &isNew);
+  noteSeq(d, f.seq, isNew);
+
+  if (!d.hasStatus) {
+    d.hasStatus = true;
+    d.day = utcDay(nowSec);
+    d.relayCountDayStart = f.relayActivationCount;
+  } else {
+    const uint32_t today = utcDay(nowSec);
+    if (today != d.day) {
+      d.day = today;
+      d.relayCountDayStart = d.latest.relayActivationCount;
+      d.cyclesToday = 0;
+    }
+    if (f.relayActivationCount < d.latest.relayActivationCount) {
+      // contorul a repornit (power loss): păstrăm ce s-a numărat azi (aritmetică modulo 2^32)
+      d.relayCountDayStart = f.relayActivationCount - d.cyclesToday;
+    }
+  }
+  d.cyclesToday = f.relayActivationCount - d.relayCountDayStart;
+
+  const bool down = (f.flags & TELEMETRY_FLAG_PING_DOWN) || !(f.flags & TELEMETRY_FLAG_WIFI_CONNECTED);
+  if (down && !d.down) {
+    Outage& o = d.outages[d.outageHead];
+    o.startEpoch = f.lastOutageEpoch ? f.lastOutageEpoch : static_cast<uint32_t>(nowSec);
+    o.endEpoch = 0;
+    d.outageHead = static_cast<uint8_t>((d.outageHead + 1) % OUTAGE_HISTORY);
+    if (d.outageCount < OUTAGE_HISTORY) ++d.outageCount;
+  } else if (!down && d.down && d.outageCount > 0) {
+    Outage& o = d.outages[(d.outageHead + OUTAGE_HISTORY - 1) % OUTAGE_HISTORY];
+    o.endEpoch = f.epoch ? f.epoch : static_cast<uint32_t>(nowSec);
+  }
+  d.down = down;
+  d.latest = f;
+  d.lastSeenSec = nowSec;
+  ++d.frames;
+}
+
+static void ingestEvent(const TelemetryEvent& e, uint64_t nowSec) {
+  eventsById[e.msgId].fetch_add(1, std::memory_order_relaxed);
+  Shard& shard = shardFor(e.chipId);
+  std::lock_guard<std::mutex> lock(shard.mu);
+
+  bool isNew;
+  DeviceRecord& d = deviceFor(shard, e.chipId, &isNew);
+  noteSeq(d, e.seq, isNew);
+  d.lastEvent = e;
+  d.lastSeenSec = nowSec;
+  ++d.events;
+}
+
+static int openUdpReusePort(uint16_t port) {
+  const int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+  if (fd < 0) return -1;
+  const int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+  const int rcvbuf = 8 << 20;
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static void ingestThread(uint16_t port) {
+  const int fd = openUdpReusePort(port);
+  const int ep = epoll_create1(0);
+  if (fd < 0 || ep < 0) {
+    perror("ingest socket");
+    running = false;
+    return;
+  }
+  epoll_event ev = {};
+  ev.events = EPOLLIN;
+  ev.data.fd = fd;
+  epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev);
+
+  static thread_local uint8_t bufs[RECV_BATCH][128];
+  mmsghdr msgs[RECV_BATCH];
+  iovec iovs[RECV_BATCH];
+  for (int i = 0; i < RECV_BATCH; ++i) {
+    iovs[i] = { bufs[i], sizeof(bufs[i]) };
+    msgs[i] = {};
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  while (running) {
+    epoll_event events[1];
+    if (epoll_wait(ep, events, 1, 200) <= 0) continue;
+
+    for (;;) {
+      const int n = recvmmsg(fd, msgs, RECV_BATCH, MSG_DONTWAIT, nullptr);
+      if (n <= 0) break;
+      const uint64_t nowSec = static_cast<uint64_t>(time(nullptr));
+      uint64_t good = 0, events = 0;
+      for (int i = 0; i < n; ++i) {
+        TelemetryFrame f;
+        TelemetryEvent e;
+        if (telemetryDecode(bufs[i], msgs[i].msg_len, &f)) {
+          ingestFrame(f, nowSec);
+          ++good;
+        } else if (telemetryEventDecode(bufs[i], msgs[i].msg_len, &e)) {
+          ingestEvent(e, nowSec);
+          ++good;
+          ++events;
+        } else {
+          framesBad.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      framesTotal.fetch_add(good, std::memory_order_relaxed);
+      eventsTotal.fetch_add(events, std::memory_order_relaxed);
+    }
+  }
+  close(ep);
+  close(fd);
+}
+
+// ----------------------------
+// Interogări
+// ----------------------------
+static void appendf(std::string& out, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+static void appendf(std::string& out, const char* fmt, ...) {
+  char line[512];
+  va_list ap;
+  va_start(ap, fmt);
+  const int n = vsnprintf(line, sizeof(line), fmt, ap);
+  va_end(ap);
+  if (n > 0) out.append(line, std::min<size_t>(static_cast<size_t>(n), sizeof(line) - 1));
+}
+
+static std::atomic<double> ingestRate{ 0.0 };
+
+static void queryStats(std::string& out) {
+  size_t devices = 0;
+  uint64_t lost = 0;
+  for (Shard& shard : shards) {
+    std::lock_guard<std::mutex> lock(shard.mu);
+    devices += shard.devices.size();
+    for (const auto& kv : shard.devices) lost += kv.second.lost;
+  }
+  appendf(out, "devices=%zu frames=%llu events=%llu bad=%llu lost=%llu rate=%.0f/s\n", devices,
+          static_cast<unsigned long long>(framesTotal.load()), static_cast<unsigned long long>(eventsTotal.load()),
+          static_cast<unsigned long long>(framesBad.load()), static_cast<unsigned long long>(lost), ingestRate.load());
+}
+
+static void queryEvents(std::string& out) {
+  for (uint16_t id = 0; id < MSG_COUNT; ++id) {
+    const uint64_t n = eventsById[id].load(std::memory_order_relaxed);
+    if (n != 0) appendf(out, "%s %llu\n", MSG_NAMES[id], static_cast<unsigned long long>(n));
+  }
+}
+
+// Ultimul eveniment, refăcut ca text (EN) din ID și argumente.
+static void formatEvent(const TelemetryEvent& e, char* out, size_t outSize) {
+  MsgArg args[TELEMETRY_EVENT_MAX_ARGS] = { 0, 0, 0, 0 };
+  const size_t count = telemetryEventArgs(e, args);
+  msgRender(out, outSize, msgText(MsgLang::EN, static_cast<Msg>(e.msgId)), args, count);
+}
+
+static void queryCyclesGreaterThan(std::string& out, uint32_t n) {
+  const uint32_t today = utcDay(static_cast<uint64_t>(time(nullptr)));
+  for (Shard& shard : shards) {
+    std::lock_guard<std::mutex> lock(shard.mu);
+    for (const auto& kv : shard.devices) {
+      const DeviceRecord& d = kv.second;
+      if (d.day == today && d.cyclesToday > n) {
+        appendf(out, "%08x %u\n", kv.first, d.cyclesToday);
+      }
+    }
+  }
+}
+
+static void queryDown(std::string& out) {
+  for (Shard& shard : shards) {
+    std::lock_guard<std::mutex> lock(shard.mu);
+    for (const auto& kv : shard.devices) {
+      if (kv.second.down) appendf(out, "%08x since=%u\n", kv.first, kv.second.latest.lastOutageEpoch);
+    }
+  }
+}
+
+static void queryDevice(std::string& out, uint32_t chipId, bool outages) {
+  Shard& shard = shardFor(chipId);
+  std::lock_guard<std::mutex> lock(shard.mu);
+  auto it = shard.devices.find(chipId);
+  if (it == shard.devices.end()) {
+    out += "ERR unknown device\n";
+    return;
+  }
+  const DeviceRecord& d = it->second;
+  if (!outages) {
+    const TelemetryFrame& f = d.latest;
+    appendf(out, "chip=%08x seq=%u up=%u alarm=%u flags=0x%02x rssi=%d rtt=%u pings=%u relayCycles=%u today=%u heap=%u frames=%llu lost=%llu\n",
+            f.chipId, f.seq, f.uptimeSec, f.alarmState, f.flags, f.rssi, f.lastPingRttMs, f.pingCounter,
+            f.relayActivationCount, d.cyclesToday, f.freeHeap, static_cast<unsigned long long>(d.frames),
+            static_cast<unsigned long long>(d.lost));
+    if (d.events != 0) {
+      char text[128];
+      formatEvent(d.lastEvent, text, sizeof(text));
+      appendf(out, "events=%llu last=%s seq=%u up=%u \"%s\"\n", static_cast<unsigned long long>(d.events), MSG_NAMES[d.lastEvent.msgId],
+              d.lastEvent.seq, d.lastEvent.uptimeSec, text);
+    }
+    return;
+  }
+  for (uint8_t i = 0; i < d.outageCount; ++i) {
+    const Outage& o = d.outages[(d.outageHead + OUTAGE_HISTORY - d.outageCount + i) % OUTAGE_HISTORY];
+    appendf(out, "start=%u end=%u\n", o.startEpoch, o.endEpoch);
+  }
+}
+
+static void handleQuery(const std::string& line, std::string& out) {
+  char cmd[32] = {};
+  char arg[32] = {};
+  sscanf(line.c_str(), "%31s %31s", cmd, arg);
+  if (strcmp(cmd, "STATS") == 0) {
+    queryStats(out);
+  } else if (strcmp(cmd, "EVENTS") == 0) {
+    queryEvents(out);
+  } else if (strcmp(cmd, "CYCLES_GT") == 0) {
+    queryCyclesGreaterThan(out, static_cast<uint32_t>(strtoul(arg, nullptr, 10)));
+  } else if (strcmp(cmd, "DEVICE") == 0 || strcmp(cmd, "OUTAGES") == 0) {
+    queryDevice(out, static_cast<uint32_t>(strtoul(arg, nullptr, 16)), cmd[0] == 'O');
+  } else if (strcmp(cmd, "DOWN") == 0) {
+    queryDown(out);
+  } else {
+    out += "ERR commands: STATS, EVENTS, CYCLES_GT <n>, DEVICE <chip>, OUTAGES <chip>, DOWN\n";
+  }
+  out += ".\n";
+}
+
+static void queryThread(uint16_t port) {
+  const int lfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  const int one = 1;
+  setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(lfd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(lfd, 64) != 0) {
+    perror("query socket");
+    running = false;
+    return;
+  }
+
+  const int ep = epoll_create1(0);
+  epoll_event ev = {};
+  ev.events = EPOLLIN;
+  ev.data.fd = lfd;
+  epoll_ctl(ep, EPOLL_CTL_ADD, lfd, &ev);
+  std::unordered_map<int, std::string> rx;
+
+  while (running) {
+    epoll_event events[32];
+    const int n = epoll_wait(ep, events, 32, 200);
+    for (int i = 0; i < n; ++i) {
+      const int fd = events[i].data.fd;
+      if (fd == lfd) {
+        int cfd;
+        while ((cfd = accept4(lfd, nullptr, nullptr, SOCK_NONBLOCK)) >= 0) {
+          epoll_event cev = {};
+          cev.events = EPOLLIN | EPOLLRDHUP;
+          cev.data.fd = cfd;
+          epoll_ctl(ep, EPOLL_CTL_ADD, cfd, &cev);
+          rx[cfd].clear();
+        }
+        continue;
+      }
+
+      char buf[1024];
+      const ssize_t got = read(fd, buf, sizeof(buf));
+      if (got <= 0) {
+        epoll_ctl(ep, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        rx.erase(fd);
+        continue;
+      }
+      std::string& pending = rx[fd];
+      pending.append(buf, static_cast<size_t>(got));
+      size_t eol;
+      while ((eol = pending.find('\n')) != std::string::npos) {
+        std::string out;
+        handleQuery(pending.substr(0, eol), out);
+        pending.erase(0, eol + 1);
+        // răspunsurile sunt mici; un client care nu citește pierde conexiunea
+        if (write(fd, out.data(), out.size()) != static_cast<ssize_t>(out.size())) break;
+      }
+    }
+  }
+  close(ep);
+  close(lfd);
+}
+
+static void onSignal(int) {
+  running = false;
+}
+
+int main(int argc, char** argv) {
+  const uint16_t udpPort = static_cast<uint16_t>(argc > 1 ? atoi(argv[1]) : 5140);
+  const uint16_t queryPort = static_cast<uint16_t>(argc > 2 ? atoi(argv[2]) : 5141);
+  const unsigned threads = argc > 3 ? static_cast<unsigned>(atoi(argv[3])) : std::max(1u, std::thread::hardware_concurrency());
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < threads; ++i) {
+    workers.emplace_back(ingestThread, udpPort);
+  }
+  std::thread query(queryThread, queryPort);
+  printf("fleet_collector: udp=%u query=%u threads=%u\n", udpPort, queryPort, threads);
+
+  // raport periodic al ratei de ingest
+  uint64_t lastFrames = 0;
+  auto lastTime = std::chrono::steady_clock::now();
+  while (running) {
+    std::this_thread::sleep_for(std::chrono::seconds(5));
+    const auto now = std::chrono::steady_clock::now();
+    const uint64_t frames = framesTotal.load();
+    ingestRate = static_cast<double>(frames - lastFrames) / std::chrono::duration<double>(now - lastTime).count();
+    lastFrames = frames;
+    lastTime = now;
+    std::string line;
+    queryStats(line);
+    fputs(line.c_str(), stdout);
+    fflush(stdout);
+  }
+
+  for (auto& t : workers) t.join();
+  query.join();
+  return 0;
+}
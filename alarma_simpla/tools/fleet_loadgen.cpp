@@ -0,0 +1,292 @@
+// fleet_loadgen.cpp — generator de încărcare pentru fleet_collector (Linux)
+//
+// Build:
+//   g++ -O2 -std=c++17 -pthread -I../include fleet_loadgen.cpp -o fleet_loadgen
+//
+// Utilizare:
+//   ./fleet_loadgen [host=127.0.0.1] [udpPort=5140] [devices=10000] [seconds=10] [queryPort=5141] [threads=4]
+//
+// Simulează `devices` plăci care trimit TelemetryFrame cât de repede permite
+// socket-ul (sendmmsg), cu întreruperi și power-cycle-uri aleatoare. Ca
+// firmware-ul, fiecare schimbare trimite și cadre TelemetryEvent (același seq):
+// internet_DOWN + relay_1_ACTIVATED la început de întrerupere, schimbări de
+// stare a alarmei (cu argumente). În paralel măsoară latența interogărilor TCP
+// (STATS / CYCLES_GT / DEVICE / EVENTS) și afișează rata de trimitere +
+// percentilele latenței; la final compară evenimentele trimise, pe ID, cu
+// răspunsul EVENTS al colectorului (UDP poate pierde, dar nu poate inventa).
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "telemetry_frame.h"
+
+static const int SEND_BATCH = 64;
+
+struct SimDevice {
+  uint32_t chipId;
+  uint32_t seq;
+  uint32_t relayCount;
+  uint32_t pingCounter;
+  bool down;
+  uint8_t alarmState;     // index în ALARM_STATES
+  uint8_t pendingEvents;  // cadre de eveniment de trimis înaintea următorului status
+};
+
+static std::atomic<bool> running{ true };
+static std::atomic<uint64_t> framesSent{ 0 };
+static std::atomic<uint64_t> eventsSent[MSG_COUNT];
+
+#define MSG_NAME_ENTRY(id, ro, en) #id,
+static const char* const MSG_NAMES[MSG_COUNT] = { MESSAGE_CATALOG(MSG_NAME_ENTRY) };
+#undef MSG_NAME_ENTRY
+
+static const char* const ALARM_STATES[] = { "ARMED", "ENTRY_DELAY", "ALARMING", "DISARMED" };
+
+// Un cadru de eveniment, ca logEvent(id, args...) din firmware.
+template <typename... Args>
+static void encodeEvent(uint8_t* out, const SimDevice& d, uint32_t seq, uint32_t now, Msg id, const Args&... args) {
+  const MsgArg argv[sizeof...(Args) + 1] = { MsgArg(args)..., MsgArg(0) };
+  TelemetryEvent e = {};
+  e.seq = seq;
+  e.chipId = d.chipId;
+  e.uptimeSec = d.pingCounter;
+  e.epoch = now;
+  e.msgId = static_cast<uint16_t>(id);
+  e.severity = 5;
+  telemetryEventSetArgs(&e, argv, sizeof...(Args));
+  telemetryEventEncode(e, out);
+}
+
+static void senderThread(sockaddr_in dst, uint32_t firstDevice, uint32_t deviceCount, uint32_t seed) {
+  const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  const int sndbuf = 4 << 20;
+  setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+  connect(fd, reinterpret_cast<sockaddr*>(&dst), sizeof(dst));
+
+  std::vector<SimDevice> devices(deviceCount);
+  for (uint32_t i = 0; i < deviceCount; ++i) {
+    devices[i] = { 0x100000u + firstDevice + i, 0, 0, 0, false, 0, 0 };
+  }
+
+  std::mt19937 rng(seed);
+  uint8_t bufs[SEND_BATCH][TELEMETRY_FRAME_SIZE];
+  mmsghdr msgs[SEND_BATCH];
+  iovec iovs[SEND_BATCH];
+  for (int i = 0; i < SEND_BATCH; ++i) {
+    iovs[i] = { bufs[i], TELEMETRY_FRAME_SIZE };
+    msgs[i] = {};
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  uint32_t next = 0;
+  uint64_t localEvents[MSG_COUNT] = {};
+  while (running) {
+    const uint32_t now = static_cast<uint32_t>(time(nullptr));
+    for (int b = 0; b < SEND_BATCH; ++b) {
+      SimDevice& d = devices[next];
+
+      // ~1/2000 cadre: începe/se termină o întrerupere; la început, un power-cycle
+      // ~1/500: alarma își schimbă starea. Evenimentele iau locul cadrului de status.
+      const uint32_t r = rng();
+      if (d.pendingEvents == 0 && (r % 2000) == 0) {
+        d.down = !d.down;
+        if (d.down) {
+          ++d.relayCount;
+          d.pendingEvents = 2;
+        }
+      } else if (d.pendingEvents == 0 && (r % 500) == 1) {
+        d.alarmState = static_cast<uint8_t>((d.alarmState + 1) % 4);
+        d.pendingEvents = 3;
+      }
+      if (d.pendingEvents != 0) {
+        Msg id;
+        if (d.pendingEvents == 2) {
+          id = Msg::EVT_INTERNET_DOWN;
+          encodeEvent(bufs[b], d, d.seq++, now, id);
+        } else if (d.pendingEvents == 1) {
+          id = Msg::EVT_RELAY_ACTIVATED;
+          encodeEvent(bufs[b], d, d.seq++, now, id);
+        } else {
+          id = Msg::EVT_ALARM_STATE;
+          encodeEvent(bufs[b], d, d.seq++, now, id, ALARM_STATES[d.alarmState], 1u);
+        }
+        d.pendingEvents = d.pendingEvents == 3 ? 0 : static_cast<uint8_t>(d.pendingEvents - 1);
+        ++localEvents[static_cast<uint16_t>(id)];
+        continue;
+      }
+      next = (next + 1) % deviceCount;
+      ++d.pingCounter;
+
+      TelemetryFrame f = {};
+      f.seq = d.seq++;
+      f.chipId = d.chipId;
+      f.uptimeSec = d.pingCounter;
+      f.epoch = now;
+      f.lastOutageEpoch = d.down ? now : 0;
+      f.pingCounter = d.pingCounter;
+      f.relayActivationCount = d.relayCount;
+      f.freeHeap = 40000 + (r & 0x3FF);
+      f.maxFreeBlock = 30000;
+      f.alarmState = 2;
+      f.flags = d.down ? (TELEMETRY_FLAG_PING_DOWN | TELEMETRY_FLAG_INTERNET_CUT) : TELEMETRY_FLAG_WIFI_CONNECTED;
+      f.rssi = static_cast<int8_t>(-50 - static_cast<int>(r % 40));
+      f.lastPingRttMs = static_cast<uint16_t>(10 + (r >> 8) % 90);
+      telemetryEncode(f, bufs[b]);
+    }
+    const int sent = sendmmsg(fd, msgs, SEND_BATCH, 0);
+    if (sent > 0) framesSent.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+  }
+  for (uint16_t id = 0; id < MSG_COUNT; ++id) eventsSent[id].fetch_add(localEvents[id], std::memory_order_relaxed);
+  close(fd);
+}
+
+static bool queryOnce(int fd, const char* cmd, std::string& reply) {
+  const size_t len = strlen(cmd);
+  if (write(fd, cmd, len) != static_cast<ssize_t>(len)) return false;
+  reply.clear();
+  char buf[4096];
+  while (reply.size() < 2 || reply.compare(reply.size() - 2, 2, ".\n") != 0) {
+    const ssize_t n = read(fd, buf, sizeof(buf));
+    if (n <= 0) return false;
+    reply.append(buf, static_cast<size_t>(n));
+  }
+  return true;
+}
+
+static void queryThread(sockaddr_in dst, std::vector<double>* latenciesUs) {
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (connect(fd, reinterpret_cast<sockaddr*>(&dst), sizeof(dst)) != 0) {
+    perror("query connect");
+    return;
+  }
+  const int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  static const char* const QUERIES[] = { "STATS\n", "CYCLES_GT 3\n", "DEVICE 100007\n", "OUTAGES 100007\n", "EVENTS\n" };
+  static const uint32_t QUERY_COUNT = sizeof(QUERIES) / sizeof(QUERIES[0]);
+  std::string reply;
+  uint32_t i = 0;
+  while (running) {
+    const auto t0 = std::chrono::steady_clock::now();
+    if (!queryOnce(fd, QUERIES[i++ % QUERY_COUNT], reply)) break;
+    const auto t1 = std::chrono::steady_clock::now();
+    latenciesUs->push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  close(fd);
+}
+
+// Răspunsul EVENTS al colectorului ("EVT_ALARM_STATE 12" pe linie) în counts[id].
+static bool queryEventCounts(sockaddr_in dst, uint64_t* counts) {
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (connect(fd, reinterpret_cast<sockaddr*>(&dst), sizeof(dst)) != 0) {
+    close(fd);
+    return false;
+  }
+  std::string reply;
+  const bool ok = queryOnce(fd, "EVENTS\n", reply);
+  close(fd);
+  if (!ok) return false;
+  for (uint16_t id = 0; id < MSG_COUNT; ++id) counts[id] = 0;
+  size_t pos = 0;
+  while (pos < reply.size()) {
+    const size_t eol = reply.find('\n', pos);
+    const std::string line = reply.substr(pos, eol - pos);
+    pos = eol == std::string::npos ? reply.size() : eol + 1;
+    const size_t space = line.find(' ');
+    if (space == std::string::npos) continue;
+    for (uint16_t id = 0; id < MSG_COUNT; ++id) {
+      if (line.compare(0, space, MSG_NAMES[id]) == 0) counts[id] = strtoull(line.c_str() + space + 1, nullptr, 10);
+    }
+  }
+  return true;
+}
+
+static double percentile(std::vector<double>& v, double p) {
+  if (v.empty()) return 0.0;
+  const size_t idx = std::min(v.size() - 1, static_cast<size_t>(p * static_cast<double>(v.size())));
+  std::nth_element(v.begin(), v.begin() + static_cast<long>(idx), v.end());
+  return v[idx];
+}
+
+int main(int argc, char** argv) {
+  const char* host = argc > 1 ? argv[1] : "127.0.0.1";
+  const uint16_t udpPort = static_cast<uint16_t>(argc > 2 ? atoi(argv[2]) : 5140);
+  const uint32_t devices = argc > 3 ? static_cast<uint32_t>(atoi(argv[3])) : 10000;
+  const int seconds = argc > 4 ? atoi(argv[4]) : 10;
+  const uint16_t queryPort = static_cast<uint16_t>(argc > 5 ? atoi(argv[5]) : 5141);
+  const uint32_t threads = std::max(1u, std::min(devices, argc > 6 ? static_cast<uint32_t>(atoi(argv[6])) : 4u));
+
+  sockaddr_in udp = {};
+  udp.sin_family = AF_INET;
+  udp.sin_port = htons(udpPort);
+  inet_pton(AF_INET, host, &udp.sin_addr);
+  sockaddr_in tcp = udp;
+  tcp.sin_port = htons(queryPort);
+
+  // contoarele colectorului sunt cumulative: se compară doar creșterea din această rulare
+  static uint64_t eventsBefore[MSG_COUNT], eventsAfter[MSG_COUNT];
+  if (!queryEventCounts(tcp, eventsBefore)) {
+    fprintf(stderr, "collector query port %u not reachable\n", queryPort);
+    return 1;
+  }
+
+  std::vector<std::thread> senders;
+  const uint32_t perThread = devices / threads;
+  for (uint32_t t = 0; t < threads; ++t) {
+    const uint32_t count = (t == threads - 1) ? devices - perThread * t : perThread;
+    senders.emplace_back(senderThread, udp, perThread * t, count, 1234u + t);
+  }
+  std::vector<double> latencies;
+  std::thread query(queryThread, tcp, &latencies);
+
+  const auto start = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(std::chrono::seconds(seconds));
+  running = false;
+  for (auto& t : senders) t.join();
+  query.join();
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  printf("devices=%u threads=%u sent=%llu rate=%.0f frames/s\n", devices, threads,
+         static_cast<unsigned long long>(framesSent.load()), static_cast<double>(framesSent.load()) / elapsed);
+  printf("query latency: n=%zu p50=%.0f us p99=%.0f us max=%.0f us\n", latencies.size(),
+         percentile(latencies, 0.50), percentile(latencies, 0.99), percentile(latencies, 1.0));
+
+  // evenimentele: trimise vs numărate de colector (după ce își golește socket-urile)
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  if (!queryEventCounts(tcp, eventsAfter)) {
+    fprintf(stderr, "collector query port %u not reachable\n", queryPort);
+    return 1;
+  }
+  bool ok = true;
+  uint64_t sentTotal = 0, receivedTotal = 0;
+  for (uint16_t id = 0; id < MSG_COUNT; ++id) {
+    const uint64_t sent = eventsSent[id].load();
+    const uint64_t received = eventsAfter[id] - eventsBefore[id];
+    if (sent == 0 && received == 0) continue;
+    printf("event %-22s sent=%llu collector=%llu\n", MSG_NAMES[id], static_cast<unsigned long long>(sent), static_cast<unsigned long long>(received));
+    sentTotal += sent;
+    receivedTotal += received;
+    ok = ok && received <= sent;
+  }
+  ok = ok && (sentTotal == 0 || receivedTotal != 0);
+  printf("events: sent=%llu collector=%llu (%.2f%% delivered) %s\n", static_cast<unsigned long long>(sentTotal),
+         static_cast<unsigned long long>(receivedTotal), sentTotal ? 100.0 * static_cast<double>(receivedTotal) / static_cast<double>(sentTotal) : 100.0,
+         ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
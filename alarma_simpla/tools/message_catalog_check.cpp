@@ -0,0 +1,229 @@
+// message_catalog_check.cpp — verificare host pentru catalogul de mesaje (include/messages.h)
+//
+// Build:
+//   g++ -O2 -std=c++17 -I../include message_catalog_check.cpp -o message_catalog_check
+//
+// Utilizare:
+//   ./message_catalog_check            (verificare; cod de ieșire 0 = ok)
+//   ./message_catalog_check --list EN  (toate mesajele randate în limba dată)
+//
+// Pentru fiecare ID, textul RO randat cu argumente de exemplu trebuie să fie
+// identic cu ce afișa firmware-ul înainte de catalog (concatenarea print-urilor
+// din main.cpp, copiată mai jos). În plus: fiecare ID are un caz aici, EN are
+// aceleași argumente ca RO, iar evenimentele (EVT_*, EVENT_LINE) sunt identice
+// în ambele limbi, pentru serial_log_analyzer.
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "messages.h"
+
+struct Golden {
+  Msg id;
+  std::vector<MsgArg> args;
+  const char* expected;  // RO, exact ca înainte
+};
+
+static const std::vector<Golden>& goldenCases() {
+  static const std::vector<Golden> cases = {
+    { Msg::STATUS_BEGIN, { 7u }, "=====  7  ===== >>" },
+    { Msg::STATUS_END, { 7u }, "=====  7  =====  <<" },
+    { Msg::STATUS_ALARM_SECTION, {}, "🚨[ Stare alarmă]" },
+    { Msg::STATUS_ALARM, { "ARMED_AWAY" }, "Alarmă: ARMED_AWAY" },
+    { Msg::STATUS_PARTITION, { 1, "ENTRY_DELAY" }, "  P1: ENTRY_DELAY" },
+    { Msg::STATUS_PARTITION_TIMER, { -3 }, " (-3s)" },
+    { Msg::STATUS_TRIGGER_COUNT, { 12u }, "Alarme declanșate: 12" },
+    { Msg::STATUS_INTERNET_RELAY, { "INACTIVE" }, "Internet relay: INACTIVE" },
+    { Msg::STATUS_PING_DOWN, { "YES" }, "Ping down activ: YES" },
+    { Msg::STATUS_PING_DOWN_START, { "NO_REAL_TIME" }, "Ping down start: NO_REAL_TIME" },
+    { Msg::STATUS_WIFI_SECTION, {}, "[🌐 Rețea WiFi]" },
+    { Msg::STATUS_WIFI, { "CONNECTED" }, "Status WiFi: CONNECTED" },
+    { Msg::STATUS_WIFI_EMULATION, { "OFF" }, "WiFi emulation: OFF" },
+    { Msg::STATUS_IP, { "192.168.1.42" }, "IP local: 192.168.1.42" },
+    { Msg::STATUS_GATEWAY, { "-" }, "Gateway: -" },
+    { Msg::STATUS_DNS, { "192.168.1.1" }, "DNS: 192.168.1.1" },
+    { Msg::STATUS_RSSI, { -67 }, "rssi=-67" },
+    { Msg::STATUS_SSID, { "TP-Link_583B", 6 }, "SSID: TP-Link_583B ch=6" },
+    { Msg::STATUS_LAST_CONNECT, { "fast", 312u, 845u }, "Last connect: fast assoc=312 ms ip=845 ms" },
+    { Msg::STATUS_INTERNET_SECTION, {}, "[🌍 Conectivitate Internet]" },
+    { Msg::STATUS_LAST_DISCONNECT, { "19/10/2026 08:15:02" }, "Ultima deconectare: 19/10/2026 08:15:02" },
+    { Msg::STATUS_WIFI_DOWN_FOR, { "0:00:00" }, "WiFi disconnected since: 0:00:00" },
+    { Msg::STATUS_PING_COUNTER, { 4096u }, "Ping counter: 4096" },
+    { Msg::STATUS_PING_INTERVAL, { 60000u, 60u }, "Ping interval: 60000 ms (60 sec)" },
+    { Msg::STATUS_SYSTEM_SECTION, {}, "System ::" },
+    { Msg::STATUS_NTP_STARTED, { "YES" }, "NTP started: YES" },
+    { Msg::STATUS_NTP_READY, { "NO" }, "NTP ready: NO" },
+    { Msg::STATUS_FREE_HEAP, { 41234u }, "Free heap: 41234" },
+    { Msg::STATUS_CHIP_ID, { 0xA1B2C3u }, "Chip ID: A1B2C3" },
+    { Msg::STATUS_UPTIME, { "1d 02:03:04" }, "Uptime: 1d 02:03:04" },
+    { Msg::BOOT_RULE, {}, "[BOOT] ===========================================" },
+    { Msg::BOOT_BUILD, { "Oct 19 2026", "10:00:00" }, "[BOOT] FW build: Oct 19 2026 10:00:00" },
+    { Msg::BOOT_CHIP_ID, { 0xA1B2C3u }, "[BOOT] Chip ID: 0xA1B2C3" },
+    { Msg::BOOT_CPU_FREQ, { 80 }, "[BOOT] CPU freq (MHz): 80" },
+    { Msg::BOOT_FREE_HEAP, { 50000u }, "[BOOT] Free heap: 50000" },
+    { Msg::BOOT_RESET_REASON, { "Power On" }, "[BOOT] Reset reason: Power On" },
+    { Msg::BOOT_RESTORE_US, { 91234u }, "[BOOT] Reset -> alarm state restored (us): 91234" },
+    { Msg::BOOT_WIFI_NETWORKS, {}, "[BOOT] WiFi networks: " },
+    { Msg::BOOT_WIFI_CACHE, { "-" }, "[BOOT] WiFi cache (RTC): -" },
+    { Msg::BOOT_RELAY_PIN, { 5 }, "[BOOT] Internet relay pin: GPIO5" },
+    { Msg::BOOT_RELAY_PULSE, { 10000u }, "[BOOT] Relay pulse (ms): 10000" },
+    { Msg::BOOT_WIFI_RETRY, { 60000u }, "[BOOT] WiFi retry trigger (ms): 60000" },
+    { Msg::BOOT_PING_INTERVAL, { 60000u }, "[BOOT] Ping interval normal (ms): 60000" },
+    { Msg::BOOT_STATUS_INTERVAL, { 30000u }, "[BOOT] Status auto interval (ms): 30000" },
+    { Msg::CMD_INVALID_PARTITION, { "ARM" }, "UART CMD: ARM -> invalid partition" },
+    { Msg::CMD_DONE, { "STATUS" }, "UART CMD: STATUS -> OK" },
+    { Msg::CMD_IGNORED, { "DISARM" }, "UART CMD: DISARM -> ignored in current state" },
+    { Msg::CMD_PINGNOW, {}, "UART CMD: PINGNOW" },
+    { Msg::CMD_WIFI_OFF, {}, "UART CMD: EMULATE_WIFI_OFF -> WiFi forced DISCONNECTED" },
+    { Msg::CMD_WIFI_OFF_RELAY, {}, "UART CMD: relay INTERNET ON immediately" },
+    { Msg::CMD_WIFI_ON, {}, "UART CMD: EMULATE_WIFI_ON -> WiFi emulation disabled" },
+    { Msg::CMD_WIFI_ON_RELAY, {}, "UART CMD: relay INTERNET forced INACTIVE" },
+    { Msg::CMD_OTA_STARTED, {}, "UART CMD: OTA -> download started" },
+    { Msg::CMD_OTA_FAILED, {}, "UART CMD: OTA -> failed to start" },
+    { Msg::CMD_TELEMETRY, { 10000u }, "UART CMD: TELEMETRY -> interval (ms): 10000" },
+    { Msg::CMD_TRACE_SAVE, {}, "UART CMD: TRACE SAVE -> at end of loop" },
+    // LANG, HTTPSNOW, STATUS FULL|DELTA, TSDB, FAULT și LOGIN sunt comenzi noi: singura diferență față de HELP-ul de dinainte
+    { Msg::CMD_HELP, {},
+      "UART commands: ARM [p], STAY [p], DISARM [p], STATUS [FULL|DELTA], PINGNOW, EMULATE_WIFI_OFF, EMULATE_WIFI_ON, OTA [url], TELEMETRY <sec>, "
+      "TRACE DUMP|SAVED|SAVE, LANG RO|EN, HTTPSNOW, TSDB [h|from to|FLUSH], FAULT [NAME value [sec]|SEED n|CLEAR], LOGIN <token>, HELP" },
+    { Msg::CMD_UNKNOWN, { "FOO" }, "UART CMD unknown: FOO" },
+    { Msg::CMD_TRY_HELP, {}, "Try: HELP" },
+    { Msg::CMD_LANG, { "EN" }, "UART CMD: LANG -> EN" },
+    { Msg::CMD_LANG_INVALID, {}, "UART CMD: LANG -> folosește RO sau EN" },
+    { Msg::EVENT_LINE, { "relay_1_ACTIVATED", "19/10/2026 08:15:02" }, "[ EVENT= relay_1_ACTIVATED] :    19/10/2026 08:15:02" },
+    { Msg::EVT_ALARM_STATE, { "ALARMING", 2 }, "Alarm state -> ALARMING (P2)" },
+    { Msg::EVT_WIFI_EMULATION_CANCELED, {}, "EMULATE_WIFI_OFF canceled -> REAL_WIFI_CONNECTED" },
+    { Msg::EVT_WIFI_CONNECTED, {}, "WiFi connect success" },
+    { Msg::EVT_WIFI_EMULATION_FORCED, {}, "WiFi emulation active -> forcing DISCONNECTED state" },
+    { Msg::EVT_WIFI_CONNECT_FAILED, {}, "WiFi connect failed" },
+    { Msg::EVT_INTERNET_DOWN, {}, "internet_DOWN_detected" },
+    { Msg::EVT_WIFI_DOWN, {}, "WiFi transition: CONNECTED -> DISCONNECTED" },
+    { Msg::EVT_WIFI_UP, {}, "WiFi transition: DISCONNECTED -> CONNECTED" },
+    { Msg::EVT_RELAY_ACTIVATED, {}, "relay_1_ACTIVATED" },
+    { Msg::EVT_RELAY_DEACTIVATED, {}, "relay_1_DEACTIVATED" },
+    { Msg::EVT_RELAY_FORCED_INACTIVE, {}, "relay_1_FORCED_INACTIVE_wifi_connected" },
+    { Msg::EVT_CMD_WIFI_OFF, {}, "UART command: EMULATE_WIFI_OFF (relay ON immediate)" },
+    { Msg::EVT_CMD_WIFI_ON, {}, "UART command: EMULATE_WIFI_ON" },
+    { Msg::EVT_OTA_STARTED, {}, "OTA_STARTED" },
+    { Msg::EVT_OTA_ROLLBACK_STARTED, {}, "OTA_ROLLBACK_STARTED" },
+    { Msg::EVT_OTA_ABORTED, {}, "OTA_ABORTED" },
+    { Msg::EVT_OTA_DONE, {}, "OTA_DONE -> reboot" },
+    { Msg::EVT_OTA_ROLLBACK_DONE, {}, "OTA_ROLLBACK_DONE -> reboot" },
+    { Msg::EVT_OTA_CONFIRMED, {}, "OTA image confirmed (health check OK)" },
+    { Msg::EVT_CONSOLE_CONNECTED, { 3 }, "Console client 3 connected" },
+    { Msg::EVT_CONSOLE_DISCONNECTED, { 1 }, "Console client 1 disconnected" },
+    { Msg::EVT_TRACE_SAVED, { "alarm" }, "trace saved (alarm)" },
+    { Msg::EVT_TRACE_FLUSH_FAILED, {}, "trace flush failed (LittleFS)" },
+    { Msg::EVT_SETUP_COMPLETE, {}, "Setup complete" },
+    { Msg::CMD_HTTPSNOW, { 204, 180u, "Mon, 19 Oct 2026 08:15:02 GMT" },
+      "UART CMD: HTTPSNOW -> HTTP 204, handshake 180 ms, Date: Mon, 19 Oct 2026 08:15:02 GMT" },
+    { Msg::CMD_STATUS_MODE, { "DELTA" }, "UART CMD: STATUS -> raport automat DELTA" },
+    { Msg::CMD_TSDB_FLUSH, { 42u }, "UART CMD: TSDB FLUSH -> 42 eșantioane scrise în flash" },
+    { Msg::CMD_TSDB_INVALID, {}, "UART CMD: TSDB -> folosește TSDB <ore> sau TSDB <de_la> <până_la> (epoch)" },
+    { Msg::EVT_POWER_CUT, { "MODEM", 3u }, "power_cycle MODEM -> OFF (#3)" },
+    { Msg::EVT_POWER_RESTORE, { "POE_SWITCH" }, "power_cycle POE_SWITCH -> ON" },
+    { Msg::EVT_POWER_SETTLED, { "ROUTER" }, "power_cycle ROUTER -> boot done, re-probing" },
+    { Msg::CMD_FAULT_DISABLED, {}, "UART CMD: FAULT -> injecția de defecte nu e compilată (FAULT_INJECTION_ENABLED în config.h)" },
+    { Msg::CMD_FAULT_INVALID, {}, "UART CMD: FAULT -> folosește FAULT <NUME> <valoare> [sec], FAULT SEED <n> sau FAULT CLEAR" },
+    { Msg::EVT_FAULT_ARMED, { "CLOCK_JUMP", -3600, 0u }, "fault_CLOCK_JUMP=-3600 for 0 s" },
+    { Msg::EVT_FAULT_RUN_END, { 600u }, "fault_run_end after 600 s" },
+    { Msg::EVT_PEER_ARM, { "STAY", 0xA1B2C3u }, "peer STAY from 0xA1B2C3" },
+    { Msg::EVT_PEER_ALARM, { 0xA1B2C3u, 5u }, "peer_alarm from 0xA1B2C3 (PIR mask 0x5)" },
+    { Msg::EVT_ZONE_BYPASSED, { 2, "STUCK" }, "zone 2 BYPASSED (STUCK)" },
+    { Msg::EVT_ZONE_RESTORED, { 2 }, "zone 2 restored" },
+    { Msg::EVT_BUTTON_GESTURE, { "...-", "ROUTER", 3 }, "button ...- -> ROUTER (lag 3 ms)" },
+    { Msg::CMD_UART_ONLY, { "DISARM" }, "UART CMD: DISARM -> doar pe UART" },
+    { Msg::CMD_LOGIN_REQUIRED, { "PINGNOW" }, "UART CMD: PINGNOW -> necesită LOGIN <token>" },
+    { Msg::CMD_LOGIN_OK, {}, "UART CMD: LOGIN -> OK" },
+    { Msg::CMD_LOGIN_DISABLED, {}, "UART CMD: LOGIN -> CONSOLE_TOKEN gol în config.h, consola TCP e doar citire" },
+    { Msg::EVT_CONSOLE_LOGIN, { 2u }, "Console client 2 logged in" },
+    { Msg::EVT_CONSOLE_LOGIN_FAILED, { 2u }, "Console client 2 login failed" },
+  };
+  return cases;
+}
+
+static const char* const MSG_NAMES[] = {
+#define MSG_NAME_ENTRY(id, ro, en) #id,
+  MESSAGE_CATALOG(MSG_NAME_ENTRY)
+#undef MSG_NAME_ENTRY
+};
+
+static std::string render(MsgLang lang, const Golden& g) {
+  char out[512];
+  msgRender(out, sizeof(out), msgText(lang, g.id), g.args.data(), g.args.size());
+  return out;
+}
+
+// Secvența de conversii (%s, %u, ...) dintr-un format.
+static std::string conversions(const char* fmt) {
+  std::string sig;
+  for (const char* p = fmt; *p != '\0'; ++p) {
+    if (*p != '%') continue;
+    if (*++p == '\0') break;
+    if (*p != '%') sig += *p;
+  }
+  return sig;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 2 && strcmp(argv[1], "--list") == 0) {
+    MsgLang lang;
+    if (!msgLangParse(argv[2], &lang)) {
+      fprintf(stderr, "unknown language '%s' (RO|EN)\n", argv[2]);
+      return 2;
+    }
+    for (const Golden& g : goldenCases()) {
+      printf("%-28s %s\n", MSG_NAMES[static_cast<uint16_t>(g.id)], render(lang, g).c_str());
+    }
+    return 0;
+  }
+
+  int failures = 0;
+  std::vector<int> covered(MSG_COUNT, 0);
+  for (const Golden& g : goldenCases()) {
+    const uint16_t i = static_cast<uint16_t>(g.id);
+    ++covered[i];
+    const std::string ro = render(MsgLang::RO, g);
+    if (ro != g.expected) {
+      printf("MISMATCH %s\n  expected: \"%s\"\n  rendered: \"%s\"\n", MSG_NAMES[i], g.expected, ro.c_str());
+      ++failures;
+    }
+  }
+
+  for (uint16_t i = 0; i < MSG_COUNT; ++i) {
+    const Msg id = static_cast<Msg>(i);
+    const char* ro = msgText(MsgLang::RO, id);
+    const char* en = msgText(MsgLang::EN, id);
+    if (covered[i] != 1) {
+      printf("%s: %d golden cases (expected exactly 1)\n", MSG_NAMES[i], covered[i]);
+      ++failures;
+    }
+    if (ro[0] == '\0' || en[0] == '\0') {
+      printf("%s: empty text\n", MSG_NAMES[i]);
+      ++failures;
+    }
+    if (conversions(ro) != conversions(en)) {
+      printf("%s: RO \"%s\" and EN \"%s\" take different arguments\n", MSG_NAMES[i], conversions(ro).c_str(), conversions(en).c_str());
+      ++failures;
+    }
+    const bool event = strncmp(MSG_NAMES[i], "EVT_", 4) == 0 || id == Msg::EVENT_LINE;
+    if (event && strcmp(ro, en) != 0) {
+      printf("%s: events must be identical in RO and EN (serial_log_analyzer)\n", MSG_NAMES[i]);
+      ++failures;
+    }
+  }
+
+  // trunchiere: ieșirea e mereu terminată și nu depășește bufferul
+  char small[8];
+  const size_t n = msgFormat(small, sizeof(small), MsgLang::RO, Msg::CMD_UNKNOWN, "X");
+  if (n != sizeof(small) - 1 || small[n] != '\0') {
+    printf("truncation: wrote %zu bytes into %zu\n", n, sizeof(small));
+    ++failures;
+  }
+
+  printf("%u messages, flash: RO %zu B + EN %zu B (RO = string literals moved out of DRAM)\n", MSG_COUNT, MSG_CATALOG_BYTES_RO,
+         MSG_CATALOG_BYTES_EN);
+  printf("%s\n", failures == 0 ? "all messages render as before" : "FAILED");
+  return failures == 0 ? 0 : 1;
+}
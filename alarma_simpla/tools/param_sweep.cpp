@@ -0,0 +1,596 @@
+// param_sweep.cpp — căutare pe grilă, pe toate nucleele, pentru timpii releului de internet, ai ping-ului și ai PIR-urilor, pe logica reală din include/
+//
+// Build:
+//   g++ -O2 -std=c++17 -pthread -I../include param_sweep.cpp -o param_sweep
+//
+// Utilizare:
+//   ./param_sweep [scenarii=128] [seed=1] [threads=nproc]
+//       Frontul Pareto pentru (reporniri inutile ale routerului, minute fără
+//       internet) și pentru (mișcări ratate, declanșări în plus), plus locul
+//       valorilor din firmware față de front.
+//   ./param_sweep bench [scenarii=64] [seed=1]
+//       Același sweep cu 1, 2, 4, ... thread-uri (până la nproc): scenarii/s,
+//       accelerarea față de un thread și verificarea că rezultatele sunt
+//       identice indiferent de numărul de thread-uri.
+//
+// Deciziile sunt codul din firmware, doar ceasul e virtual:
+//   - relay_scheduler.h cu RelayTimings (impuls, cooldown); holdoff-ul de la
+//     pornire = unlockMs, ca în setup();
+//   - ping-ul Google ca pingGoogleIfNeeded(): 10 s în primul minut, apoi
+//     intervalul din grilă; rezultatul merge în relayPingResult() și în ținta
+//     PUBLIC a watchdog-ului (power_watchdog.h, tabelele din main.cpp, impulsul
+//     routerului = impulsul releului);
+//   - PIR-urile prin alarmZonesStep() cu AlarmTimings::motionRetriggerMs.
+// Pas de 250 ms pentru rețea, 10 ms pentru PIR-uri.
+//
+// Corpusul e sintetic (același seed => același corpus): router blocat (fără
+// WiFi până la un impuls suficient de lung), WAN-ul routerului blocat (gateway-ul
+// răspunde, internetul nu), pană la ISP (trece singură, un ciclu doar o
+// lungește), WiFi căzut câteva secunde, placa pornind odată cu routerul după o
+// cădere de curent. Impulsul resetează routerul doar dacă ține mai mult decât
+// îl mai alimentează condensatoarele (2–16 s, pe scenariu). Urmele de pe placă
+// (/trace.bin) nu pot servi aici: WiFi-ul înregistrat conține deja efectul
+// impulsurilor date cu timpii vechi.
+//
+// Cele două subsisteme nu au parametri comuni: grila releului (impuls x cooldown
+// x holdoff x ping) și cea a PIR-urilor se evaluează separat; frontul pe toți
+// cei cinci parametri e produsul celor două fronturi.
+//
+// Work stealing: fiecare thread are coada lui de joburi (o combinație x un bloc
+// de scenarii), ia din capătul ei, iar când se golește fură din capătul opus al
+// altei cozi. Fiecare job are locul lui în tabelul de rezultate parțiale, deci
+// totalurile nu depind de ordinea execuției sau de numărul de thread-uri.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "alarm_fsm.h"
+#include "power_watchdog.h"
+#include "relay_scheduler.h"
+#include "relay_selftest.h"
+
+// Valorile din main.cpp
+static const uint32_t FIRMWARE_HOLDOFF_MS = 60'000;        // RELAY_STARTUP_HOLDOFF_MS
+static const uint32_t FIRMWARE_PING_INTERVAL_MS = 60'000;  // GOOGLE_PING_INTERVAL_MS
+static const uint32_t FIRMWARE_RETRIGGER_MS = 2'000;       // MOTION_RETRIGGER_MS
+static const uint32_t FAST_STARTUP_WINDOW_MS = 60'000;
+static const uint32_t FAST_STARTUP_PING_INTERVAL_MS = 10'000;
+static const uint32_t STARTUP_TEST_DURATION_MS = relaySelfTestDurationMs(1'000);
+
+enum : uint8_t { MODEM, ROUTER, POE_SWITCH, DEVICE_COUNT };
+enum : uint8_t { TARGET_GATEWAY, TARGET_PUBLIC, TARGET_COUNT };  // fără POWER_LAN_HOST_IP
+static const PowerTargetConfig TARGETS[TARGET_COUNT] = {
+  { "GATEWAY", powerDeviceBit(ROUTER), 3, 30'000 },
+  { "PUBLIC", powerDeviceBit(ROUTER) | powerDeviceBit(MODEM), 2, 0 },
+};
+static const AlarmZone ZONES[] = { { 0, ZoneType::INTERIOR }, { 0, ZoneType::INTERIOR }, { 0, ZoneType::INTERIOR }, { 0, ZoneType::ENTRY } };
+static const uint8_t ZONE_COUNT = 4;
+
+// Grila
+static const uint32_t GRID_PULSE_MS[] = { 3'000, 5'000, 10'000, 15'000, 30'000 };
+static const uint32_t GRID_COOLDOWN_MS[] = { 30'000, 60'000, 120'000, 300'000 };
+static const uint32_t GRID_HOLDOFF_MS[] = { 0, 30'000, 60'000, 120'000, 180'000 };
+static const uint32_t GRID_PING_MS[] = { 15'000, 30'000, 60'000, 120'000 };
+static const uint32_t GRID_RETRIGGER_MS[] = { 250, 500, 1'000, 2'000, 3'000, 5'000, 8'000 };
+
+template <typename T, size_t N>
+constexpr uint32_t countOf(const T (&)[N]) {
+  return N;
+}
+
+static const uint32_t RELAY_PASS_MS = 250;
+static const uint32_t OUTAGE_SCENARIO_MS = 2 * 3'600'000;
+static const uint32_t PIR_PASS_MS = 10;
+static const uint32_t MOTION_SCENARIO_MS = 10 * 60'000;
+static const uint32_t SCENARIOS_PER_JOB = 16;
+
+struct Rng {
+  uint32_t s;
+  uint32_t next() {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+  }
+  uint32_t below(uint32_t n) { return next() % n; }
+};
+
+// ----------------------------
+// Corpus
+// ----------------------------
+enum class Incident : uint8_t { ROUTER_FREEZE, WAN_HANG, ISP_OUTAGE, WIFI_GLITCH };
+
+struct OutageEvent {
+  Incident kind;
+  uint32_t atMs;
+  uint32_t durationMs;  // pana ISP / WiFi căzut; routerul blocat ține până la un impuls
+};
+
+struct OutageScenario {
+  bool coldStart;         // routerul pornește odată cu placa (revine curentul)
+  uint32_t routerBootMs;  // de la realimentare până emite WiFi
+  uint32_t minOffMs;      // impulsul minim care chiar repornește routerul
+  uint32_t assocMs;       // asociere + DHCP ale plăcii după ce routerul emite
+  uint8_t eventCount;
+  OutageEvent events[2];
+};
+
+static OutageScenario makeOutageScenario(Rng& rng) {
+  OutageScenario s = {};
+  s.coldStart = rng.below(100) < 40;
+  s.routerBootMs = 30'000 + rng.below(120'000);
+  s.minOffMs = 2'000 + rng.below(14'000);
+  s.assocMs = 2'000 + rng.below(6'000);
+  s.eventCount = static_cast<uint8_t>(1 + rng.below(2));
+  for (uint8_t i = 0; i < s.eventCount; ++i) {
+    OutageEvent& e = s.events[i];
+    const uint32_t k = rng.below(100);
+    e.kind = k < 30 ? Incident::ROUTER_FREEZE : k < 55 ? Incident::WAN_HANG : k < 80 ? Incident::ISP_OUTAGE : Incident::WIFI_GLITCH;
+    e.atMs = 5 * 60'000 + rng.below(70 * 60'000);
+    e.durationMs = e.kind == Incident::ISP_OUTAGE ? 30'000 + rng.below(30 * 60'000) : 1'000 + rng.below(20'000);
+  }
+  if (s.eventCount == 2 && s.events[1].atMs < s.events[0].atMs) std::swap(s.events[0], s.events[1]);
+  return s;
+}
+
+// Un PIR activ [startMs, endMs); episode = mișcarea reală căreia îi aparține, NOISE = zgomot.
+static const uint16_t NOISE = 0xFFFF;
+
+struct PirPulse {
+  uint32_t startMs;
+  uint32_t endMs;
+  uint16_t episode;
+};
+
+struct MotionScenario {
+  std::vector<PirPulse> pulses[ZONE_COUNT];
+  uint16_t episodes;
+};
+
+// Vizite (cam la 2 min) cu 1–4 mișcări pe aceeași zonă, la 0,5–12 s una de alta;
+// PIR-ul ține ieșirea activă 0,3–6 s. Zgomot: rafale de 1–5 vârfuri de 20–80 ms.
+static MotionScenario makeMotionScenario(Rng& rng) {
+  MotionScenario s;
+  s.episodes = 0;
+  for (uint8_t z = 0; z < ZONE_COUNT; ++z) {
+    std::vector<PirPulse> pulses;
+    for (uint32_t t = 10'000 + rng.below(120'000); t < MOTION_SCENARIO_MS - 60'000; t += 60'000 + rng.below(120'000)) {
+      uint32_t at = t;
+      for (uint32_t n = 1 + rng.below(4); n > 0; --n) {
+        const uint32_t len = 300 + rng.below(5'700);
+        pulses.push_back({ at, at + len, s.episodes++ });
+        at += len + 500 + rng.below(11'500);
+      }
+    }
+    for (uint32_t t = rng.below(180'000); t < MOTION_SCENARIO_MS - 2'000; t += 60'000 + rng.below(240'000)) {
+      uint32_t at = t;
+      for (uint32_t n = 1 + rng.below(5); n > 0; --n) {
+        const uint32_t len = 20 + rng.below(60);
+        pulses.push_back({ at, at + len, NOISE });
+        at += len + 50 + rng.below(300);
+      }
+    }
+    std::sort(pulses.begin(), pulses.end(), [](const PirPulse& a, const PirPulse& b) { return a.startMs < b.startMs; });
+    // suprapunerile (zgomot peste o mișcare) se taie: PIR-ul are o singură ieșire
+    for (size_t i = 1; i < pulses.size(); ++i) {
+      if (pulses[i].startMs < pulses[i - 1].endMs) pulses[i].startMs = pulses[i - 1].endMs;
+      if (pulses[i].endMs < pulses[i].startMs) pulses[i].endMs = pulses[i].startMs;
+    }
+    s.pulses[z] = std::move(pulses);
+  }
+  return s;
+}
+
+// ----------------------------
+// Router + WiFi + ping, pe o combinație
+// ----------------------------
+struct RelayParams {
+  uint32_t pulseMs;
+  uint32_t cooldownMs;
+  uint32_t holdoffMs;
+  uint32_t pingIntervalMs;
+};
+
+struct RelayScore {
+  uint64_t outageMs;         // casa fără internet (WiFi-ul routerului sau WAN-ul căzut)
+  uint32_t needlessReboots;  // routerul repornit deși nu era blocat
+  uint32_t reboots;
+  uint32_t unrecovered;      // scenarii terminate cu routerul încă blocat
+
+  void add(const RelayScore& o) {
+    outageMs += o.outageMs;
+    needlessReboots += o.needlessReboots;
+    reboots += o.reboots;
+    unrecovered += o.unrecovered;
+  }
+  bool operator==(const RelayScore& o) const { return outageMs == o.outageMs && needlessReboots == o.needlessReboots && reboots == o.reboots && unrecovered == o.unrecovered; }
+};
+
+static void runOutageScenario(const RelayParams& p, const OutageScenario& sc, RelayScore& score) {
+  const RelayTimings timings = { p.pulseMs, p.cooldownMs };
+  const PowerDeviceConfig devices[DEVICE_COUNT] = {
+    { "MODEM", POWER_WD_NONE, false, 10'000, 120'000, 30UL * 60'000 },
+    { "ROUTER", MODEM, true, p.pulseMs, 90'000, p.cooldownMs },
+    { "POE_SWITCH", ROUTER, false, 5'000, 45'000, 15UL * 60'000 },
+  };
+  PowerWatchdog watchdog;
+  watchdog.begin(devices, DEVICE_COUNT, TARGETS, TARGET_COUNT, 0);
+  RelayScheduler relay = {};
+  relay.unlockMs = STARTUP_TEST_DURATION_MS + p.holdoffMs;
+  relay.pingDelegated = true;
+  uint32_t lastPingMs = 0;
+
+  bool frozen = false, wanHung = false, rebooting = false, neededAtCut = false, cutWas = false, routerWifiWasDown = false;
+  uint32_t bootUntilMs = sc.coldStart ? sc.routerBootMs : 0;
+  uint32_t routerWifiSinceMs = 0, cutStartMs = 0, ispUntilMs = 0, glitchUntilMs = 0;
+  uint8_t nextEvent = 0;
+
+  for (uint32_t now = 0; now < OUTAGE_SCENARIO_MS; now += RELAY_PASS_MS) {
+    for (; nextEvent < sc.eventCount && sc.events[nextEvent].atMs <= now; ++nextEvent) {
+      const OutageEvent& e = sc.events[nextEvent];
+      switch (e.kind) {
+        case Incident::ROUTER_FREEZE: frozen = true; break;
+        case Incident::WAN_HANG: wanHung = true; break;
+        case Incident::ISP_OUTAGE: ispUntilMs = now + e.durationMs; break;
+        case Incident::WIFI_GLITCH: glitchUntilMs = now + e.durationMs; break;
+      }
+    }
+
+    // D2 din trecerea anterioară: routerul se stinge abia după minOffMs
+    if (relay.cutActive) {
+      if (!cutWas) {
+        cutStartMs = now;
+        neededAtCut = frozen || wanHung;
+      }
+      if (now - cutStartMs >= sc.minOffMs) rebooting = true;
+    } else if (cutWas && rebooting) {
+      rebooting = false;
+      frozen = false;
+      wanHung = false;
+      bootUntilMs = now + sc.routerBootMs;
+      ++score.reboots;
+      if (!neededAtCut) ++score.needlessReboots;
+    }
+    cutWas = relay.cutActive;
+
+    const bool routerWifi = !rebooting && !frozen && now >= bootUntilMs && now >= glitchUntilMs;
+    if (!routerWifi) {
+      routerWifiWasDown = true;
+    } else if (routerWifiWasDown) {
+      routerWifiWasDown = false;
+      routerWifiSinceMs = now;
+    }
+    const bool wifi = routerWifi && now - routerWifiSinceMs >= sc.assocMs;
+    const bool internet = routerWifi && !wanHung && now >= ispUntilMs;
+    if (!internet) score.outageMs += RELAY_PASS_MS;
+
+    // loop(): updateInternetRelay, pingGoogleIfNeeded, powerWatchdogStep
+    if (relayLoopStep(relay, now, wifi, timings) & RELAY_DECISION_ACTIVATED) watchdog.noteExternalCycle(ROUTER, now);
+    const uint32_t interval = now < FAST_STARTUP_WINDOW_MS ? FAST_STARTUP_PING_INTERVAL_MS : p.pingIntervalMs;
+    if (now - lastPingMs >= interval) {
+      lastPingMs = now;
+      const bool ok = wifi && internet;
+      relayPingResult(relay, now, ok, timings);
+      if (wifi) watchdog.probeResult(TARGET_PUBLIC, ok);
+    }
+    if (wifi) {
+      const uint8_t t = watchdog.dueProbe(now);
+      if (t != POWER_WD_NONE) watchdog.probeResult(t, true);  // cu WiFi, gateway-ul răspunde (și cu WAN-ul blocat)
+    }
+    const PowerAction a = watchdog.tick(now);
+    if (a.kind == PowerAction::CUT && a.device == ROUTER) relayActivate(relay, now, timings);
+  }
+  if (frozen || wanHung) ++score.unrecovered;
+}
+
+// ----------------------------
+// PIR-uri, pe o valoare a MOTION_RETRIGGER_MS
+// ----------------------------
+struct MotionScore {
+  uint32_t missed;  // mișcări reale fără nicio declanșare
+  uint32_t extra;   // declanșări peste una pe mișcare + cele din zgomot
+  uint32_t triggers;
+
+  void add(const MotionScore& o) {
+    missed += o.missed;
+    extra += o.extra;
+    triggers += o.triggers;
+  }
+  bool operator==(const MotionScore& o) const { return missed == o.missed && extra == o.extra && triggers == o.triggers; }
+};
+
+static void runMotionScenario(uint32_t retriggerMs, const MotionScenario& sc, MotionScore& score) {
+  const AlarmTimings timings = { 10'000, 15'000, 30'000, retriggerMs };
+  const AlarmPartition armed = { AlarmState::ARMED, AlarmState::ARMED, false, 0, 0 };
+  uint32_t lastMotionMs[ZONE_COUNT] = {};
+  size_t cursor[ZONE_COUNT] = {};
+  uint16_t current[ZONE_COUNT];
+  std::vector<uint8_t> hits(sc.episodes, 0);
+
+  for (uint32_t now = 0; now < MOTION_SCENARIO_MS; now += PIR_PASS_MS) {
+    uint8_t levels = 0;
+    for (uint8_t z = 0; z < ZONE_COUNT; ++z) {
+      const std::vector<PirPulse>& pulses = sc.pulses[z];
+      while (cursor[z] < pulses.size() && pulses[cursor[z]].endMs <= now) ++cursor[z];
+      if (cursor[z] < pulses.size() && pulses[cursor[z]].startMs <= now) {
+        levels |= static_cast<uint8_t>(1u << z);
+        current[z] = pulses[cursor[z]].episode;
+      }
+    }
+    // partiția stă armată: contează doar câte evenimente de mișcare ar ajunge la FSM
+    alarmZonesStep(ZONES, ZONE_COUNT, &armed, levels, lastMotionMs, now, timings, [&](uint8_t, AlarmEvent) {});
+    for (uint8_t z = 0; z < ZONE_COUNT; ++z) {
+      if (!(levels & (1u << z)) || lastMotionMs[z] != now) continue;
+      ++score.triggers;
+      if (current[z] == NOISE) {
+        ++score.extra;
+      } else if (hits[current[z]]++ != 0) {
+        ++score.extra;
+      }
+    }
+  }
+  for (uint8_t h : hits) {
+    if (h == 0) ++score.missed;
+  }
+}
+
+// ----------------------------
+// Work stealing
+// ----------------------------
+class WorkStealingPool {
+ public:
+  explicit WorkStealingPool(unsigned threads) : threads_(threads == 0 ? 1 : threads), queues_(new Queue[threads_]) {}
+
+  // fn(job) pentru job în [0, jobs); se întoarce după ce toate s-au terminat.
+  template <typename Fn>
+  void run(uint32_t jobs, Fn fn) {
+    for (unsigned i = 0; i < threads_; ++i) {
+      const uint32_t from = static_cast<uint32_t>(static_cast<uint64_t>(jobs) * i / threads_);
+      const uint32_t to = static_cast<uint32_t>(static_cast<uint64_t>(jobs) * (i + 1) / threads_);
+      for (uint32_t j = from; j < to; ++j) queues_[i].jobs.push_back(j);
+    }
+    auto worker = [&](unsigned self) {
+      uint32_t job;
+      while (popOwn(self, job) || steal(self, job)) fn(job);
+    };
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads_; ++i) workers.emplace_back(worker, i);
+    worker(0);
+    for (std::thread& t : workers) t.join();
+  }
+
+  unsigned threads() const { return threads_; }
+  uint64_t steals() const { return steals_.load(); }
+
+ private:
+  struct Queue {
+    std::mutex lock;
+    std::deque<uint32_t> jobs;
+  };
+
+  bool popOwn(unsigned self, uint32_t& job) {
+    Queue& q = queues_[self];
+    std::lock_guard<std::mutex> guard(q.lock);
+    if (q.jobs.empty()) return false;
+    job = q.jobs.back();
+    q.jobs.pop_back();
+    return true;
+  }
+
+  // Joburile nu nasc alte joburi: o tură fără nimic de furat înseamnă gata.
+  bool steal(unsigned self, uint32_t& job) {
+    for (unsigned k = 1; k < threads_; ++k) {
+      Queue& q = queues_[(self + k) % threads_];
+      std::lock_guard<std::mutex> guard(q.lock);
+      if (q.jobs.empty()) continue;
+      job = q.jobs.front();
+      q.jobs.pop_front();
+      steals_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+    return false;
+  }
+
+  const unsigned threads_;
+  std::unique_ptr<Queue[]> queues_;
+  std::atomic<uint64_t> steals_{ 0 };
+};
+
+// ----------------------------
+// Sweep
+// ----------------------------
+static std::vector<RelayParams> relayGrid() {
+  std::vector<RelayParams> grid;
+  for (uint32_t pulse : GRID_PULSE_MS) {
+    for (uint32_t cooldown : GRID_COOLDOWN_MS) {
+      for (uint32_t holdoff : GRID_HOLDOFF_MS) {
+        for (uint32_t ping : GRID_PING_MS) grid.push_back({ pulse, cooldown, holdoff, ping });
+      }
+    }
+  }
+  return grid;
+}
+
+struct SweepResult {
+  std::vector<RelayScore> relay;
+  std::vector<MotionScore> motion;
+  double relaySeconds;
+  double motionSeconds;
+  uint64_t steals;
+};
+
+template <typename Score, typename Scenario, typename Param, typename RunFn>
+static std::vector<Score> sweep(WorkStealingPool& pool, const std::vector<Param>& params, const std::vector<Scenario>& corpus, RunFn runOne) {
+  const uint32_t blocks = static_cast<uint32_t>((corpus.size() + SCENARIOS_PER_JOB - 1) / SCENARIOS_PER_JOB);
+  std::vector<Score> partial(params.size() * blocks, Score{});
+  pool.run(static_cast<uint32_t>(params.size() * blocks), [&](uint32_t job) {
+    const size_t param = job / blocks, block = job % blocks;
+    const size_t end = std::min(corpus.size(), (block + 1) * SCENARIOS_PER_JOB);
+    for (size_t s = block * SCENARIOS_PER_JOB; s < end; ++s) runOne(params[param], corpus[s], partial[job]);
+  });
+  std::vector<Score> total(params.size(), Score{});
+  for (size_t j = 0; j < partial.size(); ++j) total[j / blocks].add(partial[j]);
+  return total;
+}
+
+static SweepResult runSweep(unsigned threads, const std::vector<RelayParams>& grid, const std::vector<OutageScenario>& outages,
+                            const std::vector<uint32_t>& retriggers, const std::vector<MotionScenario>& motions) {
+  WorkStealingPool pool(threads);
+  SweepResult r;
+  auto t0 = std::chrono::steady_clock::now();
+  r.relay = sweep<RelayScore>(pool, grid, outages, runOutageScenario);
+  auto t1 = std::chrono::steady_clock::now();
+  r.motion = sweep<MotionScore>(pool, retriggers, motions, runMotionScenario);
+  auto t2 = std::chrono::steady_clock::now();
+  r.relaySeconds = std::chrono::duration<double>(t1 - t0).count();
+  r.motionSeconds = std::chrono::duration<double>(t2 - t1).count();
+  r.steals = pool.steals();
+  return r;
+}
+
+// Indicii nedominați pentru două obiective de minimizat, sortați după primul.
+template <typename A, typename B>
+static std::vector<size_t> paretoFront(size_t n, A first, B second) {
+  std::vector<size_t> order(n);
+  for (size_t i = 0; i < n; ++i) order[i] = i;
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return first(a) != first(b) ? first(a) < first(b) : second(a) < second(b);
+  });
+  std::vector<size_t> front;
+  for (size_t i : order) {
+    if (front.empty() || second(i) < second(front.back())) {
+      if (!front.empty() && first(front.back()) == first(i)) continue;
+      front.push_back(i);
+    }
+  }
+  return front;
+}
+
+static bool dominates(uint64_t a1, uint64_t a2, uint64_t b1, uint64_t b2) {
+  return a1 <= b1 && a2 <= b2 && (a1 < b1 || a2 < b2);
+}
+
+static double outageMinutes(const RelayScore& s) {
+  return static_cast<double>(s.outageMs) / 60'000.0;
+}
+
+int main(int argc, char** argv) {
+  const bool bench = argc > 1 && strcmp(argv[1], "bench") == 0;
+  const int arg0 = bench ? 2 : 1;
+  const uint32_t scenarios = argc > arg0 ? static_cast<uint32_t>(strtoul(argv[arg0], nullptr, 10)) : (bench ? 64 : 128);
+  const uint32_t seed = argc > arg0 + 1 ? static_cast<uint32_t>(strtoul(argv[arg0 + 1], nullptr, 10)) : 1;
+  const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+  const unsigned threads = !bench && argc > 3 ? static_cast<unsigned>(atoi(argv[3])) : hw;
+  bool ok = true;
+  auto check = [&](const char* what, bool pass) {
+    printf("%-60s %s\n", what, pass ? "ok" : "FAILED");
+    ok = ok && pass;
+  };
+
+  Rng rng = { seed * 2654435761u + 1 };
+  std::vector<OutageScenario> outages;
+  std::vector<MotionScenario> motions;
+  for (uint32_t i = 0; i < scenarios; ++i) outages.push_back(makeOutageScenario(rng));
+  for (uint32_t i = 0; i < scenarios; ++i) motions.push_back(makeMotionScenario(rng));
+  const std::vector<RelayParams> grid = relayGrid();
+  const std::vector<uint32_t> retriggers(std::begin(GRID_RETRIGGER_MS), std::end(GRID_RETRIGGER_MS));
+  const uint64_t relayRuns = static_cast<uint64_t>(grid.size()) * scenarios;
+  const uint64_t motionRuns = static_cast<uint64_t>(retriggers.size()) * scenarios;
+
+  printf("Corpus: %u outage scenarios (%u h each), %u PIR scenarios (%u min, %u zones); grid %zu relay x %zu retrigger\n", scenarios,
+         OUTAGE_SCENARIO_MS / 3'600'000, scenarios, MOTION_SCENARIO_MS / 60'000, ZONE_COUNT, grid.size(), retriggers.size());
+
+  if (bench) {
+    std::vector<unsigned> counts;
+    for (unsigned t = 1; t < hw; t *= 2) counts.push_back(t);
+    counts.push_back(hw);
+    if (hw == 1) counts.push_back(2);  // un singur nucleu: fără accelerare, dar se verifică determinismul
+    SweepResult base = {};
+    bool same = true;
+    printf("threads   relay scen/s   PIR scen/s   speedup   efficiency   steals\n");
+    for (unsigned t : counts) {
+      const SweepResult r = runSweep(t, grid, outages, retriggers, motions);
+      if (t == 1) base = r;
+      same = same && r.relay == base.relay && r.motion == base.motion;
+      const double speedup = base.relaySeconds / r.relaySeconds;
+      printf("%7u   %12.0f   %10.0f   %6.2fx   %9.0f%%   %6llu\n", t, relayRuns / r.relaySeconds, motionRuns / r.motionSeconds, speedup,
+             100.0 * speedup / std::min(t, hw), static_cast<unsigned long long>(r.steals));
+    }
+    if (hw == 1) printf("(1 hardware thread: speedup cannot be measured here)\n");
+    check("identical results for every thread count", same);
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+  }
+
+  const SweepResult r = runSweep(threads, grid, outages, retriggers, motions);
+  printf("Sweep: %llu relay scenarios in %.2f s (%.0f/s), %llu PIR scenarios in %.2f s (%.0f/s); %u threads, %llu steals\n\n",
+         static_cast<unsigned long long>(relayRuns), r.relaySeconds, relayRuns / r.relaySeconds, static_cast<unsigned long long>(motionRuns),
+         r.motionSeconds, motionRuns / r.motionSeconds, threads, static_cast<unsigned long long>(r.steals));
+
+  const std::vector<size_t> relayFront = paretoFront(grid.size(), [&](size_t i) { return r.relay[i].needlessReboots; },
+                                                     [&](size_t i) { return r.relay[i].outageMs; });
+  printf("Pareto front: router relay + ping (needless reboots vs outage)\n");
+  printf("  pulse  cooldown  holdoff   ping   needless  reboots  outage min  unrecovered\n");
+  for (size_t i : relayFront) {
+    const RelayParams& p = grid[i];
+    const RelayScore& s = r.relay[i];
+    printf("  %4u s   %5u s  %5u s  %4u s   %8u  %7u  %10.1f  %11u\n", p.pulseMs / 1000, p.cooldownMs / 1000, p.holdoffMs / 1000, p.pingIntervalMs / 1000,
+           s.needlessReboots, s.reboots, outageMinutes(s), s.unrecovered);
+  }
+
+  size_t firmware = grid.size();
+  for (size_t i = 0; i < grid.size(); ++i) {
+    const RelayParams& p = grid[i];
+    if (p.pulseMs == INTERNET_RELAY_PULSE_MS && p.cooldownMs == INTERNET_RELAY_COOLDOWN_MS && p.holdoffMs == FIRMWARE_HOLDOFF_MS && p.pingIntervalMs == FIRMWARE_PING_INTERVAL_MS) firmware = i;
+  }
+  size_t dominatedBy = 0;
+  if (firmware < grid.size()) {
+    const RelayScore& f = r.relay[firmware];
+    for (size_t i = 0; i < grid.size(); ++i) {
+      dominatedBy += dominates(r.relay[i].needlessReboots, r.relay[i].outageMs, f.needlessReboots, f.outageMs) ? 1 : 0;
+    }
+    printf("Firmware (%u s / %u s / %u s / %u s): needless %u, reboots %u, outage %.1f min, unrecovered %u; dominated by %zu of %zu\n\n",
+           INTERNET_RELAY_PULSE_MS / 1000, INTERNET_RELAY_COOLDOWN_MS / 1000, FIRMWARE_HOLDOFF_MS / 1000, FIRMWARE_PING_INTERVAL_MS / 1000,
+           f.needlessReboots, f.reboots, outageMinutes(f), f.unrecovered, dominatedBy, grid.size());
+  }
+
+  const std::vector<size_t> motionFront = paretoFront(retriggers.size(), [&](size_t i) { return r.motion[i].missed; },
+                                                      [&](size_t i) { return r.motion[i].extra; });
+  uint32_t episodes = 0;
+  for (const MotionScenario& m : motions) episodes += m.episodes;
+  printf("Pareto front: MOTION_RETRIGGER_MS (missed motion vs extra triggers, %u motion episodes)\n", episodes);
+  printf("  retrigger   missed   extra   triggers\n");
+  for (size_t i : motionFront) {
+    printf("  %6u ms   %6u   %5u   %8u%s\n", retriggers[i], r.motion[i].missed, r.motion[i].extra, r.motion[i].triggers,
+           retriggers[i] == FIRMWARE_RETRIGGER_MS ? "   <- firmware" : "");
+  }
+  printf("\n");
+
+  bool relayNonDominated = true;
+  for (size_t a : relayFront) {
+    for (size_t i = 0; i < grid.size(); ++i) {
+      if (dominates(r.relay[i].needlessReboots, r.relay[i].outageMs, r.relay[a].needlessReboots, r.relay[a].outageMs)) relayNonDominated = false;
+    }
+  }
+  bool motionNonDominated = true;
+  for (size_t a : motionFront) {
+    for (size_t i = 0; i < retriggers.size(); ++i) {
+      if (dominates(r.motion[i].missed, r.motion[i].extra, r.motion[a].missed, r.motion[a].extra)) motionNonDominated = false;
+    }
+  }
+  check("relay front: no grid point dominates a front member", !relayFront.empty() && relayNonDominated);
+  check("PIR front: no grid point dominates a front member", !motionFront.empty() && motionNonDominated);
+  check("firmware values are on the grid", firmware < grid.size());
+  check("shortest retrigger misses nothing", r.motion.front().missed == 0);
+  check("longest retrigger gives fewer extra triggers than shortest", r.motion.back().extra < r.motion.front().extra);
+  printf("%s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,565 @@
+// peer_sync_sim.cpp — verificare pentru include/peer_sync.h cu plăci în procese separate pe loopback
+//
+// Build:
+//   g++ -O2 -std=c++17 -I../include peer_sync_sim.cpp -o peer_sync_sim
+//
+// Utilizare:
+//   ./peer_sync_sim [plăci] [încercări]      (implicit 4 plăci, 25 încercări)
+//
+// 1) codec + merge: MAC (SipHash-2-4, vectorii de referință; bytes alterați,
+//    altă cheie și pachete v1 fără MAC aruncate), alt site, propriul ecou,
+//    ordinea sosirii nu contează, duplicatele nu schimbă nimic;
+// 2) fiecare placă e un proces (fork) cu loop() propriu: alarm_fsm.h + PeerSync,
+//    un socket UDP pe grupul multicast din config.h (legat de lo). Dacă
+//    loopback-ul nu livrează multicast (unele containere), se trimite unicast
+//    la fiecare placă: aceleași pachete, aceeași logică. Pierderi simulate la
+//    recepție, independent pe fiecare placă: 0 / 10 / 30%;
+// 3) latență: PIR pe o placă -> sirena pe toate (CLOCK_MONOTONIC, țintă
+//    < 50 ms); convergență: ARM / STAY / DISARM date în același moment pe
+//    plăci diferite -> aceeași stare peste tot.
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include "alarm_fsm.h"
+#include "peer_sync.h"
+
+// Ca în config.h
+static const char* PEER_GROUP = "239.255.42.99";
+static const uint16_t PEER_PORT = 5141;
+static const uint16_t SITE_ID = 1;
+static const uint8_t SITE_KEY[SIPHASH_KEY_BYTES] = { 0x3a, 0x91, 0x5c, 0x07, 0xe2, 0x4d, 0xb8, 0x16, 0x6f, 0xc0, 0x29, 0x84, 0x5b, 0xd3, 0x70, 0xae };
+
+static const uint8_t MAX_BOARDS = 8;
+static const AlarmZone ZONES[] = { { 0, ZoneType::INSTANT } };
+static const AlarmTimings TIMINGS = { 100, 10'000, 60'000, 2'000 };  // exit delay scurt: încercări rapide
+static const uint32_t PIR_PULSE_MS = 100;
+static const uint32_t LATENCY_TARGET_MS = 50;
+
+static int64_t monoNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+}
+
+static uint32_t monoMs() {
+  return static_cast<uint32_t>(monoNs() / 1'000'000);
+}
+
+static void sleepMs(uint32_t ms) {
+  usleep(ms * 1000);
+}
+
+// ----------------------------
+// Memorie comună părinte <-> plăci (mmap înainte de fork)
+// ----------------------------
+enum class Cmd : uint8_t { NONE, TRIP, ARM_AWAY, ARM_STAY, DISARM };
+
+struct BoardShared {
+  std::atomic<uint32_t> cmdSeq;
+  std::atomic<uint8_t> cmd;
+  std::atomic<uint8_t> state;      // AlarmState
+  std::atomic<int64_t> sirenNs;    // momentul intrării în ALARMING (0 = încă nu)
+  std::atomic<uint32_t> armLamport;
+  std::atomic<uint32_t> armOrigin;
+  std::atomic<uint8_t> armValue;
+  std::atomic<uint32_t> alarmApplies;  // incidente primite aplicate local
+  std::atomic<uint32_t> sent;
+  std::atomic<uint32_t> received;
+  std::atomic<uint32_t> dropped;       // pierderi simulate
+  std::atomic<uint32_t> duplicates;
+  std::atomic<uint32_t> seqGaps;
+  std::atomic<uint16_t> port;          // doar în modul unicast
+};
+
+struct Shared {
+  std::atomic<bool> stop;
+  std::atomic<bool> multicast;
+  std::atomic<uint32_t> lossPct;
+  uint8_t boards;
+  BoardShared board[MAX_BOARDS];
+};
+
+static Shared* shared = nullptr;
+static uint32_t remoteTrips[MAX_BOARDS];  // incidente de pe alte plăci, per placă (doar în părinte)
+
+// ----------------------------
+// Transport
+// ----------------------------
+static int openMulticastSocket() {
+  const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) return -1;
+  const int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+  sockaddr_in a = {};
+  a.sin_family = AF_INET;
+  a.sin_port = htons(PEER_PORT);
+  a.sin_addr.s_addr = htonl(INADDR_ANY);
+  ip_mreq mreq = {};
+  mreq.imr_multiaddr.s_addr = inet_addr(PEER_GROUP);
+  mreq.imr_interface.s_addr = htonl(INADDR_LOOPBACK);
+  in_addr iface = {};
+  iface.s_addr = htonl(INADDR_LOOPBACK);
+  const unsigned char loop = 1;
+  if (bind(fd, reinterpret_cast<sockaddr*>(&a), sizeof(a)) != 0 || setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0 ||
+      setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)) != 0 || setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static int openUnicastSocket(uint16_t* port) {
+  const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in a = {};
+  a.sin_family = AF_INET;
+  a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(a);
+  if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&a), sizeof(a)) != 0 || getsockname(fd, reinterpret_cast<sockaddr*>(&a), &len) != 0) return -1;
+  *port = ntohs(a.sin_port);
+  return fd;
+}
+
+// Un pachet de probă între două socket-uri de grup: livrează lo multicast?
+static bool multicastWorks() {
+  const int rx = openMulticastSocket();
+  const int tx = openMulticastSocket();
+  bool ok = false;
+  if (rx >= 0 && tx >= 0) {
+    sockaddr_in to = {};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(PEER_PORT);
+    to.sin_addr.s_addr = inet_addr(PEER_GROUP);
+    const char probe[] = "probe";
+    if (sendto(tx, probe, sizeof(probe), 0, reinterpret_cast<sockaddr*>(&to), sizeof(to)) == sizeof(probe)) {
+      pollfd p = { rx, POLLIN, 0 };
+      char buf[16];
+      ok = poll(&p, 1, 200) == 1 && recv(rx, buf, sizeof(buf), 0) == sizeof(probe);
+    }
+  }
+  if (rx >= 0) close(rx);
+  if (tx >= 0) close(tx);
+  return ok;
+}
+
+static void sendToPeers(int fd, uint8_t self, const uint8_t* buf) {
+  sockaddr_in to = {};
+  to.sin_family = AF_INET;
+  if (shared->multicast.load()) {
+    to.sin_port = htons(PEER_PORT);
+    to.sin_addr.s_addr = inet_addr(PEER_GROUP);
+    sendto(fd, buf, PEER_PACKET_SIZE, 0, reinterpret_cast<sockaddr*>(&to), sizeof(to));
+    return;
+  }
+  to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  for (uint8_t j = 0; j < shared->boards; ++j) {
+    if (j == self) continue;
+    to.sin_port = htons(shared->board[j].port.load());
+    sendto(fd, buf, PEER_PACKET_SIZE, 0, reinterpret_cast<sockaddr*>(&to), sizeof(to));
+  }
+}
+
+// ----------------------------
+// O placă: loop() cu aceeași legătură ca main.cpp
+// ----------------------------
+static void boardMain(uint8_t self, int fd) {
+  BoardShared& me = shared->board[self];
+  PeerSync sync;
+  sync.begin(0x00A10000u + self, SITE_ID, SITE_KEY);
+  AlarmPartition part = { AlarmState::DISARMED, AlarmState::ARMED, false, 0, 0 };
+  uint32_t alarmCount = 0;
+  uint32_t lastMotionMs[1] = { monoMs() - TIMINGS.motionRetriggerMs };
+  uint32_t seenCmd = 0;
+  uint32_t pirUntilMs = 0;
+  bool pirActive = false;
+  uint32_t rng = 0x12345u + self * 7919u;
+  auto random100 = [&rng]() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng % 100;
+  };
+
+  // peerApplying: schimbarea vine de la alt nod, nu se republică (main.cpp la fel)
+  bool peerApplying = false;
+  uint8_t pirLevels = 0;
+  auto dispatch = [&](AlarmEvent e, uint32_t now) {
+    if (!alarmApply(part, e, now, TIMINGS, &alarmCount)) return;
+    if (part.state == AlarmState::ALARMING) {
+      int64_t expected = 0;
+      me.sirenNs.compare_exchange_strong(expected, monoNs());
+      if (!peerApplying) sync.localAlarm(pirLevels, now);
+    }
+  };
+  auto localArm = [&](AlarmEvent e, uint32_t now) {
+    dispatch(e, now);
+    sync.localArm(peerArmFromEvent(e), now);
+  };
+  auto applyRemote = [&](uint8_t changed, uint32_t now) {
+    peerApplying = true;
+    // ambele registre noi (pachete pierdute): întâi cel mai vechi
+    const bool armFirst = !peerNewer(sync.arm(), sync.alarm());
+    for (uint8_t pass = 0; pass < 2; ++pass) {
+      const bool doArm = (pass == 0) == armFirst;
+      if (doArm && (changed & PEER_RX_ARM)) {
+        const PeerArmCmd cmd = static_cast<PeerArmCmd>(sync.arm().value);
+        if (peerArmNeedsDisarm(part, cmd)) dispatch(AlarmEvent::DISARM, now);
+        dispatch(peerArmEvent(cmd), now);
+      }
+      if (!doArm && (changed & PEER_RX_ALARM)) {
+        me.alarmApplies.fetch_add(1);
+        dispatch(AlarmEvent::MOTION_INSTANT, now);
+      }
+    }
+    peerApplying = false;
+  };
+
+  uint8_t buf[64];
+  while (!shared->stop.load()) {
+    const uint32_t now = monoMs();
+
+    if (me.cmdSeq.load() != seenCmd) {
+      seenCmd = me.cmdSeq.load();
+      switch (static_cast<Cmd>(me.cmd.load())) {
+        case Cmd::TRIP:
+          pirActive = true;
+          pirUntilMs = now + PIR_PULSE_MS;
+          lastMotionMs[0] = now - TIMINGS.motionRetriggerMs;
+          break;
+        case Cmd::ARM_AWAY: localArm(AlarmEvent::ARM_AWAY, now); break;
+        case Cmd::ARM_STAY: localArm(AlarmEvent::ARM_STAY, now); break;
+        case Cmd::DISARM: localArm(AlarmEvent::DISARM, now); break;
+        case Cmd::NONE: break;
+      }
+    }
+    if (pirActive && (int32_t)(now - pirUntilMs) >= 0) pirActive = false;
+    pirLevels = pirActive ? 1 : 0;
+    alarmZonesStep(ZONES, 1, &part, pirLevels, lastMotionMs, now, TIMINGS, [&](uint8_t, AlarmEvent e) { dispatch(e, now); });
+    alarmTimersStep(&part, 1, now, [&](uint8_t, AlarmEvent e) { dispatch(e, now); });
+
+    // RX: tot ce a sosit, fără să blocheze (loop() pe placă)
+    for (;;) {
+      const ssize_t n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+      if (n < 0) break;
+      if (random100() < shared->lossPct.load()) {
+        me.dropped.fetch_add(1);
+        continue;
+      }
+      me.received.fetch_add(1);
+      const uint8_t changed = sync.receive(buf, static_cast<size_t>(n), now);
+      if (changed != 0) applyRemote(changed, now);
+    }
+
+    // TX: imediat ce e ceva de trimis
+    while (sync.dueSend(now)) {
+      sync.encode(buf, now);
+      sendToPeers(fd, self, buf);
+      me.sent.fetch_add(1);
+    }
+
+    uint32_t dups = 0, gaps = 0;
+    for (uint8_t i = 0; i < sync.peerCount(); ++i) {
+      dups += sync.peer(i).duplicates;
+      gaps += sync.peer(i).lost;
+    }
+    me.duplicates.store(dups);
+    me.seqGaps.store(gaps);
+    me.state.store(static_cast<uint8_t>(part.state));
+    me.armLamport.store(sync.arm().lamport);
+    me.armOrigin.store(sync.arm().origin);
+    me.armValue.store(sync.arm().value);
+
+    pollfd p = { fd, POLLIN, 0 };
+    poll(&p, 1, 1);
+  }
+  close(fd);
+}
+
+// ----------------------------
+// Părintele: comenzi + măsurători
+// ----------------------------
+static void command(uint8_t board, Cmd cmd) {
+  shared->board[board].cmd.store(static_cast<uint8_t>(cmd));
+  shared->board[board].cmdSeq.fetch_add(1);
+}
+
+template <typename Pred>
+static bool waitFor(uint32_t timeoutMs, Pred pred) {
+  const uint32_t start = monoMs();
+  while (monoMs() - start < timeoutMs) {
+    if (pred()) return true;
+    usleep(200);
+  }
+  return pred();
+}
+
+static bool allInState(AlarmState s) {
+  for (uint8_t j = 0; j < shared->boards; ++j) {
+    if (shared->board[j].state.load() != static_cast<uint8_t>(s)) return false;
+  }
+  return true;
+}
+
+static bool converged() {
+  const BoardShared& b0 = shared->board[0];
+  for (uint8_t j = 1; j < shared->boards; ++j) {
+    const BoardShared& b = shared->board[j];
+    if (b.armLamport.load() != b0.armLamport.load() || b.armOrigin.load() != b0.armOrigin.load() || b.state.load() != b0.state.load()) return false;
+  }
+  return b0.state.load() != static_cast<uint8_t>(AlarmState::ARMING);
+}
+
+struct LevelResult {
+  std::vector<double> latencyMs;  // doar plăcile care NU au văzut PIR-ul
+  uint32_t tripsMissed = 0;
+  uint32_t convergeRuns = 0;
+  uint32_t convergeOk = 0;
+  uint32_t winnerOk = 0;
+  double convergeMaxMs = 0;
+};
+
+static double percentile(std::vector<double> v, double p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[static_cast<size_t>(p * (v.size() - 1) + 0.5)];
+}
+
+static LevelResult runLevel(uint32_t lossPct, uint32_t trials) {
+  LevelResult r;
+  const uint8_t n = shared->boards;
+  shared->lossPct.store(lossPct);
+
+  // latență: armare de pe o placă, PIR pe alta, dezarmare de pe a treia
+  for (uint32_t t = 0; t < trials; ++t) {
+    const uint8_t armer = t % n, tripper = (t + 1) % n, disarmer = (t + 2) % n;
+    command(armer, Cmd::ARM_AWAY);
+    if (!waitFor(3'000, [] { return allInState(AlarmState::ARMED); })) {
+      ++r.tripsMissed;
+      continue;
+    }
+    for (uint8_t j = 0; j < n; ++j) shared->board[j].sirenNs.store(0);
+    for (uint8_t j = 0; j < n; ++j) remoteTrips[j] += j != tripper ? 1 : 0;
+    const int64_t t0 = monoNs();
+    command(tripper, Cmd::TRIP);
+    const bool all = waitFor(3'000, [] { return allInState(AlarmState::ALARMING); });
+    if (!all) ++r.tripsMissed;
+    for (uint8_t j = 0; j < n; ++j) {
+      const int64_t at = shared->board[j].sirenNs.load();
+      if (j != tripper && at != 0) r.latencyMs.push_back((at - t0) / 1e6);
+    }
+    command(disarmer, Cmd::DISARM);
+    waitFor(3'000, [] { return allInState(AlarmState::DISARMED); });
+  }
+
+  // convergență: comenzi contradictorii în același moment pe plăci diferite
+  static const Cmd CONFLICT[] = { Cmd::ARM_AWAY, Cmd::DISARM, Cmd::ARM_STAY };
+  for (uint32_t t = 0; t < trials; ++t) {
+    waitFor(3'000, [] { return allInState(AlarmState::DISARMED) && converged(); });
+    const uint8_t k = std::min<uint8_t>(n, 3);
+    for (uint8_t i = 0; i < k; ++i) command((t + i) % n, CONFLICT[(t + i) % 3]);
+    const int64_t t0 = monoNs();
+    ++r.convergeRuns;
+    sleepMs(TIMINGS.exitDelayMs / 2);
+    if (waitFor(3'000, converged)) {
+      ++r.convergeOk;
+      r.convergeMaxMs = std::max(r.convergeMaxMs, (monoNs() - t0) / 1e6);
+      // câștigătorul: registrul cu (lamport, origine) maxim -> starea lui
+      const PeerArmCmd winner = static_cast<PeerArmCmd>(shared->board[0].armValue.load());
+      const AlarmState expected = winner == PeerArmCmd::ARM_AWAY ? AlarmState::ARMED : winner == PeerArmCmd::ARM_STAY ? AlarmState::ARMED_STAY : AlarmState::DISARMED;
+      if (allInState(expected)) ++r.winnerOk;
+    }
+    for (uint8_t j = 0; j < n; ++j) command(j, Cmd::DISARM);
+  }
+  waitFor(3'000, [] { return allInState(AlarmState::DISARMED) && converged(); });
+  return r;
+}
+
+int main(int argc, char** argv) {
+  const uint8_t boards = static_cast<uint8_t>(std::min<int>(argc > 1 ? atoi(argv[1]) : 4, MAX_BOARDS));
+  const uint32_t trials = argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 25;
+  bool ok = true;
+  auto check = [&](const char* what, bool pass) {
+    printf("%-60s %s\n", what, pass ? "ok" : "FAILED");
+    ok = ok && pass;
+  };
+
+  // --- 1) codec + merge, în proces
+  {
+    PeerSync a, b, c;
+    a.begin(1, SITE_ID, SITE_KEY);
+    b.begin(2, SITE_ID, SITE_KEY);
+    c.begin(3, SITE_ID, SITE_KEY);
+    uint8_t pa[PEER_PACKET_SIZE], pb[PEER_PACKET_SIZE];
+    a.localArm(PeerArmCmd::ARM_AWAY, 0);
+    b.localArm(PeerArmCmd::DISARM, 0);  // concurent: același lamport, câștigă originea mai mare
+    a.encode(pa, 0);
+    b.encode(pb, 0);
+    PeerPacket decoded;
+    check("encode/decode round trip", peerDecode(pa, sizeof(pa), SITE_KEY, &decoded) && decoded.boardId == 1 && decoded.arm.value == 1 && decoded.arm.lamport == 1);
+
+    // vectorii din articolul SipHash: cheie 00..0f, mesaj 00..0e / gol
+    uint8_t refKey[SIPHASH_KEY_BYTES], refMsg[15];
+    for (uint8_t i = 0; i < sizeof(refKey); ++i) refKey[i] = i;
+    for (uint8_t i = 0; i < sizeof(refMsg); ++i) refMsg[i] = i;
+    check("SipHash-2-4 reference vectors", siphash24(refKey, refMsg, 15) == 0xa129ca6149be45e5ull && siphash24(refKey, refMsg, 0) == 0x726fdb47dd0e0e31ull);
+
+    // alterat: fiecare byte din zona semnată, un bit
+    uint32_t tamperedAccepted = 0;
+    for (size_t i = 3; i < PEER_PACKET_SIZE; ++i) {
+      uint8_t bad[PEER_PACKET_SIZE];
+      memcpy(bad, pa, sizeof(bad));
+      bad[i] ^= 0x02;
+      tamperedAccepted += c.receive(bad, sizeof(bad), 0) != 0 || peerDecode(bad, sizeof(bad), SITE_KEY, &decoded) ? 1 : 0;
+    }
+    check("tampered packets rejected by MAC", tamperedAccepted == 0 && c.rejected() == PEER_PACKET_SIZE - 3 && c.arm().lamport == 0);
+
+    // un atacator din LAN fără cheie: pachet bine format, DISARM cu lamport mare
+    uint8_t forgedKey[SIPHASH_KEY_BYTES];
+    memcpy(forgedKey, SITE_KEY, sizeof(forgedKey));
+    forgedKey[0] ^= 1;
+    const PeerPacket forged = { PEER_FLAG_CHANGED, SITE_ID, 0xBAD, 1, { 1'000'000, 0xBAD, static_cast<uint8_t>(PeerArmCmd::DISARM) }, { 1'000'000, 0xBAD, 0x0F }, 0 };
+    uint8_t pf[PEER_PACKET_SIZE];
+    peerEncode(forged, forgedKey, pf);
+    check("packet signed with another key rejected", c.receive(pf, sizeof(pf), 0) == 0 && c.arm().lamport == 0 && c.alarm().lamport == 0 && c.peerCount() == 0);
+
+    // firmware v1: 44 bytes cu CRC32, fără MAC
+    uint8_t v1[44];
+    memcpy(v1, pa, sizeof(v1));
+    v1[2] = 1;
+    check("unauthenticated v1 packet rejected", c.receive(v1, sizeof(v1), 0) == 0 && c.arm().lamport == 0);
+    check("own multicast echo ignored", a.receive(pa, sizeof(pa), 0) == 0);
+    PeerSync other;
+    other.begin(9, SITE_ID + 1, SITE_KEY);
+    check("other site ignored", other.receive(pa, sizeof(pa), 0) == 0);
+
+    PeerSync x, y;
+    x.begin(10, SITE_ID, SITE_KEY);
+    y.begin(11, SITE_ID, SITE_KEY);
+    x.receive(pa, sizeof(pa), 0);
+    x.receive(pb, sizeof(pb), 0);
+    y.receive(pb, sizeof(pb), 0);
+    y.receive(pa, sizeof(pa), 0);
+    check("arrival order does not change the merge", x.arm().origin == 2 && y.arm().origin == 2 && x.arm().value == y.arm().value);
+    check("duplicate packet is a no-op", x.receive(pa, sizeof(pa), 1) == 0 && x.receive(pb, sizeof(pb), 1) == 0 && x.peer(0).duplicates == 1);
+    // după merge, o schimbare locală are lamport mai mare decât tot ce s-a văzut
+    x.localAlarm(1, 2);
+    check("local write after merge wins over merged state", x.alarm().lamport > x.arm().lamport);
+
+    // placă repornită: află de un incident vechi din heartbeat, dar nu pornește sirena
+    PeerSync old, rebooted, fresh;
+    old.begin(20, SITE_ID, SITE_KEY);
+    rebooted.begin(21, SITE_ID, SITE_KEY);
+    fresh.begin(22, SITE_ID, SITE_KEY);
+    uint8_t hb[PEER_PACKET_SIZE];
+    old.localAlarm(3, 1'000);
+    old.dueSend(1'000 + PEER_ALARM_FRESH_MS);
+    old.encode(hb, 1'000 + PEER_ALARM_FRESH_MS);
+    const uint8_t staleRx = rebooted.receive(hb, sizeof(hb), 50);
+    old.localAlarm(1, 20'000);
+    old.encode(hb, 20'003);
+    const uint8_t freshRx = fresh.receive(hb, sizeof(hb), 7);
+    check("stale incident adopted without siren, fresh one applied",
+          staleRx == 0 && rebooted.alarm().origin == 20 && freshRx == PEER_RX_ALARM && fresh.alarmAgeMs(10) == 6);
+
+    uint32_t sends = 0;
+    PeerSync s;
+    s.begin(5, SITE_ID, SITE_KEY);
+    s.localAlarm(1, 1'000);
+    for (uint32_t now = 1'000; now < 3'000; ++now) sends += s.dueSend(now) ? 1 : 0;
+    check("burst after change then 1 s heartbeat", sends == PEER_BURST_COUNT + 1);
+  }
+
+  // --- 2) plăci în procese separate
+  shared = static_cast<Shared*>(mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+  if (shared == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+  new (shared) Shared();
+  shared->boards = boards;
+  shared->multicast.store(multicastWorks());
+  printf("%u boards, transport: %s\n", boards, shared->multicast.load() ? "multicast on lo" : "unicast fan-out on lo (no multicast on lo here)");
+
+  int fds[MAX_BOARDS];
+  for (uint8_t j = 0; j < boards; ++j) {
+    uint16_t port = 0;
+    fds[j] = shared->multicast.load() ? openMulticastSocket() : openUnicastSocket(&port);
+    if (fds[j] < 0) {
+      perror("socket");
+      return 1;
+    }
+    shared->board[j].port.store(port);
+  }
+  std::vector<pid_t> pids;
+  for (uint8_t j = 0; j < boards; ++j) {
+    const pid_t pid = fork();
+    if (pid == 0) {
+      for (uint8_t k = 0; k < boards; ++k) {
+        if (k != j) close(fds[k]);
+      }
+      boardMain(j, fds[j]);
+      _exit(0);
+    }
+    pids.push_back(pid);
+  }
+  for (uint8_t j = 0; j < boards; ++j) close(fds[j]);
+  sleepMs(50);
+
+  static const uint32_t LOSS[] = { 0, 10, 30 };
+  for (uint32_t loss : LOSS) {
+    const LevelResult r = runLevel(loss, trials);
+    const double p50 = percentile(r.latencyMs, 0.50), p95 = percentile(r.latencyMs, 0.95), p99 = percentile(r.latencyMs, 0.99);
+    const double maxMs = percentile(r.latencyMs, 1.0);
+    printf("loss %2u%%: PIR -> siren on %zu remote boards: p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms; conflicts %u/%u converged (max %.0f ms)\n",
+           loss, r.latencyMs.size(), p50, p95, p99, maxMs, r.convergeOk, r.convergeRuns, r.convergeMaxMs);
+
+    char what[96];
+    snprintf(what, sizeof(what), "loss %u%%: every trip reached every board", loss);
+    check(what, r.tripsMissed == 0 && r.latencyMs.size() == trials * (boards - 1u));
+    if (loss <= 10) {
+      snprintf(what, sizeof(what), "loss %u%%: max trip-to-siren < %u ms", loss, LATENCY_TARGET_MS);
+      check(what, maxMs < LATENCY_TARGET_MS);
+    } else {
+      snprintf(what, sizeof(what), "loss %u%%: p95 trip-to-siren < %u ms, max < heartbeat", loss, LATENCY_TARGET_MS);
+      check(what, p95 < LATENCY_TARGET_MS && maxMs < PEER_HEARTBEAT_MS + 100);
+    }
+    snprintf(what, sizeof(what), "loss %u%%: conflicting arm/disarm converge to the winner", loss);
+    check(what, r.convergeOk == r.convergeRuns && r.winnerOk == r.convergeRuns);
+  }
+
+  uint32_t sent = 0, received = 0, dropped = 0, dups = 0, gaps = 0;
+  bool idempotent = true;
+  for (uint8_t j = 0; j < boards; ++j) {
+    const BoardShared& b = shared->board[j];
+    sent += b.sent.load();
+    received += b.received.load();
+    dropped += b.dropped.load();
+    dups += b.duplicates.load();
+    gaps += b.seqGaps.load();
+    // fiecare incident de pe altă placă aplicat exact o dată, oricâte copii au sosit
+    idempotent = idempotent && b.alarmApplies.load() == remoteTrips[j];
+  }
+  printf("packets: %u sent, %u received, %u dropped (simulated), seq gaps seen %u, duplicates %u\n", sent, received, dropped, gaps, dups);
+  check("each remote incident applied exactly once per board", idempotent);
+
+  shared->stop.store(true);
+  for (pid_t pid : pids) waitpid(pid, nullptr, 0);
+
+  printf("%s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
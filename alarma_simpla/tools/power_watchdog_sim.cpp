@@ -0,0 +1,253 @@
+// power_watchdog_sim.cpp — simulare de căderi în cascadă pentru include/power_watchdog.h
+//
+// Build:
+//   g++ -O2 -std=c++17 -I../include power_watchdog_sim.cpp -o power_watchdog_sim
+//
+// Utilizare:
+//   ./power_watchdog_sim [seed=1] [-v]
+//
+// Rețeaua din main.cpp: modem -> router -> switch PoE; ținte: gateway (prin
+// router), IP public (router + modem, ping-ul Google existent, la 60 s),
+// o gazdă din LAN (router + switch). Un echipament „agățat” nu mai trece
+// trafic până la un power-cycle (routerul agățat ține WiFi-ul); după impuls
+// bootează (modem 90 s, router 60 s, switch 30 s). Probele pierd aleator 1%
+// din pachete.
+//
+// Pentru fiecare scenariu (defect injectat la minutul 10, 4 h simulate cu
+// pas de 1 s) se verifică șirul exact de cicluri (echipamentul corect, cât
+// mai puține cicluri) și că la final toate țintele răspund. Alături: o
+// variantă naivă cu watchdog-uri independente (fiecare echipament cu ținta
+// lui, fără diagnostic comun), ca să se vadă ciclurile în plus. La final:
+// costul tick() + dueProbe() pe o trecere fără rezultate noi.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "power_watchdog.h"
+#include "relay_scheduler.h"
+
+enum : uint8_t { MODEM, ROUTER, SWITCH, DEVICE_COUNT };
+enum : uint8_t { GATEWAY, PUBLIC, LAN_HOST, TARGET_COUNT };
+
+// Ca POWER_DEVICES / POWER_TARGETS din main.cpp, cu toate releele montate și ținta LAN activă.
+static const PowerDeviceConfig DEVICES[DEVICE_COUNT] = {
+  { "MODEM", POWER_WD_NONE, true, 10'000, 120'000, 30UL * 60'000 },
+  { "ROUTER", MODEM, true, INTERNET_RELAY_PULSE_MS, 90'000, INTERNET_RELAY_COOLDOWN_MS },
+  { "POE_SWITCH", ROUTER, true, 5'000, 45'000, 15UL * 60'000 },
+};
+static const PowerTargetConfig TARGETS[TARGET_COUNT] = {
+  { "GATEWAY", powerDeviceBit(ROUTER), 3, 30'000 },
+  { "PUBLIC", powerDeviceBit(ROUTER) | powerDeviceBit(MODEM), 2, 0 },
+  { "LAN_HOST", powerDeviceBit(ROUTER) | powerDeviceBit(SWITCH), 3, 30'000 },
+};
+static const uint32_t PUBLIC_PING_INTERVAL_MS = 60'000;
+static const uint32_t BOOT_MS[DEVICE_COUNT] = { 90'000, 60'000, 30'000 };
+static const uint32_t FAULT_AT_MS = 10UL * 60'000;
+static const uint32_t SIM_MS = 4UL * 3600'000;
+static const char DEVICE_LETTER[DEVICE_COUNT] = { 'M', 'R', 'S' };
+
+struct Scenario {
+  const char* name;
+  uint8_t hung;               // biți: echipamente agățate la FAULT_AT_MS
+  bool wanStaleAfterModem;    // routerul rămâne fără WAN după un reboot de modem, până la propriul reboot
+  uint32_t ispDownMs;         // IP-ul public cade la FAULT_AT_MS, atât timp (nimic nu ajută)
+  const char* expected;       // șirul ideal de cicluri; nullptr = doar limită
+  uint32_t maxCycles;
+};
+
+static const Scenario SCENARIOS[] = {
+  { "no fault (1% loss)", 0, false, 0, "", 0 },
+  { "modem hung", 1 << MODEM, false, 0, "M", 1 },
+  { "router hung", 1 << ROUTER, false, 0, "R", 1 },
+  { "switch hung", 1 << SWITCH, false, 0, "S", 1 },
+  { "modem hung + router WAN", 1 << MODEM, true, 0, "MR", 2 },
+  { "router + switch hung", (1 << ROUTER) | (1 << SWITCH), false, 0, "RS", 2 },
+  { "modem + switch hung", (1 << MODEM) | (1 << SWITCH), false, 0, "MS", 2 },
+  { "ISP down 60 min", 0, false, 60UL * 60'000, nullptr, 4 },
+};
+
+struct World {
+  bool hung[DEVICE_COUNT] = {};
+  bool off[DEVICE_COUNT] = {};
+  uint32_t bootUntil[DEVICE_COUNT] = {};
+  bool wanStale = false;
+  bool wanStaleAfterModem = false;
+  uint32_t ispUpAt = 0;
+
+  bool forwarding(uint8_t d, uint32_t now) const { return !hung[d] && !off[d] && (int32_t)(now - bootUntil[d]) >= 0; }
+
+  bool reachable(uint8_t t, uint32_t now) const {
+    for (uint8_t d = 0; d < DEVICE_COUNT; ++d) {
+      if ((TARGETS[t].via & powerDeviceBit(d)) && !forwarding(d, now)) return false;
+    }
+    if (t == PUBLIC && (wanStale || (int32_t)(now - ispUpAt) < 0)) return false;
+    return true;
+  }
+
+  // placa e pe WiFi-ul routerului: router oprit / în boot = fără probe; un router
+  // agățat ține de obicei WiFi-ul (asocierea merge, traficul nu)
+  bool wifiUp(uint32_t now) const { return !off[ROUTER] && (int32_t)(now - bootUntil[ROUTER]) >= 0; }
+
+  void cut(uint8_t d) {
+    off[d] = true;
+    hung[d] = false;
+    if (d == MODEM && wanStaleAfterModem) wanStale = true;
+    if (d == ROUTER) wanStale = false;
+  }
+
+  void restore(uint8_t d, uint32_t now) {
+    off[d] = false;
+    bootUntil[d] = now + BOOT_MS[d];
+  }
+
+  bool allUp(uint32_t now) const {
+    for (uint8_t t = 0; t < TARGET_COUNT; ++t) {
+      if (!reachable(t, now)) return false;
+    }
+    return true;
+  }
+};
+
+struct RunResult {
+  std::string cycles;
+  bool recovered = false;
+  uint32_t recoveredAtMs = 0;  // de la defect
+};
+
+static void injectFault(World& w, const Scenario& sc, uint32_t now) {
+  for (uint8_t d = 0; d < DEVICE_COUNT; ++d) w.hung[d] = (sc.hung >> d) & 1;
+  w.wanStaleAfterModem = sc.wanStaleAfterModem;
+  if (sc.ispDownMs) w.ispUpAt = now + sc.ispDownMs;
+}
+
+static void noteRecovery(const World& w, uint32_t now, RunResult& r) {
+  if (now < FAULT_AT_MS) return;
+  if (!w.allUp(now)) {
+    r.recovered = false;
+  } else if (!r.recovered) {
+    r.recovered = true;
+    r.recoveredAtMs = now - FAULT_AT_MS;
+  }
+}
+
+static RunResult runWatchdog(const Scenario& sc, uint32_t seed, bool verbose) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  World w;
+  PowerWatchdog wd;
+  wd.begin(DEVICES, DEVICE_COUNT, TARGETS, TARGET_COUNT, 0);
+  RunResult r;
+  uint32_t nextPublicMs = PUBLIC_PING_INTERVAL_MS;
+  for (uint32_t now = 0; now < SIM_MS; now += 1000) {
+    if (now == FAULT_AT_MS) injectFault(w, sc, now);
+    if (w.wifiUp(now)) {
+      const uint8_t t = wd.dueProbe(now);
+      if (t != POWER_WD_NONE) wd.probeResult(t, w.reachable(t, now) && u(rng) >= 0.01);
+      if ((int32_t)(now - nextPublicMs) >= 0) {
+        nextPublicMs = now + PUBLIC_PING_INTERVAL_MS;
+        wd.probeResult(PUBLIC, w.reachable(PUBLIC, now) && u(rng) >= 0.01);
+      }
+    }
+    const PowerAction a = wd.tick(now);
+    if (a.kind == PowerAction::CUT) {
+      w.cut(a.device);
+      r.cycles += DEVICE_LETTER[a.device];
+      if (verbose) printf("    %7.1f min  CUT %s\n", now / 60000.0, DEVICES[a.device].name);
+    } else if (a.kind == PowerAction::RESTORE) {
+      w.restore(a.device, now);
+    }
+    noteRecovery(w, now, r);
+  }
+  return r;
+}
+
+// Watchdog-uri independente: modem <- IP public, router <- gateway, switch <- LAN;
+// fiecare cu pragul și cooldown-ul lui, fără să știe de ceilalți.
+static RunResult runNaive(const Scenario& sc, uint32_t seed) {
+  static const uint8_t OWN_TARGET[DEVICE_COUNT] = { PUBLIC, GATEWAY, LAN_HOST };
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  World w;
+  RunResult r;
+  uint8_t streak[DEVICE_COUNT] = {};
+  uint32_t nextProbe[DEVICE_COUNT] = {};
+  uint32_t restoreAt[DEVICE_COUNT] = {};
+  uint32_t holdUntil[DEVICE_COUNT] = {};
+  for (uint32_t now = 0; now < SIM_MS; now += 1000) {
+    if (now == FAULT_AT_MS) injectFault(w, sc, now);
+    for (uint8_t d = 0; d < DEVICE_COUNT; ++d) {
+      if (w.off[d] && (int32_t)(now - restoreAt[d]) >= 0) w.restore(d, now);
+      const uint8_t t = OWN_TARGET[d];
+      if ((int32_t)(now - nextProbe[d]) < 0 || (int32_t)(now - holdUntil[d]) < 0 || !w.wifiUp(now)) continue;
+      nextProbe[d] = now + (TARGETS[t].intervalMs ? TARGETS[t].intervalMs : PUBLIC_PING_INTERVAL_MS);
+      if (w.reachable(t, now) && u(rng) >= 0.01) {
+        streak[d] = 0;
+        continue;
+      }
+      if (++streak[d] < TARGETS[t].failThreshold) continue;
+      streak[d] = 0;
+      w.cut(d);
+      r.cycles += DEVICE_LETTER[d];
+      restoreAt[d] = now + DEVICES[d].pulseMs;
+      holdUntil[d] = now + DEVICES[d].pulseMs + DEVICES[d].settleMs + DEVICES[d].cooldownMs;
+    }
+    noteRecovery(w, now, r);
+  }
+  return r;
+}
+
+int main(int argc, char** argv) {
+  uint32_t seed = 1;
+  bool verbose = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+    } else {
+      seed = static_cast<uint32_t>(strtoul(argv[i], nullptr, 10));
+    }
+  }
+
+  bool ok = true;
+  size_t totalWd = 0, totalNaive = 0;
+  printf("%-26s %-9s %-8s %-12s %-9s %s\n", "scenario", "cycles", "ideal", "recovered", "naive", "");
+  for (const Scenario& sc : SCENARIOS) {
+    if (verbose) printf("  %s:\n", sc.name);
+    const RunResult r = runWatchdog(sc, seed, verbose);
+    const RunResult n = runNaive(sc, seed);
+    bool pass = r.cycles.size() <= sc.maxCycles && r.recovered;
+    if (sc.expected) pass = pass && r.cycles == sc.expected;
+    if (!sc.expected) pass = pass && r.cycles.find('S') == std::string::npos;  // ISP: switch-ul nu are ce căuta
+    char recovered[16];
+    if (r.recovered) {
+      snprintf(recovered, sizeof(recovered), "%.1f min", r.recoveredAtMs / 60000.0);
+    } else {
+      snprintf(recovered, sizeof(recovered), "NO");
+    }
+    printf("%-26s %-9s %-8s %-12s %-9s %s\n", sc.name, r.cycles.empty() ? "-" : r.cycles.c_str(), sc.expected ? (*sc.expected ? sc.expected : "-") : "<=4",
+           recovered, n.cycles.empty() ? "-" : n.cycles.c_str(), pass ? "ok" : "FAILED");
+    totalWd += r.cycles.size();
+    totalNaive += n.cycles.size();
+    ok = ok && pass;
+  }
+  printf("total power-cycles: watchdog %zu, independent watchdogs %zu\n", totalWd, totalNaive);
+
+  // cost pe trecere prin loop() fără rezultate noi (cazul obișnuit)
+  PowerWatchdog wd;
+  wd.begin(DEVICES, DEVICE_COUNT, TARGETS, TARGET_COUNT, 0);
+  const uint32_t passes = 20'000'000;
+  uint32_t sink = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < passes; ++i) {
+    const uint32_t now = 1000 + (i & 0xFFFF);  // sub interval: nicio probă scadentă
+    sink += wd.dueProbe(now);
+    sink += wd.tick(now).kind;
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  printf("idle pass (dueProbe + tick): %.2f ns  [sink %u]\n", std::chrono::duration<double, std::nano>(t1 - t0).count() / passes, sink & 1);
+
+  printf("%s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,671 @@
+// serial_log_analyzer.cpp — parser + timeline pentru capturile seriale ale firmware-ului (Linux)
+//
+// Build:
+//   g++ -O2 -std=c++17 -pthread serial_log_analyzer.cpp -o serial_log_analyzer
+//
+// Utilizare:
+//   ./serial_log_analyzer [--threads N] [--json] [--timeline out.csv] captura1.log [captura2.log ...]
+//   ./serial_log_analyzer --gen synthetic.log <MB>     generează o captură sintetică
+//   ./serial_log_analyzer --selftest [MB] [--threads N] generează, parsează și verifică numărătorile
+//
+// Fișierele sunt mapate cu mmap(); liniile sunt string_view-uri în mapare
+// (fără copiere). Un fișier mare se împarte în N bucăți la granițe de linie;
+// fiecare thread produce evenimentele bucății lui, iar timeline-ul (întreruperi,
+// power-cycle-uri, stări alarmă) se reconstruiește secvențial la merge.
+//
+// Formate recunoscute (exact cum le scrie src/main.cpp):
+//   [ EVENT= relay_1_ACTIVATED] :    dd/mm/YYYY HH:MM:SS
+//   N) [dd/mm/YYYY HH:MM:SS] PING Google OK (x ms)   (sau HTTPS probe OK, cu INTERNET_PROBE_HTTPS)
+//   >>{EVENT: relay_1_ACTIVATED Wifi is OFF | Date: dd/mm/YYYY HH:MM:SS |  N incercari de OFF>ON; } <<
+//   =====  N  ===== >>   ... Chip ID / Free heap / Alarmă ...   =====  N  =====  <<
+//   [STATUS] seq=N K|D up=S ... heap=H ... chip=0x...   (status incremental, status_delta.h)
+//   [BOOT] FW build: ...   /   [BOOT] Chip ID: 0x...
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+enum class EventType : uint8_t {
+  BOOT,
+  CHIP_ID,
+  STATUS_BLOCK,
+  FREE_HEAP,
+  PING_OK,
+  INTERNET_DOWN,
+  WIFI_DOWN,
+  WIFI_UP,
+  RELAY_ON,
+  RELAY_OFF,
+  RELAY_FORCED_OFF,
+  WIFI_OFF_TICK,
+  ALARM_STATE,
+};
+
+struct Event {
+  int64_t time;     // secunde (timp local naiv al plăcii), -1 = NO_REAL_TIME
+  uint32_t value;   // RTT, heap, chip id, stare alarmă, ...
+  EventType type;
+};
+
+struct Chunk {
+  const char* begin;
+  const char* end;
+  std::vector<Event> events;
+  uint64_t lines = 0;
+};
+
+static const char* const ALARM_STATES[] = { "DISARMED", "ARMING", "ARMED", "ALARMING", "ENTRY_DELAY", "ARMED_STAY" };
+static const uint32_t ALARM_STATE_COUNT = sizeof(ALARM_STATES) / sizeof(ALARM_STATES[0]);
+
+// ----------------------------
+// Tokenizer (fără alocări)
+// ----------------------------
+static bool startsWith(std::string_view s, std::string_view prefix) {
+  return s.size() >= prefix.size() && memcmp(s.data(), prefix.data(), prefix.size()) == 0;
+}
+
+static int digits(const char* p, int n) {
+  int v = 0;
+  for (int i = 0; i < n; ++i) {
+    const unsigned d = static_cast<unsigned>(p[i] - '0');
+    if (d > 9) return -1;
+    v = v * 10 + static_cast<int>(d);
+  }
+  return v;
+}
+
+static uint32_t parseUint(std::string_view s, size_t pos, int base = 10) {
+  uint32_t v = 0;
+  for (; pos < s.size(); ++pos) {
+    const char c = s[pos];
+    unsigned d;
+    if (c >= '0' && c <= '9') {
+      d = static_cast<unsigned>(c - '0');
+    } else if (base == 16 && c >= 'A' && c <= 'F') {
+      d = static_cast<unsigned>(c - 'A' + 10);
+    } else if (base == 16 && c >= 'a' && c <= 'f') {
+      d = static_cast<unsigned>(c - 'a' + 10);
+    } else {
+      break;
+    }
+    v = v * static_cast<unsigned>(base) + d;
+  }
+  return v;
+}
+
+// zile de la 1970-01-01 (algoritmul civil al lui H. Hinnant)
+static int64_t daysFromCivil(int y, int m, int d) {
+  y -= m <= 2;
+  const int64_t era = (y >= 0 ? y : y - 399) / 400;
+  const unsigned yoe = static_cast<unsigned>(y - era * 400);
+  const unsigned doy = static_cast<unsigned>((153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1);
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+// "dd/mm/YYYY HH:MM[:SS]" la poziția pos; -1 dacă lipsește (ex. NO_REAL_TIME)
+static int64_t parseDateTime(std::string_view s, size_t pos) {
+  if (pos + 16 > s.size()) return -1;
+  const char* p = s.data() + pos;
+  if (p[2] != '/' || p[5] != '/' || p[10] != ' ' || p[13] != ':') return -1;
+  const int day = digits(p, 2), month = digits(p + 3, 2), year = digits(p + 6, 4);
+  const int hour = digits(p + 11, 2), minute = digits(p + 14, 2);
+  int second = 0;
+  if (pos + 19 <= s.size() && p[16] == ':') second = digits(p + 17, 2);
+  if (day < 0 || month < 0 || year < 0 || hour < 0 || minute < 0 || second < 0) return -1;
+  return daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+}
+
+static void classifyLine(std::string_view line, std::vector<Event>& out) {
+  if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+  if (line.empty()) return;
+
+  switch (line[0]) {
+    case '[': {
+      if (startsWith(line, "[STATUS] seq=")) {
+        // delta-urile conțin doar câmpurile schimbate: heap/chip apar când se schimbă
+        out.push_back({ -1, parseUint(line, 13), EventType::STATUS_BLOCK });
+        const size_t heap = line.find(" heap=");
+        if (heap != std::string_view::npos) out.push_back({ -1, parseUint(line, heap + 6), EventType::FREE_HEAP });
+        const size_t chip = line.find(" chip=0x");
+        if (chip != std::string_view::npos) out.push_back({ -1, parseUint(line, chip + 8, 16), EventType::CHIP_ID });
+        return;
+      }
+      static const std::string_view EVENT_PREFIX = "[ EVENT= ";
+      if (startsWith(line, EVENT_PREFIX)) {
+        const size_t close = line.find("] :    ", EVENT_PREFIX.size());
+        if (close == std::string_view::npos) return;
+        const std::string_view msg = line.substr(EVENT_PREFIX.size(), close - EVENT_PREFIX.size());
+        const int64_t t = parseDateTime(line, close + 7);
+        if (msg == "relay_1_ACTIVATED") {
+          out.push_back({ t, 0, EventType::RELAY_ON });
+        } else if (msg == "relay_1_DEACTIVATED") {
+          out.push_back({ t, 0, EventType::RELAY_OFF });
+        } else if (msg == "relay_1_FORCED_INACTIVE_wifi_connected") {
+          out.push_back({ t, 0, EventType::RELAY_FORCED_OFF });
+        } else if (msg == "internet_DOWN_detected") {
+          out.push_back({ t, 0, EventType::INTERNET_DOWN });
+        } else if (msg == "WiFi transition: CONNECTED -> DISCONNECTED") {
+          out.push_back({ t, 0, EventType::WIFI_DOWN });
+        } else if (msg == "WiFi transition: DISCONNECTED -> CONNECTED") {
+          out.push_back({ t, 0, EventType::WIFI_UP });
+        } else if (startsWith(msg, "Alarm state -> ")) {
+          // "Alarm state -> ARMED (P1)"; capturile vechi nu au partiția
+          std::string_view st = msg.substr(15);
+          uint32_t partition = 1;
+          const size_t paren = st.find(" (P");
+          if (paren != std::string_view::npos) {
+            partition = parseUint(st, paren + 3);
+            st = st.substr(0, paren);
+          }
+          for (uint32_t i = 0; i < ALARM_STATE_COUNT; ++i) {
+            if (st == ALARM_STATES[i]) out.push_back({ t, i | (partition << 8), EventType::ALARM_STATE });
+          }
+        }
+        return;
+      }
+      if (startsWith(line, "[BOOT] Chip ID: 0x")) {
+        out.push_back({ -1, parseUint(line, 18, 16), EventType::CHIP_ID });
+      } else if (startsWith(line, "[BOOT] FW build: ")) {
+        out.push_back({ -1, 0, EventType::BOOT });
+      }
+      return;
+    }
+    case '>':
+      if (startsWith(line, ">>{EVENT: ")) {
+        const size_t date = line.find("| Date: ");
+        out.push_back({ date == std::string_view::npos ? -1 : parseDateTime(line, date + 8), 0, EventType::WIFI_OFF_TICK });
+      }
+      return;
+    case '=':
+      if (startsWith(line, "=====  ") && line.size() > 4 && line.substr(line.size() - 2) == ">>") {
+        out.push_back({ -1, parseUint(line, 7), EventType::STATUS_BLOCK });
+      }
+      return;
+    case 'C':
+      if (startsWith(line, "Chip ID: ")) {
+        out.push_back({ -1, parseUint(line, 9, 16), EventType::CHIP_ID });
+      }
+      return;
+    case 'F':
+      if (startsWith(line, "Free heap: ")) {
+        out.push_back({ -1, parseUint(line, 11), EventType::FREE_HEAP });
+      }
+      return;
+    default:
+      break;
+  }
+
+  // "N) [dd/mm/YYYY HH:MM:SS] PING Google OK (x ms)" / "... HTTPS probe OK (x ms)"
+  if (line[0] >= '0' && line[0] <= '9') {
+    const size_t br = line.find(") [");
+    if (br == std::string_view::npos || br > 10) return;
+    static const std::string_view PING_OK = "] PING Google OK (";
+    static const std::string_view PROBE_OK = "] HTTPS probe OK (";
+    size_t ok = line.find(PING_OK, br);
+    if (ok == std::string_view::npos) ok = line.find(PROBE_OK, br);
+    if (ok == std::string_view::npos) return;
+    out.push_back({ parseDateTime(line, br + 3), parseUint(line, ok + PING_OK.size()), EventType::PING_OK });
+  }
+}
+
+static void parseChunk(Chunk* c) {
+  const char* p = c->begin;
+  c->events.reserve(static_cast<size_t>(c->end - c->begin) / 256);
+  while (p < c->end) {
+    const char* nl = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(c->end - p)));
+    const char* lineEnd = nl ? nl : c->end;
+    classifyLine(std::string_view(p, static_cast<size_t>(lineEnd - p)), c->events);
+    ++c->lines;
+    p = lineEnd + 1;
+  }
+}
+
+// ----------------------------
+// Timeline + agregare (secvențial, peste evenimente)
+// ----------------------------
+struct DeviceStats {
+  std::string name;
+  uint64_t lines = 0;
+  uint64_t pingsOk = 0;
+  uint64_t rttSum = 0;
+  uint32_t rttMax = 0;
+  uint32_t outages = 0;
+  int64_t outageSeconds = 0;
+  int64_t longestOutage = 0;
+  uint32_t routerPowerCycles = 0;
+  uint32_t alarmStateChanges = 0;
+  uint32_t alarmsTriggered = 0;
+  uint32_t reboots = 0;
+  uint32_t statusBlocks = 0;
+  uint32_t minFreeHeap = UINT32_MAX;
+  int64_t firstTime = -1;
+  int64_t lastTime = -1;
+  // stare pentru timeline
+  bool bootPending = false;  // BOOT apare înaintea liniei cu Chip ID
+  bool down = false;
+  int64_t downSince = -1;
+};
+
+static void formatTime(int64_t t, char* out, size_t size) {
+  if (t < 0) {
+    snprintf(out, size, "NO_REAL_TIME");
+    return;
+  }
+  const int64_t days = t / 86400;
+  int64_t rem = t % 86400;
+  // civil din zile (inversul lui daysFromCivil)
+  const int64_t z = days + 719468;
+  const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+  const unsigned doe = static_cast<unsigned>(z - era * 146097);
+  const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const unsigned mp = (5 * doy + 2) / 153;
+  const unsigned d = doy - (153 * mp + 2) / 5 + 1;
+  const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+  const int64_t y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+  snprintf(out, size, "%04lld-%02u-%02u %02lld:%02lld:%02lld", static_cast<long long>(y), m, d,
+           static_cast<long long>(rem / 3600), static_cast<long long>((rem % 3600) / 60), static_cast<long long>(rem % 60));
+}
+
+struct Timeline {
+  FILE* csv = nullptr;
+
+  void emit(const DeviceStats& d, int64_t t, const char* what, const char* detail) {
+    if (csv == nullptr) return;
+    char ts[48];
+    formatTime(t, ts, sizeof(ts));
+    fprintf(csv, "%s,%s,%s,%s\n", d.name.c_str(), ts, what, detail);
+  }
+};
+
+static void outageStart(DeviceStats& d, Timeline& tl, int64_t t, const char* cause) {
+  if (d.down) return;
+  d.down = true;
+  d.downSince = t;
+  ++d.outages;
+  tl.emit(d, t, "OUTAGE_START", cause);
+}
+
+static void outageEnd(DeviceStats& d, Timeline& tl, int64_t t, const char* cause) {
+  if (!d.down) return;
+  d.down = false;
+  if (t >= 0 && d.downSince >= 0 && t >= d.downSince) {
+    const int64_t len = t - d.downSince;
+    d.outageSeconds += len;
+    d.longestOutage = std::max(d.longestOutage, len);
+  }
+  tl.emit(d, t, "OUTAGE_END", cause);
+}
+
+static void applyEvent(std::map<std::string, DeviceStats>& devices, DeviceStats*& cur, const std::string& fileName, const Event& e, Timeline& tl) {
+  if (e.type == EventType::CHIP_ID) {
+    char name[16];
+    snprintf(name, sizeof(name), "%08X", e.value);
+    DeviceStats& next = devices[name];
+    if (next.name.empty()) next.name = name;
+    if (cur != &next && cur->name == fileName) {
+      // statisticile dinaintea primului Chip ID aparțin aceluiași dispozitiv
+      DeviceStats pending = *cur;
+      devices.erase(fileName);
+      DeviceStats& dst = devices[name];
+      dst.lines += pending.lines;
+      dst.pingsOk += pending.pingsOk;
+      dst.rttSum += pending.rttSum;
+      dst.rttMax = std::max(dst.rttMax, pending.rttMax);
+      dst.outages += pending.outages;
+      dst.outageSeconds += pending.outageSeconds;
+      dst.longestOutage = std::max(dst.longestOutage, pending.longestOutage);
+      dst.routerPowerCycles += pending.routerPowerCycles;
+      dst.alarmStateChanges += pending.alarmStateChanges;
+      dst.alarmsTriggered += pending.alarmsTriggered;
+      dst.reboots += pending.reboots;
+      dst.statusBlocks += pending.statusBlocks;
+      dst.minFreeHeap = std::min(dst.minFreeHeap, pending.minFreeHeap);
+      if (dst.firstTime < 0) dst.firstTime = pending.firstTime;
+      dst.lastTime = std::max(dst.lastTime, pending.lastTime);
+      dst.bootPending = pending.bootPending;
+      dst.down = pending.down;
+      dst.downSince = pending.downSince;
+    }
+    cur = &devices[name];
+    if (cur->bootPending) {
+      cur->bootPending = false;
+      tl.emit(*cur, cur->lastTime, "BOOT", "");
+    }
+    return;
+  }
+
+  DeviceStats& d = *cur;
+  if (d.bootPending && e.type != EventType::BOOT) {
+    d.bootPending = false;
+    tl.emit(d, d.lastTime, "BOOT", "");
+  }
+  if (e.time >= 0) {
+    if (d.firstTime < 0) d.firstTime = e.time;
+    d.lastTime = std::max(d.lastTime, e.time);
+  }
+  switch (e.type) {
+    case EventType::BOOT:
+      ++d.reboots;
+      d.bootPending = true;
+      break;
+    case EventType::STATUS_BLOCK: ++d.statusBlocks; break;
+    case EventType::FREE_HEAP: d.minFreeHeap = std::min(d.minFreeHeap, e.value); break;
+    case EventType::PING_OK:
+      ++d.pingsOk;
+      d.rttSum += e.value;
+      d.rttMax = std::max(d.rttMax, e.value);
+      outageEnd(d, tl, e.time, "ping_ok");
+      break;
+    case EventType::INTERNET_DOWN: outageStart(d, tl, e.time, "ping_fail"); break;
+    case EventType::WIFI_DOWN: outageStart(d, tl, e.time, "wifi_down"); break;
+    case EventType::WIFI_OFF_TICK: outageStart(d, tl, e.time, "wifi_off"); break;
+    case EventType::WIFI_UP: outageEnd(d, tl, e.time, "wifi_up"); break;
+    case EventType::RELAY_ON:
+      ++d.routerPowerCycles;
+      tl.emit(d, e.time, "ROUTER_POWER_CYCLE", "relay_1_ACTIVATED");
+      break;
+    case EventType::RELAY_OFF:
+    case EventType::RELAY_FORCED_OFF: break;
+    case EventType::ALARM_STATE: {
+      ++d.alarmStateChanges;
+      if ((e.value & 0xFF) == 3) ++d.alarmsTriggered;
+      char detail[32];
+      snprintf(detail, sizeof(detail), "P%u %s", e.value >> 8, ALARM_STATES[e.value & 0xFF]);
+      tl.emit(d, e.time, "ALARM_STATE", detail);
+      break;
+    }
+    case EventType::CHIP_ID: break;
+  }
+}
+
+// ----------------------------
+// Generator de captură sintetică
+// ----------------------------
+// Ce a scris generatorul; --selftest compară cu ce reconstruiește parserul.
+struct SyntheticCounts {
+  uint64_t pings = 0;
+  uint32_t outages = 0;
+  uint32_t powerCycles = 0;
+  uint32_t statusBlocks = 0;
+  uint32_t alarmStates = 0;
+  uint32_t alarmsTriggered = 0;
+};
+
+// Ciclul de stări scris pe partiții alternative (indici în ALARM_STATES)
+static const uint8_t SYNTHETIC_ALARM_CYCLE[] = { 1, 2, 4, 0, 1, 2, 4, 3, 0, 5, 3, 0 };
+
+static int generateSynthetic(const char* path, uint64_t megabytes, SyntheticCounts* counts = nullptr) {
+  FILE* f = fopen(path, "wb");
+  if (f == nullptr) {
+    perror(path);
+    return 1;
+  }
+  const uint64_t target = megabytes << 20;
+  uint64_t written = 0;
+  int64_t t = daysFromCivil(2026, 1, 1) * 86400;
+  uint32_t ping = 0, status = 0, rng = 12345;
+  SyntheticCounts gen;
+  char ts[48], line[512];
+  auto stamp = [&](int64_t when) {
+    char iso[48];
+    formatTime(when, iso, sizeof(iso));  // YYYY-MM-DD HH:MM:SS -> dd/mm/YYYY HH:MM:SS
+    snprintf(ts, sizeof(ts), "%.2s/%.2s/%.4s %.8s", iso + 8, iso + 5, iso, iso + 11);
+  };
+  auto put = [&](const char* s) {
+    const size_t n = strlen(s);
+    fwrite(s, 1, n, f);
+    written += n;
+  };
+
+  put("[BOOT] ===========================================\r\n[BOOT] FW build: Oct 19 2026 10:00:00\r\n[BOOT] Chip ID: 0xC0FFEE\r\n");
+  while (written < target) {
+    t += 60;
+    rng = rng * 1103515245u + 12345u;
+    stamp(t);
+    if ((rng >> 16) % 500 == 0) {
+      snprintf(line, sizeof(line), "[ EVENT= internet_DOWN_detected] :    %s\r\n[ EVENT= relay_1_ACTIVATED] :    %s\r\n", ts, ts);
+      put(line);
+      for (int i = 0; i < 30; ++i) {
+        stamp(t + i);
+        snprintf(line, sizeof(line), ">>{EVENT: relay_1_ACTIVATED Wifi is OFF | Date: %s |  1 incercari de OFF>ON; } <<\r\n", ts);
+        put(line);
+      }
+      t += 30;
+      stamp(t);
+      snprintf(line, sizeof(line), "[ EVENT= relay_1_DEACTIVATED] :    %s\r\n[ EVENT= WiFi transition: DISCONNECTED -> CONNECTED] :    %s\r\n", ts, ts);
+      put(line);
+      ++gen.outages;
+      ++gen.powerCycles;
+    }
+    if ((rng >> 20) % 40 == 0) {
+      // o captură veche din 16 nu are partiția (parserul o ia ca P1)
+      const uint32_t state = SYNTHETIC_ALARM_CYCLE[gen.alarmStates % sizeof(SYNTHETIC_ALARM_CYCLE)];
+      char partition[8] = "";
+      if (gen.alarmStates % 16 != 15) snprintf(partition, sizeof(partition), " (P%u)", 1 + gen.alarmStates % 2);
+      snprintf(line, sizeof(line), "[ EVENT= Alarm state -> %s%s] :    %s\r\n", ALARM_STATES[state], partition, ts);
+      put(line);
+      ++gen.alarmStates;
+      if (state == 3) ++gen.alarmsTriggered;
+    }
+    snprintf(line, sizeof(line), "\r\n%u) [%s] PING Google OK (%u ms)\r\n", ++ping, ts, 10 + (rng >> 8) % 60);
+    put(line);
+    ++gen.pings;
+    if (ping % 2 == 0) {
+      ++status;
+      ++gen.statusBlocks;
+      snprintf(line, sizeof(line),
+               "\r\n\r\n=====  %u  ===== >>\r\n\xF0\x9F\x9A\xA8[ Stare alarm\xC4\x83]\r\nAlarm\xC4\x83: ARMED\r\nInternet relay: INACTIVE\r\n"
+               "Ping down activ: NO\r\nPing down start: NO_REAL_TIME\r\n\r\nSystem ::\r\nFree heap: %u\r\nChip ID: C0FFEE\r\n=====  %u  =====  <<\r\n\r\n",
+               status, 38000 + (rng >> 4) % 4000, status);
+      put(line);
+    }
+  }
+  fclose(f);
+  printf("wrote %llu bytes to %s (%u alarm state lines, %u ALARMING)\n", static_cast<unsigned long long>(written), path,
+         gen.alarmStates, gen.alarmsTriggered);
+  if (counts) *counts = gen;
+  return 0;
+}
+
+// ----------------------------
+// Parsare fișier (mmap + bucăți pe thread-uri)
+// ----------------------------
+static bool analyzeFile(const char* path, unsigned threads, std::map<std::string, DeviceStats>& devices, Timeline& tl,
+                        uint64_t& totalBytes, double& parseSeconds) {
+  const int fd = open(path, O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    perror(path);
+    return false;
+  }
+  const size_t size = static_cast<size_t>(st.st_size);
+  if (size == 0) {
+    close(fd);
+    return true;
+  }
+  const char* data = static_cast<const char*>(mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0));
+  if (data == MAP_FAILED) {
+    perror("mmap");
+    close(fd);
+    return false;
+  }
+  madvise(const_cast<char*>(data), size, MADV_SEQUENTIAL);
+
+  // bucăți la granițe de linie (minim 4 MB per thread)
+  const unsigned n = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(1, size >> 22)));
+  std::vector<Chunk> chunks(n);
+  const char* pos = data;
+  for (unsigned i = 0; i < n; ++i) {
+    const char* end = (i + 1 == n) ? data + size : data + size / n * (i + 1);
+    if (end < data + size) {
+      const char* nl = static_cast<const char*>(memchr(end, '\n', static_cast<size_t>(data + size - end)));
+      end = nl ? nl + 1 : data + size;
+    }
+    chunks[i].begin = pos;
+    chunks[i].end = std::max(pos, end);
+    pos = chunks[i].end;
+  }
+
+  const auto t0 = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (unsigned i = 1; i < n; ++i) workers.emplace_back(parseChunk, &chunks[i]);
+  parseChunk(&chunks[0]);
+  for (auto& w : workers) w.join();
+
+  const std::string fileName = path;
+  DeviceStats* cur = &devices[fileName];
+  cur->name = fileName;
+  for (const Chunk& c : chunks) {
+    cur->lines += c.lines;
+    for (const Event& e : c.events) applyEvent(devices, cur, fileName, e, tl);
+  }
+  parseSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  totalBytes += size;
+
+  munmap(const_cast<char*>(data), size);
+  close(fd);
+  return true;
+}
+
+// --selftest: captura sintetică trebuie să iasă cu exact numărătorile scrise,
+// și cu un singur thread, și împărțită în bucăți pe mai multe thread-uri.
+static int selfTest(uint64_t megabytes, unsigned threads) {
+  char path[] = "/tmp/serial_log_selftestXXXXXX";
+  const int fd = mkstemp(path);
+  if (fd < 0) {
+    perror("mkstemp");
+    return 1;
+  }
+  close(fd);
+  SyntheticCounts gen;
+  if (generateSynthetic(path, megabytes, &gen) != 0) {
+    unlink(path);
+    return 1;
+  }
+
+  bool ok = true;
+  auto check = [&](const char* what, bool pass) {
+    printf("%-60s %s\n", what, pass ? "ok" : "FAILED");
+    ok = ok && pass;
+  };
+  check("generator wrote alarm state lines incl. ALARMING", gen.alarmStates > 0 && gen.alarmsTriggered > 0);
+  const unsigned runs[] = { 1, std::max(2u, threads) };
+  for (unsigned n : runs) {
+    std::map<std::string, DeviceStats> devices;
+    Timeline tl;
+    uint64_t bytes = 0;
+    double seconds = 0.0;
+    const bool parsed = analyzeFile(path, n, devices, tl, bytes, seconds);
+    const auto it = devices.find("00C0FFEE");
+    const bool one = parsed && devices.size() == 1 && it != devices.end();
+    const DeviceStats d = one ? it->second : DeviceStats();
+    char what[96];
+    snprintf(what, sizeof(what), "[%u threads] single device 00C0FFEE", n);
+    check(what, one);
+    snprintf(what, sizeof(what), "[%u threads] alarm_state_changes == %u generated", n, gen.alarmStates);
+    check(what, d.alarmStateChanges == gen.alarmStates);
+    snprintf(what, sizeof(what), "[%u threads] alarms_triggered == %u ALARMING generated", n, gen.alarmsTriggered);
+    check(what, d.alarmsTriggered == gen.alarmsTriggered);
+    snprintf(what, sizeof(what), "[%u threads] pings/outages/power cycles/status blocks match", n);
+    check(what, d.pingsOk == gen.pings && d.outages == gen.outages && d.routerPowerCycles == gen.powerCycles &&
+                    d.statusBlocks == gen.statusBlocks);
+    snprintf(what, sizeof(what), "[%u threads] one boot", n);
+    check(what, d.reboots == 1);
+  }
+  unlink(path);
+  printf("%s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
+
+// ----------------------------
+// main
+// ----------------------------
+static void writeStats(const std::map<std::string, DeviceStats>& devices, bool json) {
+  if (json) {
+    printf("[\n");
+    size_t i = 0;
+    for (const auto& kv : devices) {
+      const DeviceStats& d = kv.second;
+      printf("  {\"device\":\"%s\",\"lines\":%llu,\"pings_ok\":%llu,\"rtt_avg_ms\":%.1f,\"rtt_max_ms\":%u,"
+             "\"outages\":%u,\"outage_seconds\":%lld,\"longest_outage_s\":%lld,\"router_power_cycles\":%u,"
+             "\"alarm_state_changes\":%u,\"alarms_triggered\":%u,\"reboots\":%u,\"status_blocks\":%u,\"min_free_heap\":%u}%s\n",
+             d.name.c_str(), static_cast<unsigned long long>(d.lines), static_cast<unsigned long long>(d.pingsOk),
+             d.pingsOk ? static_cast<double>(d.rttSum) / static_cast<double>(d.pingsOk) : 0.0, d.rttMax, d.outages,
+             static_cast<long long>(d.outageSeconds), static_cast<long long>(d.longestOutage), d.routerPowerCycles,
+             d.alarmStateChanges, d.alarmsTriggered, d.reboots, d.statusBlocks, d.minFreeHeap == UINT32_MAX ? 0 : d.minFreeHeap,
+             ++i < devices.size() ? "," : "");
+    }
+    printf("]\n");
+    return;
+  }
+  printf("device,lines,pings_ok,rtt_avg_ms,rtt_max_ms,outages,outage_seconds,longest_outage_s,router_power_cycles,alarm_state_changes,alarms_triggered,reboots,status_blocks,min_free_heap\n");
+  for (const auto& kv : devices) {
+    const DeviceStats& d = kv.second;
+    printf("%s,%llu,%llu,%.1f,%u,%u,%lld,%lld,%u,%u,%u,%u,%u,%u\n", d.name.c_str(), static_cast<unsigned long long>(d.lines),
+           static_cast<unsigned long long>(d.pingsOk), d.pingsOk ? static_cast<double>(d.rttSum) / static_cast<double>(d.pingsOk) : 0.0,
+           d.rttMax, d.outages, static_cast<long long>(d.outageSeconds), static_cast<long long>(d.longestOutage), d.routerPowerCycles,
+           d.alarmStateChanges, d.alarmsTriggered, d.reboots, d.statusBlocks, d.minFreeHeap == UINT32_MAX ? 0 : d.minFreeHeap);
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc >= 4 && strcmp(argv[1], "--gen") == 0) {
+    return generateSynthetic(argv[2], strtoull(argv[3], nullptr, 10));
+  }
+
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  bool json = false;
+  bool selftest = false;
+  uint64_t selftestMegabytes = 16;
+  Timeline tl;
+  std::vector<const char*> files;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--selftest") == 0) {
+      selftest = true;
+      if (i + 1 < argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9') selftestMegabytes = strtoull(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      threads = std::max(1, atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--json") == 0) {
+      json = true;
+    } else if (strcmp(argv[i], "--timeline") == 0 && i + 1 < argc) {
+      tl.csv = fopen(argv[++i], "w");
+      if (tl.csv) fprintf(tl.csv, "device,time,event,detail\n");
+    } else {
+      files.push_back(argv[i]);
+    }
+  }
+  if (selftest) return selfTest(std::max<uint64_t>(1, selftestMegabytes), threads);
+  if (files.empty()) {
+    fprintf(stderr, "usage: %s [--threads N] [--json] [--timeline out.csv] capture.log...\n       %s --gen out.log <MB>\n"
+                    "       %s --selftest [MB] [--threads N]\n", argv[0], argv[0], argv[0]);
+    return 2;
+  }
+
+  std::map<std::string, DeviceStats> devices;
+  uint64_t totalBytes = 0;
+  double parseSeconds = 0.0;
+
+  for (const char* path : files) {
+    if (!analyzeFile(path, threads, devices, tl, totalBytes, parseSeconds)) return 1;
+  }
+
+  writeStats(devices, json);
+  if (tl.csv) fclose(tl.csv);
+  fprintf(stderr, "parsed %.1f MB in %.3f s (%.0f MB/s, %u threads)\n", static_cast<double>(totalBytes) / 1048576.0,
+          parseSeconds, static_cast<double>(totalBytes) / 1048576.0 / std::max(parseSeconds, 1e-9), threads);
+  return 0;
+}
@@ -0,0 +1,424 @@
+// status_delta_sim.cpp — statusul incremental (include/status_delta.h) față de blocul complet (host)
+//
+// Build:
+//   g++ -O2 -std=c++17 -I../include status_delta_sim.cpp -o status_delta_sim
+//
+// Utilizare:
+//   ./status_delta_sim [days=1] [loss%=2]   zi simulată: bytes full vs delta + verificarea reconstrucției
+//   ./status_delta_sim decode < captura.log reface starea din liniile [STATUS] ale unei capturi
+//
+// Simularea rulează un dispozitiv tipic (armare dimineața, o alarmă, o pană de
+// WiFi noaptea, heap/RSSI care fluctuează, ping la 60 s) și scoate la fiecare
+// 30 s ambele formate: blocul complet exact ca printRuntimeStatus() (textele RO
+// din messages.h) și linia [STATUS]. Decodorul trebuie să refacă la fiecare
+// raport exact valorile trimise; în a doua trecere se pierd aleator loss% din
+// linii și decodorul trebuie să sară delta-urile până la următorul keyframe.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "messages.h"
+#include "status_delta.h"
+
+static const uint32_t REPORT_INTERVAL_S = 30;        // STATUS_AUTO_INTERVAL_MS
+static const uint16_t KEYFRAME_EVERY = 20;           // STATUS_KEYFRAME_EVERY
+static const uint8_t PARTITIONS = 2;                 // ALARM_PARTITION_COUNT
+static const uint32_t UART_BYTES_PER_SEC = 115200 / 10;
+
+// Ce ar citi printRuntimeStatus() din SystemState + WiFi/ESP.
+struct SimDevice {
+  const char* partition[PARTITIONS] = { "DISARMED", "DISARMED" };
+  int timer[PARTITIONS] = { -1, -1 };  // secunde rămase, -1 = fără timer
+  uint32_t triggers = 0;
+  bool relayActive = false;
+  bool pingDown = false;
+  uint32_t pingDownStartEpoch = 0;
+  bool wifiUp = true;
+  int rssi = -62;
+  uint32_t lastDisconnectEpoch = 0;
+  uint32_t wifiDownSinceS = 0;
+  uint32_t pings = 0;
+  uint32_t pingIntervalMs = 60'000;
+  uint32_t heap = 31'240;
+  uint8_t consoleClients = 0;
+  uint32_t traceBytes = 0;
+  uint32_t traceSaved = 0;
+  uint32_t httpsRequests = 0;
+  uint32_t httpsResumed = 0;
+  uint32_t statusCounter = 0;
+};
+
+static const uint32_t EPOCH_DAY0 = 1'792'368'000;  // 19/10/2026 00:00 (UTC, ca în capturi)
+static const uint32_t CHIP_ID = 0x00A1B2C3;
+
+static uint32_t rngState = 12345;
+static uint32_t rng() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+static void formatEpoch(uint32_t epoch, char* out, size_t outSize) {
+  if (epoch == 0) {
+    snprintf(out, outSize, "-");
+    return;
+  }
+  const time_t t = static_cast<time_t>(epoch);
+  struct tm tmInfo;
+  gmtime_r(&t, &tmInfo);
+  strftime(out, outSize, "%d/%m/%Y %H:%M:%S", &tmInfo);
+}
+
+static void formatDuration(uint32_t s, char* out, size_t outSize) {
+  snprintf(out, outSize, "%u:%02u:%02u", s / 3600, (s / 60) % 60, s % 60);
+}
+
+static const char* alarmSummary(const SimDevice& d) {
+  // prioritatea din alarm_fsm.h: ALARMING > ENTRY_DELAY > ARMED > ARMING > DISARMED
+  static const char* const ORDER[] = { "ALARMING", "ENTRY_DELAY", "ARMED", "ARMED_STAY", "ARMING" };
+  for (const char* s : ORDER) {
+    for (uint8_t i = 0; i < PARTITIONS; ++i) {
+      if (strcmp(d.partition[i], s) == 0) return s;
+    }
+  }
+  return "DISARMED";
+}
+
+// O secundă din viața dispozitivului.
+static void simulateSecond(SimDevice& d, uint32_t t) {
+  const uint32_t tod = t % 86400;
+  for (uint8_t i = 0; i < PARTITIONS; ++i) {
+    if (d.timer[i] > 0) --d.timer[i];
+  }
+  // P1 (parter): armat 08:00-18:00 cu exit delay, o alarmă la 13:00
+  if (tod == 8 * 3600) {
+    d.partition[0] = "ARMING";
+    d.timer[0] = 10;
+  } else if (strcmp(d.partition[0], "ARMING") == 0 && d.timer[0] == 0) {
+    d.partition[0] = "ARMED";
+    d.timer[0] = -1;
+  } else if (tod == 13 * 3600) {
+    d.partition[0] = "ALARMING";
+    d.timer[0] = 30;
+    ++d.triggers;
+    d.traceSaved++;
+  } else if (strcmp(d.partition[0], "ALARMING") == 0 && d.timer[0] == 0) {
+    d.partition[0] = "ARMED";
+    d.timer[0] = -1;
+  } else if (tod == 18 * 3600) {
+    d.partition[0] = "DISARMED";
+  }
+  // P2 (etaj): stay noaptea
+  if (tod == 23 * 3600) d.partition[1] = "ARMED_STAY";
+  if (tod == 7 * 3600) d.partition[1] = "DISARMED";
+
+  // pană de WiFi 02:10-02:25; releul pornește după 120 s
+  if (tod == 2 * 3600 + 600) {
+    d.wifiUp = false;
+    d.wifiDownSinceS = t;
+    d.lastDisconnectEpoch = EPOCH_DAY0 + t;
+    d.pingDown = true;
+    d.pingDownStartEpoch = EPOCH_DAY0 + t;
+    d.pingIntervalMs = 10'000;
+  } else if (!d.wifiUp && t - d.wifiDownSinceS == 120) {
+    d.relayActive = true;
+  } else if (tod == 2 * 3600 + 1500) {
+    d.wifiUp = true;
+    d.relayActive = false;
+    d.pingDown = false;
+    d.pingIntervalMs = 60'000;
+  }
+
+  if (d.wifiUp && t % (d.pingIntervalMs / 1000) == 0) ++d.pings;
+  if (tod == 9 * 3600) d.consoleClients = 1;
+  if (tod == 9 * 3600 + 1800) d.consoleClients = 0;
+  if (d.wifiUp && tod % 3600 == 1800) {
+    ++d.httpsRequests;
+    if (d.httpsRequests > 1) ++d.httpsResumed;
+  }
+  if (t % 5 == 0) d.traceBytes = (d.traceBytes + 3) % 8192;
+}
+
+// Variația dintre rapoarte: heap-ul se mișcă la aproape fiecare raport, RSSI des.
+static void jitter(SimDevice& d) {
+  if (rng() % 100 < 60) d.heap = 30'000 + (d.heap - 30'000 + rng() % 801 - 400 + 4000) % 4000;
+  if (d.wifiUp && rng() % 100 < 35) d.rssi = -70 + static_cast<int>(rng() % 15);
+}
+
+using FieldList = std::vector<std::pair<StatusField, std::string>>;
+
+// Aceleași valori, în aceeași ordine, ca printStatusDelta() din main.cpp.
+static FieldList statusFields(const SimDevice& d, uint32_t t) {
+  FieldList f;
+  char text[48];
+  f.emplace_back(StatusField::ALARM, alarmSummary(d));
+  for (uint8_t i = 0; i < PARTITIONS; ++i) {
+    const uint8_t p = static_cast<uint8_t>(StatusField::P1) + 2 * i;
+    f.emplace_back(static_cast<StatusField>(p), d.partition[i]);
+    f.emplace_back(static_cast<StatusField>(p + 1), d.timer[i] >= 0 ? std::to_string(d.timer[i]) : "-");
+  }
+  f.emplace_back(StatusField::TRIGGERS, std::to_string(d.triggers));
+  f.emplace_back(StatusField::RELAY, d.relayActive ? "ACTIVE" : "INACTIVE");
+  f.emplace_back(StatusField::PING_DOWN, d.pingDown ? "YES" : "NO");
+  formatEpoch(d.pingDownStartEpoch, text, sizeof(text));
+  f.emplace_back(StatusField::PING_DOWN_START, text);
+  f.emplace_back(StatusField::WIFI, d.wifiUp ? "CONNECTED" : "DISCONNECTED");
+  f.emplace_back(StatusField::WIFI_EMULATION, "OFF");
+  f.emplace_back(StatusField::IP, d.wifiUp ? "192.168.1.57" : "-");
+  f.emplace_back(StatusField::GATEWAY, d.wifiUp ? "192.168.1.1" : "-");
+  f.emplace_back(StatusField::DNS, d.wifiUp ? "192.168.1.1" : "-");
+  f.emplace_back(StatusField::RSSI, d.wifiUp ? std::to_string(d.rssi) : "-");
+  f.emplace_back(StatusField::SSID, d.wifiUp ? "Casa \"Sus\" 2G" : "-");
+  f.emplace_back(StatusField::CHANNEL, d.wifiUp ? "6" : "-");
+  f.emplace_back(StatusField::LAST_CONNECT, d.wifiUp ? "fast/182/341" : "-");
+  formatEpoch(d.lastDisconnectEpoch, text, sizeof(text));
+  f.emplace_back(StatusField::LAST_DISCONNECT, text);
+  formatDuration(d.wifiUp ? 0 : t - d.wifiDownSinceS, text, sizeof(text));
+  f.emplace_back(StatusField::WIFI_DOWN_FOR, text);
+  f.emplace_back(StatusField::PING_COUNTER, std::to_string(d.pings));
+  f.emplace_back(StatusField::PING_INTERVAL, std::to_string(d.pingIntervalMs));
+  f.emplace_back(StatusField::NTP_STARTED, "YES");
+  f.emplace_back(StatusField::NTP_READY, "YES");
+  f.emplace_back(StatusField::FREE_HEAP, std::to_string(d.heap));
+  f.emplace_back(StatusField::OTA, "IDLE");
+  f.emplace_back(StatusField::CONSOLE_CLIENTS, std::to_string(d.consoleClients));
+  f.emplace_back(StatusField::CONSOLE_DROPPED, "0");
+  f.emplace_back(StatusField::TRACE_BYTES, std::to_string(d.traceBytes));
+  f.emplace_back(StatusField::TRACE_SAVED, std::to_string(d.traceSaved));
+  f.emplace_back(StatusField::HTTPS_REQUESTS, std::to_string(d.httpsRequests));
+  f.emplace_back(StatusField::HTTPS_FAILURES, "0");
+  f.emplace_back(StatusField::HTTPS_RESUMED, std::to_string(d.httpsResumed));
+  snprintf(text, sizeof(text), "0x%08X", CHIP_ID);
+  f.emplace_back(StatusField::CHIP_ID, text);
+  return f;
+}
+
+// Blocul complet, rând cu rând ca printRuntimeStatus() (console.println = "\r\n").
+static void appendLine(std::string& out, const char* text) {
+  out += text;
+  out += "\r\n";
+}
+
+template <typename... Args>
+static void appendMsg(std::string& out, Msg id, const Args&... args) {
+  char line[200];
+  msgFormat(line, sizeof(line), MsgLang::RO, id, args...);
+  appendLine(out, line);
+}
+
+static void renderFull(const SimDevice& d, uint32_t t, std::string& out) {
+  char text[200];
+  appendLine(out, "");
+  appendLine(out, "");
+  appendMsg(out, Msg::STATUS_BEGIN, d.statusCounter);
+  appendMsg(out, Msg::STATUS_ALARM_SECTION);
+  appendMsg(out, Msg::STATUS_ALARM, alarmSummary(d));
+  for (uint8_t i = 0; i < PARTITIONS; ++i) {
+    size_t n = msgFormat(text, sizeof(text), MsgLang::RO, Msg::STATUS_PARTITION, i + 1, d.partition[i]);
+    if (d.timer[i] >= 0) msgFormat(text + n, sizeof(text) - n, MsgLang::RO, Msg::STATUS_PARTITION_TIMER, d.timer[i]);
+    appendLine(out, text);
+  }
+  appendMsg(out, Msg::STATUS_TRIGGER_COUNT, d.triggers);
+  appendMsg(out, Msg::STATUS_INTERNET_RELAY, d.relayActive ? "ACTIVE" : "INACTIVE");
+  appendMsg(out, Msg::STATUS_PING_DOWN, d.pingDown ? "YES" : "NO");
+  char date[32];
+  formatEpoch(d.pingDownStartEpoch, date, sizeof(date));
+  appendMsg(out, Msg::STATUS_PING_DOWN_START, date);
+  appendLine(out, "");
+  appendMsg(out, Msg::STATUS_WIFI_SECTION);
+  appendMsg(out, Msg::STATUS_WIFI, d.wifiUp ? "CONNECTED" : "DISCONNECTED");
+  appendMsg(out, Msg::STATUS_WIFI_EMULATION, "OFF");
+  appendMsg(out, Msg::STATUS_IP, d.wifiUp ? "192.168.1.57" : "-");
+  appendMsg(out, Msg::STATUS_GATEWAY, d.wifiUp ? "192.168.1.1" : "-");
+  appendMsg(out, Msg::STATUS_DNS, d.wifiUp ? "192.168.1.1" : "-");
+  if (d.wifiUp) {
+    appendMsg(out, Msg::STATUS_RSSI, d.rssi);
+    appendMsg(out, Msg::STATUS_SSID, "Casa \"Sus\" 2G", 6);
+    appendMsg(out, Msg::STATUS_LAST_CONNECT, "fast", 182u, 341u);
+  } else {
+    appendMsg(out, Msg::STATUS_RSSI, "-");
+  }
+  appendLine(out, "");
+  appendMsg(out, Msg::STATUS_INTERNET_SECTION);
+  formatEpoch(d.lastDisconnectEpoch, date, sizeof(date));
+  appendMsg(out, Msg::STATUS_LAST_DISCONNECT, date);
+  formatDuration(d.wifiUp ? 0 : t - d.wifiDownSinceS, date, sizeof(date));
+  appendMsg(out, Msg::STATUS_WIFI_DOWN_FOR, date);
+  appendMsg(out, Msg::STATUS_PING_COUNTER, d.pings);
+  appendMsg(out, Msg::STATUS_PING_INTERVAL, d.pingIntervalMs, d.pingIntervalMs / 1000);
+  appendLine(out, "");
+  appendMsg(out, Msg::STATUS_SYSTEM_SECTION);
+  appendMsg(out, Msg::STATUS_NTP_STARTED, "YES");
+  appendMsg(out, Msg::STATUS_NTP_READY, "YES");
+  appendMsg(out, Msg::STATUS_FREE_HEAP, d.heap);
+  appendLine(out, "OTA: IDLE");
+  snprintf(text, sizeof(text), "Console TCP: port 23, clients %u/3, dropped 0", d.consoleClients);
+  appendLine(out, text);
+  snprintf(text, sizeof(text), "Input trace: %u/8192 B, recorder avg 1.85 us/loop, max 9.4 us, saved %u (%s)", d.traceBytes, d.traceSaved,
+           d.traceSaved ? "alarm" : "-");
+  appendLine(out, text);
+  snprintf(text, sizeof(text), "HTTPS: %u req, 0 failed, reused conn 0, handshakes full %u (avg 1850 ms) / resumed %u (avg 310 ms)",
+           d.httpsRequests, d.httpsRequests - d.httpsResumed, d.httpsResumed);
+  appendLine(out, text);
+  appendLine(out, "HTTPS last handshake (ms): 306, max 1904, conn heap 6120 B, MFLN 512, suite 0xC02B, ssl err 0");
+  appendMsg(out, Msg::STATUS_CHIP_ID, CHIP_ID);
+  formatDuration(t, date, sizeof(date));
+  appendMsg(out, Msg::STATUS_UPTIME, date);
+  appendMsg(out, Msg::STATUS_END, d.statusCounter);
+  appendLine(out, "");
+}
+
+static void appendToString(void* ctx, const char* text) {
+  *static_cast<std::string*>(ctx) += text;
+}
+
+static std::string renderDelta(StatusDeltaEncoder& enc, const FieldList& fields, uint32_t t) {
+  std::string line;
+  enc.begin(t, appendToString, &line);
+  for (const auto& f : fields) enc.put(f.first, f.second.c_str());
+  enc.end();
+  return line;
+}
+
+// Starea decodorului = exact câmpurile trimise (restul necunoscute).
+static bool matches(const StatusDeltaDecoder& dec, const FieldList& fields, std::string* why) {
+  bool sent[STATUS_FIELD_COUNT] = {};
+  for (const auto& f : fields) {
+    const uint8_t i = static_cast<uint8_t>(f.first);
+    if (i < STATUS_FIELD_COUNT) sent[i] = true;
+    const char* v = dec.value(f.first);
+    if (v == nullptr || f.second.compare(0, STATUS_VALUE_MAX - 1, v) != 0) {
+      *why = std::string(STATUS_FIELD_KEYS[static_cast<uint8_t>(f.first)]) + ": expected \"" + f.second + "\", got \"" + (v ? v : "(none)") + "\"";
+      return false;
+    }
+  }
+  for (uint8_t i = 0; i < STATUS_FIELD_COUNT; ++i) {
+    if (!sent[i] && dec.value(static_cast<StatusField>(i)) != nullptr) {
+      *why = std::string(STATUS_FIELD_KEYS[i]) + ": never sent but decoded";
+      return false;
+    }
+  }
+  return true;
+}
+
+struct PassResult {
+  uint64_t fullBytes = 0;
+  uint64_t deltaBytes = 0;
+  uint32_t reports = 0;
+  uint32_t keyframes = 0;
+  uint32_t dropped = 0;
+  uint32_t skipped = 0;
+  uint32_t mismatches = 0;
+  size_t maxDeltaLine = 0;
+  size_t maxKeyframeLine = 0;
+};
+
+static PassResult runPass(uint32_t days, uint32_t lossPercent) {
+  PassResult r;
+  SimDevice d;
+  StatusDeltaEncoder enc(KEYFRAME_EVERY);
+  StatusDeltaDecoder dec;
+  rngState = 12345;
+  std::string full;
+  for (uint32_t t = 1; t <= days * 86400; ++t) {
+    simulateSecond(d, t);
+    if (t % REPORT_INTERVAL_S != 0) continue;
+    jitter(d);
+    ++d.statusCounter;
+    ++r.reports;
+
+    full.clear();
+    renderFull(d, t, full);
+    r.fullBytes += full.size();
+
+    const FieldList fields = statusFields(d, t);
+    const std::string line = renderDelta(enc, fields, t);
+    r.deltaBytes += line.size() + 2;
+    if (enc.lastWasKeyframe()) {
+      ++r.keyframes;
+      r.maxKeyframeLine = std::max(r.maxKeyframeLine, line.size());
+    } else {
+      r.maxDeltaLine = std::max(r.maxDeltaLine, line.size());
+    }
+
+    if (lossPercent && rng() % 100 < lossPercent) {
+      ++r.dropped;
+      continue;
+    }
+    const StatusDeltaResult res = dec.feed(line.c_str());
+    if (res == StatusDeltaResult::SKIPPED) {
+      ++r.skipped;
+      continue;
+    }
+    std::string why;
+    if (res == StatusDeltaResult::MALFORMED || res == StatusDeltaResult::NOT_STATUS) {
+      why = "line rejected";
+    } else if (dec.uptimeSec() != t) {
+      why = "uptime " + std::to_string(dec.uptimeSec()) + " != " + std::to_string(t);
+    } else if (matches(dec, fields, &why)) {
+      continue;
+    }
+    if (r.mismatches++ < 5) printf("  report %u: %s\n    %s\n", r.reports, why.c_str(), line.c_str());
+  }
+  return r;
+}
+
+static int runSim(uint32_t days, uint32_t lossPercent) {
+  printf("%u day(s), report every %u s, keyframe every %u reports, %u status fields\n", days, REPORT_INTERVAL_S, KEYFRAME_EVERY,
+         STATUS_FIELD_COUNT);
+  const PassResult r = runPass(days, 0);
+  const double perDay = 1.0 / days;
+  printf("full blocks:  %8llu B/day (%5.0f B/report, UART %.1f ms/report)\n", static_cast<unsigned long long>(r.fullBytes * perDay),
+         static_cast<double>(r.fullBytes) / r.reports, 1000.0 * r.fullBytes / r.reports / UART_BYTES_PER_SEC);
+  printf("delta lines:  %8llu B/day (%5.0f B/report, UART %.1f ms/report), %u keyframes, longest delta %zu B, keyframe %zu B\n",
+         static_cast<unsigned long long>(r.deltaBytes * perDay), static_cast<double>(r.deltaBytes) / r.reports,
+         1000.0 * r.deltaBytes / r.reports / UART_BYTES_PER_SEC, r.keyframes, r.maxDeltaLine, r.maxKeyframeLine);
+  printf("delta / full: %.1f%% (%.1fx smaller)\n", 100.0 * r.deltaBytes / r.fullBytes, static_cast<double>(r.fullBytes) / r.deltaBytes);
+  printf("reconstruction: %u reports, %u mismatches %s\n", r.reports, r.mismatches, r.mismatches == 0 ? "ok" : "FAILED");
+
+  int failures = (r.mismatches != 0 || r.deltaBytes >= r.fullBytes) ? 1 : 0;
+  if (lossPercent) {
+    const PassResult l = runPass(days, lossPercent);
+    const bool ok = l.mismatches == 0 && l.skipped > 0;
+    printf("with %u%% lines lost: %u dropped, %u deltas skipped until keyframe, %u mismatches %s\n", lossPercent, l.dropped, l.skipped,
+           l.mismatches, ok ? "ok" : "FAILED");
+    if (!ok) ++failures;
+  }
+  return failures == 0 ? 0 : 1;
+}
+
+static int runDecode() {
+  StatusDeltaDecoder dec;
+  uint32_t counts[5] = {};
+  std::string line;
+  while (std::getline(std::cin, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    const StatusDeltaResult res = dec.feed(line.c_str());
+    ++counts[static_cast<uint8_t>(res)];
+    if (res == StatusDeltaResult::MALFORMED) printf("malformed: %s\n", line.c_str());
+  }
+  printf("[STATUS] lines: %u keyframes, %u deltas, %u skipped, %u malformed, %u seq gaps\n", counts[1], counts[2], counts[3], counts[4],
+         dec.gaps());
+  if (!dec.synced()) {
+    printf("no keyframe since the last gap, state unknown\n");
+    return 1;
+  }
+  printf("state at seq %u (uptime %u s):\n", dec.lastSeq(), dec.uptimeSec());
+  for (uint8_t i = 0; i < STATUS_FIELD_COUNT; ++i) {
+    const char* v = dec.value(static_cast<StatusField>(i));
+    if (v != nullptr) printf("  %-16s %s\n", STATUS_FIELD_KEYS[i], v);
+  }
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1 && strcmp(argv[1], "decode") == 0) return runDecode();
+  const uint32_t days = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 1;
+  const uint32_t loss = argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 2;
+  return runSim(days ? days : 1, loss);
+}
@@ -0,0 +1,432 @@
+// supervisor_sim.cpp — simulare host a supervizorului loop() și a restaurării din RTC (include/supervisor.h)
+//
+// Build:
+//   g++ -O2 -std=c++17 -I../include supervisor_sim.cpp -o supervisor_sim
+//
+// Utilizare:
+//   ./supervisor_sim [runs=2000] [seed=1] [-v]
+//
+// O placă simulată rulează loop() ca main.cpp: fiecare trecere deschide o
+// scriere seqlock, face check-in pentru serial, alarmă și rețea, iar tickerul
+// de 1 s (supervisorTickStep(), același cod ca pe placă) scrie imaginea RTC
+// și în mijlocul trecerilor (yield()-urile din connectWifi(), ping). La un
+// moment dat o etapă se blochează; după reset, o placă nouă pornește din
+// aceeași memorie RTC și restaurează partițiile ca restoreAlarmPartitions().
+//
+// Se verifică:
+//   - resetul vine după primul deadline expirat (+ cel mult un tick), cu
+//     cauza SUPERVISOR_TIMEOUT și etapa blocată în context;
+//   - starea și modul armat al fiecărei partiții revin neschimbate (ALARMING
+//     revine ca modul armat: sirena nu repornește), la fel contorul de boot
+//     (+1) și contorul de activări ale releului;
+//   - un tick cu scrierea deschisă (tryRead() eșuat) nu atinge imaginea RTC,
+//     deci nicio imagine salvată nu are rezumatul nepotrivit cu partițiile;
+//   - o imagine coruptă e ignorată (pornire la rece).
+// Scenariile fixe sunt urmate de `runs` scenarii aleatoare.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "supervisor.h"
+
+static const uint8_t PARTITIONS = 2;     // ALARM_PARTITION_COUNT din main.cpp
+static const uint8_t PARTITION_MAX = 4;  // ALARM_PARTITION_MAX
+using SystemState = SystemStateT<PARTITIONS>;
+using CrashContext = CrashContextT<PARTITION_MAX>;
+
+// Ca SupervisedTask / SUPERVISED_TASKS din main.cpp.
+enum : uint8_t { TASK_ALARM, TASK_NETWORK, TASK_SERIAL, TASK_COUNT };
+static const SupervisedTaskInfo TASKS[TASK_COUNT] = {
+  { "alarm", 30'000 },
+  { "network", 45'000 },
+  { "serial", 30'000 },
+};
+
+// Valorile lui LoopStage din main.cpp folosite de simulare.
+enum : uint8_t { STAGE_BOOT = 0, STAGE_ALARM = 1, STAGE_SERIAL_CMD = 2, STAGE_WIFI_CONNECT = 3, STAGE_STATUS = 7, STAGE_IDLE = 9 };
+
+static const uint32_t RTC_SLOT_CRASH_CONTEXT = 0;
+static const uint32_t RTC_SLOT_RELAY_SCHEDULER = 16;
+static const uint32_t TICK_MS = 1000;
+static const uint32_t PASS_MS = 20;
+static const uint32_t NO_PASS = 0xFFFFFFFF;
+
+static bool verbose = false;
+
+static const char* stateName(uint8_t s) {
+  return s < ALARM_STATE_COUNT ? ALARM_STATE_INFO[s].name : "UNKNOWN";
+}
+
+static AlarmState summaryState(const uint8_t* states, uint8_t count) {
+  uint8_t best = static_cast<uint8_t>(AlarmState::DISARMED);
+  for (uint8_t i = 0; i < count; ++i) {
+    if (ALARM_STATE_INFO[states[i]].priority > ALARM_STATE_INFO[best].priority) best = states[i];
+  }
+  return static_cast<AlarmState>(best);
+}
+
+// ESP.rtcUserMemoryRead/Write: 512 bytes, adresare pe cuvinte.
+struct Rtc {
+  uint32_t words[128] = {};
+  void write(uint32_t slot, const void* data, size_t size) { memcpy(words + slot, data, size); }
+  void read(uint32_t slot, void* data, size_t size) const { memcpy(data, words + slot, size); }
+};
+
+struct Board {
+  SeqLocked<SystemState> state;
+  uint32_t checkInMs[TASK_COUNT] = {};
+  uint32_t bootCount = 0;
+  uint32_t nextTickMs = 0;
+  uint8_t stage = STAGE_BOOT;
+  bool resetRequested = false;
+  uint32_t resetAtMs = 0;
+  uint32_t ticksWhileWriting = 0;
+  uint32_t tornImages = 0;      // imagini salvate cu rezumatul nepotrivit
+  uint32_t writingOverwrites = 0;  // tick cu scrierea deschisă care a schimbat imaginea fără timeout
+  Rtc* rtc = nullptr;
+
+  SystemState& sys() { return state.value(); }
+
+  // setup(): loadCrashContextAtBoot() + restoreRelayScheduler() + restoreAlarmPartitions() + supervisorBegin()
+  bool boot(Rtc& r, uint32_t now) {
+    rtc = &r;
+    systemStateInit(sys());
+    CrashContext ctx;
+    r.read(RTC_SLOT_CRASH_CONTEXT, &ctx, sizeof(ctx));
+    const bool crashValid = crashContextValid(ctx);
+    if (crashValid) bootCount = ctx.bootCount + 1;
+    RelaySchedulerRtc rec;
+    r.read(RTC_SLOT_RELAY_SCHEDULER, &rec, sizeof(rec));
+    if (relaySchedulerRtcValid(rec)) sys().relay.activationCount = rec.activationCount;
+    uint8_t states[PARTITIONS];
+    for (uint8_t i = 0; i < PARTITIONS; ++i) {
+      AlarmState mode = AlarmState::ARMED;
+      // fără context valid main.cpp citește flash-ul; aici flash-ul e gol
+      sys().partitions[i].state = crashValid ? crashContextRestoreState(ctx, i, &mode) : AlarmState::DISARMED;
+      sys().partitions[i].armedMode = mode;
+      states[i] = static_cast<uint8_t>(sys().partitions[i].state);
+    }
+    sys().alarmState = summaryState(states, PARTITIONS);
+    for (uint8_t i = 0; i < TASK_COUNT; ++i) checkInMs[i] = now;
+    save(CrashCause::NONE, SUPERVISOR_NO_TASK, sys(), now);
+    nextTickMs = now + TICK_MS;
+    return crashValid;
+  }
+
+  void save(CrashCause cause, uint8_t task, const SystemState& snap, uint32_t now) {
+    CrashContext ctx;
+    crashContextCapture(&ctx, cause, task, stage, snap, now, 40'000, bootCount);
+    uint8_t states[PARTITIONS];
+    for (uint8_t i = 0; i < PARTITIONS; ++i) states[i] = ctx.partitionState[i];
+    if (ctx.alarmState != static_cast<uint8_t>(summaryState(states, PARTITIONS))) ++tornImages;
+    rtc->write(RTC_SLOT_CRASH_CONTEXT, &ctx, sizeof(ctx));
+    RelaySchedulerRtc rec;
+    relaySchedulerRtcCapture(&rec, snap.relay, now);
+    rtc->write(RTC_SLOT_RELAY_SCHEDULER, &rec, sizeof(rec));
+  }
+
+  // Tickerul: toate tick-urile scadente până la `now` (rulează și în yield()).
+  void advanceTo(uint32_t now) {
+    while (!resetRequested && (int32_t)(now - nextTickMs) >= 0) {
+      const uint32_t at = nextTickMs;
+      nextTickMs += TICK_MS;
+      const bool writing = state.writing();
+      Rtc before = *rtc;
+      bool timeout = false;
+      resetRequested = supervisorTickStep(at, checkInMs, TASKS, TASK_COUNT, state, [&](CrashCause cause, uint8_t task, const SystemState& snap) {
+        timeout = cause != CrashCause::NONE;
+        save(cause, task, snap, at);
+      });
+      if (resetRequested) resetAtMs = at;
+      if (writing) {
+        ++ticksWhileWriting;
+        if (!timeout && memcmp(before.words, rtc->words, sizeof(before.words)) != 0) ++writingOverwrites;
+      }
+    }
+  }
+
+  void setPartition(uint8_t p, AlarmState s, AlarmState mode) {
+    sys().partitions[p].state = s;
+    sys().partitions[p].armedMode = mode;
+  }
+
+  void updateSummary() {
+    uint8_t states[PARTITIONS];
+    for (uint8_t i = 0; i < PARTITIONS; ++i) states[i] = static_cast<uint8_t>(sys().partitions[i].state);
+    sys().alarmState = summaryState(states, PARTITIONS);
+  }
+};
+
+// O schimbare de stare făcută în etapa ALARM a unei treceri (updateZones()).
+struct Change {
+  uint8_t partition;
+  AlarmState state;
+  AlarmState mode;
+};
+
+struct Run {
+  uint32_t startMs;
+  uint32_t hangPass;       // trecerea în care se blochează etapa
+  uint8_t hangStage;       // STAGE_SERIAL_CMD / STAGE_ALARM / STAGE_WIFI_CONNECT
+  uint32_t networkMs;      // cât durează etapa de rețea într-o trecere normală (cu yield())
+  Change changes[8];
+  uint32_t changeAtPass[8];
+  uint8_t changeCount;
+  uint32_t relayAtPass;    // o activare a releului în trecerea asta (NO_PASS = niciuna)
+  bool corruptRtc;         // un bit schimbat în imaginea RTC înainte de boot
+};
+
+struct Outcome {
+  bool ok = true;
+  std::string why;
+  void fail(const std::string& what) {
+    if (ok) why = what;
+    ok = false;
+  }
+};
+
+// Trecerea completă prin loop(), cu etapele în ordinea din main.cpp. La
+// `hangStage` nu se mai întoarce: tickerul rulează până cere reset.
+static void runPass(Board& b, const Run& r, uint32_t pass, uint32_t t) {
+  b.state.beginWrite();
+  b.stage = STAGE_STATUS;
+  if (pass == r.relayAtPass) relayActivate(b.sys().relay, t);
+  b.advanceTo(t + 1);
+  b.stage = STAGE_SERIAL_CMD;
+  const bool hang = pass == r.hangPass;
+  if (hang && r.hangStage == STAGE_SERIAL_CMD) return;
+  b.checkInMs[TASK_SERIAL] = t + 1;
+  b.stage = STAGE_ALARM;
+  for (uint8_t i = 0; i < r.changeCount; ++i) {
+    if (r.changeAtPass[i] == pass) b.setPartition(r.changes[i].partition, r.changes[i].state, r.changes[i].mode);
+  }
+  b.advanceTo(t + 2);  // tick între partiții și rezumat: copie ruptă dacă ar fi acceptată
+  b.updateSummary();
+  if (hang && r.hangStage == STAGE_ALARM) return;
+  b.checkInMs[TASK_ALARM] = t + 2;
+  b.stage = STAGE_WIFI_CONNECT;
+  if (hang) return;
+  b.advanceTo(t + 2 + r.networkMs);
+  b.checkInMs[TASK_NETWORK] = t + 2 + r.networkMs;
+  b.stage = STAGE_IDLE;
+  b.state.endWrite();
+}
+
+static Outcome runScenario(const Run& r, uint32_t* resetDelayMs) {
+  Outcome out;
+  Rtc rtc;
+  Board before;
+  before.boot(rtc, r.startMs);
+  before.stage = STAGE_IDLE;
+
+  uint32_t t = r.startMs;
+  SystemState lastSaved = before.sys();
+  for (uint32_t pass = 0; !before.resetRequested; ++pass) {
+    runPass(before, r, pass, t);
+    if (pass == r.hangPass) {
+      const uint32_t hangAt = t;
+      for (uint32_t guard = 0; !before.resetRequested && guard < 120; ++guard) before.advanceTo(before.nextTickMs);
+      if (!before.resetRequested) {
+        out.fail("no reset after a hung stage");
+        return out;
+      }
+      *resetDelayMs = before.resetAtMs - hangAt;
+      break;
+    }
+    t += PASS_MS;
+    before.advanceTo(t);
+    if (pass > r.hangPass + 10'000) break;
+  }
+  if (!before.resetRequested) {
+    out.fail("reset before the hang");
+    return out;
+  }
+  lastSaved = before.sys();  // scriitorul e blocat: starea live e cea de la reset
+
+  CrashContext ctx;
+  rtc.read(RTC_SLOT_CRASH_CONTEXT, &ctx, sizeof(ctx));
+  const bool stageOk = ctx.stage == r.hangStage;
+  const bool causeOk = ctx.cause == static_cast<uint8_t>(CrashCause::SUPERVISOR_TIMEOUT) && ctx.task < TASK_COUNT;
+  if (!stageOk) out.fail("stage in crash context");
+  if (!causeOk) out.fail("cause/task in crash context");
+  if (before.tornImages != 0) out.fail("torn image saved");
+  if (before.writingOverwrites != 0) out.fail("image rewritten while the write was open");
+
+  // primul deadline expirat, din momentele de check-in de la blocaj
+  uint32_t firstExpiry = 0;
+  for (uint8_t i = 0; i < TASK_COUNT; ++i) {
+    const uint32_t at = before.checkInMs[i] + TASKS[i].deadlineMs + 1;
+    if (i == 0 || (int32_t)(at - firstExpiry) < 0) firstExpiry = at;
+  }
+  const int32_t late = (int32_t)(before.resetAtMs - firstExpiry);
+  if (late < 0 || late >= (int32_t)TICK_MS) out.fail("reset not within one tick of the first expired deadline");
+
+  if (r.corruptRtc) rtc.words[3] ^= 0x10;
+
+  Board after;
+  const bool restored = after.boot(rtc, before.resetAtMs + 300);
+  if (r.corruptRtc) {
+    if (restored) out.fail("corrupted image accepted");
+    for (uint8_t i = 0; i < PARTITIONS; ++i) {
+      if (after.sys().partitions[i].state != AlarmState::DISARMED) out.fail("corrupted image: partition not DISARMED");
+    }
+    if (after.bootCount != 0) out.fail("corrupted image: boot count");
+    return out;
+  }
+  if (!restored) out.fail("crash context rejected");
+  if (after.bootCount != before.bootCount + 1) out.fail("boot count");
+  if (after.sys().relay.activationCount != lastSaved.relay.activationCount) out.fail("relay activation count");
+  for (uint8_t i = 0; i < PARTITIONS; ++i) {
+    const AlarmPartition& was = lastSaved.partitions[i];
+    const AlarmPartition& now = after.sys().partitions[i];
+    const AlarmState expected = was.state == AlarmState::ALARMING ? was.armedMode : was.state;
+    if (now.state != expected) out.fail(std::string("P") + char('1' + i) + " state " + stateName(static_cast<uint8_t>(now.state)) + ", expected " + stateName(static_cast<uint8_t>(expected)));
+    if (now.armedMode != was.armedMode) out.fail(std::string("P") + char('1' + i) + " arm mode");
+  }
+  if (verbose) {
+    printf("  reset at +%u ms, task %s, stage %u, P1=%s P2=%s, boot %u, relay %u\n", *resetDelayMs, ctx.task < TASK_COUNT ? TASKS[ctx.task].name : "-", ctx.stage,
+           stateName(static_cast<uint8_t>(after.sys().partitions[0].state)), stateName(static_cast<uint8_t>(after.sys().partitions[1].state)), after.bootCount,
+           after.sys().relay.activationCount);
+  }
+  return out;
+}
+
+static Run baseRun(uint32_t startMs, uint8_t hangStage, uint32_t hangPass) {
+  Run r = {};
+  r.startMs = startMs;
+  r.hangStage = hangStage;
+  r.hangPass = hangPass;
+  r.networkMs = 15;  // tick-urile cad des în scrierea deschisă
+  r.relayAtPass = NO_PASS;
+  return r;
+}
+
+static void addChange(Run& r, uint32_t pass, uint8_t p, AlarmState s, AlarmState mode) {
+  r.changes[r.changeCount] = { p, s, mode };
+  r.changeAtPass[r.changeCount] = pass;
+  ++r.changeCount;
+}
+
+int main(int argc, char** argv) {
+  uint32_t runs = 2000;
+  uint32_t seed = 1;
+  int positional = 0;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+    } else if (positional++ == 0) {
+      runs = strtoul(argv[i], nullptr, 10);
+    } else {
+      seed = strtoul(argv[i], nullptr, 10);
+    }
+  }
+
+  bool ok = true;
+  auto check = [&](const char* what, bool pass) {
+    printf("%-60s %s\n", what, pass ? "ok" : "FAILED");
+    ok = ok && pass;
+  };
+  auto scenario = [&](const char* what, const Run& r) {
+    uint32_t delay = 0;
+    const Outcome o = runScenario(r, &delay);
+    check(what, o.ok);
+    if (!o.ok) printf("  %s\n", o.why.c_str());
+  };
+
+  {
+    Run r = baseRun(5'000, STAGE_WIFI_CONNECT, 600);
+    addChange(r, 100, 0, AlarmState::ARMED, AlarmState::ARMED);
+    addChange(r, 120, 1, AlarmState::ARMED_STAY, AlarmState::ARMED_STAY);
+    r.relayAtPass = 300;
+    scenario("WiFi connect hang, P1 ARMED, P2 ARMED_STAY", r);
+  }
+  {
+    // schimbarea din trecerea blocată e doar în starea live (tryRead eșuează)
+    Run r = baseRun(5'000, STAGE_ALARM, 600);
+    addChange(r, 100, 0, AlarmState::ARMED, AlarmState::ARMED);
+    addChange(r, 100, 1, AlarmState::ARMED, AlarmState::ARMED);
+    addChange(r, 600, 0, AlarmState::ENTRY_DELAY, AlarmState::ARMED);
+    scenario("alarm stage hang right after ENTRY_DELAY", r);
+  }
+  {
+    Run r = baseRun(5'000, STAGE_SERIAL_CMD, 800);
+    addChange(r, 100, 0, AlarmState::ARMED_STAY, AlarmState::ARMED_STAY);
+    addChange(r, 500, 0, AlarmState::ALARMING, AlarmState::ARMED_STAY);
+    addChange(r, 100, 1, AlarmState::ARMING, AlarmState::ARMED);
+    r.relayAtPass = 50;
+    scenario("serial hang while ALARMING (siren does not restart)", r);
+  }
+  {
+    Run r = baseRun(0xFFFF0000u, STAGE_WIFI_CONNECT, 2'500);
+    addChange(r, 10, 1, AlarmState::ARMED, AlarmState::ARMED);
+    r.relayAtPass = 20;
+    scenario("hang across the millis() wrap", r);
+  }
+  {
+    Run r = baseRun(5'000, STAGE_WIFI_CONNECT, 300);
+    addChange(r, 10, 0, AlarmState::ARMED, AlarmState::ARMED);
+    r.corruptRtc = true;
+    scenario("corrupted RTC image starts cold", r);
+  }
+
+  // tick cu scrierea deschisă și partițiile pe jumătate actualizate
+  {
+    Rtc rtc;
+    Board b;
+    b.boot(rtc, 0);
+    b.setPartition(0, AlarmState::ARMED, AlarmState::ARMED);
+    b.updateSummary();
+    b.advanceTo(1000);
+    const Rtc saved = rtc;
+    b.state.beginWrite();
+    b.setPartition(0, AlarmState::ALARMING, AlarmState::ARMED);  // rezumatul încă ARMED
+    b.advanceTo(2000);
+    const bool skipped = memcmp(saved.words, rtc.words, sizeof(rtc.words)) == 0 && b.ticksWhileWriting == 1;
+    b.updateSummary();
+    b.state.endWrite();
+    b.advanceTo(3000);
+    CrashContext ctx;
+    rtc.read(RTC_SLOT_CRASH_CONTEXT, &ctx, sizeof(ctx));
+    check("inconsistent seqlock read skips the save", skipped);
+    check("next consistent tick saves the new state", ctx.partitionState[0] == static_cast<uint8_t>(AlarmState::ALARMING) && ctx.alarmState == ctx.partitionState[0] && !b.resetRequested);
+  }
+
+  std::mt19937 rng(seed);
+  uint32_t failed = 0;
+  uint32_t worstLate = 0;
+  std::string firstFailure;
+  static const uint8_t HANG_STAGES[] = { STAGE_SERIAL_CMD, STAGE_ALARM, STAGE_WIFI_CONNECT };
+  static const AlarmState STATES[] = { AlarmState::DISARMED, AlarmState::ARMING, AlarmState::ARMED, AlarmState::ALARMING, AlarmState::ENTRY_DELAY, AlarmState::ARMED_STAY };
+  for (uint32_t i = 0; i < runs; ++i) {
+    Run r = baseRun(rng(), HANG_STAGES[rng() % 3], 1 + rng() % 3'000);
+    r.networkMs = rng() % (PASS_MS - 2);
+    r.changeCount = static_cast<uint8_t>(rng() % 9);
+    for (uint8_t k = 0; k < r.changeCount; ++k) {
+      const AlarmState mode = (rng() & 1) ? AlarmState::ARMED_STAY : AlarmState::ARMED;
+      AlarmState st = STATES[rng() % 6];
+      if (st == AlarmState::ARMED || st == AlarmState::ARMED_STAY) st = mode;  // starea armată e chiar modul
+      r.changes[k] = { static_cast<uint8_t>(rng() % PARTITIONS), st, mode };
+      r.changeAtPass[k] = rng() % (r.hangPass + 1);
+    }
+    r.relayAtPass = (rng() & 1) ? rng() % (r.hangPass + 1) : NO_PASS;
+    r.corruptRtc = rng() % 16 == 0;
+    uint32_t delay = 0;
+    const Outcome o = runScenario(r, &delay);
+    if (!o.ok) {
+      if (failed == 0) firstFailure = o.why;
+      ++failed;
+    }
+    if (delay > worstLate) worstLate = delay;
+  }
+  char what[96];
+  snprintf(what, sizeof(what), "random hangs: %u runs, seed %u", runs, seed);
+  check(what, failed == 0);
+  if (failed) printf("  %u failed, first: %s\n", failed, firstFailure.c_str());
+  printf("longest hang before reset: %.1f s (deadlines %u/%u/%u s, tick %u ms)\n", worstLate / 1000.0, TASKS[0].deadlineMs / 1000, TASKS[1].deadlineMs / 1000,
+         TASKS[2].deadlineMs / 1000, TICK_MS);
+
+  printf("%s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
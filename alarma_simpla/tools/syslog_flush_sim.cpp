@@ -0,0 +1,357 @@
+// syslog_flush_sim.cpp — verificare pentru include/syslog_sink.h cu un receptor UDP local
+//
+// Build:
+//   g++ -O2 -std=c++17 -pthread -I../include syslog_flush_sim.cpp -o syslog_flush_sim
+//
+// Utilizare:
+//   ./syslog_flush_sim [-v]
+//
+// Un thread ascultă pe 127.0.0.1 (port efemer) ca un server syslog; placa e
+// simulată cu ceas propriu (pas de 100 ms), același ring / formatare /
+// token bucket ca în main.cpp, trimitere prin sendto(). Scenarii:
+//   1) 10 min online, 10 min fără rețea (internet_DOWN, impulsuri de releu la
+//      70 s, WiFi căzut/revenit), apoi legătura revine: tot ce a fost în
+//      buffer ajunge, în ordine, cu momentul original (nu cel al trimiterii);
+//   2) evenimente înainte de sincronizarea orei: timestamp dedus la trimitere;
+//   3) furtună (mai multe evenimente decât ring-ul): se pierd exact cele mai
+//      vechi, iar primul mesaj de după poartă dropped="N".
+// Scenariul 1 rulează cu un mesaj pe datagramă (RFC 5426, implicit) și cu
+// loturi de 16 (opțiune nestandard). Raportează durata golirii după pană
+// (limitată de rată), numărul de datagrame și costul formatării pe host.
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "syslog_sink.h"
+
+// Ca în main.cpp
+static const uint16_t BUFFER_RECORDS = 64;
+static const uint16_t RATE_PER_SEC = 10;
+static const uint16_t RATE_BURST = 5;
+static const uint8_t BATCH_RFC5426 = 1;        // SYSLOG_BATCH_RECORDS implicit
+static const uint8_t BATCH_OPT_IN_RECORDS = 16;  // loturi separate prin LF (nestandard)
+static const uint32_t STEP_MS = 100;
+static const uint32_t EPOCH_BASE = 1792400000;
+static const SyslogIdentity IDENTITY = { "alarma-00a1b2c3", "alarma_simpla", SYSLOG_FACILITY_LOCAL0 };
+
+struct Received {
+  std::vector<std::string> messages;
+  size_t datagrams = 0;
+  size_t bytes = 0;
+};
+
+class Listener {
+ public:
+  bool start() {
+    fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd_ < 0) return false;
+    int rcvbuf = 4 << 20;
+    setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    timeval tv = { 0, 200'000 };
+    setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    sockaddr_in a = {};
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd_, reinterpret_cast<sockaddr*>(&a), sizeof(a)) != 0) return false;
+    socklen_t len = sizeof(addr_);
+    getsockname(fd_, reinterpret_cast<sockaddr*>(&addr_), &len);
+    thread_ = std::thread([this] { run(); });
+    return true;
+  }
+
+  // așteaptă până nu mai vine nimic, apoi întoarce ce s-a primit
+  Received drain() {
+    size_t last = SIZE_MAX;
+    for (;;) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      std::lock_guard<std::mutex> lock(mu_);
+      if (got_.datagrams == last) break;
+      last = got_.datagrams;
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    Received r = std::move(got_);
+    got_ = Received();
+    return r;
+  }
+
+  void stop() {
+    stop_ = true;
+    thread_.join();
+    close(fd_);
+  }
+
+  const sockaddr_in& addr() const { return addr_; }
+
+ private:
+  void run() {
+    char buf[2048];
+    while (!stop_) {
+      const ssize_t n = recv(fd_, buf, sizeof(buf), 0);
+      if (n <= 0) continue;
+      std::lock_guard<std::mutex> lock(mu_);
+      ++got_.datagrams;
+      got_.bytes += static_cast<size_t>(n);
+      size_t start = 0;
+      for (size_t i = 0; i <= static_cast<size_t>(n); ++i) {
+        if (i == static_cast<size_t>(n) || buf[i] == '\n') {
+          got_.messages.emplace_back(buf + start, i - start);
+          start = i + 1;
+        }
+      }
+    }
+  }
+
+  int fd_ = -1;
+  sockaddr_in addr_ = {};
+  std::thread thread_;
+  std::mutex mu_;
+  Received got_;
+  std::atomic<bool> stop_{ false };
+};
+
+// Placa simulată: ring + rate limiter + trimitere, ca syslogFlushIfNeeded().
+struct Board {
+  SyslogBuffer<BUFFER_RECORDS> buffer;
+  SyslogRateLimiter rate = { RATE_PER_SEC, RATE_BURST, 0, 0, false };
+  int fd = -1;
+  sockaddr_in to = {};
+  uint32_t nowMs = 0;
+  bool online = true;
+  bool timeSynced = true;
+  size_t datagramsSent = 0;
+  uint32_t pendingDropped = 0;
+  uint8_t batchRecords = BATCH_RFC5426;
+
+  uint32_t epochNow() const { return timeSynced ? EPOCH_BASE + nowMs / 1000 : 0; }
+
+  void event(const char* text, uint8_t severity) { buffer.push(text, severity, nowMs, epochNow()); }
+
+  void flush() {
+    if (!online) return;
+    pendingDropped += buffer.takeDropped();
+    while (buffer.size() != 0 && rate.take(nowMs)) {
+      char datagram[SYSLOG_DATAGRAM_MAX];
+      uint16_t taken = 0;
+      const size_t len = syslogBuildBatch(buffer, IDENTITY, nowMs, epochNow(), pendingDropped, batchRecords, datagram, sizeof(datagram), &taken);
+      if (len != 0 && sendto(fd, datagram, len, 0, reinterpret_cast<const sockaddr*>(&to), sizeof(to)) != static_cast<ssize_t>(len)) return;
+      buffer.pop(taken);
+      pendingDropped = 0;
+      ++datagramsSent;
+    }
+  }
+
+  void advance(uint32_t ms) {
+    for (uint32_t t = 0; t < ms; t += STEP_MS) {
+      nowMs += STEP_MS;
+      flush();
+    }
+  }
+};
+
+struct Parsed {
+  unsigned pri = 0;
+  std::string timestamp;
+  unsigned long seq = 0;
+  unsigned long late = 0;
+  unsigned long dropped = 0;
+  std::string text;
+};
+
+static bool parse(const std::string& m, Parsed* p) {
+  char ts[32], host[64], app[32];
+  int off = 0;
+  if (sscanf(m.c_str(), "<%u>1 %31s %63s %31s - EVENT [alarma@32473 seq=\"%lu\" late=\"%lu\"%n", &p->pri, ts, host, app, &p->seq, &p->late, &off) != 6) return false;
+  p->timestamp = ts;
+  const char* rest = m.c_str() + off;
+  if (sscanf(rest, " dropped=\"%lu\"", &p->dropped) == 1) rest = strchr(rest, ']');
+  if (!rest || *rest != ']') return false;
+  p->text = rest + (rest[1] == ' ' ? 2 : 1);
+  return true;
+}
+
+static std::string isoUtc(uint32_t epoch) {
+  const time_t t = epoch;
+  struct tm tmUtc;
+  gmtime_r(&t, &tmUtc);
+  char buf[32];
+  strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tmUtc);
+  return buf;
+}
+
+struct Expected {
+  uint32_t epoch;
+  std::string text;
+};
+
+// 10 min de pană ca pe placă: WiFi cade, releul pulsează la 70 s, ping-ul eșuează.
+static void outage(Board& b, std::vector<Expected>& expected, uint32_t minutes) {
+  b.online = false;
+  auto ev = [&](const char* text, uint8_t sev) {
+    expected.push_back({ b.epochNow(), text });
+    b.event(text, sev);
+  };
+  ev("internet_DOWN_detected", SYSLOG_SEV_WARNING);
+  ev("WiFi transition: CONNECTED -> DISCONNECTED", SYSLOG_SEV_WARNING);
+  for (uint32_t s = 0; s < minutes * 60; s += 70) {
+    ev("relay_1_ACTIVATED", SYSLOG_SEV_WARNING);
+    b.advance(10'000);
+    ev("relay_1_DEACTIVATED", SYSLOG_SEV_NOTICE);
+    ev("WiFi connect failed", SYSLOG_SEV_WARNING);
+    b.advance(60'000);
+  }
+  ev("WiFi transition: DISCONNECTED -> CONNECTED", SYSLOG_SEV_NOTICE);
+  ev("WiFi connect success", SYSLOG_SEV_NOTICE);
+}
+
+int main(int argc, char** argv) {
+  const bool verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+  Listener listener;
+  if (!listener.start()) {
+    perror("listener");
+    return 1;
+  }
+  bool ok = true;
+  auto check = [&](const char* what, bool pass) {
+    printf("%-58s %s\n", what, pass ? "ok" : "FAILED");
+    ok = ok && pass;
+  };
+
+  // --- 1) pană de 10 min
+  for (uint8_t batch : { BATCH_RFC5426, BATCH_OPT_IN_RECORDS }) {
+    Board b;
+    b.batchRecords = batch;
+    b.fd = socket(AF_INET, SOCK_DGRAM, 0);
+    b.to = listener.addr();
+    std::vector<Expected> expected;
+    for (int i = 0; i < 10; ++i) {
+      expected.push_back({ b.epochNow(), "PING OK" });
+      b.event("PING OK", SYSLOG_SEV_INFO);
+      b.advance(60'000);
+    }
+    const size_t before = listener.drain().messages.size();
+    outage(b, expected, 10);
+    const uint32_t backlog = b.buffer.size();
+    const uint32_t maxDepth = b.buffer.maxCount();
+    b.online = true;
+    const uint32_t flushStart = b.nowMs;
+    const size_t datagramsBefore = b.datagramsSent;
+    while (b.buffer.size() != 0) b.advance(STEP_MS);
+    const uint32_t flushMs = b.nowMs - flushStart;
+    const size_t flushDatagrams = b.datagramsSent - datagramsBefore;
+    Received got = listener.drain();
+
+    bool ordered = true, timestamps = true, parsed = true;
+    unsigned long lastSeq = 0;
+    std::vector<Parsed> all;
+    for (const std::string& m : got.messages) {
+      Parsed p;
+      if (!parse(m, &p)) {
+        parsed = false;
+        if (verbose) printf("  unparsed: %s\n", m.c_str());
+        continue;
+      }
+      if (!all.empty() && p.seq != lastSeq + 1) ordered = false;
+      lastSeq = p.seq;
+      all.push_back(p);
+    }
+    const size_t first = expected.size() - all.size();  // primele 10 ajunseseră înainte de drain()
+    for (size_t i = 0; i < all.size() && first + i < expected.size(); ++i) {
+      if (all[i].timestamp != isoUtc(expected[first + i].epoch) || all[i].text != expected[first + i].text) timestamps = false;
+      if (verbose) printf("  %s  late=%4lus  %s\n", all[i].timestamp.c_str(), all[i].late, all[i].text.c_str());
+    }
+    printf("outage 10 min, batch %u: %u events buffered (max depth %u/%u), flushed in %.1f s as %zu datagrams (%zu B avg)\n", batch, backlog, maxDepth,
+           BUFFER_RECORDS, flushMs / 1000.0, flushDatagrams, flushDatagrams ? got.bytes / got.datagrams : 0);
+    char what[64];
+    auto checkBatch = [&](const char* name, bool pass) {
+      snprintf(what, sizeof(what), "[batch %2u] %s", batch, name);
+      check(what, pass);
+    };
+    checkBatch("all messages parse as RFC 5424", parsed);
+    checkBatch("nothing lost within the buffer bound", before == 10 && all.size() == backlog && b.buffer.droppedTotal() == 0);
+    checkBatch("delivered in order (seq +1)", ordered);
+    checkBatch("original timestamps kept", timestamps);
+    checkBatch("flush respects the rate limit", flushDatagrams <= RATE_BURST + (flushMs / 1000 + 1) * RATE_PER_SEC);
+    if (batch == BATCH_RFC5426) checkBatch("one message per datagram (RFC 5426)", got.datagrams == got.messages.size());
+    close(b.fd);
+  }
+
+  // --- 2) înainte de sincronizarea orei
+  {
+    Board b;
+    b.fd = socket(AF_INET, SOCK_DGRAM, 0);
+    b.to = listener.addr();
+    b.timeSynced = false;
+    b.online = false;
+    b.advance(5'000);
+    b.event("Setup complete", SYSLOG_SEV_NOTICE);
+    const uint32_t eventMs = b.nowMs;
+    b.advance(40'000);
+    b.timeSynced = true;
+    b.online = true;
+    b.advance(1'000);
+    Received got = listener.drain();
+    Parsed p;
+    const bool pass = got.messages.size() == 1 && parse(got.messages[0], &p) && p.timestamp == isoUtc(EPOCH_BASE + eventMs / 1000) && p.late == 40;
+    if (verbose && !got.messages.empty()) printf("  %s\n", got.messages[0].c_str());
+    check("timestamp derived when time sync came later", pass);
+    close(b.fd);
+  }
+
+  // --- 3) furtună peste capacitate
+  {
+    Board b;
+    b.fd = socket(AF_INET, SOCK_DGRAM, 0);
+    b.to = listener.addr();
+    b.online = false;
+    const uint32_t storm = 3 * BUFFER_RECORDS;
+    char text[32];
+    for (uint32_t i = 0; i < storm; ++i) {
+      snprintf(text, sizeof(text), "motion P%u #%u", i % 4 + 1, i);
+      b.event(text, SYSLOG_SEV_NOTICE);
+      b.advance(STEP_MS);
+    }
+    b.online = true;
+    while (b.buffer.size() != 0) b.advance(STEP_MS);
+    Received got = listener.drain();
+    Parsed firstMsg, lastMsg;
+    const bool parsedEnds = got.messages.size() == BUFFER_RECORDS && parse(got.messages.front(), &firstMsg) && parse(got.messages.back(), &lastMsg);
+    snprintf(text, sizeof(text), "motion P%u #%u", (storm - BUFFER_RECORDS) % 4 + 1, storm - BUFFER_RECORDS);
+    const bool pass = parsedEnds && firstMsg.dropped == storm - BUFFER_RECORDS && firstMsg.text == text && lastMsg.seq == storm - 1 && lastMsg.dropped == 0;
+    check("overflow drops the oldest, reports dropped=N once", pass);
+    close(b.fd);
+  }
+
+  // --- cost
+  {
+    SyslogBuffer<BUFFER_RECORDS> buf;
+    for (uint16_t i = 0; i < BUFFER_RECORDS; ++i) buf.push("relay_1_ACTIVATED", SYSLOG_SEV_WARNING, i * 1000, EPOCH_BASE + i);
+    char datagram[SYSLOG_DATAGRAM_MAX];
+    const int reps = 200'000;
+    size_t sink = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i) {
+      uint16_t taken = 0;
+      sink += syslogBuildBatch(buf, IDENTITY, 60'000, EPOCH_BASE + 60, 0, BATCH_OPT_IN_RECORDS, datagram, sizeof(datagram), &taken);
+      sink += taken;
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / (static_cast<double>(reps) * BATCH_OPT_IN_RECORDS);
+    printf("format: %.0f ns/message on host, record %zu B, ring %zu B  [%zu]\n", ns, sizeof(SyslogRecord), sizeof(SyslogBuffer<BUFFER_RECORDS>), sink & 1);
+  }
+
+  listener.stop();
+  printf("%s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+// system_state_stress.cpp — test de stres host pentru snapshot-urile SystemState (include/seqlock.h)
+//
+// Build:
+//   g++ -O2 -std=c++17 -pthread -I../include system_state_stress.cpp -o system_state_stress
+//
+// Utilizare:
+//   ./system_state_stress [seconds=2] [readers=3]
+//
+// Un fir scriitor joacă rolul lui loop(): la fiecare "trecere" deschide o
+// scriere seqlock și rescrie toate câmpurile din SystemState dintr-un contor k.
+// Firele cititoare joacă rolul tickerului: tryRead() și verifică faptul că
+// fiecare copie acceptată provine dintr-o singură trecere (toate câmpurile din
+// același k). Un cititor naiv copiază fără contor, ca să se vadă că verificarea
+// chiar prinde stări rupte. Rezultat așteptat: 0 copii rupte prin tryRead().
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "system_state.h"
+
+static const uint8_t PARTITIONS = 2;  // la fel ca ALARM_PARTITION_COUNT din main.cpp
+using SystemState = SystemStateT<PARTITIONS>;
+
+// O trecere prin loop(): câmp cu câmp, în ordinea declarării, ca un cititor
+// care nu respectă protocolul să poată prinde o stare pe jumătate scrisă.
+static void fillFromCounter(SystemState& s, uint32_t k) {
+  for (uint8_t i = 0; i < PARTITIONS; ++i) {
+    s.partitions[i].state = static_cast<AlarmState>(k % 4);
+    s.partitions[i].armedMode = static_cast<AlarmState>(k % 3);
+    s.partitions[i].timerActive = (k & 1) != 0;
+    s.partitions[i].sinceMs = k;
+    s.partitions[i].timerDeadlineMs = k + i;
+  }
+  for (uint8_t i = 0; i < 4; ++i) s.lastMotionMs[i] = k ^ i;
+  s.alarmTriggerCount = k;
+  s.relay.cutUntilMs = k;
+  s.relay.nextAllowedMs = k;
+  s.relay.wifiDisconnectedSinceMs = k;
+  s.relay.unlockMs = k;
+  s.relay.activationCount = k;
+  s.relay.cutActive = (k & 1) != 0;
+  s.relay.pingDownActive = (k & 2) != 0;
+  s.relay.wifiWasConnected = (k & 4) != 0;
+  s.lastGooglePingMs = k;
+  s.pingCounter = k;
+  s.pingDownStartEpoch = k;
+  s.lastWifiDisconnectEpoch = k;
+  s.lastPingDownEpoch = k;
+  s.wifiOffLivePrintLastMs = k;
+  s.emulateWifiLastConnectTryMs = k;
+  s.wifiConnectStartMs = k;
+  s.lastHttpTimeTryMs = k;
+  s.lastAutoStatusMs = k;
+  s.statusPrintCounter = k;
+  s.bootToArmedUs = k;
+  s.lastPingRttMs = static_cast<uint16_t>(k);
+  s.wifiLastAssocMs = static_cast<uint16_t>(k >> 1);
+  s.wifiLastIpMs = static_cast<uint16_t>(k >> 2);
+  s.alarmState = static_cast<AlarmState>(k % 4);
+  s.wifiAttemptNetwork = k & 15;
+  s.wifiCacheValid = (k & 1) != 0;
+  s.wifiAttemptFast = (k & 2) != 0;
+  s.wifiNextAttemptFast = (k & 4) != 0;
+  s.wifiLastConnectFast = (k & 8) != 0;
+  s.wifiConnectInProgress = (k & 1) != 0;
+  s.emulateWifiOff = (k & 2) != 0;
+  s.emulateWifiOffLogged = (k & 4) != 0;
+  s.ntpStarted = (k & 8) != 0;
+  s.ntpReadyLogged = (k & 1) != 0;
+  s.ntpWaitingLogged = (k & 2) != 0;
+}
+
+// k-ul e luat din primul câmp; copia e consistentă dacă restul coincide.
+static bool consistent(const SystemState& s) {
+  if (s.version != SYSTEM_STATE_VERSION) return false;
+  SystemState expected;
+  memset(&expected, 0, sizeof(expected));
+  expected.version = SYSTEM_STATE_VERSION;
+  fillFromCounter(expected, s.partitions[0].sinceMs);
+  return memcmp(&expected, &s, sizeof(s)) == 0;
+}
+
+struct ReaderStats {
+  uint64_t attempts = 0;
+  uint64_t accepted = 0;
+  uint64_t torn = 0;
+};
+
+int main(int argc, char** argv) {
+  const double seconds = argc > 1 ? atof(argv[1]) : 2.0;
+  const int readers = argc > 2 ? atoi(argv[2]) : 3;
+
+  printf("SystemState<%u>: %zu B (alignof %zu)\n", PARTITIONS, sizeof(SystemState), alignof(SystemState));
+  printf("  partitions@%zu relay@%zu lastPingRttMs@%zu alarmState@%zu (flags follow)\n", offsetof(SystemState, partitions),
+         offsetof(SystemState, relay), offsetof(SystemState, lastPingRttMs), offsetof(SystemState, alarmState));
+
+  static SeqLocked<SystemState> shared;
+  // padding-ul trebuie să fie identic între copii (memcmp în consistent())
+  memset(&shared.value(), 0, sizeof(SystemState));
+  shared.value().version = SYSTEM_STATE_VERSION;
+  fillFromCounter(shared.value(), 0);
+
+  std::atomic<bool> stop{ false };
+  std::atomic<uint64_t> passes{ 0 };
+  std::thread writer([&] {
+    uint32_t k = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+      shared.beginWrite();
+      fillFromCounter(shared.value(), ++k);
+      shared.endWrite();
+    }
+    passes.store(k);
+  });
+
+  std::vector<ReaderStats> stats(static_cast<size_t>(readers));
+  std::vector<std::thread> threads;
+  for (int r = 0; r < readers; ++r) {
+    threads.emplace_back([&, r] {
+      ReaderStats& st = stats[static_cast<size_t>(r)];
+      SystemState snap;
+      while (!stop.load(std::memory_order_relaxed)) {
+        ++st.attempts;
+        if (!shared.tryRead(&snap)) continue;
+        ++st.accepted;
+        if (!consistent(snap)) ++st.torn;
+      }
+    });
+  }
+  // cititorul naiv: aceeași copie pe cuvinte, fără verificarea contorului
+  ReaderStats naive;
+  std::thread naiveReader([&] {
+    typedef uint32_t __attribute__((__may_alias__)) Word;
+    SystemState snap;
+    while (!stop.load(std::memory_order_relaxed)) {
+      const Word* src = reinterpret_cast<const Word*>(&shared.value());
+      Word* dst = reinterpret_cast<Word*>(&snap);
+      for (size_t i = 0; i < sizeof(SystemState) / 4; ++i) dst[i] = __atomic_load_n(src + i, __ATOMIC_RELAXED);
+      ++naive.attempts;
+      ++naive.accepted;
+      if (!consistent(snap)) ++naive.torn;
+    }
+  });
+
+  const auto t0 = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+  stop.store(true);
+  writer.join();
+  for (std::thread& t : threads) t.join();
+  naiveReader.join();
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  int failures = 0;
+  printf("writer: %llu passes (%.1f ns/pass)\n", static_cast<unsigned long long>(passes.load()), elapsed * 1e9 / passes.load());
+  for (int r = 0; r < readers; ++r) {
+    const ReaderStats& st = stats[static_cast<size_t>(r)];
+    printf("  tryRead reader %d: attempts=%llu accepted=%llu (%.1f%%) torn=%llu %s\n", r, static_cast<unsigned long long>(st.attempts),
+           static_cast<unsigned long long>(st.accepted), st.attempts ? 100.0 * st.accepted / st.attempts : 0.0,
+           static_cast<unsigned long long>(st.torn), st.torn == 0 ? "ok" : "TORN SNAPSHOT");
+    if (st.torn != 0 || st.accepted == 0) ++failures;
+  }
+  printf("  naive reader:     copies=%llu torn=%llu (expected > 0 on a multi-core host)\n", static_cast<unsigned long long>(naive.attempts),
+         static_cast<unsigned long long>(naive.torn));
+  return failures == 0 ? 0 : 1;
+}
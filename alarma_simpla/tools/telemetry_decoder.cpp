@@ -0,0 +1,327 @@
+// telemetry_decoder.cpp — decodor host pentru cadrele UDP de telemetrie (Linux)
+//
+// Build:
+//   g++ -O2 -std=c++17 -I../include telemetry_decoder.cpp -o telemetry_decoder
+//
+// Utilizare:
+//   ./telemetry_decoder listen [port]   afișează cadrele primite (status și evenimente) + pierderi (seq)
+//   ./telemetry_decoder bench [n]       cost encode/decode, loopback UDP, bytes/raport, evenimente dus-întors
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <unordered_map>
+
+#include "telemetry_frame.h"
+
+static const char* alarmStateName(uint8_t s) {
+  static const char* const NAMES[] = { "DISARMED", "ARMING", "ARMED", "ALARMING", "ENTRY_DELAY", "ARMED_STAY" };
+  return s < 6 ? NAMES[s] : "UNKNOWN";
+}
+
+static void formatEpoch(uint32_t epoch, char* out, size_t outSize) {
+  if (epoch == 0) {
+    snprintf(out, outSize, "-");
+    return;
+  }
+  const time_t t = static_cast<time_t>(epoch);
+  struct tm tmInfo;
+  gmtime_r(&t, &tmInfo);
+  strftime(out, outSize, "%Y-%m-%dT%H:%M:%SZ", &tmInfo);
+}
+
+static void printFrame(const char* from, const TelemetryFrame& f) {
+  char outage[32];
+  formatEpoch(f.lastOutageEpoch, outage, sizeof(outage));
+  printf("%s chip=%08x seq=%u up=%us alarm=%s wifi=%s relay=%s pingDown=%s rssi=%d rtt=%ums "
+         "pings=%u relayCycles=%u heap=%u maxBlock=%u boot=%u lastOutage=%s\n",
+         from, f.chipId, f.seq, f.uptimeSec, alarmStateName(f.alarmState),
+         (f.flags & TELEMETRY_FLAG_WIFI_CONNECTED) ? "UP" : "DOWN",
+         (f.flags & TELEMETRY_FLAG_INTERNET_CUT) ? "ACTIVE" : "INACTIVE",
+         (f.flags & TELEMETRY_FLAG_PING_DOWN) ? "YES" : "NO",
+         f.rssi, f.lastPingRttMs, f.pingCounter, f.relayActivationCount, f.freeHeap,
+         f.maxFreeBlock, f.bootCount, outage);
+}
+
+#define MSG_NAME_ENTRY(id, ro, en) #id,
+static const char* const MSG_NAMES[MSG_COUNT] = { MESSAGE_CATALOG(MSG_NAME_ENTRY) };
+#undef MSG_NAME_ENTRY
+
+static void formatEvent(const TelemetryEvent& e, char* out, size_t outSize) {
+  MsgArg args[TELEMETRY_EVENT_MAX_ARGS] = { 0, 0, 0, 0 };
+  const size_t count = telemetryEventArgs(e, args);
+  msgRender(out, outSize, msgText(MsgLang::EN, static_cast<Msg>(e.msgId)), args, count);
+}
+
+static void printEvent(const char* from, const TelemetryEvent& e) {
+  char text[128];
+  formatEvent(e, text, sizeof(text));
+  printf("%s chip=%08x seq=%u up=%us event=%s sev=%u \"%s\"\n", from, e.chipId, e.seq, e.uptimeSec, MSG_NAMES[e.msgId], e.severity, text);
+}
+
+static int openUdp(uint16_t port) {
+  const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) return -1;
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static int runListen(uint16_t port) {
+  const int fd = openUdp(port);
+  if (fd < 0) {
+    perror("bind");
+    return 1;
+  }
+  printf("listening on UDP %u\n", port);
+
+  struct SeqTrack {
+    uint32_t nextSeq;
+    uint64_t received;
+    uint64_t lost;
+  };
+  std::unordered_map<uint32_t, SeqTrack> devices;
+  uint8_t buf[512];
+  for (;;) {
+    sockaddr_in from = {};
+    socklen_t fromLen = sizeof(from);
+    const ssize_t n = recvfrom(fd, buf, sizeof(buf), 0, reinterpret_cast<sockaddr*>(&from), &fromLen);
+    if (n < 0) continue;
+
+    // status și evenimente au același seq
+    TelemetryFrame f;
+    TelemetryEvent e;
+    uint32_t chipId, seq;
+    const bool isStatus = telemetryDecode(buf, static_cast<size_t>(n), &f);
+    if (isStatus) {
+      chipId = f.chipId;
+      seq = f.seq;
+    } else if (telemetryEventDecode(buf, static_cast<size_t>(n), &e)) {
+      chipId = e.chipId;
+      seq = e.seq;
+    } else {
+      printf("bad frame (%zd bytes)\n", n);
+      continue;
+    }
+
+    auto it = devices.find(chipId);
+    if (it == devices.end()) {
+      it = devices.emplace(chipId, SeqTrack{ seq, 0, 0 }).first;
+    }
+    SeqTrack& t = it->second;
+    if (seq > t.nextSeq) {
+      t.lost += seq - t.nextSeq;  // goluri în seq
+    } else if (seq < t.nextSeq && seq == 0) {
+      t.nextSeq = 0;  // reboot: seq repornește de la 0
+    }
+    t.nextSeq = seq + 1;
+    ++t.received;
+
+    char addr[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &from.sin_addr, addr, sizeof(addr));
+    if (isStatus) {
+      printFrame(addr, f);
+    } else {
+      printEvent(addr, e);
+    }
+    if (t.lost) {
+      printf("  chip=%08x received=%llu lost=%llu\n", chipId, static_cast<unsigned long long>(t.received), static_cast<unsigned long long>(t.lost));
+    }
+    fflush(stdout);
+  }
+}
+
+// Aproximarea blocului text din printRuntimeStatus() pentru comparația de mărime.
+static std::string textStatusSample(const TelemetryFrame& f) {
+  char buf[2048];
+  snprintf(buf, sizeof(buf),
+           "\r\n\r\n=====  %u  ===== >>\r\n"
+           "\xF0\x9F\x9A\xA8[ Stare alarm\xC4\x83]\r\nAlarm\xC4\x83: %s\r\nInternet relay: %s\r\nPing down activ: %s\r\n"
+           "Ping down start: NO_REAL_TIME\r\n\r\n"
+           "[\xF0\x9F\x8C\x90 Re\xC8\x9B" "ea WiFi]\r\nStatus WiFi: CONNECTED\r\nWiFi emulation: OFF\r\n"
+           "IP local: 192.168.0.105\r\nGateway: 192.168.0.1\r\nDNS: 192.168.0.1\r\nrssi=%d\r\n"
+           "SSID: TP-Link_583B ch=6\r\nLast connect: fast assoc=120 ms ip=180 ms\r\n\r\n"
+           "[\xF0\x9F\x8C\x8D Conectivitate Internet]\r\nUltima deconectare: 19/10/2026 03:12:44\r\n"
+           "WiFi disconnected since: 0:00:00\r\nPing counter: %u\r\nPing interval: 60000 ms (60 sec)\r\n\r\n"
+           "System ::\r\nNTP started: YES\r\nNTP ready: YES\r\nFree heap: %u\r\nOTA: IDLE\r\n"
+           "Chip ID: %X\r\nUptime: %u:%02u:%02u\r\n=====  %u  =====  <<\r\n\r\n",
+           f.seq, alarmStateName(f.alarmState), (f.flags & TELEMETRY_FLAG_INTERNET_CUT) ? "ACTIVE" : "INACTIVE",
+           (f.flags & TELEMETRY_FLAG_PING_DOWN) ? "YES" : "NO", f.rssi, f.pingCounter, f.freeHeap, f.chipId,
+           f.uptimeSec / 3600, (f.uptimeSec % 3600) / 60, f.uptimeSec % 60, f.seq);
+  return buf;
+}
+
+static TelemetryFrame sampleFrame(uint32_t seq) {
+  TelemetryFrame f = {};
+  f.seq = seq;
+  f.chipId = 0x00C0FFEE;
+  f.uptimeSec = 86400 + seq;
+  f.epoch = 1790000000 + seq;
+  f.lastOutageEpoch = 1789990000;
+  f.pingCounter = 1440 + seq;
+  f.relayActivationCount = 3;
+  f.freeHeap = 41000 - (seq % 100);
+  f.maxFreeBlock = 30000;
+  f.alarmState = 2;
+  f.flags = TELEMETRY_FLAG_WIFI_CONNECTED | TELEMETRY_FLAG_NTP_READY;
+  f.rssi = -67;
+  f.loopStage = 8;
+  f.lastPingRttMs = 23;
+  f.bootCount = 4;
+  return f;
+}
+
+// Un eveniment dus-întors: textul refăcut din cadru = textul din logEvent().
+template <typename... Args>
+static bool eventRoundTrip(Msg id, const Args&... args) {
+  const MsgArg argv[sizeof...(Args) + 1] = { MsgArg(args)..., MsgArg(0) };
+  char expected[128];
+  msgRender(expected, sizeof(expected), msgText(MsgLang::EN, id), argv, sizeof...(Args));
+  TelemetryEvent e = {};
+  e.seq = 7;
+  e.chipId = 0x00C0FFEE;
+  e.msgId = static_cast<uint16_t>(id);
+  telemetryEventSetArgs(&e, argv, sizeof...(Args));
+  uint8_t buf[TELEMETRY_FRAME_SIZE];
+  telemetryEventEncode(e, buf);
+  TelemetryEvent d;
+  TelemetryFrame f;
+  if (!telemetryEventDecode(buf, sizeof(buf), &d) || telemetryDecode(buf, sizeof(buf), &f)) return false;
+  char text[128];
+  formatEvent(d, text, sizeof(text));
+  return d.seq == 7 && d.chipId == 0x00C0FFEE && strcmp(text, expected) == 0;
+}
+
+static bool eventChecks() {
+  bool ok = true;
+  auto check = [&](const char* what, bool pass) {
+    printf("  %-58s %s\n", what, pass ? "ok" : "FAILED");
+    ok = ok && pass;
+  };
+  printf("event frames:\n");
+  check("EVT_ALARM_STATE (text + number)", eventRoundTrip(Msg::EVT_ALARM_STATE, "ENTRY_DELAY", 1u));
+  check("EVT_FAULT_ARMED (negative number)", eventRoundTrip(Msg::EVT_FAULT_ARMED, "PING_RTT", -40, 600u));
+  check("EVT_BUTTON_GESTURE (three arguments)", eventRoundTrip(Msg::EVT_BUTTON_GESTURE, "long", "ARM", 12u));
+  check("EVT_WIFI_CONNECTED (no arguments)", eventRoundTrip(Msg::EVT_WIFI_CONNECTED));
+
+  // un text prea lung se trunchiază, cadrul rămâne valid
+  const char* longText = "a text argument much longer than the thirty-five byte area";
+  const MsgArg argv[2] = { MsgArg(longText), MsgArg(3u) };
+  TelemetryEvent e = {};
+  e.msgId = static_cast<uint16_t>(Msg::EVT_ZONE_BYPASSED);
+  const bool complete = telemetryEventSetArgs(&e, argv, 2);
+  uint8_t buf[TELEMETRY_FRAME_SIZE];
+  telemetryEventEncode(e, buf);
+  TelemetryEvent d;
+  MsgArg out[TELEMETRY_EVENT_MAX_ARGS] = { 0, 0, 0, 0 };
+  const bool decoded = telemetryEventDecode(buf, sizeof(buf), &d) && telemetryEventArgs(d, out) == 2;
+  check("oversized text truncated, frame still decodes", !complete && decoded && out[0].kind == MsgArg::STR && strlen(out[0].s) == TELEMETRY_EVENT_ARG_BYTES - 1);
+
+  // CRC greșit, ID în afara catalogului, text fără '\0'
+  uint8_t bad[TELEMETRY_FRAME_SIZE];
+  memcpy(bad, buf, sizeof(bad));
+  bad[30] ^= 1;
+  check("corrupted event frame rejected (CRC)", !telemetryEventDecode(bad, sizeof(bad), &d));
+  e.msgId = MSG_COUNT;
+  telemetryEventEncode(e, bad);
+  check("unknown message id rejected", !telemetryEventDecode(bad, sizeof(bad), &d));
+  e.msgId = static_cast<uint16_t>(Msg::EVT_TRACE_SAVED);
+  e.argCount = 1;
+  e.argKinds = MsgArg::STR;
+  memset(e.args, 'x', sizeof(e.args));
+  telemetryEventEncode(e, bad);
+  check("unterminated text argument rejected", !telemetryEventDecode(bad, sizeof(bad), &d));
+  return ok;
+}
+
+static int runBench(uint32_t n) {
+  using Clock = std::chrono::steady_clock;
+  uint8_t buf[TELEMETRY_FRAME_SIZE];
+  volatile uint32_t sink = 0;
+
+  auto t0 = Clock::now();
+  for (uint32_t i = 0; i < n; ++i) {
+    const TelemetryFrame f = sampleFrame(i);
+    telemetryEncode(f, buf);
+    sink += buf[60];
+  }
+  auto t1 = Clock::now();
+  uint32_t decodeErrors = 0;
+  for (uint32_t i = 0; i < n; ++i) {
+    telemetryEncode(sampleFrame(i), buf);
+    TelemetryFrame f;
+    if (!telemetryDecode(buf, sizeof(buf), &f) || f.seq != i) ++decodeErrors;
+  }
+  auto t2 = Clock::now();
+
+  const double encNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+  const double encDecNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / n;
+  printf("encode:          %.1f ns/frame\n", encNs);
+  printf("encode+decode:   %.1f ns/frame (errors=%u)\n", encDecNs, decodeErrors);
+
+  size_t textBytes = 0;
+  auto t3 = Clock::now();
+  for (uint32_t i = 0; i < n; ++i) {
+    textBytes += textStatusSample(sampleFrame(i)).size();
+  }
+  auto t4 = Clock::now();
+  printf("text format:     %.1f ns/report, %.0f bytes/report\n", std::chrono::duration<double, std::nano>(t4 - t3).count() / n, static_cast<double>(textBytes) / n);
+  printf("binary format:   %zu bytes/report (%.1fx smaller)\n", TELEMETRY_FRAME_SIZE, static_cast<double>(textBytes) / n / TELEMETRY_FRAME_SIZE);
+
+  // loopback UDP: fiecare cadru trimis trebuie decodat identic și în ordine
+  const int rx = openUdp(0);
+  const int tx = socket(AF_INET, SOCK_DGRAM, 0);
+  if (rx < 0 || tx < 0) {
+    perror("socket");
+    return 1;
+  }
+  sockaddr_in dst = {};
+  socklen_t dstLen = sizeof(dst);
+  getsockname(rx, reinterpret_cast<sockaddr*>(&dst), &dstLen);
+  dst.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  timeval tv = { 1, 0 };
+  setsockopt(rx, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+  const uint32_t loopbackFrames = n < 10000 ? n : 10000;
+  uint32_t ok = 0;
+  auto t5 = Clock::now();
+  for (uint32_t i = 0; i < loopbackFrames; ++i) {
+    telemetryEncode(sampleFrame(i), buf);
+    sendto(tx, buf, sizeof(buf), 0, reinterpret_cast<sockaddr*>(&dst), sizeof(dst));
+    uint8_t in[256];
+    const ssize_t got = recv(rx, in, sizeof(in), 0);
+    TelemetryFrame f;
+    if (got > 0 && telemetryDecode(in, static_cast<size_t>(got), &f) && f.seq == i) ++ok;
+  }
+  auto t6 = Clock::now();
+  printf("UDP loopback:    %u/%u frames ok, %.1f us/round-trip\n", ok, loopbackFrames, std::chrono::duration<double, std::micro>(t6 - t5).count() / loopbackFrames);
+  close(rx);
+  close(tx);
+  (void)sink;
+  const bool eventsOk = eventChecks();
+  return ok == loopbackFrames && decodeErrors == 0 && eventsOk ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+  if (argc >= 2 && strcmp(argv[1], "listen") == 0) {
+    return runListen(static_cast<uint16_t>(argc >= 3 ? atoi(argv[2]) : 5140));
+  }
+  if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+    return runBench(static_cast<uint32_t>(argc >= 3 ? strtoul(argv[2], nullptr, 10) : 1000000));
+  }
+  fprintf(stderr, "usage: %s listen [port] | bench [n]\n", argv[0]);
+  return 2;
+}
@@ -0,0 +1,358 @@
+// tls_probe_server.cpp — server HTTPS local pentru testarea clientului TLS din firmware (host Linux, OpenSSL)
+//
+// Build:
+//   g++ -O2 -std=c++17 -pthread tls_probe_server.cpp -o tls_probe_server -lssl -lcrypto
+//
+// Utilizare:
+//   ./tls_probe_server [--port 8443] [--rsa] [--idle <sec>] [--cert cert.pem --key key.pem]
+//   ./tls_probe_server selftest [conexiuni=20] [cereri_per_conexiune=3]
+//
+// Răspunde la HEAD/GET /generate_204 cu 204 + header Date, pe conexiuni
+// keep-alive, exact ce cere tryHttpsTimeSyncIfNeeded(). Ca BearSSL de pe placă:
+// maxim TLS 1.2, reluare doar prin session ID (fără tickets), MFLN acceptat.
+// Pentru fiecare conexiune afișează suita, dacă sesiunea a fost reluată,
+// fragmentul negociat și durata handshake-ului văzută de server.
+//
+// Fără --cert/--key se generează un certificat self-signed EC P-256 (sau
+// RSA-2048 cu --rsa, pentru HTTPS_FAST_CIPHERS); amprenta SHA1 afișată la
+// pornire merge direct în HTTPS_FINGERPRINT. Pe placă: HTTPS_HOST = IP-ul
+// PC-ului, HTTPS_PORT = portul de aici, apoi comanda HTTPSNOW.
+//
+// selftest pornește serverul pe 127.0.0.1 și un client OpenSSL care se
+// comportă ca firmware-ul (session ID păstrat între conexiuni, MFLN 512,
+// mai multe cereri pe aceeași conexiune) și verifică: primul handshake e
+// complet, restul reluate, toate cererile primesc 204 cu Date.
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+static std::mutex logMutex;
+static std::atomic<uint32_t> connectionCount{ 0 };
+static std::atomic<uint32_t> resumedCount{ 0 };
+static std::atomic<uint32_t> requestCount{ 0 };
+
+static double msSince(Clock::time_point t0) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static void fail(const char* what) {
+  fprintf(stderr, "%s\n", what);
+  ERR_print_errors_fp(stderr);
+  exit(1);
+}
+
+// Certificat self-signed, valabil de ieri încă un an.
+static void makeSelfSigned(bool rsa, EVP_PKEY** outKey, X509** outCert) {
+  EVP_PKEY* key = rsa ? EVP_RSA_gen(2048) : EVP_EC_gen("P-256");
+  if (key == nullptr) fail("key generation failed");
+  X509* cert = X509_new();
+  X509_set_version(cert, 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(cert), static_cast<long>(time(nullptr)));
+  X509_gmtime_adj(X509_getm_notBefore(cert), -86400);
+  X509_gmtime_adj(X509_getm_notAfter(cert), 365L * 86400);
+  X509_set_pubkey(cert, key);
+  X509_NAME* name = X509_get_subject_name(cert);
+  X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("alarma-probe"), -1, -1, 0);
+  X509_set_issuer_name(cert, name);
+  if (X509_sign(cert, key, EVP_sha256()) == 0) fail("certificate signing failed");
+  *outKey = key;
+  *outCert = cert;
+}
+
+static void printFingerprint(X509* cert) {
+  unsigned char md[EVP_MAX_MD_SIZE];
+  unsigned int n = 0;
+  X509_digest(cert, EVP_sha1(), md, &n);
+  printf("certificate SHA1 (HTTPS_FINGERPRINT): ");
+  for (unsigned int i = 0; i < n; ++i) printf(i ? ":%02X" : "%02X", md[i]);
+  printf("\n");
+}
+
+static SSL_CTX* makeServerContext(bool rsa, const char* certPath, const char* keyPath) {
+  SSL_CTX* ctx = SSL_CTX_new(TLS_server_method());
+  if (ctx == nullptr) fail("SSL_CTX_new failed");
+  // ca BearSSL: TLS 1.2, reluare prin session ID
+  SSL_CTX_set_max_proto_version(ctx, TLS1_2_VERSION);
+  SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+  SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+  static const unsigned char sidContext[] = "alarma_simpla";
+  SSL_CTX_set_session_id_context(ctx, sidContext, sizeof(sidContext) - 1);
+  SSL_CTX_set_timeout(ctx, 24 * 3600);
+
+  if (certPath != nullptr && keyPath != nullptr) {
+    if (SSL_CTX_use_certificate_chain_file(ctx, certPath) != 1) fail("cannot load certificate");
+    if (SSL_CTX_use_PrivateKey_file(ctx, keyPath, SSL_FILETYPE_PEM) != 1) fail("cannot load private key");
+    printFingerprint(SSL_CTX_get0_certificate(ctx));
+  } else {
+    EVP_PKEY* key = nullptr;
+    X509* cert = nullptr;
+    makeSelfSigned(rsa, &key, &cert);
+    SSL_CTX_use_certificate(ctx, cert);
+    SSL_CTX_use_PrivateKey(ctx, key);
+    printFingerprint(cert);
+    X509_free(cert);
+    EVP_PKEY_free(key);
+  }
+  return ctx;
+}
+
+static void httpDate(char* out, size_t outSize) {
+  const time_t now = time(nullptr);
+  struct tm tmUtc;
+  gmtime_r(&now, &tmUtc);
+  strftime(out, outSize, "%a, %d %b %Y %H:%M:%S GMT", &tmUtc);
+}
+
+// Citește o cerere (până la linia goală); false la închidere/timeout.
+static bool readRequest(SSL* ssl, std::string* request) {
+  request->clear();
+  char buf[512];
+  while (request->find("\r\n\r\n") == std::string::npos) {
+    const int n = SSL_read(ssl, buf, sizeof(buf));
+    if (n <= 0) return false;
+    request->append(buf, static_cast<size_t>(n));
+    if (request->size() > 8192) return false;
+  }
+  return true;
+}
+
+static void serveConnection(SSL_CTX* ctx, int fd, std::string peer) {
+  SSL* ssl = SSL_new(ctx);
+  SSL_set_fd(ssl, fd);
+  const auto t0 = Clock::now();
+  if (SSL_accept(ssl) != 1) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    printf("%s: handshake failed\n", peer.c_str());
+    ERR_print_errors_fp(stdout);
+    SSL_free(ssl);
+    close(fd);
+    return;
+  }
+  const double handshakeMs = msSince(t0);
+  const bool resumed = SSL_session_reused(ssl) == 1;
+  const uint8_t mfl = SSL_SESSION_get_max_fragment_length(SSL_get_session(ssl));
+  const uint32_t id = ++connectionCount;
+  if (resumed) ++resumedCount;
+  {
+    std::lock_guard<std::mutex> lock(logMutex);
+    printf("conn #%u %s: %s %s, %s, MFLN %u, handshake %.1f ms (server side)\n", id, peer.c_str(), SSL_get_version(ssl), SSL_get_cipher_name(ssl),
+           resumed ? "RESUMED" : "full", mfl ? 256u << mfl : 0u, handshakeMs);
+    fflush(stdout);
+  }
+
+  std::string request;
+  uint32_t onThisConnection = 0;
+  while (readRequest(ssl, &request)) {
+    ++onThisConnection;
+    ++requestCount;
+    const bool head = request.compare(0, 5, "HEAD ") == 0;
+    const bool known = request.find(" /generate_204 ") != std::string::npos;
+    const bool closeRequested = request.find("\r\nConnection: close") != std::string::npos;
+    char date[64];
+    httpDate(date, sizeof(date));
+    char response[256];
+    const int n = snprintf(response, sizeof(response), "HTTP/1.1 %s\r\nDate: %s\r\nContent-Length: 0\r\nConnection: %s\r\n\r\n",
+                           known ? "204 No Content" : "404 Not Found", date, closeRequested ? "close" : "keep-alive");
+    if (SSL_write(ssl, response, n) != n) break;
+    {
+      std::lock_guard<std::mutex> lock(logMutex);
+      printf("  conn #%u req %u: %s %s -> %s\n", id, onThisConnection, head ? "HEAD" : "GET", known ? "/generate_204" : "?", known ? "204" : "404");
+      fflush(stdout);
+    }
+    if (closeRequested) break;
+  }
+  SSL_shutdown(ssl);
+  SSL_free(ssl);
+  close(fd);
+  std::lock_guard<std::mutex> lock(logMutex);
+  printf("conn #%u closed after %u requests (totals: %u conns, %u resumed, %u requests)\n", id, onThisConnection, connectionCount.load(),
+         resumedCount.load(), requestCount.load());
+  fflush(stdout);
+}
+
+static int listenOn(const char* address, uint16_t port) {
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  const int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, address, &addr.sin_addr);
+  if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+    perror("bind/listen");
+    exit(1);
+  }
+  return fd;
+}
+
+static uint16_t boundPort(int fd) {
+  sockaddr_in addr = {};
+  socklen_t len = sizeof(addr);
+  getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+  return ntohs(addr.sin_port);
+}
+
+static void acceptLoop(SSL_CTX* ctx, int listenFd, int idleSec) {
+  for (;;) {
+    sockaddr_in peer = {};
+    socklen_t len = sizeof(peer);
+    const int fd = accept(listenFd, reinterpret_cast<sockaddr*>(&peer), &len);
+    if (fd < 0) continue;
+    timeval tv = { idleSec, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    const int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    char ip[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &peer.sin_addr, ip, sizeof(ip));
+    std::thread(serveConnection, ctx, fd, std::string(ip) + ":" + std::to_string(ntohs(peer.sin_port))).detach();
+  }
+}
+
+// ----------------------------
+// selftest: client care imită firmware-ul
+// ----------------------------
+static int connectTo(uint16_t port) {
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// HEAD /generate_204 pe o conexiune deschisă: true dacă vine 204 cu Date.
+static bool clientHead(SSL* ssl) {
+  static const char request[] = "HEAD /generate_204 HTTP/1.1\r\nHost: 127.0.0.1\r\nUser-Agent: alarma_simpla\r\nConnection: keep-alive\r\n\r\n";
+  if (SSL_write(ssl, request, sizeof(request) - 1) != static_cast<int>(sizeof(request) - 1)) return false;
+  std::string response;
+  if (!readRequest(ssl, &response)) return false;
+  return response.compare(0, 13, "HTTP/1.1 204 ") == 0 && response.find("\r\nDate: ") != std::string::npos;
+}
+
+static int selftest(int connections, int requestsPerConnection) {
+  SSL_CTX* serverCtx = makeServerContext(false, nullptr, nullptr);
+  const int listenFd = listenOn("127.0.0.1", 0);
+  const uint16_t port = boundPort(listenFd);
+  std::thread(acceptLoop, serverCtx, listenFd, 5).detach();
+
+  SSL_CTX* clientCtx = SSL_CTX_new(TLS_client_method());
+  SSL_CTX_set_max_proto_version(clientCtx, TLS1_2_VERSION);
+  SSL_CTX_set_options(clientCtx, SSL_OP_NO_TICKET);
+  SSL_CTX_set_verify(clientCtx, SSL_VERIFY_NONE, nullptr);
+
+  SSL_SESSION* session = nullptr;
+  int failures = 0;
+  int full = 0;
+  int resumed = 0;
+  double fullMs = 0;
+  double resumedMs = 0;
+  for (int c = 0; c < connections; ++c) {
+    const int fd = connectTo(port);
+    if (fd < 0) fail("connect failed");
+    SSL* ssl = SSL_new(clientCtx);
+    SSL_set_fd(ssl, fd);
+    SSL_set_tlsext_max_fragment_length(ssl, TLSEXT_max_fragment_length_512);
+    if (session != nullptr) SSL_set_session(ssl, session);
+    const auto t0 = Clock::now();
+    if (SSL_connect(ssl) != 1) fail("client handshake failed");
+    const double ms = msSince(t0);
+    const bool wasResumed = SSL_session_reused(ssl) == 1;
+    if (wasResumed) {
+      ++resumed;
+      resumedMs += ms;
+    } else {
+      ++full;
+      fullMs += ms;
+    }
+    // primul handshake e complet, restul trebuie reluate
+    if (wasResumed != (c > 0)) {
+      printf("client conn %d: expected %s handshake\n", c + 1, c > 0 ? "resumed" : "full");
+      ++failures;
+    }
+    if (SSL_SESSION_get_max_fragment_length(SSL_get_session(ssl)) != TLSEXT_max_fragment_length_512) {
+      printf("client conn %d: MFLN 512 not negotiated\n", c + 1);
+      ++failures;
+    }
+    for (int r = 0; r < requestsPerConnection; ++r) {
+      if (!clientHead(ssl)) {
+        printf("client conn %d req %d: no 204/Date\n", c + 1, r + 1);
+        ++failures;
+      }
+    }
+    if (session != nullptr) SSL_SESSION_free(session);
+    session = SSL_get1_session(ssl);
+    SSL_shutdown(ssl);
+    SSL_free(ssl);
+    close(fd);
+  }
+  if (session != nullptr) SSL_SESSION_free(session);
+  // serverul își termină log-ul pentru ultima conexiune
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  std::lock_guard<std::mutex> lock(logMutex);
+  printf("selftest: %d connections x %d requests, handshakes full %d (avg %.2f ms) / resumed %d (avg %.2f ms)\n", connections,
+         requestsPerConnection, full, full ? fullMs / full : 0.0, resumed, resumed ? resumedMs / resumed : 0.0);
+  printf("%s\n", failures == 0 ? "ok" : "FAILED");
+  fflush(stdout);
+  _exit(failures == 0 ? 0 : 1);  // firele serverului rămân în accept()
+}
+
+int main(int argc, char** argv) {
+  signal(SIGPIPE, SIG_IGN);
+  if (argc > 1 && strcmp(argv[1], "selftest") == 0) {
+    const int connections = argc > 2 ? atoi(argv[2]) : 20;
+    const int requests = argc > 3 ? atoi(argv[3]) : 3;
+    return selftest(connections > 0 ? connections : 1, requests > 0 ? requests : 1);
+  }
+
+  uint16_t port = 8443;
+  bool rsa = false;
+  int idleSec = 30;
+  const char* certPath = nullptr;
+  const char* keyPath = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+      port = static_cast<uint16_t>(atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--rsa") == 0) {
+      rsa = true;
+    } else if (strcmp(argv[i], "--idle") == 0 && i + 1 < argc) {
+      idleSec = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--cert") == 0 && i + 1 < argc) {
+      certPath = argv[++i];
+    } else if (strcmp(argv[i], "--key") == 0 && i + 1 < argc) {
+      keyPath = argv[++i];
+    } else {
+      fprintf(stderr, "usage: %s [--port 8443] [--rsa] [--idle sec] [--cert cert.pem --key key.pem] | selftest [conns] [reqs]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  SSL_CTX* ctx = makeServerContext(rsa, certPath, keyPath);
+  const int listenFd = listenOn("0.0.0.0", port);
+  printf("listening on 0.0.0.0:%u (TLS 1.2, session-ID cache, no tickets, idle close %d s)\n", port, idleSec);
+  fflush(stdout);
+  acceptLoop(ctx, listenFd, idleSec);
+  return 0;
+}
@@ -0,0 +1,698 @@
+// trace_replay.cpp — replay host pentru urma de intrări salvată de firmware (include/input_trace.h)
+//
+// Build:
+//   g++ -O2 -std=c++17 -I../include trace_replay.cpp -o trace_replay
+//
+// Utilizare:
+//   ./trace_replay replay <trace.bin|captura.log> [-q]
+//       trace.bin = fișierul /trace.bin din LittleFS; captura = log serial/TCP
+//       care conține blocul TRACE BEGIN ... TRACE END (comenzile TRACE DUMP/SAVED).
+//       Afișează jurnalul de decizii refăcut și îl compară cu deciziile
+//       înregistrate pe placă (și starea de la finalul jumătății vechi cu
+//       snapshot-ul jumătății noi). Cod de ieșire 0 = identic bit cu bit.
+//   ./trace_replay bench [passes=5000000] [seed=1] [out.bin]
+//       Rulează o simulare a loop()-ului (PIR, WiFi, ping, comenzi) prin
+//       același recorder ca firmware-ul, face replay periodic pe ring și
+//       verifică jurnalul de decizii față de simulare; raportează costul
+//       recorder-ului per trecere. Cu out.bin salvează ring-ul final, în
+//       același format ca /trace.bin de pe placă.
+//   ./trace_replay table [-v]
+//       Parcurge tabelul alarmei tranziție cu tranziție: fiecare stare x
+//       eveniment (x modul armat memorat, ARMED/ARMED_STAY) prin alarmApply(),
+//       comparat cu o specificație scrisă separat: starea următoare, sirena,
+//       citirea PIR-urilor, LED-ul, timerul pornit și contorul de alarme.
+//       Cu -v afișează fiecare rând.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "input_trace.h"
+#include "zone_health.h"
+
+struct Decision {
+  uint32_t atMs;
+  uint8_t kind;
+  uint8_t arg;
+  bool operator==(const Decision& o) const { return atMs == o.atMs && kind == o.kind && arg == o.arg; }
+};
+
+static const char* stateName(uint8_t s) {
+  return s < ALARM_STATE_COUNT ? ALARM_STATE_INFO[s].name : "UNKNOWN";
+}
+
+static void formatDecision(const Decision& d, char* out, size_t outSize) {
+  if (d.kind == TRACE_DECISION_ALARM) {
+    snprintf(out, outSize, "%10u ms  alarm P%u -> %s", d.atMs, (d.arg >> 4) + 1u, stateName(d.arg & 0x0F));
+    return;
+  }
+  static const char* const BITS[] = { "WIFI_DOWN", "WIFI_UP", "FORCED_INACTIVE", "DEACTIVATED", "ACTIVATED", "PING_DOWN" };
+  int n = snprintf(out, outSize, "%10u ms  relay", d.atMs);
+  for (uint8_t i = 0; i < 6 && n > 0 && static_cast<size_t>(n) < outSize; ++i) {
+    if (d.arg & (1u << i)) n += snprintf(out + n, outSize - n, " %s", BITS[i]);
+  }
+}
+
+// ----------------------------
+// Replay
+// ----------------------------
+struct HalfResult {
+  bool ok = true;  // format valid
+  uint32_t passes = 0;
+  uint32_t startMs = 0;
+  std::vector<Decision> recorded;
+  std::vector<Decision> replayed;
+  TracedState finalState = {};
+  uint8_t partitionCount = 0;
+};
+
+struct PassRecords {
+  bool hasLevels = false;
+  uint8_t levels = 0;
+  bool hasState[TRACE_PHASE_COUNT] = {};
+  TracedState state[TRACE_PHASE_COUNT];
+  bool hasPing = false;
+  bool pingOk = false;
+  uint32_t pingOffsetMs = 0;
+};
+
+// Aceeași ordine ca loop() din main.cpp (vezi input_trace.h).
+static void replayPass(TracedState& s, const TraceConfig& config, uint32_t now, uint8_t levels, const PassRecords& rec, std::vector<Decision>& out) {
+  const uint8_t d = relayLoopStep(s.relay, now, (levels & TRACE_LEVEL_WIFI) != 0);
+  if (d != RELAY_DECISION_NONE) out.push_back({ now, TRACE_DECISION_RELAY, d });
+  if (rec.hasState[TRACE_PHASE_INPUT]) s = rec.state[TRACE_PHASE_INPUT];
+
+  auto dispatch = [&](uint8_t p, AlarmEvent event) {
+    if (p >= config.partitionCount) return;
+    if (alarmApply(s.partitions[p], event, now, config.timings, &s.alarmTriggerCount)) {
+      out.push_back({ now, TRACE_DECISION_ALARM, static_cast<uint8_t>((p << 4) | static_cast<uint8_t>(s.partitions[p].state)) });
+    }
+  };
+  alarmZonesStep(config.zones, TRACE_ZONES, s.partitions, static_cast<uint8_t>(levels & ~s.zoneBypass), s.lastMotionMs, now, config.timings, dispatch);
+  alarmTimersStep(s.partitions, config.partitionCount, now, dispatch);
+  if (rec.hasState[TRACE_PHASE_NETWORK]) s = rec.state[TRACE_PHASE_NETWORK];
+
+  if (rec.hasPing) {
+    const uint32_t at = now + rec.pingOffsetMs;
+    const uint8_t pd = relayPingResult(s.relay, at, rec.pingOk);
+    if (pd != RELAY_DECISION_NONE) out.push_back({ at, TRACE_DECISION_RELAY, pd });
+  }
+  if (rec.hasState[TRACE_PHASE_LATE]) s = rec.state[TRACE_PHASE_LATE];
+}
+
+static HalfResult replayHalf(const uint8_t* p, size_t len, bool verbose) {
+  HalfResult r;
+  const uint8_t* end = p + len;
+  const size_t snapshotFixed = 1 + 4 + 1 + 1 + TRACE_ZONES * 2 + 4 * 4;
+  if (len < snapshotFixed || p[0] != TRACE_TAG_SNAPSHOT) {
+    r.ok = false;
+    return r;
+  }
+  TraceConfig config = {};
+  uint32_t now = traceGetU32(p + 1);
+  uint8_t levels = p[5];
+  config.partitionCount = p[6];
+  if (config.partitionCount == 0 || config.partitionCount > TRACE_MAX_PARTITIONS) {
+    r.ok = false;
+    return r;
+  }
+  for (uint8_t i = 0; i < TRACE_ZONES; ++i) {
+    config.zones[i].partition = p[7 + 2 * i];
+    config.zones[i].type = static_cast<ZoneType>(p[8 + 2 * i]);
+  }
+  const uint8_t* q = p + 7 + 2 * TRACE_ZONES;
+  config.timings.exitDelayMs = traceGetU32(q);
+  config.timings.entryDelayMs = traceGetU32(q + 4);
+  config.timings.sirenMs = traceGetU32(q + 8);
+  config.timings.motionRetriggerMs = traceGetU32(q + 12);
+  q += 16;
+  const size_t stateBytes = traceStateBytes(config.partitionCount);
+  if (static_cast<size_t>(end - q) < stateBytes) {
+    r.ok = false;
+    return r;
+  }
+  TracedState s;
+  q += traceDecodeState(q, config.partitionCount, &s);
+  r.partitionCount = config.partitionCount;
+  r.startMs = now;
+
+  bool inPass = false;
+  PassRecords rec;
+  auto flushPass = [&]() {
+    if (!inPass) return;
+    if (rec.hasLevels) levels = rec.levels;
+    replayPass(s, config, now, levels, rec, r.replayed);
+    ++r.passes;
+    rec = PassRecords();
+  };
+
+  while (q < end) {
+    const uint8_t tag = *q++;
+    const size_t avail = static_cast<size_t>(end - q);
+    switch (tag) {
+      case TRACE_TAG_PASS: {
+        uint32_t dt = 0;
+        const size_t n = traceGetVarint(q, avail, &dt);
+        if (n == 0) { r.ok = false; break; }
+        flushPass();
+        q += n;
+        now += dt;
+        inPass = true;
+        break;
+      }
+      case TRACE_TAG_LEVELS:
+        if (avail < 1) { r.ok = false; break; }
+        rec.hasLevels = true;
+        rec.levels = *q++;
+        break;
+      case TRACE_TAG_STATE: {
+        if (avail < 1 + stateBytes || q[0] >= TRACE_PHASE_COUNT) { r.ok = false; break; }
+        const uint8_t phase = q[0];
+        rec.hasState[phase] = true;
+        q += 1 + traceDecodeState(q + 1, config.partitionCount, &rec.state[phase]);
+        break;
+      }
+      case TRACE_TAG_PING: {
+        uint32_t off = 0;
+        const size_t n = avail >= 2 ? traceGetVarint(q + 1, avail - 1, &off) : 0;
+        if (n == 0) { r.ok = false; break; }
+        rec.hasPing = true;
+        rec.pingOk = q[0] != 0;
+        rec.pingOffsetMs = off;
+        q += 1 + n;
+        break;
+      }
+      case TRACE_TAG_DECISION: {
+        if (avail < 2) { r.ok = false; break; }
+        // deciziile de la ping poartă timpul ping-ului, ca în firmware
+        const bool fromPing = rec.hasPing && q[0] == TRACE_DECISION_RELAY;
+        r.recorded.push_back({ fromPing ? now + rec.pingOffsetMs : now, q[0], q[1] });
+        q += 2;
+        break;
+      }
+      case TRACE_TAG_COMMAND: {
+        if (avail < 1 || avail < 1u + q[0]) { r.ok = false; break; }
+        if (verbose) printf("%10u ms  cmd \"%.*s\"\n", now, static_cast<int>(q[0]), reinterpret_cast<const char*>(q + 1));
+        q += 1 + q[0];
+        break;
+      }
+      default:
+        r.ok = false;
+        break;
+    }
+    if (!r.ok) return r;
+  }
+  flushPass();
+  r.finalState = s;
+  return r;
+}
+
+struct ReplayReport {
+  bool formatOk = true;
+  uint32_t passes = 0;
+  size_t decisions = 0;
+  size_t mismatches = 0;
+  bool boundaryOk = true;  // finalul jumătății vechi == snapshot-ul celei noi
+};
+
+static ReplayReport replayTrace(const uint8_t* data, size_t len, bool verbose) {
+  ReplayReport rep;
+  if (len < TRACE_FILE_HEADER_BYTES || data[0] != 'A' || data[1] != 'R' || data[2] != TRACE_FORMAT_VERSION) {
+    rep.formatOk = false;
+    return rep;
+  }
+  const size_t len0 = data[4] | (data[5] << 8);
+  const size_t len1 = data[6] | (data[7] << 8);
+  if (TRACE_FILE_HEADER_BYTES + len0 + len1 > len) {
+    rep.formatOk = false;
+    return rep;
+  }
+  if (verbose && data[3]) printf("warning: recorder overflow flag set (records were dropped)\n");
+
+  const uint8_t* halves[2] = { data + TRACE_FILE_HEADER_BYTES, data + TRACE_FILE_HEADER_BYTES + len0 };
+  const size_t lens[2] = { len0, len1 };
+  HalfResult prev;
+  bool havePrev = false;
+  for (uint8_t h = 0; h < 2; ++h) {
+    if (lens[h] == 0) continue;
+    HalfResult r = replayHalf(halves[h], lens[h], verbose);
+    if (!r.ok) {
+      rep.formatOk = false;
+      return rep;
+    }
+    if (havePrev) {
+      // snapshot-ul jumătății noi trebuie să fie exact starea la care a ajuns replay-ul
+      TracedState snap;
+      const uint8_t* q = halves[h] + 1 + 4 + 1 + 1 + TRACE_ZONES * 2 + 16;
+      traceDecodeState(q, r.partitionCount, &snap);
+      rep.boundaryOk = traceStatesEqual(prev.finalState, snap, r.partitionCount);
+    }
+    const size_t n = r.replayed.size() > r.recorded.size() ? r.replayed.size() : r.recorded.size();
+    for (size_t i = 0; i < n; ++i) {
+      const bool haveA = i < r.replayed.size();
+      const bool haveB = i < r.recorded.size();
+      const bool same = haveA && haveB && r.replayed[i] == r.recorded[i];
+      if (!same) ++rep.mismatches;
+      if (!verbose) continue;
+      char line[128];
+      if (haveA) {
+        formatDecision(r.replayed[i], line, sizeof(line));
+        printf("%s%s\n", line, same ? "" : "   <-- MISMATCH");
+      }
+      if (!same && haveB) {
+        formatDecision(r.recorded[i], line, sizeof(line));
+        printf("%s   (recorded)\n", line);
+      }
+    }
+    rep.passes += r.passes;
+    rep.decisions += r.replayed.size();
+    prev = r;
+    havePrev = true;
+  }
+  return rep;
+}
+
+// ----------------------------
+// Citire fișier binar sau captură text (TRACE BEGIN ... TRACE END)
+// ----------------------------
+static bool readFile(const char* path, std::string* out) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  char buf[65536];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out->append(buf, n);
+  fclose(f);
+  return true;
+}
+
+static int hexNibble(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// Ultimul bloc complet din captură (liniile pot avea prefix de timp/CR).
+static bool extractHexBlock(const std::string& text, std::vector<uint8_t>* out) {
+  const size_t begin = text.rfind("TRACE BEGIN");
+  if (begin == std::string::npos) return false;
+  const size_t stop = text.find("TRACE END", begin);
+  if (stop == std::string::npos) return false;
+  size_t pos = text.find('\n', begin);
+  out->clear();
+  while (pos != std::string::npos && pos < stop) {
+    const size_t eol = text.find('\n', pos + 1);
+    std::string line = text.substr(pos + 1, (eol == std::string::npos ? stop : std::min(eol, stop)) - pos - 1);
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.pop_back();
+    const size_t sp = line.find_last_of(' ');
+    if (sp != std::string::npos) line = line.substr(sp + 1);
+    if (!line.empty() && line.size() % 2 == 0) {
+      std::vector<uint8_t> bytes;
+      bool hex = true;
+      for (size_t i = 0; i < line.size() && hex; i += 2) {
+        const int hi = hexNibble(line[i]);
+        const int lo = hexNibble(line[i + 1]);
+        hex = hi >= 0 && lo >= 0;
+        bytes.push_back(static_cast<uint8_t>((hi << 4) | lo));
+      }
+      if (hex) out->insert(out->end(), bytes.begin(), bytes.end());
+    }
+    pos = eol;
+  }
+  return !out->empty();
+}
+
+static int cmdReplay(const char* path, bool verbose) {
+  std::string raw;
+  if (!readFile(path, &raw)) {
+    fprintf(stderr, "cannot read %s\n", path);
+    return 2;
+  }
+  std::vector<uint8_t> data;
+  if (raw.size() >= 2 && raw[0] == 'A' && raw[1] == 'R') {
+    data.assign(raw.begin(), raw.end());
+  } else if (!extractHexBlock(raw, &data)) {
+    fprintf(stderr, "%s: no binary trace and no TRACE BEGIN/END block\n", path);
+    return 2;
+  }
+  const ReplayReport rep = replayTrace(data.data(), data.size(), verbose);
+  if (!rep.formatOk) {
+    fprintf(stderr, "%s: malformed trace\n", path);
+    return 2;
+  }
+  printf("passes=%u decisions=%zu mismatches=%zu boundary=%s\n", rep.passes, rep.decisions, rep.mismatches, rep.boundaryOk ? "ok" : "MISMATCH");
+  return (rep.mismatches == 0 && rep.boundaryOk) ? 0 : 1;
+}
+
+// ----------------------------
+// Table: tranzițiile alarmei, una câte una
+// ----------------------------
+static const char* const EVENT_NAMES[ALARM_EVENT_COUNT] = { "ARM_AWAY", "ARM_STAY", "DISARM", "MOTION_ENTRY", "MOTION_INSTANT", "MOTION_INTERIOR", "TIMEOUT" };
+static const char* const LED_NAMES[] = { "OFF", "ON", "BLINK", "SLOW_BLINK", "FAST_BLINK" };
+
+// Specificația comportamentului, scrisă independent de ALARM_TRANSITIONS;
+// ALARM_NO_TRANSITION = evenimentul trebuie ignorat.
+static uint8_t specNext(AlarmState s, AlarmEvent e, AlarmState armedMode) {
+  if (e == AlarmEvent::DISARM) return s == AlarmState::DISARMED ? ALARM_NO_TRANSITION : static_cast<uint8_t>(AlarmState::DISARMED);
+  switch (s) {
+    case AlarmState::DISARMED:
+      return (e == AlarmEvent::ARM_AWAY || e == AlarmEvent::ARM_STAY) ? static_cast<uint8_t>(AlarmState::ARMING) : ALARM_NO_TRANSITION;
+    case AlarmState::ARMING:
+    case AlarmState::ALARMING:  // exit delay / sirena expirată: înapoi în modul armat
+      return e == AlarmEvent::TIMEOUT ? static_cast<uint8_t>(armedMode) : ALARM_NO_TRANSITION;
+    case AlarmState::ARMED:
+      if (e == AlarmEvent::MOTION_ENTRY) return static_cast<uint8_t>(AlarmState::ENTRY_DELAY);
+      if (e == AlarmEvent::MOTION_INSTANT || e == AlarmEvent::MOTION_INTERIOR) return static_cast<uint8_t>(AlarmState::ALARMING);
+      return ALARM_NO_TRANSITION;
+    case AlarmState::ENTRY_DELAY:  // interiorul urmează entry delay-ul, nu îl scurtează
+      return (e == AlarmEvent::MOTION_INSTANT || e == AlarmEvent::TIMEOUT) ? static_cast<uint8_t>(AlarmState::ALARMING) : ALARM_NO_TRANSITION;
+    case AlarmState::ARMED_STAY:  // interiorul e ocolit; din stay se poate trece în away
+      if (e == AlarmEvent::ARM_AWAY) return static_cast<uint8_t>(AlarmState::ARMING);
+      if (e == AlarmEvent::MOTION_ENTRY) return static_cast<uint8_t>(AlarmState::ENTRY_DELAY);
+      if (e == AlarmEvent::MOTION_INSTANT) return static_cast<uint8_t>(AlarmState::ALARMING);
+      return ALARM_NO_TRANSITION;
+  }
+  return ALARM_NO_TRANSITION;
+}
+
+struct SpecOutputs {
+  bool siren;
+  bool armed;
+  LedPattern led;
+  AlarmTimer timer;
+};
+
+static SpecOutputs specOutputs(AlarmState s) {
+  switch (s) {
+    case AlarmState::DISARMED: return { false, false, LedPattern::BLINK, AlarmTimer::NONE };
+    case AlarmState::ARMING: return { false, false, LedPattern::BLINK, AlarmTimer::EXIT_DELAY };
+    case AlarmState::ARMED: return { false, true, LedPattern::ON, AlarmTimer::NONE };
+    case AlarmState::ALARMING: return { true, true, LedPattern::ON, AlarmTimer::SIREN };
+    case AlarmState::ENTRY_DELAY: return { false, true, LedPattern::FAST_BLINK, AlarmTimer::ENTRY_DELAY };
+    case AlarmState::ARMED_STAY: return { false, true, LedPattern::SLOW_BLINK, AlarmTimer::NONE };
+  }
+  return { false, false, LedPattern::OFF, AlarmTimer::NONE };
+}
+
+static int cmdTable(bool verbose) {
+  const AlarmTimings timings = { 10'000, 15'000, 30'000, 2'000 };
+  const AlarmState modes[] = { AlarmState::ARMED, AlarmState::ARMED_STAY };
+  const uint32_t before = 5'000, at = 7'000;
+  uint32_t rows = 0, transitions = 0, ignored = 0, rowFailures = 0;
+  bool sirenDisarmed = false, outputsOk = true, ignoredUntouched = true, countOk = true, modeOk = true;
+
+  for (uint8_t si = 0; si < ALARM_STATE_COUNT; ++si) {
+    for (uint8_t ei = 0; ei < ALARM_EVENT_COUNT; ++ei) {
+      for (AlarmState mode : modes) {
+        const AlarmState state = static_cast<AlarmState>(si);
+        const AlarmEvent event = static_cast<AlarmEvent>(ei);
+        const AlarmPartition start = { state, mode, false, before, 0 };
+        AlarmPartition part = start;
+        uint32_t alarms = 0;
+        const bool applied = alarmApply(part, event, at, timings, &alarms);
+        const uint8_t want = specNext(state, event, mode);
+        ++rows;
+
+        bool ok = applied == (want != ALARM_NO_TRANSITION);
+        char got[160];
+        if (!applied) {
+          ++ignored;
+          const bool untouched = part.state == start.state && part.armedMode == start.armedMode && part.timerActive == start.timerActive &&
+                                 part.sinceMs == start.sinceMs && part.timerDeadlineMs == start.timerDeadlineMs && alarms == 0;
+          ignoredUntouched = ignoredUntouched && untouched;
+          ok = ok && untouched;
+          snprintf(got, sizeof(got), "ignored");
+        } else {
+          ++transitions;
+          const SpecOutputs out = specOutputs(part.state);
+          const AlarmStateInfo& info = ALARM_STATE_INFO[static_cast<uint8_t>(part.state)];
+          const uint32_t timerMs = alarmTimerMs(out.timer, timings);
+          const bool outputs = info.siren == out.siren && info.armed == out.armed && info.led == out.led && info.timer == out.timer &&
+                               part.sinceMs == at && part.timerActive == (timerMs != 0) && (timerMs == 0 || part.timerDeadlineMs == at + timerMs);
+          // contorul crește exact la intrarea în ALARMING
+          const bool counted = alarms == (part.state == AlarmState::ALARMING && state != AlarmState::ALARMING ? 1u : 0u);
+          // ARM_AWAY/ARM_STAY memorează modul; celelalte îl păstrează
+          const AlarmState wantMode = event == AlarmEvent::ARM_AWAY ? AlarmState::ARMED : event == AlarmEvent::ARM_STAY ? AlarmState::ARMED_STAY : mode;
+          outputsOk = outputsOk && outputs;
+          countOk = countOk && counted;
+          modeOk = modeOk && part.armedMode == wantMode;
+          if (part.state == AlarmState::DISARMED && info.siren) sirenDisarmed = true;
+          ok = ok && static_cast<uint8_t>(part.state) == want && outputs && counted && part.armedMode == wantMode;
+          snprintf(got, sizeof(got), "%-11s siren=%d pir=%d led=%-10s timer=%-5u alarms+%u mode=%s", stateName(static_cast<uint8_t>(part.state)),
+                   info.siren, info.armed, LED_NAMES[static_cast<uint8_t>(info.led)], part.timerActive ? part.timerDeadlineMs - at : 0, alarms,
+                   stateName(static_cast<uint8_t>(part.armedMode)));
+        }
+        if (!ok) ++rowFailures;
+        if (verbose || !ok) {
+          printf("%-11s x %-15s (mode %-10s) -> %s%s%s\n", stateName(si), EVENT_NAMES[ei], stateName(static_cast<uint8_t>(mode)), got,
+                 ok ? "" : "   <-- MISMATCH, spec: ", ok ? "" : want == ALARM_NO_TRANSITION ? "ignored" : stateName(want));
+        }
+      }
+    }
+  }
+
+  bool pass = true;
+  auto check = [&](const char* what, bool ok) {
+    printf("%-60s %s\n", what, ok ? "ok" : "FAILED");
+    pass = pass && ok;
+  };
+  char what[96];
+  snprintf(what, sizeof(what), "%u rows (%u states x %u events x 2 modes) match the spec", rows, ALARM_STATE_COUNT, ALARM_EVENT_COUNT);
+  check(what, rowFailures == 0 && rows == ALARM_STATE_COUNT * ALARM_EVENT_COUNT * 2u);
+  snprintf(what, sizeof(what), "%u transitions: siren/PIR/LED/timer of the target state", transitions);
+  check(what, outputsOk);
+  snprintf(what, sizeof(what), "%u ignored events leave the partition untouched", ignored);
+  check(what, ignoredUntouched);
+  check("alarm counter +1 exactly on entering ALARMING", countOk);
+  check("armed mode set by ARM_AWAY/ARM_STAY, kept otherwise", modeOk);
+  check("siren never on in DISARMED", !sirenDisarmed && !ALARM_STATE_INFO[static_cast<uint8_t>(AlarmState::DISARMED)].siren);
+  printf("%s\n", pass ? "ok" : "FAILED");
+  return pass ? 0 : 1;
+}
+
+// ----------------------------
+// Bench: loop() simulat prin recorder-ul din firmware
+// ----------------------------
+static uint32_t rngState = 1;
+static uint32_t rnd() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+static const size_t BENCH_HALF_BYTES = 2048;  // la fel ca TRACE_HALF_BYTES din main.cpp
+
+static int cmdBench(uint32_t passes, uint32_t seed, const char* outPath) {
+  rngState = seed ? seed : 1;
+  TraceConfig config = {};
+  config.partitionCount = 2;
+  config.zones[0] = { 0, ZoneType::ENTRY };
+  config.zones[1] = { 0, ZoneType::INTERIOR };
+  config.zones[2] = { 0, ZoneType::INTERIOR };
+  config.zones[3] = { 1, ZoneType::INSTANT };
+  config.timings = { 10'000, 15'000, 30'000, 2'000 };
+
+  static InputTraceRecorder<BENCH_HALF_BYTES> recorder;
+  recorder.begin(config);
+  ZoneHealth<TRACE_ZONES> health;  // ca ZONE_* din config.h
+  health.begin({ 3UL * 60'000, 10UL * 60'000, 50, 60'000, 12, 3 });
+  bool pirStuck = false;  // PIR3 blocat activ din când în când
+  uint32_t bypassChanges = 0;
+  TracedState s = {};
+  s.relay.unlockMs = 70'000;
+  s.relay.wifiWasConnected = true;
+  std::vector<Decision> simLog;
+  std::vector<uint32_t> simPassMs;  // trecerea fiecărei decizii: un ping întârziat poate depăși începutul trecerii următoare
+
+  uint32_t now = 1'000;
+  uint8_t levels = TRACE_LEVEL_WIFI;
+  uint32_t nextPingMs = 10'000;
+  bool internetUp = true;
+  uint64_t recorderNs = 0;
+  uint32_t checks = 0, failures = 0;
+  uint64_t recordedPasses = 0;
+  size_t lastUsed = 0;
+  uint32_t windowMs = 0;  // cât acoperă ring-ul la ultima verificare
+  const uint32_t startMs = now;
+  bool stepActive = false;
+
+  using Clock = std::chrono::steady_clock;
+  auto timed = [&](auto&& fn) {
+    const auto t0 = Clock::now();
+    fn();
+    recorderNs += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count());
+  };
+  auto alarmDispatch = [&](uint8_t p, AlarmEvent event) {
+    if (!alarmApply(s.partitions[p], event, now, config.timings, &s.alarmTriggerCount)) return;
+    const uint8_t arg = static_cast<uint8_t>((p << 4) | static_cast<uint8_t>(s.partitions[p].state));
+    if (stepActive) {
+      simLog.push_back({ now, TRACE_DECISION_ALARM, arg });
+      simPassMs.push_back(now);
+      timed([&] { recorder.decision(TRACE_DECISION_ALARM, arg); });
+    }
+  };
+
+  for (uint32_t i = 0; i < passes; ++i) {
+    now += 1 + rnd() % 8;  // o trecere prin loop() durează câteva ms
+
+    // intrări: PIR-uri cu mișcare rară, WiFi care cade din când în când
+    if (rnd() % 3'000'000 == 0) pirStuck = !pirStuck;
+    for (uint8_t z = 0; z < 4; ++z) {
+      if (z == 2 && pirStuck) {
+        levels |= 1u << 2;
+        continue;
+      }
+      const bool on = levels & (1u << z);
+      if (on ? (rnd() % 400 == 0) : (rnd() % 60'000 == 0)) levels ^= static_cast<uint8_t>(1u << z);
+    }
+    if (rnd() % (levels & TRACE_LEVEL_WIFI ? 2'000'000 : 40'000) == 0) levels ^= TRACE_LEVEL_WIFI;
+    if (rnd() % 1'500'000 == 0) internetUp = !internetUp;
+
+    stepActive = true;
+    timed([&] { recorder.beginPass(now, levels, s); });
+    const uint8_t d = relayLoopStep(s.relay, now, (levels & TRACE_LEVEL_WIFI) != 0);
+    if (d != RELAY_DECISION_NONE) {
+      simLog.push_back({ now, TRACE_DECISION_RELAY, d });
+      simPassMs.push_back(now);
+      timed([&] { recorder.decision(TRACE_DECISION_RELAY, d); });
+    }
+    stepActive = false;
+    timed([&] { recorder.stepDone(s); });
+
+    // comenzi (nedeterministe pentru replay => STATE)
+    if (rnd() % 300'000 == 0) {
+      const bool arm = s.partitions[0].state == AlarmState::DISARMED;
+      const char* text = arm ? (rnd() % 2 ? "ARM" : "STAY") : "DISARM";
+      timed([&] { recorder.command(text, strlen(text)); });
+      const AlarmEvent ev = arm ? (text[0] == 'A' ? AlarmEvent::ARM_AWAY : AlarmEvent::ARM_STAY) : AlarmEvent::DISARM;
+      for (uint8_t p = 0; p < config.partitionCount; ++p) alarmDispatch(p, ev);
+    }
+    // ocolirea zonelor (zoneHealthStep din main.cpp)
+    uint8_t watch = 0;
+    for (uint8_t z = 0; z < TRACE_ZONES; ++z) {
+      if (ALARM_STATE_INFO[static_cast<uint8_t>(s.partitions[config.zones[z].partition].state)].armed) watch |= static_cast<uint8_t>(1u << z);
+    }
+    health.step(now, levels, watch);
+    if (health.bypassMask() != s.zoneBypass) ++bypassChanges;
+    s.zoneBypass = health.bypassMask();
+    timed([&] { recorder.external(TRACE_PHASE_INPUT, s); });
+
+    stepActive = true;
+    const uint8_t pir = static_cast<uint8_t>(levels & ~s.zoneBypass);
+    alarmZonesStep(config.zones, TRACE_ZONES, s.partitions, pir, s.lastMotionMs, now, config.timings, alarmDispatch);
+    alarmTimersStep(s.partitions, config.partitionCount, now, alarmDispatch);
+    stepActive = false;
+    timed([&] { recorder.stepDone(s); });
+    for (uint8_t z = 0; z < TRACE_ZONES; ++z) {
+      const AlarmPartition& part = s.partitions[config.zones[z].partition];
+      if (!(pir & (1u << z)) || s.lastMotionMs[z] != now || part.sinceMs != now) continue;
+      if (part.state == AlarmState::ALARMING || part.state == AlarmState::ENTRY_DELAY) health.noteAlarm(z);
+    }
+
+    // rețea: conectarea WiFi resetează contorul de deconectare (ca connectWifi)
+    if ((levels & TRACE_LEVEL_WIFI) && s.relay.wifiDisconnectedSinceMs != 0 && rnd() % 50 == 0) s.relay.wifiDisconnectedSinceMs = 0;
+    timed([&] { recorder.external(TRACE_PHASE_NETWORK, s); });
+
+    if ((int32_t)(now - nextPingMs) >= 0) {
+      nextPingMs = now + 60'000;
+      const uint32_t at = now + 5 + rnd() % 1'000;  // Ping.ping() blochează
+      const bool ok = internetUp && (levels & TRACE_LEVEL_WIFI);
+      const uint8_t pd = relayPingResult(s.relay, at, ok);
+      timed([&] { recorder.ping(ok, at); });
+      if (pd != RELAY_DECISION_NONE) {
+        simLog.push_back({ at, TRACE_DECISION_RELAY, pd });
+        simPassMs.push_back(now);
+        timed([&] { recorder.decision(TRACE_DECISION_RELAY, pd); });
+      }
+      timed([&] { recorder.stepDone(s); });
+    }
+    timed([&] {
+      recorder.external(TRACE_PHASE_LATE, s);
+      recorder.endPass();
+    });
+
+    if (recorder.bytesUsed() != lastUsed) ++recordedPasses;
+    lastUsed = recorder.bytesUsed();
+
+    // replay periodic al ring-ului curent; deciziile trebuie să fie exact
+    // sufixul jurnalului simulării, iar starea finală aceeași
+    if ((i + 1) % 250'000 == 0 || i + 1 == passes) {
+      std::vector<uint8_t> blob(TRACE_FILE_HEADER_BYTES);
+      recorder.header(blob.data());
+      for (uint8_t h = 0; h < 2; ++h) {
+        const uint8_t* data = nullptr;
+        const size_t n = recorder.span(h, &data);
+        blob.insert(blob.end(), data, data + n);
+      }
+      const ReplayReport rep = replayTrace(blob.data(), blob.size(), false);
+      if (outPath != nullptr && i + 1 == passes) {
+        FILE* f = fopen(outPath, "wb");
+        if (f) {
+          fwrite(blob.data(), 1, blob.size(), f);
+          fclose(f);
+        }
+      }
+      // rerun detaliat doar pentru jurnalul refăcut
+      std::vector<Decision> replayed;
+      uint32_t firstMs = 0;
+      TracedState finalState = {};
+      {
+        const size_t len0 = blob[4] | (blob[5] << 8);
+        const size_t len1 = blob[6] | (blob[7] << 8);
+        const uint8_t* base = blob.data() + TRACE_FILE_HEADER_BYTES;
+        bool first = true;
+        if (len0) {
+          HalfResult r0 = replayHalf(base, len0, false);
+          replayed = r0.replayed;
+          firstMs = r0.startMs;
+          first = false;
+        }
+        HalfResult r1 = replayHalf(base + len0, len1, false);
+        if (first) firstMs = r1.startMs;
+        replayed.insert(replayed.end(), r1.replayed.begin(), r1.replayed.end());
+        finalState = r1.finalState;
+      }
+      size_t k = simLog.size();
+      while (k > 0 && (int32_t)(simPassMs[k - 1] - firstMs) >= 0) --k;
+      windowMs = now - firstMs;
+      const std::vector<Decision> expected(simLog.begin() + static_cast<long>(k), simLog.end());
+      const bool ok = rep.formatOk && rep.mismatches == 0 && rep.boundaryOk && replayed == expected && traceStatesEqual(finalState, s, config.partitionCount);
+      ++checks;
+      if (!ok) {
+        ++failures;
+        printf("check %u FAILED: format=%d mismatches=%zu boundary=%d decisions replayed=%zu expected=%zu\n", checks, rep.formatOk, rep.mismatches,
+               rep.boundaryOk, replayed.size(), expected.size());
+      }
+    }
+  }
+
+  const double hours = (now - startMs) / 3'600'000.0;
+  size_t relayDecisions = 0;
+  for (const Decision& d : simLog) relayDecisions += d.kind == TRACE_DECISION_RELAY;
+  printf("passes=%u simulated=%.1f h decisions=%zu (relay %zu, alarm %zu) alarms=%u relay activations=%u zone bypass changes=%u\n", passes, hours,
+         simLog.size(), relayDecisions, simLog.size() - relayDecisions, s.alarmTriggerCount, s.relay.activationCount, bypassChanges);
+  printf("recorder: %.1f ns/pass on host, %.3f%% passes recorded, ring (2 x %zu B) covers the last %.1f min\n", static_cast<double>(recorderNs) / passes,
+         100.0 * recordedPasses / passes, BENCH_HALF_BYTES, windowMs / 60'000.0);
+  printf("replay checks: %u, failures: %u\n", checks, failures);
+  return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+  if (argc >= 3 && strcmp(argv[1], "replay") == 0) {
+    const bool quiet = argc >= 4 && strcmp(argv[3], "-q") == 0;
+    return cmdReplay(argv[2], !quiet);
+  }
+  if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+    const uint32_t passes = argc > 2 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 5'000'000;
+    const uint32_t seed = argc > 3 ? static_cast<uint32_t>(strtoul(argv[3], nullptr, 10)) : 1;
+    return cmdBench(passes, seed, argc > 4 ? argv[4] : nullptr);
+  }
+  if (argc >= 2 && strcmp(argv[1], "table") == 0) {
+    return cmdTable(argc >= 3 && strcmp(argv[2], "-v") == 0);
+  }
+  fprintf(stderr, "usage:\n  %s replay <trace.bin|capture.log> [-q]\n  %s bench [passes] [seed] [out.bin]\n  %s table [-v]\n", argv[0], argv[0], argv[0]);
+  return 2;
+}
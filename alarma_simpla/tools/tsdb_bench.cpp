@@ -0,0 +1,301 @@
+// tsdb_bench.cpp — verificare + cost pentru seria de timp din flash (include/tsdb.h)
+//
+// Build:
+//   g++ -O2 -std=c++17 -I../include tsdb_bench.cpp -o tsdb_bench
+//
+// Utilizare:
+//   ./tsdb_bench [zile=30] [seed=1]
+//
+// 1) generează `zile` de eșantioane pe minut, cu forma celor de pe placă:
+//    RSSI care derivează lent, RTT zgomotos cu ping-uri eșuate și căderi de
+//    WiFi, heap cu o scurgere lentă + zgomot de alocări, releu rar activ;
+//    câteva minute lipsă (reboot) și un salt de ceas (resincronizare);
+// 2) le codează în blocuri ca tsdbFlush() din main.cpp (rotație pe
+//    TSDB_SEGMENT_COUNT segmente de TSDB_SEGMENT_BYTES) și verifică:
+//    decodarea e exactă, `zile` încap în segmentele vechi fără să le rotească
+//    (bugetul de flash e fix, deci ultimul segment trebuie să rămână liber);
+// 3) raportează bytes/eșantion, total și pe coloană, față de stocarea brută
+//    (12 bytes/eșantion) și CSV;
+// 4) interogare pe interval (ultimele 24 h și o oră din mijloc): sărirea
+//    blocurilor după antet + decodarea celor atinse, față de o căutare binară
+//    pe stocarea brută și de o parcurgere liniară a ei.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "tsdb.h"
+
+static const uint32_t START_EPOCH = 1790000000;  // aliniat la minut
+
+struct Segment {
+  std::vector<uint8_t> bytes;
+  uint32_t firstEpoch = 0;
+  uint32_t lastEpoch = 0;
+};
+
+static std::vector<TsdbSample> generate(uint32_t days, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::normal_distribution<double> noise(0.0, 1.0);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  std::vector<TsdbSample> out;
+  const uint32_t minutes = days * 24 * 60;
+  out.reserve(minutes);
+  double rssi = -62.0;
+  double heap = 31000.0;
+  uint32_t wifiDownLeft = 0;
+  uint32_t relayLeft = 0;
+  uint32_t epoch = START_EPOCH;
+  for (uint32_t m = 0; m < minutes; ++m) {
+    epoch += 60;
+    if (u(rng) < 0.0005) epoch += 60 * (1 + rng() % 5);  // reboot: minute lipsă
+    if (m == minutes / 3) epoch += 7;                     // ceas resincronizat
+
+    rssi += noise(rng) * 0.4 + (-62.0 - rssi) * 0.01;
+    if (wifiDownLeft == 0 && u(rng) < 0.0008) wifiDownLeft = 2 + rng() % 20;
+    heap += noise(rng) * 6.0 - 0.02;  // scurgere lentă
+    if (u(rng) < 0.02) heap += (u(rng) < 0.5 ? -1.0 : 1.0) * (200 + rng() % 800);
+    if (heap < 18000) heap = 31000;  // reboot de la watchdog
+
+    TsdbSample s;
+    s.epoch = epoch;
+    s.heap = static_cast<uint32_t>(heap) & ~3u;  // alocatorul lucrează pe 4 bytes
+    uint8_t activations = 0;
+    if (wifiDownLeft) {
+      --wifiDownLeft;
+      s.rssi = TSDB_RSSI_NONE;
+      s.rttMs = TSDB_RTT_FAIL;
+      if (wifiDownLeft == 0 && u(rng) < 0.3) {
+        relayLeft = 1 + rng() % 3;
+        activations = 1;
+      }
+    } else {
+      s.rssi = static_cast<int8_t>(std::lround(rssi));
+      const double rtt = 22.0 + std::fabs(noise(rng)) * 8.0 + (u(rng) < 0.03 ? 150.0 * u(rng) : 0.0);
+      s.rttMs = u(rng) < 0.004 ? TSDB_RTT_FAIL : static_cast<uint16_t>(rtt);
+    }
+    s.relay = activations;
+    if (relayLeft) {
+      --relayLeft;
+      s.relay |= TSDB_RELAY_ACTIVE;
+    }
+    out.push_back(s);
+  }
+  return out;
+}
+
+// Aceleași rânduri ca tsdbPrintRow() din main.cpp (fără CR).
+static size_t csvBytes(const std::vector<TsdbSample>& samples) {
+  size_t total = 0;
+  char line[64];
+  for (const TsdbSample& s : samples) {
+    char rssi[8] = "";
+    char rtt[8] = "";
+    if (s.rssi != TSDB_RSSI_NONE) snprintf(rssi, sizeof(rssi), "%d", s.rssi);
+    if (s.rttMs != TSDB_RTT_FAIL) snprintf(rtt, sizeof(rtt), "%u", s.rttMs);
+    total += snprintf(line, sizeof(line), "%lu,%s,%s,%lu,%u,%u\n", static_cast<unsigned long>(s.epoch), rssi, rtt,
+                      static_cast<unsigned long>(s.heap), (s.relay & TSDB_RELAY_ACTIVE) ? 1 : 0, s.relay & 0x7F);
+  }
+  return total;
+}
+
+static bool sameSample(const TsdbSample& a, const TsdbSample& b) {
+  return a.epoch == b.epoch && a.heap == b.heap && a.rttMs == b.rttMs && a.rssi == b.rssi && a.relay == b.relay;
+}
+
+// Ca query-ul din firmware: segmente în ordine, antet -> sare sau decodează.
+static size_t queryTsdb(const std::vector<Segment>& segs, uint32_t from, uint32_t to, uint64_t* checksum, size_t* blocksRead) {
+  size_t rows = 0;
+  *blocksRead = 0;
+  for (const Segment& seg : segs) {
+    if (seg.bytes.empty() || seg.lastEpoch < from || seg.firstEpoch > to) continue;
+    size_t pos = 0;
+    while (pos + TSDB_BLOCK_HEADER_BYTES <= seg.bytes.size()) {
+      TsdbBlockInfo info;
+      if (!tsdbParseHeader(seg.bytes.data() + pos, &info)) break;
+      const uint8_t* block = seg.bytes.data() + pos;
+      pos += info.totalBytes;
+      if (info.lastEpoch < from || info.firstEpoch > to) continue;
+      TsdbBlockReader reader;
+      if (!reader.open(block, info.totalBytes)) continue;
+      ++*blocksRead;
+      TsdbSample s;
+      while (reader.next(&s)) {
+        if (s.epoch < from || s.epoch > to) continue;
+        *checksum += s.heap + s.rttMs;
+        ++rows;
+      }
+    }
+  }
+  return rows;
+}
+
+static size_t queryRawBinary(const std::vector<TsdbSample>& raw, uint32_t from, uint32_t to, uint64_t* checksum) {
+  size_t lo = 0, hi = raw.size();
+  while (lo < hi) {
+    const size_t mid = (lo + hi) / 2;
+    if (raw[mid].epoch < from) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  size_t rows = 0;
+  for (size_t i = lo; i < raw.size() && raw[i].epoch <= to; ++i) {
+    *checksum += raw[i].heap + raw[i].rttMs;
+    ++rows;
+  }
+  return rows;
+}
+
+static size_t queryRawLinear(const std::vector<TsdbSample>& raw, uint32_t from, uint32_t to, uint64_t* checksum) {
+  size_t rows = 0;
+  for (const TsdbSample& s : raw) {
+    if (s.epoch < from || s.epoch > to) continue;
+    *checksum += s.heap + s.rttMs;
+    ++rows;
+  }
+  return rows;
+}
+
+template <typename F>
+static double usPerCall(F&& f, int reps) {
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < reps; ++i) f();
+  const auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(t1 - t0).count() / reps;
+}
+
+int main(int argc, char** argv) {
+  const uint32_t days = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 30;
+  const uint32_t seed = argc > 2 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 1;
+  if (days == 0) {
+    fprintf(stderr, "zile > 0\n");
+    return 1;
+  }
+  bool ok = true;
+  const std::vector<TsdbSample> samples = generate(days, seed);
+
+  // --- codare, cu rotația din tsdbFlush()
+  std::vector<Segment> segs(TSDB_SEGMENT_COUNT);
+  uint8_t current = 0;
+  uint32_t rotations = 0;
+  uint64_t columnBytes[TSDB_COLUMNS] = {};
+  size_t blocks = 0;
+  uint8_t block[TSDB_BLOCK_MAX_BYTES];
+  for (size_t i = 0; i < samples.size(); i += TSDB_BLOCK_SAMPLES) {
+    const uint8_t n = static_cast<uint8_t>(std::min<size_t>(TSDB_BLOCK_SAMPLES, samples.size() - i));
+    const size_t len = tsdbEncodeBlock(&samples[i], n, block, sizeof(block));
+    if (len == 0) {
+      printf("encode block %zu: FAILED\n", blocks);
+      return 1;
+    }
+    TsdbBlockInfo info;
+    tsdbParseHeader(block, &info);
+    for (uint8_t c = 0; c < TSDB_COLUMNS; ++c) columnBytes[c] += info.columnBytes[c];
+    if (segs[current].bytes.size() + len > TSDB_SEGMENT_BYTES) {
+      current = (current + 1) % TSDB_SEGMENT_COUNT;
+      segs[current] = Segment();
+      ++rotations;
+    }
+    Segment& seg = segs[current];
+    if (seg.bytes.empty()) seg.firstEpoch = samples[i].epoch;
+    seg.lastEpoch = samples[i + n - 1].epoch;
+    seg.bytes.insert(seg.bytes.end(), block, block + len);
+    ++blocks;
+  }
+  size_t flashBytes = 0;
+  for (const Segment& seg : segs) flashBytes += seg.bytes.size();
+  // ca tsdbStartQuery(): de la cel mai vechi segment (după rotație, indexul nu mai e ordinea)
+  std::stable_sort(segs.begin(), segs.end(), [](const Segment& a, const Segment& b) { return a.firstEpoch < b.firstEpoch; });
+
+  // --- decodare completă
+  std::vector<TsdbSample> decoded;
+  decoded.reserve(samples.size());
+  for (const Segment& seg : segs) {
+    size_t pos = 0;
+    TsdbBlockInfo info;
+    while (pos < seg.bytes.size() && tsdbParseHeader(seg.bytes.data() + pos, &info)) {
+      TsdbBlockReader reader;
+      if (!reader.open(seg.bytes.data() + pos, info.totalBytes)) {
+        printf("CRC block @%zu: FAILED\n", pos);
+        ok = false;
+        break;
+      }
+      TsdbSample s;
+      while (reader.next(&s)) decoded.push_back(s);
+      pos += info.totalBytes;
+    }
+  }
+  size_t mismatch = 0;
+  const size_t kept = decoded.size();
+  const size_t offset = samples.size() - std::min(samples.size(), kept);
+  for (size_t i = 0; i < kept; ++i) {
+    if (!sameSample(decoded[i], samples[offset + i])) ++mismatch;
+  }
+  const bool wrapped = rotations >= TSDB_SEGMENT_COUNT;  // cele mai vechi zile s-au rescris
+  const bool roundtrip = (kept == samples.size() || wrapped) && kept != 0 && mismatch == 0;
+  printf("roundtrip: %zu/%zu samples, %zu mismatches: %s\n", kept, samples.size(), mismatch, roundtrip ? "ok" : "FAILED");
+  ok = ok && roundtrip;
+
+  // corupție: un bit întors în date trebuie prins de CRC
+  {
+    Segment& seg = segs.back();
+    TsdbBlockInfo info = {};
+    tsdbParseHeader(seg.bytes.data(), &info);
+    seg.bytes[TSDB_BLOCK_HEADER_BYTES + 3] ^= 0x10;
+    TsdbBlockReader reader;
+    const bool caught = !reader.open(seg.bytes.data(), info.totalBytes);
+    seg.bytes[TSDB_BLOCK_HEADER_BYTES + 3] ^= 0x10;
+    printf("corrupt block rejected: %s\n", caught ? "ok" : "FAILED");
+    ok = ok && caught;
+  }
+
+  const uint32_t retentionBudget = (TSDB_SEGMENT_COUNT - 1) * TSDB_SEGMENT_BYTES;
+  const bool fits = rotations < TSDB_SEGMENT_COUNT && flashBytes <= retentionBudget;
+  printf("%u days: %zu samples, %zu blocks, %zu B flash (retention budget %u B, total %u B): %s\n", days, samples.size(), blocks,
+         flashBytes, retentionBudget, TSDB_FLASH_BUDGET_BYTES, fits ? "ok" : (days > 30 ? "wrapped" : "FAILED"));
+  ok = ok && (days > 30 || fits);
+
+  const double n = static_cast<double>(samples.size());
+  const double headerBytes = static_cast<double>(blocks) * TSDB_BLOCK_HEADER_BYTES;
+  printf("\nbytes/sample: %.3f (raw packed 12, CSV %.1f)\n", flashBytes / n, csvBytes(samples) / n);
+  static const char* const NAMES[TSDB_COLUMNS] = { "epoch", "rssi", "rtt", "heap", "relay" };
+  for (uint8_t c = 0; c < TSDB_COLUMNS; ++c) printf("  %-6s %.3f\n", NAMES[c], columnBytes[c] / n);
+  printf("  header %.3f\n", headerBytes / n);
+  printf("compression vs raw 12 B: %.1fx\n", 12.0 * n / flashBytes);
+
+  // --- interogări
+  const uint32_t last = samples.back().epoch;
+  struct Range {
+    const char* name;
+    uint32_t from;
+    uint32_t to;
+  };
+  const uint32_t mid = samples[samples.size() / 2].epoch;
+  const Range ranges[] = { { "last 24h", last - 24 * 3600, last }, { "1h in the middle", mid, mid + 3600 } };
+  printf("\nrange query (us/query):\n");
+  for (const Range& r : ranges) {
+    uint64_t ca = 0, cb = 0, cc = 0;
+    size_t blocksRead = 0;
+    const size_t ra = queryTsdb(segs, r.from, r.to, &ca, &blocksRead);
+    const size_t rb = queryRawBinary(samples, r.from, r.to, &cb);
+    const size_t rc = queryRawLinear(samples, r.from, r.to, &cc);
+    const bool same = ra == rb && rb == rc && ca == cb && cb == cc;
+    uint64_t sink = 0;
+    size_t dummy = 0;
+    const double tTsdb = usPerCall([&] { queryTsdb(segs, r.from, r.to, &sink, &dummy); }, 200);
+    const double tBin = usPerCall([&] { queryRawBinary(samples, r.from, r.to, &sink); }, 200);
+    const double tLin = usPerCall([&] { queryRawLinear(samples, r.from, r.to, &sink); }, 200);
+    printf("  %-17s %5zu rows, %3zu/%zu blocks decoded: tsdb %.1f, raw binary %.1f, raw linear %.1f  %s\n", r.name, ra, blocksRead, blocks,
+           tTsdb, tBin, tLin, same ? "ok" : "FAILED");
+    ok = ok && same && sink != 1;
+  }
+
+  printf("\n%s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,338 @@
+// zone_health_sim.cpp — replay de nopți cu PIR-uri defecte prin alarm_fsm.h, cu și fără include/zone_health.h
+//
+// Build:
+//   g++ -O2 -std=c++17 -I../include zone_health_sim.cpp -o zone_health_sim
+//
+// Utilizare:
+//   ./zone_health_sim [seed=1] [-v]
+//
+// Fiecare scenariu e o urmă de niveluri PIR pe o noapte (8 h, armat AWAY la
+// început, DISARM la final), trecută prin pașii din loop() (10 ms/trecere):
+// zoneHealthStep (ocolirea), alarmZonesStep cu PIR-urile neocolite,
+// alarmTimersStep, plus numărarea alarmelor pe zonă ca în updateZones().
+// Aceeași urmă rulează o dată fără verificarea zonelor (ca înainte) și o dată
+// cu ea, cu valorile ZONE_* din config.h, apoi încă o dată cu ZONE_SWINGER_LIMIT
+// = 0, unde ocolirea vine doar din STUCK/DUTY/RATE. Se compară ciclurile de
+// sirenă (intrările în ALARMING) și minutele de sirenă, iar la fiecare ocolire
+// se verifică zona și defectul raportat: cablul blocat = STUCK, contactul
+// intermitent = DUTY sau RATE, declanșările false dese = RATE. O intruziune
+// reală trebuie să dea prima alarmă la fel în toate variantele, inclusiv după
+// ocolirea altei zone (limita de alarme pe zonă se aplică și unei intruziuni lungi).
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "alarm_fsm.h"
+#include "zone_health.h"
+
+// Tipurile de zonă și timpii din main.cpp, ZONE_* din config.h (o singură partiție)
+static const AlarmZone ZONES[4] = { { 0, ZoneType::ENTRY }, { 0, ZoneType::INTERIOR }, { 0, ZoneType::INTERIOR }, { 0, ZoneType::INSTANT } };
+static const AlarmTimings TIMINGS = { 10'000, 15'000, 30'000, 2'000 };
+static const ZoneHealthConfig HEALTH = { 3UL * 60'000, 10UL * 60'000, 50, 60'000, 12, 3 };
+static const ZoneHealthConfig HEALTH_NO_SWINGER = { 3UL * 60'000, 10UL * 60'000, 50, 60'000, 12, 0 };
+
+static const uint32_t PASS_MS = 10;
+static const uint32_t NIGHT_MS = 8 * 3'600'000;
+static const uint32_t MIN_MS = 60'000;
+
+struct Rng {
+  uint32_t s;
+  uint32_t next() {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+  }
+  uint32_t below(uint32_t n) { return next() % n; }
+};
+
+// Urma unei zone: intervale active [startMs, endMs), sortate.
+struct Span {
+  uint32_t startMs;
+  uint32_t endMs;
+};
+
+static constexpr uint8_t faultBit(ZoneFault f) {
+  return static_cast<uint8_t>(1u << static_cast<uint8_t>(f));
+}
+
+static const uint8_t NO_ZONE = 0xFF;
+
+struct Scenario {
+  const char* name;
+  std::vector<Span> zones[4];
+  uint32_t intrusionMs;  // 0 = fără intruziune reală; altfel trebuie o alarmă după acest moment
+  bool faulty;           // PIR defect: ciclurile de sirenă trebuie să scadă
+  uint8_t faultZone;     // zona PIR-ului defect, NO_ZONE = niciuna
+  // Defectele acceptate la ocolirea faultZone (biți faultBit), [0] cu limita
+  // de alarme, [1] fără ea; 0 = zona nu trebuie ocolită în varianta respectivă.
+  uint8_t expectFaults[2];
+};
+
+static void stuckFrom(Scenario& s, uint8_t zone, uint32_t fromMs) {
+  s.zones[zone].push_back({ fromMs, NIGHT_MS + 1 });
+}
+
+// Contact intermitent: impulsuri scurte la câteva secunde.
+static void intermittent(Scenario& s, uint8_t zone, uint32_t fromMs, Rng& rng) {
+  for (uint32_t t = fromMs; t < NIGHT_MS; t += 3'000 + rng.below(5'000)) s.zones[zone].push_back({ t, t + 200 + rng.below(400) });
+}
+
+// Declanșări false (insecte, aer cald, curent de aer): un impuls de 1–3 s la
+// fiecare periodMs ± jumătate.
+static void falseTrips(Scenario& s, uint8_t zone, uint32_t periodMs, Rng& rng) {
+  for (uint32_t t = periodMs / 2 + rng.below(periodMs / 2); t < NIGHT_MS - MIN_MS; t += periodMs * 3 / 4 + rng.below(periodMs / 2)) {
+    s.zones[zone].push_back({ t, t + 1'000 + rng.below(2'000) });
+  }
+}
+
+// Intruziune: intrare (zona 1), apoi mișcare prin zonele 2 și 3 câteva minute.
+static void intrusion(Scenario& s, uint32_t atMs, Rng& rng) {
+  s.intrusionMs = atMs;
+  s.zones[0].push_back({ atMs, atMs + 4'000 });
+  for (uint32_t t = atMs + 8'000; t < atMs + 4 * MIN_MS; t += 5'000 + rng.below(20'000)) {
+    const uint8_t z = static_cast<uint8_t>(1 + rng.below(2));
+    if (!s.zones[z].empty() && s.zones[z].back().endMs > t) continue;  // zona e deja activă (blocată)
+    s.zones[z].push_back({ t, t + 2'000 + rng.below(4'000) });
+  }
+}
+
+static std::vector<Scenario> makeScenarios(uint32_t seed) {
+  Rng rng = { seed * 2654435761u + 1 };
+  std::vector<Scenario> out;
+  const uint8_t SWINGER = faultBit(ZoneFault::SWINGER);
+  auto faulty = [](Scenario& s, uint8_t zone, uint8_t withLimit, uint8_t withoutLimit) {
+    s.faulty = true;
+    s.faultZone = zone;
+    s.expectFaults[0] = withLimit;
+    s.expectFaults[1] = withoutLimit;
+  };
+  Scenario s;
+  s = {};
+  s.name = "quiet night";
+  s.faultZone = NO_ZONE;
+  out.push_back(s);
+  // Un PIR blocat repornește sirena la fiecare ~45 s: limita de alarme (3)
+  // îl prinde înaintea celor 3 minute de STUCK, fără ea rămâne STUCK.
+  s = {};
+  s.name = "PIR2 stuck high from 01:00 (cut cable)";
+  faulty(s, 1, SWINGER | faultBit(ZoneFault::STUCK), faultBit(ZoneFault::STUCK));
+  stuckFrom(s, 1, 3 * 3'600'000);
+  out.push_back(s);
+  s = {};
+  s.name = "PIR4 stuck high before arming";
+  faulty(s, 3, SWINGER | faultBit(ZoneFault::STUCK), faultBit(ZoneFault::STUCK));
+  stuckFrom(s, 3, 0);
+  out.push_back(s);
+  s = {};
+  s.name = "PIR3 intermittent contact from 00:00";
+  faulty(s, 2, SWINGER | faultBit(ZoneFault::DUTY) | faultBit(ZoneFault::RATE), faultBit(ZoneFault::DUTY) | faultBit(ZoneFault::RATE));
+  intermittent(s, 2, 2 * 3'600'000, rng);
+  out.push_back(s);
+  // Declanșări rare: sub pragul de rată (cel mult 2 sloturi din 32), doar
+  // limita de alarme le oprește.
+  s = {};
+  s.name = "PIR1 false trip every ~20 min";
+  faulty(s, 0, SWINGER, 0);
+  falseTrips(s, 0, 20 * MIN_MS, rng);
+  out.push_back(s);
+  s = {};
+  s.name = "PIR1 false trip every ~2 min";
+  faulty(s, 0, SWINGER | faultBit(ZoneFault::RATE), faultBit(ZoneFault::RATE));
+  falseTrips(s, 0, 2 * MIN_MS, rng);
+  out.push_back(s);
+  s = {};
+  s.name = "intrusion at 01:30";
+  s.faultZone = NO_ZONE;
+  intrusion(s, 3 * 3'600'000 + 30 * MIN_MS, rng);
+  out.push_back(s);
+  s = {};
+  s.name = "PIR2 stuck from 23:00, intrusion at 03:00";
+  faulty(s, 1, SWINGER | faultBit(ZoneFault::STUCK), faultBit(ZoneFault::STUCK));
+  stuckFrom(s, 1, 3'600'000);
+  intrusion(s, 5 * 3'600'000, rng);
+  out.push_back(s);
+  return out;
+}
+
+// O ocolire: zona, defectul raportat de ZoneHealth::fault() și momentul.
+struct Bypass {
+  uint8_t zone;
+  ZoneFault fault;
+  uint32_t atMs;
+};
+
+struct Result {
+  uint32_t sirenCycles;
+  uint32_t sirenMs;
+  uint32_t alarmsAfterIntrusion;
+  uint32_t firstIntrusionAlarmMs;
+  uint8_t bypassAtDisarm;  // ocolirile rămase după DISARM (PIR încă activ)
+  std::vector<Bypass> bypasses;
+  uint64_t healthNs;
+};
+
+static void formatBypass(char* out, size_t size, const Result& r) {
+  if (r.bypasses.empty()) {
+    snprintf(out, size, "-");
+    return;
+  }
+  const Bypass& b = r.bypasses.front();
+  snprintf(out, size, "Z%u %s at +%u min", b.zone + 1u, ZONE_FAULT_NAMES[static_cast<uint8_t>(b.fault)], b.atMs / MIN_MS);
+}
+
+// healthConfig = nullptr: fără verificarea zonelor.
+static Result runNight(const Scenario& sc, const ZoneHealthConfig* healthConfig) {
+  const bool withHealth = healthConfig != nullptr;
+  Result r = {};
+  AlarmPartition part = { AlarmState::ARMED, AlarmState::ARMED, false, 0, 0 };
+  uint32_t lastMotionMs[4] = {};
+  uint32_t alarmCount = 0;
+  ZoneHealth<4> health;
+  if (withHealth) health.begin(*healthConfig);
+  uint8_t bypass = 0;
+  size_t cursor[4] = {};
+
+  for (uint32_t now = 0; now <= NIGHT_MS + MIN_MS; now += PASS_MS) {
+    uint8_t levels = 0;
+    for (uint8_t z = 0; z < 4; ++z) {
+      const std::vector<Span>& spans = sc.zones[z];
+      while (cursor[z] < spans.size() && spans[cursor[z]].endMs <= now) ++cursor[z];
+      if (cursor[z] < spans.size() && spans[cursor[z]].startMs <= now) levels |= static_cast<uint8_t>(1u << z);
+    }
+    if (now == NIGHT_MS) alarmApply(part, AlarmEvent::DISARM, now, TIMINGS, &alarmCount);
+
+    // faza de intrări: zoneHealthStep()
+    if (withHealth) {
+      const auto t0 = std::chrono::steady_clock::now();
+      const uint8_t watch = ALARM_STATE_INFO[static_cast<uint8_t>(part.state)].armed ? 0x0F : 0;
+      health.step(now, levels, watch);
+      const uint8_t mask = health.bypassMask();
+      r.healthNs += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count());
+      for (uint8_t z = 0; z < 4; ++z) {
+        if ((mask & ~bypass) & (1u << z)) r.bypasses.push_back({ z, health.fault(z), now });
+      }
+      bypass = mask;
+    }
+
+    // updateZones() + updateAlarmTimers()
+    const uint8_t pir = static_cast<uint8_t>(levels & ~bypass);
+    const AlarmState before = part.state;
+    auto dispatch = [&](uint8_t, AlarmEvent e) { alarmApply(part, e, now, TIMINGS, &alarmCount); };
+    alarmZonesStep(ZONES, 4, &part, pir, lastMotionMs, now, TIMINGS, dispatch);
+    for (uint8_t z = 0; z < 4; ++z) {
+      if (!(pir & (1u << z)) || lastMotionMs[z] != now || part.sinceMs != now) continue;
+      if (withHealth && (part.state == AlarmState::ALARMING || part.state == AlarmState::ENTRY_DELAY)) health.noteAlarm(z);
+    }
+    alarmTimersStep(&part, 1, now, dispatch);
+
+    if (part.state == AlarmState::ALARMING) {
+      r.sirenMs += PASS_MS;
+      if (before != AlarmState::ALARMING) {
+        ++r.sirenCycles;
+        if (sc.intrusionMs != 0 && now >= sc.intrusionMs && r.alarmsAfterIntrusion++ == 0) r.firstIntrusionAlarmMs = now;
+      }
+    }
+  }
+  r.bypassAtDisarm = bypass;
+  return r;
+}
+
+int main(int argc, char** argv) {
+  uint32_t seed = 1;
+  bool verbose = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+    } else {
+      seed = static_cast<uint32_t>(strtoul(argv[i], nullptr, 10));
+    }
+  }
+  bool ok = true;
+  auto check = [&](const char* what, bool pass) {
+    printf("%-60s %s\n", what, pass ? "ok" : "FAILED");
+    ok = ok && pass;
+  };
+
+  const std::vector<Scenario> scenarios = makeScenarios(seed);
+  printf("%-42s %21s %21s   %-22s %s\n", "night (armed 22:00-06:00)", "siren cycles", "siren min", "first bypass", "first bypass");
+  printf("%-42s %6s %7s %6s %6s %7s %6s   %-22s %s\n", "", "before", "zones", "no lim", "before", "zones", "no lim", "(zones)", "(no swinger limit)");
+  bool faultyDrop = true, noLimitDrop = true, intrusionSame = true, quietClean = true, intrusionAfterBypass = true, stuckStays = true;
+  bool faultyBypassed = true, faultExpected = true, onlyFaultyZone = true, rareTripsKept = true;
+  uint64_t healthNs = 0, passes = 0;
+  for (const Scenario& sc : scenarios) {
+    const Result before = runNight(sc, nullptr);
+    const Result after = runNight(sc, &HEALTH);
+    const Result noLimit = runNight(sc, &HEALTH_NO_SWINGER);
+    healthNs += after.healthNs;
+    passes += NIGHT_MS / PASS_MS + MIN_MS / PASS_MS + 1;
+    char firstAfter[32], firstNoLimit[32];
+    formatBypass(firstAfter, sizeof(firstAfter), after);
+    formatBypass(firstNoLimit, sizeof(firstNoLimit), noLimit);
+    printf("%-42s %6u %7u %6u %6.1f %7.1f %6.1f   %-22s %s\n", sc.name, before.sirenCycles, after.sirenCycles, noLimit.sirenCycles, before.sirenMs / 60'000.0,
+           after.sirenMs / 60'000.0, noLimit.sirenMs / 60'000.0, firstAfter, firstNoLimit);
+
+    // Fiecare ocolire, în ambele variante: zona defectă cu un defect așteptat;
+    // altă zonă doar ca SWINGER (limita de alarme pe o intruziune lungă).
+    const Result* runs[2] = { &after, &noLimit };
+    for (uint8_t v = 0; v < 2; ++v) {
+      const Result& r = *runs[v];
+      bool faultZoneBypassed = false;
+      for (const Bypass& b : r.bypasses) {
+        if (verbose) printf("    %s: Z%u %s at +%u min\n", v == 0 ? "zones" : "no limit", b.zone + 1u, ZONE_FAULT_NAMES[static_cast<uint8_t>(b.fault)], b.atMs / MIN_MS);
+        if (b.zone == sc.faultZone) {
+          faultZoneBypassed = true;
+          faultExpected = faultExpected && (sc.expectFaults[v] & faultBit(b.fault)) != 0;
+        } else {
+          onlyFaultyZone = onlyFaultyZone && v == 0 && b.fault == ZoneFault::SWINGER && sc.intrusionMs != 0 && b.atMs >= sc.intrusionMs;
+        }
+      }
+      if (sc.faulty && sc.expectFaults[v] != 0) faultyBypassed = faultyBypassed && faultZoneBypassed;
+      if (sc.faulty && sc.expectFaults[v] == 0) rareTripsKept = rareTripsKept && !faultZoneBypassed && r.sirenCycles == before.sirenCycles;
+    }
+
+    if (sc.faulty) {
+      const uint32_t faultBefore = before.sirenCycles - before.alarmsAfterIntrusion;
+      const uint32_t faultAfter = after.sirenCycles - after.alarmsAfterIntrusion;
+      faultyDrop = faultyDrop && faultAfter < faultBefore && faultAfter <= HEALTH.swingerLimit;
+      if (sc.expectFaults[1] != 0) noLimitDrop = noLimitDrop && noLimit.sirenCycles - noLimit.alarmsAfterIntrusion < faultBefore;
+    }
+    // O intruziune lungă repornește și ea sirena; limita de alarme se aplică
+    // oricărei cauze, dar prima alarmă trebuie să fie aceeași.
+    if (sc.intrusionMs != 0) {
+      const bool sameFirst = after.alarmsAfterIntrusion >= 1 && after.firstIntrusionAlarmMs == before.firstIntrusionAlarmMs &&
+                             noLimit.alarmsAfterIntrusion >= 1 && noLimit.firstIntrusionAlarmMs == before.firstIntrusionAlarmMs;
+      if (sc.faulty) {
+        intrusionAfterBypass = intrusionAfterBypass && sameFirst;
+      } else {
+        const uint32_t floor = before.sirenCycles < HEALTH.swingerLimit ? before.sirenCycles : HEALTH.swingerLimit;
+        intrusionSame = intrusionSame && sameFirst && after.sirenCycles >= floor;
+      }
+    }
+    if (!sc.faulty && sc.intrusionMs == 0) {
+      quietClean = quietClean && after.bypasses.empty() && after.sirenCycles == 0 && noLimit.bypasses.empty() && noLimit.sirenCycles == 0;
+    }
+    // după DISARM rămâne ocolită doar o zonă încă activă (blocată)
+    for (uint8_t z = 0; z < 4; ++z) {
+      const bool stillHigh = !sc.zones[z].empty() && sc.zones[z].back().endMs > NIGHT_MS + MIN_MS;
+      if (((after.bypassAtDisarm >> z) & 1) != (stillHigh ? 1 : 0)) stuckStays = false;
+      if (((noLimit.bypassAtDisarm >> z) & 1) != (stillHigh ? 1 : 0)) stuckStays = false;
+    }
+  }
+  printf("\nzone health step: %.1f ns/pass on host (4 zones)\n\n", static_cast<double>(healthNs) / passes);
+
+  check("faulty PIR: siren cycles drop to the swinger limit", faultyDrop);
+  check("no swinger limit: siren cycles still drop (STUCK/DUTY/RATE)", noLimitDrop);
+  check("faulty PIR zone bypassed in every expected variant", faultyBypassed);
+  check("each bypass reports the expected fault (stuck=STUCK, ...)", faultExpected);
+  check("other zones bypassed only as SWINGER during an intrusion", onlyFaultyZone);
+  check("rare false trips, no swinger limit: below RATE, not bypassed", rareTripsKept);
+  check("real intrusion: same first alarm, >= swinger limit cycles", intrusionSame);
+  check("intrusion after another zone was bypassed: same first alarm", intrusionAfterBypass);
+  check("quiet night: no bypass, no alarm", quietClean);
+  check("after DISARM only still-active PIRs stay bypassed", stuckStays);
+  printf("%s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}